@@ -137,9 +137,117 @@ static PyObject *Elevation_calcShadowMask(PyObject *self, PyObject *args)
     if( !PyArg_ParseTuple(args, "ssfffs:shadowmask", &pszInputImage, &pszOutputFile, &azimuth, &zenith, &maxHeight, &pszGDALFormat))
         return NULL;
     
+    if(PyErr_WarnEx(PyExc_DeprecationWarning, "shadowmask: maxHeight is deprecated and ignored, the shadow search distance is taken from the DEM.", 1) < 0)
+        return NULL;
+    
+    try
+    {
+        rsgis::cmds::executeCalcShadowMask(std::string(pszInputImage), std::string(pszOutputFile), azimuth, zenith, std::string(pszGDALFormat));
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return NULL;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+static PyObject *Elevation_calcTerrainDerivatives(PyObject *self, PyObject *args)
+{
+    const char *pszInputImage, *pszOutputFile, *pszGDALFormat, *pszOutUnit;
+    PyObject *pDerivatives;
+    float solarAzimuth, solarZenith, viewAzimuth, viewZenith = 0.0;
+    if( !PyArg_ParseTuple(args, "ssOffffss:terrainDerivatives", &pszInputImage, &pszOutputFile, &pDerivatives, &solarAzimuth, &solarZenith, &viewAzimuth, &viewZenith, &pszOutUnit, &pszGDALFormat))
+        return NULL;
+    
+    std::vector<std::string> derivatives;
+    if(RSGISPY_CHECK_STRING(pDerivatives))
+    {
+        derivatives.push_back(RSGISPY_STRING_EXTRACT(pDerivatives));
+    }
+    else if(PySequence_Check(pDerivatives))
+    {
+        Py_ssize_t nDerivs = PySequence_Size(pDerivatives);
+        for( Py_ssize_t n = 0; n < nDerivs; n++ )
+        {
+            PyObject *o = PySequence_GetItem(pDerivatives, n);
+            if(!RSGISPY_CHECK_STRING(o))
+            {
+                PyErr_SetString(GETSTATE(self)->error, "Terrain derivatives must be strings");
+                Py_DECREF(o);
+                return NULL;
+            }
+            derivatives.push_back(RSGISPY_STRING_EXTRACT(o));
+            Py_DECREF(o);
+        }
+    }
+    else
+    {
+        PyErr_SetString(GETSTATE(self)->error, "Terrain derivatives must be a string or a list of strings");
+        return NULL;
+    }
+    
+    try
+    {
+        rsgis::cmds::RSGISAngleMeasure outAngleUnit;
+        std::string angUnit = std::string(pszOutUnit);
+        if(angUnit == "degrees")
+        {
+            outAngleUnit = rsgis::cmds::rsgis_degrees;
+        }
+        else if(angUnit == "radians")
+        {
+            outAngleUnit = rsgis::cmds::rsgis_radians;
+        }
+        else
+        {
+            throw rsgis::cmds::RSGISCmdException("The unit option needs to be specified as either \'degrees\' or \'radians\'.");
+        }
+        
+        rsgis::cmds::executeCalcTerrainDerivatives(std::string(pszInputImage), std::string(pszOutputFile), derivatives, solarAzimuth, solarZenith, viewAzimuth, viewZenith, outAngleUnit, std::string(pszGDALFormat));
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return NULL;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+static PyObject *Elevation_calcSkyViewFactor(PyObject *self, PyObject *args)
+{
+    const char *pszInputImage, *pszOutputFile, *pszGDALFormat;
+    unsigned int numAzimuths = 16;
+    float maxSearchDist = 0;
+    if( !PyArg_ParseTuple(args, "ssIfs:skyViewFactor", &pszInputImage, &pszOutputFile, &numAzimuths, &maxSearchDist, &pszGDALFormat))
+        return NULL;
+    
+    try
+    {
+        rsgis::cmds::executeCalcSkyViewFactor(std::string(pszInputImage), std::string(pszOutputFile), numAzimuths, maxSearchDist, std::string(pszGDALFormat));
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return NULL;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+static PyObject *Elevation_calcHorizonAngles(PyObject *self, PyObject *args)
+{
+    const char *pszInputImage, *pszOutputFile, *pszGDALFormat;
+    unsigned int numAzimuths = 16;
+    float maxSearchDist = 0;
+    if( !PyArg_ParseTuple(args, "ssIfs:horizonAngles", &pszInputImage, &pszOutputFile, &numAzimuths, &maxSearchDist, &pszGDALFormat))
+        return NULL;
+    
     try
     {
-        rsgis::cmds::executeCalcShadowMask(std::string(pszInputImage), std::string(pszOutputFile), azimuth, zenith, maxHeight, std::string(pszGDALFormat));
+        rsgis::cmds::executeCalcHorizonAngles(std::string(pszInputImage), std::string(pszOutputFile), numAzimuths, maxSearchDist, std::string(pszGDALFormat));
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -309,7 +417,47 @@ static PyMethodDef ElevationMethods[] = {
 ":param outputImage: is a string containing the name and path of the output file.\n"
 ":param solarAzimuth: is a float with the solar azimuth in degrees.\n"
 ":param solarZenith: is a float with the solar zenith in degrees.\n"
-":param maxHeight: is a float with the maximum height for the ray tracing (should be above the maximum elevation within the scene)."
+":param maxHeight: is deprecated and ignored (a DeprecationWarning is raised). Shadows are found with a horizon sweep along the solar azimuth, searched as far as the DEM's elevation range can cast a shadow, so no maximum height is needed. It is kept so existing calls still work.\n"
+":param gdalformat: is a string with the output image format for the GDAL driver.\n"},
+    
+{"terrainDerivatives", Elevation_calcTerrainDerivatives, METH_VARARGS,
+"rsgislib.elevation.terrainDerivatives(inputImage, outputImage, derivatives, solarAzimuth, solarZenith, viewAzimuth, viewZenith, slopeUnit, gdalformat)\n"
+"Calculates several terrain derivatives in a single pass over the DEM, outputting one band per derivative in the order given.\n"
+"\n"
+"Where:\n"
+"\n"
+":param inputImage: is a string containing the name and path of the input DEM file.\n"
+":param outputImage: is a string containing the name and path of the output file.\n"
+":param derivatives: is a list of strings from 'slope', 'aspect', 'hillshade', 'curvature', 'tpi', 'incidence' and 'exitance'.\n"
+":param solarAzimuth: is a float with the solar azimuth in degrees (used for hillshade and incidence).\n"
+":param solarZenith: is a float with the solar zenith in degrees (used for hillshade and incidence).\n"
+":param viewAzimuth: is a float with the view azimuth in degrees (used for exitance).\n"
+":param viewZenith: is a float with the view zenith in degrees (used for exitance).\n"
+":param slopeUnit: is a string specifying the slope output units ('degrees' or 'radians').\n"
+":param gdalformat: is a string with the output image format for the GDAL driver.\n"},
+    
+{"skyViewFactor", Elevation_calcSkyViewFactor, METH_VARARGS,
+"rsgislib.elevation.skyViewFactor(inputImage, outputImage, numAzimuths, maxSearchDist, gdalformat)\n"
+"Calculates the sky view factor (0-1) of each pixel from the terrain horizons in numAzimuths directions.\n"
+"\n"
+"Where:\n"
+"\n"
+":param inputImage: is a string containing the name and path of the input DEM file.\n"
+":param outputImage: is a string containing the name and path of the output file.\n"
+":param numAzimuths: is an unsigned int with the number of azimuths sampled (e.g., 16).\n"
+":param maxSearchDist: is a float with the distance (in the units of the DEM projection) searched for the horizon. The DEM is processed in strips with a halo of this distance; 0 searches the whole DEM, which is then read into memory.\n"
+":param gdalformat: is a string with the output image format for the GDAL driver.\n"},
+    
+{"horizonAngles", Elevation_calcHorizonAngles, METH_VARARGS,
+"rsgislib.elevation.horizonAngles(inputImage, outputImage, numAzimuths, maxSearchDist, gdalformat)\n"
+"Calculates the elevation angle (degrees) of the terrain horizon for numAzimuths directions, clockwise from north, with one output band per direction.\n"
+"\n"
+"Where:\n"
+"\n"
+":param inputImage: is a string containing the name and path of the input DEM file.\n"
+":param outputImage: is a string containing the name and path of the output file.\n"
+":param numAzimuths: is an unsigned int with the number of azimuths.\n"
+":param maxSearchDist: is a float with the distance (in the units of the DEM projection) searched for the horizon. The DEM is processed in strips with a halo of this distance; 0 searches the whole DEM, which is then read into memory.\n"
 ":param gdalformat: is a string with the output image format for the GDAL driver.\n"},
     
     
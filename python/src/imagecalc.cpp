@@ -709,6 +709,156 @@ static PyObject *ImageCalc_PCA(PyObject *self, PyObject *args)
     Py_RETURN_NONE;
 }
 
+static PyObject *ImageCalc_ImagePCA(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {"inputimg", "outputimg", "outeigenvecfile", "ncomponents", "mnf", "sampleratio", "nodataval", "gdalformat", "datatype", NULL};
+    const char *pszInputImage, *pszOutputImage, *pszEigenVecFile;
+    const char *pszGDALFormat = "KEA";
+    unsigned int numComponents = 0;
+    int calcMNF = 0;
+    float sampleRatio = 1.0;
+    PyObject *pNoDataVal = Py_None;
+    int nDataType = 9;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sss|IifOsi:imagePCA", kwlist, &pszInputImage, &pszOutputImage, &pszEigenVecFile, &numComponents, &calcMNF, &sampleRatio, &pNoDataVal, &pszGDALFormat, &nDataType))
+    {
+        return NULL;
+    }
+    
+    bool useNoData = false;
+    float noDataVal = 0.0;
+    if(pNoDataVal != Py_None)
+    {
+        PyObject *pNoDataFloat = PyNumber_Float(pNoDataVal);
+        if(pNoDataFloat == NULL)
+        {
+            PyErr_SetString(GETSTATE(self)->error, "The no data value must be a number or None");
+            return NULL;
+        }
+        useNoData = true;
+        noDataVal = PyFloat_AsDouble(pNoDataFloat);
+        Py_DECREF(pNoDataFloat);
+    }
+    
+    std::vector<double> eigenvalues;
+    try
+    {
+        rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
+        eigenvalues = rsgis::cmds::executeImagePCA(std::string(pszInputImage), std::string(pszOutputImage), std::string(pszEigenVecFile), numComponents, (bool)calcMNF, sampleRatio, useNoData, noDataVal, std::string(pszGDALFormat), type);
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return NULL;
+    }
+    
+    PyObject *pEigenvalues = PyList_New(eigenvalues.size());
+    for(size_t i = 0; i < eigenvalues.size(); ++i)
+    {
+        PyList_SetItem(pEigenvalues, i, PyFloat_FromDouble(eigenvalues[i]));
+    }
+    return pEigenvalues;
+}
+
+static PyObject *ImageCalc_SmoothTimeSeriesSG(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {"inputimgs", "imgbands", "imgtimes", "outputimg", "order", "window", "nodataval", "gdalformat", "datatype", NULL};
+    PyObject *inImagesObj, *imageBandsObj, *imageTimesObj;
+    const char *pszOutputImage;
+    const char *pszGDALFormat = "KEA";
+    unsigned int order = 3;
+    unsigned int window = 2;
+    PyObject *pNoDataVal = Py_None;
+    int nDataType = 9;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "OOOs|IIOsi:smoothTimeSeriesSG", kwlist, &inImagesObj, &imageBandsObj, &imageTimesObj, &pszOutputImage, &order, &window, &pNoDataVal, &pszGDALFormat, &nDataType))
+    {
+        return NULL;
+    }
+    
+    if( !PySequence_Check(inImagesObj) || !PySequence_Check(imageBandsObj) || !PySequence_Check(imageTimesObj))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "first three arguments must be sequences");
+        return NULL;
+    }
+    
+    Py_ssize_t nImages = PySequence_Size(inImagesObj);
+    if((PySequence_Size(imageBandsObj) != nImages) || (PySequence_Size(imageTimesObj) != nImages))
+    {
+        PyErr_SetString(GETSTATE(self)->error, "A band and a time must be given for every input image");
+        return NULL;
+    }
+    
+    std::vector<std::string> inputImages;
+    std::vector<unsigned int> imageBands;
+    std::vector<double> imageTimes;
+    for(Py_ssize_t i = 0; i < nImages; ++i)
+    {
+        PyObject *inImageObj = PySequence_GetItem(inImagesObj, i);
+        PyObject *imageBandObj = PySequence_GetItem(imageBandsObj, i);
+        PyObject *imageTimeObj = PySequence_GetItem(imageTimesObj, i);
+        PyObject *imageTimeFloat = PyNumber_Float(imageTimeObj);
+        
+        bool failedCheck = false;
+        if(!RSGISPY_CHECK_STRING(inImageObj))
+        {
+            failedCheck = true;
+            PyErr_SetString(GETSTATE(self)->error, "Input images must be strings");
+        }
+        else if(!RSGISPY_CHECK_INT(imageBandObj))
+        {
+            failedCheck = true;
+            PyErr_SetString(GETSTATE(self)->error, "Image bands must be integers");
+        }
+        else if(imageTimeFloat == NULL)
+        {
+            failedCheck = true;
+            PyErr_SetString(GETSTATE(self)->error, "Image times must be numbers");
+        }
+        else
+        {
+            inputImages.push_back(RSGISPY_STRING_EXTRACT(inImageObj));
+            imageBands.push_back(RSGISPY_INT_EXTRACT(imageBandObj));
+            imageTimes.push_back(PyFloat_AsDouble(imageTimeFloat));
+        }
+        
+        Py_DECREF(inImageObj);
+        Py_DECREF(imageBandObj);
+        Py_DECREF(imageTimeObj);
+        Py_XDECREF(imageTimeFloat);
+        if(failedCheck)
+        {
+            return NULL;
+        }
+    }
+    
+    bool useNoData = false;
+    float noDataVal = 0.0;
+    if(pNoDataVal != Py_None)
+    {
+        PyObject *pNoDataFloat = PyNumber_Float(pNoDataVal);
+        if(pNoDataFloat == NULL)
+        {
+            PyErr_SetString(GETSTATE(self)->error, "The no data value must be a number or None");
+            return NULL;
+        }
+        useNoData = true;
+        noDataVal = PyFloat_AsDouble(pNoDataFloat);
+        Py_DECREF(pNoDataFloat);
+    }
+    
+    try
+    {
+        rsgis::RSGISLibDataType type = (rsgis::RSGISLibDataType)nDataType;
+        rsgis::cmds::executeSmoothTimeSeriesSG(inputImages, imageBands, imageTimes, std::string(pszOutputImage), order, window, useNoData, noDataVal, std::string(pszGDALFormat), type);
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return NULL;
+    }
+    
+    Py_RETURN_NONE;
+}
+
 static PyObject *ImageCalc_Standardise(PyObject *self, PyObject *args) {
     const char *meanVector, *inputImage, *outputImage;
 
@@ -2424,6 +2574,61 @@ static PyMethodDef ImageCalcMethods[] = {
 "\n"
 },
 
+{"imagePCA", (PyCFunction)ImageCalc_ImagePCA, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imagecalc.imagePCA(inputimg, outputimg, outeigenvecfile, ncomponents=0, mnf=False, sampleratio=1.0, nodataval=None, gdalformat='KEA', datatype=rsgislib.TYPE_32FLOAT)\n"
+"Calculates a principal components (or minimum noise fraction) transform of an image and applies it.\n"
+"The mean and covariance are accumulated in a single pass over the image and the transform is applied\n"
+"in a second pass, so the image does not need to fit in memory. The output components are mean centred.\n"
+"For the MNF the noise covariance is estimated from the differences between horizontally adjacent pixels.\n"
+"\n"
+"Where:\n"
+"\n"
+":param inputimg: is a string containing the name of the input image file\n"
+":param outputimg: is a string containing the name of the output image file\n"
+":param outeigenvecfile: is a string containing the name of the output matrix file for the eigenvectors (one per row). Use an empty string to not save them.\n"
+":param ncomponents: is an int with the number of components to output (0 outputs all components).\n"
+":param mnf: is a boolean specifying that a minimum noise fraction transform is calculated rather than a PCA.\n"
+":param sampleratio: is a float (0-1] with the proportion of pixels used to calculate the covariance.\n"
+":param nodataval: is a float with the no data value; pixels where all bands are this value are ignored (None to use all pixels).\n"
+":param gdalformat: is a string containing the GDAL format for the output file - eg 'KEA'\n"
+":param datatype: is an int containing one of the values from rsgislib.TYPE_*\n"
+":return: list of eigenvalues, one per component.\n"
+"\n"
+"Example::\n"
+"\n"
+"   import rsgislib\n"
+"   import rsgislib.imagecalc\n"
+"   eigenvals = rsgislib.imagecalc.imagePCA('Input.kea', 'PCA.kea', 'EigenVec.mtxt', ncomponents=10, sampleratio=0.1, nodataval=0)\n"
+"\n"
+},
+
+{"smoothTimeSeriesSG", (PyCFunction)ImageCalc_SmoothTimeSeriesSG, METH_VARARGS | METH_KEYWORDS,
+"rsgislib.imagecalc.smoothTimeSeriesSG(inputimgs, imgbands, imgtimes, outputimg, order=3, window=2, nodataval=None, gdalformat='KEA', datatype=rsgislib.TYPE_32FLOAT)\n"
+"Smooths a time series of images with a Savitzky-Golay filter, allowing for irregular acquisition dates and gaps.\n"
+"The input can be a list of single date images or the bands of a stacked image (the same file listed for each band).\n"
+"The output image has one band per input date and gaps (no data) are filled by the fitted polynomial.\n"
+"\n"
+"Where:\n"
+"\n"
+":param inputimgs: is a list of strings with the input image files, one per date.\n"
+":param imgbands: is a list of ints with the band (starting at 1) of each image to use.\n"
+":param imgtimes: is a list of floats with the time of each image (e.g., day of year).\n"
+":param outputimg: is a string containing the name of the output image file.\n"
+":param order: is an int with the number of polynomial coefficients (i.e., 3 is quadratic).\n"
+":param window: is an int with the number of valid observations used either side of each date.\n"
+":param nodataval: is a float with the no data value of the inputs, which is also used for the output (None to use all values).\n"
+":param gdalformat: is a string containing the GDAL format for the output file - eg 'KEA'\n"
+":param datatype: is an int containing one of the values from rsgislib.TYPE_*\n"
+"\n"
+"Example::\n"
+"\n"
+"   import rsgislib\n"
+"   import rsgislib.imagecalc\n"
+"   imgs = ['NDVI_20150101.kea', 'NDVI_20150117.kea', 'NDVI_20150305.kea', 'NDVI_20150321.kea', 'NDVI_20150406.kea']\n"
+"   rsgislib.imagecalc.smoothTimeSeriesSG(imgs, [1]*5, [1, 17, 64, 80, 96], 'NDVI_SG.kea', order=3, window=2, nodataval=0)\n"
+"\n"
+},
+
 {"standardise", ImageCalc_Standardise, METH_VARARGS,
 "rsgislib.imagecalc.standardise(meanVector, inputImage, outputImage)\n"
 "Generates a standardised image using the mean vector provided\n"
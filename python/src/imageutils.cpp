@@ -1642,15 +1642,16 @@ static PyObject *ImageUtils_PerformRandomPxlSampleSmallPxlCount(PyObject *self,
 
 static PyObject *ImageUtils_PanSharpenHCS(PyObject *self, PyObject *args, PyObject *keywds)
 {
-    static char *kwlist[] = {"inimage", "outimage", "gdalformat", "datatype", "winsize", "useNaiveMethod", NULL};
+    static char *kwlist[] = {"inimage", "outimage", "gdalformat", "datatype", "winsize", "useNaiveMethod", "panimage", NULL};
     const char *pszInputImage = "";
     const char *pszOutputImage = "";
     const char *pszGDALFormat = "";
+    const char *pszPanImage = "";
     int nDataType;
     unsigned int winSize = 7;
     int useNaiveMethInt = false;
     
-    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssi|Ii:panSharpenHCS", kwlist, &pszInputImage, &pszOutputImage, &pszGDALFormat, &nDataType, &winSize, &useNaiveMethInt))
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sssi|Iis:panSharpenHCS", kwlist, &pszInputImage, &pszOutputImage, &pszGDALFormat, &nDataType, &winSize, &useNaiveMethInt, &pszPanImage))
     {
         return NULL;
     }
@@ -1660,7 +1661,15 @@ static PyObject *ImageUtils_PanSharpenHCS(PyObject *self, PyObject *args, PyObje
     try
     {
         bool useNaiveMeth = (bool)useNaiveMethInt;
-        rsgis::cmds::executePerformHCSPanSharpen(std::string(pszInputImage), std::string(pszOutputImage), std::string(pszGDALFormat), type, winSize, useNaiveMeth);
+        std::string panImage = std::string(pszPanImage);
+        if(panImage == "")
+        {
+            rsgis::cmds::executePerformHCSPanSharpen(std::string(pszInputImage), std::string(pszOutputImage), std::string(pszGDALFormat), type, winSize, useNaiveMeth);
+        }
+        else
+        {
+            rsgis::cmds::executePerformHCSPanSharpenImgs(std::string(pszInputImage), panImage, std::string(pszOutputImage), std::string(pszGDALFormat), type, winSize, useNaiveMeth);
+        }
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -3045,7 +3054,7 @@ For example, can be used to produce monthly composite images from a stack with i
 "\n"},
     
 {"panSharpenHCS", (PyCFunction)ImageUtils_PanSharpenHCS, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.imageutils.panSharpenHCS(inimage=string, outimage=string, gdalformat=string, datatype=int, winsize=unsigned int, useNaiveMethod=boolean)\n"
+"rsgislib.imageutils.panSharpenHCS(inimage=string, outimage=string, gdalformat=string, datatype=int, winsize=unsigned int, useNaiveMethod=boolean, panimage=string)\n"
 "A function which performs a Hyperspherical Colour Space (HSC) Pan Sharpening of an input image.\n"
 "Padwick, C., Deskevich, M., Pacifici, F., Smallwood, S. 2010. WorldView-2 Pan-Sharpening.\n"
 "ASPRS 2010 Annual Conference, San Diego, California (2010) pp. 26-30.\n"
@@ -3058,6 +3067,7 @@ For example, can be used to produce monthly composite images from a stack with i
 ":param datatype: is an containing one of the values from rsgislib.TYPE_*\n"
 ":param winsize: is an optional integer, which must be an odd number, specifying the window size used for the analysis (Default = 7; Only used if useNaiveMethod=False).\n"
 ":param useNaiveMethod: is an optional boolean option to specify whether the naive or smart method should be used - False=Smart (Default), True=Naive Method.\n"
+":param panimage: is an optional string for a separate panchromatic image (first band used). If provided, inimage only contains the multispectral bands, which are resampled (bilinear) to the pan image on the fly so no resampled stack is needed.\n"
 "\n"
 "\nExample::\n"
 "\n"
@@ -3072,6 +3082,10 @@ For example, can be used to produce monthly composite images from a stack with i
 "\n"
 "    rsgislib.imageutils.panSharpenHCS(inimage='StackPanImg.kea', outimage='StackPanImgSharp.kea', gdalformat='KEA', datatype=rsgislib.TYPE_16UINT)\n"
 "\n"
+"    # or without creating the stack\n"
+"    rsgislib.imageutils.panSharpenHCS(inimage='./14SEP03025718-M2AS-054000253010_01_P001.TIF', outimage='StackPanImgSharp.kea', gdalformat='KEA', datatype=rsgislib.TYPE_16UINT,\n"
+"                                      panimage='./14SEP03025718-P2AS-054000253010_01_P001.TIF')\n"
+"\n"
 "    rsgislib.imageutils.popImageStats('StackPanImgSharp.kea', usenodataval=True, nodataval=0, calcpyramids=True)\n"
 "\n"
 "\n"},
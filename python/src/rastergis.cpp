@@ -206,14 +206,40 @@ static PyObject *RasterGIS_SpatialExtent(PyObject *self, PyObject *args, PyObjec
     Py_RETURN_NONE;
 }
 
+static PyObject *RasterGIS_SpatialPxlBBox(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    const char *inputImage, *minXCol, *maxXCol, *minYCol, *maxYCol;
+    const char *blocksCol = "";
+    unsigned int ratBand = 1;
+    static char *kwlist[] = {"clumps", "minX", "maxX", "minY", "maxY", "blocks", "ratband", NULL};
+    
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "sssss|sI:spatialPxlBBox", kwlist, &inputImage, &minXCol, &maxXCol, &minYCol, &maxYCol, &blocksCol, &ratBand))
+    {
+        return NULL;
+    }
+    
+    try
+    {
+        rsgis::cmds::executeSpatialLocationPxlBBox(std::string(inputImage), ratBand, std::string(minXCol), std::string(maxXCol), std::string(minYCol), std::string(maxYCol), std::string(blocksCol));
+    }
+    catch (rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return NULL;
+    }
+    
+    Py_RETURN_NONE;
+}
+
 static PyObject *RasterGIS_PopulateRATWithStats(PyObject *self, PyObject *args, PyObject *keywds)
 {
     const char *inputImage, *clumpsImage;
     PyObject *pBandAttStatsCmds;
     unsigned int ratBand = 1;
-    static char *kwlist[] = {"valsimage", "clumps", "bandstats", "ratband", NULL};
+    const char *changesCol = "";
+    static char *kwlist[] = {"valsimage", "clumps", "bandstats", "ratband", "changescol", NULL};
 
-    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ssO|I:populateRATWithStats", kwlist, &inputImage, &clumpsImage, &pBandAttStatsCmds, &ratBand))
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ssO|Is:populateRATWithStats", kwlist, &inputImage, &clumpsImage, &pBandAttStatsCmds, &ratBand, &changesCol))
     {
         return NULL;
     }
@@ -305,7 +331,7 @@ static PyObject *RasterGIS_PopulateRATWithStats(PyObject *self, PyObject *args,
 
     try
     {
-        rsgis::cmds::executePopulateRATWithStats(std::string(inputImage), std::string(clumpsImage), &bandStatsCmds, ratBand);
+        rsgis::cmds::executePopulateRATWithStats(std::string(inputImage), std::string(clumpsImage), &bandStatsCmds, ratBand, std::string(changesCol));
     }
     catch (rsgis::cmds::RSGISCmdException &e)
     {
@@ -1400,15 +1426,16 @@ static PyObject *RasterGIS_RegionGrowClass(PyObject *self, PyObject *args)
     const char *clumpsImage, *xmlBlock, *classColumn, *classVal;
     unsigned int ratBand = 1;
     int maxNumIter = -1;
+    const char *changesCol = "";
     
-    if(!PyArg_ParseTuple(args, "ssss|iI:regionGrowClass", &clumpsImage, &xmlBlock, &classColumn, &classVal, &maxNumIter, &ratBand))
+    if(!PyArg_ParseTuple(args, "ssss|iIs:regionGrowClass", &clumpsImage, &xmlBlock, &classColumn, &classVal, &maxNumIter, &ratBand, &changesCol))
     {
         return NULL;
     }
     
     try
     {
-        rsgis::cmds::executeClassRegionGrowing(std::string(clumpsImage), ratBand, std::string(classColumn), std::string(classVal), maxNumIter, std::string(xmlBlock));
+        rsgis::cmds::executeClassRegionGrowing(std::string(clumpsImage), ratBand, std::string(classColumn), std::string(classVal), maxNumIter, std::string(xmlBlock), std::string(changesCol));
     }
     catch (rsgis::cmds::RSGISCmdException &e)
     {
@@ -1702,10 +1729,11 @@ static PyObject *RasterGIS_ApplyKNN(PyObject *self, PyObject *args, PyObject *ke
     float distThreshold = 100000;
     int distKNNInt = rsgis::cmds::rsgisKNNMahalanobis;
     int summeriseKNNInt = rsgis::cmds::rsgisKNNMean;
+    float minkowskiP = 3;
     
-    static char *kwlist[] = {"clumps", "inExtrapField", "outExtrapField", "trainRegionsField", "applyRegionsField", "fields", "kFeat", "distKNN", "summeriseKNN", "distThres", "ratband", NULL};
+    static char *kwlist[] = {"clumps", "inExtrapField", "outExtrapField", "trainRegionsField", "applyRegionsField", "fields", "kFeat", "distKNN", "summeriseKNN", "distThres", "ratband", "minkowskiP", NULL};
     
-    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ssssOO|IiifI:applyKNN", kwlist, &inClumpsImage, &inExtrapField, &outExtrapField, &trainRegionsField, &applyRegionsFieldObj, &pFields, &kFeatures, &distKNNInt, &summeriseKNNInt, &distThreshold, &ratBand))
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ssssOO|IiifIf:applyKNN", kwlist, &inClumpsImage, &inExtrapField, &outExtrapField, &trainRegionsField, &applyRegionsFieldObj, &pFields, &kFeatures, &distKNNInt, &summeriseKNNInt, &distThreshold, &ratBand, &minkowskiP))
     {
         return NULL;
     }
@@ -1735,7 +1763,7 @@ static PyObject *RasterGIS_ApplyKNN(PyObject *self, PyObject *args, PyObject *ke
         rsgis::cmds::rsgisKNNDistCmd distKNN = static_cast<rsgis::cmds::rsgisKNNDistCmd>(distKNNInt);
         rsgis::cmds::rsgisKNNSummeriseCmd summeriseKNN = static_cast<rsgis::cmds::rsgisKNNSummeriseCmd>(summeriseKNNInt);
         
-        rsgis::cmds::executeApplyKNN(std::string(inClumpsImage), ratBand, std::string(inExtrapField), std::string(outExtrapField), std::string(trainRegionsField), applyRegionsField, applyRegions, fields, kFeatures, distKNN, distThreshold, summeriseKNN);
+        rsgis::cmds::executeApplyKNN(std::string(inClumpsImage), ratBand, std::string(inExtrapField), std::string(outExtrapField), std::string(trainRegionsField), applyRegionsField, applyRegions, fields, kFeatures, distKNN, distThreshold, summeriseKNN, minkowskiP);
     }
     catch (rsgis::cmds::RSGISCmdException &e)
     {
@@ -1984,17 +2012,22 @@ static PyObject *RasterGIS_ExportClumps2Images(PyObject *self, PyObject *args, P
     const char *inputImage, *outputBaseName, *outFileExt, *imageFormat;
     int binaryOut = false;
     int ratBand = 1;
+    const char *minXCol = "";
+    const char *maxXCol = "";
+    const char *minYCol = "";
+    const char *maxYCol = "";
+    const char *blocksCol = "";
     
-    static char *kwlist[] = {"clumps", "outimgbase", "binout", "outimgext", "gdalformat", "ratband", NULL};
+    static char *kwlist[] = {"clumps", "outimgbase", "binout", "outimgext", "gdalformat", "ratband", "minX", "maxX", "minY", "maxY", "blocks", NULL};
     
-    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ssiss|i:exportClumps2Images", kwlist, &inputImage, &outputBaseName, &binaryOut, &outFileExt, &imageFormat, &ratBand))
+    if(!PyArg_ParseTupleAndKeywords(args, keywds, "ssiss|isssss:exportClumps2Images", kwlist, &inputImage, &outputBaseName, &binaryOut, &outFileExt, &imageFormat, &ratBand, &minXCol, &maxXCol, &minYCol, &maxYCol, &blocksCol))
     {
         return NULL;
     }
     
     try
     {
-        rsgis::cmds::executeExportClumps2Images(std::string(inputImage), std::string(outputBaseName), std::string(outFileExt), std::string(imageFormat), (bool)binaryOut, ratBand);
+        rsgis::cmds::executeExportClumps2Images(std::string(inputImage), std::string(outputBaseName), std::string(outFileExt), std::string(imageFormat), (bool)binaryOut, ratBand, std::string(minXCol), std::string(maxXCol), std::string(minYCol), std::string(maxYCol), std::string(blocksCol));
     }
     catch (rsgis::cmds::RSGISCmdException &e)
     {
@@ -2131,10 +2164,31 @@ static PyMethodDef RasterGISMethods[] = {
 "   maxY_X = 'maxYX'\n"
 "   maxY_Y = 'maxYY'\n"
 "   rastergis.spatialExtent(image, minX_X, minX_Y, maxX_X, maxX_Y, minY_X, minY_Y, maxY_X, maxY_Y)\n"
+"\n"},
+
+{"spatialPxlBBox", (PyCFunction)RasterGIS_SpatialPxlBBox, METH_VARARGS | METH_KEYWORDS,
+"rastergis.spatialPxlBBox(clumps=string, minX=string, maxX=string, minY=string, maxY=string, blocks=string, ratband=int)\n"
+"Adds the pixel bounding box of each clump to the attribute table, which can be used by exportClumps2Images.\n"
+"\n"
+"Where:\n"
+"\n"
+":param clumps: is a string containing the name of the input clumps image file\n"
+":param minX: is a string containing the name of the min X pixel field\n"
+":param maxX: is a string containing the name of the max X pixel field\n"
+":param minY: is a string containing the name of the min Y pixel field\n"
+":param maxY: is a string containing the name of the max Y pixel field\n"
+":param blocks: is an optional string with the name of a field for the image blocks each clump occupies (Optional, default = '' not calculated)\n"
+":param ratband: is an integer containing the band number for the RAT (Optional, default = 1)\n"
+"\n"
+"Example::\n"
+"\n"
+"   from rsgislib import rastergis\n"
+"   clumps = 'injune_p142_casi_sub_utm_segs.kea'\n"
+"   rastergis.spatialPxlBBox(clumps, 'MinXPxl', 'MaxXPxl', 'MinYPxl', 'MaxYPxl', blocks='PxlBlocks')\n"
 "\n"},
 
     {"populateRATWithStats", (PyCFunction)RasterGIS_PopulateRATWithStats, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.rastergis.populateRATWithStats(valsimage=string, clumps=string, bandstats=rsgislib.rastergis.BandAttStats, ratband=int)\n"
+"rsgislib.rastergis.populateRATWithStats(valsimage=string, clumps=string, bandstats=rsgislib.rastergis.BandAttStats, ratband=int, changescol=string)\n"
 "Populates an attribute table with statistics from an input values image.\n"
 "\n"
 "Where:\n"
@@ -2149,6 +2203,7 @@ static PyMethodDef RasterGISMethods[] = {
 "        * meanField: string defining the name of the field for mean value\n"
 "        * stdDevField: string defining the name of the field for standard deviation value\n"
 "* ratband is an optional (default = 1) integer parameter specifying the image band to which the RAT is associated.\n"
+"* changescol is an optional (default = '') string with the name of a column recording the clumps changed since the statistics were calculated (see rsgislib.segmentation.rmSmallClumpsStepwise, rsgislib.segmentation.mergeSegments2Neighbours and rsgislib.rastergis.regionGrowClass). Only the rows of those clumps are recalculated, reading only the image blocks containing them. If the column does not exist all the clumps are calculated. The column is then cleared, so use one column for each set of statistics columns.\n"
 "\n"
 "Example::\n"
 "\n"
@@ -2608,7 +2663,7 @@ static PyMethodDef RasterGISMethods[] = {
 ":param selectField: is a string which defines the column name where a value of 1 defines the clumps which will be included in the analysis.\n"
 ":param eastingsField: is a string which defines a column with a eastings for each clump.\n"
 ":param northingsField: is a string which defines a column with a northings for each clump.\n"
-":param methodStr: is a string which defines a column with a value for each clump which will be used for the distance, nearestneighbour or naturalneighbour or naturalnearestneighbour or knearestneighbour or idwall anaylsis.\n"
+":param methodStr: is a string which defines a column with a value for each clump which will be used for the distance, nearestneighbour or naturalneighbour or naturalnearestneighbour or lineartin (linear within the triangulation) or knearestneighbour or idwall anaylsis.\n"
 ":param valueField: is a string which defines a column containing the values to be interpolated creating the new image.\n"
 ":param outputFile: is a string for the path to the output image file.\n"
 ":param gdalformat: is string defining the GDAL format of the output image.\n"
@@ -2679,7 +2734,7 @@ static PyMethodDef RasterGISMethods[] = {
 "\n"},
     
 {"regionGrowClass", RasterGIS_RegionGrowClass, METH_VARARGS,
-"rsgislib.rastergis.regionGrowClass(clumpsImage, xmlBlock, classColumn, classVal, maxNumIter, ratBand)\n"
+"rsgislib.rastergis.regionGrowClass(clumpsImage, xmlBlock, classColumn, classVal, maxNumIter, ratBand, changesCol)\n"
 "Using a logical expression a class (classVal) defined within the classColumn is grown until.\n"
 "either the maximum number of iterations (maxNumIter) is reached or there all clumps meeting the\n"
 "criteria have been met (set maxNumIter to be -1).\n"
@@ -2692,6 +2747,7 @@ static PyMethodDef RasterGISMethods[] = {
 ":param classVal: is a string with the name of the class to be grown\n"
 ":param maxNumIter: is the maximum number of iterations to used for the growth (optional; default is -1, i.e., no max number of iterations\n"
 ":param ratBand: is an (optional; default 1) integer with the image band with which the RAT is associated.\n"
+":param changesCol: is an (optional; default '') string with the name of a column in which the reclassified clumps are recorded (see rsgislib.rastergis.populateRATWithStats). If the column does not exist all the clumps are recorded as changed.\n"
 "\n"
 "Example::\n"
 "\n"
@@ -2851,7 +2907,7 @@ static PyMethodDef RasterGISMethods[] = {
 "\n"},
 
 {"applyKNN", (PyCFunction)RasterGIS_ApplyKNN, METH_VARARGS | METH_KEYWORDS,
-"rsgislib.rastergis.applyKNN(clumps=string, inExtrapField=string, outExtrapField=string, trainRegionsField=string, applyRegionsField=string, fields=list<string>, kFeat=uint, distKNN=int, summeriseKNN=int, distThres=float, ratband=int)\n"
+"rsgislib.rastergis.applyKNN(clumps=string, inExtrapField=string, outExtrapField=string, trainRegionsField=string, applyRegionsField=string, fields=list<string>, kFeat=uint, distKNN=int, summeriseKNN=int, distThres=float, ratband=int, minkowskiP=float)\n"
 "This function uses the KNN algorithm to allow data values to be extrapolated to segments.\n"
 "\n"
 "Where:\n"
@@ -2863,10 +2919,11 @@ static PyMethodDef RasterGISMethods[] = {
 ":param applyRegionsField: is a string containing the name of the field specifying the regions for which KNN is to be applued - binary column (1 == regions to be calculated). If None then ignored and applied to all."
 ":param fields: is a list of strings specifying the fields which will be used to calculate distance.\n"
 ":param kFeat: is an unsigned integer specifying the number of nearest features (i.e., K) to be used (Default: 12) \n"
-":param distKNN: specifies how the distance to identify NN is calculated (rsgislib.DIST_EUCLIDEAN, rsgislib.DIST_MANHATTEN, rsgislib.DIST_MAHALANOBIS, rsgislib.DIST_MINKOWSKI, rsgislib.DIST_CHEBYSHEV; Default: rsgislib.DIST_MAHALANOBIS).\n"
+":param distKNN: specifies how the distance to identify NN is calculated (rsgislib.DIST_EUCLIDEAN, rsgislib.DIST_MANHATTEN, rsgislib.DIST_MAHALANOBIS, rsgislib.DIST_MINKOWSKI (of order minkowskiP), rsgislib.DIST_CHEBYSHEV; Default: rsgislib.DIST_MAHALANOBIS).\n"
 ":param summeriseKNN: specifies how the extrapolation value is calculated (rsgislib.SUMTYPE_MODE, rsgislib.SUMTYPE_MEAN, rsgislib.SUMTYPE_MEDIAN, rsgislib.SUMTYPE_MIN, rsgislib.SUMTYPE_MAX, rsgislib.SUMTYPE_STDDEV; Default: rsgislib.SUMTYPE_MEDIAN). Mode is used for classification.\n"
 ":param distThres: is a maximum distance threshold over which features will not be included within the \'k\'.\n"
 ":param ratband: is an optional (default = 1) integer parameter specifying the image band to which the RAT is associated.\n"
+":param minkowskiP: is the order (>= 1) of the Minkowski distance, (sum(|a-b|^p))^(1/p), used when distKNN is rsgislib.DIST_MINKOWSKI (Default: 3).\n"
 "\n"
 "Example::\n"
 "\n"
@@ -3015,7 +3072,7 @@ static PyMethodDef RasterGISMethods[] = {
 ":return: double for distance\n"
 "\n"},
 {"exportClumps2Images", (PyCFunction)RasterGIS_ExportClumps2Images, METH_VARARGS | METH_KEYWORDS,
-"rastergis.exportClumps2Images(clumps, outimgbase, binout, outimgext, gdalformat, ratband=1)\n"
+"rastergis.exportClumps2Images(clumps, outimgbase, binout, outimgext, gdalformat, ratband=1, minX='', maxX='', minY='', maxY='', blocks='')\n"
 "Exports each clump to a seperate raster which is the minimum extent for the clump.\n"
 "\n"
 "Where:\n"
@@ -3026,6 +3083,8 @@ static PyMethodDef RasterGISMethods[] = {
 ":param binout: is a boolean specifying whether the output images should be binary or if the pixel value should be the FID of the clump.\n"
 ":param gdalformat: is a string containing the GDAL format for the output file - eg 'KEA'\n"
 ":param ratband: is an optional (default = 1) integer parameter specifying the image band to which the RAT is associated.\n"
+":param minX, maxX, minY, maxY: are optional names of the pixel bounding box fields (see spatialPxlBBox). If given and valid they are used rather than building the index from the image.\n"
+":param blocks: is an optional name of the field with the image blocks each clump occupies (see spatialPxlBBox).\n"
 "\n"
 "Example::\n"
 "\n"
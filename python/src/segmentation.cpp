@@ -137,14 +137,15 @@ static PyObject *Segmentation_RMSmallClumpsStepwise(PyObject *self, PyObject *ar
     int storeMean,processInMemory,stretchStatsAvail;
     unsigned int minClumpSize;
     float specThreshold;                   
-    if( !PyArg_ParseTuple(args, "ssssisiiIf:rmSmallClumpsStepwise", &pszInputImage, &pszClumpsImage, &pszOutputImage, &pszgdalformat,
-                    &stretchStatsAvail, &pszStretchStatsFile, &storeMean, &processInMemory, &minClumpSize, &specThreshold))            
+    const char *pszChangesCol = "";
+    if( !PyArg_ParseTuple(args, "ssssisiiIf|s:rmSmallClumpsStepwise", &pszInputImage, &pszClumpsImage, &pszOutputImage, &pszgdalformat,
+                    &stretchStatsAvail, &pszStretchStatsFile, &storeMean, &processInMemory, &minClumpSize, &specThreshold, &pszChangesCol))            
         return NULL;
     
     try
     {
         rsgis::cmds::executeRMSmallClumpsStepwise(pszInputImage, pszClumpsImage, pszOutputImage, pszgdalformat,
-                                stretchStatsAvail, pszStretchStatsFile, storeMean, processInMemory, minClumpSize, specThreshold);
+                                stretchStatsAvail, pszStretchStatsFile, storeMean, processInMemory, minClumpSize, specThreshold, pszChangesCol);
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -351,6 +352,49 @@ static PyObject *Segmentation_mergeClumpImages(PyObject *self, PyObject *args)
 }
 
 
+static PyObject *Segmentation_tiledSegmentation(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwlist[] = {"inputimg", "outputimg", "clustercentres", "minpxls", "distthres", "gdalformat", "stretchstats", "tilexsize", "tileysize", "tileoverlap", "nthreads", NULL};
+    const char *pszInputImage, *pszOutputImage, *pszClusterCentres;
+    const char *pszGDALFormat = "KEA";
+    unsigned int minClumpSize = 100;
+    float specThreshold = 100;
+    PyObject *pStretchStats = Py_None;
+    unsigned int tileXSize = 2000;
+    unsigned int tileYSize = 2000;
+    unsigned int tileOverlap = 100;
+    unsigned int numThreads = 0;
+    if( !PyArg_ParseTupleAndKeywords(args, keywds, "sss|IfsOIIII:tiledSegmentation", kwlist, &pszInputImage, &pszOutputImage, &pszClusterCentres, &minClumpSize, &specThreshold, &pszGDALFormat, &pStretchStats, &tileXSize, &tileYSize, &tileOverlap, &numThreads))
+    {
+        return NULL;
+    }
+    
+    bool stretchStatsAvail = false;
+    std::string stretchStatsFile = "";
+    if(pStretchStats != Py_None)
+    {
+        if(!RSGISPY_CHECK_STRING(pStretchStats))
+        {
+            PyErr_SetString(GETSTATE(self)->error, "The stretch stats file must be a string or None");
+            return NULL;
+        }
+        stretchStatsAvail = true;
+        stretchStatsFile = RSGISPY_STRING_EXTRACT(pStretchStats);
+    }
+    
+    try
+    {
+        rsgis::cmds::executeTiledSegmentation(std::string(pszInputImage), std::string(pszOutputImage), std::string(pszClusterCentres), minClumpSize, specThreshold, std::string(pszGDALFormat), stretchStatsAvail, stretchStatsFile, tileXSize, tileYSize, tileOverlap, numThreads);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return NULL;
+    }
+    
+    Py_RETURN_NONE;
+}
+
 static PyObject *Segmentation_findTileBordersMask(PyObject *self, PyObject *args)
 {
     const char *pszBorderMaskImage, *pszColsName;
@@ -446,6 +490,26 @@ static PyObject *Segmentation_meanImage(PyObject *self, PyObject *args)
 }
 
 
+static PyObject *Segmentation_populateRATMeans(PyObject *self, PyObject *args)
+{
+    const char *pszInputImage, *pszInputClumps;
+    if( !PyArg_ParseTuple(args, "ss:populateRATMeans", &pszInputImage, &pszInputClumps))
+        return NULL;
+    
+    try
+    {
+        rsgis::cmds::executePopulateRATMeans(pszInputImage, pszInputClumps);
+    }
+    catch(rsgis::cmds::RSGISCmdException &e)
+    {
+        PyErr_SetString(GETSTATE(self)->error, e.what());
+        return NULL;
+    }
+    
+    Py_RETURN_NONE;
+}
+
+
 static PyObject *Segmentation_GenerateRegularGrid(PyObject *self, PyObject *args)
 {
     const char *pszInputImage, *pszOutputImage, *pszgdalformat;
@@ -495,14 +559,15 @@ static PyObject *Segmentation_IncludeRegionsInClumps(PyObject *self, PyObject *a
 static PyObject *Segmentation_mergeSegments2Neighbours(PyObject *self, PyObject *args)
 {
     const char *pszInputClumpsImage, *pszInputSpecImage, *pszOutputImage, *pszgdalformat, *selectClumpsCol, *noDataClumpsCol;
-    if( !PyArg_ParseTuple(args, "ssssss:mergeSegments2Neighbours", &pszInputClumpsImage, &pszInputSpecImage, &pszOutputImage, &pszgdalformat, &selectClumpsCol, &noDataClumpsCol))
+    const char *changesCol = "";
+    if( !PyArg_ParseTuple(args, "ssssss|s:mergeSegments2Neighbours", &pszInputClumpsImage, &pszInputSpecImage, &pszOutputImage, &pszgdalformat, &selectClumpsCol, &noDataClumpsCol, &changesCol))
     {
         return NULL;
     }
     
     try
     {
-        rsgis::cmds::executeMergeSelectClumps2Neighbour(std::string(pszInputSpecImage), std::string(pszInputClumpsImage), std::string(pszOutputImage), std::string(pszgdalformat), std::string(selectClumpsCol), std::string(noDataClumpsCol));
+        rsgis::cmds::executeMergeSelectClumps2Neighbour(std::string(pszInputSpecImage), std::string(pszInputClumpsImage), std::string(pszOutputImage), std::string(pszgdalformat), std::string(selectClumpsCol), std::string(noDataClumpsCol), std::string(changesCol));
     }
     catch(rsgis::cmds::RSGISCmdException &e)
     {
@@ -694,7 +759,7 @@ static PyMethodDef SegmentationMethods[] = {
 "\n"},
 
     {"rmSmallClumpsStepwise", Segmentation_RMSmallClumpsStepwise, METH_VARARGS,
-"segmentation.rmSmallClumpsStepwise(inputimage, clumpsimage, outputimage, gdalformat, stretchstatsavail, stretchstatsfile, storemean, processinmemory, minclumpsize, specThreshold)\n"
+"segmentation.rmSmallClumpsStepwise(inputimage, clumpsimage, outputimage, gdalformat, stretchstatsavail, stretchstatsfile, storemean, processinmemory, minclumpsize, specThreshold, changescol)\n"
 "eliminate clumps smaller than a given size from the scene, small clumps will be combined with their spectrally closest neighbouring  clump in a stepwise fashion unless over spectral distance threshold\n"
 "\n"
 "Where:\n"
@@ -709,6 +774,7 @@ static PyMethodDef SegmentationMethods[] = {
 ":param processinmemory: is a bool specifying if processing should be carried out in memory (faster if sufficient RAM is available, set to False if unsure).\n"
 ":param minclumpsize: is an unsigned integer providing the minimum size for clumps.\n"
 ":param specThreshold: is a float providing the maximum (Euclidian distance) spectral separation for which to merge clumps. Set to a large value to ignore spectral separation and always merge.\n"
+":param changescol: is an optional (default '') string. If provided the attribute table of the clumps image is copied to the output and the clumps which have been eliminated or grown are recorded in this column, so rsgislib.rastergis.populateRATWithStats can update the statistics of just those clumps. If the column does not exist in the input all the clumps are recorded as changed.\n"
 "\n"},
 
     {"relabelClumps", Segmentation_relabelClumps, METH_VARARGS,
@@ -762,6 +828,33 @@ static PyMethodDef SegmentationMethods[] = {
 ":param inputimagepaths: is a list of input image paths\n"
 ":param outputimage: is a string containing the name of the output file\n"
 ":param mergeRATs: is a boolean specifying with the image RATs are to merged (Default: false; Optional)\n"
+"\n"},
+
+    {"tiledSegmentation", (PyCFunction)Segmentation_tiledSegmentation, METH_VARARGS | METH_KEYWORDS,
+"segmentation.tiledSegmentation(inputimg, outputimg, clustercentres, minpxls=100, distthres=100, gdalformat='KEA', stretchstats=None, tilexsize=2000, tileysize=2000, tileoverlap=100, nthreads=0)\n"
+"Runs the Shepherd et al. (2019) segmentation (label to the nearest cluster centre, clump and eliminate small clumps) over\n"
+"an image in tiles using a pool of threads and writes a single clumps image. The clumps cut by the tile boundaries are\n"
+"re-segmented using offset tiles and then as individual regions, as in the tiled workflow of Clewley et al. (2015),\n"
+"but without writing any intermediate files. Pixels where all bands are zero are treated as no data.\n"
+"\n"
+"Where:\n"
+"\n"
+":param inputimg: is a string containing the name of the input (usually stretched) image file\n"
+":param outputimg: is a string containing the name of the output clumps file\n"
+":param clustercentres: is a string containing the name of the cluster centres file (e.g., from the KMeans clustering)\n"
+":param minpxls: is an unsigned integer providing the minimum size for clumps.\n"
+":param distthres: is a float providing the maximum spectral distance for which to merge clumps.\n"
+":param gdalformat: is a string containing the GDAL format for the output file - eg 'KEA'\n"
+":param stretchstats: is a string containing the name of the stretch stats file for the input image (None if not stretched)\n"
+":param tilexsize: is an unsigned integer with the width of the tiles in pixels\n"
+":param tileysize: is an unsigned integer with the height of the tiles in pixels\n"
+":param tileoverlap: is an unsigned integer with the number of pixels each tile overlaps its neighbours\n"
+":param nthreads: is an unsigned integer with the number of threads to use (0 uses all the available cores)\n"
+"\n"
+"Example::\n"
+"\n"
+"   import rsgislib.segmentation\n"
+"   rsgislib.segmentation.tiledSegmentation('Stretched.kea', 'Clumps.kea', 'KCentres.gmtxt', minpxls=100, distthres=100, stretchstats='StretchStats.txt')\n"
 "\n"},
 
     {"findTileBordersMask", Segmentation_findTileBordersMask, METH_VARARGS,
@@ -797,10 +890,20 @@ static PyMethodDef SegmentationMethods[] = {
 "Where:\n"
 "\n"
 ":param inputImage: is a string containing the name of the input image file from which the mean is taken.\n"
-":param inputClumps: is a string containing the name of the input clumps file\n"
+":param inputClumps: is a string containing the name of the input clumps file, which is not modified.\n"
 ":param outputImage: is a string containing the name of the output image.\n"
 ":param gdalformat: is a string defining the format of the output image.\n"
 ":param datatype: is an containing one of the values from rsgislib.TYPE_*\n"
+"\n"},
+
+    {"populateRATMeans", Segmentation_populateRATMeans, METH_VARARGS,
+"segmentation.populateRATMeans(inputImage, inputClumps)\n"
+"A function to calculate the mean of each band of the input image for each clump and store them in the clumps attribute table (columns b1Mean, b2Mean, ...). Existing columns with these names are overwritten.\n"
+"\n"
+"Where:\n"
+"\n"
+":param inputImage: is a string containing the name of the input image file from which the mean is taken.\n"
+":param inputClumps: is a string containing the name of the input clumps file, which is updated.\n"
 "\n"},
 
 {"generateRegularGrid", Segmentation_GenerateRegularGrid, METH_VARARGS,
@@ -831,7 +934,7 @@ static PyMethodDef SegmentationMethods[] = {
 "\n"},
     
 {"mergeSegments2Neighbours", Segmentation_mergeSegments2Neighbours, METH_VARARGS,
-"segmentation.mergeSegments2Neighbours(clumpsImage, spectralImage, outputClumps, gdalformat, selectedClumpsCol, noDataClumpsCol)\n"
+"segmentation.mergeSegments2Neighbours(clumpsImage, spectralImage, outputClumps, gdalformat, selectedClumpsCol, noDataClumpsCol, changesCol)\n"
 "A function to merge some selected clumps with the neighbours based on colour (spectral) distance where clumps identified as no data are ignored.\n"
 "\n"
 "Where:\n"
@@ -842,6 +945,7 @@ static PyMethodDef SegmentationMethods[] = {
 ":param gdalformat: is a string defining the format of the output image.\n"
 ":param selectClumpsCol: is a string defining the binary column for defining the segments to be merged (1 == selected clumps).\n"
 ":param noDataClumpsCol: is a string defining the binary column for defining the segments to be ignored as no data (1 == no-data clumps).\n"
+":param changesCol: is an optional (default '') string with the name of a column recording the clumps changed since the statistics were calculated. If provided only those clumps have their statistics recalculated, the attribute table is copied to the output and the merged clumps are recorded in this column of the output (see rsgislib.rastergis.populateRATWithStats).\n"
 "\n"},
     
 {"dropSelectedClumps", Segmentation_dropSelectedSegments, METH_VARARGS,
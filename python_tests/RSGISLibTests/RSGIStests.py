@@ -82,6 +82,7 @@ class RSGISTests:
         shutil.copy2('RATS/injune_p142_casi_sub_utm_segs_nostats.kea', 'TestOutputs/RasterGIS/injune_p142_casi_sub_utm_segs_cpcols.kea')
         shutil.copy2('RATS/injune_p142_casi_sub_utm_segs_nostats.kea', 'TestOutputs/RasterGIS/injune_p142_casi_sub_utm_segs_spatloc_eucdist.kea')
         shutil.copy2('RATS/injune_p142_casi_sub_utm_segs_nostats.kea', 'TestOutputs/RasterGIS/injune_p142_casi_sub_utm_segs_popstats.kea')
+        shutil.copy2('RATS/injune_p142_casi_sub_utm_segs_nostats.kea', 'TestOutputs/RasterGIS/injune_p142_casi_sub_utm_segs_popstats_changes.kea')
         shutil.copy2('RATS/injune_p142_casi_sub_utm_segs.kea', 'TestOutputs/RasterGIS/injune_p142_casi_sub_utm_segs_neighbours.kea')
         shutil.copy2('RATS/injune_p142_casi_sub_utm_segs.kea', 'TestOutputs/RasterGIS/injune_p142_casi_sub_utm_segs_borlen.kea')
         shutil.copy2('RATS/injune_p142_casi_sub_utm_segs.kea', 'TestOutputs/RasterGIS/injune_p142_casi_sub_utm_segs_borlen.kea')
@@ -422,6 +423,28 @@ class RSGISTests:
         bs.append(rastergis.BandAttStats(band=3, minField="b3Min", maxField="b3Max", meanField="b3Mean", sumField="b3Sum", stdDevField="b3StdDev"))
         rastergis.populateRATWithStats(input, clumps, bs)
 
+    def testPopulateRATWithStatsChanges(self):
+        print("PYTHON TEST: populateRATWithStats (changescol)")
+        import numpy
+        from rsgislib.rastergis import ratutils
+        clumps="./TestOutputs/RasterGIS/injune_p142_casi_sub_utm_segs_popstats_changes.kea"
+        elimClumps="./TestOutputs/RasterGIS/injune_p142_casi_sub_utm_segs_popstats_changes_elim.kea"
+        fullClumps="./TestOutputs/RasterGIS/injune_p142_casi_sub_utm_segs_popstats_changes_full.kea"
+        input="./Rasters/injune_p142_casi_sub_utm.kea"
+        bs = []
+        bs.append(rastergis.BandAttStats(band=1, minField="b1Min", maxField="b1Max", meanField="b1Mean", sumField="b1Sum", stdDevField="b1StdDev"))
+        bs.append(rastergis.BandAttStats(band=2, minField="b2Min", maxField="b2Max", meanField="b2Mean", sumField="b2Sum", stdDevField="b2StdDev"))
+        rastergis.populateRATWithStats(input, clumps, bs, changescol="Changes")
+        segmentation.rmSmallClumpsStepwise(input, clumps, elimClumps, "KEA", False, "", False, False, 100, 1000000, "Changes")
+        shutil.copy2(elimClumps, fullClumps)
+        rastergis.populateRATWithStats(input, elimClumps, bs, changescol="Changes")
+        rastergis.populateRATWithStats(input, fullClumps, bs)
+        for field in ["b1Min", "b1Max", "b1Mean", "b1Sum", "b1StdDev", "b2Min", "b2Max", "b2Mean", "b2Sum", "b2StdDev"]:
+            incVals = ratutils.getColumnData(elimClumps, field)
+            fullVals = ratutils.getColumnData(fullClumps, field)
+            if not numpy.allclose(incVals, fullVals):
+                raise Exception('Incrementally updated column {} does not match a full recompute.'.format(field))
+
     def testPopulateRATWithPercentiles(self):
         print("PYTHON TEST: populateRATWithPercentiles")
         clumps = "./TestOutputs/RasterGIS/injune_p142_casi_sub_utm_segs_popstats.kea"
@@ -983,6 +1006,7 @@ if __name__ == '__main__':
         #t.tryFuncAndCatch(t.testFindTopN)
         #t.tryFuncAndCatch(t.testFindSpecClose)
         t.tryFuncAndCatch(t.testPopulateRATWithStats)
+        t.tryFuncAndCatch(t.testPopulateRATWithStatsChanges)
         t.tryFuncAndCatch(t.testPopulateRATWithPercentiles)
         t.tryFuncAndCatch(t.testExport2Ascii)
         t.tryFuncAndCatch(t.testExportCol2GDALImage)
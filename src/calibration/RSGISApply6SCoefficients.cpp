@@ -115,6 +115,119 @@ namespace rsgis{namespace calib{
         
     }
     
+    RSGISLUTAxisIndex::RSGISLUTAxisIndex()
+    {
+        this->minVal = 0;
+        this->cellSize = 1;
+    }
+    
+    void RSGISLUTAxisIndex::buildIndex(const std::vector<float> &sortedVals)
+    {
+        if(sortedVals.empty())
+        {
+            throw rsgis::img::RSGISImageCalcException("The LUT does not have any entries.");
+        }
+        this->vals = sortedVals;
+        this->minVal = sortedVals.front();
+        float range = sortedVals.back() - sortedVals.front();
+        
+        // Cells are half the smallest spacing so each holds at most one LUT boundary.
+        float minGap = range;
+        for(size_t i = 1; i < sortedVals.size(); ++i)
+        {
+            float gap = sortedVals[i] - sortedVals[i-1];
+            if((gap > 0) && (gap < minGap))
+            {
+                minGap = gap;
+            }
+        }
+        const size_t maxNumCells = 65536;
+        size_t numCells = 1;
+        this->cellSize = 1;
+        if(range > 0)
+        {
+            this->cellSize = minGap / 2;
+            numCells = ((size_t)ceil(range / this->cellSize)) + 1;
+            if(numCells > maxNumCells)
+            {
+                numCells = maxNumCells;
+                this->cellSize = range / (maxNumCells - 1);
+            }
+        }
+        
+        unsigned int maxLower = (this->vals.size() > 1)?(this->vals.size() - 2):0;
+        this->cellIdx.assign(numCells, 0);
+        unsigned int idx = 0;
+        for(size_t c = 0; c < numCells; ++c)
+        {
+            float cellStart = this->minVal + (c * this->cellSize);
+            while((idx < maxLower) && (this->vals[idx+1] <= cellStart))
+            {
+                ++idx;
+            }
+            this->cellIdx[c] = idx;
+        }
+    }
+    
+    unsigned int RSGISLUTAxisIndex::findLower(float val) const
+    {
+        if(this->vals.size() < 2)
+        {
+            return 0;
+        }
+        unsigned int maxLower = this->vals.size() - 2;
+        float cell = (val - this->minVal) / this->cellSize;
+        size_t c = 0;
+        if(cell >= this->cellIdx.size())
+        {
+            c = this->cellIdx.size() - 1;
+        }
+        else if(cell > 0)
+        {
+            c = (size_t)cell;
+        }
+        
+        unsigned int idx = this->cellIdx[c];
+        while((idx < maxLower) && (this->vals[idx+1] <= val))
+        {
+            ++idx;
+        }
+        while((idx > 0) && (this->vals[idx] > val))
+        {
+            --idx;
+        }
+        return idx;
+    }
+    
+    unsigned int RSGISLUTAxisIndex::findNearest(float val) const
+    {
+        unsigned int idx = this->findLower(val);
+        if((idx + 1 < this->vals.size()) && (fabs(this->vals[idx+1] - val) < fabs(this->vals[idx] - val)))
+        {
+            ++idx;
+        }
+        return idx;
+    }
+    
+    /**
+     * Appends the coefficients of a LUT entry to the contiguous coefficient arrays.
+     */
+    template <typename LUTEntry> void appendLUT6SCoeffs(const LUTEntry &lutVal, LUT6SCoeffArrays *coeffs)
+    {
+        if(coeffs->imageBands.empty())
+        {
+            coeffs->numValues = lutVal.numValues;
+        }
+        else if(coeffs->numValues != lutVal.numValues)
+        {
+            throw rsgis::img::RSGISImageCalcException("All the LUT entries must have the same number of coefficients.");
+        }
+        coeffs->imageBands.insert(coeffs->imageBands.end(), lutVal.imageBands, lutVal.imageBands + lutVal.numValues);
+        coeffs->aX.insert(coeffs->aX.end(), lutVal.aX, lutVal.aX + lutVal.numValues);
+        coeffs->bX.insert(coeffs->bX.end(), lutVal.bX, lutVal.bX + lutVal.numValues);
+        coeffs->cX.insert(coeffs->cX.end(), lutVal.cX, lutVal.cX + lutVal.numValues);
+    }
+    
     RSGISApply6SCoefficientsElevLUTParam::RSGISApply6SCoefficientsElevLUTParam(unsigned int numOutBands, std::vector<LUT6SElevation> *lut, float demNoDataVal, float noDataVal, bool useNoDataVal, float scaleFactor):rsgis::img::RSGISCalcImageValue(numOutBands)
     {
 		this->lut = lut;
@@ -123,20 +236,23 @@ namespace rsgis{namespace calib{
         this->noDataVal = noDataVal;
         this->useNoDataVal = useNoDataVal;
         
-        double minElev = 0;
+        // Order the LUT by elevation and copy the coefficients into contiguous arrays.
+        std::vector<unsigned int> order(lut->size());
         for(unsigned int i = 0; i < lut->size(); ++i)
         {
-            if(i == 0)
-            {
-                minElev = lut->at(i).elev;
-                minElevCoeffs = lut->at(i);
-            }
-            else if(lut->at(i).elev < minElev)
-            {
-                minElev = lut->at(i).elev;
-                minElevCoeffs = lut->at(i);
-            }
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [lut](unsigned int a, unsigned int b){return lut->at(a).elev < lut->at(b).elev;});
+        
+        std::vector<float> elevs;
+        this->coeffs.numValues = 0;
+        for(std::vector<unsigned int>::iterator iterIdx = order.begin(); iterIdx != order.end(); ++iterIdx)
+        {
+            elevs.push_back(lut->at(*iterIdx).elev);
+            appendLUT6SCoeffs(lut->at(*iterIdx), &this->coeffs);
         }
+        this->elevIdx.buildIndex(elevs);
+        this->minElev = elevs.front();
     }
     
     void RSGISApply6SCoefficientsElevLUTParam::calcImageValue(float *bandValues, int numBands, double *output) 
@@ -149,7 +265,7 @@ namespace rsgis{namespace calib{
         float elevVal = bandValues[0];
         if(elevVal == demNoDataVal)
         {
-            elevVal = minElevCoeffs.elev;
+            elevVal = this->minElev;
         }
 		
         bool nodata = true;
@@ -180,95 +296,55 @@ namespace rsgis{namespace calib{
         }
         else
         {
-            LUT6SElevation lutVal;
-            float dist = 0.0;
-            float minDist = 0.0;
-            unsigned int lutIdx = 0;
-            
-            LUT6SElevation lutVal2;
-            unsigned int lutIdx2 = 0;
-            
-            for(unsigned int i = 0; i < lut->size(); ++i)
-            {
-                dist = (lut->at(i).elev - elevVal) * (lut->at(i).elev - elevVal);
-                if(i == 0)
-                {
-                    minDist = dist;
-                    lutIdx = i;
-                }
-                else if(dist < minDist)
-                {
-                    minDist = dist;
-                    lutIdx = i;
-                }
-            }
-            lutVal = lut->at(lutIdx);
-            
-            
-            float elevLUTDiff = 0.0;
-            float elevLUTDiff1 = 0.0;
-            float elevLUTDiff2 = 0.0;
+            // Interpolate between the LUT entries either side of the elevation.
+            bool interpolate = this->elevIdx.getNumValues() > 1;
+            unsigned int numValues = this->coeffs.numValues;
+            unsigned int lutIdx = this->elevIdx.findLower(elevVal);
+            unsigned int lutIdx2 = interpolate?(lutIdx+1):lutIdx;
             
-            float elevProp1 = 0.0;
+            float elevProp1 = 1.0;
             float elevProp2 = 0.0;
-            
-            if(lut->size() > 1)
+            if(interpolate)
             {
-                if(lutIdx == 0)
-                {
-                    lutIdx2 = 1;
-                }
-                else if(lutIdx == (lut->size()-1))
-                {
-                    lutIdx2 = lutIdx-1;
-                }
-                else
-                {
-                    if((elevVal - lut->at(lutIdx).elev) < 0)
-                    {
-                        lutIdx2 = lutIdx-1;
-                    }
-                    else
-                    {
-                        lutIdx2 = lutIdx+1;
-                    }
-                }
-                lutVal2 = lut->at(lutIdx2);
-                
-                elevLUTDiff = fabs(lutVal.elev - lutVal2.elev);
-                elevLUTDiff1 = fabs(elevVal - lutVal.elev);
-                elevLUTDiff2 = fabs(elevVal - lutVal2.elev);
-                
-                elevProp1 = 1-(elevLUTDiff1/elevLUTDiff);
-                elevProp2 = 1-(elevLUTDiff2/elevLUTDiff);
+                float elev1 = this->elevIdx.getValue(lutIdx);
+                float elev2 = this->elevIdx.getValue(lutIdx2);
+                float elevLUTDiff = fabs(elev1 - elev2);
+                elevProp1 = 1-(fabs(elevVal - elev1)/elevLUTDiff);
+                elevProp2 = 1-(fabs(elevVal - elev2)/elevLUTDiff);
             }
             
+            const unsigned int *imageBands1 = &this->coeffs.imageBands[lutIdx * numValues];
+            const float *aX1 = &this->coeffs.aX[lutIdx * numValues];
+            const float *bX1 = &this->coeffs.bX[lutIdx * numValues];
+            const float *cX1 = &this->coeffs.cX[lutIdx * numValues];
+            const unsigned int *imageBands2 = &this->coeffs.imageBands[lutIdx2 * numValues];
+            const float *aX2 = &this->coeffs.aX[lutIdx2 * numValues];
+            const float *bX2 = &this->coeffs.bX[lutIdx2 * numValues];
+            const float *cX2 = &this->coeffs.cX[lutIdx2 * numValues];
+            
             double tmpVal = 0;
             double reflVal1 = 0.0;
             double reflVal2 = 0.0;
             
-            for(unsigned int i = 0; i < lutVal.numValues; ++i)
+            for(unsigned int i = 0; i < numValues; ++i)
             {
-                if(lutVal.imageBands[i] > numBands)
+                if((imageBands1[i] > numBands) | (imageBands2[i] > numBands))
                 {
-                    std::cout << "Image band: " << lutVal.imageBands[i] << std::endl;
+                    std::cout << "Image band: " << imageBands1[i] << std::endl;
                     throw rsgis::img::RSGISImageCalcException("Image band is not within image.");
                 }
                 
-                if(lut->size() > 1)
+                tmpVal=aX1[i]*bandValues[imageBands1[i]]-bX1[i];
+                reflVal1 = (tmpVal/(1.0+cX1[i]*tmpVal))*this->scaleFactor;
+                if(interpolate)
                 {
-                    tmpVal=lutVal.aX[i]*bandValues[lutVal.imageBands[i]]-lutVal.bX[i];
-                    reflVal1 = (tmpVal/(1.0+lutVal.cX[i]*tmpVal))*this->scaleFactor;
-                    
-                    tmpVal=lutVal2.aX[i]*bandValues[lutVal2.imageBands[i]]-lutVal2.bX[i];
-                    reflVal2 = (tmpVal/(1.0+lutVal2.cX[i]*tmpVal))*this->scaleFactor;
-                    
+                    tmpVal=aX2[i]*bandValues[imageBands2[i]]-bX2[i];
+                    reflVal2 = (tmpVal/(1.0+cX2[i]*tmpVal))*this->scaleFactor;
                     output[i] = (reflVal1*elevProp1) + (reflVal2*elevProp2);
                 }
                 else
                 {
-                    tmpVal=lutVal.aX[i]*bandValues[lutVal.imageBands[i]]-lutVal.bX[i];
-                    output[i] = (tmpVal/(1.0+lutVal.cX[i]*tmpVal))*this->scaleFactor;
+                    output[i] = reflVal1;
                 }
                 
                 if(this->useNoDataVal & (this->noDataVal == 0.0))
@@ -305,6 +381,42 @@ namespace rsgis{namespace calib{
         this->scaleFactor = scaleFactor;
         this->noDataVal = noDataVal;
         this->useNoDataVal = useNoDataVal;
+        
+        // Order the LUT by elevation and then AOT, copying the coefficients into contiguous arrays.
+        std::vector<unsigned int> order(lut->size());
+        for(unsigned int i = 0; i < lut->size(); ++i)
+        {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [lut](unsigned int a, unsigned int b){return lut->at(a).elev < lut->at(b).elev;});
+        
+        std::vector<float> elevs;
+        this->coeffs.numValues = 0;
+        unsigned int numEntries = 0;
+        for(std::vector<unsigned int>::iterator iterIdx = order.begin(); iterIdx != order.end(); ++iterIdx)
+        {
+            const std::vector<LUT6SAOT> &aotLUT = lut->at(*iterIdx).aotLUT;
+            std::vector<unsigned int> aotOrder(aotLUT.size());
+            for(unsigned int i = 0; i < aotLUT.size(); ++i)
+            {
+                aotOrder[i] = i;
+            }
+            std::stable_sort(aotOrder.begin(), aotOrder.end(), [&aotLUT](unsigned int a, unsigned int b){return aotLUT.at(a).aot < aotLUT.at(b).aot;});
+            
+            std::vector<float> aots;
+            for(std::vector<unsigned int>::iterator iterAOT = aotOrder.begin(); iterAOT != aotOrder.end(); ++iterAOT)
+            {
+                aots.push_back(aotLUT.at(*iterAOT).aot);
+                appendLUT6SCoeffs(aotLUT.at(*iterAOT), &this->coeffs);
+            }
+            
+            elevs.push_back(lut->at(*iterIdx).elev);
+            this->aotIdxs.push_back(RSGISLUTAxisIndex());
+            this->aotIdxs.back().buildIndex(aots);
+            this->aotOffsets.push_back(numEntries);
+            numEntries += aots.size();
+        }
+        this->elevIdx.buildIndex(elevs);
     }
     
     void RSGISApply6SCoefficientsElevAOTLUTParam::calcImageValue(float *bandValues, int numBands, double *output) 
@@ -346,76 +458,27 @@ namespace rsgis{namespace calib{
         }
         else
         {
-            LUT6SBaseElevAOT elevLUTVal;
-            unsigned int elevLUTIdx = 0;
-            float dist = 0.0;
-            float minDist = 0.0;
-                        
-            for(unsigned int i = 0; i < lut->size(); ++i)
-            {
-                dist = (lut->at(i).elev - elevVal) * (lut->at(i).elev - elevVal);
-                if(i == 0)
-                {
-                    minDist = dist;
-                    elevLUTIdx = i;
-                }
-                else if(dist < minDist)
-                {
-                    minDist = dist;
-                    elevLUTIdx = i;
-                }
-            }
-            
-            if(elevLUTIdx >= lut->size())
-            {
-                std::cerr << "elevVal = " << elevVal << std::endl;
-                std::cerr << "elevLUTIdx = " << elevLUTIdx << std::endl;
-                std::cerr << "lut->size() = " << lut->size() << std::endl;
-                
-                throw rsgis::img::RSGISImageCalcException("Elevation value is not within the LUT.");
-            }
-            
-            elevLUTVal = lut->at(elevLUTIdx);
+            // Nearest elevation and then nearest AOT within that elevation.
+            unsigned int elevLUTIdx = this->elevIdx.findNearest(elevVal);
+            unsigned int aotLUTIdx = this->aotIdxs[elevLUTIdx].findNearest(aotVal);
             
-            LUT6SAOT aotLUTVal;
-            unsigned int aotLUTIdx = 0;
+            unsigned int numValues = this->coeffs.numValues;
+            size_t coeffOff = ((size_t)(this->aotOffsets[elevLUTIdx] + aotLUTIdx)) * numValues;
+            const unsigned int *imageBands = &this->coeffs.imageBands[coeffOff];
+            const float *aX = &this->coeffs.aX[coeffOff];
+            const float *bX = &this->coeffs.bX[coeffOff];
+            const float *cX = &this->coeffs.cX[coeffOff];
             
-            for(unsigned int i = 0; i < elevLUTVal.aotLUT.size(); ++i)
+            for(unsigned int i = 0; i < numValues; ++i)
             {
-                dist = (elevLUTVal.aotLUT.at(i).aot - aotVal) * (elevLUTVal.aotLUT.at(i).aot - aotVal);
-                if(i == 0)
-                {
-                    minDist = dist;
-                    aotLUTIdx = i;
-                }
-                else if(dist < minDist)
-                {
-                    minDist = dist;
-                    aotLUTIdx = i;
-                }
-            }
-                        
-            if(aotLUTIdx >= elevLUTVal.aotLUT.size())
-            {
-                std::cerr << "aotVal = " << aotVal << std::endl;
-                std::cerr << "aotLUTIdx = " << aotLUTIdx << std::endl;
-                std::cerr << "elevLUTVal.aotLUT.size() = " << elevLUTVal.aotLUT.size() << std::endl;
-                
-                throw rsgis::img::RSGISImageCalcException("AOT value is not within the LUT.");
-            }
-            
-            aotLUTVal = elevLUTVal.aotLUT.at(aotLUTIdx);
-            
-            for(unsigned int i = 0; i < aotLUTVal.numValues; ++i)
-            {
-                if(aotLUTVal.imageBands[i] > numBands)
+                if(imageBands[i] > numBands)
                 {
-                    std::cout << "Image band: " << aotLUTVal.imageBands[i] << std::endl;
+                    std::cout << "Image band: " << imageBands[i] << std::endl;
                     throw rsgis::img::RSGISImageCalcException("Image band is not within image.");
                 }
                 
-                tmpVal=aotLUTVal.aX[i]*bandValues[aotLUTVal.imageBands[i]]-aotLUTVal.bX[i];
-                output[i] = (tmpVal/(1.0+aotLUTVal.cX[i]*tmpVal))*this->scaleFactor;
+                tmpVal=aX[i]*bandValues[imageBands[i]]-bX[i];
+                output[i] = (tmpVal/(1.0+cX[i]*tmpVal))*this->scaleFactor;
 
                 if(this->useNoDataVal & (this->noDataVal == 0.0))
                 {
@@ -29,6 +29,9 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <math.h>
 
 #include "gdal_priv.h"
 
@@ -85,6 +88,42 @@ namespace rsgis{namespace calib{
         std::vector<LUT6SAOT> aotLUT;
     };
 	    
+    /**
+     * Coefficients for a set of LUT entries held as contiguous arrays indexed
+     * by (entry * numValues) + i rather than as one struct per entry.
+     */
+    struct DllExport LUT6SCoeffArrays
+    {
+        unsigned int numValues;
+        std::vector<unsigned int> imageBands;
+        std::vector<float> aX;
+        std::vector<float> bX;
+        std::vector<float> cX;
+    };
+    
+    /**
+     * Index over the sorted values of a LUT axis (e.g., elevation or AOT). The
+     * range of the axis is divided into evenly spaced cells, each recording the
+     * LUT entry at or below its start, so the entries either side of a value
+     * are found in constant time rather than by scanning the LUT.
+     */
+    class DllExport RSGISLUTAxisIndex
+    {
+    public:
+        RSGISLUTAxisIndex();
+        void buildIndex(const std::vector<float> &sortedVals);
+        unsigned int findLower(float val) const;
+        unsigned int findNearest(float val) const;
+        float getValue(unsigned int idx) const {return this->vals[idx];};
+        unsigned int getNumValues() const {return this->vals.size();};
+        ~RSGISLUTAxisIndex(){};
+    protected:
+        std::vector<float> vals;
+        std::vector<unsigned int> cellIdx;
+        float minVal;
+        float cellSize;
+    };
+    
 	class DllExport RSGISApply6SCoefficientsSingleParam : public rsgis::img::RSGISCalcImageValue
     {
     public: 
@@ -130,7 +169,9 @@ namespace rsgis{namespace calib{
         ~RSGISApply6SCoefficientsElevLUTParam();
     protected:
         std::vector<LUT6SElevation> *lut;
-        LUT6SElevation minElevCoeffs;
+        RSGISLUTAxisIndex elevIdx;
+        LUT6SCoeffArrays coeffs;
+        float minElev;
         float scaleFactor;
         float demNoDataVal;
         float noDataVal;
@@ -155,6 +196,10 @@ namespace rsgis{namespace calib{
         ~RSGISApply6SCoefficientsElevAOTLUTParam();
     protected:
         std::vector<LUT6SBaseElevAOT> *lut;
+        RSGISLUTAxisIndex elevIdx;
+        std::vector<RSGISLUTAxisIndex> aotIdxs;
+        std::vector<unsigned int> aotOffsets;
+        LUT6SCoeffArrays coeffs;
         float scaleFactor;
         float noDataVal;
         bool useNoDataVal;
@@ -959,7 +959,7 @@ namespace rsgis{namespace calib{
     }
     
     
-    void RSGISCalcCloudParams::projFitCloudShadow(GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeights, GDALDataset *potentCloudShadowRegions, GDALDataset *cloudShadowTestRegionsDS, GDALDataset *cloudShadowRegionsDS, double sunAz, double sunZen, double senAz, double senZen)
+    void RSGISCalcCloudParams::projFitCloudShadow(GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeights, GDALDataset *potentCloudShadowRegions, GDALDataset *cloudShadowRegionsDS, double sunAz, double sunZen, double senAz, double senZen, unsigned int numThreads)
     {
         try
         {
@@ -967,104 +967,30 @@ namespace rsgis{namespace calib{
             GDALRasterAttributeTable *cloudsRAT = cloudClumpsDS->GetRasterBand(1)->GetDefaultRAT();
             size_t numClumps = 0;
             int *cloudsRATHisto = attUtils.readIntColumn(cloudsRAT, "Histogram", &numClumps);
-            double *minX = attUtils.readDoubleColumn(cloudsRAT, "MinXX", &numClumps);
-            double *maxX = attUtils.readDoubleColumn(cloudsRAT, "MaxXX", &numClumps);
-            double *minY = attUtils.readDoubleColumn(cloudsRAT, "MinYY", &numClumps);
-            double *maxY = attUtils.readDoubleColumn(cloudsRAT, "MaxYY", &numClumps);
-            double *cloudBase = attUtils.readDoubleColumn(cloudsRAT, "CloudBase", &numClumps);
             double *hBaseMin = attUtils.readDoubleColumn(cloudsRAT, "hBaseMin", &numClumps);
             double *hBaseMax = attUtils.readDoubleColumn(cloudsRAT, "hBaseMax", &numClumps);
             
-            RSGISEditCloudShadowImg editShadImg = RSGISEditCloudShadowImg(cloudShadowTestRegionsDS, 1);
-            RSGISEditCloudShadowImg editFinalShadImg = RSGISEditCloudShadowImg(cloudShadowRegionsDS, 1);
-            editFinalShadImg.reset();
-            rsgis::img::RSGISExtractPxlsAsPts getPxPts;
-            geos::geom::Envelope *env = new geos::geom::Envelope();
-            double baseHeight = 0.0;
-            double pxlX = 0.0;
-            double pxlY = 0.0;
-            double cloudHgt = 0.0;
-            double d = 0.0;
-            double xDash = 0.0;
-            double yDash = 0.0;
-            bool pxlOn = false;
-            bool first = true;
-            double maxH = 0.0;
-            double maxProp = 0.0;
-            unsigned long maxOverlap = 0;
-            double cloudPropOverlap = 0.0;
-            unsigned long numPxlOverlap = 0;
-            bool calcdShadProp = true;
+            // The shadow test image is no longer used; the shadows are tested in memory.
+            std::cout << "Reading cloud and potential cloud shadow masks\n";
+            RSGISCloudShadowFit shadowFit(cloudClumpsDS, initCloudHeights, potentCloudShadowRegions, numClumps, cloudsRATHisto, sunAz, sunZen);
+            delete[] cloudsRATHisto;
+            
             double *bestFitBaseLine = new double[numClumps];
             bestFitBaseLine[0] = 0.0;
             
+            rsgis::img::RSGISImageThreadUtils threadUtils;
+            numThreads = threadUtils.getNumThreads(numThreads);
+            std::vector<std::vector<size_t> > threadShadPxls(numThreads);
+            std::vector<std::vector<boost::uint64_t> > threadWinBits(numThreads);
+            
             std::cout << "Iteratively finding optimal cloud height. This step may take a while; there are " << numClumps << " clumps\n";
-            rsgis_tqdm pbar;
-            for(size_t i = 1; i < numClumps; ++i)
+            size_t numClouds = (numClumps > 0)?(numClumps-1):0;
+            threadUtils.runTasks(numThreads, numClouds, [&](unsigned int threadIdx, size_t task)
             {
-                pbar.progress(i, numClumps);
-                
-                std::vector<std::pair<std::pair<double,double>,double> > *pxPts = new std::vector<std::pair<std::pair<double,double>,double> >();
-                pxPts->reserve(cloudsRATHisto[i]);
-                env->init(minX[i], maxX[i], minY[i], maxY[i]);
-                getPxPts.exportPixelsAsPointsWithVal(cloudClumpsDS, (float)i, initCloudHeights, 2, pxPts, true, env);
-                
-                
-                first = true;
-                for(baseHeight=hBaseMin[i]; baseHeight < hBaseMax[i]; baseHeight+=0.25)
-                {
-                    editShadImg.reset();
-                    for(std::vector<std::pair<std::pair<double,double>,double> >::iterator iterPts = pxPts->begin(); iterPts != pxPts->end(); ++iterPts)
-                    {
-                        pxlX = (*iterPts).first.first;
-                        pxlY = (*iterPts).first.second;
-                        cloudHgt = (baseHeight+(*iterPts).second) * 1000; // Convert to metres.
-                        
-                        // calculation taken from python-fmask
-                        d = cloudHgt * tan(sunZen);
-                        
-                        // (x', y') are coordinates of each voxel projected onto the plane of the cloud base,
-                        // for every voxel in the solid cloud
-                        xDash = pxlX - d * sin(sunAz);
-                        yDash = pxlY - d * cos(sunAz);
-                        pxlOn = editShadImg.turnOnPxl(xDash, yDash);
-                    }
-                    // Calculate shadow fit.
-                    calcdShadProp = editShadImg.calcCorrelation(cloudClumpsDS, potentCloudShadowRegions, cloudShadowTestRegionsDS, &cloudPropOverlap, &numPxlOverlap);
-                    if(calcdShadProp)
-                    {
-                        if(first)
-                        {
-                            maxH = baseHeight;
-                            maxProp = cloudPropOverlap;
-                            maxOverlap = numPxlOverlap;
-                            first = false;
-                        }
-                        else if(cloudPropOverlap > maxProp)
-                        {
-                            maxH = baseHeight;
-                            maxProp = cloudPropOverlap;
-                            maxOverlap = numPxlOverlap;
-                        }
-                    }
-                    else
-                    {
-                        if(first)
-                        {
-                            maxH = baseHeight;
-                            maxProp = 0.0;
-                            maxOverlap = 0.0;
-                        }
-                        break;
-                    }
-                }
-                
-                // Shadow best fit base height is 'maxH'
-                bestFitBaseLine[i] = maxH;
-                
-                delete pxPts;
-            }
-            pbar.finish();
+                size_t i = task + 1;
+                bestFitBaseLine[i] = shadowFit.fitBaseHeight(i, hBaseMin[i], hBaseMax[i], &threadShadPxls[threadIdx], &threadWinBits[threadIdx]);
+            });
+            
             attUtils.writeRealColumn(cloudsRAT, "FitBaseLine", bestFitBaseLine, numClumps);
             rsgis::math::RSGISMathsUtils mathUtils;
             
@@ -1103,46 +1029,12 @@ namespace rsgis{namespace calib{
             }
             attUtils.writeRealColumn(cloudsRAT, "FitBaseLineEdit", bestFitBaseLine, numClumps);
             
-            pbar.reset();
-            std::cout << "Producing cloud shadow mask using optimal heights:\n";
-            // Add Shadow with most correspondance to Final Shadow Image.
-            for(size_t i = 1; i < numClumps; ++i)
-            {
-                pbar.progress(i, numClumps);
-                
-                std::vector<std::pair<std::pair<double,double>,double> > *pxPts = new std::vector<std::pair<std::pair<double,double>,double> >();
-                pxPts->reserve(cloudsRATHisto[i]);
-                env->init(minX[i], maxX[i], minY[i], maxY[i]);
-                getPxPts.exportPixelsAsPointsWithVal(cloudClumpsDS, (float)i, initCloudHeights, 2, pxPts, true, env);
-                
-                for(std::vector<std::pair<std::pair<double,double>,double> >::iterator iterPts = pxPts->begin(); iterPts != pxPts->end(); ++iterPts)
-                {
-                    pxlX = (*iterPts).first.first;
-                    pxlY = (*iterPts).first.second;
-                    cloudHgt = (bestFitBaseLine[i]+(*iterPts).second) * 1000; // Conver to metres.
-                    
-                    // calculation taken from python-fmask
-                    d = cloudHgt * tan(sunZen);
-                    
-                    // (x', y') are coordinates of each voxel projected onto the plane of the cloud base,
-                    // for every voxel in the solid cloud
-                    xDash = pxlX - d * sin(sunAz);
-                    yDash = pxlY - d * cos(sunAz);
-                    pxlOn = editFinalShadImg.turnOnPxl(xDash, yDash);
-                }
-                
-                delete pxPts;
-            }
-            pbar.finish();
+            std::cout << "Producing cloud shadow mask using optimal heights\n";
+            shadowFit.writeShadowMask(cloudShadowRegionsDS, bestFitBaseLine);
             
-            delete env;
-            delete[] cloudBase;
+            delete[] bestFitBaseLine;
             delete[] hBaseMin;
             delete[] hBaseMax;
-            delete[] minX;
-            delete[] maxX;
-            delete[] minY;
-            delete[] maxY;
         }
         catch (rsgis::img::RSGISImageCalcException &e)
         {
@@ -1159,6 +1051,321 @@ namespace rsgis{namespace calib{
     }
     
     
+    RSGISCloudShadowFit::RSGISCloudShadowFit(GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeights, GDALDataset *potentCloudShadowRegions, size_t numClumps, int *clumpsHisto, double sunAz, double sunZen)
+    {
+        this->numClumps = numClumps;
+        this->nXPxl = cloudClumpsDS->GetRasterXSize();
+        this->nYPxl = cloudClumpsDS->GetRasterYSize();
+        if((initCloudHeights->GetRasterXSize() != this->nXPxl) | (initCloudHeights->GetRasterYSize() != this->nYPxl) | (potentCloudShadowRegions->GetRasterXSize() != this->nXPxl) | (potentCloudShadowRegions->GetRasterYSize() != this->nYPxl))
+        {
+            throw rsgis::img::RSGISImageCalcException("The cloud clumps, cloud heights and potential cloud shadow images must be the same size.");
+        }
+        if(initCloudHeights->GetRasterCount() < 2)
+        {
+            throw rsgis::img::RSGISImageCalcException("The cloud heights image must have 2 bands.");
+        }
+        
+        double trans[6];
+        cloudClumpsDS->GetGeoTransform(trans);
+        this->tlX = trans[0];
+        this->tlY = trans[3];
+        this->xRes = trans[1];
+        this->yRes = trans[5];
+        if(this->yRes < 0)
+        {
+            this->yRes = this->yRes * (-1);
+        }
+        this->brX = this->tlX + (this->nXPxl * this->xRes);
+        this->brY = this->tlY - (this->nYPxl * this->yRes);
+        
+        this->sinSunAz = sin(sunAz);
+        this->cosSunAz = cos(sunAz);
+        this->tanSunZen = tan(sunZen);
+        
+        // Group the cloud pixels by clump using the histogram.
+        this->cloudOffsets.assign(numClumps+1, 0);
+        for(size_t i = 1; i < numClumps; ++i)
+        {
+            this->cloudOffsets[i+1] = this->cloudOffsets[i] + ((clumpsHisto[i] > 0)?clumpsHisto[i]:0);
+        }
+        size_t numCloudPxls = this->cloudOffsets[numClumps];
+        this->cloudPxlX.resize(numCloudPxls);
+        this->cloudPxlY.resize(numCloudPxls);
+        this->cloudPxlHgt.resize(numCloudPxls);
+        std::vector<size_t> fillPos(this->cloudOffsets.begin(), this->cloudOffsets.end());
+        
+        size_t numPxls = ((size_t)this->nXPxl) * ((size_t)this->nYPxl);
+        this->clearBits.assign((numPxls + 63) / 64, 0);
+        this->potentBits.assign((numPxls + 63) / 64, 0);
+        
+        GDALRasterBand *clumpsBand = cloudClumpsDS->GetRasterBand(1);
+        GDALRasterBand *hgtBand = initCloudHeights->GetRasterBand(2);
+        GDALRasterBand *potentBand = potentCloudShadowRegions->GetRasterBand(1);
+        
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        clumpsBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        if(yBlockSize < 1)
+        {
+            yBlockSize = 1;
+        }
+        unsigned long stripRows = yBlockSize;
+        while(((stripRows * this->nXPxl) < 65536) & (stripRows < this->nYPxl))
+        {
+            stripRows += yBlockSize;
+        }
+        
+        std::vector<unsigned int> clumpVals(stripRows * this->nXPxl);
+        std::vector<float> hgtVals(stripRows * this->nXPxl);
+        std::vector<int> potentVals(stripRows * this->nXPxl);
+        for(unsigned long row = 0; row < this->nYPxl; row += stripRows)
+        {
+            unsigned long nRows = std::min(stripRows, this->nYPxl - row);
+            if((clumpsBand->RasterIO(GF_Read, 0, row, this->nXPxl, nRows, clumpVals.data(), this->nXPxl, nRows, GDT_UInt32, 0, 0) != CE_None) |
+               (hgtBand->RasterIO(GF_Read, 0, row, this->nXPxl, nRows, hgtVals.data(), this->nXPxl, nRows, GDT_Float32, 0, 0) != CE_None) |
+               (potentBand->RasterIO(GF_Read, 0, row, this->nXPxl, nRows, potentVals.data(), this->nXPxl, nRows, GDT_Int32, 0, 0) != CE_None))
+            {
+                throw rsgis::img::RSGISImageCalcException("Could not read the cloud and potential cloud shadow images.");
+            }
+            
+            size_t idx = row * this->nXPxl;
+            size_t k = 0;
+            for(unsigned long y = 0; y < nRows; ++y)
+            {
+                for(unsigned long x = 0; x < this->nXPxl; ++x, ++k, ++idx)
+                {
+                    unsigned int clump = clumpVals[k];
+                    if(clump == 0)
+                    {
+                        this->setBit(this->clearBits, idx);
+                    }
+                    else if(clump < numClumps)
+                    {
+                        if(fillPos[clump] >= this->cloudOffsets[clump+1])
+                        {
+                            throw rsgis::img::RSGISImageCalcException("The cloud clumps histogram does not match the cloud clumps image.");
+                        }
+                        this->cloudPxlX[fillPos[clump]] = x;
+                        this->cloudPxlY[fillPos[clump]] = row + y;
+                        this->cloudPxlHgt[fillPos[clump]] = hgtVals[k];
+                        ++fillPos[clump];
+                    }
+                    
+                    if(potentVals[k] == 1)
+                    {
+                        this->setBit(this->potentBits, idx);
+                    }
+                }
+            }
+        }
+        
+        for(size_t i = 1; i < numClumps; ++i)
+        {
+            if(fillPos[i] != this->cloudOffsets[i+1])
+            {
+                throw rsgis::img::RSGISImageCalcException("The cloud clumps histogram does not match the cloud clumps image.");
+            }
+        }
+    }
+    
+    bool RSGISCloudShadowFit::projectShadow(size_t clump, double baseHeight, std::vector<size_t> *shadPxls, std::vector<boost::uint64_t> *winBits) const
+    {
+        shadPxls->clear();
+        bool first = true;
+        double minX = 0.0;
+        double maxX = 0.0;
+        double minY = 0.0;
+        double maxY = 0.0;
+        long minXPxl = 0;
+        long maxXPxl = 0;
+        long minYPxl = 0;
+        long maxYPxl = 0;
+        for(size_t i = this->cloudOffsets[clump]; i < this->cloudOffsets[clump+1]; ++i)
+        {
+            // Pixel centre.
+            double pxlX = this->tlX + ((this->cloudPxlX[i] + 0.5) * this->xRes);
+            double pxlY = this->tlY - ((this->cloudPxlY[i] + 0.5) * this->yRes);
+            double cloudHgt = (baseHeight + this->cloudPxlHgt[i]) * 1000; // Convert to metres.
+            
+            // calculation taken from python-fmask
+            double d = cloudHgt * this->tanSunZen;
+            
+            // (x', y') are coordinates of each voxel projected onto the plane of the cloud base,
+            // for every voxel in the solid cloud
+            double xDash = pxlX - d * this->sinSunAz;
+            double yDash = pxlY - d * this->cosSunAz;
+            
+            if((xDash < this->tlX) | (xDash > this->brX) | (yDash > this->tlY) | (yDash < this->brY))
+            {
+                continue;
+            }
+            long xPxlLoc = floor(((xDash - this->tlX) / this->xRes) + 0.5);
+            long yPxlLoc = floor(((this->tlY - yDash) / this->yRes) + 0.5);
+            if((xPxlLoc < 0) | (xPxlLoc >= ((long)this->nXPxl)) | (yPxlLoc < 0) | (yPxlLoc >= ((long)this->nYPxl)))
+            {
+                continue;
+            }
+            
+            shadPxls->push_back((((size_t)yPxlLoc) * this->nXPxl) + xPxlLoc);
+            if(first)
+            {
+                minX = maxX = xDash;
+                minY = maxY = yDash;
+                minXPxl = maxXPxl = xPxlLoc;
+                minYPxl = maxYPxl = yPxlLoc;
+                first = false;
+            }
+            else
+            {
+                minX = std::min(minX, xDash);
+                maxX = std::max(maxX, xDash);
+                minY = std::min(minY, yDash);
+                maxY = std::max(maxY, yDash);
+                minXPxl = std::min(minXPxl, xPxlLoc);
+                maxXPxl = std::max(maxXPxl, xPxlLoc);
+                minYPxl = std::min(minYPxl, yPxlLoc);
+                maxYPxl = std::max(maxYPxl, yPxlLoc);
+            }
+        }
+        if(first)
+        {
+            return false;
+        }
+        
+        // Several cloud pixels can project onto the same pixel; keep the first of each
+        // using a bitset over the window holding the shadow.
+        size_t winWidth = (maxXPxl - minXPxl) + 1;
+        size_t winSize = winWidth * ((maxYPxl - minYPxl) + 1);
+        winBits->assign((winSize + 63) / 64, 0);
+        size_t numUnique = 0;
+        for(size_t i = 0; i < shadPxls->size(); ++i)
+        {
+            size_t idx = shadPxls->at(i);
+            size_t winIdx = ((((idx / this->nXPxl) - minYPxl)) * winWidth) + ((idx % this->nXPxl) - minXPxl);
+            if(!this->testBit(*winBits, winIdx))
+            {
+                this->setBit(*winBits, winIdx);
+                shadPxls->at(numUnique++) = idx;
+            }
+        }
+        shadPxls->resize(numUnique);
+        
+        // The shadow must be at least 2 pixels across in both directions.
+        return ((maxX - minX) >= (this->xRes*2)) & ((maxY - minY) >= (this->yRes*2));
+    }
+    
+    bool RSGISCloudShadowFit::calcShadowOverlap(const std::vector<size_t> *shadPxls, double *cloudPropOverlap, unsigned long *numPxlOverlap) const
+    {
+        // Only shadow pixels which are not cloud are counted.
+        unsigned long nShadPxls = 0;
+        unsigned long nShadPxlsInPotent = 0;
+        for(std::vector<size_t>::const_iterator iterPxls = shadPxls->begin(); iterPxls != shadPxls->end(); ++iterPxls)
+        {
+            if(this->testBit(this->clearBits, *iterPxls))
+            {
+                ++nShadPxls;
+                if(this->testBit(this->potentBits, *iterPxls))
+                {
+                    ++nShadPxlsInPotent;
+                }
+            }
+        }
+        
+        if(nShadPxls == 0)
+        {
+            *cloudPropOverlap = 0.0;
+            *numPxlOverlap = 0;
+            return false;
+        }
+        *numPxlOverlap = nShadPxlsInPotent;
+        *cloudPropOverlap = ((double)nShadPxlsInPotent)/((double)nShadPxls);
+        return true;
+    }
+    
+    double RSGISCloudShadowFit::fitBaseHeight(size_t clump, double hBaseMin, double hBaseMax, std::vector<size_t> *shadPxls, std::vector<boost::uint64_t> *winBits) const
+    {
+        double maxH = hBaseMin;
+        double maxProp = 0.0;
+        bool first = true;
+        double cloudPropOverlap = 0.0;
+        unsigned long numPxlOverlap = 0;
+        for(double baseHeight = hBaseMin; baseHeight < hBaseMax; baseHeight += 0.25)
+        {
+            // Stop once the shadow has left the image.
+            if(!this->projectShadow(clump, baseHeight, shadPxls, winBits))
+            {
+                break;
+            }
+            if(!this->calcShadowOverlap(shadPxls, &cloudPropOverlap, &numPxlOverlap))
+            {
+                break;
+            }
+            if(first | (cloudPropOverlap > maxProp))
+            {
+                maxH = baseHeight;
+                maxProp = cloudPropOverlap;
+                first = false;
+            }
+            // A complete overlap cannot be bettered.
+            if(maxProp >= 1.0)
+            {
+                break;
+            }
+        }
+        return maxH;
+    }
+    
+    void RSGISCloudShadowFit::writeShadowMask(GDALDataset *cloudShadowRegionsDS, const double *baseHeights)
+    {
+        if((cloudShadowRegionsDS->GetRasterXSize() != this->nXPxl) | (cloudShadowRegionsDS->GetRasterYSize() != this->nYPxl))
+        {
+            throw rsgis::img::RSGISImageCalcException("The cloud shadow image must be the same size as the cloud clumps image.");
+        }
+        
+        size_t numPxls = ((size_t)this->nXPxl) * ((size_t)this->nYPxl);
+        std::vector<boost::uint64_t> shadowBits((numPxls + 63) / 64, 0);
+        std::vector<size_t> shadPxls;
+        std::vector<boost::uint64_t> winBits;
+        for(size_t i = 1; i < this->numClumps; ++i)
+        {
+            this->projectShadow(i, baseHeights[i], &shadPxls, &winBits);
+            for(std::vector<size_t>::iterator iterPxls = shadPxls.begin(); iterPxls != shadPxls.end(); ++iterPxls)
+            {
+                this->setBit(shadowBits, *iterPxls);
+            }
+        }
+        
+        GDALRasterBand *shadowBand = cloudShadowRegionsDS->GetRasterBand(1);
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        shadowBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        if(yBlockSize < 1)
+        {
+            yBlockSize = 1;
+        }
+        unsigned long stripRows = yBlockSize;
+        while(((stripRows * this->nXPxl) < 65536) & (stripRows < this->nYPxl))
+        {
+            stripRows += yBlockSize;
+        }
+        std::vector<unsigned char> outVals(stripRows * this->nXPxl);
+        for(unsigned long row = 0; row < this->nYPxl; row += stripRows)
+        {
+            unsigned long nRows = std::min(stripRows, this->nYPxl - row);
+            size_t idx = row * this->nXPxl;
+            size_t numStripPxls = nRows * this->nXPxl;
+            for(size_t k = 0; k < numStripPxls; ++k, ++idx)
+            {
+                outVals[k] = this->testBit(shadowBits, idx)?1:0;
+            }
+            if(shadowBand->RasterIO(GF_Write, 0, row, this->nXPxl, nRows, outVals.data(), this->nXPxl, nRows, GDT_Byte, 0, 0) != CE_None)
+            {
+                throw rsgis::img::RSGISImageCalcException("Could not write the cloud shadow image.");
+            }
+        }
+    }
+    
+    
     RSGISEditCloudShadowImg::RSGISEditCloudShadowImg(GDALDataset *testImg, int band)
     {
         this->testImg = testImg;
@@ -26,6 +26,8 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <math.h>
 
 #include "gdal_priv.h"
@@ -40,6 +42,7 @@
 #include "img/RSGISCalcImage.h"
 #include "img/RSGISImageStatistics.h"
 #include "img/RSGISExtractImageValues.h"
+#include "img/RSGISImageThreadUtils.h"
 
 #include "rastergis/RSGISPopRATWithStats.h"
 #include "rastergis/RSGISRasterAttUtils.h"
@@ -47,6 +50,8 @@
 
 #include "math/RSGISMathsUtils.h"
 
+#include <boost/cstdint.hpp>
+
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
 #undef DllExport
@@ -279,10 +284,52 @@ namespace rsgis{namespace calib{
         RSGISCalcCloudParams(){};
         void calcCloudHeights(GDALDataset *thermal, GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeights, double lowerLandThres, double upperLandThres, float scaleFactor);
         void calcCloudHeightsNoThermal(GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeightsDS);
-        void projFitCloudShadow(GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeights, GDALDataset *potentCloudShadowRegions, GDALDataset *cloudShadowTestRegionsDS, GDALDataset *cloudShadowRegionsDS, double sunAz, double sunZen, double senAz, double senZen);
+        void projFitCloudShadow(GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeights, GDALDataset *potentCloudShadowRegions, GDALDataset *cloudShadowRegionsDS, double sunAz, double sunZen, double senAz, double senZen, unsigned int numThreads=0);
         ~RSGISCalcCloudParams(){};
     };
     
+    /**
+     * Projects cloud pixels onto the ground at a given cloud base height and
+     * measures how much of the projected shadow falls within the potential
+     * cloud shadow mask. The cloud and potential shadow masks are held in
+     * memory as bitsets (one bit per pixel) and the cloud pixels are grouped
+     * by clump, so fitting the shadow of a cloud does not touch GDAL and the
+     * clouds can be fitted in parallel (the const functions are thread safe
+     * given separate working vectors).
+     */
+    class DllExport RSGISCloudShadowFit
+    {
+    public:
+        RSGISCloudShadowFit(GDALDataset *cloudClumpsDS, GDALDataset *initCloudHeights, GDALDataset *potentCloudShadowRegions, size_t numClumps, int *clumpsHisto, double sunAz, double sunZen);
+        bool projectShadow(size_t clump, double baseHeight, std::vector<size_t> *shadPxls, std::vector<boost::uint64_t> *winBits) const;
+        bool calcShadowOverlap(const std::vector<size_t> *shadPxls, double *cloudPropOverlap, unsigned long *numPxlOverlap) const;
+        double fitBaseHeight(size_t clump, double hBaseMin, double hBaseMax, std::vector<size_t> *shadPxls, std::vector<boost::uint64_t> *winBits) const;
+        void writeShadowMask(GDALDataset *cloudShadowRegionsDS, const double *baseHeights);
+        ~RSGISCloudShadowFit(){};
+    protected:
+        inline bool testBit(const std::vector<boost::uint64_t> &bits, size_t idx) const {return (bits[idx >> 6] >> (idx & 63)) & 1;};
+        inline void setBit(std::vector<boost::uint64_t> &bits, size_t idx) const {bits[idx >> 6] |= (((boost::uint64_t)1) << (idx & 63));};
+        size_t numClumps;
+        double tlX;
+        double tlY;
+        double brX;
+        double brY;
+        double xRes;
+        double yRes;
+        unsigned long nXPxl;
+        unsigned long nYPxl;
+        double sinSunAz;
+        double cosSunAz;
+        double tanSunZen;
+        std::vector<boost::uint64_t> clearBits;
+        std::vector<boost::uint64_t> potentBits;
+        // Pixels of cloud i are cloudPxlX/Y/Hgt[cloudOffsets[i]] to [cloudOffsets[i+1]-1].
+        std::vector<size_t> cloudOffsets;
+        std::vector<unsigned int> cloudPxlX;
+        std::vector<unsigned int> cloudPxlY;
+        std::vector<float> cloudPxlHgt;
+    };
+    
     class DllExport RSGISCalcCloudShadowCorrespondance : public rsgis::img::RSGISCalcImageValue
     {
     public:
@@ -111,9 +111,13 @@ namespace rsgis{namespace calib{
             rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&initOutImg);
             calcImage.calcImageWindowData(&inValidImgDS, 1, outImgDS, 3, true);
             
+            rsgis::img::RSGISImageTileCache<float> validCache(inValidImgDS->GetRasterBand(1));
+            rsgis::img::RSGISImageTileCache<float> demCache(inDEMImgDS->GetRasterBand(1));
+            rsgis::img::RSGISImageTileCache<float> outCache(outImgDS->GetRasterBand(1), true);
+            
             if(pxQ[0]->size() == 0)
             {
-                this->getImagesEdgesToInitFill(outImgDS->GetRasterBand(1), borderVal, pxQ[0]);
+                this->getImagesEdgesToInitFill(&outCache, borderVal, pxQ[0]);
                 //throw rsgis::img::RSGISImageCalcException("The were no edge pixels with the valid mask.");
             }
             
@@ -132,16 +136,16 @@ namespace rsgis{namespace calib{
                     pxl = this->qPopFront(hcrt);
 
                     // Get Neightbours
-                    std::list<Q2DPxl> *nPxls = this->getNeighbours(pxl, inValidImgDS->GetRasterBand(1));
+                    std::list<Q2DPxl> *nPxls = this->getNeighbours(pxl, &validCache);
                     for(std::list<Q2DPxl>::iterator iterNPxls = nPxls->begin(); iterNPxls != nPxls->end(); ++iterNPxls)
                     {
-                        imgVal = this->getPxlVal((*iterNPxls), inDEMImgDS->GetRasterBand(1));
-                        img2Val = this->getPxlVal((*iterNPxls), outImgDS->GetRasterBand(1));
+                        imgVal = this->getPxlVal((*iterNPxls), &demCache);
+                        img2Val = this->getPxlVal((*iterNPxls), &outCache);
 
                         if(img2Val == maxVal)
                         {
                             img2Val = this->rtnMax(hcrt, imgVal);
-                            this->setPxlVal((*iterNPxls), img2Val, outImgDS->GetRasterBand(1));
+                            this->setPxlVal((*iterNPxls), img2Val, &outCache);
                             if(img2Val < maxVal)
                             {
                                 this->qPushBack(img2Val, (*iterNPxls));
@@ -154,6 +158,7 @@ namespace rsgis{namespace calib{
                 
                 ++hcrt;
             }
+            outCache.flush();
             pbar.finish();
             
             for(long n = 0; n < numLevels; ++n)
@@ -197,12 +202,12 @@ namespace rsgis{namespace calib{
         pxQ[qIdx]->push_back(pxl);
     }
     
-    std::list<Q2DPxl>* RSGISHydroDEMFillSoilleGratin94::getNeighbours(Q2DPxl pxl, GDALRasterBand *inValidImg) 
+    std::list<Q2DPxl>* RSGISHydroDEMFillSoilleGratin94::getNeighbours(Q2DPxl pxl, rsgis::img::RSGISImageTileCache<float> *inValidImg) 
     {
         std::list<Q2DPxl> *nPxls = new std::list<Q2DPxl>();
         
-        long width = inValidImg->GetXSize();
-        long height = inValidImg->GetYSize();
+        long width = inValidImg->getXSize();
+        long height = inValidImg->getYSize();
         
         long minXPxl = pxl.x - 1;
         long maxXPxl = pxl.x + 1;
@@ -239,7 +244,7 @@ namespace rsgis{namespace calib{
             {
                 if(!((cPxlX == pxl.x) & (cPxlY == pxl.y)))
                 {
-                    inValidImg->RasterIO(GF_Read, cPxlX, cPxlY, 1, 1, &dataVal, 1, 1, GDT_Float32, 0, 0);
+                    dataVal = inValidImg->getValue(cPxlX, cPxlY);
 
                     if(dataVal == 1)
                     {
@@ -254,17 +259,14 @@ namespace rsgis{namespace calib{
         return nPxls;
     }
     
-    long RSGISHydroDEMFillSoilleGratin94::getPxlVal(Q2DPxl pxl, GDALRasterBand *imgData)
+    long RSGISHydroDEMFillSoilleGratin94::getPxlVal(Q2DPxl pxl, rsgis::img::RSGISImageTileCache<float> *imgData)
     {
-        float outVal = 0;
-        imgData->RasterIO(GF_Read, pxl.x, pxl.y, 1, 1, &outVal, 1, 1, GDT_Float32, 0, 0);
-        return (long)outVal;
+        return (long)imgData->getValue(pxl.x, pxl.y);
     }
     
-    void RSGISHydroDEMFillSoilleGratin94::setPxlVal(Q2DPxl pxl, long val, GDALRasterBand *imgData)
+    void RSGISHydroDEMFillSoilleGratin94::setPxlVal(Q2DPxl pxl, long val, rsgis::img::RSGISImageTileCache<float> *imgData)
     {
-        float outVal = val;
-        imgData->RasterIO(GF_Write, pxl.x, pxl.y, 1, 1, &outVal, 1, 1, GDT_Float32, 0, 0);
+        imgData->setValue(pxl.x, pxl.y, val);
     }
     
     long RSGISHydroDEMFillSoilleGratin94::rtnMax(long val1, long val2)
@@ -277,12 +279,12 @@ namespace rsgis{namespace calib{
         return outVal;
     }
     
-    void RSGISHydroDEMFillSoilleGratin94::getImagesEdgesToInitFill(GDALRasterBand *imgData, double borderVal, std::list<Q2DPxl> *pxQ)
+    void RSGISHydroDEMFillSoilleGratin94::getImagesEdgesToInitFill(rsgis::img::RSGISImageTileCache<float> *imgData, double borderVal, std::list<Q2DPxl> *pxQ)
     {
         try
         {
-            unsigned int xSize = imgData->GetXSize();
-            unsigned int ySize = imgData->GetYSize();
+            unsigned int xSize = imgData->getXSize();
+            unsigned int ySize = imgData->getYSize();
             
             //std::cout << "[" << xSize << ", " << ySize << "]\n";
             
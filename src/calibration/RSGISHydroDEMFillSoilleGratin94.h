@@ -45,6 +45,7 @@
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISExtractImagePixelsInPolygon.h"
 #include "img/RSGISImageStatistics.h"
+#include "img/RSGISImageTileCache.h"
 
 #include "math/RSGISMathsUtils.h"
 
@@ -93,11 +94,11 @@ namespace rsgis{namespace calib{
         bool qEmpty(long hcrt);
         Q2DPxl qPopFront(long hcrt);
         void qPushBack(long hcrt, Q2DPxl pxl);
-        std::list<Q2DPxl>* getNeighbours(Q2DPxl pxl, GDALRasterBand *inValidImg);
-        long getPxlVal(Q2DPxl pxl, GDALRasterBand *imgData);
-        void setPxlVal(Q2DPxl pxl, long val, GDALRasterBand *imgData);
+        std::list<Q2DPxl>* getNeighbours(Q2DPxl pxl, rsgis::img::RSGISImageTileCache<float> *inValidImg);
+        long getPxlVal(Q2DPxl pxl, rsgis::img::RSGISImageTileCache<float> *imgData);
+        void setPxlVal(Q2DPxl pxl, long val, rsgis::img::RSGISImageTileCache<float> *imgData);
         long rtnMax(long val1, long val2);
-        void getImagesEdgesToInitFill(GDALRasterBand *imgData, double borderVal, std::list<Q2DPxl> *pxQ);
+        void getImagesEdgesToInitFill(rsgis::img::RSGISImageTileCache<float> *imgData, double borderVal, std::list<Q2DPxl> *pxQ);
         std::list<Q2DPxl> **pxQ;
         long minVal;
         long maxVal;
@@ -0,0 +1,344 @@
+/*
+ *  RSGISTerrainDerivatives.cpp
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISTerrainDerivatives.h"
+
+namespace rsgis{namespace calib{
+    
+    RSGISTerrainDerivatives::RSGISTerrainDerivatives(std::vector<RSGISTerrainDerivativeType> derivatives, float sunZenith, float sunAzimuth, float viewZenith, float viewAzimuth, bool slopeInDegrees, unsigned int numThreads)
+    {
+        this->derivatives = derivatives;
+        this->sunZenith = sunZenith;
+        this->sunAzimuth = sunAzimuth;
+        this->viewZenith = viewZenith;
+        this->viewAzimuth = viewAzimuth;
+        this->slopeInDegrees = slopeInDegrees;
+        this->numThreads = numThreads;
+        this->ewRes = 1;
+        this->nsRes = 1;
+        
+        const double degreesToRadians = M_PI / 180.0;
+        this->sunZenRad = sunZenith * degreesToRadians;
+        this->sunAzRad = sunAzimuth * degreesToRadians;
+        
+        // The hillshade uses the azimuth anti-clockwise from east.
+        double hillshadeAz = (360 - sunAzimuth) + 90;
+        if(hillshadeAz > 360)
+        {
+            hillshadeAz = hillshadeAz - 360;
+        }
+        this->hillshadeAzRad = hillshadeAz * degreesToRadians;
+        
+        // Unit vectors of the incident and exitance rays.
+        this->sunVec[0] = sin(this->sunZenRad) * cos(this->sunAzRad);
+        this->sunVec[1] = sin(this->sunZenRad) * sin(this->sunAzRad);
+        this->sunVec[2] = cos(this->sunZenRad);
+        double viewZenRad = viewZenith * degreesToRadians;
+        double viewAzRad = viewAzimuth * degreesToRadians;
+        this->viewVec[0] = sin(viewZenRad) * cos(viewAzRad);
+        this->viewVec[1] = sin(viewZenRad) * sin(viewAzRad);
+        this->viewVec[2] = cos(viewZenRad);
+    }
+    
+    void RSGISTerrainDerivatives::calcTerrainDerivatives(GDALDataset *dem, unsigned int band, double noDataVal, GDALDataset *outDS)
+    {
+        try
+        {
+            if((band == 0) | (band > ((unsigned int)dem->GetRasterCount())))
+            {
+                throw rsgis::img::RSGISImageCalcException("Specified image band is not within the image.");
+            }
+            if(this->derivatives.empty())
+            {
+                throw rsgis::img::RSGISImageCalcException("No terrain derivatives have been specified.");
+            }
+            if(((unsigned int)outDS->GetRasterCount()) != this->derivatives.size())
+            {
+                throw rsgis::img::RSGISImageCalcException("The output image must have one band for each terrain derivative.");
+            }
+            
+            unsigned int width = dem->GetRasterXSize();
+            unsigned int height = dem->GetRasterYSize();
+            if((((unsigned int)outDS->GetRasterXSize()) != width) | (((unsigned int)outDS->GetRasterYSize()) != height))
+            {
+                throw rsgis::img::RSGISImageCalcException("The output image is not the same size as the DEM.");
+            }
+            
+            double *trans = new double[6];
+            dem->GetGeoTransform(trans);
+            this->ewRes = fabs(trans[1]);
+            this->nsRes = fabs(trans[5]);
+            delete[] trans;
+            
+            for(unsigned int d = 0; d < this->derivatives.size(); ++d)
+            {
+                outDS->GetRasterBand(d+1)->SetDescription(getDerivativeName(this->derivatives[d]).c_str());
+            }
+            
+            int xBlockSize = 0;
+            int yBlockSize = 0;
+            dem->GetRasterBand(band)->GetBlockSize(&xBlockSize, &yBlockSize);
+            unsigned int stripRows = yBlockSize;
+            while((((size_t)stripRows) * width) < 65536)
+            {
+                stripRows += yBlockSize;
+            }
+            size_t numStrips = (height + stripRows - 1) / stripRows;
+            
+            rsgis::img::RSGISImageThreadUtils threadUtils;
+            std::vector<GDALDataset*> handles = threadUtils.openDatasetHandles(dem, threadUtils.getNumThreads(this->numThreads));
+            
+            unsigned int numOutBands = this->derivatives.size();
+            float demNoData = noDataVal;
+            std::mutex writeMutex;
+            try
+            {
+                threadUtils.runTasks(handles.size(), numStrips, [&](unsigned int threadIdx, size_t strip)
+                {
+                    unsigned int startRow = strip * stripRows;
+                    unsigned int endRow = std::min(startRow + stripRows, height);
+                    unsigned int readStart = (startRow > 0)?(startRow - 1):0;
+                    unsigned int readEnd = std::min(endRow + 1, height);
+                    unsigned int numReadRows = readEnd - readStart;
+                    unsigned int numStripRows = endRow - startRow;
+                    
+                    std::vector<float> demVals(((size_t)numReadRows) * width);
+                    if(handles[threadIdx]->GetRasterBand(band)->RasterIO(GF_Read, 0, readStart, width, numReadRows, demVals.data(), width, numReadRows, GDT_Float32, 0, 0) != CE_None)
+                    {
+                        throw rsgis::img::RSGISImageCalcException("Failed to read the DEM.");
+                    }
+                    
+                    std::vector<float> outVals(((size_t)numStripRows) * width * numOutBands);
+                    std::vector<float> pxlOut(numOutBands);
+                    double win[3][3];
+                    bool noData[3][3];
+                    for(unsigned int y = startRow; y < endRow; ++y)
+                    {
+                        for(unsigned int x = 0; x < width; ++x)
+                        {
+                            bool hasNoDataVal = false;
+                            double sumVals = 0.0;
+                            int nVals = 0;
+                            for(int i = 0; i < 3; ++i)
+                            {
+                                long wy = ((long)y) + i - 1;
+                                for(int j = 0; j < 3; ++j)
+                                {
+                                    long wx = ((long)x) + j - 1;
+                                    noData[i][j] = true;
+                                    if((wy >= 0) && (wy < height) && (wx >= 0) && (wx < width))
+                                    {
+                                        float val = demVals[(((size_t)(wy - readStart)) * width) + wx];
+                                        if((val != demNoData) && (!boost::math::isnan(val)))
+                                        {
+                                            noData[i][j] = false;
+                                            win[i][j] = val;
+                                            sumVals += val;
+                                            ++nVals;
+                                        }
+                                    }
+                                    hasNoDataVal = hasNoDataVal || noData[i][j];
+                                }
+                            }
+                            if(hasNoDataVal && (nVals > 0))
+                            {
+                                double meanVal = sumVals / nVals;
+                                for(int i = 0; i < 3; ++i)
+                                {
+                                    for(int j = 0; j < 3; ++j)
+                                    {
+                                        if(noData[i][j])
+                                        {
+                                            win[i][j] = meanVal;
+                                        }
+                                    }
+                                }
+                            }
+                            
+                            this->calcPixelDerivatives(win, nVals, pxlOut.data());
+                            size_t outIdx = (((size_t)(y - startRow)) * width) + x;
+                            for(unsigned int d = 0; d < numOutBands; ++d)
+                            {
+                                outVals[(((size_t)d) * numStripRows * width) + outIdx] = pxlOut[d];
+                            }
+                        }
+                    }
+                    
+                    std::lock_guard<std::mutex> lock(writeMutex);
+                    for(unsigned int d = 0; d < numOutBands; ++d)
+                    {
+                        if(outDS->GetRasterBand(d+1)->RasterIO(GF_Write, 0, startRow, width, numStripRows, &outVals[((size_t)d) * numStripRows * width], width, numStripRows, GDT_Float32, 0, 0) != CE_None)
+                        {
+                            throw rsgis::img::RSGISImageCalcException("Failed to write the terrain derivatives.");
+                        }
+                    }
+                });
+            }
+            catch(rsgis::img::RSGISImageCalcException &e)
+            {
+                threadUtils.closeDatasetHandles(&handles);
+                throw e;
+            }
+            threadUtils.closeDatasetHandles(&handles);
+        }
+        catch(rsgis::img::RSGISImageCalcException &e)
+        {
+            throw e;
+        }
+    }
+    
+    std::string RSGISTerrainDerivatives::getDerivativeName(RSGISTerrainDerivativeType derivative)
+    {
+        std::string name = "";
+        switch(derivative)
+        {
+            case rsgis_terrain_slope:
+                name = "Slope";
+                break;
+            case rsgis_terrain_aspect:
+                name = "Aspect";
+                break;
+            case rsgis_terrain_hillshade:
+                name = "Hillshade";
+                break;
+            case rsgis_terrain_curvature:
+                name = "Curvature";
+                break;
+            case rsgis_terrain_tpi:
+                name = "TPI";
+                break;
+            case rsgis_terrain_incidence:
+                name = "Incidence";
+                break;
+            case rsgis_terrain_exitance:
+                name = "Exitance";
+                break;
+        }
+        return name;
+    }
+    
+    void RSGISTerrainDerivatives::calcPixelDerivatives(double win[3][3], int nVals, float *outVals)
+    {
+        const double radiansToDegrees = 180.0 / M_PI;
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        bool valid = nVals > 1;
+        
+        // Horn gradient (east and south positive), shared by all the derivatives.
+        double dx = 0.0;
+        double dy = 0.0;
+        double slopeRad = 0.0;
+        double aspect = nan;
+        if(valid)
+        {
+            dx = ((win[0][2] + win[1][2] + win[1][2] + win[2][2]) - (win[0][0] + win[1][0] + win[1][0] + win[2][0]))/this->ewRes;
+            dy = ((win[2][0] + win[2][1] + win[2][1] + win[2][2]) - (win[0][0] + win[0][1] + win[0][1] + win[0][2]))/this->nsRes;
+            slopeRad = atan(sqrt((dx * dx) + (dy * dy))/8);
+            if((dx != 0) || (dy != 0))
+            {
+                aspect = atan2(-dx, dy)*radiansToDegrees;
+                if(aspect < 0)
+                {
+                    aspect += 360.0;
+                }
+                if(aspect >= 360.0)
+                {
+                    aspect = 0.0;
+                }
+            }
+        }
+        
+        for(unsigned int d = 0; d < this->derivatives.size(); ++d)
+        {
+            double outVal = 0.0;
+            switch(this->derivatives[d])
+            {
+                case rsgis_terrain_slope:
+                {
+                    outVal = this->slopeInDegrees?(slopeRad * radiansToDegrees):slopeRad;
+                    break;
+                }
+                case rsgis_terrain_aspect:
+                {
+                    outVal = aspect;
+                    break;
+                }
+                case rsgis_terrain_hillshade:
+                {
+                    outVal = 1.0;
+                    if(valid)
+                    {
+                        double hsDX = dx / 8;
+                        double hsDY = -dy / 8;
+                        double xx_plus_yy = (hsDX * hsDX) + (hsDY * hsDY);
+                        double cang = (sin(this->sunZenRad) - cos(this->sunZenRad) * sqrt(xx_plus_yy) * sin(atan2(hsDY, hsDX) - (this->hillshadeAzRad - M_PI/2))) / sqrt(1 + xx_plus_yy);
+                        outVal = (cang <= 0.0)?1.0:(1.0 + (254.0 * cang));
+                    }
+                    break;
+                }
+                case rsgis_terrain_curvature:
+                {
+                    if(valid)
+                    {
+                        double dxx = (((win[1][0] + win[1][2]) / 2) - win[1][1]) / (this->ewRes * this->ewRes);
+                        double dyy = (((win[0][1] + win[2][1]) / 2) - win[1][1]) / (this->nsRes * this->nsRes);
+                        outVal = -2 * (dxx + dyy) * 100;
+                    }
+                    break;
+                }
+                case rsgis_terrain_tpi:
+                {
+                    if(valid)
+                    {
+                        double sumNeighbours = win[0][0] + win[0][1] + win[0][2] + win[1][0] + win[1][2] + win[2][0] + win[2][1] + win[2][2];
+                        outVal = win[1][1] - (sumNeighbours / 8);
+                    }
+                    break;
+                }
+                case rsgis_terrain_incidence:
+                case rsgis_terrain_exitance:
+                {
+                    bool incidence = this->derivatives[d] == rsgis_terrain_incidence;
+                    const double *rayVec = incidence?this->sunVec:this->viewVec;
+                    double fallback = incidence?this->sunZenith:0.0;
+                    outVal = fallback;
+                    if(valid)
+                    {
+                        // Flat areas have no aspect; the exitance angle takes it as north.
+                        double aspectRad = boost::math::isnan(aspect)?(incidence?nan:0.0):(aspect / radiansToDegrees);
+                        double pA = sin(slopeRad) * cos(aspectRad);
+                        double pB = sin(slopeRad) * sin(aspectRad);
+                        double pC = cos(slopeRad);
+                        outVal = acos((pA*rayVec[0])+(pB*rayVec[1])+(pC*rayVec[2])) * radiansToDegrees;
+                        if(boost::math::isnan(outVal))
+                        {
+                            outVal = fallback;
+                        }
+                    }
+                    break;
+                }
+            }
+            outVals[d] = outVal;
+        }
+    }
+    
+}}
+
@@ -0,0 +1,114 @@
+/*
+ *  RSGISTerrainDerivatives.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISTerrainDerivatives_h
+#define RSGISTerrainDerivatives_h
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <limits>
+#include <mutex>
+#include <math.h>
+
+#include "gdal_priv.h"
+
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISImageThreadUtils.h"
+
+#include <boost/math/special_functions/fpclassify.hpp>
+
+#ifndef M_PI
+# define M_PI  3.1415926535897932384626433832795
+#endif
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_calib_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace calib{
+    
+    enum RSGISTerrainDerivativeType
+    {
+        rsgis_terrain_slope,
+        rsgis_terrain_aspect,
+        rsgis_terrain_hillshade,
+        rsgis_terrain_curvature,
+        rsgis_terrain_tpi,
+        rsgis_terrain_incidence,
+        rsgis_terrain_exitance
+    };
+    
+    /**
+     * Calculates any subset of slope, aspect, hillshade, curvature, topographic
+     * position index (TPI), local incidence and local exitance angles from a DEM
+     * in a single pass, writing one output band per derivative in the order given.
+     * The 3x3 gradient is calculated once per pixel and shared by all the outputs.
+     * Strips of the DEM (with a one row halo) are processed in parallel, each
+     * thread reading through its own dataset handle.
+     *
+     * Slope, aspect, hillshade, incidence and exitance match RSGISCalcSlope,
+     * RSGISCalcAspect, RSGISCalcHillShade, RSGISCalcRayIncidentAngle and
+     * RSGISCalcRayExitanceAngle, including the filling of no data values within
+     * the window with the window mean. Pixels outside the image are treated as
+     * no data. Curvature is the Zevenbergen and Thorne (1987) curvature (1/100 z
+     * units, negative for convex) and TPI is the elevation minus the mean of the
+     * eight neighbours.
+     */
+    class DllExport RSGISTerrainDerivatives
+    {
+    public:
+        RSGISTerrainDerivatives(std::vector<RSGISTerrainDerivativeType> derivatives, float sunZenith=0, float sunAzimuth=0, float viewZenith=0, float viewAzimuth=0, bool slopeInDegrees=true, unsigned int numThreads=0);
+        void calcTerrainDerivatives(GDALDataset *dem, unsigned int band, double noDataVal, GDALDataset *outDS);
+        static std::string getDerivativeName(RSGISTerrainDerivativeType derivative);
+        ~RSGISTerrainDerivatives(){};
+    protected:
+        void calcPixelDerivatives(double win[3][3], int nVals, float *outVals);
+        std::vector<RSGISTerrainDerivativeType> derivatives;
+        float sunZenith;
+        float sunAzimuth;
+        float viewZenith;
+        float viewAzimuth;
+        bool slopeInDegrees;
+        unsigned int numThreads;
+        double ewRes;
+        double nsRes;
+        double sunZenRad;
+        double sunAzRad;
+        double hillshadeAzRad;
+        double sunVec[3];
+        double viewVec[3];
+    };
+    
+}}
+
+#endif
+
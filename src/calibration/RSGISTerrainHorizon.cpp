@@ -0,0 +1,565 @@
+/*
+ *  RSGISTerrainHorizon.cpp
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISTerrainHorizon.h"
+
+namespace rsgis{namespace calib{
+    
+    RSGISTerrainHorizon::RSGISTerrainHorizon(GDALDataset *dem, unsigned int band, double noDataVal, unsigned int numThreads)
+    {
+        try
+        {
+            if((band == 0) | (band > ((unsigned int)dem->GetRasterCount())))
+            {
+                throw rsgis::img::RSGISImageCalcException("Specified image band is not within the image.");
+            }
+            
+            rsgis::img::RSGISImageThreadUtils threadUtils;
+            this->numThreads = threadUtils.getNumThreads(numThreads);
+            this->noDataVal = noDataVal;
+            this->demBand = dem->GetRasterBand(band);
+            this->width = dem->GetRasterXSize();
+            this->height = dem->GetRasterYSize();
+            
+            double *trans = new double[6];
+            dem->GetGeoTransform(trans);
+            this->ewRes = fabs(trans[1]);
+            this->nsRes = fabs(trans[5]);
+            delete[] trans;
+            if((this->ewRes == 0) | (this->nsRes == 0))
+            {
+                throw rsgis::img::RSGISImageCalcException("The DEM must have a non-zero pixel resolution.");
+            }
+        }
+        catch(rsgis::img::RSGISImageCalcException &e)
+        {
+            throw e;
+        }
+    }
+    
+    void RSGISTerrainHorizon::calcShadowMask(float sunZenith, float sunAzimuth, GDALDataset *outDS, unsigned int outBand)
+    {
+        try
+        {
+            this->checkOutputImage(outDS);
+            
+            double sunZenRad = sunZenith * (M_PI / 180.0);
+            double sunAzRad = sunAzimuth * (M_PI / 180.0);
+            double sunElevSlope = tan((M_PI / 2.0) - sunZenRad);
+            
+            // Terrain further away than this cannot rise above the sun seen from the lowest pixel.
+            double maxSearchDist = 0.0;
+            if(sunElevSlope > 0)
+            {
+                double minElev = 0.0;
+                double maxElev = 0.0;
+                this->calcElevRange(&minElev, &maxElev);
+                maxSearchDist = std::max((maxElev - minElev) / sunElevSlope, std::max(this->ewRes, this->nsRes));
+            }
+            
+            rsgis::img::RSGISImageThreadUtils threadUtils;
+            std::vector<float> horizonSlopes;
+            std::vector<unsigned char> shadowMask;
+            this->processStrips(maxSearchDist, [&](const DEMStrip &strip)
+            {
+                this->calcHorizonSlopes(strip, sunAzimuth, maxSearchDist, &horizonSlopes);
+                shadowMask.assign(((size_t)this->width) * strip.outRows, 0);
+                threadUtils.runTasks(this->numThreads, strip.outRows, [&](unsigned int threadIdx, size_t row)
+                {
+                    unsigned int y = strip.outRow + row;
+                    size_t idx = ((size_t)y) * this->width;
+                    unsigned char *mask = &shadowMask[row * this->width];
+                    for(unsigned int x = 0; x < this->width; ++x, ++idx)
+                    {
+                        if(this->isNoData(strip.vals[idx]))
+                        {
+                            continue;
+                        }
+                        if((horizonSlopes[idx] > sunElevSlope) || this->isSelfShadowed(strip, x, y, sunZenRad, sunAzRad))
+                        {
+                            mask[x] = 1;
+                        }
+                    }
+                }, true);
+                this->writeStripBand(outDS, outBand, strip, shadowMask.data(), GDT_Byte);
+            });
+        }
+        catch(rsgis::img::RSGISImageCalcException &e)
+        {
+            throw e;
+        }
+    }
+    
+    void RSGISTerrainHorizon::calcHorizonAngles(unsigned int numAzimuths, double maxSearchDist, GDALDataset *outDS)
+    {
+        try
+        {
+            if(numAzimuths == 0)
+            {
+                throw rsgis::img::RSGISImageCalcException("At least one azimuth is required to calculate the horizon angles.");
+            }
+            this->checkOutputImage(outDS);
+            if(((unsigned int)outDS->GetRasterCount()) < numAzimuths)
+            {
+                throw rsgis::img::RSGISImageCalcException("The output image does not have a band for each azimuth.");
+            }
+            
+            const double radiansToDegrees = 180.0 / M_PI;
+            std::vector<float> horizonSlopes;
+            std::vector<float> horizonAngles;
+            this->processStrips(maxSearchDist, [&](const DEMStrip &strip)
+            {
+                size_t outOff = ((size_t)strip.outRow) * this->width;
+                size_t numOutPxls = ((size_t)strip.outRows) * this->width;
+                horizonAngles.resize(numOutPxls);
+                for(unsigned int a = 0; a < numAzimuths; ++a)
+                {
+                    this->calcHorizonSlopes(strip, (360.0 * a) / numAzimuths, maxSearchDist, &horizonSlopes);
+                    for(size_t i = 0; i < numOutPxls; ++i)
+                    {
+                        float slope = horizonSlopes[outOff + i];
+                        horizonAngles[i] = boost::math::isnan(slope)?this->noDataVal:(atan(slope) * radiansToDegrees);
+                    }
+                    this->writeStripBand(outDS, a+1, strip, horizonAngles.data(), GDT_Float32);
+                }
+            });
+        }
+        catch(rsgis::img::RSGISImageCalcException &e)
+        {
+            throw e;
+        }
+    }
+    
+    void RSGISTerrainHorizon::calcSkyViewFactor(unsigned int numAzimuths, double maxSearchDist, GDALDataset *outDS, unsigned int outBand)
+    {
+        try
+        {
+            if(numAzimuths == 0)
+            {
+                throw rsgis::img::RSGISImageCalcException("At least one azimuth is required to calculate the sky view factor.");
+            }
+            this->checkOutputImage(outDS);
+            
+            // Sky view factor is the mean of cos^2 of the horizon elevation; cos^2(atan(s)) = 1/(1+s^2).
+            std::vector<float> horizonSlopes;
+            std::vector<double> sumVals;
+            std::vector<float> skyViewFactor;
+            this->processStrips(maxSearchDist, [&](const DEMStrip &strip)
+            {
+                size_t outOff = ((size_t)strip.outRow) * this->width;
+                size_t numOutPxls = ((size_t)strip.outRows) * this->width;
+                sumVals.assign(numOutPxls, 0.0);
+                for(unsigned int a = 0; a < numAzimuths; ++a)
+                {
+                    this->calcHorizonSlopes(strip, (360.0 * a) / numAzimuths, maxSearchDist, &horizonSlopes);
+                    for(size_t i = 0; i < numOutPxls; ++i)
+                    {
+                        double s = horizonSlopes[outOff + i];
+                        sumVals[i] += (s > 0)?(1.0 / (1.0 + (s * s))):1.0;
+                    }
+                }
+                
+                skyViewFactor.resize(numOutPxls);
+                for(size_t i = 0; i < numOutPxls; ++i)
+                {
+                    skyViewFactor[i] = this->isNoData(strip.vals[outOff + i])?this->noDataVal:(sumVals[i] / numAzimuths);
+                }
+                this->writeStripBand(outDS, outBand, strip, skyViewFactor.data(), GDT_Float32);
+            });
+        }
+        catch(rsgis::img::RSGISImageCalcException &e)
+        {
+            throw e;
+        }
+    }
+    
+    void RSGISTerrainHorizon::processStrips(double maxSearchDist, std::function<void(const DEMStrip&)> stripFunc)
+    {
+        // The halo covers the rows a line can cross within the search distance, plus one for rounding and the 3x3 slope window.
+        unsigned int haloRows = this->height;
+        if(maxSearchDist > 0)
+        {
+            haloRows = (unsigned int)std::min<double>(ceil(maxSearchDist / this->nsRes) + 1, this->height);
+        }
+        
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        this->demBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int yStep = std::max(yBlockSize, 1);
+        unsigned int stripRows = yStep;
+        while(((((size_t)stripRows) * this->width) < 65536) && (stripRows < this->height))
+        {
+            stripRows += yStep;
+        }
+        // The halo rows are swept for every strip so the strips are kept at least twice the halo.
+        stripRows = std::max(stripRows, 2 * haloRows);
+        
+        DEMStrip strip;
+        for(unsigned int row = 0; row < this->height; row += stripRows)
+        {
+            strip.outRows = std::min(stripRows, this->height - row);
+            strip.yOff = (row > haloRows)?(row - haloRows):0;
+            strip.nRows = std::min(((size_t)row) + strip.outRows + haloRows, (size_t)this->height) - strip.yOff;
+            strip.outRow = row - strip.yOff;
+            strip.vals.resize(((size_t)this->width) * strip.nRows);
+            if(this->demBand->RasterIO(GF_Read, 0, strip.yOff, this->width, strip.nRows, strip.vals.data(), this->width, strip.nRows, GDT_Float32, 0, 0) != CE_None)
+            {
+                throw rsgis::img::RSGISImageCalcException("Failed to read the DEM.");
+            }
+            stripFunc(strip);
+        }
+    }
+    
+    void RSGISTerrainHorizon::calcHorizonSlopes(const DEMStrip &strip, float azimuth, double maxSearchDist, std::vector<float> *horizonSlopes)
+    {
+        size_t numPxls = ((size_t)this->width) * strip.nRows;
+        horizonSlopes->assign(numPxls, 0.0);
+        if(numPxls == 0)
+        {
+            return;
+        }
+        
+        // Direction of the azimuth in pixel units (azimuth clockwise from north, rows increase southwards).
+        double azRad = azimuth * (M_PI / 180.0);
+        double dCol = sin(azRad) / this->ewRes;
+        double dRow = -cos(azRad) / this->nsRes;
+        
+        // Lines are stepped one pixel at a time along the dominant axis.
+        bool colMajor = fabs(dCol) >= fabs(dRow);
+        int majorDir = ((colMajor?dCol:dRow) >= 0)?1:-1;
+        double minorPerStep = colMajor?(dRow/fabs(dCol)):(dCol/fabs(dRow));
+        double stepDist = colMajor?sqrt((this->ewRes*this->ewRes) + (minorPerStep*this->nsRes*minorPerStep*this->nsRes)):sqrt((this->nsRes*this->nsRes) + (minorPerStep*this->ewRes*minorPerStep*this->ewRes));
+        
+        // Lines are defined in image coordinates so they are the same whichever strip they are swept in.
+        long imgMajorLen = colMajor?this->width:this->height;
+        long majorOff = colMajor?0:strip.yOff;
+        long majorLen = colMajor?this->width:strip.nRows;
+        long minorOff = colMajor?strip.yOff:0;
+        long minorLen = colMajor?strip.nRows:this->width;
+        
+        std::vector<long> shifts(majorLen);
+        for(long m = 0; m < majorLen; ++m)
+        {
+            shifts[m] = lround((m + majorOff) * minorPerStep);
+        }
+        long minShift = *std::min_element(shifts.begin(), shifts.end());
+        long maxShift = *std::max_element(shifts.begin(), shifts.end());
+        // Line k holds the pixels (m, k + shifts[m]) so every pixel lies on exactly one line.
+        long firstLine = minorOff - maxShift;
+        long numLines = minorLen - minShift + maxShift;
+        
+        // Search distance in steps along the line (0 for the whole line).
+        long searchSteps = 0;
+        if((maxSearchDist > 0) && ((maxSearchDist / stepDist) < imgMajorLen))
+        {
+            searchSteps = std::max<long>(floor(maxSearchDist / stepDist), 1);
+        }
+        
+        const size_t linesPerTask = 256;
+        size_t numTasks = (numLines + linesPerTask - 1) / linesPerTask;
+        float *slopes = horizonSlopes->data();
+        const float *demVals = strip.vals.data();
+        unsigned int width = this->width;
+        const float noHorizon = -std::numeric_limits<float>::infinity();
+        
+        rsgis::img::RSGISImageThreadUtils threadUtils;
+        threadUtils.runTasks(this->numThreads, numTasks, [&](unsigned int threadIdx, size_t task)
+        {
+            // Profile of the line in the azimuth direction as (distance, elevation), with the step and pixel of each point.
+            std::vector<std::pair<double, double> > profile;
+            std::vector<long> profileSteps;
+            std::vector<size_t> profileIdxs;
+            // Upper convex hull of the profile as (distance, elevation).
+            std::vector<std::pair<double, double> > hull;
+            profile.reserve(majorLen);
+            profileSteps.reserve(majorLen);
+            profileIdxs.reserve(majorLen);
+            hull.reserve(majorLen);
+            long endLine = std::min(firstLine + (long)((task + 1) * linesPerTask), firstLine + numLines);
+            for(long k = firstLine + (long)(task * linesPerTask); k < endLine; ++k)
+            {
+                profile.clear();
+                profileSteps.clear();
+                profileIdxs.clear();
+                for(long i = 0; i < majorLen; ++i)
+                {
+                    long m = (majorDir > 0)?i:(majorLen - 1 - i);
+                    long minor = k + shifts[m] - minorOff;
+                    if((minor < 0) | (minor >= minorLen))
+                    {
+                        continue;
+                    }
+                    size_t idx = colMajor?((((size_t)minor) * width) + m):((((size_t)m) * width) + minor);
+                    if(this->isNoData(demVals[idx]))
+                    {
+                        slopes[idx] = std::numeric_limits<float>::quiet_NaN();
+                        continue;
+                    }
+                    long step = (majorDir > 0)?(m + majorOff):(imgMajorLen - 1 - (m + majorOff));
+                    profile.push_back(std::pair<double, double>(step * stepDist, demVals[idx]));
+                    profileSteps.push_back(step);
+                    profileIdxs.push_back(idx);
+                }
+                long numPts = profile.size();
+                
+                // The line is split into blocks of searchSteps so the terrain within the search
+                // distance is the rest of the pixel's block and the start of the next block.
+                
+                // Rest of the block, walking backwards from the end of the block.
+                hull.clear();
+                long block = -1;
+                for(long j = numPts - 1; j >= 0; --j)
+                {
+                    if(searchSteps > 0)
+                    {
+                        long pxlBlock = profileSteps[j] / searchSteps;
+                        if(pxlBlock != block)
+                        {
+                            hull.clear();
+                            block = pxlBlock;
+                        }
+                    }
+                    double dist = profile[j].first;
+                    double z = profile[j].second;
+                    
+                    while(hull.size() >= 2)
+                    {
+                        const std::pair<double, double> &top = hull[hull.size()-1];
+                        const std::pair<double, double> &second = hull[hull.size()-2];
+                        if(((top.second - z) / (top.first - dist)) <= ((second.second - z) / (second.first - dist)))
+                        {
+                            hull.pop_back();
+                        }
+                        else
+                        {
+                            break;
+                        }
+                    }
+                    slopes[profileIdxs[j]] = hull.empty()?noHorizon:((hull.back().second - z) / (hull.back().first - dist));
+                    hull.push_back(profile[j]);
+                }
+                
+                // Start of the next block up to the search distance, walking forwards.
+                if(searchSteps > 0)
+                {
+                    hull.clear();
+                    block = -1;
+                    long nextPt = 0;
+                    for(long j = 0; j < numPts; ++j)
+                    {
+                        long pxlBlock = profileSteps[j] / searchSteps;
+                        if(pxlBlock != block)
+                        {
+                            hull.clear();
+                            block = pxlBlock;
+                            while((nextPt < numPts) && (profileSteps[nextPt] < ((pxlBlock + 1) * searchSteps)))
+                            {
+                                ++nextPt;
+                            }
+                        }
+                        while((nextPt < numPts) && (profileSteps[nextPt] <= (profileSteps[j] + searchSteps)))
+                        {
+                            const std::pair<double, double> &pt = profile[nextPt];
+                            while(hull.size() >= 2)
+                            {
+                                const std::pair<double, double> &top = hull[hull.size()-1];
+                                const std::pair<double, double> &second = hull[hull.size()-2];
+                                if((((top.first - second.first) * (pt.second - second.second)) - ((top.second - second.second) * (pt.first - second.first))) >= 0)
+                                {
+                                    hull.pop_back();
+                                }
+                                else
+                                {
+                                    break;
+                                }
+                            }
+                            hull.push_back(pt);
+                            ++nextPt;
+                        }
+                        if(!hull.empty())
+                        {
+                            // The slopes to the hull vertices rise to the horizon and then fall.
+                            double dist = profile[j].first;
+                            double z = profile[j].second;
+                            size_t lower = 0;
+                            size_t upper = hull.size() - 1;
+                            while(lower < upper)
+                            {
+                                size_t mid = (lower + upper) / 2;
+                                if(((hull[mid+1].second - z) / (hull[mid+1].first - dist)) > ((hull[mid].second - z) / (hull[mid].first - dist)))
+                                {
+                                    lower = mid + 1;
+                                }
+                                else
+                                {
+                                    upper = mid;
+                                }
+                            }
+                            float slope = (hull[lower].second - z) / (hull[lower].first - dist);
+                            slopes[profileIdxs[j]] = std::max(slopes[profileIdxs[j]], slope);
+                        }
+                    }
+                }
+                
+                // Flat where there is no terrain ahead.
+                for(long j = 0; j < numPts; ++j)
+                {
+                    if(slopes[profileIdxs[j]] == noHorizon)
+                    {
+                        slopes[profileIdxs[j]] = 0.0;
+                    }
+                }
+            }
+        }, true);
+    }
+    
+    void RSGISTerrainHorizon::calcElevRange(double *minElev, double *maxElev)
+    {
+        *minElev = 0.0;
+        *maxElev = 0.0;
+        bool first = true;
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        this->demBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = std::max(yBlockSize, 1);
+        std::vector<float> vals(((size_t)this->width) * stripRows);
+        for(unsigned int row = 0; row < this->height; row += stripRows)
+        {
+            unsigned int nRows = std::min(stripRows, this->height - row);
+            if(this->demBand->RasterIO(GF_Read, 0, row, this->width, nRows, vals.data(), this->width, nRows, GDT_Float32, 0, 0) != CE_None)
+            {
+                throw rsgis::img::RSGISImageCalcException("Failed to read the DEM.");
+            }
+            size_t numPxls = ((size_t)this->width) * nRows;
+            for(size_t i = 0; i < numPxls; ++i)
+            {
+                if(this->isNoData(vals[i]))
+                {
+                    continue;
+                }
+                if(first)
+                {
+                    *minElev = vals[i];
+                    *maxElev = vals[i];
+                    first = false;
+                }
+                else if(vals[i] < *minElev)
+                {
+                    *minElev = vals[i];
+                }
+                else if(vals[i] > *maxElev)
+                {
+                    *maxElev = vals[i];
+                }
+            }
+        }
+    }
+    
+    void RSGISTerrainHorizon::checkOutputImage(GDALDataset *outDS)
+    {
+        if((((unsigned int)outDS->GetRasterXSize()) != this->width) | (((unsigned int)outDS->GetRasterYSize()) != this->height))
+        {
+            throw rsgis::img::RSGISImageCalcException("The output image is not the same size as the DEM.");
+        }
+    }
+    
+    void RSGISTerrainHorizon::writeStripBand(GDALDataset *outDS, unsigned int band, const DEMStrip &strip, void *data, GDALDataType dataType)
+    {
+        if(outDS->GetRasterBand(band)->RasterIO(GF_Write, 0, strip.yOff + strip.outRow, this->width, strip.outRows, data, this->width, strip.outRows, dataType, 0, 0) != CE_None)
+        {
+            throw rsgis::img::RSGISImageCalcException("Failed to write the output image band.");
+        }
+    }
+    
+    bool RSGISTerrainHorizon::isNoData(float val) const
+    {
+        return (val == ((float)this->noDataVal)) || boost::math::isnan(val);
+    }
+    
+    bool RSGISTerrainHorizon::isSelfShadowed(const DEMStrip &strip, unsigned int x, unsigned int y, double sunZenRad, double sunAzRad) const
+    {
+        // 3x3 window clamped at the image edge (the strip always has a row of halo within the image), no data filled with the window mean.
+        double win[3][3];
+        bool noData[3][3];
+        bool hasNoDataVal = false;
+        double sumVals = 0.0;
+        int nVals = 0;
+        for(int i = 0; i < 3; ++i)
+        {
+            long wy = std::min(std::max(((long)y) + i - 1, 0L), ((long)strip.nRows) - 1);
+            for(int j = 0; j < 3; ++j)
+            {
+                long wx = std::min(std::max(((long)x) + j - 1, 0L), ((long)this->width) - 1);
+                size_t idx = (((size_t)wy) * this->width) + wx;
+                noData[i][j] = this->isNoData(strip.vals[idx]);
+                win[i][j] = strip.vals[idx];
+                if(noData[i][j])
+                {
+                    hasNoDataVal = true;
+                }
+                else
+                {
+                    sumVals += win[i][j];
+                    ++nVals;
+                }
+            }
+        }
+        if(nVals <= 1)
+        {
+            return false;
+        }
+        if(hasNoDataVal)
+        {
+            double meanVal = sumVals / nVals;
+            for(int i = 0; i < 3; ++i)
+            {
+                for(int j = 0; j < 3; ++j)
+                {
+                    if(noData[i][j])
+                    {
+                        win[i][j] = meanVal;
+                    }
+                }
+            }
+        }
+        
+        double dx = ((win[0][2] + win[1][2] + win[1][2] + win[2][2]) - (win[0][0] + win[1][0] + win[1][0] + win[2][0]))/this->ewRes;
+        double dy = ((win[2][0] + win[2][1] + win[2][1] + win[2][2]) - (win[0][0] + win[0][1] + win[0][1] + win[0][2]))/this->nsRes;
+        if((dx == 0) && (dy == 0))
+        {
+            // Flat area
+            return false;
+        }
+        
+        double slopeRad = atan(sqrt((dx * dx) + (dy * dy))/8);
+        double aspect = atan2(-dx, dy);
+        if(aspect < 0)
+        {
+            aspect += 2 * M_PI;
+        }
+        
+        double ic = (cos(sunZenRad) * cos(slopeRad)) + (sin(sunZenRad) * sin(slopeRad) * cos(sunAzRad - aspect));
+        return ic < 0;
+    }
+    
+}}
+
@@ -0,0 +1,115 @@
+/*
+ *  RSGISTerrainHorizon.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISTerrainHorizon_h
+#define RSGISTerrainHorizon_h
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+#include "gdal_priv.h"
+
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISImageThreadUtils.h"
+
+#include <boost/math/special_functions/fpclassify.hpp>
+
+#ifndef M_PI
+# define M_PI  3.1415926535897932384626433832795
+#endif
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_calib_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace calib{
+    
+    /**
+     * Calculates terrain horizons from a DEM. For a given azimuth the DEM is swept
+     * along parallel lines in that direction; walking each line backwards an upper
+     * convex hull of the terrain profile ahead is kept, from which the horizon of
+     * each pixel is found in amortised constant time. Lines are processed in
+     * parallel. From the horizons a cast shadow mask, horizon angles and the sky
+     * view factor are derived. Where the profile leaves the DEM the horizon is
+     * taken as flat.
+     *
+     * The horizon is only searched to maxSearchDist (map units) and the DEM is
+     * read in strips of rows with a halo of that distance, so only the strip is
+     * held in memory. The result does not depend on the strip size. A search
+     * distance of 0 searches the whole DEM, which is then read as one strip.
+     */
+    class DllExport RSGISTerrainHorizon
+    {
+    public:
+        RSGISTerrainHorizon(GDALDataset *dem, unsigned int band, double noDataVal, unsigned int numThreads=0);
+        /** The search distance is the furthest terrain which could shadow the lowest pixel at the given sun elevation. */
+        void calcShadowMask(float sunZenith, float sunAzimuth, GDALDataset *outDS, unsigned int outBand);
+        /** One output band per azimuth, clockwise from north. */
+        void calcHorizonAngles(unsigned int numAzimuths, double maxSearchDist, GDALDataset *outDS);
+        void calcSkyViewFactor(unsigned int numAzimuths, double maxSearchDist, GDALDataset *outDS, unsigned int outBand);
+        unsigned int getWidth() const {return this->width;};
+        unsigned int getHeight() const {return this->height;};
+        double getNoDataValue() const {return this->noDataVal;};
+        ~RSGISTerrainHorizon(){};
+    protected:
+        struct DEMStrip
+        {
+            std::vector<float> vals;
+            unsigned int yOff;
+            unsigned int nRows;
+            unsigned int outRow;
+            unsigned int outRows;
+        };
+        void processStrips(double maxSearchDist, std::function<void(const DEMStrip&)> stripFunc);
+        void calcHorizonSlopes(const DEMStrip &strip, float azimuth, double maxSearchDist, std::vector<float> *horizonSlopes);
+        void calcElevRange(double *minElev, double *maxElev);
+        void checkOutputImage(GDALDataset *outDS);
+        void writeStripBand(GDALDataset *outDS, unsigned int band, const DEMStrip &strip, void *data, GDALDataType dataType);
+        bool isNoData(float val) const;
+        bool isSelfShadowed(const DEMStrip &strip, unsigned int x, unsigned int y, double sunZenRad, double sunAzRad) const;
+        GDALRasterBand *demBand;
+        unsigned int width;
+        unsigned int height;
+        double ewRes;
+        double nsRes;
+        double noDataVal;
+        unsigned int numThreads;
+    };
+    
+}}
+
+#endif
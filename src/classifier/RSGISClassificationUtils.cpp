@@ -318,49 +318,22 @@ namespace rsgis{ namespace classifier{
             outData = imgUtils.createCopy(inImageData, outputImage, format, inImageData->GetRasterBand(1)->GetRasterDataType());
             imgUtils.copyUIntGDALDataset(inImageData, outData);
             
-            unsigned long singlesCount = 0;
-            bool singlesRemoved = false;
+            if((filterConnectivity != rsgis::img::rsgis_4connect) & (filterConnectivity != rsgis::img::rsgis_8connect))
+            {
+                GDALClose(outData);
+                throw rsgis::img::RSGISImageCalcException("Connectivity not recoginised (Only 4 or 8 are valid inputs)");
+            }
             
-            while(!singlesRemoved)
+            try
             {
-                if(filterConnectivity == rsgis::img::rsgis_4connect)
-                {
-                    singlesCount = this->findSinglePixelsConnect4(outData, tmpData, noDataVal, noDataValProvided);
-                }
-                else if(filterConnectivity == rsgis::img::rsgis_8connect)
-                {
-                    singlesCount = this->findSinglePixelsConnect8(outData, tmpData, noDataVal, noDataValProvided);
-                }
-                else
-                {
-                    throw rsgis::img::RSGISImageCalcException("Connectivity not recoginised (Only 4 or 8 are valid inputs)");
-                }
-                
-                if(singlesCount > 0)
-                {
-                    std::cout << "There are " << singlesCount << " single pixels within the image\n";
-                    if(filterConnectivity == rsgis::img::rsgis_4connect)
-                    {
-                        if(!eliminateSinglePixelsConnect4(outData, tmpData, outData, noDataVal, noDataValProvided))
-                        {
-                            singlesRemoved = true;
-                            break;
-                        }
-                    }
-                    else//if(filterConnectivity == rsgis::img::rsgis_8connect)
-                    {
-                        if(!eliminateSinglePixelsConnect8(outData, tmpData, outData, noDataVal, noDataValProvided))
-                        {
-                            singlesRemoved = true;
-                            break;
-                        }
-                    }
-                }
-                else
-                {
-                    singlesRemoved = true;
-                    break;
-                }
+                RSGISMajoritySinglePxlReplacement majorityReplace;
+                rsgis::img::RSGISSinglePxlElimination elimSingles = rsgis::img::RSGISSinglePxlElimination(filterConnectivity, noDataValProvided, noDataVal);
+                elimSingles.eliminate(outData->GetRasterBand(1), tmpData->GetRasterBand(1), &majorityReplace);
+            }
+            catch(RSGISImageException &e)
+            {
+                GDALClose(outData);
+                throw e;
             }
             std::cout << "Complete, all connected single pixels have been removed\n";
             
@@ -377,1462 +350,32 @@ namespace rsgis{ namespace classifier{
         }
     }
     
-    unsigned long RSGISEliminateSingleClassPixels::findSinglePixelsConnect4(GDALDataset *inImageData, GDALDataset *tmpData, float noDataVal, bool noDataValProvided) 
+    RSGISEliminateSingleClassPixels::~RSGISEliminateSingleClassPixels()
     {
-        unsigned long countSingles = 0;
-        try
-        {
-            unsigned int width = inImageData->GetRasterXSize();
-            unsigned int height = inImageData->GetRasterYSize();
-            
-            GDALRasterBand *clumpBand = inImageData->GetRasterBand(1);
-            GDALRasterBand *tmpBand = tmpData->GetRasterBand(1);
-            
-            unsigned int **inData = new unsigned int*[3];
-            inData[0] = new unsigned int[width];
-            inData[1] = new unsigned int[width];
-            inData[2] = new unsigned int[width];
-            unsigned int *outData = new unsigned int[width];
-            bool notSingle = false;
-            
-            rsgis_tqdm pbar;
-            for(unsigned int i = 0; i < height; ++i)
-            {
-                pbar.progress(i, height);
-                if(i == 0)
-                {
-                    clumpBand->RasterIO(GF_Read, 0, i, width, 1, inData[1], width, 1, GDT_UInt32, 0, 0);
-                    clumpBand->RasterIO(GF_Read, 0, i+1, width, 1, inData[2], width, 1, GDT_UInt32, 0, 0);
-                    for(unsigned int j = 0; j < width; ++j)
-                    {
-                        notSingle = false;
-                        if((noDataValProvided & (inData[1][j] != noDataVal)) | !noDataValProvided)
-                        {
-                            if(j == 0)
-                            {
-                                //right
-                                if((j < width-1) && (inData[1][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom
-                                else if(inData[2][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                            else if(j == (width-1))
-                            {
-                                //left
-                                if((j > 0) && (inData[1][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom
-                                else if(inData[2][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                            else
-                            {
-                                //left
-                                if((j > 0) && (inData[1][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //right
-                                else if((j < width-1) && (inData[1][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom
-                                else if(inData[2][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                        }
-                        else
-                        {
-                            notSingle = true;
-                        }
-                        
-                        if(notSingle)
-                        {
-                            outData[j] = 0;
-                        }
-                        else
-                        {
-                            outData[j] = 1;
-                            ++countSingles;
-                        }
-                    }
-                }
-                else if(i == (height-1))
-                {
-                    clumpBand->RasterIO(GF_Read, 0, i-1, width, 1, inData[0], width, 1, GDT_UInt32, 0, 0);
-                    clumpBand->RasterIO(GF_Read, 0, i, width, 1, inData[1], width, 1, GDT_UInt32, 0, 0);
-                    for(unsigned int j = 0; j < width; ++j)
-                    {
-                        notSingle = false;
-                        if((noDataValProvided & (inData[1][j] != noDataVal)) | !noDataValProvided)
-                        {
-                            if(j == 0)
-                            {
-                                //top
-                                if(inData[0][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //right
-                                else if((j < width-1) && (inData[1][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                            else if(j == (width-1))
-                            {
-                                //top
-                                if(inData[0][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //left
-                                else if((j > 0) && (inData[1][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                            else
-                            {
-                                //top
-                                if(inData[0][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //left
-                                else if((j > 0) && (inData[1][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //right
-                                else if((j < width-1) && (inData[1][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                        }
-                        else
-                        {
-                            notSingle = true;
-                        }
-                        
-                        if(notSingle)
-                        {
-                            outData[j] = 0;
-                        }
-                        else
-                        {
-                            outData[j] = 1;
-                            ++countSingles;
-                        }
-                    }
-                }
-                else
-                {
-                    clumpBand->RasterIO(GF_Read, 0, i-1, width, 1, inData[0], width, 1, GDT_UInt32, 0, 0);
-                    clumpBand->RasterIO(GF_Read, 0, i, width, 1, inData[1], width, 1, GDT_UInt32, 0, 0);
-                    clumpBand->RasterIO(GF_Read, 0, i+1, width, 1, inData[2], width, 1, GDT_UInt32, 0, 0);
-                    for(unsigned int j = 0; j < width; ++j)
-                    {
-                        notSingle = false;
-                        if((noDataValProvided & (inData[1][j] != noDataVal)) | !noDataValProvided)
-                        {
-                            if(j == 0)
-                            {
-                                //top
-                                if(inData[0][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //right
-                                else if((j < width-1) && (inData[1][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom
-                                else if(inData[2][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                            else if(j == (width-1))
-                            {
-                                //top
-                                if(inData[0][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //left
-                                else if((j > 0) && (inData[1][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom
-                                else if(inData[2][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                            else
-                            {
-                                //top
-                                if(inData[0][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //left
-                                else if((j > 0) && (inData[1][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //right
-                                else if((j < width-1) && (inData[1][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom
-                                else if(inData[2][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                        }
-                        else
-                        {
-                            notSingle = true;
-                        }
-                        
-                        if(notSingle)
-                        {
-                            outData[j] = 0;
-                        }
-                        else
-                        {
-                            outData[j] = 1;
-                            ++countSingles;
-                        }
-                    }
-                }
-                
-                tmpBand->RasterIO(GF_Write, 0, i, width, 1, outData, width, 1, GDT_UInt32, 0, 0);
-            }
-            pbar.finish();
-            
-            delete[] inData[0];
-            delete[] inData[1];
-            delete[] inData[2];
-            delete[] inData;
-            delete[] outData;
-        }
-        catch (rsgis::img::RSGISImageCalcException &e)
-        {
-            throw e;
-        }
         
-        return countSingles;
-    }
-    
-    bool RSGISEliminateSingleClassPixels::eliminateSinglePixelsConnect4(GDALDataset *inImageData, GDALDataset *tmpData, GDALDataset *outDataset, float noDataVal, bool noDataValProvided) 
-    {
-        bool hasChangeOccured = false;
-        try
-        {
-            unsigned int width = inImageData->GetRasterXSize();
-            unsigned int height = inImageData->GetRasterYSize();
-            
-            GDALRasterBand *clumpBand = inImageData->GetRasterBand(1);
-            GDALRasterBand *singlePxlBand = tmpData->GetRasterBand(1);
-            GDALRasterBand *outBand = outDataset->GetRasterBand(1);
-            
-            unsigned int **inData = new unsigned int*[3];
-            inData[0] = new unsigned int[width];
-            inData[1] = new unsigned int[width];
-            inData[2] = new unsigned int[width];
-            
-            unsigned int **singlePxl = new unsigned int*[3];
-            singlePxl[0] = new unsigned int[width];
-            singlePxl[1] = new unsigned int[width];
-            singlePxl[2] = new unsigned int[width];
-            
-            rsgis::datastruct::SortedGenericList<unsigned int> *sortedList = new rsgis::datastruct::SortedGenericList<unsigned int>();
-            
-            unsigned int *outData = new unsigned int[width];
-            
-            rsgis_tqdm pbar;
-            for(unsigned int i = 0; i < height; ++i)
-            {
-                pbar.progress(i, height);
-                if(i == 0)
-                {
-                    clumpBand->RasterIO(GF_Read, 0, i, width, 1, inData[1], width, 1, GDT_UInt32, 0, 0);
-                    clumpBand->RasterIO(GF_Read, 0, i+1, width, 1, inData[2], width, 1, GDT_UInt32, 0, 0);
-                    singlePxlBand->RasterIO(GF_Read, 0, i, width, 1, singlePxl[1], width, 1, GDT_UInt32, 0, 0);
-                    singlePxlBand->RasterIO(GF_Read, 0, i+1, width, 1, singlePxl[2], width, 1, GDT_UInt32, 0, 0);
-                    
-                    for(unsigned int j = 0; j < width; ++j)
-                    {
-                        if((noDataValProvided & (inData[1][j] != noDataVal)) | !noDataValProvided)
-                        {
-                            if(singlePxl[1][j] == 1)
-                            {
-                                if(j == 0)
-                                {
-                                    //right
-                                    if((j < width-1) && (singlePxl[1][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j+1]);
-                                    }
-                                    //bottom
-                                    if(singlePxl[2][j] == 0)
-                                    {
-                                        sortedList->add(&inData[2][j]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                                else if(j == (width-1))
-                                {
-                                    //left
-                                    if((j > 0) && (singlePxl[1][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j-1]);
-                                    }
-                                    //bottom
-                                    if(singlePxl[2][j] == 0)
-                                    {
-                                        sortedList->add(&inData[2][j]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                                else
-                                {
-                                    //left
-                                    if((j > 0) && (singlePxl[1][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j-1]);
-                                    }
-                                    //right
-                                    if((j < width-1) && (singlePxl[1][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j+1]);
-                                    }
-                                    //bottom
-                                    if(singlePxl[2][j] == 0)
-                                    {
-                                        sortedList->add(&inData[2][j]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                            }
-                            else
-                            {
-                                outData[j] = inData[1][j];
-                            }
-                        }
-                        else
-                        {
-                            outData[j] = inData[1][j];
-                        }
-                    }
-                    
-                }
-                else if(i == (height-1))
-                {
-                    clumpBand->RasterIO(GF_Read, 0, i-1, width, 1, inData[0], width, 1, GDT_UInt32, 0, 0);
-                    clumpBand->RasterIO(GF_Read, 0, i, width, 1, inData[1], width, 1, GDT_UInt32, 0, 0);
-                    singlePxlBand->RasterIO(GF_Read, 0, i-1, width, 1, singlePxl[0], width, 1, GDT_UInt32, 0, 0);
-                    singlePxlBand->RasterIO(GF_Read, 0, i, width, 1, singlePxl[1], width, 1, GDT_UInt32, 0, 0);
-                    
-                    for(unsigned int j = 0; j < width; ++j)
-                    {
-                        if((noDataValProvided & (inData[1][j] != noDataVal)) | !noDataValProvided)
-                        {
-                            if(singlePxl[1][j] == 1)
-                            {
-                                if(j == 0)
-                                {
-                                    //top
-                                    if(singlePxl[0][j] == 0)
-                                    {
-                                        sortedList->add(&inData[0][j]);
-                                    }
-                                    //right
-                                    if((j < width-1) && (singlePxl[1][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j+1]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                                else if(j == (width-1))
-                                {
-                                    //top
-                                    if(singlePxl[0][j] == 0)
-                                    {
-                                        sortedList->add(&inData[0][j]);
-                                    }
-                                    //left
-                                    if((j > 0) && (singlePxl[1][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j-1]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                                else
-                                {
-                                    //top
-                                    if(singlePxl[0][j] == 0)
-                                    {
-                                        sortedList->add(&inData[0][j]);
-                                    }
-                                    //left
-                                    if((j > 0) && (singlePxl[1][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j-1]);
-                                    }
-                                    //right
-                                    if((j < width-1) && (singlePxl[1][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j+1]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                            }
-                            else
-                            {
-                                outData[j] = inData[1][j];
-                            }
-                        }
-                        else
-                        {
-                            outData[j] = inData[1][j];
-                        }
-                    }
-                }
-                else
-                {
-                    clumpBand->RasterIO(GF_Read, 0, i-1, width, 1, inData[0], width, 1, GDT_UInt32, 0, 0);
-                    clumpBand->RasterIO(GF_Read, 0, i, width, 1, inData[1], width, 1, GDT_UInt32, 0, 0);
-                    clumpBand->RasterIO(GF_Read, 0, i+1, width, 1, inData[2], width, 1, GDT_UInt32, 0, 0);
-                    singlePxlBand->RasterIO(GF_Read, 0, i-1, width, 1, singlePxl[0], width, 1, GDT_UInt32, 0, 0);
-                    singlePxlBand->RasterIO(GF_Read, 0, i, width, 1, singlePxl[1], width, 1, GDT_UInt32, 0, 0);
-                    singlePxlBand->RasterIO(GF_Read, 0, i+1, width, 1, singlePxl[2], width, 1, GDT_UInt32, 0, 0);
-                    
-                    for(unsigned int j = 0; j < width; ++j)
-                    {
-                        if((noDataValProvided & (inData[1][j] != noDataVal)) | !noDataValProvided)
-                        {
-                            if(singlePxl[1][j] == 1)
-                            {
-                                if(j == 0)
-                                {
-                                    //top
-                                    if(singlePxl[0][j] == 0)
-                                    {
-                                        sortedList->add(&inData[0][j]);
-                                    }
-                                    //right
-                                    if((j < width-1) && (singlePxl[1][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j+1]);
-                                    }
-                                    //bottom
-                                    if(singlePxl[2][j] == 0)
-                                    {
-                                        sortedList->add(&inData[2][j]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                                else if(j == (width-1))
-                                {
-                                    //top
-                                    if(singlePxl[0][j] == 0)
-                                    {
-                                        sortedList->add(&inData[0][j]);
-                                    }
-                                    //left
-                                    if((j > 0) && (singlePxl[1][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j-1]);
-                                    }
-                                    //bottom
-                                    if(singlePxl[2][j] == 0)
-                                    {
-                                        sortedList->add(&inData[2][j]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                                else
-                                {
-                                    //top
-                                    if(singlePxl[0][j] == 0)
-                                    {
-                                        sortedList->add(&inData[0][j]);
-                                    }
-                                    //left
-                                    if((j > 0) && (singlePxl[1][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j-1]);
-                                    }
-                                    //right
-                                    if((j < width-1) && (singlePxl[1][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j+1]);
-                                    }
-                                    //bottom
-                                    if(singlePxl[2][j] == 0)
-                                    {
-                                        sortedList->add(&inData[2][j]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                            }
-                            else
-                            {
-                                outData[j] = inData[1][j];
-                            }
-                        }
-                        else
-                        {
-                            outData[j] = inData[1][j];
-                        }
-                    }
-                }
-                
-                outBand->RasterIO(GF_Write, 0, i, width, 1, outData, width, 1, GDT_UInt32, 0, 0);
-            }
-            pbar.finish();
-            
-            delete sortedList;
-            delete[] inData[0];
-            delete[] inData[1];
-            delete[] inData[2];
-            delete[] inData;
-            delete[] singlePxl[0];
-            delete[] singlePxl[1];
-            delete[] singlePxl[2];
-            delete[] singlePxl;
-            delete[] outData;
-        }
-        catch (rsgis::img::RSGISImageCalcException &e)
-        {
-            throw e;
-        }
-        return hasChangeOccured;
     }
     
-    unsigned long RSGISEliminateSingleClassPixels::findSinglePixelsConnect8(GDALDataset *inImageData, GDALDataset *tmpData, float noDataVal, bool noDataValProvided) 
+    bool RSGISMajoritySinglePxlReplacement::findReplacement(unsigned int xPxl, unsigned int yPxl, unsigned int numNeighbours, const unsigned int *xNeighbours, const unsigned int *yNeighbours, const unsigned int *neighbourVals, unsigned int *outVal)
     {
-        unsigned long countSingles = 0;
-        try
+        unsigned int maxCount = 0;
+        unsigned int count = 0;
+        for(unsigned int i = 0; i < numNeighbours; ++i)
         {
-            unsigned int width = inImageData->GetRasterXSize();
-            unsigned int height = inImageData->GetRasterYSize();
-            
-            GDALRasterBand *clumpBand = inImageData->GetRasterBand(1);
-            GDALRasterBand *tmpBand = tmpData->GetRasterBand(1);
-            
-            unsigned int **inData = new unsigned int*[3];
-            inData[0] = new unsigned int[width];
-            inData[1] = new unsigned int[width];
-            inData[2] = new unsigned int[width];
-            unsigned int *outData = new unsigned int[width];
-            bool notSingle = false;
-            
-            rsgis_tqdm pbar;
-            for(unsigned int i = 0; i < height; ++i)
+            count = 0;
+            for(unsigned int j = i; j < numNeighbours; ++j)
             {
-                pbar.progress(i, height);
-                if(i == 0)
-                {
-                    clumpBand->RasterIO(GF_Read, 0, i, width, 1, inData[1], width, 1, GDT_UInt32, 0, 0);
-                    clumpBand->RasterIO(GF_Read, 0, i+1, width, 1, inData[2], width, 1, GDT_UInt32, 0, 0);
-                    for(unsigned int j = 0; j < width; ++j)
-                    {
-                        notSingle = false;
-                        if((noDataValProvided & (inData[1][j] != noDataVal)) | !noDataValProvided)
-                        {
-                            if(j == 0)
-                            {
-                                //right
-                                if((j < width-1) && (inData[1][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom
-                                else if(inData[2][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom right
-                                else if((j < width-1) && (inData[2][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                            else if(j == (width-1))
-                            {
-                                //left
-                                if((j > 0) && (inData[1][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom
-                                else if(inData[2][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom left
-                                else if((j > 0) && (inData[2][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                            else
-                            {
-                                //left
-                                if((j > 0) && (inData[1][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //right
-                                else if((j < width-1) && (inData[1][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom left
-                                else if((j > 0) && (inData[2][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom
-                                else if(inData[2][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom right
-                                else if((j < width-1) && (inData[2][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                        }
-                        else
-                        {
-                            notSingle = true;
-                        }
-                        
-                        if(notSingle)
-                        {
-                            outData[j] = 0;
-                        }
-                        else
-                        {
-                            outData[j] = 1;
-                            ++countSingles;
-                        }
-                    }
-                }
-                else if(i == (height-1))
+                if(neighbourVals[j] == neighbourVals[i])
                 {
-                    clumpBand->RasterIO(GF_Read, 0, i-1, width, 1, inData[0], width, 1, GDT_UInt32, 0, 0);
-                    clumpBand->RasterIO(GF_Read, 0, i, width, 1, inData[1], width, 1, GDT_UInt32, 0, 0);
-                    for(unsigned int j = 0; j < width; ++j)
-                    {
-                        notSingle = false;
-                        if((noDataValProvided & (inData[1][j] != noDataVal)) | !noDataValProvided)
-                        {
-                            if(j == 0)
-                            {
-                                //top
-                                if(inData[0][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //top right
-                                else if((j < width-1) && (inData[0][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //right
-                                else if((j < width-1) && (inData[1][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                            else if(j == (width-1))
-                            {
-                                //top
-                                if(inData[0][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //top left
-                                else if((j > 0) && (inData[0][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //left
-                                else if((j > 0) && (inData[1][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                            else
-                            {
-                                //top left
-                                if((j > 0) && (inData[0][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //top
-                                else if(inData[0][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //top right
-                                else if((j < width-1) && (inData[0][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //left
-                                else if((j > 0) && (inData[1][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //right
-                                else if((j < width-1) && (inData[1][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                        }
-                        else
-                        {
-                            notSingle = true;
-                        }
-                        
-                        if(notSingle)
-                        {
-                            outData[j] = 0;
-                        }
-                        else
-                        {
-                            outData[j] = 1;
-                            ++countSingles;
-                        }
-                    }
+                    ++count;
                 }
-                else
-                {
-                    clumpBand->RasterIO(GF_Read, 0, i-1, width, 1, inData[0], width, 1, GDT_UInt32, 0, 0);
-                    clumpBand->RasterIO(GF_Read, 0, i, width, 1, inData[1], width, 1, GDT_UInt32, 0, 0);
-                    clumpBand->RasterIO(GF_Read, 0, i+1, width, 1, inData[2], width, 1, GDT_UInt32, 0, 0);
-                    for(unsigned int j = 0; j < width; ++j)
-                    {
-                        notSingle = false;
-                        if((noDataValProvided & (inData[1][j] != noDataVal)) | !noDataValProvided)
-                        {
-                            if(j == 0)
-                            {
-                                //top
-                                if(inData[0][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //top right
-                                else if((j < width-1) && (inData[0][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //right
-                                else if((j < width-1) && (inData[1][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom
-                                else if(inData[2][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom right
-                                else if((j < width-1) && (inData[2][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                            else if(j == (width-1))
-                            {
-                                //top
-                                if(inData[0][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //top left
-                                else if((j > 0) && (inData[0][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //left
-                                else if((j > 0) && (inData[1][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom
-                                else if(inData[2][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom left
-                                else if((j > 0) && (inData[2][j] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                            else
-                            {
-                                //top left
-                                if((j > 0) && (inData[0][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //top
-                                else if(inData[0][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //top right
-                                else if((j < width-1) && (inData[0][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //left
-                                else if((j > 0) && (inData[1][j-1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //right
-                                else if((j < width-1) && (inData[1][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom left
-                                else if((j > 0) && (inData[2][j] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom
-                                else if(inData[2][j] == inData[1][j])
-                                {
-                                    notSingle = true;
-                                }
-                                //bottom right
-                                else if((j < width-1) && (inData[2][j+1] == inData[1][j]))
-                                {
-                                    notSingle = true;
-                                }
-                            }
-                        }
-                        else
-                        {
-                            notSingle = true;
-                        }
-                        
-                        if(notSingle)
-                        {
-                            outData[j] = 0;
-                        }
-                        else
-                        {
-                            outData[j] = 1;
-                            ++countSingles;
-                        }
-                    }
-                }
-                
-                tmpBand->RasterIO(GF_Write, 0, i, width, 1, outData, width, 1, GDT_UInt32, 0, 0);
             }
-            pbar.finish();
-            
-            delete[] inData[0];
-            delete[] inData[1];
-            delete[] inData[2];
-            delete[] inData;
-            delete[] outData;
-        }
-        catch (rsgis::img::RSGISImageCalcException &e)
-        {
-            throw e;
-        }
-        
-        return countSingles;
-    }
-    
-    bool RSGISEliminateSingleClassPixels::eliminateSinglePixelsConnect8(GDALDataset *inImageData, GDALDataset *tmpData, GDALDataset *outDataset, float noDataVal, bool noDataValProvided) 
-    {
-        bool hasChangeOccured = false;
-        try
-        {
-            unsigned int width = inImageData->GetRasterXSize();
-            unsigned int height = inImageData->GetRasterYSize();
-            
-            GDALRasterBand *clumpBand = inImageData->GetRasterBand(1);
-            GDALRasterBand *singlePxlBand = tmpData->GetRasterBand(1);
-            GDALRasterBand *outBand = outDataset->GetRasterBand(1);
-            
-            unsigned int **inData = new unsigned int*[3];
-            inData[0] = new unsigned int[width];
-            inData[1] = new unsigned int[width];
-            inData[2] = new unsigned int[width];
-            
-            unsigned int **singlePxl = new unsigned int*[3];
-            singlePxl[0] = new unsigned int[width];
-            singlePxl[1] = new unsigned int[width];
-            singlePxl[2] = new unsigned int[width];
-            
-            rsgis::datastruct::SortedGenericList<unsigned int> *sortedList = new rsgis::datastruct::SortedGenericList<unsigned int>();
-            
-            unsigned int *outData = new unsigned int[width];
-            
-            rsgis_tqdm pbar;
-            for(unsigned int i = 0; i < height; ++i)
+            if(count > maxCount)
             {
-                pbar.progress(i, height);
-                if(i == 0)
-                {
-                    clumpBand->RasterIO(GF_Read, 0, i, width, 1, inData[1], width, 1, GDT_UInt32, 0, 0);
-                    clumpBand->RasterIO(GF_Read, 0, i+1, width, 1, inData[2], width, 1, GDT_UInt32, 0, 0);
-                    singlePxlBand->RasterIO(GF_Read, 0, i, width, 1, singlePxl[1], width, 1, GDT_UInt32, 0, 0);
-                    singlePxlBand->RasterIO(GF_Read, 0, i+1, width, 1, singlePxl[2], width, 1, GDT_UInt32, 0, 0);
-                    
-                    for(unsigned int j = 0; j < width; ++j)
-                    {
-                        if((noDataValProvided & (inData[1][j] != noDataVal)) | !noDataValProvided)
-                        {
-                            if(singlePxl[1][j] == 1)
-                            {
-                                if(j == 0)
-                                {
-                                    //right
-                                    if((j < width-1) && (singlePxl[1][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j+1]);
-                                    }
-                                    //bottom
-                                    else if(singlePxl[2][j] == 0)
-                                    {
-                                        sortedList->add(&inData[2][j]);
-                                    }
-                                    //bottom right
-                                    else if((j < width-1) && (singlePxl[2][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[2][j+1]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                                else if(j == (width-1))
-                                {
-                                    //left
-                                    if((j > 0) && (singlePxl[1][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j-1]);
-                                    }
-                                    //bottom left 
-                                    else if((j > 0) && (singlePxl[2][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[2][j-1]);
-                                    }
-                                    //bottom
-                                    else if(singlePxl[2][j] == 0)
-                                    {
-                                        sortedList->add(&inData[2][j]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                                else
-                                {
-                                    //left
-                                    if((j > 0) && (singlePxl[1][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j-1]);
-                                    }
-                                    //right
-                                    else if((j < width-1) && (singlePxl[1][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j+1]);
-                                    }
-                                    //bottom left
-                                    else if((j > 0) && (singlePxl[2][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[2][j-1]);
-                                    }
-                                    //bottom
-                                    else if(singlePxl[2][j] == 0)
-                                    {
-                                        sortedList->add(&inData[2][j]);
-                                    }
-                                    //bottom right
-                                    else if((j < width-1) && (singlePxl[2][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[2][j+1]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                            }
-                            else
-                            {
-                                outData[j] = inData[1][j];
-                            }
-                        }
-                        else
-                        {
-                            outData[j] = inData[1][j];
-                        }
-                    }
-                    
-                }
-                else if(i == (height-1))
-                {
-                    clumpBand->RasterIO(GF_Read, 0, i-1, width, 1, inData[0], width, 1, GDT_UInt32, 0, 0);
-                    clumpBand->RasterIO(GF_Read, 0, i, width, 1, inData[1], width, 1, GDT_UInt32, 0, 0);
-                    singlePxlBand->RasterIO(GF_Read, 0, i-1, width, 1, singlePxl[0], width, 1, GDT_UInt32, 0, 0);
-                    singlePxlBand->RasterIO(GF_Read, 0, i, width, 1, singlePxl[1], width, 1, GDT_UInt32, 0, 0);
-                    
-                    for(unsigned int j = 0; j < width; ++j)
-                    {
-                        if((noDataValProvided & (inData[1][j] != noDataVal)) | !noDataValProvided)
-                        {
-                            if(singlePxl[1][j] == 1)
-                            {
-                                if(j == 0)
-                                {
-                                    //top
-                                    if(singlePxl[0][j] == 0)
-                                    {
-                                        sortedList->add(&inData[0][j]);
-                                    }
-                                    //top right
-                                    if((j < width-1) && (singlePxl[0][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[0][j+1]);
-                                    }
-                                    //right
-                                    else if((j < width-1) && (singlePxl[1][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j+1]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                                else if(j == (width-1))
-                                {
-                                    //top left
-                                    if((j > 0) && (singlePxl[0][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[0][j-1]);
-                                    }
-                                    //top
-                                    else if(singlePxl[0][j] == 0)
-                                    {
-                                        sortedList->add(&inData[0][j]);
-                                    }
-                                    //left
-                                    else if((j > 0) && (singlePxl[1][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j-1]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                                else
-                                {
-                                    //top left
-                                    if((j > 0) && (singlePxl[0][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[0][j-1]);
-                                    }
-                                    //top
-                                    else if(singlePxl[0][j] == 0)
-                                    {
-                                        sortedList->add(&inData[0][j]);
-                                    }
-                                    //top right
-                                    if((j < width-1) && (singlePxl[0][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[0][j+1]);
-                                    }
-                                    //left
-                                    else if((j > 0) && (singlePxl[1][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j-1]);
-                                    }
-                                    //right
-                                    else if((j < width-1) && (singlePxl[1][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j+1]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                            }
-                            else
-                            {
-                                outData[j] = inData[1][j];
-                            }
-                        }
-                        else
-                        {
-                            outData[j] = inData[1][j];
-                        }
-                    }
-                }
-                else
-                {
-                    clumpBand->RasterIO(GF_Read, 0, i-1, width, 1, inData[0], width, 1, GDT_UInt32, 0, 0);
-                    clumpBand->RasterIO(GF_Read, 0, i, width, 1, inData[1], width, 1, GDT_UInt32, 0, 0);
-                    clumpBand->RasterIO(GF_Read, 0, i+1, width, 1, inData[2], width, 1, GDT_UInt32, 0, 0);
-                    singlePxlBand->RasterIO(GF_Read, 0, i-1, width, 1, singlePxl[0], width, 1, GDT_UInt32, 0, 0);
-                    singlePxlBand->RasterIO(GF_Read, 0, i, width, 1, singlePxl[1], width, 1, GDT_UInt32, 0, 0);
-                    singlePxlBand->RasterIO(GF_Read, 0, i+1, width, 1, singlePxl[2], width, 1, GDT_UInt32, 0, 0);
-                    
-                    for(unsigned int j = 0; j < width; ++j)
-                    {
-                        if((noDataValProvided & (inData[1][j] != noDataVal)) | !noDataValProvided)
-                        {
-                            if(singlePxl[1][j] == 1)
-                            {
-                                if(j == 0)
-                                {
-                                    //top
-                                    if(singlePxl[0][j] == 0)
-                                    {
-                                        sortedList->add(&inData[0][j]);
-                                    }
-                                    //top right
-                                    else if((j < width-1) && (singlePxl[0][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[0][j+1]);
-                                    }
-                                    //right
-                                    else if((j < width-1) && (singlePxl[1][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j+1]);
-                                    }
-                                    //bottom
-                                    else if(singlePxl[2][j] == 0)
-                                    {
-                                        sortedList->add(&inData[2][j]);
-                                    }
-                                    //bottom right
-                                    else if(singlePxl[2][j+1] == 0)
-                                    {
-                                        sortedList->add(&inData[2][j+1]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                                else if(j == (width-1))
-                                {
-                                    //top left
-                                    if((j > 0) && (singlePxl[0][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[0][j-1]);
-                                    }
-                                    //top
-                                    else if(singlePxl[0][j] == 0)
-                                    {
-                                        sortedList->add(&inData[0][j]);
-                                    }
-                                    //left
-                                    else if((j > 0) && (singlePxl[1][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j-1]);
-                                    }
-                                    //bottom left
-                                    else if((j > 0) && (singlePxl[2][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[2][j-1]);
-                                    }
-                                    //bottom
-                                    else if(singlePxl[2][j] == 0)
-                                    {
-                                        sortedList->add(&inData[2][j]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                                else
-                                {
-                                    //top left
-                                    if((j > 0) && (singlePxl[0][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[0][j-1]);
-                                    }
-                                    //top
-                                    else if(singlePxl[0][j] == 0)
-                                    {
-                                        sortedList->add(&inData[0][j]);
-                                    }
-                                    //top right
-                                    else if((j < width-1) && (singlePxl[0][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[0][j+1]);
-                                    }
-                                    //left
-                                    else if((j > 0) && (singlePxl[1][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j-1]);
-                                    }
-                                    //right
-                                    else if((j < width-1) && (singlePxl[1][j+1] == 0))
-                                    {
-                                        sortedList->add(&inData[1][j+1]);
-                                    }
-                                    //bottom left
-                                    else if((j > 0) && (singlePxl[2][j-1] == 0))
-                                    {
-                                        sortedList->add(&inData[2][j-1]);
-                                    }
-                                    //bottom
-                                    else if(singlePxl[2][j] == 0)
-                                    {
-                                        sortedList->add(&inData[2][j]);
-                                    }
-                                    //bottom right
-                                    else if(singlePxl[2][j+1] == 0)
-                                    {
-                                        sortedList->add(&inData[2][j+1]);
-                                    }
-                                    
-                                    if(sortedList->getSize() <= 1)
-                                    {
-                                        outData[j] = inData[1][j];
-                                    }
-                                    else
-                                    {
-                                        outData[j] = *sortedList->getMostCommonValue();
-                                        hasChangeOccured = true;
-                                    }
-                                    sortedList->clearList();
-                                }
-                            }
-                            else
-                            {
-                                outData[j] = inData[1][j];
-                            }
-                        }
-                        else
-                        {
-                            outData[j] = inData[1][j];
-                        }
-                    }
-                }
-                
-                outBand->RasterIO(GF_Write, 0, i, width, 1, outData, width, 1, GDT_UInt32, 0, 0);
+                maxCount = count;
+                *outVal = neighbourVals[i];
             }
-            pbar.finish();
-            
-            delete sortedList;
-            delete[] inData[0];
-            delete[] inData[1];
-            delete[] inData[2];
-            delete[] inData;
-            delete[] singlePxl[0];
-            delete[] singlePxl[1];
-            delete[] singlePxl[2];
-            delete[] singlePxl;
-            delete[] outData;
-        }
-        catch (rsgis::img::RSGISImageCalcException &e)
-        {
-            throw e;
         }
-        return hasChangeOccured;
-    }
-    
-    unsigned int RSGISEliminateSingleClassPixels::findMostCommonVal(std::vector<unsigned int> values)
-    {
-        return 0;
-    }
-    
-    RSGISEliminateSingleClassPixels::~RSGISEliminateSingleClassPixels()
-    {
-        
+        return (maxCount > 0);
     }
 
 }}
@@ -43,6 +43,7 @@
 
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISImageCalcException.h"
+#include "img/RSGISSinglePxlElimination.h"
 
 #include "datastruct/SortedGenericList.cpp"
 
@@ -87,12 +88,18 @@ namespace rsgis{ namespace classifier{
         RSGISEliminateSingleClassPixels();
         void eliminate(GDALDataset *inImageData, GDALDataset *tmpData, std::string outputImage, float noDataVal, bool noDataValProvided, std::string format, rsgis::img::RSGISRasterConnectivity filterConnectivity);
         ~RSGISEliminateSingleClassPixels();
-    private:
-        unsigned long findSinglePixelsConnect4(GDALDataset *inImageData, GDALDataset *tmpData, float noDataVal, bool noDataValProvided);
-        bool eliminateSinglePixelsConnect4(GDALDataset *inImageData, GDALDataset *tmpData, GDALDataset *outDataset, float noDataVal, bool noDataValProvided);
-        unsigned long findSinglePixelsConnect8(GDALDataset *inImageData, GDALDataset *tmpData, float noDataVal, bool noDataValProvided);
-        bool eliminateSinglePixelsConnect8(GDALDataset *inImageData, GDALDataset *tmpData, GDALDataset *outDataset, float noDataVal, bool noDataValProvided);
-        unsigned int findMostCommonVal(std::vector<unsigned int> values);
+    };
+    
+    /**
+     * Replaces a single pixel with the most common class of its neighbours,
+     * taking the first in the neighbour order if there is a tie.
+     */
+    class DllExport RSGISMajoritySinglePxlReplacement : public rsgis::img::RSGISSinglePxlReplacement
+    {
+    public:
+        RSGISMajoritySinglePxlReplacement(){};
+        bool findReplacement(unsigned int xPxl, unsigned int yPxl, unsigned int numNeighbours, const unsigned int *xNeighbours, const unsigned int *yNeighbours, const unsigned int *neighbourVals, unsigned int *outVal);
+        ~RSGISMajoritySinglePxlReplacement(){};
     };
 	
 }}
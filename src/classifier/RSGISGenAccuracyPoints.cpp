@@ -331,87 +331,69 @@ namespace rsgis{namespace classifier{
             }
             
             
-            srand(seed);
-            
-            unsigned int xPxl = 0;
-            unsigned int yPxl = 0;
-            double eastings = 0;
-            double northings = 0;
-            float demVal = 0;
-            std::string classVal = "";
-            std::map<std::string, size_t>::iterator iterMap;
+            rsgis::rastergis::RSGISRasterAttUtils ratUtils;
+            std::vector<std::string> *rowClassNames = ratUtils.readStrColumnAsVec(attTable, classColName);
+            std::vector<long> classIdxLUT = this->createClassIdxLUT(rowClassNames, &classesLookUp);
+            delete rowClassNames;
             
-            RSGISAccPoint *tmpAccPt = NULL;
+            // Sample the pixels of each class in a single pass through the image.
+            rsgis::img::RSGISStratifiedPxlSampler sampler = rsgis::img::RSGISStratifiedPxlSampler(seed);
+            std::vector<std::vector<std::pair<unsigned int, unsigned int> > > classPxls;
+            std::vector<unsigned long> classPxlCounts;
+            std::cout << "Number of points to be generated: " << classes->size() * numPts << std::endl;
+            sampler.samplePxls(inputImage, 1, classIdxLUT, numPts, &classPxls, &classPxlCounts);
             
-            unsigned long totalNumPtsRequired = classes->size() * numPts;
             unsigned long ptsCount = 0;
-            
-            
-            std::cout << "Number of points to be generated: " << totalNumPtsRequired << std::endl;
-            
-            while(ptsCount < totalNumPtsRequired)
+            RSGISAccPoint *tmpAccPt = NULL;
+            std::vector<RSGISAccPoint*> demPts;
+            std::vector<std::pair<unsigned int, unsigned int> > demPxls;
+            idx = 0;
+            for(std::list<std::string>::iterator iterClasses = classes->begin(); iterClasses != classes->end(); ++iterClasses)
             {
-                std::cout << "Completed " << floor((((double)ptsCount)/((double)totalNumPtsRequired))*100) << " %\r" << std::flush;
+                if(classPxlCounts.at(idx) < numPts)
+                {
+                    std::cout << "Class \'" << *iterClasses << "\' only has " << classPxlCounts.at(idx) << " pixels.\n";
+                }
                 
-                xPxl = rand() % imgSizeX;
-                yPxl = rand() % imgSizeY;
-                                
-                eastings = tlX + (((double)xPxl)*xRes);
-                northings = tlY - (((double)yPxl)*yRes);
-                                
-                try
+                for(std::vector<std::pair<unsigned int, unsigned int> >::iterator iterPxls = classPxls.at(idx).begin(); iterPxls != classPxls.at(idx).end(); ++iterPxls)
                 {
-                    classVal = findClassVal(inputImage, 1, attTable, inClassColIdx, xPxl, yPxl);
-                                       
-                    iterMap = classesLookUp.find(classVal);
-                    
-                    if(iterMap == classesLookUp.end())
-                    {
-                        rsgis::RSGISImageException("Class name was not found!");
-                    }
-                    
-                    idx = iterMap->second;
+                    tmpAccPt = new RSGISAccPoint();
+                    tmpAccPt->ptID = ++ptsCount;
+                    tmpAccPt->eastings = tlX + (((double)(*iterPxls).first)*xRes);
+                    tmpAccPt->northings = tlY - (((double)(*iterPxls).second)*yRes);
+                    tmpAccPt->elevation = 0.0;
+                    tmpAccPt->mapClassName = *iterClasses;
+                    tmpAccPt->trueClassName = *iterClasses;
+                    tmpAccPt->status = -1;
+                    tmpAccPt->comment = "";
                     
-                    if(accClassPts->at(idx).size() < numPts)
+                    if(demProvided)
                     {
-                        if(demProvided)
+                        double diffX = tmpAccPt->eastings - demTlX;
+                        double diffY = demTlY - tmpAccPt->northings;
+                        if((diffX >= 0) && (diffY >= 0) && ((diffX/demXRes) < demSizeX) && ((diffY/demYRes) < demSizeY))
                         {
-                            try
-                            {
-                                demVal = findPixelVal(inputDEM, 1, eastings, northings, demTlX, demTlY, demXRes, demYRes, demSizeX, demSizeY);
-                            }
-                            catch (rsgis::RSGISImageException &e)
-                            {
-                                demVal = -99999;
-                            }
+                            demPts.push_back(tmpAccPt);
+                            demPxls.push_back(std::pair<unsigned int, unsigned int>(diffX/demXRes, diffY/demYRes));
                         }
                         else
                         {
-                            demVal = 0;
+                            tmpAccPt->elevation = -99999;
                         }
-                        
-                        tmpAccPt = new RSGISAccPoint();
-                        tmpAccPt->ptID = ptsCount+1;
-                        tmpAccPt->eastings = eastings;
-                        tmpAccPt->northings = northings;
-                        tmpAccPt->elevation = demVal;
-                        tmpAccPt->mapClassName = classVal;
-                        tmpAccPt->trueClassName = classVal;
-                        tmpAccPt->status = -1;
-                        tmpAccPt->comment = "";
-                        
-                        accClassPts->at(idx).push_back(tmpAccPt);
-                        
-                        ++ptsCount;
-                    }                    
-                }
-                catch (rsgis::RSGISImageException &e)
-                {
-                    // Ignore as class not found...
+                    }
+                    
+                    accClassPts->at(idx).push_back(tmpAccPt);
                 }
-                catch (std::exception &e)
+                ++idx;
+            }
+            
+            if(demProvided)
+            {
+                std::vector<double> demVals;
+                sampler.readPxlValues(inputDEM, 1, demPxls, &demVals);
+                for(size_t i = 0; i < demPts.size(); ++i)
                 {
-                    throw rsgis::RSGISImageException(e.what());
+                    demPts.at(i)->elevation = demVals.at(i);
                 }
             }
             
@@ -697,76 +679,40 @@ namespace rsgis{namespace classifier{
             
             delete[] trans;
             
-            srand(seed);
+            std::vector<long> classIdxLUT = this->createClassIdxLUT(imgClassColVals, &classesLookUp);
             
-            unsigned int xPxl = 0;
-            unsigned int yPxl = 0;
-            double eastings = 0;
-            double northings = 0;
-            std::string classVal = "";
-            long pxlVal = 0.0;
+            // Sample the pixels of each class in a single pass through the image.
+            rsgis::img::RSGISStratifiedPxlSampler sampler = rsgis::img::RSGISStratifiedPxlSampler(seed);
+            std::vector<std::vector<std::pair<unsigned int, unsigned int> > > classPxls;
+            std::vector<unsigned long> classPxlCounts;
+            std::cout << "Number of points to be generated: " << classNames->size() * numPts << std::endl;
+            sampler.samplePxls(inputImage, 1, classIdxLUT, numPts, &classPxls, &classPxlCounts);
             
-            RSGISAccPoint *tmpAccPt = NULL;
-            std::map<std::string, size_t>::iterator iterMap;
-            
-            unsigned long totalNumPtsRequired = classNames->size() * numPts;
             unsigned long ptsCount = 0;
-            
-            std::cout << "Number of points to be generated: " << totalNumPtsRequired << std::endl;
-            
-            while(ptsCount < totalNumPtsRequired)
+            RSGISAccPoint *tmpAccPt = NULL;
+            idx = 0;
+            for(std::list<std::string>::iterator iterClasses = classNames->begin(); iterClasses != classNames->end(); ++iterClasses)
             {
-                std::cout << "Completed " << floor((((double)ptsCount)/((double)totalNumPtsRequired))*100) << " %\r" << std::flush;
-                
-                xPxl = rand() % imgSizeX;
-                yPxl = rand() % imgSizeY;
-                
-                eastings = tlX + (((double)xPxl)*xRes);
-                northings = tlY - (((double)yPxl)*yRes);
-                
-                try
+                if(classPxlCounts.at(idx) < numPts)
                 {
-                    pxlVal = long(this->findPixelVal(inputImage, 1, eastings, northings, tlX, tlY, xRes, yRes, imgSizeX, imgSizeY));
-                    
-                    if((pxlVal > 0) & (pxlVal < imgClassColVals->size()))
-                    {
-                        classVal = imgClassColVals->at(pxlVal);
-                        
-                        iterMap = classesLookUp.find(classVal);
-                        
-                        if(iterMap == classesLookUp.end())
-                        {
-                            rsgis::RSGISImageException("Class name was not found!");
-                        }
-                        
-                        idx = iterMap->second;
-                        
-                        if(accClassPts->at(idx).size() < numPts)
-                        {
-                            tmpAccPt = new RSGISAccPoint();
-                            tmpAccPt->ptID = ptsCount+1;
-                            tmpAccPt->eastings = eastings;
-                            tmpAccPt->northings = northings;
-                            tmpAccPt->elevation = 0.0;
-                            tmpAccPt->mapClassName = classVal;
-                            tmpAccPt->trueClassName = "";
-                            tmpAccPt->status = -1;
-                            tmpAccPt->comment = "";
-                        
-                            accClassPts->at(idx).push_back(tmpAccPt);
-                            
-                            ++ptsCount;
-                        }
-                    }
-                }
-                catch (rsgis::RSGISImageException &e)
-                {
-                    // Ignore as class not found...
+                    std::cout << "Class \'" << *iterClasses << "\' only has " << classPxlCounts.at(idx) << " pixels.\n";
                 }
-                catch (std::exception &e)
+                
+                for(std::vector<std::pair<unsigned int, unsigned int> >::iterator iterPxls = classPxls.at(idx).begin(); iterPxls != classPxls.at(idx).end(); ++iterPxls)
                 {
-                    throw rsgis::RSGISImageException(e.what());
+                    tmpAccPt = new RSGISAccPoint();
+                    tmpAccPt->ptID = ++ptsCount;
+                    tmpAccPt->eastings = tlX + (((double)(*iterPxls).first)*xRes);
+                    tmpAccPt->northings = tlY - (((double)(*iterPxls).second)*yRes);
+                    tmpAccPt->elevation = 0.0;
+                    tmpAccPt->mapClassName = *iterClasses;
+                    tmpAccPt->trueClassName = "";
+                    tmpAccPt->status = -1;
+                    tmpAccPt->comment = "";
+                    
+                    accClassPts->at(idx).push_back(tmpAccPt);
                 }
+                ++idx;
             }
             
             OGRFieldDefn imgClassField(vecClassImgCol.c_str(), OFTString);
@@ -810,11 +756,15 @@ namespace rsgis{namespace classifier{
                     poFeature->SetField(processedColIdx, 0);
                     
                     outputSHPLayer->CreateFeature(poFeature);
+                    OGRFeature::DestroyFeature(poFeature);
+                    delete *iterPts;
                 }
             }
             
             delete classNames;
             delete accClassPts;
+            delete imgClassColVals;
+            delete histogram;
             
         }
         catch(rsgis::RSGISImageException &e)
@@ -876,30 +826,41 @@ namespace rsgis{namespace classifier{
             }
             
             unsigned long numClasses = classNames->size();
-            std::vector<std::pair<double, double> > **classPxlLst = new std::vector<std::pair<double, double> >*[numClasses];
-            unsigned int idx = 0;
-            for(std::vector<std::string>::iterator iterClasses = classNames->begin(); iterClasses != classNames->end(); ++iterClasses)
+            std::map<std::string, size_t> classesLookUp;
+            for(unsigned long i = 0; i < numClasses; ++i)
             {
-                std::cout << "Class: \'" <<  *iterClasses << "\'" << std::endl;
-                classPxlLst[idx] = new std::vector<std::pair<double, double> >();
-                ++idx;
+                std::cout << "Class: \'" <<  classNames->at(i) << "\'" << std::endl;
+                classesLookUp.insert(std::pair<std::string, size_t>(classNames->at(i), i));
             }
+            std::vector<long> classIdxLUT = this->createClassIdxLUT(imgClassColVals, &classesLookUp);
             
-            rsgis::img::RSGISCalcImageValue *exClassPxlLocs = new RSGISExtractClassPxllocs(classPxlLst, numClasses);
-            rsgis::img::RSGISCalcImage calcImg = rsgis::img::RSGISCalcImage(exClassPxlLocs);
-            calcImg.calcImageExtent(&inputImage, 1, 0);
-            delete exClassPxlLocs;
+            // Sample the pixels of each class in a single pass through the image.
+            rsgis::img::RSGISStratifiedPxlSampler sampler = rsgis::img::RSGISStratifiedPxlSampler(seed);
+            std::vector<std::vector<std::pair<unsigned int, unsigned int> > > classPxls;
+            std::vector<unsigned long> classPxlCounts;
+            sampler.samplePxls(inputImage, 1, classIdxLUT, numPts, &classPxls, &classPxlCounts);
             
-            bool **usedPxl = new bool*[numClasses];
             for(unsigned long i = 0; i < numClasses; ++i)
             {
-                usedPxl[i] = new bool[classPxlLst[i]->size()];
-                for(unsigned long j = 0; j < classPxlLst[i]->size(); ++j)
+                if(classPxlCounts.at(i) < numPts)
                 {
-                    usedPxl[i][j] = false;
+                    rsgis::utils::RSGISTextUtils txtUtils;
+                    throw rsgis::RSGISImageException("All pixels (n="+txtUtils.sizettostring(classPxlCounts.at(i))+") for class \""+classNames->at(i)+"\" have been sampled within the image");
                 }
             }
             
+            double *trans = new double[6];
+            inputImage->GetGeoTransform(trans);
+            double tlX = trans[0];
+            double tlY = trans[3];
+            double xRes = trans[1];
+            double yRes = trans[5];
+            if(yRes < 0)
+            {
+                yRes = yRes * (-1);
+            }
+            delete[] trans;
+            
             OGRFieldDefn imgClassField(vecClassImgCol.c_str(), OFTString);
             imgClassField.SetWidth(254);
             if( outputSHPLayer->CreateField( &imgClassField ) != OGRERR_NONE )
@@ -927,52 +888,17 @@ namespace rsgis{namespace classifier{
             int imgClassColIdx = featDefn->GetFieldIndex(vecClassImgCol.c_str());
             int refClassColIdx = featDefn->GetFieldIndex(vecClassRefCol.c_str());
             int processedColIdx = featDefn->GetFieldIndex("Processed");
-            unsigned long pxlIdx = 0;
-            bool foundPxl = false;
-            unsigned long findPxlIterCount = 0;
-            unsigned long checkPt = 0;
-            bool usedAllPxls = false;
             for(unsigned long i = 0; i < numClasses; ++i)
             {
                 std::cout << "Processing Class \"" << classNames->at(i) << "\"\n";
-                srand(seed);
-                checkPt = classPxlLst[i]->size();
-                for(unsigned long j = 0; j < numPts; ++j)
+                for(std::vector<std::pair<unsigned int, unsigned int> >::iterator iterPxls = classPxls.at(i).begin(); iterPxls != classPxls.at(i).end(); ++iterPxls)
                 {
-                    foundPxl = false;
-                    while(!foundPxl)
-                    {
-                        pxlIdx = rand() % classPxlLst[i]->size();
-                        if(!usedPxl[i][pxlIdx])
-                        {
-                            foundPxl = true;
-                            usedPxl[i][pxlIdx] = true;
-                        }
-                        else if(findPxlIterCount > checkPt)
-                        {
-                            usedAllPxls = true;
-                            for(unsigned long n = 0; n < classPxlLst[i]->size(); ++n)
-                            {
-                                if(!usedPxl[i][n])
-                                {
-                                    usedAllPxls = false;
-                                    break;
-                                }
-                            }
-                            
-                            if(usedAllPxls)
-                            {
-                                rsgis::utils::RSGISTextUtils txtUtils;
-                                throw rsgis::RSGISImageException("All pixels (n="+txtUtils.sizettostring(classPxlLst[i]->size())+") for class \""+classNames->at(i)+"\" have been sampled within the image");
-                            }
-                            checkPt = checkPt + classPxlLst[i]->size();
-                        }
-                        
-                        ++findPxlIterCount;
-                    }
+                    // Use the centre of the pixel.
+                    double eastings = tlX + ((((double)(*iterPxls).first) + 0.5) * xRes);
+                    double northings = tlY - ((((double)(*iterPxls).second) + 0.5) * yRes);
                     
                     OGRFeature *poFeature = new OGRFeature(featDefn);
-                    OGRPoint *pt = new OGRPoint(classPxlLst[i]->at(pxlIdx).first, classPxlLst[i]->at(pxlIdx).second, 0.0);
+                    OGRPoint *pt = new OGRPoint(eastings, northings, 0.0);
                     poFeature->SetGeometryDirectly(pt);
                     
                     poFeature->SetField(imgClassColIdx, classNames->at(i).c_str());
@@ -980,15 +906,13 @@ namespace rsgis{namespace classifier{
                     poFeature->SetField(processedColIdx, 0);
                     
                     outputSHPLayer->CreateFeature(poFeature);
+                    OGRFeature::DestroyFeature(poFeature);
                 }
             }
             
             delete classNames;
-            for(idx = 0; idx < numClasses; ++idx)
-            {
-                delete classPxlLst[idx];
-            }
-            delete[] classPxlLst;
+            delete imgClassColVals;
+            delete histogram;
         }
         catch(rsgis::RSGISImageException &e)
         {
@@ -1082,7 +1006,6 @@ namespace rsgis{namespace classifier{
             
             int numFeatures = inputVecLayer->GetFeatureCount(TRUE);
             
-            bool nullGeometry = false;
             OGREnvelope *ogrEnv = NULL;
             OGRGeometry *geometry = NULL;
             std::string classVal = "";
@@ -1090,38 +1013,65 @@ namespace rsgis{namespace classifier{
             long pxlVal = 0.0;
             int i = 0;
             
+            // First pass: find the pixel under each feature so the image can be read in block order.
+            std::vector<char> hasGeometry;
+            std::vector<std::pair<unsigned int, unsigned int> > ptPxls;
             OGRFeature *featObj = NULL;
             inputVecLayer->ResetReading();
-            rsgis_tqdm pbar;
             while( (featObj = inputVecLayer->GetNextFeature()) != NULL )
             {
-                pbar.progress(i, numFeatures);
-                
-                // Get Geometry.
-                nullGeometry = false;
                 geometry = featObj->GetGeometryRef();
-                if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbPoint )
+                if(geometry != NULL)
                 {
-                    OGRPoint *pt = (OGRPoint *) geometry;
-                    eastings = pt->getX();
-                    northings = pt->getY();
-                }
-                else if(geometry != NULL)
-                {
-                    ogrEnv = new OGREnvelope();
-                    geometry->getEnvelope(ogrEnv);
-                    eastings = ogrEnv->MinX + ((ogrEnv->MaxX - ogrEnv->MinX)/2);
-                    northings = ogrEnv->MinY + ((ogrEnv->MaxY - ogrEnv->MinY)/2);
+                    if(wkbFlatten(geometry->getGeometryType()) == wkbPoint)
+                    {
+                        OGRPoint *pt = (OGRPoint *) geometry;
+                        eastings = pt->getX();
+                        northings = pt->getY();
+                    }
+                    else
+                    {
+                        ogrEnv = new OGREnvelope();
+                        geometry->getEnvelope(ogrEnv);
+                        eastings = ogrEnv->MinX + ((ogrEnv->MaxX - ogrEnv->MinX)/2);
+                        northings = ogrEnv->MinY + ((ogrEnv->MaxY - ogrEnv->MinY)/2);
+                        delete ogrEnv;
+                    }
+                    
+                    double diffX = eastings - tlX;
+                    double diffY = tlY - northings;
+                    if((diffX < 0) | (diffY < 0) | ((diffX/xRes) >= imgSizeX) | ((diffY/yRes) >= imgSizeY))
+                    {
+                        OGRFeature::DestroyFeature(featObj);
+                        throw rsgis::RSGISImageException("Not found within the scene.");
+                    }
+                    ptPxls.push_back(std::pair<unsigned int, unsigned int>(diffX/xRes, diffY/yRes));
+                    hasGeometry.push_back(1);
                 }
                 else
                 {
-                    nullGeometry = true;
+                    hasGeometry.push_back(0);
                     std::cout << "WARNING: NULL Geometry Present within input file - IGNORED\n";
                 }
+                OGRFeature::DestroyFeature(featObj);
+            }
+            
+            std::vector<double> ptPxlVals;
+            rsgis::img::RSGISStratifiedPxlSampler pxlReader = rsgis::img::RSGISStratifiedPxlSampler(0);
+            pxlReader.readPxlValues(inputImage, 1, ptPxls, &ptPxlVals);
+            
+            // Second pass: write the class to each feature.
+            size_t ptIdx = 0;
+            size_t featIdx = 0;
+            inputVecLayer->ResetReading();
+            rsgis_tqdm pbar;
+            while( (featObj = inputVecLayer->GetNextFeature()) != NULL )
+            {
+                pbar.progress(i, numFeatures);
                 
-                if(!nullGeometry)
+                if((featIdx < hasGeometry.size()) && hasGeometry.at(featIdx))
                 {
-                    pxlVal = long(this->findPixelVal(inputImage, 1, eastings, northings, tlX, tlY, xRes, yRes, imgSizeX, imgSizeY));
+                    pxlVal = long(float(ptPxlVals.at(ptIdx++)));
                     if((pxlVal > 0) & (pxlVal < imgClassColVals->size()))
                     {
                         classVal = imgClassColVals->at(pxlVal);
@@ -1129,22 +1079,16 @@ namespace rsgis{namespace classifier{
                         {
                             classVal = "NA";
                         }
-
-                        featObj->SetField(imgClassColIdx, classVal.c_str());
-                        if(addRefCol)
-                        {
-                            featObj->SetField(refClassColIdx, emptyStr.c_str());
-                        }
-                        
                     }
                     else
                     {
                         classVal = "NA";
-                        featObj->SetField(imgClassColIdx, classVal.c_str());
-                        if(addRefCol)
-                        {
-                            featObj->SetField(refClassColIdx, emptyStr.c_str());
-                        }
+                    }
+                    
+                    featObj->SetField(imgClassColIdx, classVal.c_str());
+                    if(addRefCol)
+                    {
+                        featObj->SetField(refClassColIdx, emptyStr.c_str());
                     }
                     featObj->SetField(processedColIdx, 0);
                     
@@ -1155,11 +1099,12 @@ namespace rsgis{namespace classifier{
                 }
                 
                 OGRFeature::DestroyFeature(featObj);
+                ++featIdx;
                 i++;
             }
             pbar.finish();
             
-        
+            delete imgClassColVals;
         }
         catch(rsgis::RSGISImageException &e)
         {
@@ -1291,42 +1236,29 @@ namespace rsgis{namespace classifier{
         return classes;
     }
     
-    RSGISGenAccuracyPoints::~RSGISGenAccuracyPoints()
-    {
-        
-    }
-    
-    
-    
-    RSGISExtractClassPxllocs::RSGISExtractClassPxllocs(std::vector<std::pair<double, double> > **classPxlLst, unsigned long numClasses):rsgis::img::RSGISCalcImageValue(0)
-    {
-        this->classPxlLst = classPxlLst;
-        this->numClasses = numClasses;
-    }
-    
-    void RSGISExtractClassPxllocs::calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals, geos::geom::Envelope extent)
+    std::vector<long> RSGISGenAccuracyPoints::createClassIdxLUT(std::vector<std::string> *rowClassNames, std::map<std::string, size_t> *classesLookUp)
     {
-        if((numIntVals != 1) & (numfloatVals != 0))
-        {
-            throw rsgis::img::RSGISImageCalcException("Only expecting a single integer input image band.");
-        }
-        
-        if(intBandValues[0] > 0)
+        // Row zero is the background so is never sampled.
+        std::vector<long> classIdxLUT(rowClassNames->size(), -1);
+        std::map<std::string, size_t>::iterator iterMap;
+        for(size_t i = 1; i < rowClassNames->size(); ++i)
         {
-            if(intBandValues[0] <= this->numClasses)
+            iterMap = classesLookUp->find(boost::trim_all_copy(rowClassNames->at(i)));
+            if(iterMap != classesLookUp->end())
             {
-                double x = extent.getMinX() + (extent.getWidth()/2);
-                double y = extent.getMinY() + (extent.getHeight()/2);
-                this->classPxlLst[intBandValues[0]-1]->push_back(std::pair<double, double>(x, y));
+                classIdxLUT.at(i) = iterMap->second;
             }
         }
+        return classIdxLUT;
     }
-
-    RSGISExtractClassPxllocs::~RSGISExtractClassPxllocs()
+    
+    RSGISGenAccuracyPoints::~RSGISGenAccuracyPoints()
     {
         
     }
     
+    
+    
 }}
 
 
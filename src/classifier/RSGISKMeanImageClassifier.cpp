@@ -426,37 +426,14 @@ namespace rsgis{ namespace classifier{
 			numPxlInClusters[i] = 0;
 		}
 		
+		centreSearch = NULL;
+		this->updateCentreSearch();
 	}
 	
 	void RSGISKMeanCalcPixelClusterCalcImageVal::calcImageValue(float *bandValues, int numBands) 
 	{
 		// Identify cluster within which point is associated with
-		double minDistance = 0;
-		unsigned int minIdx = 0;
-		bool first = true;
-		double sum = 0;
-		double distance = 0;
-		for(unsigned int i = 0; i < numClusters; ++i)
-		{
-			sum = 0;
-			for(int j = 0; j < numBands; ++j)
-			{
-				sum += ((clusterCentres[i]->data->vector[j] - bandValues[j])*(clusterCentres[i]->data->vector[j] - bandValues[j]));
-			}
-			distance = sum/numBands;
-			
-			if(first)
-			{
-				minDistance = distance;
-				minIdx = i;
-				first = false;
-			}
-			else if(distance < minDistance)
-			{
-				minDistance = distance;
-				minIdx = i;
-			}
-		}
+		unsigned int minIdx = centreSearch->findNearest(bandValues);
 		
 		// add to sum for next centre
 		for(int i = 0; i < numBands; ++i)
@@ -487,10 +464,35 @@ namespace rsgis{ namespace classifier{
 			}
 			numPxlInClusters[i] = 0;
 		}
+		
+		// The centres have been moved so the search needs the new centres.
+		this->updateCentreSearch();
+	}
+	
+	void RSGISKMeanCalcPixelClusterCalcImageVal::updateCentreSearch()
+	{
+		std::vector<double> centreVals(((size_t)numClusters) * numImageBands);
+		for(unsigned int i = 0; i < numClusters; ++i)
+		{
+			for(unsigned int j = 0; j < numImageBands; ++j)
+			{
+				centreVals[(((size_t)i) * numImageBands) + j] = clusterCentres[i]->data->vector[j];
+			}
+		}
+		if(centreSearch == NULL)
+		{
+			centreSearch = new rsgis::math::RSGISNearestCentreSearch(centreVals.data(), numClusters, numImageBands);
+		}
+		else
+		{
+			centreSearch->setCentres(centreVals.data(), numClusters, numImageBands);
+		}
 	}
 	
 	RSGISKMeanCalcPixelClusterCalcImageVal::~RSGISKMeanCalcPixelClusterCalcImageVal()
 	{
+		delete centreSearch;
+		
 		rsgis::math::RSGISVectors vecUtils;
 		for(unsigned int i = 0; i < numClusters; ++i)
 		{
@@ -625,41 +627,30 @@ namespace rsgis{ namespace classifier{
 	{
 		this->clusterCentres = clusterCentres;
 		this->numClusters = numClusters;
+		
+		unsigned int numVals = clusterCentres[0]->data->n;
+		std::vector<double> centreVals(((size_t)numClusters) * numVals);
+		for(unsigned int i = 0; i < numClusters; ++i)
+		{
+			for(unsigned int j = 0; j < numVals; ++j)
+			{
+				centreVals[(((size_t)i) * numVals) + j] = clusterCentres[i]->data->vector[j];
+			}
+		}
+		this->centreSearch = new rsgis::math::RSGISNearestCentreSearch(centreVals.data(), numClusters, numVals);
 	}
 	
 	void RSGISApplyKMeanClassifierCalcImageVal::calcImageValue(float *bandValues, int numBands, double *output) 
 	{
-		double minDistance = 0;
-		unsigned int minIdx = 0;
-		bool first = true;
-		double sum = 0;
-		double distance = 0;
-		for(unsigned int i = 0; i < numClusters; ++i)
+		if(((unsigned int)numBands) != centreSearch->getNumVars())
 		{
-			sum = 0;
-			for(int j = 0; j < numBands; ++j)
-			{
-				sum += ((clusterCentres[i]->data->vector[j] - bandValues[j])*(clusterCentres[i]->data->vector[j] - bandValues[j]));
-			}
-			distance = sum/numBands;
-			
-			if(first)
-			{
-				minDistance = distance;
-				minIdx = i;
-				first = false;
-			}
-			else if(distance < minDistance)
-			{
-				minDistance = distance;
-				minIdx = i;
-			}
+			throw rsgis::img::RSGISImageCalcException("The number of image bands does not match the cluster centres.");
 		}
-		output[0] = minIdx;
+		output[0] = centreSearch->findNearest(bandValues);
 	}
 	
 	RSGISApplyKMeanClassifierCalcImageVal::~RSGISApplyKMeanClassifierCalcImageVal()
 	{
-		
+		delete centreSearch;
 	}
 }}
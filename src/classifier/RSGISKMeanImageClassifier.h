@@ -29,11 +29,14 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
 
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISImageStatistics.h"
 
+#include "math/RSGISNearestCentreSearch.h"
+
 #include "common/RSGISClassificationException.h"
 
 #include "utils/RSGISExportForPlotting.h"
@@ -100,11 +103,13 @@ namespace rsgis{ namespace classifier{
 		void reset();
 		~RSGISKMeanCalcPixelClusterCalcImageVal();
 	protected:
+		void updateCentreSearch();
 		ClusterCentre **clusterCentres;
 		unsigned int numClusters;
 		ClusterCentre **newClusterCentres;
 		unsigned long *numPxlInClusters;
 		unsigned int numImageBands;
+		rsgis::math::RSGISNearestCentreSearch *centreSearch;
 	};
 	
 	class DllExport RSGISCalcDist2NrCentreCalcImageVal : public rsgis::img::RSGISCalcImageValue
@@ -173,6 +178,7 @@ namespace rsgis{ namespace classifier{
 	protected:
 		ClusterCentre **clusterCentres;
 		unsigned int numClusters;
+		rsgis::math::RSGISNearestCentreSearch *centreSearch;
 	};
 }}
 
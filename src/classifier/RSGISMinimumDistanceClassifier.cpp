@@ -28,6 +28,16 @@ namespace rsgis{ namespace classifier{
 	{
 		this->centreType = centreType;
 		this->calcClusterCentres();
+		
+		std::vector<double> centreVals(((size_t)numClasses) * numVariables);
+		for(int i = 0; i < numClasses; i++)
+		{
+			for(int j = 0; j < numVariables; j++)
+			{
+				centreVals[(((size_t)i) * numVariables) + j] = clusterCentres[i].data->matrix[j];
+			}
+		}
+		this->centreSearch = new rsgis::math::RSGISNearestCentreSearch(centreVals.data(), numClasses, numVariables);
 	}
 	
 	int RSGISMinimumDistanceClassifier::getClassID(float *variables, int numVars)
@@ -124,42 +134,16 @@ namespace rsgis{ namespace classifier{
 	
 	ClassData* RSGISMinimumDistanceClassifier::findClass(float *variables, int numVars)
 	{
-		double distance = 0;
-		double minDistance = 0;
-		double sqSum = 0;
-		double sumPair = 0;
-		ClassData *minDistClass = NULL;
-		
-		for(int i = 0; i < numClasses; i++)
+		if(numVars != numVariables)
 		{
-			sqSum = 0;
-			for(int j = 0; j < numVars; j++)
-			{
-				sumPair = clusterCentres->data->matrix[i] - variables[j]; 
-				sqSum += (sumPair*sumPair);
-			}
-			distance = sqrt(sqSum);
-			
-			if(i == 0)
-			{
-				minDistance = distance;
-				minDistClass = &clusterCentres[i];
-			}
-			else
-			{
-				if(distance < minDistance)
-				{
-					minDistance = distance;
-					minDistClass = &clusterCentres[i];
-				}
-			}
+			throw RSGISClassificationException("The number of variables does not match the training data.");
 		}
-		return minDistClass;
+		return &clusterCentres[centreSearch->findNearest(variables)];
 	}
 	
 	RSGISMinimumDistanceClassifier::~RSGISMinimumDistanceClassifier()
 	{
-		
+		delete centreSearch;
 	}
 }}
 
@@ -25,8 +25,10 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include "classifier/RSGISClassifier.h"
 #include "math/RSGISMatrices.h"
+#include "math/RSGISNearestCentreSearch.h"
 #include "common/RSGISClassificationException.h"
 
 // mark all exported classes/functions with DllExport to have
@@ -62,6 +64,7 @@ namespace rsgis{ namespace classifier{
 			ClassData* findClass(float *variables, int numVars);
 			ClassData *clusterCentres;
 			MinDistCentreType centreType;
+			rsgis::math::RSGISNearestCentreSearch *centreSearch;
 		};
 	
 }}
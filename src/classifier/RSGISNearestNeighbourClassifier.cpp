@@ -26,7 +26,20 @@ namespace rsgis{ namespace classifier{
 
 	RSGISNearestNeighbourClassifier::RSGISNearestNeighbourClassifier(ClassData **trainingData, int numClasses) : RSGISClassifier(trainingData, numClasses)
 	{
-
+		// All the training points are searched together, in class order, so
+		// ties go to the first class as when each class is searched in turn.
+		std::vector<double> pointVals;
+		for(int i = 0; i < numClasses; i++)
+		{
+			if(trainingData[i]->data->n != numVariables)
+			{
+				throw RSGISClassificationException("All the training data must have the same number of variables.");
+			}
+			size_t numVals = ((size_t)trainingData[i]->data->m) * trainingData[i]->data->n;
+			pointVals.insert(pointVals.end(), trainingData[i]->data->matrix, trainingData[i]->data->matrix + numVals);
+			pointClasses.insert(pointClasses.end(), trainingData[i]->data->m, i);
+		}
+		pointSearch = new rsgis::math::RSGISNearestCentreSearch(pointVals.data(), pointClasses.size(), numVariables);
 	}
 	
 	int RSGISNearestNeighbourClassifier::getClassID(float *variables, int numVars)
@@ -43,64 +56,15 @@ namespace rsgis{ namespace classifier{
 	
 	ClassData* RSGISNearestNeighbourClassifier::findClass(float *variables, int numVars)
 	{
-		double distance = 0;
-		double minDistance = 0;
-		ClassData *minDistData = NULL;
-		for(int i = 0; i < this->numClasses; i++)
-		{
-			if(i == 0)
-			{
-				minDistance = this->findClosestPointInClass(trainingData[i], variables, numVars);
-				minDistData = trainingData[i];
-			}
-			else
-			{
-				distance = this->findClosestPointInClass(trainingData[i], variables, numVars);
-				if(distance < minDistance)
-				{
-					minDistance = distance;
-					minDistData = trainingData[i];
-				}
-			}
-		}
-		return minDistData;
-	}
-	
-	double RSGISNearestNeighbourClassifier::findClosestPointInClass(ClassData *data, float *variables, int numVars)
-	{
-		double minDistance = 0;
-		double distance = 0;
-		int matrixIndex = 0;
-		double sqSum = 0;
-		double sumPair = 0;
-		for(int i = 0; i < data->data->m; i++)
+		if(numVars != numVariables)
 		{
-			sqSum = 0;
-			for(int j = 0; j < numVars; j++)
-			{
-				sumPair = data->data->matrix[matrixIndex] - variables[j]; 
-				sqSum += (sumPair*sumPair);
-				matrixIndex++;
-			}
-			distance = sqrt(sqSum);
-			
-			if(i == 0)
-			{
-				minDistance = distance;
-			}
-			else
-			{
-				if(distance < minDistance)
-				{
-					minDistance = distance;
-				}
-			}
+			throw RSGISClassificationException("The number of variables does not match the training data.");
 		}
-		return minDistance;
+		return trainingData[pointClasses[pointSearch->findNearest(variables)]];
 	}
 	
 	RSGISNearestNeighbourClassifier::~RSGISNearestNeighbourClassifier()
 	{
-		
+		delete pointSearch;
 	}
 }}
@@ -25,8 +25,10 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include "classifier/RSGISClassifier.h"
 #include "math/RSGISMatrices.h"
+#include "math/RSGISNearestCentreSearch.h"
 #include "common/RSGISClassificationException.h"
 #include <math.h>
 
@@ -54,7 +56,8 @@ namespace rsgis{ namespace classifier{
 			~RSGISNearestNeighbourClassifier();
 		protected:
 			ClassData* findClass(float *variables, int numVars);
-			double findClosestPointInClass(ClassData *data, float *variables, int numVars);
+			rsgis::math::RSGISNearestCentreSearch *pointSearch;
+			std::vector<int> pointClasses;
 		};
 
 }}
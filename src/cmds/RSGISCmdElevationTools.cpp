@@ -25,6 +25,8 @@
 
 #include "calibration/RSGISDEMTools.h"
 #include "calibration/RSGISHydroDEMFillSoilleGratin94.h"
+#include "calibration/RSGISTerrainHorizon.h"
+#include "calibration/RSGISTerrainDerivatives.h"
 
 namespace rsgis{ namespace cmds {
     
@@ -223,6 +225,12 @@ namespace rsgis{ namespace cmds {
 
     
     void executeCalcShadowMask(std::string demImage, std::string outputImage, float solarAzimuth, float solarZenith, float maxHeight, std::string outImageFormat)
+    {
+        std::cerr << "WARNING: maxHeight is deprecated and ignored, the shadow search distance is taken from the DEM.\n";
+        executeCalcShadowMask(demImage, outputImage, solarAzimuth, solarZenith, outImageFormat);
+    }
+    
+    void executeCalcShadowMask(std::string demImage, std::string outputImage, float solarAzimuth, float solarZenith, std::string outImageFormat)
     {
         try
         {
@@ -255,34 +263,192 @@ namespace rsgis{ namespace cmds {
                 throw rsgis::RSGISException("The DEM image file does not have a no data value defined. ");
             }
             
-            double *transformation = new double[6];
-            dataset->GetGeoTransform(transformation);
+            // Cast shadows are found by sweeping the DEM along the solar azimuth, with the search
+            // distance taken from the DEM's elevation range.
+            rsgis::calib::RSGISTerrainHorizon terrainHorizon(dataset, 1, demNoDataVal);
             
-            float imageEWRes = transformation[1];
-            float imageNSRes = transformation[5];
+            rsgis::img::RSGISImageUtils imgUtils;
+            GDALDataset *outImgDS = imgUtils.createCopy(dataset, 1, outputImage, outImageFormat, GDT_Byte);
+            terrainHorizon.calcShadowMask(solarZenith, solarAzimuth, outImgDS, 1);
             
-            if(imageNSRes < 0)
+            GDALClose(outImgDS);
+            GDALClose(dataset);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+
+    
+    void executeCalcSkyViewFactor(std::string demImage, std::string outputImage, unsigned int numAzimuths, float maxSearchDist, std::string outImageFormat)
+    {
+        try
+        {
+            GDALAllRegister();
+            
+            std::cout << "Open " << demImage << std::endl;
+            GDALDataset *dataset = (GDALDataset *) GDALOpen(demImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
             {
-                imageNSRes = imageNSRes * (-1);
+                std::string message = std::string("Could not open image ") + demImage;
+                throw rsgis::RSGISImageException(message.c_str());
             }
             
-            delete[] transformation;
+            double demNoDataVal = 0.0;
+            int demNoDataValAvail = false;
+            demNoDataVal = dataset->GetRasterBand(1)->GetNoDataValue(&demNoDataValAvail);
+            if(!demNoDataValAvail)
+            {
+                GDALClose(dataset);
+                throw rsgis::RSGISException("The DEM image file does not have a no data value defined. ");
+            }
+            
+            rsgis::calib::RSGISTerrainHorizon terrainHorizon(dataset, 1, demNoDataVal);
+            
+            rsgis::img::RSGISImageUtils imgUtils;
+            GDALDataset *outImgDS = imgUtils.createCopy(dataset, 1, outputImage, outImageFormat, GDT_Float32);
+            terrainHorizon.calcSkyViewFactor(numAzimuths, maxSearchDist, outImgDS, 1);
+            outImgDS->GetRasterBand(1)->SetNoDataValue(demNoDataVal);
+            
+            GDALClose(outImgDS);
+            GDALClose(dataset);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+    
+    void executeCalcHorizonAngles(std::string demImage, std::string outputImage, unsigned int numAzimuths, float maxSearchDist, std::string outImageFormat)
+    {
+        try
+        {
+            GDALAllRegister();
+            
+            if(numAzimuths == 0)
+            {
+                throw rsgis::RSGISException("At least one azimuth must be specified.");
+            }
+            
+            std::cout << "Open " << demImage << std::endl;
+            GDALDataset *dataset = (GDALDataset *) GDALOpen(demImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + demImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            double demNoDataVal = 0.0;
+            int demNoDataValAvail = false;
+            demNoDataVal = dataset->GetRasterBand(1)->GetNoDataValue(&demNoDataValAvail);
+            if(!demNoDataValAvail)
+            {
+                GDALClose(dataset);
+                throw rsgis::RSGISException("The DEM image file does not have a no data value defined. ");
+            }
             
-            rsgis::calib::RSGISCalcShadowBinaryMask *calcShadowMask = new rsgis::calib::RSGISCalcShadowBinaryMask(1, dataset, 0, imageEWRes, imageNSRes, solarZenith, solarAzimuth, maxHeight, demNoDataVal);
+            rsgis::calib::RSGISTerrainHorizon terrainHorizon(dataset, 1, demNoDataVal);
             
-            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(calcShadowMask, "", true);
+            rsgis::img::RSGISImageUtils imgUtils;
+            GDALDataset *outImgDS = imgUtils.createCopy(dataset, numAzimuths, outputImage, outImageFormat, GDT_Float32);
             
-            calcImage.calcImageWindowDataExtent(&dataset, 1, outputImage, 3, outImageFormat, GDT_Byte);
+            // One band per azimuth, clockwise from north.
+            terrainHorizon.calcHorizonAngles(numAzimuths, maxSearchDist, outImgDS);
+            for(unsigned int a = 0; a < numAzimuths; ++a)
+            {
+                float azimuth = (360.0 * a) / numAzimuths;
+                outImgDS->GetRasterBand(a+1)->SetNoDataValue(demNoDataVal);
+                outImgDS->GetRasterBand(a+1)->SetDescription((std::string("Azimuth_") + std::to_string(azimuth)).c_str());
+            }
             
+            GDALClose(outImgDS);
+            GDALClose(dataset);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+    
+    void executeCalcTerrainDerivatives(std::string demImage, std::string outputImage, std::vector<std::string> derivatives, float solarAzimuth, float solarZenith, float viewAzimuth, float viewZenith, RSGISAngleMeasure slopeUnit, std::string outImageFormat)
+    {
+        try
+        {
+            GDALAllRegister();
+            
+            std::vector<rsgis::calib::RSGISTerrainDerivativeType> derivTypes;
+            for(std::vector<std::string>::iterator iterDerivs = derivatives.begin(); iterDerivs != derivatives.end(); ++iterDerivs)
+            {
+                if(*iterDerivs == "slope")
+                {
+                    derivTypes.push_back(rsgis::calib::rsgis_terrain_slope);
+                }
+                else if(*iterDerivs == "aspect")
+                {
+                    derivTypes.push_back(rsgis::calib::rsgis_terrain_aspect);
+                }
+                else if(*iterDerivs == "hillshade")
+                {
+                    derivTypes.push_back(rsgis::calib::rsgis_terrain_hillshade);
+                }
+                else if(*iterDerivs == "curvature")
+                {
+                    derivTypes.push_back(rsgis::calib::rsgis_terrain_curvature);
+                }
+                else if(*iterDerivs == "tpi")
+                {
+                    derivTypes.push_back(rsgis::calib::rsgis_terrain_tpi);
+                }
+                else if(*iterDerivs == "incidence")
+                {
+                    derivTypes.push_back(rsgis::calib::rsgis_terrain_incidence);
+                }
+                else if(*iterDerivs == "exitance")
+                {
+                    derivTypes.push_back(rsgis::calib::rsgis_terrain_exitance);
+                }
+                else
+                {
+                    throw rsgis::RSGISException("Terrain derivative \'" + *iterDerivs + "\' is not recognised.");
+                }
+            }
+            if(derivTypes.empty())
+            {
+                throw rsgis::RSGISException("At least one terrain derivative must be specified.");
+            }
+            
+            std::cout << "Open " << demImage << std::endl;
+            GDALDataset *dataset = (GDALDataset *) GDALOpen(demImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + demImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            double demNoDataVal = 0.0;
+            int demNoDataValAvail = false;
+            demNoDataVal = dataset->GetRasterBand(1)->GetNoDataValue(&demNoDataValAvail);
+            if(!demNoDataValAvail)
+            {
+                GDALClose(dataset);
+                throw rsgis::RSGISException("The DEM image file does not have a no data value defined. ");
+            }
+            
+            rsgis::img::RSGISImageUtils imgUtils;
+            GDALDataset *outImgDS = imgUtils.createCopy(dataset, derivTypes.size(), outputImage, outImageFormat, GDT_Float32);
+            
+            rsgis::calib::RSGISTerrainDerivatives terrainDerivs(derivTypes, solarZenith, solarAzimuth, viewZenith, viewAzimuth, (slopeUnit == rsgis_degrees));
+            terrainDerivs.calcTerrainDerivatives(dataset, 1, demNoDataVal, outImgDS);
+            
+            GDALClose(outImgDS);
             GDALClose(dataset);
-            delete calcShadowMask;
         }
         catch(rsgis::RSGISException &e)
         {
             throw RSGISCmdException(e.what());
         }
     }
-
     
     void executeCalcLocalIncidenceAngle(std::string demImage, std::string outputImage, float solarAzimuth, float solarZenith, std::string outImageFormat)
     {
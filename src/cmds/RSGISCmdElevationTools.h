@@ -61,7 +61,15 @@ namespace rsgis{ namespace cmds {
     /** A function to generate a hillshade layer */
     DllExport void executeCalcHillshade(std::string demImage, std::string outputImage, float solarAzimuth, float solarZenith, std::string outImageFormat);
     /** A function to generate a shadow mask layer */
+    DllExport void executeCalcShadowMask(std::string demImage, std::string outputImage, float solarAzimuth, float solarZenith, std::string outImageFormat);
+    /** Deprecated: maxHeight is ignored (a warning is printed), use the version without it */
     DllExport void executeCalcShadowMask(std::string demImage, std::string outputImage, float solarAzimuth, float solarZenith, float maxHeight, std::string outImageFormat);
+    /** A function to generate a sky view factor layer from the horizons at numAzimuths directions, searched to maxSearchDist (0 for the whole DEM) */
+    DllExport void executeCalcSkyViewFactor(std::string demImage, std::string outputImage, unsigned int numAzimuths, float maxSearchDist, std::string outImageFormat);
+    /** A function to generate the horizon elevation angles (degrees), one band per azimuth, searched to maxSearchDist (0 for the whole DEM) */
+    DllExport void executeCalcHorizonAngles(std::string demImage, std::string outputImage, unsigned int numAzimuths, float maxSearchDist, std::string outImageFormat);
+    /** A function to generate any subset of slope, aspect, hillshade, curvature, tpi, incidence and exitance layers in a single pass (one band each) */
+    DllExport void executeCalcTerrainDerivatives(std::string demImage, std::string outputImage, std::vector<std::string> derivatives, float solarAzimuth, float solarZenith, float viewAzimuth, float viewZenith, RSGISAngleMeasure slopeUnit, std::string outImageFormat);
     /** A function to generate a local incidence angle layer given the sun position */
     DllExport void executeCalcLocalIncidenceAngle(std::string demImage, std::string outputImage, float solarAzimuth, float solarZenith, std::string outImageFormat);
     /** A function to generate a local exitance angle layer given a viewers position */
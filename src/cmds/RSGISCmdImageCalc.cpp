@@ -43,6 +43,8 @@
 #include "img/RSGISImageNormalisation.h"
 #include "img/RSGISStandardiseImage.h"
 #include "img/RSGISApplyEigenvectors.h"
+#include "img/RSGISImagePCA.h"
+#include "img/RSGISSavitzkyGolaySmoothingFilters.h"
 #include "img/RSGISReplaceValuesLessThanGivenValue.h"
 #include "img/RSGISConvertSpectralToUnitArea.h"
 #include "img/RSGISCalculateImageMovementSpeed.h"
@@ -1294,11 +1296,9 @@ namespace rsgis{ namespace cmds {
     void executePCA(std::string inputImage, std::string eigenvectors, std::string outputImage, int numComponents, std::string gdalFormat, RSGISLibDataType outDataType)
     {
         GDALAllRegister();
-        GDALDataset **datasets = NULL;
+        GDALDataset *dataset = NULL;
 
         rsgis::math::RSGISMatrices matrixUtils;
-        rsgis::img::RSGISCalcImage *calcImage = NULL;
-        rsgis::img::RSGISApplyEigenvectors *applyPCA = NULL;
         rsgis::math::Matrix *eigenvectorsMatrix = NULL;
 
         try
@@ -1307,10 +1307,9 @@ namespace rsgis{ namespace cmds {
             eigenvectorsMatrix = matrixUtils.readMatrixFromTxt(eigenvectors);
             std::cout << "Finished reading in matrix\n";
 
-            datasets = new GDALDataset*[1];
             std::cout << "Reading in image " << inputImage << std::endl;
-            datasets[0] = (GDALDataset *) GDALOpenShared(inputImage.c_str(), GA_ReadOnly);
-            if(datasets[0] == NULL)
+            dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
             {
                 std::string message = std::string("Could not open image ") + inputImage;
                 throw rsgis::RSGISImageException(message.c_str());
@@ -1320,37 +1319,153 @@ namespace rsgis{ namespace cmds {
             {
                 throw RSGISException("Number of component must be smaller or equal than the number image bands in the input image.");
             }
-
-            applyPCA = new rsgis::img::RSGISApplyEigenvectors(numComponents, eigenvectorsMatrix);
-            calcImage = new rsgis::img::RSGISCalcImage(applyPCA, "", true);
-            calcImage->calcImage(datasets, 1, outputImage, false, NULL, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
-
-            if(datasets[0] != NULL)
+            if(eigenvectorsMatrix->m != dataset->GetRasterCount())
             {
-                GDALClose(datasets[0]);
+                throw RSGISException("The length of the eigenvectors must match the number of image bands in the input image.");
             }
 
+            // Each row of the matrix is an eigenvector, applied without centring the data.
+            std::vector<double> transform(eigenvectorsMatrix->matrix, eigenvectorsMatrix->matrix + (eigenvectorsMatrix->n * eigenvectorsMatrix->m));
+            rsgis::img::RSGISImagePCA applyPCA;
+            applyPCA.applyTransform(dataset, transform, numComponents, NULL, outputImage, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
+
+            GDALClose(dataset);
+            matrixUtils.freeMatrix(eigenvectorsMatrix);
         }
         catch(rsgis::RSGISException &e)
         {
-            throw e;
+            if(dataset != NULL)
+            {
+                GDALClose(dataset);
+            }
+            if(eigenvectorsMatrix != NULL)
+            {
+                matrixUtils.freeMatrix(eigenvectorsMatrix);
+            }
+            throw RSGISCmdException(e.what());
         }
+    }
 
-        if(calcImage != NULL)
+    std::vector<double> executeImagePCA(std::string inputImage, std::string outputImage, std::string outEigenVecFile, unsigned int numComponents, bool calcMNF, float sampleRatio, bool useNoData, float noDataVal, std::string gdalFormat, RSGISLibDataType outDataType)
+    {
+        GDALAllRegister();
+        GDALDataset *dataset = NULL;
+        std::vector<double> eigenvalues;
+
+        rsgis::math::RSGISMatrices matrixUtils;
+        rsgis::math::Matrix *eigenvectorsMatrix = NULL;
+
+        try
         {
-            delete calcImage;
+            dataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(dataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            unsigned int numBands = dataset->GetRasterCount();
+
+            rsgis::img::RSGISImagePCA imgPCA = rsgis::img::RSGISImagePCA(0, useNoData, noDataVal, sampleRatio);
+            std::vector<double> meanVec;
+            std::vector<double> covMatrix;
+            std::vector<double> noiseCovMatrix;
+            unsigned long numPxls = 0;
+            std::vector<double> transform;
+            if(calcMNF)
+            {
+                std::cout << "Calculating the image and noise covariance matrices\n";
+                imgPCA.calcMeanCovariance(dataset, &meanVec, &covMatrix, &numPxls, &noiseCovMatrix);
+                imgPCA.calcMNFTransform(covMatrix, noiseCovMatrix, numBands, &transform, &eigenvalues);
+            }
+            else
+            {
+                std::cout << "Calculating the image covariance matrix\n";
+                imgPCA.calcMeanCovariance(dataset, &meanVec, &covMatrix, &numPxls);
+                imgPCA.calcPCATransform(covMatrix, numBands, &transform, &eigenvalues);
+            }
+            std::cout << "Covariance calculated from " << numPxls << " pixels\n";
+
+            if((numComponents == 0) | (numComponents > eigenvalues.size()))
+            {
+                numComponents = eigenvalues.size();
+            }
+
+            if(outEigenVecFile != "")
+            {
+                eigenvectorsMatrix = matrixUtils.createMatrix(eigenvalues.size(), numBands);
+                for(size_t i = 0; i < transform.size(); ++i)
+                {
+                    eigenvectorsMatrix->matrix[i] = transform[i];
+                }
+                matrixUtils.saveMatrix2txt(eigenvectorsMatrix, outEigenVecFile);
+                matrixUtils.freeMatrix(eigenvectorsMatrix);
+                eigenvectorsMatrix = NULL;
+            }
+
+            std::cout << "Applying the transform\n";
+            imgPCA.applyTransform(dataset, transform, numComponents, &meanVec, outputImage, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
+
+            GDALClose(dataset);
         }
-        if(applyPCA != NULL)
+        catch(rsgis::RSGISException &e)
         {
-            delete applyPCA;
+            if(dataset != NULL)
+            {
+                GDALClose(dataset);
+            }
+            if(eigenvectorsMatrix != NULL)
+            {
+                matrixUtils.freeMatrix(eigenvectorsMatrix);
+            }
+            throw RSGISCmdException(e.what());
         }
+        return eigenvalues;
+    }
 
-        if(eigenvectorsMatrix != NULL)
+    void executeSmoothTimeSeriesSG(std::vector<std::string> inputImages, std::vector<unsigned int> imageBands, std::vector<double> imageTimes, std::string outputImage, unsigned int order, unsigned int window, bool useNoData, float noDataVal, std::string gdalFormat, RSGISLibDataType outDataType)
+    {
+        GDALAllRegister();
+        if((imageBands.size() != inputImages.size()) | (imageTimes.size() != inputImages.size()))
         {
-            matrixUtils.freeMatrix(eigenvectorsMatrix);
+            throw RSGISCmdException("Bands and Times were not supplied for all images");
         }
 
-        delete [] datasets;
+        // A file listed several times (e.g., each band of a stack) is only opened once.
+        std::map<std::string, GDALDataset*> openImages;
+        try
+        {
+            std::vector<GDALDataset*> datasets;
+            for(size_t i = 0; i < inputImages.size(); ++i)
+            {
+                if(openImages.count(inputImages[i]) == 0)
+                {
+                    GDALDataset *dataset = (GDALDataset *) GDALOpen(inputImages[i].c_str(), GA_ReadOnly);
+                    if(dataset == NULL)
+                    {
+                        std::string message = std::string("Could not open image ") + inputImages[i];
+                        throw rsgis::RSGISImageException(message.c_str());
+                    }
+                    openImages[inputImages[i]] = dataset;
+                }
+                datasets.push_back(openImages[inputImages[i]]);
+            }
+
+            rsgis::img::RSGISSavitzkyGolayTimeSeries sgTimeSeries(imageTimes, order, window, useNoData, noDataVal);
+            sgTimeSeries.smoothImages(datasets, imageBands, outputImage, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
+
+            for(std::map<std::string, GDALDataset*>::iterator iterImgs = openImages.begin(); iterImgs != openImages.end(); ++iterImgs)
+            {
+                GDALClose(iterImgs->second);
+            }
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            for(std::map<std::string, GDALDataset*>::iterator iterImgs = openImages.begin(); iterImgs != openImages.end(); ++iterImgs)
+            {
+                GDALClose(iterImgs->second);
+            }
+            throw RSGISCmdException(e.what());
+        }
     }
 
     void executeStandardise(std::string meanvectorStr, std::string inputImage, std::string outputImage)
@@ -120,6 +120,10 @@ namespace rsgis{ namespace cmds {
     DllExport void executeMeanVector(std::string inputImage, std::string outputMatrix);
     /** Function to perform principal components analysis of an image */
     DllExport void executePCA(std::string inputImage, std::string eigenvectors, std::string outputImage, int numComponents, std::string gdalFormat, RSGISLibDataType outDataType);
+    /** Function to calculate a PCA (or MNF) transform from an image and apply it in two streaming passes. Returns the eigenvalues. */
+    DllExport std::vector<double> executeImagePCA(std::string inputImage, std::string outputImage, std::string outEigenVecFile, unsigned int numComponents, bool calcMNF=false, float sampleRatio=1.0, bool useNoData=false, float noDataVal=0.0, std::string gdalFormat="KEA", RSGISLibDataType outDataType=rsgis_32float);
+    /** Function to apply a Savitzky-Golay filter to a time series of image bands with irregular dates and gaps */
+    DllExport void executeSmoothTimeSeriesSG(std::vector<std::string> inputImages, std::vector<unsigned int> imageBands, std::vector<double> imageTimes, std::string outputImage, unsigned int order, unsigned int window, bool useNoData=false, float noDataVal=0.0, std::string gdalFormat="KEA", RSGISLibDataType outDataType=rsgis_32float);
     /** Function to generate a standardised image using the mean vector provided */
     DllExport void executeStandardise(std::string meanvectorStr, std::string inputImage, std::string outputImage);
     /** Function to replace values less then given, using a threshold */
@@ -785,7 +785,6 @@ namespace rsgis{ namespace cmds {
             std::string tmpCloudsClumpRMSmall = tmpImgsBase + "_baseCloudClumpsRMSmall"+tmpImgFileExt;
             std::string tmpCloudsClumpRMSmallRelabel = tmpImgsBase + "_baseCloudClumpsRMSmallRelabel"+tmpImgFileExt;
             std::string tmpCloudsInitHeights = tmpImgsBase + "_baseCloudInitHeights"+tmpImgFileExt;
-            std::string tmpCloudsShadowTestRegions = tmpImgsBase + "_testShadowRegions"+tmpImgFileExt;
             std::string tmpCloudsShadows = tmpImgsBase + "_shadowRegions"+tmpImgFileExt;
             std::string tmpFinalShadowsDialate = tmpImgsBase + "_finalShadowsDialate"+tmpImgFileExt;
             std::string tmpFinalClouds = tmpImgsBase + "_finalClouds"+tmpImgFileExt;
@@ -1118,10 +1117,9 @@ namespace rsgis{ namespace cmds {
                 rsgis::calib::RSGISCalcCloudParams calcCloudParams;
                 calcCloudParams.calcCloudHeights(thermDataset, cloudClumpsRMSmallReLblDS, initCloudHeightsDS, lowerLandThres, upperLandThres, scaleFactorIn);
                 
-                GDALDataset *cloudShadowTestRegionsDS = imgUtils.createCopy(pass1DS, 1, tmpCloudsShadowTestRegions, gdalFormat, GDT_Byte);
                 GDALDataset *cloudShadowRegionsDS = imgUtils.createCopy(pass1DS, 1, tmpCloudsShadows, gdalFormat, GDT_Byte);
                 
-                calcCloudParams.projFitCloudShadow(cloudClumpsRMSmallReLblDS, initCloudHeightsDS, potentCloudShadowDS, cloudShadowTestRegionsDS, cloudShadowRegionsDS, sunAz, sunZen, senAz, senZen);
+                calcCloudParams.projFitCloudShadow(cloudClumpsRMSmallReLblDS, initCloudHeightsDS, potentCloudShadowDS, cloudShadowRegionsDS, sunAz, sunZen, senAz, senZen);
                 
                 
                 std::cout << "Apply cloud shadow majority filter...\n";
@@ -1224,7 +1222,6 @@ namespace rsgis{ namespace cmds {
                 GDALClose(cloudClumpsRMSmallDS);
                 GDALClose(cloudClumpsRMSmallReLblDS);
                 GDALClose(initCloudHeightsDS);
-                GDALClose(cloudShadowTestRegionsDS);
                 GDALClose(cloudShadowRegionsDS);
                 GDALClose(finalShadowsDialateDS);
                 GDALClose(finalCloudsDS);
@@ -1256,7 +1253,6 @@ namespace rsgis{ namespace cmds {
                     poDriver->Delete(tmpCloudsClumpRMSmall.c_str());
                     poDriver->Delete(tmpCloudsClumpRMSmallRelabel.c_str());
                     poDriver->Delete(tmpCloudsInitHeights.c_str());
-                    poDriver->Delete(tmpCloudsShadowTestRegions.c_str());
                     poDriver->Delete(tmpCloudsShadows.c_str());
                     poDriver->Delete(tmpFinalShadowsDialate.c_str());
                     poDriver->Delete(tmpFinalClouds.c_str());
@@ -1849,7 +1845,6 @@ namespace rsgis{ namespace cmds {
             std::string tmpDarkFillBandImg = tmpImgsBase + "_darkbandfill"+tmpImgFileExt;
             std::string tmpPotentShadows = tmpImgsBase + "_potentshadows"+tmpImgFileExt;
             std::string tmpClumpClouds = tmpImgsBase + "_cloudclumps"+tmpImgFileExt;
-            std::string tmpCloudsShadowTestRegions = tmpImgsBase + "_testShadowRegions"+tmpImgFileExt;
             std::string tmpCloudsShadows = tmpImgsBase + "_shadowRegions"+tmpImgFileExt;
             std::string tmpCloudsInitHeights = tmpImgsBase + "_baseCloudInitHeights"+tmpImgFileExt;
             
@@ -1899,12 +1894,11 @@ namespace rsgis{ namespace cmds {
             GDALDataset *initCloudHeightsDS = imgUtils.createCopy(validDataset, 2, tmpCloudsInitHeights, gdalFormat, GDT_Float32);
             imgUtils.assignValGDALDataset(initCloudHeightsDS, 0.0);
             
-            GDALDataset *cloudShadowTestRegionsDS = imgUtils.createCopy(validDataset, 1, tmpCloudsShadowTestRegions, gdalFormat, GDT_Byte);
             GDALDataset *cloudShadowRegionsDS = imgUtils.createCopy(validDataset, 1, tmpCloudsShadows, gdalFormat, GDT_Byte);
             
             rsgis::calib::RSGISCalcCloudParams calcCloudParams;
             calcCloudParams.calcCloudHeightsNoThermal(tmpClumpCloudsDS, initCloudHeightsDS);
-            calcCloudParams.projFitCloudShadow(tmpClumpCloudsDS, initCloudHeightsDS, potentCloudShadowDS, cloudShadowTestRegionsDS, cloudShadowRegionsDS, sunAz, sunZen, senAz, senZen);
+            calcCloudParams.projFitCloudShadow(tmpClumpCloudsDS, initCloudHeightsDS, potentCloudShadowDS, cloudShadowRegionsDS, sunAz, sunZen, senAz, senZen);
 
             std::cout << "Apply cloud shadow majority filter...\n";
             rsgis::calib::RSGISCalcImageCloudMajorityFilter cloudShadowMajFilter = rsgis::calib::RSGISCalcImageCloudMajorityFilter();
@@ -1921,7 +1915,6 @@ namespace rsgis{ namespace cmds {
             GDALClose(darkBandFillDS);
             GDALClose(potentCloudShadowDS);
             GDALClose(initCloudHeightsDS);
-            GDALClose(cloudShadowTestRegionsDS);
             GDALClose(cloudShadowRegionsDS);
             GDALClose(tmpClumpCloudsDS);
             
@@ -1937,7 +1930,6 @@ namespace rsgis{ namespace cmds {
                 poDriver->Delete(tmpDarkFillBandImg.c_str());
                 poDriver->Delete(tmpPotentShadows.c_str());
                 poDriver->Delete(tmpClumpClouds.c_str());
-                poDriver->Delete(tmpCloudsShadowTestRegions.c_str());
                 poDriver->Delete(tmpCloudsShadows.c_str());
                 poDriver->Delete(tmpCloudsInitHeights.c_str());
             }
@@ -2416,36 +2416,20 @@ void executeStretchImageWithStatsNoData(std::string inputImage, std::string outp
             }
             
             int numRasterBands = dataset->GetRasterCount();
+            std::vector<unsigned int> msBands;
+            for(int i = 1; i < numRasterBands; ++i)
+            {
+                msBands.push_back(i);
+            }
             
-            // Calculate statistics
             float *imageStats = new float[4];  // Set up an array to hold image stats
+            rsgis::img::RSGISHCSPanSharpenImages panSharpen = rsgis::img::RSGISHCSPanSharpenImages(dataset, msBands, dataset, numRasterBands);
             
-            std::cout << "Calculating image mean.." << std::endl;
-            rsgis::img::RSGISHCSPanSharpenCalcMeanStats panMean = rsgis::img::RSGISHCSPanSharpenCalcMeanStats(numRasterBands, imageStats);
-            rsgis::img::RSGISCalcImage calcImageMean = rsgis::img::RSGISCalcImage(&panMean, "", true);
-            calcImageMean.calcImage(&dataset, 1);
-            panMean.returnStats();
-            
-            std::cout << "Calculating image standard deviation.." << std::endl;
-            rsgis::img::RSGISHCSPanSharpenCalcSDStats panSD = rsgis::img::RSGISHCSPanSharpenCalcSDStats(numRasterBands, imageStats);
-            rsgis::img::RSGISCalcImage calcImageSD = rsgis::img::RSGISCalcImage(&panSD, "", true);
-            calcImageSD.calcImage(&dataset, 1);
-            panSD.returnStats();
-
+            std::cout << "Calculating image statistics.." << std::endl;
+            panSharpen.calcStats(imageStats);
             
             std::cout << "Pan sharpening.." << std::endl;
-            rsgis::img::RSGISHCSPanSharpen panSharpen = rsgis::img::RSGISHCSPanSharpen(numRasterBands - 1, imageStats);
-            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&panSharpen, "", true);
-            if(useNaiveMethod)
-            {
-                // naive mode
-                calcImage.calcImage(&dataset, 1, outputImage, false, NULL, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
-            }
-            else
-            {
-                // smart mode
-                calcImage.calcImageWindowData(&dataset, 1, outputImage, winSize, gdalFormat, RSGIS_to_GDAL_Type(outDataType));
-            }
+            panSharpen.panSharpen(imageStats, outputImage, gdalFormat, RSGIS_to_GDAL_Type(outDataType), winSize, useNaiveMethod);
             
             // Tidy up
             GDALClose(dataset);
@@ -2466,6 +2450,64 @@ void executeStretchImageWithStatsNoData(std::string inputImage, std::string outp
         }
     }
                 
+    void executePerformHCSPanSharpenImgs(std::string msImage, std::string panImage, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, unsigned int winSize, bool useNaiveMethod)
+    {
+        try
+        {
+            GDALAllRegister();
+            GDALDataset *msDataset = (GDALDataset *) GDALOpen(msImage.c_str(), GA_ReadOnly);
+            if(msDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + msImage;
+                throw RSGISImageException(message.c_str());
+            }
+            GDALDataset *panDataset = (GDALDataset *) GDALOpen(panImage.c_str(), GA_ReadOnly);
+            if(panDataset == NULL)
+            {
+                GDALClose(msDataset);
+                std::string message = std::string("Could not open image ") + panImage;
+                throw RSGISImageException(message.c_str());
+            }
+            
+            std::vector<unsigned int> msBands;
+            for(int i = 1; i <= msDataset->GetRasterCount(); ++i)
+            {
+                msBands.push_back(i);
+            }
+            
+            float *imageStats = new float[4];
+            try
+            {
+                rsgis::img::RSGISHCSPanSharpenImages panSharpen = rsgis::img::RSGISHCSPanSharpenImages(msDataset, msBands, panDataset, 1);
+                
+                std::cout << "Calculating image statistics.." << std::endl;
+                panSharpen.calcStats(imageStats);
+                
+                std::cout << "Pan sharpening.." << std::endl;
+                panSharpen.panSharpen(imageStats, outputImage, gdalFormat, RSGIS_to_GDAL_Type(outDataType), winSize, useNaiveMethod);
+            }
+            catch(RSGISException& e)
+            {
+                delete[] imageStats;
+                GDALClose(msDataset);
+                GDALClose(panDataset);
+                throw e;
+            }
+            
+            delete[] imageStats;
+            GDALClose(msDataset);
+            GDALClose(panDataset);
+        }
+        catch (RSGISException& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception& e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
+                
     void executeSharpenLowResImgBands(std::string inputImage, std::string outputImage, std::vector<RSGISInitSharpenBandInfo> bandInfo, unsigned int winSize, int noDataVal, std::string gdalFormat, RSGISLibDataType outDataType) 
     {
         try
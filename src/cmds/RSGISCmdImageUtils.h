@@ -208,6 +208,9 @@ DllExport void executeStretchImageWithStatsNoData(std::string inputImage, std::s
     /** A function to perform a pan-sharpening using a Hyperspherical Colour Space technique */
     DllExport void executePerformHCSPanSharpen(std::string inputImage, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, unsigned int winSize=7, bool useNaiveMethod=false);
     
+    /** A function to perform a HCS pan-sharpening from separate multispectral and panchromatic images, resampling the multispectral bands on the fly */
+    DllExport void executePerformHCSPanSharpenImgs(std::string msImage, std::string panImage, std::string outputImage, std::string gdalFormat, RSGISLibDataType outDataType, unsigned int winSize=7, bool useNaiveMethod=false);
+    
     /** A function to sharpen nn resampled lower resolution image bands using high native resolution image bands in the same stack */
     DllExport void executeSharpenLowResImgBands(std::string inputImage, std::string outputImage, std::vector<RSGISInitSharpenBandInfo> bandInfo, unsigned int winSize, int noDataVal, std::string gdalFormat, RSGISLibDataType outDataType);
     
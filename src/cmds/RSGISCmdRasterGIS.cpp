@@ -60,6 +60,7 @@
 #include "rastergis/RSGISDefineClumpsInTiles.h"
 #include "rastergis/RSGISRATStats.h"
 #include "rastergis/RSGISExportClumps2Imgs.h"
+#include "rastergis/RSGISClumpChangeTracker.h"
 
 
 namespace rsgis{ namespace cmds {
@@ -246,8 +247,36 @@ namespace rsgis{ namespace cmds {
             throw RSGISCmdException(e.what());
         }
     }
+    
+    void executeSpatialLocationPxlBBox(std::string inputImage, unsigned int ratBand, std::string minXCol, std::string maxXCol, std::string minYCol, std::string maxYCol, std::string blocksCol)
+    {
+        try
+        {
+            GDALAllRegister();
+            
+            GDALDataset *inputDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_Update);
+            if(inputDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            rsgis::rastergis::RSGISCalcClusterLocation calcLoc;
+            calcLoc.populateAttWithClumpPxlLocation(inputDataset, ratBand, minXCol, maxXCol, minYCol, maxYCol, blocksCol);
+            
+            GDALClose(inputDataset);
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISCmdException(e.what());
+        }
+    }
 
-    void executePopulateRATWithStats(std::string inputImage, std::string clumpsImage, std::vector<rsgis::cmds::RSGISBandAttStatsCmds*> *bandStatsCmds, unsigned int ratBand)
+    void executePopulateRATWithStats(std::string inputImage, std::string clumpsImage, std::vector<rsgis::cmds::RSGISBandAttStatsCmds*> *bandStatsCmds, unsigned int ratBand, std::string changesCol)
     {
         try
         {
@@ -289,7 +318,25 @@ namespace rsgis{ namespace cmds {
             }
 
             rsgis::rastergis::RSGISPopRATWithStats clumpStats;
-            clumpStats.populateRATWithBasicStats(clumpsDataset, imageDataset, bandStats, ratBand);
+            if(changesCol == "")
+            {
+                clumpStats.populateRATWithBasicStats(clumpsDataset, imageDataset, bandStats, ratBand);
+            }
+            else
+            {
+                // Without stored changes all the clumps are calculated.
+                rsgis::rastergis::RSGISClumpChangeTracker changes(clumpsDataset, ratBand);
+                if(changes.readFromRAT(clumpsDataset, ratBand, changesCol))
+                {
+                    clumpStats.populateRATWithBasicStats(clumpsDataset, imageDataset, bandStats, ratBand, &changes);
+                }
+                else
+                {
+                    clumpStats.populateRATWithBasicStats(clumpsDataset, imageDataset, bandStats, ratBand);
+                }
+                changes.clear();
+                changes.writeToRAT(clumpsDataset, ratBand, changesCol);
+            }
 
             for(std::vector<rsgis::rastergis::RSGISBandAttStats*>::iterator iterBand = bandStats->begin(); iterBand != bandStats->end(); ++iterBand)
             {
@@ -589,7 +636,7 @@ namespace rsgis{ namespace cmds {
 
     }
 */
-    void executeApplyKNN(std::string inClumpsImage, unsigned int ratBand, std::string inExtrapField, std::string outExtrapField, std::string trainRegionsField, std::string applyRegionsField, bool useApplyField, std::vector<std::string> fields, unsigned int kFeatures, rsgisKNNDistCmd distKNNCmd, float distThreshold, rsgisKNNSummeriseCmd summeriseKNNCmd) 
+    void executeApplyKNN(std::string inClumpsImage, unsigned int ratBand, std::string inExtrapField, std::string outExtrapField, std::string trainRegionsField, std::string applyRegionsField, bool useApplyField, std::vector<std::string> fields, unsigned int kFeatures, rsgisKNNDistCmd distKNNCmd, float distThreshold, rsgisKNNSummeriseCmd summeriseKNNCmd, float minkowskiP) 
     {
         GDALAllRegister();
         GDALDataset *clumpsDataset;
@@ -661,7 +708,7 @@ namespace rsgis{ namespace cmds {
             
             std::cout << "Applying KNN\n";
             rsgis::rastergis::RSGISApplyRATKNN applyKNN;
-            applyKNN.applyKNNExtrapolation(clumpsDataset, inExtrapField, outExtrapField, trainRegionsField, applyRegionsField, useApplyField, fields, kFeatures, distKNN, distThreshold, summeriseKNN, ratBand);
+            applyKNN.applyKNNExtrapolation(clumpsDataset, inExtrapField, outExtrapField, trainRegionsField, applyRegionsField, useApplyField, fields, kFeatures, distKNN, distThreshold, summeriseKNN, ratBand, minkowskiP);
             std::cout << "Completed KNN\n";
             
             GDALClose(clumpsDataset);
@@ -1399,6 +1446,10 @@ namespace rsgis{ namespace cmds {
             {
                 interpolator = new rsgis::math::RSGISNaturalNeighbor2DInterpolator();
             }
+            else if(methodStr == "lineartin")
+            {
+                interpolator = new rsgis::math::RSGISLinearTIN2DInterpolator();
+            }
             else if(methodStr == "knearestneighbour")
             {
                 interpolator = new rsgis::math::RSGISKNearestNeighbour2DInterpolator(3);
@@ -1421,7 +1472,7 @@ namespace rsgis{ namespace cmds {
             }
             else
             {
-                std::cerr << "Available Interpolators: \'nearestneighbour\', \'naturalneighbour\', \'naturalnearestneighbour\', \'knearestneighbour\', \'idwall\'\n";
+                std::cerr << "Available Interpolators: \'nearestneighbour\', \'naturalneighbour\', \'naturalnearestneighbour\', \'lineartin\', \'knearestneighbour\', \'idwall\', \'plane\', \'naturalneighbourplane\', \'nnandnn\'\n";
                 throw rsgis::RSGISAttributeTableException("The interpolated specified was not recognised.");
             }
 
@@ -1606,7 +1657,7 @@ namespace rsgis{ namespace cmds {
         }
     }
       
-    void executeClassRegionGrowing(std::string clumpsImage, unsigned int ratBand, std::string classColumn, std::string classVal, int maxIter, std::string xmlBlock)
+    void executeClassRegionGrowing(std::string clumpsImage, unsigned int ratBand, std::string classColumn, std::string classVal, int maxIter, std::string xmlBlock, std::string changesCol)
     {
         try
         {
@@ -1620,8 +1671,24 @@ namespace rsgis{ namespace cmds {
                 throw rsgis::RSGISImageException(message.c_str());
             }
 
+            rsgis::rastergis::RSGISClumpChangeTracker *changes = NULL;
+            if(changesCol != "")
+            {
+                changes = new rsgis::rastergis::RSGISClumpChangeTracker(clumpsDataset, ratBand);
+                if(!changes->readFromRAT(clumpsDataset, ratBand, changesCol))
+                {
+                    changes->markAllClumps(clumpsDataset->GetRasterBand(ratBand)->GetDefaultRAT()->GetRowCount());
+                }
+            }
+
             rsgis::rastergis::RSGISClumpRegionGrowing growClumpRegions;
-            growClumpRegions.growClassRegion(clumpsDataset, classColumn, classVal, maxIter, ratBand, xmlBlock);
+            growClumpRegions.growClassRegion(clumpsDataset, classColumn, classVal, maxIter, ratBand, xmlBlock, changes);
+
+            if(changes != NULL)
+            {
+                changes->writeToRAT(clumpsDataset, ratBand, changesCol);
+                delete changes;
+            }
             
             GDALClose(clumpsDataset);
         }
@@ -2097,7 +2164,7 @@ namespace rsgis{ namespace cmds {
     }
     
     
-    void executeExportClumps2Images(std::string clumpsImage, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, unsigned int ratBand)
+    void executeExportClumps2Images(std::string clumpsImage, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, unsigned int ratBand, std::string minXCol, std::string maxXCol, std::string minYCol, std::string maxYCol, std::string blocksCol)
     {
         try
         {
@@ -2105,19 +2172,36 @@ namespace rsgis{ namespace cmds {
             std::cout.precision(12);
             
             std::cout << "Opening Clumps Image: " << clumpsImage << std::endl;
-            GDALDataset *clumpsDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_Update);
+            GDALDataset *clumpsDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_ReadOnly);
             if(clumpsDataset == NULL)
             {
                 std::string message = std::string("Could not open image ") + clumpsImage;
                 throw rsgis::RSGISImageException(message.c_str());
             }
             
-            rsgis::rastergis::RSGISCalcClusterLocation calcLoc;
-            calcLoc.populateAttWithClumpLocationExtent(clumpsDataset, ratBand, "MinXX", "MinXY", "MaxXX", "MaxXY", "MinYX", "MinYY", "MaxYX", "MaxYY");
-            calcLoc.populateAttWithClumpPxlLocation(clumpsDataset, ratBand, "MinXPxl", "MaxXPxl", "MinYPxl", "MaxYPxl");
+            // A stored index is used where the columns are given and valid. Otherwise it is
+            // built in memory, rather than added to the RAT, as the image is opened read-only.
+            rsgis::rastergis::RSGISClumpBBoxIndex bboxIdx;
+            bool idxRead = false;
+            if((minXCol != "") & (maxXCol != "") & (minYCol != "") & (maxYCol != ""))
+            {
+                try
+                {
+                    bboxIdx.readIndex(clumpsDataset, ratBand, minXCol, maxXCol, minYCol, maxYCol, blocksCol);
+                    idxRead = true;
+                }
+                catch(rsgis::RSGISAttributeTableException &e)
+                {
+                    std::cerr << "WARNING: The stored bounding box index could not be used (" << e.what() << ") so it will be rebuilt.\n";
+                }
+            }
+            if(!idxRead)
+            {
+                bboxIdx.buildIndex(clumpsDataset, ratBand, true);
+            }
             
             rsgis::rastergis::RSGISExportClumps2Images exportClumps;
-            exportClumps.exportClumps2Images(clumpsDataset, outImgBase, imgFileExt, imageFormat, binaryOut, "MinXPxl", "MaxXPxl", "MinYPxl", "MaxYPxl", "MinXX", "MaxYY", ratBand);
+            exportClumps.exportClumps2Images(clumpsDataset, outImgBase, imgFileExt, imageFormat, binaryOut, &bboxIdx, ratBand);
             
             GDALClose(clumpsDataset);
         }
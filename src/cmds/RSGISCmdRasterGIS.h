@@ -197,9 +197,12 @@ namespace rsgis{ namespace cmds {
     
     /** Function for adding the spatial extent for each clump as columns to the attribute table */
     DllExport void executeSpatialLocationExtent(std::string inputImage, unsigned int ratBand, std::string minXColX, std::string minXColY, std::string maxXColX, std::string maxXColY, std::string minYColX, std::string minYColY, std::string maxYColX, std::string maxYColY);
+    
+    /** Function for adding the pixel bounding box (and optionally the occupied image blocks) of each clump as columns to the attribute table */
+    DllExport void executeSpatialLocationPxlBBox(std::string inputImage, unsigned int ratBand, std::string minXCol, std::string maxXCol, std::string minYCol, std::string maxYCol, std::string blocksCol="");
 
-    /** Function for populating an attribute table from an image */
-    DllExport void executePopulateRATWithStats(std::string inputImage, std::string clumpsImage, std::vector<rsgis::cmds::RSGISBandAttStatsCmds*> *bandStatsCmds, unsigned int ratBand);
+    /** Function for populating an attribute table from an image (if changesCol is given only the clumps recorded as changed in that column are recalculated) */
+    DllExport void executePopulateRATWithStats(std::string inputImage, std::string clumpsImage, std::vector<rsgis::cmds::RSGISBandAttStatsCmds*> *bandStatsCmds, unsigned int ratBand, std::string changesCol="");
 
     /** Function for populating an attribute table with a percentile of the pixel values */
     DllExport void executePopulateRATWithPercentiles(std::string inputImage, std::string clumpsImage, unsigned int band, std::vector<rsgis::cmds::RSGISBandAttPercentilesCmds*> *bandPercentilesCmds, unsigned int ratBand, unsigned int numHistBins);
@@ -225,8 +228,8 @@ namespace rsgis{ namespace cmds {
     /** Function to calculate the features within a given spatial and spectral distance */
     //DllExport void executeFindSpecClose(std::string inputImage, std::string distanceField, std::string spatialDistField, std::string outputField, float specDistThreshold, float distThreshold);
 
-    /** Function to extrapolate values on segments using KNN, use mode for classification */
-    DllExport void executeApplyKNN(std::string inClumpsImage, unsigned int ratBand, std::string inExtrapField, std::string outExtrapField, std::string trainRegionsField, std::string applyRegionsField, bool useApplyField, std::vector<std::string> fields, unsigned int kFeatures, rsgisKNNDistCmd distKNNCmd, float distThreshold, rsgisKNNSummeriseCmd summeriseKNNCmd);
+    /** Function to extrapolate values on segments using KNN, use mode for classification. minkowskiP is the order (>= 1) of the Minkowski distance */
+    DllExport void executeApplyKNN(std::string inClumpsImage, unsigned int ratBand, std::string inExtrapField, std::string outExtrapField, std::string trainRegionsField, std::string applyRegionsField, bool useApplyField, std::vector<std::string> fields, unsigned int kFeatures, rsgisKNNDistCmd distKNNCmd, float distThreshold, rsgisKNNSummeriseCmd summeriseKNNCmd, float minkowskiP=3);
 
     /** Function to export columns from a GDAL RAT to ascii */
     DllExport void executeExport2Ascii(std::string inputImage, std::string outputFile, std::vector<std::string> fields, int ratBand=1);
@@ -297,8 +300,8 @@ namespace rsgis{ namespace cmds {
     /** Function to calculate relative difference statistic to neighbouring clumps. */
     DllExport void executeCalcRelDiffNeighbourStats(std::string clumpsImage, rsgis::cmds::RSGISFieldAttStatsCmds *fieldStatsCmds, bool useAbsDiff, unsigned int ratBand);
     
-    /** Function to undertaken region growing of a class */
-    DllExport void executeClassRegionGrowing(std::string clumpsImage, unsigned int ratBand, std::string classColumn, std::string classVal, int maxIter, std::string xmlBlock);
+    /** Function to undertaken region growing of a class (if changesCol is given the reclassified clumps are recorded in that column) */
+    DllExport void executeClassRegionGrowing(std::string clumpsImage, unsigned int ratBand, std::string classColumn, std::string classVal, int maxIter, std::string xmlBlock, std::string changesCol="");
     
     /** Function to evaluate regions to produce a binary classification */
     DllExport void executeBinaryClassify(std::string clumpsImage, unsigned int ratBand, std::string xmlBlock, std::string outColumn);
@@ -336,8 +339,8 @@ namespace rsgis{ namespace cmds {
     /** Function to calculate the Bhattacharyya distance between two classes. */
     DllExport float executeCalcBhattacharyyaDistance(std::string clumpsImage, std::string varCol, std::string classColumn, std::string class1Val, std::string class2Val, unsigned int ratBand=1);
     
-    /** Function to export each clump to an individual image file */
-    DllExport void executeExportClumps2Images(std::string clumpsImage, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, unsigned int ratBand=1);
+    /** Function to export each clump to an individual image file. If the bounding box columns (from executeSpatialLocationPxlBBox) are named and valid they are used, otherwise the index is built in memory */
+    DllExport void executeExportClumps2Images(std::string clumpsImage, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, unsigned int ratBand=1, std::string minXCol="", std::string maxXCol="", std::string minYCol="", std::string maxYCol="", std::string blocksCol="");
     
     
 }}
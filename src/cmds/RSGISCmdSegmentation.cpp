@@ -44,10 +44,12 @@
 #include "segmentation/RSGISCreateImageGrid.h"
 #include "segmentation/RSGISDropClumps.h"
 #include "segmentation/RSGISRegionGrowSegmentsPixels.h"
+#include "segmentation/RSGISTiledSegmentation.h"
 
 #include "rastergis/RSGISRasterAttUtils.h"
 #include "rastergis/RSGISCalcImageStatsAndPyramids.h"
 #include "rastergis/RSGISExportColumns2Image.h"
+#include "rastergis/RSGISClumpChangeTracker.h"
 
 
 namespace rsgis{ namespace cmds {
@@ -239,7 +241,7 @@ namespace rsgis{ namespace cmds {
         }
     }
     
-    void executeRMSmallClumpsStepwise(std::string inputImage, std::string clumpsImage, std::string outputImage, std::string imageFormat, bool stretchStatsAvail, std::string stretchStatsFile, bool storeMean, bool processInMemory, unsigned int minClumpSize, float specThreshold)
+    void executeRMSmallClumpsStepwise(std::string inputImage, std::string clumpsImage, std::string outputImage, std::string imageFormat, bool stretchStatsAvail, std::string stretchStatsFile, bool storeMean, bool processInMemory, unsigned int minClumpSize, float specThreshold, std::string changesCol)
     {
         try
         {
@@ -266,6 +268,24 @@ namespace rsgis{ namespace cmds {
                 bandStretchStats = rsgis::img::RSGISStretchImage::readBandSpecThresholds(stretchStatsFile);
             }
             
+            // The clumps changed since the RAT statistics were calculated are carried to the output.
+            rsgis::rastergis::RSGISPopulateWithImageStats popImageStats;
+            rsgis::rastergis::RSGISClumpChangeTracker *changes = NULL;
+            GDALRasterAttributeTable *inClumpsRAT = NULL;
+            if(changesCol != "")
+            {
+                inClumpsRAT = inClumpDataset->GetRasterBand(1)->GetDefaultRAT();
+                if(inClumpsRAT == NULL)
+                {
+                    throw rsgis::RSGISAttributeTableException("The clumps image does not have an attribute table.");
+                }
+                changes = new rsgis::rastergis::RSGISClumpChangeTracker(inClumpDataset, 1);
+                if(!changes->readFromRAT(inClumpDataset, 1, changesCol))
+                {
+                    changes->markAllClumps(inClumpsRAT->GetRowCount());
+                }
+            }
+            
             GDALDataset *spectralDataset = NULL;
             GDALDataset *clumpsDataset = NULL;
             GDALDataset *resultDataset = NULL;
@@ -293,11 +313,11 @@ namespace rsgis{ namespace cmds {
             if(storeMean)
             {
                 //eliminate.stepwiseEliminateSmallClumps(spectralDataset, resultDataset, minClumpSize, specThreshold, bandStretchStats, stretchStatsAvail);
-                eliminate.stepwiseIterativeEliminateSmallClumps(spectralDataset, resultDataset, minClumpSize, specThreshold, bandStretchStats, stretchStatsAvail);
+                eliminate.stepwiseIterativeEliminateSmallClumps(spectralDataset, resultDataset, minClumpSize, specThreshold, bandStretchStats, stretchStatsAvail, changes);
             }
             else
             {
-                eliminate.stepwiseEliminateSmallClumpsNoMean(spectralDataset, resultDataset, minClumpSize, specThreshold, bandStretchStats, stretchStatsAvail);
+                eliminate.stepwiseEliminateSmallClumpsNoMean(spectralDataset, resultDataset, minClumpSize, specThreshold, bandStretchStats, stretchStatsAvail, changes);
             }
             
             if(processInMemory)
@@ -305,10 +325,30 @@ namespace rsgis{ namespace cmds {
                 std::cout << "Copying output to disk\n";
                 GDALDataset *outDataset = imgUtils.createCopy(inClumpDataset, outputImage, imageFormat, GDT_UInt32, true, "");
                 imgUtils.copyUIntGDALDataset(resultDataset, outDataset);
+                if(changes != NULL)
+                {
+                    // The clumps keep their IDs so the statistics of those not changed are still valid.
+                    outDataset->GetRasterBand(1)->SetDefaultRAT(inClumpsRAT);
+                    outDataset->GetRasterBand(1)->SetMetadataItem("LAYER_TYPE", "thematic");
+                    popImageStats.populateImageWithRasterGISStats(outDataset, true, true, true, 1);
+                    changes->writeToRAT(outDataset, 1, changesCol);
+                }
                 GDALClose(outDataset);
                 GDALClose(spectralDataset);
                 GDALClose(clumpsDataset);
             }
+            else if(changes != NULL)
+            {
+                resultDataset->GetRasterBand(1)->SetDefaultRAT(inClumpsRAT);
+                resultDataset->GetRasterBand(1)->SetMetadataItem("LAYER_TYPE", "thematic");
+                popImageStats.populateImageWithRasterGISStats(resultDataset, true, true, true, 1);
+                changes->writeToRAT(resultDataset, 1, changesCol);
+            }
+            
+            if(changes != NULL)
+            {
+                delete changes;
+            }
             
             if(stretchStatsAvail)
             {
@@ -438,7 +478,7 @@ namespace rsgis{ namespace cmds {
             
             std::cout << "Calculating Mean Image\n";
             rsgis::segment::RSGISGenMeanSegImage genMeanImg;
-            genMeanImg.generateMeanImageUsingCalcImage(spectralDataset, clumpsDataset, resultDataset);
+            genMeanImg.generateMeanImage(spectralDataset, clumpsDataset, resultDataset);
             
             if(processInMemory)
             {
@@ -465,6 +505,42 @@ namespace rsgis{ namespace cmds {
         }
     }
 
+    void executePopulateRATMeans(std::string inputImage, std::string clumpsImage)
+    {
+        try
+        {
+            GDALAllRegister();
+            GDALDataset *inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(inDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            GDALDataset *clumpDataset = (GDALDataset *) GDALOpen(clumpsImage.c_str(), GA_Update);
+            if(clumpDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + clumpsImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            rsgis::segment::RSGISGenMeanSegImage genMeanImg;
+            genMeanImg.populateRATMeans(inDataset, clumpDataset);
+            
+            // Tidy up
+            GDALClose(inDataset);
+            GDALClose(clumpDataset);
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+    }
+
     void executeRandomColourClumps(std::string inputImage, std::string outputImage, std::string imageFormat, bool processInMemory, std::string importLUTFile, bool importLUT, std::string exportLUTFile, bool exportLUT)
     {
         try
@@ -663,6 +739,56 @@ namespace rsgis{ namespace cmds {
         }
     }
     
+    void executeTiledSegmentation(std::string inputImage, std::string clumpsImage, std::string clusterCentresFile, unsigned int minClumpSize, float specThreshold, std::string imageFormat, bool stretchStatsAvail, std::string stretchStatsFile, unsigned int tileXSize, unsigned int tileYSize, unsigned int tileOverlap, unsigned int numThreads)
+    {
+        try
+        {
+            GDALAllRegister();
+            GDALDataset *inDataset = (GDALDataset *) GDALOpen(inputImage.c_str(), GA_ReadOnly);
+            if(inDataset == NULL)
+            {
+                std::string message = std::string("Could not open image ") + inputImage;
+                throw rsgis::RSGISImageException(message.c_str());
+            }
+            
+            rsgis::math::RSGISMatrices matrixUtils;
+            rsgis::math::Matrix *clusterCentres = matrixUtils.readMatrixFromGridTxt(clusterCentresFile);
+            
+            std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats = NULL;
+            if(stretchStatsAvail)
+            {
+                bandStretchStats = rsgis::img::RSGISStretchImage::readBandSpecThresholds(stretchStatsFile);
+            }
+            
+            rsgis::img::RSGISImageUtils imgUtils;
+            GDALDataset *outDataset = imgUtils.createCopy(inDataset, 1, clumpsImage, imageFormat, GDT_UInt32, true, "");
+            
+            rsgis::segment::RSGISTiledSegmentation tiledSeg(tileXSize, tileYSize, tileOverlap, numThreads);
+            tiledSeg.performSegmentation(inDataset, outDataset, clusterCentres, minClumpSize, specThreshold, bandStretchStats, stretchStatsAvail);
+            
+            outDataset->GetRasterBand(1)->SetMetadataItem("LAYER_TYPE", "thematic");
+            rsgis::rastergis::RSGISPopulateWithImageStats popImageStats;
+            popImageStats.populateImageWithRasterGISStats(outDataset, true, true, true, 1);
+            
+            if(stretchStatsAvail)
+            {
+                delete bandStretchStats;
+            }
+            matrixUtils.freeMatrix(clusterCentres);
+            
+            GDALClose(inDataset);
+            GDALClose(outDataset);
+        }
+        catch (rsgis::RSGISException &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+        catch (std::exception &e)
+        {
+            throw rsgis::cmds::RSGISCmdException(e.what());
+        }
+    }
+    
     void executeExtractBrightFeatures(std::string inputImage, std::string maskImage, std::string outputImage, std::string temp1Image, std::string temp2Image, std::string outputFormat, float initThres, float thresIncrement, float thresholdUpper, std::vector<rsgis::cmds::FeatureShapeDescription*> shapeFeatDescript)
     {
         /*
@@ -869,7 +995,7 @@ namespace rsgis{ namespace cmds {
         }
     }
             
-    void executeMergeSelectClumps2Neighbour(std::string inputImage, std::string clumpsImage, std::string outputImage, std::string imageFormat, std::string selectClumpsCol, std::string noDataClumpsCol)
+    void executeMergeSelectClumps2Neighbour(std::string inputImage, std::string clumpsImage, std::string outputImage, std::string imageFormat, std::string selectClumpsCol, std::string noDataClumpsCol, std::string changesCol)
     {
         try
         {
@@ -888,13 +1014,24 @@ namespace rsgis{ namespace cmds {
                 throw rsgis::RSGISImageException(message.c_str());
             }
             
-            std::cout << "Merge Clumps\n";
-            rsgis::segment::RSGISMergeSegments mergeSegs;
-            mergeSegs.mergeSelectedClumps(clumpDataset, spectralDataset, selectClumpsCol, noDataClumpsCol);
-            
             rsgis::rastergis::RSGISRasterAttUtils attUtils;
             GDALRasterAttributeTable *gdalATT = clumpDataset->GetRasterBand(1)->GetDefaultRAT();
             
+            // Only the clumps changed since the statistics were calculated need updating.
+            rsgis::rastergis::RSGISClumpChangeTracker *changes = NULL;
+            if(changesCol != "")
+            {
+                changes = new rsgis::rastergis::RSGISClumpChangeTracker(clumpDataset, 1);
+                if(!changes->readFromRAT(clumpDataset, 1, changesCol))
+                {
+                    changes->markAllClumps(gdalATT->GetRowCount());
+                }
+            }
+            
+            std::cout << "Merge Clumps\n";
+            rsgis::segment::RSGISMergeSegments mergeSegs;
+            mergeSegs.mergeSelectedClumps(clumpDataset, spectralDataset, selectClumpsCol, noDataClumpsCol, changes);
+            
             // Get column intex in RAT
             unsigned int columnIndex = attUtils.findColumnIndex(gdalATT, "OutClumpIDs");
             
@@ -912,9 +1049,21 @@ namespace rsgis{ namespace cmds {
             }
             outputClumpsDS->GetRasterBand(1)->SetMetadataItem("LAYER_TYPE", "thematic");
             
+            if(changes != NULL)
+            {
+                // The clumps keep their IDs so the statistics of those not merged are still valid.
+                outputClumpsDS->GetRasterBand(1)->SetDefaultRAT(gdalATT);
+            }
+            
             rsgis::rastergis::RSGISPopulateWithImageStats popImageStats;
             popImageStats.populateImageWithRasterGISStats(outputClumpsDS, true, true, true, 1);
             
+            if(changes != NULL)
+            {
+                changes->writeToRAT(outputClumpsDS, 1, changesCol);
+                delete changes;
+            }
+            
             // Tidy up
             GDALClose(spectralDataset);
             GDALClose(clumpDataset);
@@ -71,8 +71,8 @@ namespace rsgis{ namespace cmds {
     /** Function to run the clump command */
     DllExport void executeClump(std::string inputImage, std::string outputImage, std::string imageFormat, bool processInMemory, bool noDataValProvided, float noDataVal, bool addRatPxlVals=true);
 
-    /** Function to run the iterative stepwise elimination command */
-    DllExport void executeRMSmallClumpsStepwise(std::string inputImage, std::string clumpsImage, std::string outputImage, std::string imageFormat, bool stretchStatsAvail, std::string stretchStatsFile, bool storeMean, bool processInMemory, unsigned int minClumpSize, float specThreshold);
+    /** Function to run the iterative stepwise elimination command (if changesCol is given the RAT is carried to the output with the eliminated and grown clumps recorded in that column) */
+    DllExport void executeRMSmallClumpsStepwise(std::string inputImage, std::string clumpsImage, std::string outputImage, std::string imageFormat, bool stretchStatsAvail, std::string stretchStatsFile, bool storeMean, bool processInMemory, unsigned int minClumpSize, float specThreshold, std::string changesCol="");
     
     /** Function to run the relabel clumps command */
     DllExport void executeRelabelClumps(std::string inputImage, std::string outputImage, std::string imageFormat, bool processInMemory);
@@ -80,6 +80,9 @@ namespace rsgis{ namespace cmds {
     /** Function to run generate mean image command */
     DllExport void executeMeanImage(std::string inputImage, std::string clumpsImage, std::string outputImage, std::string imageFormat, RSGISLibDataType outDataType, bool processInMemory);
     
+    /** Function to populate the clumps attribute table with the clump means (b1Mean, b2Mean, ...) */
+    DllExport void executePopulateRATMeans(std::string inputImage, std::string clumpsImage);
+    
     /** Function to run assign random colours to clumps commands */
     DllExport void executeRandomColourClumps(std::string inputImage, std::string outputImage, std::string imageFormat, bool processInMemory, std::string importLUTFile, bool importLUT, std::string exportLUTFile, bool exportLUT);
     
@@ -95,6 +98,9 @@ namespace rsgis{ namespace cmds {
     /** Function to run command to merge clump image */
     DllExport void executeMergeClumpImages(std::vector<std::string> inputImagePaths, std::string outputImage, bool mergeRATs);
     
+    /** Function to run the Shepherd segmentation over an image in tiles on a pool of threads, producing a single clumps image */
+    DllExport void executeTiledSegmentation(std::string inputImage, std::string clumpsImage, std::string clusterCentresFile, unsigned int minClumpSize, float specThreshold, std::string imageFormat="KEA", bool stretchStatsAvail=false, std::string stretchStatsFile="", unsigned int tileXSize=2000, unsigned int tileYSize=2000, unsigned int tileOverlap=100, unsigned int numThreads=0);
+    
     /** Function to run command to merge clump image */
     DllExport void executeExtractBrightFeatures(std::string inputImage, std::string maskImage, std::string outputImage, std::string temp1Image, std::string temp2Image, std::string outputFormat, float initThres, float thresIncrement, float thresholdUpper, std::vector<rsgis::cmds::FeatureShapeDescription*> shapeFeatDescript);
     
@@ -107,8 +113,8 @@ namespace rsgis{ namespace cmds {
     /** Function to include a clumped masked region into an existing segmebtation */
     DllExport void executeIncludeClumpedRegion(std::string inputClumps, std::string inputRegion, std::string outputClumpImage, std::string imageFormat);
     
-    /** Function to merge selected clumps to neighbour with closest values from input image */
-    DllExport void executeMergeSelectClumps2Neighbour(std::string inputImage, std::string clumpsImage, std::string outputImage, std::string imageFormat, std::string selectClumpsCol, std::string noDataClumpsCol);
+    /** Function to merge selected clumps to neighbour with closest values from input image (if changesCol is given only the changed clumps have their statistics recalculated and the RAT is carried to the output with the merged clumps recorded in that column) */
+    DllExport void executeMergeSelectClumps2Neighbour(std::string inputImage, std::string clumpsImage, std::string outputImage, std::string imageFormat, std::string selectClumpsCol, std::string noDataClumpsCol, std::string changesCol="");
     
     /** Function to drop selected clumps from the segmentation */
     DllExport void executeDropSelectedClumps(std::string clumpsImage, std::string outputImage, std::string imageFormat, std::string selectClumpsCol);
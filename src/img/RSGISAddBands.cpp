@@ -427,106 +427,36 @@ namespace rsgis{namespace img{
                 yBlockSize = outYBlockSize;
             }
             
-			// Allocate memory
-			inputData = new float*[numInBands];
-			for(int i = 0; i < numInBands; i++)
-			{
-				inputData[i] = (float *) CPLMalloc(sizeof(float)*(width*yBlockSize));
-			}
-            
-            int nYBlocks = height / yBlockSize;
-            int remainRows = height - (nYBlocks * yBlockSize);
-            int rowOffset = 0;
-            
-			rsgis_tqdm pbar;
-			// Loop images to process data
-			for(int i = 0; i < nYBlocks; i++)
-			{
-				for(int n = 0; n < numInBands; n++)
-				{
-                    rowOffset = bandOffsets[n][1] + (yBlockSize * i);
-					inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0], rowOffset, width, yBlockSize, inputData[n], width, yBlockSize, GDT_Float32, 0, 0);
-				}
-                
-                for(int m = 0; m < yBlockSize; ++m)
+            if(skipPixels)
+            {
+                this->stackImageBlocks(inputRasterBands, bandOffsets, outputRasterBands, numInBands, width, height, yBlockSize, skipPixels, skipValue, noDataValue);
+            }
+            else
+            {
+                // Nothing to check per pixel so the bands can be copied block by block.
+                std::vector<RSGISBlockCopyBand> inBands;
+                for(int i = 0; i < numDS; i++)
                 {
-                    pbar.progress((i*yBlockSize)+m, height);
-                    
-                    if(skipPixels) // If skipping pixels, look through input values and check for skip value in any of the bands.
+                    for(int j = 0; j < datasets[i]->GetRasterCount(); j++)
                     {
-                        for(int j = 0; j < width; j++)
-                        {
-                            bool dataPixel = true;
-                            
-                            int n = 0;
-                            while((n < numInBands) && dataPixel)
-                            {
-                                if(inputData[n][(m*width)+j] == skipValue)
-                                {
-                                    for(int n = 0; n < numInBands; n++)
-                                    {
-                                        inputData[n][(m*width)+j] = noDataValue;
-                                    }
-                                    
-                                    dataPixel = false;
-                                }
-                                ++n;
-                            }
-                        }
+                        RSGISBlockCopyBand inBand;
+                        inBand.dataset = datasets[i];
+                        inBand.band = j+1;
+                        inBand.xOff = dsOffsets[i][0];
+                        inBand.yOff = dsOffsets[i][1];
+                        inBands.push_back(inBand);
                     }
-                    
                 }
-				
-				for(int n = 0; n < numInBands; n++)
-				{
-                    rowOffset = yBlockSize * i;
-					outputRasterBands[n]->RasterIO(GF_Write, 0, rowOffset, width, yBlockSize, inputData[n], width, yBlockSize, GDT_Float32, 0, 0);
-				}
-			}
-            
-            if(remainRows > 0)
-            {
-                for(int n = 0; n < numInBands; n++)
-				{
-                    rowOffset = bandOffsets[n][1] + (yBlockSize * nYBlocks);
-					inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0], rowOffset, width, remainRows, inputData[n], width, remainRows, GDT_Float32, 0, 0);
-				}
-                
-                for(int m = 0; m < remainRows; ++m)
+                try
                 {
-                    pbar.progress((nYBlocks*yBlockSize)+m, height);
-                    
-                    if(skipPixels) // If skipping pixels, look through input values and check for skip value in any of the bands.
-                    {
-                        for(int j = 0; j < width; j++)
-                        {
-                            bool dataPixel = true;
-                            
-                            int n = 0;
-                            while((n < numInBands) && dataPixel)
-                            {
-                                if(inputData[n][(m*width)+j] == skipValue)
-                                {
-                                    for(int n = 0; n < numInBands; n++)
-                                    {
-                                        inputData[n][(m*width)+j] = noDataValue;
-                                    }
-                                    
-                                    dataPixel = false;
-                                }
-                                ++n;
-                            }
-                        }
-                    }
+                    RSGISImageBlockCopy blockCopy(0, false);
+                    blockCopy.copyBands(inBands, outputImageDS, GDT_Float32);
+                }
+                catch(rsgis::RSGISImageException &e)
+                {
+                    throw RSGISImageBandException(e.what());
                 }
-				
-				for(int n = 0; n < numInBands; n++)
-				{
-                    rowOffset = (yBlockSize * nYBlocks);
-					outputRasterBands[n]->RasterIO(GF_Write, 0, rowOffset, width, remainRows, inputData[n], width, remainRows, GDT_Float32, 0, 0);
-				}
             }
-			pbar.finish();
 		}
 		catch(RSGISImageBandException& e)
 		{			
@@ -648,6 +578,132 @@ namespace rsgis{namespace img{
     }
     
     
+    void RSGISAddBands::stackImageBlocks(GDALRasterBand **inputRasterBands, int **bandOffsets, GDALRasterBand **outputRasterBands, int numInBands, int width, int height, int yBlockSize, bool skipPixels, float skipValue, float noDataValue)
+    {
+        float **inputData = NULL;
+        try
+		{
+			// Allocate memory
+			inputData = new float*[numInBands];
+			for(int i = 0; i < numInBands; i++)
+			{
+				inputData[i] = (float *) CPLMalloc(sizeof(float)*(width*yBlockSize));
+			}
+            
+            int nYBlocks = height / yBlockSize;
+            int remainRows = height - (nYBlocks * yBlockSize);
+            int rowOffset = 0;
+            
+			rsgis_tqdm pbar;
+			// Loop images to process data
+			for(int i = 0; i < nYBlocks; i++)
+			{
+				for(int n = 0; n < numInBands; n++)
+				{
+                    rowOffset = bandOffsets[n][1] + (yBlockSize * i);
+					inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0], rowOffset, width, yBlockSize, inputData[n], width, yBlockSize, GDT_Float32, 0, 0);
+				}
+                
+                for(int m = 0; m < yBlockSize; ++m)
+                {
+                    pbar.progress((i*yBlockSize)+m, height);
+                    
+                    if(skipPixels) // If skipping pixels, look through input values and check for skip value in any of the bands.
+                    {
+                        for(int j = 0; j < width; j++)
+                        {
+                            bool dataPixel = true;
+                            
+                            int n = 0;
+                            while((n < numInBands) && dataPixel)
+                            {
+                                if(inputData[n][(m*width)+j] == skipValue)
+                                {
+                                    for(int n = 0; n < numInBands; n++)
+                                    {
+                                        inputData[n][(m*width)+j] = noDataValue;
+                                    }
+                                    
+                                    dataPixel = false;
+                                }
+                                ++n;
+                            }
+                        }
+                    }
+                    
+                }
+				
+				for(int n = 0; n < numInBands; n++)
+				{
+                    rowOffset = yBlockSize * i;
+					outputRasterBands[n]->RasterIO(GF_Write, 0, rowOffset, width, yBlockSize, inputData[n], width, yBlockSize, GDT_Float32, 0, 0);
+				}
+			}
+            
+            if(remainRows > 0)
+            {
+                for(int n = 0; n < numInBands; n++)
+				{
+                    rowOffset = bandOffsets[n][1] + (yBlockSize * nYBlocks);
+					inputRasterBands[n]->RasterIO(GF_Read, bandOffsets[n][0], rowOffset, width, remainRows, inputData[n], width, remainRows, GDT_Float32, 0, 0);
+				}
+                
+                for(int m = 0; m < remainRows; ++m)
+                {
+                    pbar.progress((nYBlocks*yBlockSize)+m, height);
+                    
+                    if(skipPixels) // If skipping pixels, look through input values and check for skip value in any of the bands.
+                    {
+                        for(int j = 0; j < width; j++)
+                        {
+                            bool dataPixel = true;
+                            
+                            int n = 0;
+                            while((n < numInBands) && dataPixel)
+                            {
+                                if(inputData[n][(m*width)+j] == skipValue)
+                                {
+                                    for(int n = 0; n < numInBands; n++)
+                                    {
+                                        inputData[n][(m*width)+j] = noDataValue;
+                                    }
+                                    
+                                    dataPixel = false;
+                                }
+                                ++n;
+                            }
+                        }
+                    }
+                }
+				
+				for(int n = 0; n < numInBands; n++)
+				{
+                    rowOffset = (yBlockSize * nYBlocks);
+					outputRasterBands[n]->RasterIO(GF_Write, 0, rowOffset, width, remainRows, inputData[n], width, remainRows, GDT_Float32, 0, 0);
+				}
+            }
+			pbar.finish();
+		}
+		catch(RSGISImageBandException& e)
+		{
+			if(inputData != NULL)
+			{
+				for(int i = 0; i < numInBands; i++)
+				{
+					CPLFree(inputData[i]);
+				}
+				delete[] inputData;
+			}
+			throw e;
+		}
+		
+		for(int i = 0; i < numInBands; i++)
+		{
+			CPLFree(inputData[i]);
+		}
+		delete[] inputData;
+    }
+    
     RSGISAddBands::~RSGISAddBands()
     {
         
@@ -65,6 +65,8 @@ namespace rsgis
 				void addBandToFile(GDALDataset *input, GDALDataset *toAdd, std::string *outputFile, int band);
 				void stackImages(GDALDataset **datasets, int numDS, std::string outputImage, std::string *imageBandNames, bool skipPixels, float skipValue = 0, float noDataValue = 0, std::string gdalFormat="ENVI", GDALDataType gdalDataType=GDT_Float32, bool replaceBandNames=false);
 				~RSGISAddBands();
+			protected:
+				void stackImageBlocks(GDALRasterBand **inputRasterBands, int **bandOffsets, GDALRasterBand **outputRasterBands, int numInBands, int width, int height, int yBlockSize, bool skipPixels, float skipValue, float noDataValue);
 		};
         
         
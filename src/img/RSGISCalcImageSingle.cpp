@@ -842,7 +842,7 @@ namespace rsgis{namespace img{
 	
 	void RSGISCalcImageSingle::calcImageWithinRasterPolygon(GDALDataset **datasets, int numDS, double *outputValue, geos::geom::Envelope *env, long fid, bool output)
 	{
-		GDALAllRegister();
+		// The datasets are already open so the drivers are registered (and this is called per feature, possibly on several threads).
 		RSGISImageUtils imgUtils;
 		double *gdalTranslation = NULL;
 		
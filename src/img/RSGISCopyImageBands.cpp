@@ -31,66 +31,43 @@ namespace rsgis{namespace img{
 	
 	GDALDataset* RSGISCopyImageBands::outputImageBands(GDALDataset *inputDS, std::string outputFile, int *outBands, int numOutBands, std::string outputProj, bool useInProj)
 	{
-		RSGISIdentifyImageValues *copyImageValues = NULL;
-		RSGISCalcImage *calcImage = NULL;
-		GDALDataset **datasets = NULL;
+		GDALDataset *outDS = NULL;
 		
 		try
 		{
 			std::cout << "Copying Image Data ";
-			datasets = new GDALDataset*[1];
-			datasets[0] = inputDS;
-			
-			copyImageValues = new RSGISIdentifyImageValues(numOutBands, outBands);
-			calcImage = new RSGISCalcImage(copyImageValues, outputProj, useInProj);
-			calcImage->calcImage(datasets, 1, outputFile);
-		}
-		catch(RSGISImageCalcException &e)
-		{
-			if(copyImageValues != NULL)
+			std::vector<RSGISBlockCopyBand> inBands;
+			for(int i = 0; i < numOutBands; i++)
 			{
-				delete copyImageValues;
+				if((outBands[i] < 0) | (outBands[i] >= inputDS->GetRasterCount()))
+				{
+					throw RSGISImageException("Insufficient number of input bands provided.");
+				}
+				RSGISBlockCopyBand inBand;
+				inBand.dataset = inputDS;
+				inBand.band = outBands[i]+1;
+				inBand.xOff = 0;
+				inBand.yOff = 0;
+				inBands.push_back(inBand);
 			}
-			if(calcImage != NULL)
-			{
-				delete calcImage;
-			}
-			if(datasets != NULL)
-			{
-				delete[] datasets;
-			}
-			throw e;
+			
+			RSGISImageUtils imgUtils;
+			outDS = imgUtils.createCopy(inputDS, numOutBands, outputFile, "KEA", GDT_Float32, useInProj, outputProj);
+			
+			RSGISImageBlockCopy blockCopy(0, false);
+			blockCopy.copyBands(inBands, outDS, GDT_Float32);
+			
+			GDALClose(outDS);
 		}
-		catch(RSGISImageBandException &e)
+		catch(RSGISImageException &e)
 		{
-			if(copyImageValues != NULL)
+			if(outDS != NULL)
 			{
-				delete copyImageValues;
-			}
-			if(calcImage != NULL)
-			{
-				delete calcImage;
-			}
-			if(datasets != NULL)
-			{
-				delete[] datasets;
+				GDALClose(outDS);
 			}
 			throw e;
 		}
 		
-		if(copyImageValues != NULL)
-		{
-			delete copyImageValues;
-		}
-		if(calcImage != NULL)
-		{
-			delete calcImage;
-		}
-		if(datasets != NULL)
-		{
-			delete[] datasets;
-		}
-		
 		GDALDataset *ds = (GDALDataset *) GDALOpen(outputFile.c_str(), GA_ReadOnly);
 		if(ds == NULL)
 		{
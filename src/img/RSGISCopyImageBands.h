@@ -31,6 +31,8 @@
 #include "img/RSGISImageBandException.h"
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImage.h"
+#include "img/RSGISImageUtils.h"
+#include "img/RSGISImageBlockCopy.h"
 
 #include "common/RSGISImageException.h"
 
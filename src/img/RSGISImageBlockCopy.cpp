@@ -0,0 +1,161 @@
+/*
+ *  RSGISImageBlockCopy.cpp
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISImageBlockCopy.h"
+
+namespace rsgis{namespace img{
+
+    RSGISImageBlockCopy::RSGISImageBlockCopy(unsigned int numThreads, bool quiet)
+    {
+        this->numThreads = numThreads;
+        this->quiet = quiet;
+    }
+
+    void RSGISImageBlockCopy::copyDataset(GDALDataset *inDS, GDALDataset *outDS, GDALDataType convType)
+    {
+        std::vector<RSGISBlockCopyBand> inBands;
+        for(int n = 1; n <= inDS->GetRasterCount(); ++n)
+        {
+            RSGISBlockCopyBand inBand;
+            inBand.dataset = inDS;
+            inBand.band = n;
+            inBand.xOff = 0;
+            inBand.yOff = 0;
+            inBands.push_back(inBand);
+        }
+        this->copyBands(inBands, outDS, convType);
+    }
+
+    void RSGISImageBlockCopy::copyBands(const std::vector<RSGISBlockCopyBand> &inBands, GDALDataset *outDS, GDALDataType convType)
+    {
+        unsigned int numBands = inBands.size();
+        if(numBands != ((unsigned int)outDS->GetRasterCount()))
+        {
+            throw RSGISImageException("Number of bands are not the same");
+        }
+        if(numBands == 0)
+        {
+            return;
+        }
+        int width = outDS->GetRasterXSize();
+        int height = outDS->GetRasterYSize();
+
+        std::vector<GDALDataType> transferTypes(numBands);
+        size_t maxTypeSize = 1;
+        for(unsigned int n = 0; n < numBands; ++n)
+        {
+            const RSGISBlockCopyBand &inBand = inBands[n];
+            if((inBand.band < 1) | (inBand.band > ((unsigned int)inBand.dataset->GetRasterCount())))
+            {
+                throw RSGISImageException("An input band is not within the image it refers to.");
+            }
+            if((inBand.xOff < 0) | (inBand.yOff < 0) | ((inBand.xOff + width) > inBand.dataset->GetRasterXSize()) | ((inBand.yOff + height) > inBand.dataset->GetRasterYSize()))
+            {
+                throw RSGISImageException("The output image is not within the extent of an input image.");
+            }
+            GDALDataType inType = inBand.dataset->GetRasterBand(inBand.band)->GetRasterDataType();
+            GDALDataType outType = outDS->GetRasterBand(n+1)->GetRasterDataType();
+            if(inType == outType)
+            {
+                transferTypes[n] = inType;
+            }
+            else
+            {
+                transferTypes[n] = (convType == GDT_Unknown)?outType:convType;
+            }
+            maxTypeSize = std::max<size_t>(maxTypeSize, GDALGetDataTypeSizeBytes(transferTypes[n]));
+        }
+
+        // Work in whole block rows of the output, growing very thin (e.g., scanline) blocks to about 4 MB.
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        outDS->GetRasterBand(1)->GetBlockSize(&xBlockSize, &yBlockSize);
+        if(yBlockSize < 1)
+        {
+            yBlockSize = 1;
+        }
+        int stripRows = yBlockSize;
+        while(((((size_t)stripRows) * width * maxTypeSize) < 4194304) && (stripRows < height))
+        {
+            stripRows += yBlockSize;
+        }
+        size_t numStrips = (height + stripRows - 1) / stripRows;
+
+        RSGISImageThreadUtils threadUtils;
+        unsigned int nThreads = threadUtils.getNumThreads(this->numThreads);
+        std::map<GDALDataset*, std::vector<GDALDataset*> > handles;
+        for(unsigned int n = 0; n < numBands; ++n)
+        {
+            if(handles.count(inBands[n].dataset) == 0)
+            {
+                handles[inBands[n].dataset] = threadUtils.openDatasetHandles(inBands[n].dataset, nThreads);
+                nThreads = std::min<unsigned int>(nThreads, handles[inBands[n].dataset].size());
+            }
+        }
+        std::vector<std::vector<GDALDataset*>*> bandHandles(numBands);
+        for(unsigned int n = 0; n < numBands; ++n)
+        {
+            bandHandles[n] = &handles[inBands[n].dataset];
+        }
+
+        // Tasks run along each block row across the bands so pixel interleaved outputs are filled in order.
+        std::mutex writeMutex;
+        try
+        {
+            threadUtils.runTasks(nThreads, numStrips * numBands, [&](unsigned int threadIdx, size_t task)
+            {
+                size_t strip = task / numBands;
+                unsigned int n = task % numBands;
+                const RSGISBlockCopyBand &inBand = inBands[n];
+                int startRow = strip * stripRows;
+                int numStripRows = std::min(stripRows, height - startRow);
+
+                std::vector<unsigned char> data(((size_t)width) * numStripRows * GDALGetDataTypeSizeBytes(transferTypes[n]));
+                GDALDataset *inDS = bandHandles[n]->at(threadIdx);
+                if(inDS->GetRasterBand(inBand.band)->RasterIO(GF_Read, inBand.xOff, inBand.yOff + startRow, width, numStripRows, data.data(), width, numStripRows, transferTypes[n], 0, 0) != CE_None)
+                {
+                    throw RSGISImageException("Failed to read from the input image.");
+                }
+
+                std::lock_guard<std::mutex> lock(writeMutex);
+                if(outDS->GetRasterBand(n+1)->RasterIO(GF_Write, 0, startRow, width, numStripRows, data.data(), width, numStripRows, transferTypes[n], 0, 0) != CE_None)
+                {
+                    throw RSGISImageException("Failed to write to the output image.");
+                }
+            }, this->quiet);
+        }
+        catch(RSGISImageException &e)
+        {
+            for(std::map<GDALDataset*, std::vector<GDALDataset*> >::iterator iterHandles = handles.begin(); iterHandles != handles.end(); ++iterHandles)
+            {
+                threadUtils.closeDatasetHandles(&iterHandles->second);
+            }
+            throw e;
+        }
+
+        for(std::map<GDALDataset*, std::vector<GDALDataset*> >::iterator iterHandles = handles.begin(); iterHandles != handles.end(); ++iterHandles)
+        {
+            threadUtils.closeDatasetHandles(&iterHandles->second);
+        }
+    }
+
+}}
@@ -0,0 +1,88 @@
+/*
+ *  RSGISImageBlockCopy.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISImageBlockCopy_H
+#define RSGISImageBlockCopy_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <algorithm>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISImageException.h"
+
+#include "img/RSGISImageThreadUtils.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+
+    /**
+     * An input band for RSGISImageBlockCopy; band numbers start at 1 and the
+     * offsets give the pixel in the input which maps to the output origin.
+     */
+    struct DllExport RSGISBlockCopyBand
+    {
+        GDALDataset *dataset;
+        unsigned int band;
+        int xOff;
+        int yOff;
+    };
+
+    /**
+     * Copies image bands into an existing dataset one block row of the output
+     * at a time, so every output block is written whole. Reads are made in
+     * parallel, each thread with its own handle onto each input, while writes
+     * are serialised. Where the input and output bands have the same type the
+     * data is moved without conversion, otherwise it is passed through
+     * convType (the output band type if GDT_Unknown).
+     */
+    class DllExport RSGISImageBlockCopy
+    {
+    public:
+        RSGISImageBlockCopy(unsigned int numThreads=0, bool quiet=true);
+        void copyDataset(GDALDataset *inDS, GDALDataset *outDS, GDALDataType convType=GDT_Unknown);
+        void copyBands(const std::vector<RSGISBlockCopyBand> &inBands, GDALDataset *outDS, GDALDataType convType=GDT_Unknown);
+        ~RSGISImageBlockCopy(){};
+    protected:
+        unsigned int numThreads;
+        bool quiet;
+    };
+
+}}
+
+#endif
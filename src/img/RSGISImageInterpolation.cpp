@@ -762,9 +762,9 @@ namespace rsgis{namespace img{
     
     
     
-    RSGISPopulateImageFromInterpolator::RSGISPopulateImageFromInterpolator()
+    RSGISPopulateImageFromInterpolator::RSGISPopulateImageFromInterpolator(unsigned int numThreads)
     {
-        
+        this->numThreads = numThreads;
     }
     
     void RSGISPopulateImageFromInterpolator::populateImage(rsgis::math::RSGIS2DInterpolator *interpolator, GDALDataset *image)
@@ -773,85 +773,57 @@ namespace rsgis{namespace img{
         {
             int xBlockSize = 0;
             int yBlockSize = 0;
-            int height = 0;
-            int width = 0;
-            float *imgData = NULL;
             GDALRasterBand *outputRasterBand = image->GetRasterBand(1);
-            double *gdalTransform = new double[6];
+            double gdalTransform[6];
             image->GetGeoTransform(gdalTransform);
-            width = image->GetRasterXSize();
-            height = image->GetRasterYSize();
-            
-            outputRasterBand->GetBlockSize(&xBlockSize, &yBlockSize);
-            
-            int bufferSize = yBlockSize * width;
-            imgData = (float *) CPLMalloc(sizeof(float)*(bufferSize));
-            
-            int nYBlocks = floor(((double)height) / ((double)yBlockSize));
-            int remainRows = height - (nYBlocks * yBlockSize);
-            int rowOffset = 0;
+            unsigned int width = image->GetRasterXSize();
+            unsigned int height = image->GetRasterYSize();
             
             double tlX = gdalTransform[0];
             double tlY = gdalTransform[3];
             double xRes = gdalTransform[1];
             double yRes = gdalTransform[5];
             
-            double cX = 0.0;
-            double cY = 0.0;
-            
+            // Each pixel is costly to interpolate so the strips are kept small enough
+            // to spread the rows evenly over the threads.
+            outputRasterBand->GetBlockSize(&xBlockSize, &yBlockSize);
+            unsigned int stripRows = std::max(yBlockSize, 1);
+            unsigned int yStep = stripRows;
+            while(((((size_t)stripRows) * width) < 262144) && (stripRows < height))
+            {
+                stripRows += yStep;
+            }
+            size_t numStrips = (height + stripRows - 1) / stripRows;
             
-			int feedback = height/10.0;
-			int feedbackCounter = 0;
-			std::cout << "Started" << std::flush;
-            cY = tlY;
-            for(int i = 0; i < nYBlocks; ++i)
-			{
-                for(int m = 0; m < yBlockSize; ++m)
+            RSGISImageThreadUtils threadUtils;
+            std::mutex writeMutex;
+            size_t numStripsDone = 0;
+            unsigned int feedbackCounter = 0;
+            std::cout << "Started" << std::flush;
+            threadUtils.runTasks(threadUtils.getNumThreads(this->numThreads), numStrips, [&](unsigned int threadIdx, size_t strip)
+            {
+                unsigned int startRow = strip * stripRows;
+                unsigned int numRows = std::min(stripRows, height - startRow);
+                
+                std::vector<float> imgData(((size_t)width) * numRows);
+                for(unsigned int m = 0; m < numRows; ++m)
                 {
-                    if((feedback != 0) && (((i*yBlockSize)+m) % feedback) == 0)
-                    {
-                        std::cout << "." << feedbackCounter << "." << std::flush;
-                        feedbackCounter = feedbackCounter + 10;
-                    }
-                    cX = tlX;
-                    for(int j = 0; j < width; ++j)
-                    {
-                        imgData[(m*width)+j] = interpolator->getValue(cX, cY);
-                        cX += xRes;
-                    }
-                    cY += yRes;
+                    interpolator->getValues(tlX, tlY + ((startRow + m) * yRes), xRes, width, &imgData[((size_t)m) * width]);
                 }
-				
-				rowOffset = yBlockSize * i;
-                outputRasterBand->RasterIO(GF_Write, 0, rowOffset, width, yBlockSize, imgData, width, yBlockSize, GDT_Float32, 0, 0);
-			}
-            
-            if(remainRows > 0)
-            {
-                for(int m = 0; m < remainRows; ++m)
+                
+                std::lock_guard<std::mutex> lock(writeMutex);
+                if(outputRasterBand->RasterIO(GF_Write, 0, startRow, width, numRows, imgData.data(), width, numRows, GDT_Float32, 0, 0) != CE_None)
                 {
-                    if((feedback != 0) && ((((nYBlocks*yBlockSize)+m) % feedback) == 0))
-                    {
-                        std::cout << "." << feedbackCounter << "." << std::flush;
-                        feedbackCounter = feedbackCounter + 10;
-                    }
-                    cX = tlX;
-                    for(int j = 0; j < width; ++j)
-                    {
-                        imgData[(m*width)+j] = interpolator->getValue(cX, cY);
-                        cX += xRes;
-                    }
-                    cY += yRes;
+                    throw rsgis::RSGISImageException("Failed to write the interpolated image.");
                 }
-				
-				rowOffset = (yBlockSize * nYBlocks);
-                outputRasterBand->RasterIO(GF_Write, 0, rowOffset, width, remainRows, imgData, width, remainRows, GDT_Float32, 0, 0);
-            }
-			std::cout << " Complete.\n";
-                        
-            delete[] gdalTransform;
-            delete[] imgData;
-            
+                ++numStripsDone;
+                while((feedbackCounter <= 100) && ((numStripsDone * 100) >= (((size_t)feedbackCounter) * numStrips)))
+                {
+                    std::cout << "." << feedbackCounter << "." << std::flush;
+                    feedbackCounter = feedbackCounter + 10;
+                }
+            }, true);
+            std::cout << " Complete.\n";
         }
         catch(rsgis::math::RSGISInterpolationException &e)
         {
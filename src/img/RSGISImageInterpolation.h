@@ -25,6 +25,9 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <mutex>
+#include <algorithm>
 
 #include "gdal_priv.h"
 
@@ -33,6 +36,7 @@
 #include "common/RSGISImageException.h"
 
 #include "img/RSGISImageInterpolator.h"
+#include "img/RSGISImageThreadUtils.h"
 
 #include "math/RSGIS2DInterpolation.h"
 
@@ -77,9 +81,12 @@ namespace rsgis{namespace img{
     class DllExport RSGISPopulateImageFromInterpolator
     {
     public:
-        RSGISPopulateImageFromInterpolator();
+        RSGISPopulateImageFromInterpolator(unsigned int numThreads=0);
+        /** Rows are interpolated on several threads so the interpolator must be initialised first. */
         void populateImage(rsgis::math::RSGIS2DInterpolator *interpolator, GDALDataset *image);
         ~RSGISPopulateImageFromInterpolator();
+    protected:
+        unsigned int numThreads;
     };
     
 }}
@@ -0,0 +1,583 @@
+/*
+ *  RSGISImagePCA.cpp
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISImagePCA.h"
+
+namespace rsgis{namespace img{
+
+    void RSGISCovarianceAccumulator::addBlock(double *pxlVals, size_t numPxls, size_t rowStride)
+    {
+        if(numPxls == 0)
+        {
+            return;
+        }
+
+        // Centre the block on its own mean so the rank-k update is well conditioned.
+        std::vector<double> delta(this->numBands);
+        for(unsigned int b = 0; b < this->numBands; ++b)
+        {
+            double *row = pxlVals + (((size_t)b) * rowStride);
+            double sum = 0.0;
+            for(size_t p = 0; p < numPxls; ++p)
+            {
+                sum += row[p];
+            }
+            double blockMean = sum / numPxls;
+            for(size_t p = 0; p < numPxls; ++p)
+            {
+                row[p] -= blockMean;
+            }
+            delta[b] = blockMean - this->mean[b];
+        }
+
+        gsl_matrix_view pxlsView = gsl_matrix_view_array_with_tda(pxlVals, this->numBands, numPxls, rowStride);
+        gsl_matrix_view coMomentView = gsl_matrix_view_array(this->coMoment.data(), this->numBands, this->numBands);
+        gsl_blas_dsyrk(CblasUpper, CblasNoTrans, 1.0, &pxlsView.matrix, 1.0, &coMomentView.matrix);
+
+        double nA = this->n;
+        double nB = numPxls;
+        double nT = nA + nB;
+        double scale = (nA * nB) / nT;
+        for(unsigned int i = 0; i < this->numBands; ++i)
+        {
+            double *row = &this->coMoment[((size_t)i) * this->numBands];
+            for(unsigned int j = i; j < this->numBands; ++j)
+            {
+                row[j] += delta[i] * delta[j] * scale;
+            }
+            this->mean[i] += delta[i] * (nB / nT);
+        }
+        this->n += numPxls;
+    }
+
+    void RSGISCovarianceAccumulator::merge(const RSGISCovarianceAccumulator &other)
+    {
+        if(other.n == 0)
+        {
+            return;
+        }
+        if(other.numBands != this->numBands)
+        {
+            throw RSGISImageCalcException("Cannot merge covariance accumulators with different numbers of bands.");
+        }
+
+        double nA = this->n;
+        double nB = other.n;
+        double nT = nA + nB;
+        double scale = (nA * nB) / nT;
+        std::vector<double> delta(this->numBands);
+        for(unsigned int i = 0; i < this->numBands; ++i)
+        {
+            delta[i] = other.mean[i] - this->mean[i];
+        }
+        for(unsigned int i = 0; i < this->numBands; ++i)
+        {
+            size_t rowIdx = ((size_t)i) * this->numBands;
+            for(unsigned int j = i; j < this->numBands; ++j)
+            {
+                this->coMoment[rowIdx+j] += other.coMoment[rowIdx+j] + (delta[i] * delta[j] * scale);
+            }
+            this->mean[i] += delta[i] * (nB / nT);
+        }
+        this->n += other.n;
+    }
+
+    void RSGISCovarianceAccumulator::getCovariance(std::vector<double> *covMatrix) const
+    {
+        if(this->n < 2)
+        {
+            throw RSGISImageCalcException("At least two valid pixels are needed to calculate a covariance matrix.");
+        }
+        covMatrix->assign(((size_t)this->numBands) * this->numBands, 0.0);
+        double div = this->n - 1;
+        for(unsigned int i = 0; i < this->numBands; ++i)
+        {
+            for(unsigned int j = i; j < this->numBands; ++j)
+            {
+                double val = this->coMoment[(((size_t)i) * this->numBands) + j] / div;
+                covMatrix->at((((size_t)i) * this->numBands) + j) = val;
+                covMatrix->at((((size_t)j) * this->numBands) + i) = val;
+            }
+        }
+    }
+
+
+
+
+    RSGISImagePCA::RSGISImagePCA(unsigned int numThreads, bool useNoData, double noDataVal, double sampleRatio)
+    {
+        this->numThreads = numThreads;
+        this->useNoData = useNoData;
+        this->noDataVal = noDataVal;
+        if((sampleRatio <= 0) | (sampleRatio > 1))
+        {
+            throw RSGISImageCalcException("The sample ratio must be greater than 0 and no more than 1.");
+        }
+        this->sampleRatio = sampleRatio;
+        this->sampleThreshold = (unsigned long long)(sampleRatio * 18446744073709549568.0);
+    }
+
+    void RSGISImagePCA::calcMeanCovariance(GDALDataset *dataset, std::vector<double> *meanVec, std::vector<double> *covMatrix, unsigned long *numPxls, std::vector<double> *noiseCovMatrix)
+    {
+        try
+        {
+            unsigned int numBands = dataset->GetRasterCount();
+            unsigned int width = dataset->GetRasterXSize();
+            unsigned int height = dataset->GetRasterYSize();
+            if(numBands == 0)
+            {
+                throw RSGISImageCalcException("The input image does not have any bands.");
+            }
+            bool calcNoise = (noiseCovMatrix != NULL);
+
+            unsigned int stripRows = this->calcStripRows(dataset, calcNoise?(numBands*2):numBands);
+            size_t numStrips = (height + stripRows - 1) / stripRows;
+
+            RSGISImageThreadUtils threadUtils;
+            unsigned int nThreads = threadUtils.getNumThreads(this->numThreads);
+            std::vector<GDALDataset*> handles = threadUtils.openDatasetHandles(dataset, nThreads);
+            nThreads = handles.size();
+
+            std::vector<RSGISCovarianceAccumulator> accums(nThreads, RSGISCovarianceAccumulator(numBands));
+            std::vector<RSGISCovarianceAccumulator> noiseAccums(calcNoise?nThreads:0, RSGISCovarianceAccumulator(numBands));
+
+            try
+            {
+                threadUtils.runTasks(nThreads, numStrips, [&](unsigned int threadIdx, size_t strip)
+                {
+                    unsigned int startRow = strip * stripRows;
+                    unsigned int numStripRows = std::min(stripRows, height - startRow);
+                    size_t numStripPxls = ((size_t)width) * numStripRows;
+
+                    std::vector<double> pxlVals(numStripPxls * numBands);
+                    GDALDataset *ds = handles[threadIdx];
+                    for(unsigned int b = 0; b < numBands; ++b)
+                    {
+                        if(ds->GetRasterBand(b+1)->RasterIO(GF_Read, 0, startRow, width, numStripRows, &pxlVals[b * numStripPxls], width, numStripRows, GDT_Float64, 0, 0) != CE_None)
+                        {
+                            throw RSGISImageCalcException("Failed to read the input image.");
+                        }
+                    }
+
+                    std::vector<char> valid(numStripPxls, 1);
+                    std::vector<char> allNoData(numStripPxls, this->useNoData?1:0);
+                    for(unsigned int b = 0; b < numBands; ++b)
+                    {
+                        const double *row = &pxlVals[b * numStripPxls];
+                        for(size_t p = 0; p < numStripPxls; ++p)
+                        {
+                            if(std::isnan(row[p]))
+                            {
+                                valid[p] = 0;
+                            }
+                            else if(row[p] != this->noDataVal)
+                            {
+                                allNoData[p] = 0;
+                            }
+                        }
+                    }
+
+                    std::vector<size_t> pxlIdxs;
+                    pxlIdxs.reserve(numStripPxls);
+                    size_t firstPxlIdx = ((size_t)startRow) * width;
+
+                    if(calcNoise)
+                    {
+                        // Noise is estimated from the difference between horizontal neighbours.
+                        for(size_t p = 0; p < numStripPxls; ++p)
+                        {
+                            if(((p % width) != (width-1)) && valid[p] && valid[p+1] && (!allNoData[p]) && (!allNoData[p+1]) && this->isSampled(firstPxlIdx + p))
+                            {
+                                pxlIdxs.push_back(p);
+                            }
+                        }
+                        std::vector<double> diffVals(pxlIdxs.size() * numBands);
+                        for(unsigned int b = 0; b < numBands; ++b)
+                        {
+                            const double *row = &pxlVals[b * numStripPxls];
+                            double *diffRow = &diffVals[b * pxlIdxs.size()];
+                            for(size_t i = 0; i < pxlIdxs.size(); ++i)
+                            {
+                                diffRow[i] = row[pxlIdxs[i]+1] - row[pxlIdxs[i]];
+                            }
+                        }
+                        noiseAccums[threadIdx].addBlock(diffVals.data(), pxlIdxs.size(), pxlIdxs.size());
+                        pxlIdxs.clear();
+                    }
+
+                    for(size_t p = 0; p < numStripPxls; ++p)
+                    {
+                        if(valid[p] && (!allNoData[p]) && this->isSampled(firstPxlIdx + p))
+                        {
+                            pxlIdxs.push_back(p);
+                        }
+                    }
+                    // Compact the selected pixels to the start of each band row.
+                    for(unsigned int b = 0; b < numBands; ++b)
+                    {
+                        double *row = &pxlVals[b * numStripPxls];
+                        for(size_t i = 0; i < pxlIdxs.size(); ++i)
+                        {
+                            row[i] = row[pxlIdxs[i]];
+                        }
+                    }
+                    accums[threadIdx].addBlock(pxlVals.data(), pxlIdxs.size(), numStripPxls);
+                });
+            }
+            catch(RSGISImageCalcException &e)
+            {
+                threadUtils.closeDatasetHandles(&handles);
+                throw e;
+            }
+            threadUtils.closeDatasetHandles(&handles);
+
+            for(unsigned int i = 1; i < nThreads; ++i)
+            {
+                accums[0].merge(accums[i]);
+            }
+            accums[0].getCovariance(covMatrix);
+            *meanVec = accums[0].mean;
+            *numPxls = accums[0].n;
+
+            if(calcNoise)
+            {
+                for(unsigned int i = 1; i < nThreads; ++i)
+                {
+                    noiseAccums[0].merge(noiseAccums[i]);
+                }
+                // var(x1 - x2) = 2 var(noise)
+                noiseAccums[0].getCovariance(noiseCovMatrix);
+                for(std::vector<double>::iterator iterVals = noiseCovMatrix->begin(); iterVals != noiseCovMatrix->end(); ++iterVals)
+                {
+                    *iterVals /= 2.0;
+                }
+            }
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            throw e;
+        }
+        catch(RSGISException &e)
+        {
+            throw RSGISImageCalcException(e.what());
+        }
+    }
+
+    void RSGISImagePCA::calcPCATransform(const std::vector<double> &covMatrix, unsigned int numBands, std::vector<double> *transform, std::vector<double> *eigenvalues)
+    {
+        if(covMatrix.size() != (((size_t)numBands) * numBands))
+        {
+            throw RSGISImageCalcException("The covariance matrix does not match the number of bands.");
+        }
+
+        gsl_matrix *covGSL = gsl_matrix_alloc(numBands, numBands);
+        gsl_matrix *eigenvectors = gsl_matrix_alloc(numBands, numBands);
+        for(unsigned int i = 0; i < numBands; ++i)
+        {
+            for(unsigned int j = 0; j < numBands; ++j)
+            {
+                gsl_matrix_set(covGSL, i, j, covMatrix[(((size_t)i) * numBands) + j]);
+            }
+        }
+        this->calcSortedEigenvectors(covGSL, eigenvalues, eigenvectors);
+
+        // Each row of the transform is an eigenvector.
+        transform->resize(((size_t)numBands) * numBands);
+        for(unsigned int i = 0; i < numBands; ++i)
+        {
+            for(unsigned int j = 0; j < numBands; ++j)
+            {
+                transform->at((((size_t)i) * numBands) + j) = gsl_matrix_get(eigenvectors, j, i);
+            }
+        }
+
+        gsl_matrix_free(covGSL);
+        gsl_matrix_free(eigenvectors);
+    }
+
+    void RSGISImagePCA::calcMNFTransform(const std::vector<double> &covMatrix, const std::vector<double> &noiseCovMatrix, unsigned int numBands, std::vector<double> *transform, std::vector<double> *eigenvalues)
+    {
+        if((covMatrix.size() != (((size_t)numBands) * numBands)) | (noiseCovMatrix.size() != (((size_t)numBands) * numBands)))
+        {
+            throw RSGISImageCalcException("The covariance matrices do not match the number of bands.");
+        }
+
+        // Whiten the noise: W = V L^-1/2 where Cn = V L V^T.
+        gsl_matrix *noiseGSL = gsl_matrix_alloc(numBands, numBands);
+        gsl_matrix *noiseVecs = gsl_matrix_alloc(numBands, numBands);
+        for(unsigned int i = 0; i < numBands; ++i)
+        {
+            for(unsigned int j = 0; j < numBands; ++j)
+            {
+                gsl_matrix_set(noiseGSL, i, j, noiseCovMatrix[(((size_t)i) * numBands) + j]);
+            }
+        }
+        std::vector<double> noiseVals;
+        this->calcSortedEigenvectors(noiseGSL, &noiseVals, noiseVecs);
+        gsl_matrix_free(noiseGSL);
+
+        unsigned int numComps = 0;
+        double minNoiseVal = noiseVals[0] * numBands * 2.2204460492503131e-16;
+        while((numComps < numBands) && (noiseVals[numComps] > minNoiseVal))
+        {
+            ++numComps;
+        }
+        if(numComps == 0)
+        {
+            gsl_matrix_free(noiseVecs);
+            throw RSGISImageCalcException("The noise covariance matrix is zero so the MNF transform cannot be calculated.");
+        }
+
+        gsl_matrix *whiten = gsl_matrix_alloc(numBands, numComps);
+        for(unsigned int j = 0; j < numComps; ++j)
+        {
+            double scale = 1.0 / sqrt(noiseVals[j]);
+            for(unsigned int i = 0; i < numBands; ++i)
+            {
+                gsl_matrix_set(whiten, i, j, gsl_matrix_get(noiseVecs, i, j) * scale);
+            }
+        }
+        gsl_matrix_free(noiseVecs);
+
+        // PCA of the noise whitened covariance W^T C W.
+        gsl_matrix_const_view covView = gsl_matrix_const_view_array(covMatrix.data(), numBands, numBands);
+        gsl_matrix *covWhiten = gsl_matrix_alloc(numBands, numComps);
+        gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, &covView.matrix, whiten, 0.0, covWhiten);
+        gsl_matrix *whitenedCov = gsl_matrix_alloc(numComps, numComps);
+        gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, whiten, covWhiten, 0.0, whitenedCov);
+        gsl_matrix_free(covWhiten);
+
+        gsl_matrix *signalVecs = gsl_matrix_alloc(numComps, numComps);
+        this->calcSortedEigenvectors(whitenedCov, eigenvalues, signalVecs);
+        gsl_matrix_free(whitenedCov);
+
+        gsl_matrix *mnfVecs = gsl_matrix_alloc(numBands, numComps);
+        gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, whiten, signalVecs, 0.0, mnfVecs);
+        gsl_matrix_free(whiten);
+        gsl_matrix_free(signalVecs);
+
+        transform->resize(((size_t)numComps) * numBands);
+        for(unsigned int i = 0; i < numComps; ++i)
+        {
+            for(unsigned int j = 0; j < numBands; ++j)
+            {
+                transform->at((((size_t)i) * numBands) + j) = gsl_matrix_get(mnfVecs, j, i);
+            }
+        }
+        gsl_matrix_free(mnfVecs);
+    }
+
+    void RSGISImagePCA::applyTransform(GDALDataset *dataset, const std::vector<double> &transform, unsigned int numComponents, const std::vector<double> *meanVec, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType)
+    {
+        try
+        {
+            unsigned int numBands = dataset->GetRasterCount();
+            unsigned int width = dataset->GetRasterXSize();
+            unsigned int height = dataset->GetRasterYSize();
+            if((numComponents == 0) | ((((size_t)numComponents) * numBands) > transform.size()))
+            {
+                throw RSGISImageCalcException("The transform does not have enough components for the number of output bands.");
+            }
+            if((meanVec != NULL) && (meanVec->size() != numBands))
+            {
+                throw RSGISImageCalcException("The mean vector does not match the number of image bands.");
+            }
+
+            RSGISImageUtils imgUtils;
+            GDALDataset *outDS = imgUtils.createCopy(dataset, numComponents, outputImage, gdalFormat, gdalDataType);
+            if(this->useNoData)
+            {
+                for(unsigned int c = 1; c <= numComponents; ++c)
+                {
+                    outDS->GetRasterBand(c)->SetNoDataValue(this->noDataVal);
+                }
+            }
+
+            unsigned int stripRows = this->calcStripRows(dataset, numBands + numComponents);
+            size_t numStrips = (height + stripRows - 1) / stripRows;
+
+            RSGISImageThreadUtils threadUtils;
+            unsigned int nThreads = threadUtils.getNumThreads(this->numThreads);
+            std::vector<GDALDataset*> handles = threadUtils.openDatasetHandles(dataset, nThreads);
+            nThreads = handles.size();
+
+            gsl_matrix_const_view transView = gsl_matrix_const_view_array(transform.data(), numComponents, numBands);
+
+            std::mutex writeMutex;
+            try
+            {
+                threadUtils.runTasks(nThreads, numStrips, [&](unsigned int threadIdx, size_t strip)
+                {
+                    unsigned int startRow = strip * stripRows;
+                    unsigned int numStripRows = std::min(stripRows, height - startRow);
+                    size_t numStripPxls = ((size_t)width) * numStripRows;
+
+                    std::vector<double> pxlVals(numStripPxls * numBands);
+                    GDALDataset *ds = handles[threadIdx];
+                    for(unsigned int b = 0; b < numBands; ++b)
+                    {
+                        if(ds->GetRasterBand(b+1)->RasterIO(GF_Read, 0, startRow, width, numStripRows, &pxlVals[b * numStripPxls], width, numStripRows, GDT_Float64, 0, 0) != CE_None)
+                        {
+                            throw RSGISImageCalcException("Failed to read the input image.");
+                        }
+                    }
+
+                    std::vector<char> valid(numStripPxls, 1);
+                    std::vector<char> allNoData(numStripPxls, this->useNoData?1:0);
+                    for(unsigned int b = 0; b < numBands; ++b)
+                    {
+                        double *row = &pxlVals[b * numStripPxls];
+                        double bandMean = (meanVec != NULL)?meanVec->at(b):0.0;
+                        for(size_t p = 0; p < numStripPxls; ++p)
+                        {
+                            if(std::isnan(row[p]))
+                            {
+                                valid[p] = 0;
+                                row[p] = 0.0;
+                            }
+                            else
+                            {
+                                if(row[p] != this->noDataVal)
+                                {
+                                    allNoData[p] = 0;
+                                }
+                                row[p] -= bandMean;
+                            }
+                        }
+                    }
+
+                    std::vector<double> outVals(numStripPxls * numComponents);
+                    gsl_matrix_view pxlsView = gsl_matrix_view_array(pxlVals.data(), numBands, numStripPxls);
+                    gsl_matrix_view outView = gsl_matrix_view_array(outVals.data(), numComponents, numStripPxls);
+                    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, &transView.matrix, &pxlsView.matrix, 0.0, &outView.matrix);
+
+                    for(size_t p = 0; p < numStripPxls; ++p)
+                    {
+                        if((!valid[p]) | allNoData[p])
+                        {
+                            for(unsigned int c = 0; c < numComponents; ++c)
+                            {
+                                outVals[(c * numStripPxls) + p] = this->noDataVal;
+                            }
+                        }
+                    }
+
+                    std::lock_guard<std::mutex> lock(writeMutex);
+                    for(unsigned int c = 0; c < numComponents; ++c)
+                    {
+                        if(outDS->GetRasterBand(c+1)->RasterIO(GF_Write, 0, startRow, width, numStripRows, &outVals[c * numStripPxls], width, numStripRows, GDT_Float64, 0, 0) != CE_None)
+                        {
+                            throw RSGISImageCalcException("Failed to write the output image.");
+                        }
+                    }
+                });
+            }
+            catch(RSGISImageCalcException &e)
+            {
+                threadUtils.closeDatasetHandles(&handles);
+                GDALClose(outDS);
+                throw e;
+            }
+            threadUtils.closeDatasetHandles(&handles);
+            GDALClose(outDS);
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            throw e;
+        }
+        catch(RSGISException &e)
+        {
+            throw RSGISImageCalcException(e.what());
+        }
+    }
+
+    unsigned int RSGISImagePCA::calcStripRows(GDALDataset *dataset, unsigned int numVals)
+    {
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        dataset->GetRasterBand(1)->GetBlockSize(&xBlockSize, &yBlockSize);
+        if(yBlockSize < 1)
+        {
+            yBlockSize = 1;
+        }
+
+        // Aim for about 16 MB of pixel values per strip, whatever the number of bands.
+        size_t width = dataset->GetRasterXSize();
+        size_t height = dataset->GetRasterYSize();
+        size_t targetPxls = std::max<size_t>(2097152 / std::max<unsigned int>(numVals, 1), width);
+        unsigned int stripRows = yBlockSize;
+        while(((((size_t)stripRows) * width) < targetPxls) && (stripRows < height))
+        {
+            stripRows += yBlockSize;
+        }
+        return stripRows;
+    }
+
+    bool RSGISImagePCA::isSampled(size_t pxlIdx)
+    {
+        if(this->sampleRatio >= 1.0)
+        {
+            return true;
+        }
+        // splitmix64 finaliser
+        unsigned long long z = ((unsigned long long)pxlIdx) + 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z = z ^ (z >> 31);
+        return z < this->sampleThreshold;
+    }
+
+    void RSGISImagePCA::calcSortedEigenvectors(gsl_matrix *symMatrix, std::vector<double> *eigenvalues, gsl_matrix *eigenvectors)
+    {
+        size_t n = symMatrix->size1;
+        gsl_vector *evalsGSL = gsl_vector_alloc(n);
+        gsl_eigen_symmv_workspace *workspace = gsl_eigen_symmv_alloc(n);
+        gsl_eigen_symmv(symMatrix, evalsGSL, eigenvectors, workspace);
+        gsl_eigen_symmv_free(workspace);
+        gsl_eigen_symmv_sort(evalsGSL, eigenvectors, GSL_EIGEN_SORT_VAL_DESC);
+
+        eigenvalues->resize(n);
+        for(size_t i = 0; i < n; ++i)
+        {
+            eigenvalues->at(i) = gsl_vector_get(evalsGSL, i);
+
+            // Fix the sign so the largest element of each eigenvector is positive.
+            size_t maxIdx = 0;
+            for(size_t j = 1; j < n; ++j)
+            {
+                if(fabs(gsl_matrix_get(eigenvectors, j, i)) > fabs(gsl_matrix_get(eigenvectors, maxIdx, i)))
+                {
+                    maxIdx = j;
+                }
+            }
+            if(gsl_matrix_get(eigenvectors, maxIdx, i) < 0)
+            {
+                for(size_t j = 0; j < n; ++j)
+                {
+                    gsl_matrix_set(eigenvectors, j, i, -gsl_matrix_get(eigenvectors, j, i));
+                }
+            }
+        }
+        gsl_vector_free(evalsGSL);
+    }
+
+}}
@@ -0,0 +1,120 @@
+/*
+ *  RSGISImagePCA.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISImagePCA_H
+#define RSGISImagePCA_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cmath>
+#include <algorithm>
+
+#include "gdal_priv.h"
+
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_eigen.h>
+
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISImageUtils.h"
+#include "img/RSGISImageThreadUtils.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+
+    /**
+     * Running mean and co-moment matrix (upper triangle, row-major) for
+     * numBands variables. Blocks of pixels are added with a rank-k update
+     * and accumulators are combined with the pairwise update of Chan et al.
+     */
+    struct DllExport RSGISCovarianceAccumulator
+    {
+        RSGISCovarianceAccumulator(unsigned int numBands=0)
+        {
+            this->reset(numBands);
+        };
+        void reset(unsigned int numBands)
+        {
+            this->numBands = numBands;
+            this->n = 0;
+            this->mean.assign(numBands, 0.0);
+            this->coMoment.assign(((size_t)numBands)*numBands, 0.0);
+        };
+        void addBlock(double *pxlVals, size_t numPxls, size_t rowStride);
+        void merge(const RSGISCovarianceAccumulator &other);
+        void getCovariance(std::vector<double> *covMatrix) const;
+        unsigned int numBands;
+        unsigned long n;
+        std::vector<double> mean;
+        std::vector<double> coMoment;
+    };
+
+    /**
+     * Principal component and minimum noise fraction transforms for images
+     * which do not fit in memory. The mean vector and covariance matrix are
+     * accumulated in one streaming pass, with image strips shared between
+     * threads, and the transform is applied to each strip as a matrix product
+     * in a second pass. Only a few strips are held in memory per thread.
+     *
+     * Pixels where every band is equal to the no data value (if used) or
+     * where any band is NaN are ignored. A sample ratio less than 1 selects
+     * pixels with a fixed hash of their position so the result does not
+     * depend on the number of threads.
+     */
+    class DllExport RSGISImagePCA
+    {
+    public:
+        RSGISImagePCA(unsigned int numThreads=0, bool useNoData=false, double noDataVal=0.0, double sampleRatio=1.0);
+        void calcMeanCovariance(GDALDataset *dataset, std::vector<double> *meanVec, std::vector<double> *covMatrix, unsigned long *numPxls, std::vector<double> *noiseCovMatrix=NULL);
+        void calcPCATransform(const std::vector<double> &covMatrix, unsigned int numBands, std::vector<double> *transform, std::vector<double> *eigenvalues);
+        void calcMNFTransform(const std::vector<double> &covMatrix, const std::vector<double> &noiseCovMatrix, unsigned int numBands, std::vector<double> *transform, std::vector<double> *eigenvalues);
+        void applyTransform(GDALDataset *dataset, const std::vector<double> &transform, unsigned int numComponents, const std::vector<double> *meanVec, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType);
+        ~RSGISImagePCA(){};
+    protected:
+        unsigned int calcStripRows(GDALDataset *dataset, unsigned int numVals);
+        bool isSampled(size_t pxlIdx);
+        void calcSortedEigenvectors(gsl_matrix *symMatrix, std::vector<double> *eigenvalues, gsl_matrix *eigenvectors);
+        unsigned int numThreads;
+        bool useNoData;
+        double noDataVal;
+        double sampleRatio;
+        unsigned long long sampleThreshold;
+    };
+
+}}
+
+#endif
@@ -0,0 +1,199 @@
+/*
+ *  RSGISImageThreadUtils.cpp
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISImageThreadUtils.h"
+
+namespace rsgis{namespace img{
+
+    unsigned int RSGISImageThreadUtils::getNumThreads(unsigned int numThreads)
+    {
+        if(numThreads == 0)
+        {
+            numThreads = std::thread::hardware_concurrency();
+            if(numThreads == 0)
+            {
+                numThreads = 1;
+            }
+        }
+        return numThreads;
+    }
+
+    std::vector<GDALDataset*> RSGISImageThreadUtils::openDatasetHandles(GDALDataset *dataset, unsigned int numThreads)
+    {
+        std::vector<GDALDataset*> handles;
+        handles.push_back(dataset);
+
+        std::string fileName = dataset->GetDescription();
+        if((numThreads <= 1) | (fileName == ""))
+        {
+            return handles;
+        }
+
+        // HDF5 based formats (e.g., KEA) cannot be read from several threads at once.
+        GDALDriver *driver = dataset->GetDriver();
+        if(driver != NULL)
+        {
+            std::string driverName = driver->GetDescription();
+            if((driverName == "KEA") | (driverName == "HDF5") | (driverName == "HDF5Image") | (driverName == "netCDF"))
+            {
+                return handles;
+            }
+        }
+
+        // Make sure anything written through the callers handle is visible to the new handles.
+        dataset->FlushCache();
+
+        for(unsigned int i = 1; i < numThreads; ++i)
+        {
+            GDALDataset *threadDS = (GDALDataset *) GDALOpen(fileName.c_str(), GA_ReadOnly);
+            if(threadDS == NULL)
+            {
+                break;
+            }
+            if((threadDS->GetRasterXSize() != dataset->GetRasterXSize()) | (threadDS->GetRasterYSize() != dataset->GetRasterYSize()) | (threadDS->GetRasterCount() != dataset->GetRasterCount()))
+            {
+                // Description does not refer to the same image (e.g., a VRT built in memory).
+                GDALClose(threadDS);
+                break;
+            }
+            handles.push_back(threadDS);
+        }
+        return handles;
+    }
+
+    std::vector<GDALDataset*> RSGISImageThreadUtils::openDatasetHandles(GDALDataset *dataset, unsigned int numThreads, bool *sharedHandle)
+    {
+        std::vector<GDALDataset*> handles = this->openDatasetHandles(dataset, numThreads);
+        *sharedHandle = (handles.size() < numThreads);
+        while(handles.size() < numThreads)
+        {
+            handles.push_back(dataset);
+        }
+        return handles;
+    }
+
+    std::unique_lock<std::mutex> RSGISImageThreadUtils::lockSharedRead(bool sharedHandle)
+    {
+        // One lock for all the shared handles as HDF5 is not safe to use from
+        // several threads even for different files.
+        static std::mutex sharedReadMutex;
+        if(sharedHandle)
+        {
+            return std::unique_lock<std::mutex>(sharedReadMutex);
+        }
+        return std::unique_lock<std::mutex>();
+    }
+
+    void RSGISImageThreadUtils::closeDatasetHandles(std::vector<GDALDataset*> *handles)
+    {
+        for(size_t i = 1; i < handles->size(); ++i)
+        {
+            if(handles->at(i) != handles->at(0))
+            {
+                GDALClose(handles->at(i));
+            }
+        }
+        if(handles->size() > 1)
+        {
+            handles->resize(1);
+        }
+    }
+
+    void RSGISImageThreadUtils::runTasks(unsigned int numThreads, size_t numTasks, std::function<void(unsigned int, size_t)> taskFunc, bool quiet)
+    {
+        if(numThreads < 1)
+        {
+            numThreads = 1;
+        }
+        if(numThreads > numTasks)
+        {
+            numThreads = numTasks;
+        }
+        if(numTasks == 0)
+        {
+            return;
+        }
+
+        std::atomic<size_t> nextTask(0);
+        std::atomic<bool> failed(false);
+        std::mutex progressMutex;
+        std::exception_ptr firstError = nullptr;
+        size_t numComplete = 0;
+        rsgis_tqdm pbar;
+
+        auto worker = [&](unsigned int threadIdx)
+        {
+            size_t task = 0;
+            while((!failed) && ((task = nextTask++) < numTasks))
+            {
+                try
+                {
+                    taskFunc(threadIdx, task);
+                }
+                catch(...)
+                {
+                    std::lock_guard<std::mutex> lock(progressMutex);
+                    if(!failed)
+                    {
+                        firstError = std::current_exception();
+                        failed = true;
+                    }
+                    return;
+                }
+
+                if(!quiet)
+                {
+                    std::lock_guard<std::mutex> lock(progressMutex);
+                    pbar.progress(numComplete++, numTasks);
+                }
+            }
+        };
+
+        if(numThreads == 1)
+        {
+            worker(0);
+        }
+        else
+        {
+            std::vector<std::thread> threads;
+            for(unsigned int i = 0; i < numThreads; ++i)
+            {
+                threads.push_back(std::thread(worker, i));
+            }
+            for(unsigned int i = 0; i < numThreads; ++i)
+            {
+                threads[i].join();
+            }
+        }
+
+        if(!quiet)
+        {
+            pbar.finish();
+        }
+
+        if(firstError != nullptr)
+        {
+            std::rethrow_exception(firstError);
+        }
+    }
+
+}}
@@ -0,0 +1,84 @@
+/*
+ *  RSGISImageThreadUtils.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISImageThreadUtils_H
+#define RSGISImageThreadUtils_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+
+#include "gdal_priv.h"
+
+#include "common/rsgis-tqdm.h"
+
+#include "img/RSGISImageCalcException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+
+    /**
+     * Helpers for processing an image with a pool of threads. A GDALDataset must
+     * not be shared between threads so each thread is given its own read-only
+     * handle onto the same file (handle 0 is always the dataset passed in). If
+     * the dataset cannot be re-opened (e.g., it is an in-memory dataset) then a
+     * single handle is returned and processing falls back to one thread. This is
+     * also the case for formats built on HDF5, which is not thread safe.
+     *
+     * Alternatively, the sharedHandle version always returns numThreads handles;
+     * where the dataset cannot be opened per thread they are all the dataset
+     * passed in and reads through them must hold the lock from lockSharedRead.
+     * The reads are then serialised but the processing can still use the pool.
+     */
+    class DllExport RSGISImageThreadUtils
+    {
+    public:
+        RSGISImageThreadUtils(){};
+        unsigned int getNumThreads(unsigned int numThreads);
+        std::vector<GDALDataset*> openDatasetHandles(GDALDataset *dataset, unsigned int numThreads);
+        std::vector<GDALDataset*> openDatasetHandles(GDALDataset *dataset, unsigned int numThreads, bool *sharedHandle);
+        std::unique_lock<std::mutex> lockSharedRead(bool sharedHandle);
+        void closeDatasetHandles(std::vector<GDALDataset*> *handles);
+        void runTasks(unsigned int numThreads, size_t numTasks, std::function<void(unsigned int, size_t)> taskFunc, bool quiet=false);
+        ~RSGISImageThreadUtils(){};
+    };
+
+}}
+
+#endif
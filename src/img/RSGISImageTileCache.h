@@ -0,0 +1,274 @@
+/*
+ *  RSGISImageTileCache.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISImageTileCache_H
+#define RSGISImageTileCache_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <list>
+#include <algorithm>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISImageException.h"
+
+namespace rsgis{namespace img{
+
+    template<typename T> struct RSGISTileCacheDataType {};
+    template<> struct RSGISTileCacheDataType<unsigned char> { static GDALDataType gdalType(){return GDT_Byte;} };
+    template<> struct RSGISTileCacheDataType<unsigned short> { static GDALDataType gdalType(){return GDT_UInt16;} };
+    template<> struct RSGISTileCacheDataType<short> { static GDALDataType gdalType(){return GDT_Int16;} };
+    template<> struct RSGISTileCacheDataType<unsigned int> { static GDALDataType gdalType(){return GDT_UInt32;} };
+    template<> struct RSGISTileCacheDataType<int> { static GDALDataType gdalType(){return GDT_Int32;} };
+    template<> struct RSGISTileCacheDataType<float> { static GDALDataType gdalType(){return GDT_Float32;} };
+    template<> struct RSGISTileCacheDataType<double> { static GDALDataType gdalType(){return GDT_Float64;} };
+
+    /**
+     * Random access to the pixels of an image band through a cache of decoded
+     * tiles, for algorithms which visit pixels in an irregular order (e.g.,
+     * region growing) and would otherwise make a 1x1 RasterIO call per pixel.
+     *
+     * Tiles follow the block layout of the band (scanline blocks are grown to
+     * at least 64k pixels) and values are held as type T, converted by GDAL
+     * when a tile is read or written. When the memory budget is reached the
+     * least recently used tile is dropped, being written back first if it has
+     * been modified. Pixel coordinates are not checked against the image.
+     *
+     * A cache is not thread safe and changes are only visible to other readers
+     * of the band after flush(), which the destructor also calls.
+     */
+    template<typename T>
+    class RSGISImageTileCache
+    {
+    public:
+        RSGISImageTileCache(GDALRasterBand *band, bool writable=false, size_t maxMemBytes=268435456)
+        {
+            this->band = band;
+            this->writable = writable;
+            this->width = band->GetXSize();
+            this->height = band->GetYSize();
+
+            int xBlockSize = 0;
+            int yBlockSize = 0;
+            band->GetBlockSize(&xBlockSize, &yBlockSize);
+            this->tileXSize = std::max(std::min(xBlockSize, this->width), 1);
+            this->tileYSize = std::max(std::min(yBlockSize, this->height), 1);
+            int yStep = this->tileYSize;
+            while(((((size_t)this->tileXSize) * this->tileYSize) < 65536) && (this->tileYSize < this->height))
+            {
+                this->tileYSize = std::min(this->tileYSize + yStep, this->height);
+            }
+            this->numTilesX = (this->width + this->tileXSize - 1) / this->tileXSize;
+            this->numTilesY = (this->height + this->tileYSize - 1) / this->tileYSize;
+            this->tilePxls = ((size_t)this->tileXSize) * this->tileYSize;
+
+            this->maxTiles = std::max<size_t>(maxMemBytes / (this->tilePxls * sizeof(T)), 1);
+            this->tiles.assign(((size_t)this->numTilesX) * this->numTilesY, NULL);
+            this->lastTileIdx = this->tiles.size();
+            this->lastTileData = NULL;
+        };
+        int getXSize(){return this->width;};
+        int getYSize(){return this->height;};
+        inline T getValue(int x, int y)
+        {
+            return this->getTileData(x, y)[this->getTileOffset(x, y)];
+        };
+        inline void setValue(int x, int y, T val)
+        {
+            if(!this->writable)
+            {
+                throw rsgis::RSGISImageException("The tile cache was not created as writable.");
+            }
+            T *tileData = this->getTileData(x, y);
+            this->tiles[this->lastTileIdx]->dirty = true;
+            tileData[this->getTileOffset(x, y)] = val;
+        };
+        /**
+         * Load the tiles covering a window (clipped to the image) which is about
+         * to be accessed, in raster order. Nothing is loaded and false returned
+         * if the tiles would not all fit within the memory budget, in which case
+         * the pixels are still read on demand.
+         */
+        bool prefetch(int xOff, int yOff, int xSize, int ySize)
+        {
+            int xEnd = std::min(((long)xOff) + xSize, (long)this->width);
+            int yEnd = std::min(((long)yOff) + ySize, (long)this->height);
+            xOff = std::max(xOff, 0);
+            yOff = std::max(yOff, 0);
+            if((xOff >= xEnd) | (yOff >= yEnd))
+            {
+                return true;
+            }
+            int tileX1 = xOff / this->tileXSize;
+            int tileX2 = (xEnd - 1) / this->tileXSize;
+            int tileY1 = yOff / this->tileYSize;
+            int tileY2 = (yEnd - 1) / this->tileYSize;
+            size_t numTiles = ((size_t)(tileX2 - tileX1 + 1)) * (tileY2 - tileY1 + 1);
+            if(numTiles > this->maxTiles)
+            {
+                return false;
+            }
+            for(int tileY = tileY1; tileY <= tileY2; ++tileY)
+            {
+                for(int tileX = tileX1; tileX <= tileX2; ++tileX)
+                {
+                    this->loadTile((((size_t)tileY) * this->numTilesX) + tileX);
+                }
+            }
+            return true;
+        };
+        /**
+         * Write all the modified tiles back to the band.
+         */
+        void flush()
+        {
+            for(size_t i = 0; i < this->tiles.size(); ++i)
+            {
+                if((this->tiles[i] != NULL) && this->tiles[i]->dirty)
+                {
+                    this->writeTile(i);
+                }
+            }
+        };
+        ~RSGISImageTileCache()
+        {
+            try
+            {
+                this->flush();
+            }
+            catch(rsgis::RSGISImageException &e)
+            {
+                std::cerr << "ERROR: " << e.what() << std::endl;
+            }
+            for(size_t i = 0; i < this->tiles.size(); ++i)
+            {
+                if(this->tiles[i] != NULL)
+                {
+                    delete this->tiles[i];
+                }
+            }
+        };
+    protected:
+        struct RSGISCacheTile
+        {
+            std::vector<T> data;
+            bool dirty;
+            typename std::list<size_t>::iterator lruPos;
+        };
+        inline size_t getTileOffset(int x, int y)
+        {
+            return (((size_t)(y % this->tileYSize)) * this->tileXSize) + (x % this->tileXSize);
+        };
+        inline T* getTileData(int x, int y)
+        {
+            size_t tileIdx = (((size_t)(y / this->tileYSize)) * this->numTilesX) + (x / this->tileXSize);
+            if(tileIdx != this->lastTileIdx)
+            {
+                this->lastTileData = this->loadTile(tileIdx)->data.data();
+                this->lastTileIdx = tileIdx;
+            }
+            return this->lastTileData;
+        };
+        RSGISCacheTile* loadTile(size_t tileIdx)
+        {
+            RSGISCacheTile *tile = this->tiles[tileIdx];
+            if(tile != NULL)
+            {
+                this->lruTiles.splice(this->lruTiles.begin(), this->lruTiles, tile->lruPos);
+                return tile;
+            }
+
+            if(this->lruTiles.size() >= this->maxTiles)
+            {
+                // Reuse the memory of the least recently used tile.
+                size_t oldIdx = this->lruTiles.back();
+                if(this->tiles[oldIdx]->dirty)
+                {
+                    this->writeTile(oldIdx);
+                }
+                tile = this->tiles[oldIdx];
+                this->tiles[oldIdx] = NULL;
+                this->lruTiles.pop_back();
+                if(oldIdx == this->lastTileIdx)
+                {
+                    this->lastTileIdx = this->tiles.size();
+                }
+            }
+            else
+            {
+                tile = new RSGISCacheTile();
+                tile->data.resize(this->tilePxls);
+            }
+
+            int tileX = tileIdx % this->numTilesX;
+            int tileY = tileIdx / this->numTilesX;
+            int xOff = tileX * this->tileXSize;
+            int yOff = tileY * this->tileYSize;
+            int xSize = std::min(this->tileXSize, this->width - xOff);
+            int ySize = std::min(this->tileYSize, this->height - yOff);
+            if(this->band->RasterIO(GF_Read, xOff, yOff, xSize, ySize, tile->data.data(), xSize, ySize, RSGISTileCacheDataType<T>::gdalType(), sizeof(T), sizeof(T) * this->tileXSize) != CE_None)
+            {
+                delete tile;
+                throw rsgis::RSGISImageException("Failed to read an image tile into the cache.");
+            }
+            tile->dirty = false;
+            this->lruTiles.push_front(tileIdx);
+            tile->lruPos = this->lruTiles.begin();
+            this->tiles[tileIdx] = tile;
+            return tile;
+        };
+        void writeTile(size_t tileIdx)
+        {
+            RSGISCacheTile *tile = this->tiles[tileIdx];
+            int tileX = tileIdx % this->numTilesX;
+            int tileY = tileIdx / this->numTilesX;
+            int xOff = tileX * this->tileXSize;
+            int yOff = tileY * this->tileYSize;
+            int xSize = std::min(this->tileXSize, this->width - xOff);
+            int ySize = std::min(this->tileYSize, this->height - yOff);
+            if(this->band->RasterIO(GF_Write, xOff, yOff, xSize, ySize, tile->data.data(), xSize, ySize, RSGISTileCacheDataType<T>::gdalType(), sizeof(T), sizeof(T) * this->tileXSize) != CE_None)
+            {
+                throw rsgis::RSGISImageException("Failed to write an image tile from the cache.");
+            }
+            tile->dirty = false;
+        };
+        GDALRasterBand *band;
+        bool writable;
+        int width;
+        int height;
+        int tileXSize;
+        int tileYSize;
+        int numTilesX;
+        int numTilesY;
+        size_t tilePxls;
+        size_t maxTiles;
+        std::vector<RSGISCacheTile*> tiles;
+        std::list<size_t> lruTiles;
+        size_t lastTileIdx;
+        T *lastTileData;
+    };
+
+}}
+
+#endif
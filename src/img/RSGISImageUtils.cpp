@@ -3724,10 +3724,6 @@ namespace rsgis{namespace img{
 		GDALDataset **inDatasets = NULL;
 		GDALDriver *gdalDriver = NULL;
 		GDALDataset *outputImageDS = NULL;
-		GDALRasterBand *inputRasterBand = NULL;
-		GDALRasterBand *outputRasterBand = NULL;
-		
-		float *data = NULL;
 		double *gdalTranslation = new double[6];
 		int **dsOffsets = new int*[numImages];
 		for(int i = 0; i < numImages; i++)
@@ -3767,8 +3763,6 @@ namespace rsgis{namespace img{
 			std::cout << "Stack Height = " << stackHeight << std::endl;
 			std::cout << "Stack Width = " << stackWidth << std::endl;
 			
-			data = (float *) CPLMalloc(sizeof(float)*stackWidth);
-			
 			for(int i = 0; i < numImages; i++)
 			{
 				std::cout << "Converting image " << inputImages[i] << std::endl;
@@ -3779,22 +3773,18 @@ namespace rsgis{namespace img{
 				outputImageDS->SetGeoTransform(gdalTranslation);
 				outputImageDS->SetProjection(inDatasets[0]->GetProjectionRef());
 				
+				std::vector<RSGISBlockCopyBand> inBands;
 				for(int n = 1; n <= numOutBands; n++)
 				{
-					std::cout << "Image Band " << n << " of " << numOutBands << std::endl;
-					
-					inputRasterBand = inDatasets[i]->GetRasterBand(n);
-					outputRasterBand = outputImageDS->GetRasterBand(n);
-					
-					rsgis_tqdm pbar;
-					for(int m = 0; m < stackHeight; m++)
-					{
-						pbar.progress(m, stackHeight);
-						inputRasterBand->RasterIO(GF_Read, dsOffsets[i][0], (dsOffsets[i][1]+m), stackWidth, 1, data, stackWidth, 1, GDT_Float32, 0, 0);						
-						outputRasterBand->RasterIO(GF_Write, 0, m, stackWidth, 1, data, stackWidth, 1, GDT_Float32, 0, 0);
-					}
-					pbar.finish();
+					RSGISBlockCopyBand inBand;
+					inBand.dataset = inDatasets[i];
+					inBand.band = n;
+					inBand.xOff = dsOffsets[i][0];
+					inBand.yOff = dsOffsets[i][1];
+					inBands.push_back(inBand);
 				}
+				RSGISImageBlockCopy blockCopy(0, false);
+				blockCopy.copyBands(inBands, outputImageDS, GDT_Float32);
 				GDALClose(outputImageDS);
 			}
 			
@@ -3802,8 +3792,12 @@ namespace rsgis{namespace img{
 			{
 				GDALClose(inDatasets[i]);
 			}
-			delete inDatasets;
-			delete data;
+			delete[] inDatasets;
+			for(int i = 0; i < numImages; i++)
+			{
+				delete[] dsOffsets[i];
+			}
+			delete[] dsOffsets;
 			delete[] gdalTranslation;
 			
 		}
@@ -3940,15 +3934,7 @@ namespace rsgis{namespace img{
 		GDALDriver *gdalDriver = NULL;
 		GDALDataset *outDataset = NULL;
 		
-		GDALRasterBand *inputRasterBand = NULL;
-		GDALRasterBand *outputRasterBand = NULL;
-		
-		float *data = NULL;
-		
 		char **gdalDriverMetaInfo;
-		int numOutBands = 0;
-		int width = 0;
-		int height = 0;
 		
 		try
 		{
@@ -3991,39 +3977,11 @@ namespace rsgis{namespace img{
                 outDataset->SetProjection(wktProjStr.c_str());
             }
 			
-			width = inDataset->GetRasterXSize();
-			height = inDataset->GetRasterYSize();
-			data = (float *) CPLMalloc(sizeof(float)*width);
-			std::cout << "Image size [" << width << "," << height << "]\n";
-			
-			numOutBands = inDataset->GetRasterCount();
-			for(int n = 1; n <= numOutBands; n++)
-			{
-				std::cout << "Image Band " << n << " of " << numOutBands << std::endl;
-				inputRasterBand = inDataset->GetRasterBand(n);
-				outputRasterBand = outDataset->GetRasterBand(n);
-				
-				int feedback = height/10;
-				int feedbackCounter = 0;
-				std::cout << "Started" << std::flush;
-				
-				for(int m = 0; m < height; m++)
-				{
-					if((m % feedback) == 0)
-					{
-						std::cout << ".." << feedbackCounter << ".." << std::flush;
-						feedbackCounter = feedbackCounter + 10;
-					}
-					
-					inputRasterBand->RasterIO(GF_Read, 0, m, width, 1, data, width, 1, GDT_Float32, 0, 0);
-					outputRasterBand->RasterIO(GF_Write, 0, m, width, 1, data, width, 1, GDT_Float32, 0, 0);
-				}
-				std::cout << " Complete.\n";
-			}
+			// CreateCopy has already copied the pixel values block by block in their native type.
+			std::cout << "Image size [" << inDataset->GetRasterXSize() << "," << inDataset->GetRasterYSize() << "]\n";
 			
 			GDALClose(outDataset);
 			GDALClose(inDataset);
-			delete data;
 		}
 		catch(RSGISImageException &e)
 		{
@@ -4445,32 +4403,9 @@ namespace rsgis{namespace img{
                 throw RSGISImageException("Number of bands are not the same");
             }
             
-            unsigned long width = inData->GetRasterXSize();
-            unsigned long height = inData->GetRasterYSize();
-            unsigned int numBands = inData->GetRasterCount();
-            
-            GDALRasterBand **inputRasterBands = new GDALRasterBand*[numBands];
-            GDALRasterBand **outputRasterBands = new GDALRasterBand*[numBands];
-            float *data = new float[width];
-            
-            for(unsigned int n = 0; n < numBands; ++n)
-            {
-                inputRasterBands[n] = inData->GetRasterBand(n+1);
-                outputRasterBands[n] = outData->GetRasterBand(n+1);
-            }
-            
-            for(unsigned long y = 0; y < height; ++y)
-            {
-                for(unsigned int n = 0; n < numBands; ++n)
-                {
-                    inputRasterBands[n]->RasterIO(GF_Read, 0, y, width, 1, data, width, 1, GDT_Float32, 0, 0);
-                    outputRasterBands[n]->RasterIO(GF_Write, 0, y, width, 1, data, width, 1, GDT_Float32, 0, 0);
-                }
-            }
-                
-            delete[] inputRasterBands;
-            delete[] outputRasterBands;
-            delete[] data;
+            // Values only pass through GDT_Float32 where the band types differ.
+            RSGISImageBlockCopy blockCopy;
+            blockCopy.copyDataset(inData, outData, GDT_Float32);
         }
         catch(RSGISImageException &e)
         {
@@ -4496,32 +4431,8 @@ namespace rsgis{namespace img{
                 throw RSGISImageException("Number of bands are not the same");
             }
             
-            unsigned long width = inData->GetRasterXSize();
-            unsigned long height = inData->GetRasterYSize();
-            unsigned int numBands = inData->GetRasterCount();
-            
-            GDALRasterBand **inputRasterBands = new GDALRasterBand*[numBands];
-            GDALRasterBand **outputRasterBands = new GDALRasterBand*[numBands];
-            int *data = new int[width];
-            
-            for(unsigned int n = 0; n < numBands; ++n)
-            {
-                inputRasterBands[n] = inData->GetRasterBand(n+1);
-                outputRasterBands[n] = outData->GetRasterBand(n+1);
-            }
-            
-            for(unsigned long y = 0; y < height; ++y)
-            {
-                for(unsigned int n = 0; n < numBands; ++n)
-                {
-                    inputRasterBands[n]->RasterIO(GF_Read, 0, y, width, 1, data, width, 1, GDT_Int32, 0, 0);
-                    outputRasterBands[n]->RasterIO(GF_Write, 0, y, width, 1, data, width, 1, GDT_Int32, 0, 0);
-                }
-            }
-            
-            delete[] inputRasterBands;
-            delete[] outputRasterBands;
-            delete[] data;
+            RSGISImageBlockCopy blockCopy;
+            blockCopy.copyDataset(inData, outData, GDT_Int32);
         }
         catch(RSGISImageException &e)
         {
@@ -4547,32 +4458,8 @@ namespace rsgis{namespace img{
                 throw RSGISImageException("Number of bands are not the same");
             }
             
-            unsigned long width = inData->GetRasterXSize();
-            unsigned long height = inData->GetRasterYSize();
-            unsigned int numBands = inData->GetRasterCount();
-            
-            GDALRasterBand **inputRasterBands = new GDALRasterBand*[numBands];
-            GDALRasterBand **outputRasterBands = new GDALRasterBand*[numBands];
-            unsigned int *data = new unsigned int[width];
-            
-            for(unsigned int n = 0; n < numBands; ++n)
-            {
-                inputRasterBands[n] = inData->GetRasterBand(n+1);
-                outputRasterBands[n] = outData->GetRasterBand(n+1);
-            }
-            
-            for(unsigned long y = 0; y < height; ++y)
-            {
-                for(unsigned int n = 0; n < numBands; ++n)
-                {
-                    inputRasterBands[n]->RasterIO(GF_Read, 0, y, width, 1, data, width, 1, GDT_UInt32, 0, 0);
-                    outputRasterBands[n]->RasterIO(GF_Write, 0, y, width, 1, data, width, 1, GDT_UInt32, 0, 0);
-                }
-            }
-            
-            delete[] inputRasterBands;
-            delete[] outputRasterBands;
-            delete[] data;
+            RSGISImageBlockCopy blockCopy;
+            blockCopy.copyDataset(inData, outData, GDT_UInt32);
         }
         catch(RSGISImageException &e)
         {
@@ -4598,32 +4485,8 @@ namespace rsgis{namespace img{
                 throw RSGISImageException("Number of bands are not the same");
             }
             
-            unsigned long width = inData->GetRasterXSize();
-            unsigned long height = inData->GetRasterYSize();
-            unsigned int numBands = inData->GetRasterCount();
-            
-            GDALRasterBand **inputRasterBands = new GDALRasterBand*[numBands];
-            GDALRasterBand **outputRasterBands = new GDALRasterBand*[numBands];
-            float *data = new float[width];
-            
-            for(unsigned int n = 0; n < numBands; ++n)
-            {
-                inputRasterBands[n] = inData->GetRasterBand(n+1);
-                outputRasterBands[n] = outData->GetRasterBand(n+1);
-            }
-            
-            for(unsigned long y = 0; y < height; ++y)
-            {
-                for(unsigned int n = 0; n < numBands; ++n)
-                {
-                    inputRasterBands[n]->RasterIO(GF_Read, 0, y, width, 1, data, width, 1, GDT_Float32, 0, 0);
-                    outputRasterBands[n]->RasterIO(GF_Write, 0, y, width, 1, data, width, 1, GDT_Float32, 0, 0);
-                }
-            }
-            
-            delete[] inputRasterBands;
-            delete[] outputRasterBands;
-            delete[] data;
+            RSGISImageBlockCopy blockCopy;
+            blockCopy.copyDataset(inData, outData, GDT_Float32);
         }
         catch(RSGISImageException &e)
         {
@@ -4649,32 +4512,8 @@ namespace rsgis{namespace img{
                 throw RSGISImageException("Number of bands are not the same");
             }
             
-            unsigned long width = inData->GetRasterXSize();
-            unsigned long height = inData->GetRasterYSize();
-            unsigned int numBands = inData->GetRasterCount();
-            
-            GDALRasterBand **inputRasterBands = new GDALRasterBand*[numBands];
-            GDALRasterBand **outputRasterBands = new GDALRasterBand*[numBands];
-            int *data = new int[width];
-            
-            for(unsigned int n = 0; n < numBands; ++n)
-            {
-                inputRasterBands[n] = inData->GetRasterBand(n+1);
-                outputRasterBands[n] = outData->GetRasterBand(n+1);
-            }
-            
-            for(unsigned long y = 0; y < height; ++y)
-            {
-                for(unsigned int n = 0; n < numBands; ++n)
-                {
-                    inputRasterBands[n]->RasterIO(GF_Read, 0, y, width, 1, data, width, 1, GDT_Byte, 0, 0);
-                    outputRasterBands[n]->RasterIO(GF_Write, 0, y, width, 1, data, width, 1, GDT_Byte, 0, 0);
-                }
-            }
-            
-            delete[] inputRasterBands;
-            delete[] outputRasterBands;
-            delete[] data;
+            RSGISImageBlockCopy blockCopy;
+            blockCopy.copyDataset(inData, outData, GDT_Byte);
         }
         catch(RSGISImageException &e)
         {
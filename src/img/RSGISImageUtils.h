@@ -36,6 +36,7 @@
 #include "common/rsgis-tqdm.h"
 
 #include "img/RSGISImageBandException.h"
+#include "img/RSGISImageBlockCopy.h"
 
 #include "math/RSGISMathsUtils.h"
 
@@ -198,6 +199,12 @@ namespace rsgis
                 GDALDataset* createCopy(GDALDataset **datasets, int numDS, unsigned int numBands, std::string outputFilePath, std::string outputFormat, GDALDataType eType, bool useImgProj=true, std::string proj="");
                 void createKMLText(std::string inputImage, std::string outKMLFile);
                 bool closeResTest(double baseRes, double targetRes);
+                /**
+                 * Single pixel access. There is no state kept between calls so these do not
+                 * use RSGISImageTileCache (a tile would be decoded for every pixel); repeated
+                 * calls are served by the GDAL block cache. Code looping over many pixels
+                 * should hold a RSGISImageTileCache instead.
+                 */
                 double getPixelValue(GDALDataset *image, unsigned int imgBand, double xLoc, double yLoc);
                 double getPixelValue(GDALDataset *image, unsigned int imgBand, unsigned int xPxl, unsigned int yPxl);
                 void setPixelValue(GDALDataset *image, unsigned int imgBand, unsigned int xPxl, unsigned int yPxl, double val);
@@ -60,29 +60,9 @@ namespace rsgis{namespace img{
                 throw RSGISImageCalcException("The number of endmember samples should be less than the number of input image bands.");
             }
             
-            gsl_matrix *V = gsl_matrix_alloc (endmembers->size2, endmembers->size2);
-            gsl_vector *S = gsl_vector_alloc(endmembers->size2);
-            gsl_vector *work = gsl_vector_alloc(endmembers->size2);
-            int status = gsl_linalg_SV_decomp(endmembers, V, S, work);
-            if(status != 0)
-            {
-                throw RSGISImageCalcException(gsl_strerror(status));
-            }
-            
-            gsl_vector *b = gsl_vector_alloc(endmembers->size1);
-            gsl_vector *x = gsl_vector_alloc(endmembers->size2);
-            
-            RSGISUnconstrainedLinearSpectralUnmixing *calcUnconstrained = new RSGISUnconstrainedLinearSpectralUnmixing(endmembers->size2, endmembers, V, S, work, b, x, this->gain, this->offset);
-            RSGISCalcImage calcImage(calcUnconstrained);
-            calcImage.calcImage(datasets, numDatasets, outputImage, false, NULL, gdalFormat, gdalDataType);
-            
+            RSGISBatchLinearSpectralUnmixing unmixing(endmembers);
             gsl_matrix_free(endmembers);
-            gsl_matrix_free(V);
-            gsl_vector_free(S);
-            gsl_vector_free(work);
-            gsl_vector_free(b);
-            gsl_vector_free(x);
-            
+            unmixing.unmixImage(datasets, numDatasets, outputImage, this->gdalFormat, this->gdalDataType, this->gain, this->offset);
         }
         catch(RSGISException &e)
         {
@@ -118,45 +98,9 @@ namespace rsgis{namespace img{
                 throw RSGISImageCalcException("The number of endmember samples should be less than the number of input image bands.");
             }
             
-            
-            gsl_matrix *endmembers = gsl_matrix_alloc (endmembersIn->size1+1, endmembersIn->size2);
-            for(unsigned int i = 0; i < endmembersIn->size1; ++i)
-            {
-                for(unsigned int j = 0; j < endmembersIn->size2; ++j)
-                {
-                    gsl_matrix_set(endmembers, i, j, gsl_matrix_get(endmembersIn, i, j));
-                }
-            }
-            for(unsigned int j = 0; j < endmembersIn->size2; ++j)
-            {
-                gsl_matrix_set(endmembers, endmembersIn->size1, j, weight);
-            }
-            
-            
-            gsl_matrix *V = gsl_matrix_alloc (endmembers->size2, endmembers->size2);
-            gsl_vector *S = gsl_vector_alloc(endmembers->size2);
-            gsl_vector *work = gsl_vector_alloc(endmembers->size2);
-            int status = gsl_linalg_SV_decomp(endmembers, V, S, work);
-            if(status != 0)
-            {
-                throw RSGISImageCalcException(gsl_strerror(status));
-            }
-            
-            gsl_vector *b = gsl_vector_alloc(endmembers->size1);
-            gsl_vector *x = gsl_vector_alloc(endmembers->size2);
-            
-            RSGISPartConstrainedLinearSpectralUnmixing *calcPartConstrained = new RSGISPartConstrainedLinearSpectralUnmixing(endmembers->size2, weight, endmembers, V, S, work, b, x, this->gain, this->offset);
-            RSGISCalcImage calcImage(calcPartConstrained);
-            calcImage.calcImage(datasets, numDatasets, outputImage, false, NULL, gdalFormat, gdalDataType);
-            
+            RSGISBatchLinearSpectralUnmixing unmixing(endmembersIn, true, weight);
             gsl_matrix_free(endmembersIn);
-            gsl_matrix_free(endmembers);
-            gsl_matrix_free(V);
-            gsl_vector_free(S);
-            gsl_vector_free(work);
-            gsl_vector_free(b);
-            gsl_vector_free(x);
-            
+            unmixing.unmixImage(datasets, numDatasets, outputImage, this->gdalFormat, this->gdalDataType, this->gain, this->offset);
         }
         catch(RSGISException &e)
         {
@@ -174,7 +118,6 @@ namespace rsgis{namespace img{
                 numOfImageBands += datasets[i]->GetRasterCount();
             }            
             
-            rsgis::math::RSGISVectors vecUtils;
             rsgis::math::RSGISMatrices matrixUtils;
             gsl_matrix *endmembersIn = matrixUtils.readGSLMatrixFromTxt(endmembersFilePath);
             matrixUtils.printGSLMatrix(endmembersIn);
@@ -182,6 +125,7 @@ namespace rsgis{namespace img{
             
             if(endmembersIn->size1 != numOfImageBands)
             {
+                gsl_matrix_free(endmembersIn);
                 throw RSGISImageCalcException("The number of image bands and wavelengths within the endmemebers should match.");
             }
             
@@ -190,93 +134,10 @@ namespace rsgis{namespace img{
                 gsl_matrix_free(endmembersIn);
                 throw RSGISImageCalcException("The number of endmember samples should be less than the number of input image bands.");
             }
-                                    
-            int m = endmembersIn->size1+1;
-            int n = endmembersIn->size2;
-            
-            std::cout << "m = " << m << std::endl;
-            std::cout << "n = " << n << std::endl;
             
-            int mda = m;
-            
-            double* a = new double[m*n];
-            double *b = new double[m];
-            double *x = new double[n];
-            double rNorm = 0;
-            double *w = new double[n];
-            double *zz = new double[m];
-            int *index = new int[n];
-            int mode = 0;
-            
-            for(unsigned int i = 0; i < endmembersIn->size1; ++i)
-            {
-                for(unsigned int j = 0; j < endmembersIn->size2; ++j)
-                {
-                    a[(i*endmembersIn->size2)+j] = gsl_matrix_get(endmembersIn, i, j);
-                }
-            }
-            for(unsigned int j = 0; j < endmembersIn->size2; ++j)
-            {
-                a[(endmembersIn->size1*endmembersIn->size2)+j] = weight;
-            }
-            
-            for(unsigned int i = 0; i < m; ++i)
-            {
-                for(unsigned int j = 0; j < n; ++j)
-                {
-                    if( j == 0 )
-                    {
-                        std::cout << a[(i*n)+j];
-                    }
-                    else
-                    {
-                        std::cout << "," << a[(i*n)+j];
-                    }
-                }
-                std::cout << "\n";
-            }
-            
-            float e1 = 0.5;
-            float e2 = 0.2;
-            float e3 = 0.3;
-            b[0] = ((50.4*e1)+(29.45*e2)+(209.964*e3));
-            b[1] = ((81.85*e1)+(65.45*e2)+(244.321*e3));
-            b[2] = ((107.85*e1)+(23.4*e2)+(267.25*e3));
-            b[3] = ((177.1*e1)+(112.8*e2)+(278.679*e3));
-            b[4] = ((281.35*e1)+(524.2*e2)+(305.429*e3));
-            b[5] = ((324.2*e1)+(653.25*e2)+(299.036*e3));
-            b[6] = ((362.45*e1)+(680.6*e2)+(309.036*e3));
-            b[7] = ((394.55*e1)+(692.25*e2)+(303.036*e3));
-            b[8] = ((404.55*e1)+(258.6*e2)+(301.143*e3));
-            b[9] = ((237.25*e1)+(114.35*e2)+(273.643*e3));
-            b[10] = weight;
-            
-            /*
-            50.4,29.45,209.964
-            81.85,65.45,244.321
-            107.85,23.4,267.25
-            177.1,112.8,278.679
-             281.35,524.2,305.429
-             324.2,653.25,299.036
-             362.45,680.6,309.036
-             394.55,692.25,303.036
-             404.55,258.6,301.143
-             237.25,114.35,273.643
-            */
-            std::cout << "B: [" << b[0] << "," << b[1] << "," << b[2] << "," << b[3] << "," << b[4] << "," << b[5] << "," << b[6] << "," << b[7] << "," << b[8] << "," << b[9] << "," << b[10] << "]\n";
-            
-            rsgis::math::RSGISNNLS nnls;
-            
-            //double* a, int* mda, int* m, int* n, double* b, double* x, double* rnorm, double* w, double* zz, int* index, int* mode
-            
-            int outVal = nnls.nnls_c(a, &mda, &m, &n, b, x, &rNorm, w, zz, index, &mode); 
-            std::cout << "outVal = " << outVal << std::endl;
-            std::cout << "rNorm = " << rNorm << std::endl;
-            std::cout << "mode = " << mode << std::endl;
-            
-            std::cout << "E: [" << e1 << "," << e2 << "," << e3 << "]\n";
-            std::cout << "X: [" << x[0] << "," << x[1] << "," << x[2] << "]\n";
-                        
+            RSGISBatchLinearSpectralUnmixing unmixing(endmembersIn, true, weight, true);
+            gsl_matrix_free(endmembersIn);
+            unmixing.unmixImage(datasets, numDatasets, outputImage, this->gdalFormat, this->gdalDataType, this->gain, this->offset);
         }
         catch(RSGISException &e)
         {
@@ -457,6 +318,23 @@ namespace rsgis{namespace img{
         this->numOfEndMembers = endmembers->size2;
         this->gain = gain;
         this->offset = offset;
+        
+        // Gram matrix of the endmembers so the distance of each candidate
+        // abundance vector is independent of the number of bands.
+        for(unsigned int i = 0; i < 3; ++i)
+        {
+            for(unsigned int j = 0; j < 3; ++j)
+            {
+                this->emGram[i][j] = 0.0;
+                if((i < this->numOfEndMembers) && (j < this->numOfEndMembers))
+                {
+                    for(unsigned int b = 0; b < endmembers->size1; ++b)
+                    {
+                        this->emGram[i][j] += gsl_matrix_get(endmembers, b, i) * gsl_matrix_get(endmembers, b, j);
+                    }
+                }
+            }
+        }
     }
     
     void RSGISExhaustiveLinearSpectralUnmixing::calcImageValue(float *bandValues, int numBands, double *output) 
@@ -473,8 +351,6 @@ namespace rsgis{namespace img{
         
         float threshold = 1 + this->stepRes;
         
-        float *normBandVals = new float[numBands];
-        
         double sqSum = 0;
         for(int i = 0; i < numBands; ++i)
         {
@@ -483,6 +359,22 @@ namespace rsgis{namespace img{
         
         float normVal = sqrt(sqSum);
         
+        // Dot products of the endmembers with the normalised spectra.
+        double emDotSpectra[3] = {0.0, 0.0, 0.0};
+        double normSqSum = 0.0;
+        if(normVal > 0)
+        {
+            for(int i = 0; i < numBands; ++i)
+            {
+                float normBandVal = bandValues[i]/normVal;
+                normSqSum += normBandVal * normBandVal;
+                for(unsigned int j = 0; (j < this->numOfEndMembers) && (j < 3); ++j)
+                {
+                    emDotSpectra[j] += gsl_matrix_get(endmembers, i, j) * normBandVal;
+                }
+            }
+        }
+        
         if(this->numOfEndMembers == 2)
         {
             float em1Val = 0;
@@ -496,11 +388,6 @@ namespace rsgis{namespace img{
             
             if( normVal > 0)
             {
-                for(int i = 0; i < numBands; ++i)
-                {
-                    normBandVals[i] = bandValues[i]/normVal;
-                }
-                
                 for(unsigned int i = 0; i < numOfSteps; ++i)
                 {
                     em2Val = 0;
@@ -508,7 +395,7 @@ namespace rsgis{namespace img{
                     {
                         if((em1Val+em2Val) < threshold)
                         {
-                            distVal = this->calcDistance2MeasuredSpectra(em1Val, em2Val, normBandVals, numBands);
+                            distVal = this->calcDistance2MeasuredSpectra(em1Val, em2Val, emDotSpectra, normSqSum, numBands);
                             
                             if(first)
                             {
@@ -558,11 +445,6 @@ namespace rsgis{namespace img{
                         
             if( normVal > 0)
             {
-                for(int i = 0; i < numBands; ++i)
-                {
-                    normBandVals[i] = bandValues[i]/normVal;
-                }
-                
                 for(unsigned int i = 0; i < numOfSteps; ++i)
                 {
                     em2Val = 0;
@@ -573,7 +455,7 @@ namespace rsgis{namespace img{
                         {
                             if((em1Val+em2Val+em3Val) < threshold)
                             {
-                                distVal = this->calcDistance2MeasuredSpectra(em1Val, em2Val, em3Val, normBandVals, numBands);
+                                distVal = this->calcDistance2MeasuredSpectra(em1Val, em2Val, em3Val, emDotSpectra, normSqSum, numBands);
                                 
                                 if(first)
                                 {
@@ -618,56 +500,482 @@ namespace rsgis{namespace img{
         {
             throw RSGISImageCalcException("Unmixing is only implemented for 3 endmembers.");
         }
-                
-        delete[] normBandVals;
     }
     
-    float RSGISExhaustiveLinearSpectralUnmixing::calcDistance2MeasuredSpectra(float em1Val, float em2Val, float em3Val, float *normSpectra, unsigned int numBands) 
+    float RSGISExhaustiveLinearSpectralUnmixing::calcDistance2MeasuredSpectra(float em1Val, float em2Val, float em3Val, const double *emDotSpectra, double spectraSqSum, unsigned int numBands) 
     {
-        float *genSpectra = new float[numBands];
-        for(unsigned int i = 0; i < numBands; ++i)
+        // ||Ea - s||^2 = a'Ga - 2a'(E's) + s's
+        double emVals[3] = {em1Val, em2Val, em3Val};
+        double errorVal = spectraSqSum;
+        for(unsigned int i = 0; i < 3; ++i)
         {
-            genSpectra[i] = (gsl_matrix_get(endmembers, i, 0) * em1Val) + (gsl_matrix_get(endmembers, i, 1) * em2Val) + (gsl_matrix_get(endmembers, i, 2) * em3Val);
+            errorVal -= 2 * emVals[i] * emDotSpectra[i];
+            for(unsigned int j = 0; j < 3; ++j)
+            {
+                errorVal += emVals[i] * this->emGram[i][j] * emVals[j];
+            }
         }
+        if(errorVal < 0)
+        {
+            errorVal = 0;
+        }
+        
+        return sqrt(errorVal/numBands);
+    }
+    
+    float RSGISExhaustiveLinearSpectralUnmixing::calcDistance2MeasuredSpectra(float em1Val, float em2Val, const double *emDotSpectra, double spectraSqSum, unsigned int numBands) 
+    {
+        return this->calcDistance2MeasuredSpectra(em1Val, em2Val, 0.0, emDotSpectra, spectraSqSum, numBands);
+    }
+    
+    RSGISExhaustiveLinearSpectralUnmixing::~RSGISExhaustiveLinearSpectralUnmixing()
+    {
+        
+    }
+    
+    
+    RSGISBatchLinearSpectralUnmixing::RSGISBatchLinearSpectralUnmixing(gsl_matrix *endmembers, bool sumToOne, float weight, bool nonNegative)
+    {
+        this->numBands = endmembers->size1;
+        this->numEndmembers = endmembers->size2;
+        this->sumToOne = sumToOne;
+        this->weight = weight;
+        this->nonNegative = nonNegative;
         
-        float errorVal = 0;
-        for(unsigned int i = 0; i < numBands; ++i)
+        unsigned int numRows = this->numBands + (sumToOne?1:0);
+        if(this->numEndmembers >= numRows)
         {
-            errorVal += ((genSpectra[i] - normSpectra[i])*(genSpectra[i] - normSpectra[i]));
+            throw RSGISImageCalcException("The number of endmember samples should be less than the number of input image bands.");
         }
         
-        delete[] genSpectra;
+        unsigned int n = this->numEndmembers;
+        this->emMatrix.resize(((size_t)this->numBands) * n);
+        gsl_matrix *U = gsl_matrix_alloc(numRows, n);
+        for(unsigned int i = 0; i < numRows; ++i)
+        {
+            for(unsigned int j = 0; j < n; ++j)
+            {
+                double val = (i < this->numBands)?gsl_matrix_get(endmembers, i, j):this->weight;
+                gsl_matrix_set(U, i, j, val);
+                if(i < this->numBands)
+                {
+                    this->emMatrix[(i*n)+j] = val;
+                }
+            }
+        }
         
-        errorVal = sqrt(errorVal/numBands);
+        // Gram matrix of the (augmented) endmembers for the NNLS.
+        this->gramMatrix.assign(n*n, 0.0);
+        for(unsigned int i = 0; i < numRows; ++i)
+        {
+            for(unsigned int j = 0; j < n; ++j)
+            {
+                for(unsigned int k = 0; k < n; ++k)
+                {
+                    this->gramMatrix[(j*n)+k] += gsl_matrix_get(U, i, j) * gsl_matrix_get(U, i, k);
+                }
+            }
+        }
         
-        return errorVal;
+        // Pseudo-inverse V S^-1 U^T, ignoring numerically zero singular values.
+        gsl_matrix *V = gsl_matrix_alloc(n, n);
+        gsl_vector *S = gsl_vector_alloc(n);
+        gsl_vector *work = gsl_vector_alloc(n);
+        int status = gsl_linalg_SV_decomp(U, V, S, work);
+        if(status != 0)
+        {
+            gsl_matrix_free(U);
+            gsl_matrix_free(V);
+            gsl_vector_free(S);
+            gsl_vector_free(work);
+            throw RSGISImageCalcException(gsl_strerror(status));
+        }
+        double svTol = gsl_vector_get(S, 0) * numRows * std::numeric_limits<double>::epsilon();
+        this->pinvMatrix.assign(((size_t)n) * this->numBands, 0.0);
+        this->pinvWeight.assign(n, 0.0);
+        for(unsigned int e = 0; e < n; ++e)
+        {
+            for(unsigned int r = 0; r < numRows; ++r)
+            {
+                double val = 0.0;
+                for(unsigned int k = 0; k < n; ++k)
+                {
+                    double sv = gsl_vector_get(S, k);
+                    if(sv > svTol)
+                    {
+                        val += gsl_matrix_get(V, e, k) * gsl_matrix_get(U, r, k) / sv;
+                    }
+                }
+                if(r < this->numBands)
+                {
+                    this->pinvMatrix[(((size_t)e) * this->numBands) + r] = val;
+                }
+                else
+                {
+                    this->pinvWeight[e] = val * this->weight;
+                }
+            }
+        }
+        gsl_matrix_free(U);
+        gsl_matrix_free(V);
+        gsl_vector_free(S);
+        gsl_vector_free(work);
     }
     
-    float RSGISExhaustiveLinearSpectralUnmixing::calcDistance2MeasuredSpectra(float em1Val, float em2Val, float *normSpectra, unsigned int numBands) 
+    void RSGISBatchLinearSpectralUnmixing::unmixPixels(const double *pxlVals, size_t numPxls, double *abundances)
     {
-        float *genSpectra = new float[numBands];
-        for(unsigned int i = 0; i < numBands; ++i)
+        if(numPxls == 0)
         {
-            genSpectra[i] = (gsl_matrix_get(endmembers, i, 0) * em1Val) + (gsl_matrix_get(endmembers, i, 1) * em2Val);
+            return;
         }
+        unsigned int n = this->numEndmembers;
+        gsl_matrix_const_view pxlsView = gsl_matrix_const_view_array(pxlVals, this->numBands, numPxls);
+        gsl_matrix_view outView = gsl_matrix_view_array(abundances, n, numPxls);
         
-        float errorVal = 0;
-        for(unsigned int i = 0; i < numBands; ++i)
+        if(!this->nonNegative)
         {
-            errorVal += ((genSpectra[i] - normSpectra[i])*(genSpectra[i] - normSpectra[i]));
+            gsl_matrix_const_view pinvView = gsl_matrix_const_view_array(this->pinvMatrix.data(), n, this->numBands);
+            gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, &pinvView.matrix, &pxlsView.matrix, 0.0, &outView.matrix);
+            if(this->sumToOne)
+            {
+                for(unsigned int e = 0; e < n; ++e)
+                {
+                    double *outRow = abundances + (((size_t)e) * numPxls);
+                    for(size_t p = 0; p < numPxls; ++p)
+                    {
+                        outRow[p] += this->pinvWeight[e];
+                    }
+                }
+            }
         }
-                
-        delete[] genSpectra;
+        else
+        {
+            // A^T b for every pixel as one product, then NNLS per pixel on the Gram matrix.
+            gsl_matrix_const_view emView = gsl_matrix_const_view_array(this->emMatrix.data(), this->numBands, n);
+            gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, &emView.matrix, &pxlsView.matrix, 0.0, &outView.matrix);
+            
+            std::vector<double> atb(n);
+            std::vector<double> x(n);
+            std::vector<char> passive(n, 0);
+            std::vector<double> work;
+            std::vector<unsigned int> idxWork;
+            double weightSq = this->sumToOne?(this->weight * this->weight):0.0;
+            for(size_t p = 0; p < numPxls; ++p)
+            {
+                for(unsigned int e = 0; e < n; ++e)
+                {
+                    atb[e] = abundances[(((size_t)e) * numPxls) + p] + weightSq;
+                }
+                this->solveNNLS(atb.data(), &passive, x.data(), &work, &idxWork);
+                for(unsigned int e = 0; e < n; ++e)
+                {
+                    abundances[(((size_t)e) * numPxls) + p] = x[e];
+                }
+            }
+        }
+    }
+    
+    void RSGISBatchLinearSpectralUnmixing::unmixImage(GDALDataset **datasets, int numDatasets, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType, float gain, float offset, unsigned int numThreads)
+    {
+        try
+        {
+            unsigned int numOfImageBands = 0;
+            for(int i = 0; i < numDatasets; ++i)
+            {
+                numOfImageBands += datasets[i]->GetRasterCount();
+            }
+            if(numOfImageBands != this->numBands)
+            {
+                throw RSGISImageCalcException("The number of image bands and wavelengths within the endmemebers should match.");
+            }
+            
+            RSGISImageUtils imgUtils;
+            int **dsOffsets = new int*[numDatasets];
+            for(int i = 0; i < numDatasets; ++i)
+            {
+                dsOffsets[i] = new int[2];
+            }
+            int width = 0;
+            int height = 0;
+            double *gdalTranslation = new double[6];
+            imgUtils.getImageOverlap(datasets, numDatasets, dsOffsets, &width, &height, gdalTranslation);
+            delete[] gdalTranslation;
+            
+            GDALDataset *outDS = imgUtils.createCopy(datasets, numDatasets, this->numEndmembers, outputImage, gdalFormat, gdalDataType);
+            
+            int xBlockSize = 0;
+            int yBlockSize = 0;
+            datasets[0]->GetRasterBand(1)->GetBlockSize(&xBlockSize, &yBlockSize);
+            unsigned int stripRows = yBlockSize;
+            while((((size_t)stripRows) * width) < 65536)
+            {
+                stripRows += yBlockSize;
+            }
+            size_t numStrips = (height + stripRows - 1) / stripRows;
+            
+            RSGISImageThreadUtils threadUtils;
+            numThreads = threadUtils.getNumThreads(numThreads);
+            std::vector<std::vector<GDALDataset*> > handles(numDatasets);
+            for(int i = 0; i < numDatasets; ++i)
+            {
+                handles[i] = threadUtils.openDatasetHandles(datasets[i], numThreads);
+                numThreads = std::min(numThreads, (unsigned int)handles[i].size());
+            }
+            
+            std::mutex writeMutex;
+            try
+            {
+                threadUtils.runTasks(numThreads, numStrips, [&](unsigned int threadIdx, size_t strip)
+                {
+                    unsigned int startRow = strip * stripRows;
+                    unsigned int numStripRows = std::min(stripRows, ((unsigned int)height) - startRow);
+                    size_t numPxls = ((size_t)width) * numStripRows;
+                    
+                    std::vector<double> pxlVals(numPxls * this->numBands);
+                    unsigned int bandIdx = 0;
+                    for(int i = 0; i < numDatasets; ++i)
+                    {
+                        GDALDataset *ds = handles[i][threadIdx];
+                        for(int b = 1; b <= ds->GetRasterCount(); ++b)
+                        {
+                            if(ds->GetRasterBand(b)->RasterIO(GF_Read, dsOffsets[i][0], dsOffsets[i][1] + startRow, width, numStripRows, &pxlVals[bandIdx * numPxls], width, numStripRows, GDT_Float64, 0, 0) != CE_None)
+                            {
+                                throw RSGISImageCalcException("Failed to read the input image.");
+                            }
+                            ++bandIdx;
+                        }
+                    }
+                    
+                    std::vector<double> abundances(numPxls * this->numEndmembers);
+                    this->unmixPixels(pxlVals.data(), numPxls, abundances.data());
+                    for(std::vector<double>::iterator iterVals = abundances.begin(); iterVals != abundances.end(); ++iterVals)
+                    {
+                        *iterVals = offset + ((*iterVals) * gain);
+                    }
+                    
+                    std::lock_guard<std::mutex> lock(writeMutex);
+                    for(unsigned int e = 0; e < this->numEndmembers; ++e)
+                    {
+                        if(outDS->GetRasterBand(e+1)->RasterIO(GF_Write, 0, startRow, width, numStripRows, &abundances[e * numPxls], width, numStripRows, GDT_Float64, 0, 0) != CE_None)
+                        {
+                            throw RSGISImageCalcException("Failed to write the output image.");
+                        }
+                    }
+                });
+            }
+            catch(RSGISImageCalcException &e)
+            {
+                for(int i = 0; i < numDatasets; ++i)
+                {
+                    threadUtils.closeDatasetHandles(&handles[i]);
+                    delete[] dsOffsets[i];
+                }
+                delete[] dsOffsets;
+                GDALClose(outDS);
+                throw e;
+            }
+            
+            for(int i = 0; i < numDatasets; ++i)
+            {
+                threadUtils.closeDatasetHandles(&handles[i]);
+                delete[] dsOffsets[i];
+            }
+            delete[] dsOffsets;
+            GDALClose(outDS);
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            throw e;
+        }
+        catch(RSGISException &e)
+        {
+            throw RSGISImageCalcException(e.what());
+        }
+    }
+    
+    void RSGISBatchLinearSpectralUnmixing::solveNNLS(const double *atb, std::vector<char> *passive, double *x, std::vector<double> *work, std::vector<unsigned int> *idxWork)
+    {
+        unsigned int n = this->numEndmembers;
+        work->resize((n*n) + (3*n));
+        idxWork->resize(n);
+        double *z = work->data() + (n*n) + n;
+        double *w = z + n;
         
-        errorVal = sqrt(errorVal/numBands);
+        double maxATB = 0.0;
+        for(unsigned int i = 0; i < n; ++i)
+        {
+            x[i] = 0.0;
+            maxATB = std::max(maxATB, fabs(atb[i]));
+        }
+        double tol = 1e-10 * (1.0 + maxATB);
         
-        return errorVal;
+        // Warm start from the passive set of the previous pixel if it gives a feasible solution.
+        bool warmStart = false;
+        for(unsigned int i = 0; i < n; ++i)
+        {
+            warmStart = warmStart || (*passive)[i];
+        }
+        if(warmStart)
+        {
+            bool feasible = this->solvePassiveSet(atb, *passive, z, work, idxWork);
+            for(unsigned int i = 0; (i < n) && feasible; ++i)
+            {
+                feasible = (!(*passive)[i]) || (z[i] > 0);
+            }
+            if(feasible)
+            {
+                for(unsigned int i = 0; i < n; ++i)
+                {
+                    x[i] = z[i];
+                }
+            }
+            else
+            {
+                passive->assign(n, 0);
+            }
+        }
+        
+        for(unsigned int iter = 0; iter < (3*n); ++iter)
+        {
+            // Gradient of the objective; stop when no active variable would improve it.
+            int maxIdx = -1;
+            double maxW = tol;
+            for(unsigned int i = 0; i < n; ++i)
+            {
+                w[i] = atb[i];
+                for(unsigned int j = 0; j < n; ++j)
+                {
+                    w[i] -= this->gramMatrix[(i*n)+j] * x[j];
+                }
+                if((!(*passive)[i]) && (w[i] > maxW))
+                {
+                    maxW = w[i];
+                    maxIdx = i;
+                }
+            }
+            if(maxIdx < 0)
+            {
+                break;
+            }
+            (*passive)[maxIdx] = 1;
+            
+            for(unsigned int inner = 0; inner < (3*n); ++inner)
+            {
+                if(!this->solvePassiveSet(atb, *passive, z, work, idxWork))
+                {
+                    (*passive)[maxIdx] = 0;
+                    return;
+                }
+                
+                // Step towards z until the first passive variable reaches zero.
+                double alpha = 2.0;
+                int alphaIdx = -1;
+                for(unsigned int i = 0; i < n; ++i)
+                {
+                    if((*passive)[i] && (z[i] <= 0))
+                    {
+                        double stepVal = x[i] / (x[i] - z[i]);
+                        if(stepVal < alpha)
+                        {
+                            alpha = stepVal;
+                            alphaIdx = i;
+                        }
+                    }
+                }
+                if(alphaIdx < 0)
+                {
+                    for(unsigned int i = 0; i < n; ++i)
+                    {
+                        x[i] = z[i];
+                    }
+                    break;
+                }
+                
+                for(unsigned int i = 0; i < n; ++i)
+                {
+                    if((*passive)[i])
+                    {
+                        x[i] += alpha * (z[i] - x[i]);
+                        if((x[i] <= 0) || (((int)i) == alphaIdx))
+                        {
+                            x[i] = 0.0;
+                            (*passive)[i] = 0;
+                        }
+                    }
+                }
+            }
+        }
     }
     
-    RSGISExhaustiveLinearSpectralUnmixing::~RSGISExhaustiveLinearSpectralUnmixing()
+    bool RSGISBatchLinearSpectralUnmixing::solvePassiveSet(const double *atb, const std::vector<char> &passive, double *z, std::vector<double> *work, std::vector<unsigned int> *idxWork)
     {
+        unsigned int n = this->numEndmembers;
+        double *a = work->data();
+        double *rhs = a + (n*n);
+        unsigned int *idxs = idxWork->data();
+        
+        unsigned int k = 0;
+        for(unsigned int i = 0; i < n; ++i)
+        {
+            z[i] = 0.0;
+            if(passive[i])
+            {
+                idxs[k++] = i;
+            }
+        }
+        for(unsigned int r = 0; r < k; ++r)
+        {
+            unsigned int gi = idxs[r];
+            for(unsigned int c = 0; c < k; ++c)
+            {
+                a[(r*k)+c] = this->gramMatrix[(gi*n)+idxs[c]];
+            }
+            rhs[r] = atb[gi];
+        }
         
+        // Gaussian elimination with partial pivoting on the passive block of the Gram matrix.
+        for(unsigned int c = 0; c < k; ++c)
+        {
+            unsigned int pivot = c;
+            for(unsigned int r = c+1; r < k; ++r)
+            {
+                if(fabs(a[(r*k)+c]) > fabs(a[(pivot*k)+c]))
+                {
+                    pivot = r;
+                }
+            }
+            if(fabs(a[(pivot*k)+c]) <= (std::numeric_limits<double>::epsilon() * fabs(this->gramMatrix[(idxs[c]*n)+idxs[c]])))
+            {
+                return false;
+            }
+            if(pivot != c)
+            {
+                for(unsigned int j = 0; j < k; ++j)
+                {
+                    std::swap(a[(c*k)+j], a[(pivot*k)+j]);
+                }
+                std::swap(rhs[c], rhs[pivot]);
+            }
+            for(unsigned int r = c+1; r < k; ++r)
+            {
+                double f = a[(r*k)+c] / a[(c*k)+c];
+                for(unsigned int j = c; j < k; ++j)
+                {
+                    a[(r*k)+j] -= f * a[(c*k)+j];
+                }
+                rhs[r] -= f * rhs[c];
+            }
+        }
+        for(int r = ((int)k)-1; r >= 0; --r)
+        {
+            double val = rhs[r];
+            for(unsigned int j = r+1; j < k; ++j)
+            {
+                val -= a[(r*k)+j] * z[idxs[j]];
+            }
+            z[idxs[r]] = val / a[(r*k)+r];
+        }
+        return true;
     }
     
-    
 }}
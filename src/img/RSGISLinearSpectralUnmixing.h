@@ -27,10 +27,16 @@
 #include <string>
 #include <math.h>
 #include <stdlib.h>
+#include <vector>
+#include <mutex>
+#include <limits>
+#include <algorithm>
 
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISCalcImage.h"
+#include "img/RSGISImageUtils.h"
+#include "img/RSGISImageThreadUtils.h"
 
 #include "math/RSGISMatrices.h"
 #include "math/RSGISnnls.h"
@@ -149,9 +155,10 @@ namespace rsgis{namespace img{
         bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output) {throw RSGISImageCalcException("Not implemented");};
         ~RSGISExhaustiveLinearSpectralUnmixing();
     protected:
-        float calcDistance2MeasuredSpectra(float em1Val, float em2Val, float em3Val, float *normSpectra, unsigned int numBands);
-        float calcDistance2MeasuredSpectra(float em1Val, float em2Val, float *normSpectra, unsigned int numBands);
+        float calcDistance2MeasuredSpectra(float em1Val, float em2Val, float em3Val, const double *emDotSpectra, double spectraSqSum, unsigned int numBands);
+        float calcDistance2MeasuredSpectra(float em1Val, float em2Val, const double *emDotSpectra, double spectraSqSum, unsigned int numBands);
         gsl_matrix *endmembers;
+        double emGram[3][3];
         float stepRes;
         unsigned int numOfEndMembers;
         float gain;
@@ -159,6 +166,39 @@ namespace rsgis{namespace img{
     };
     
     
+    /**
+     * Linear spectral unmixing of blocks of pixels. The pseudo-inverse of the
+     * endmember matrix is calculated once (SVD) so the unconstrained and the
+     * weighted sum-to-one solutions for a block of pixels are a single matrix
+     * product. The non-negative solution uses an active set NNLS (Lawson and
+     * Hanson) on the endmember Gram matrix, warm started from the passive set
+     * of the previous pixel, which for neighbouring pixels is usually optimal
+     * without further iterations. As for the existing classes, sum-to-one is
+     * applied by appending a row of 'weight' to the endmembers and the pixel.
+     */
+    class DllExport RSGISBatchLinearSpectralUnmixing
+    {
+    public:
+        RSGISBatchLinearSpectralUnmixing(gsl_matrix *endmembers, bool sumToOne=false, float weight=1, bool nonNegative=false);
+        void unmixPixels(const double *pxlVals, size_t numPxls, double *abundances);
+        void unmixImage(GDALDataset **datasets, int numDatasets, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType, float gain=1, float offset=0, unsigned int numThreads=0);
+        unsigned int getNumBands() const {return this->numBands;};
+        unsigned int getNumEndmembers() const {return this->numEndmembers;};
+        ~RSGISBatchLinearSpectralUnmixing(){};
+    protected:
+        void solveNNLS(const double *atb, std::vector<char> *passive, double *x, std::vector<double> *work, std::vector<unsigned int> *idxWork);
+        bool solvePassiveSet(const double *atb, const std::vector<char> &passive, double *z, std::vector<double> *work, std::vector<unsigned int> *idxWork);
+        unsigned int numBands;
+        unsigned int numEndmembers;
+        bool sumToOne;
+        double weight;
+        bool nonNegative;
+        std::vector<double> pinvMatrix;
+        std::vector<double> pinvWeight;
+        std::vector<double> emMatrix;
+        std::vector<double> gramMatrix;
+    };
+    
 }}
 
 #endif
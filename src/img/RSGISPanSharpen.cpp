@@ -239,4 +239,390 @@ namespace rsgis { namespace img {
 		this->outStats[3] = sqrt(this->sumPAN / this->nPix);
 	}
 
+	RSGISHCSPanSharpenImages::RSGISHCSPanSharpenImages(GDALDataset *msImage, std::vector<unsigned int> msBands, GDALDataset *panImage, unsigned int panBand, unsigned int numThreads)
+	{
+		if(msBands.size() < 2)
+		{
+			throw RSGISImageCalcException("At least two multispectral bands are needed for HCS pan sharpening.");
+		}
+		for(std::vector<unsigned int>::iterator iterBands = msBands.begin(); iterBands != msBands.end(); ++iterBands)
+		{
+			if(((*iterBands) < 1) || ((*iterBands) > ((unsigned int)msImage->GetRasterCount())))
+			{
+				throw RSGISImageCalcException("A multispectral band is not within the multispectral image.");
+			}
+		}
+		if((panBand < 1) || (panBand > ((unsigned int)panImage->GetRasterCount())))
+		{
+			throw RSGISImageCalcException("The panchromatic band is not within the panchromatic image.");
+		}
+		
+		this->msImage = msImage;
+		this->msBands = msBands;
+		this->panImage = panImage;
+		this->panBand = panBand;
+		this->numThreads = numThreads;
+		this->width = panImage->GetRasterXSize();
+		this->height = panImage->GetRasterYSize();
+		
+		double panTrans[6];
+		double msTrans[6];
+		panImage->GetGeoTransform(panTrans);
+		msImage->GetGeoTransform(msTrans);
+		if((panTrans[2] != 0) || (panTrans[4] != 0) || (msTrans[2] != 0) || (msTrans[4] != 0))
+		{
+			throw RSGISImageCalcException("Rotated images are not supported for pan sharpening.");
+		}
+		
+		// Position of each pan pixel centre within the multispectral image in pixels, used for bilinear interpolation.
+		int msWidth = msImage->GetRasterXSize();
+		this->msCol0.resize(this->width);
+		this->msCol1.resize(this->width);
+		this->msColWeight.resize(this->width);
+		this->msColInside.resize(this->width);
+		for(int x = 0; x < this->width; ++x)
+		{
+			double msX = (((panTrans[0] + ((x + 0.5) * panTrans[1])) - msTrans[0]) / msTrans[1]) - 0.5;
+			this->msColInside[x] = (msX >= -0.5) && (msX <= (msWidth - 0.5));
+			int col0 = (int)floor(msX);
+			this->msColWeight[x] = msX - col0;
+			this->msCol0[x] = std::min(std::max(col0, 0), msWidth-1);
+			this->msCol1[x] = std::min(std::max(col0+1, 0), msWidth-1);
+		}
+		this->msRowScale = panTrans[5] / msTrans[5];
+		this->msRowOffset = (((panTrans[3] + (0.5 * panTrans[5])) - msTrans[3]) / msTrans[5]) - 0.5;
+	}
+	
+	int RSGISHCSPanSharpenImages::calcStripRows()
+	{
+		int xBlockSize = 0;
+		int yBlockSize = 0;
+		this->panImage->GetRasterBand(this->panBand)->GetBlockSize(&xBlockSize, &yBlockSize);
+		if(yBlockSize < 1)
+		{
+			yBlockSize = 1;
+		}
+		size_t numVals = ((size_t)this->width) * (this->msBands.size() + 1);
+		int stripRows = yBlockSize;
+		while(((((size_t)stripRows) * numVals) < 2097152) && (stripRows < this->height))
+		{
+			stripRows += yBlockSize;
+		}
+		return stripRows;
+	}
+	
+	void RSGISHCSPanSharpenImages::readStrip(GDALDataset *msDS, GDALDataset *panDS, int startRow, int numRows, std::vector<float> *msVals, std::vector<float> *panVals, std::vector<unsigned char> *validPxls)
+	{
+		unsigned int numMSBands = this->msBands.size();
+		size_t numPxls = ((size_t)this->width) * numRows;
+		int msWidth = msDS->GetRasterXSize();
+		int msHeight = msDS->GetRasterYSize();
+		
+		panVals->resize(numPxls);
+		if(panDS->GetRasterBand(this->panBand)->RasterIO(GF_Read, 0, startRow, this->width, numRows, panVals->data(), this->width, numRows, GDT_Float32, 0, 0) != CE_None)
+		{
+			throw RSGISImageCalcException("Failed to read the panchromatic image.");
+		}
+		
+		std::vector<int> row0(numRows);
+		std::vector<int> row1(numRows);
+		std::vector<float> rowWeight(numRows);
+		std::vector<unsigned char> rowInside(numRows);
+		int msStartRow = msHeight;
+		int msEndRow = -1;
+		for(int y = 0; y < numRows; ++y)
+		{
+			double msY = ((startRow + y) * this->msRowScale) + this->msRowOffset;
+			rowInside[y] = (msY >= -0.5) && (msY <= (msHeight - 0.5));
+			int r0 = (int)floor(msY);
+			rowWeight[y] = msY - r0;
+			row0[y] = std::min(std::max(r0, 0), msHeight-1);
+			row1[y] = std::min(std::max(r0+1, 0), msHeight-1);
+			msStartRow = std::min(msStartRow, row0[y]);
+			msEndRow = std::max(msEndRow, row1[y]);
+		}
+		int numMSRows = msEndRow - msStartRow + 1;
+		size_t numMSPxls = ((size_t)msWidth) * numMSRows;
+		
+		std::vector<float> msRows(numMSPxls * numMSBands);
+		for(unsigned int n = 0; n < numMSBands; ++n)
+		{
+			if(msDS->GetRasterBand(this->msBands[n])->RasterIO(GF_Read, 0, msStartRow, msWidth, numMSRows, &msRows[n * numMSPxls], msWidth, numMSRows, GDT_Float32, 0, 0) != CE_None)
+			{
+				throw RSGISImageCalcException("Failed to read the multispectral image.");
+			}
+		}
+		
+		msVals->resize(numPxls * numMSBands);
+		for(unsigned int n = 0; n < numMSBands; ++n)
+		{
+			const float *bandRows = &msRows[n * numMSPxls];
+			float *bandVals = &(*msVals)[n * numPxls];
+			for(int y = 0; y < numRows; ++y)
+			{
+				const float *rowA = &bandRows[((size_t)(row0[y] - msStartRow)) * msWidth];
+				const float *rowB = &bandRows[((size_t)(row1[y] - msStartRow)) * msWidth];
+				float wy = rowWeight[y];
+				float *outRow = &bandVals[((size_t)y) * this->width];
+				for(int x = 0; x < this->width; ++x)
+				{
+					float wx = this->msColWeight[x];
+					float top = rowA[this->msCol0[x]] + (wx * (rowA[this->msCol1[x]] - rowA[this->msCol0[x]]));
+					float bottom = rowB[this->msCol0[x]] + (wx * (rowB[this->msCol1[x]] - rowB[this->msCol0[x]]));
+					outRow[x] = top + (wy * (bottom - top));
+				}
+			}
+		}
+		
+		validPxls->resize(numPxls);
+		for(int y = 0; y < numRows; ++y)
+		{
+			for(int x = 0; x < this->width; ++x)
+			{
+				size_t idx = (((size_t)y) * this->width) + x;
+				(*validPxls)[idx] = rowInside[y] && this->msColInside[x] && ((*msVals)[idx] > 0) && !std::isnan((*panVals)[idx]);
+			}
+		}
+	}
+	
+	void RSGISHCSPanSharpenImages::calcStats(float *imageStats)
+	{
+		unsigned int numMSBands = this->msBands.size();
+		int stripRows = this->calcStripRows();
+		size_t numStrips = (this->height + stripRows - 1) / stripRows;
+		
+		RSGISImageThreadUtils threadUtils;
+		unsigned int nThreads = threadUtils.getNumThreads(this->numThreads);
+		std::vector<GDALDataset*> msHandles = threadUtils.openDatasetHandles(this->msImage, nThreads);
+		std::vector<GDALDataset*> panHandles = threadUtils.openDatasetHandles(this->panImage, nThreads);
+		nThreads = std::min(msHandles.size(), panHandles.size());
+		
+		// Count, mean and sum of squared differences of I^2 and P^2 for each strip, merged in strip order.
+		std::vector<double> stripN(numStrips, 0);
+		std::vector<double> stripMean(numStrips * 2, 0);
+		std::vector<double> stripM2(numStrips * 2, 0);
+		try
+		{
+			threadUtils.runTasks(nThreads, numStrips, [&](unsigned int threadIdx, size_t strip)
+			{
+				int startRow = strip * stripRows;
+				int numRows = std::min(stripRows, this->height - startRow);
+				size_t numPxls = ((size_t)this->width) * numRows;
+				std::vector<float> msVals;
+				std::vector<float> panVals;
+				std::vector<unsigned char> validPxls;
+				this->readStrip(msHandles[threadIdx], panHandles[threadIdx], startRow, numRows, &msVals, &panVals, &validPxls);
+				
+				double n = 0;
+				double meanMS = 0;
+				double meanPAN = 0;
+				double m2MS = 0;
+				double m2PAN = 0;
+				for(size_t i = 0; i < numPxls; ++i)
+				{
+					if(validPxls[i])
+					{
+						double iSq = 0;
+						for(unsigned int b = 0; b < numMSBands; ++b)
+						{
+							iSq += msVals[(b * numPxls) + i] * msVals[(b * numPxls) + i];
+						}
+						double pSq = panVals[i] * panVals[i];
+						n += 1;
+						double diffMS = iSq - meanMS;
+						meanMS += diffMS / n;
+						m2MS += diffMS * (iSq - meanMS);
+						double diffPAN = pSq - meanPAN;
+						meanPAN += diffPAN / n;
+						m2PAN += diffPAN * (pSq - meanPAN);
+					}
+				}
+				stripN[strip] = n;
+				stripMean[strip * 2] = meanMS;
+				stripMean[(strip * 2) + 1] = meanPAN;
+				stripM2[strip * 2] = m2MS;
+				stripM2[(strip * 2) + 1] = m2PAN;
+			});
+		}
+		catch(rsgis::RSGISException &e)
+		{
+			threadUtils.closeDatasetHandles(&msHandles);
+			threadUtils.closeDatasetHandles(&panHandles);
+			throw RSGISImageCalcException(e.what());
+		}
+		threadUtils.closeDatasetHandles(&msHandles);
+		threadUtils.closeDatasetHandles(&panHandles);
+		
+		double n = 0;
+		double mean[2] = {0, 0};
+		double m2[2] = {0, 0};
+		for(size_t strip = 0; strip < numStrips; ++strip)
+		{
+			if(stripN[strip] == 0)
+			{
+				continue;
+			}
+			double nTotal = n + stripN[strip];
+			for(unsigned int j = 0; j < 2; ++j)
+			{
+				double delta = stripMean[(strip * 2) + j] - mean[j];
+				mean[j] += delta * (stripN[strip] / nTotal);
+				m2[j] += stripM2[(strip * 2) + j] + (delta * delta * ((n * stripN[strip]) / nTotal));
+			}
+			n = nTotal;
+		}
+		if(n == 0)
+		{
+			throw RSGISImageCalcException("There are no valid pixels to calculate the pan sharpening statistics.");
+		}
+		
+		imageStats[0] = mean[0];
+		imageStats[1] = mean[1];
+		imageStats[2] = sqrt(m2[0] / n);
+		imageStats[3] = sqrt(m2[1] / n);
+	}
+	
+	void RSGISHCSPanSharpenImages::panSharpen(float *imageStats, std::string outputImage, std::string gdalFormat, GDALDataType outDataType, unsigned int winSize, bool useNaiveMethod)
+	{
+		unsigned int numMSBands = this->msBands.size();
+		double meanMS = imageStats[0];
+		double meanPAN = imageStats[1];
+		double sdMS = imageStats[2];
+		double sdPAN = imageStats[3];
+		int halfWin = useNaiveMethod?0:(winSize/2);
+		int stripRows = this->calcStripRows();
+		size_t numStrips = (this->height + stripRows - 1) / stripRows;
+		
+		RSGISImageUtils imgUtils;
+		GDALDataset *outDS = imgUtils.createCopy(this->panImage, numMSBands, outputImage, gdalFormat, outDataType);
+		
+		RSGISImageThreadUtils threadUtils;
+		unsigned int nThreads = threadUtils.getNumThreads(this->numThreads);
+		std::vector<GDALDataset*> msHandles = threadUtils.openDatasetHandles(this->msImage, nThreads);
+		std::vector<GDALDataset*> panHandles = threadUtils.openDatasetHandles(this->panImage, nThreads);
+		nThreads = std::min(msHandles.size(), panHandles.size());
+		std::mutex writeMutex;
+		try
+		{
+			threadUtils.runTasks(nThreads, numStrips, [&](unsigned int threadIdx, size_t strip)
+			{
+				int startRow = strip * stripRows;
+				int numRows = std::min(stripRows, this->height - startRow);
+				size_t numPxls = ((size_t)this->width) * numRows;
+				std::vector<float> msVals;
+				std::vector<float> panVals;
+				std::vector<unsigned char> validPxls;
+				this->readStrip(msHandles[threadIdx], panHandles[threadIdx], startRow, numRows, &msVals, &panVals, &validPxls);
+				
+				// Scale applied to the multispectral values of each pixel (I_adj / I).
+				std::vector<float> scale(numPxls, 0);
+				if(useNaiveMethod)
+				{
+					for(size_t i = 0; i < numPxls; ++i)
+					{
+						if(validPxls[i])
+						{
+							double iSq = 0;
+							for(unsigned int b = 0; b < numMSBands; ++b)
+							{
+								iSq += msVals[(b * numPxls) + i] * msVals[(b * numPxls) + i];
+							}
+							double pSq = ((sdMS / sdPAN) * ((panVals[i] * panVals[i]) - meanPAN + sdPAN)) + (meanMS - sdMS);
+							if((pSq > 0) && (iSq > 0))
+							{
+								scale[i] = sqrt(pSq / iSq);
+							}
+						}
+					}
+				}
+				else
+				{
+					// Mean of the pan values within the window from a summed area table over the strip and its halo.
+					int haloStart = std::max(startRow - halfWin, 0);
+					int haloEnd = std::min(startRow + numRows + halfWin, this->height);
+					int numHaloRows = haloEnd - haloStart;
+					std::vector<float> haloVals(((size_t)this->width) * numHaloRows);
+					if(panHandles[threadIdx]->GetRasterBand(this->panBand)->RasterIO(GF_Read, 0, haloStart, this->width, numHaloRows, haloVals.data(), this->width, numHaloRows, GDT_Float32, 0, 0) != CE_None)
+					{
+						throw RSGISImageCalcException("Failed to read the panchromatic image.");
+					}
+					size_t satWidth = this->width + 1;
+					std::vector<double> panSum(satWidth * (numHaloRows + 1), 0);
+					std::vector<double> panCount(satWidth * (numHaloRows + 1), 0);
+					for(int y = 0; y < numHaloRows; ++y)
+					{
+						double rowSum = 0;
+						double rowCount = 0;
+						for(int x = 0; x < this->width; ++x)
+						{
+							float val = haloVals[(((size_t)y) * this->width) + x];
+							if(!std::isnan(val))
+							{
+								rowSum += val;
+								rowCount += 1;
+							}
+							panSum[((y + 1) * satWidth) + x + 1] = panSum[(y * satWidth) + x + 1] + rowSum;
+							panCount[((y + 1) * satWidth) + x + 1] = panCount[(y * satWidth) + x + 1] + rowCount;
+						}
+					}
+					
+					for(int y = 0; y < numRows; ++y)
+					{
+						int y0 = std::max(startRow + y - halfWin, haloStart) - haloStart;
+						int y1 = std::min(startRow + y + halfWin + 1, haloEnd) - haloStart;
+						for(int x = 0; x < this->width; ++x)
+						{
+							size_t i = (((size_t)y) * this->width) + x;
+							if(!validPxls[i])
+							{
+								continue;
+							}
+							int x0 = std::max(x - halfWin, 0);
+							int x1 = std::min(x + halfWin + 1, this->width);
+							double winSum = panSum[(y1 * satWidth) + x1] - panSum[(y0 * satWidth) + x1] - panSum[(y1 * satWidth) + x0] + panSum[(y0 * satWidth) + x0];
+							double winCount = panCount[(y1 * satWidth) + x1] - panCount[(y0 * satWidth) + x1] - panCount[(y1 * satWidth) + x0] + panCount[(y0 * satWidth) + x0];
+							double panSmooth = winSum / winCount;
+							
+							double pSq = ((sdMS / sdPAN) * ((panVals[i] * panVals[i]) - meanPAN + sdPAN)) + (meanMS - sdMS);
+							double pSqSmooth = ((sdMS / sdPAN) * ((panSmooth * panSmooth) - meanPAN + sdPAN)) + (meanMS - sdMS);
+							double ratio = pSq / pSqSmooth;
+							if((ratio > 0) && std::isfinite(ratio))
+							{
+								scale[i] = sqrt(ratio);
+							}
+						}
+					}
+				}
+				
+				for(unsigned int b = 0; b < numMSBands; ++b)
+				{
+					float *bandVals = &msVals[b * numPxls];
+					for(size_t i = 0; i < numPxls; ++i)
+					{
+						bandVals[i] = validPxls[i]?(bandVals[i] * scale[i]):0;
+					}
+				}
+				
+				std::lock_guard<std::mutex> lock(writeMutex);
+				for(unsigned int b = 0; b < numMSBands; ++b)
+				{
+					if(outDS->GetRasterBand(b+1)->RasterIO(GF_Write, 0, startRow, this->width, numRows, &msVals[b * numPxls], this->width, numRows, GDT_Float32, 0, 0) != CE_None)
+					{
+						throw RSGISImageCalcException("Failed to write the output image.");
+					}
+				}
+			});
+		}
+		catch(rsgis::RSGISException &e)
+		{
+			threadUtils.closeDatasetHandles(&msHandles);
+			threadUtils.closeDatasetHandles(&panHandles);
+			GDALClose(outDS);
+			throw RSGISImageCalcException(e.what());
+		}
+		threadUtils.closeDatasetHandles(&msHandles);
+		threadUtils.closeDatasetHandles(&panHandles);
+		GDALClose(outDS);
+	}
+	
 }}
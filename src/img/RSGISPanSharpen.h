@@ -23,6 +23,9 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
+#include <mutex>
+#include <cmath>
 
 #include "common/RSGISException.h"
 #include "common/RSGISImageException.h"
@@ -30,6 +33,8 @@
 
 #include "img/RSGISCalcImage.h"
 #include "img/RSGISCalcImageValue.h"
+#include "img/RSGISImageUtils.h"
+#include "img/RSGISImageThreadUtils.h"
 
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
@@ -125,5 +130,46 @@ namespace rsgis { namespace img {
 		long int nPix;
 	};
 	
+	/**
+	 * HCS pan sharpening (Padwick et al. 2010) working directly from a
+	 * multispectral image and a panchromatic image, which may be bands of the
+	 * same image. The multispectral bands are bilinearly resampled onto the
+	 * pan grid strip by strip, so no resampled stack is needed. The mean and
+	 * standard deviation of I^2 and P^2 are calculated in a single parallel
+	 * pass and the transform is then applied to each strip.
+	 *
+	 * The forward and reverse hyperspherical transforms only change the
+	 * intensity, so the sharpened values are the multispectral values scaled
+	 * by I_adj / I. Pixels where the first multispectral band is not greater
+	 * than zero (or which are outside the multispectral image) are set to 0.
+	 *
+	 * imageStats has the same layout as RSGISHCSPanSharpen
+	 * (meanMS, meanPAN, sdMS, sdPAN).
+	 */
+	class DllExport RSGISHCSPanSharpenImages
+	{
+	public:
+		RSGISHCSPanSharpenImages(GDALDataset *msImage, std::vector<unsigned int> msBands, GDALDataset *panImage, unsigned int panBand, unsigned int numThreads=0);
+		void calcStats(float *imageStats);
+		void panSharpen(float *imageStats, std::string outputImage, std::string gdalFormat, GDALDataType outDataType, unsigned int winSize=7, bool useNaiveMethod=false);
+		~RSGISHCSPanSharpenImages(){};
+	protected:
+		int calcStripRows();
+		void readStrip(GDALDataset *msDS, GDALDataset *panDS, int startRow, int numRows, std::vector<float> *msVals, std::vector<float> *panVals, std::vector<unsigned char> *validPxls);
+		GDALDataset *msImage;
+		std::vector<unsigned int> msBands;
+		GDALDataset *panImage;
+		unsigned int panBand;
+		unsigned int numThreads;
+		int width;
+		int height;
+		std::vector<int> msCol0;
+		std::vector<int> msCol1;
+		std::vector<float> msColWeight;
+		std::vector<unsigned char> msColInside;
+		double msRowScale;
+		double msRowOffset;
+	};
+
 }}
 
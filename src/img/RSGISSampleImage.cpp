@@ -72,72 +72,48 @@ namespace rsgis{namespace img{
     {
         try
         {
-            RSGISImageUtils imgUtils;
-            unsigned int imgPxlXSize = inputImage->GetRasterXSize()-1;
-            unsigned int imgPxlYSize = inputImage->GetRasterYSize()-1;
-            unsigned int maxVal = imgPxlXSize;
-            if(imgPxlYSize > maxVal)
-            {
-                maxVal = imgPxlYSize;
-            }
-            bool foundAllSamples = false;
-            
-            unsigned int *maskValCounts = new unsigned int[maskVals.size()];
-            for(int i = 0; i < maskVals.size(); ++i)
+            if(maskVals.empty())
             {
-                maskValCounts[i] = 0;
+                throw RSGISImageException("At least one mask value must be provided.");
             }
             
-            boost::mt19937 rng (NULL);
-            
-            boost::uniform_int<> pxlRange( 0, maxVal );
-            
-            boost::variate_generator< boost::mt19937, boost::uniform_int<> > pxlGen(rng, pxlRange);
-            
-            unsigned int xPxl = 0;
-            unsigned int yPxl = 0;
-            
-            double pxlVal = 0.0;
-            
-            while(!foundAllSamples)
+            // Lookup from pixel value to the index of the mask value.
+            int maxMaskVal = 0;
+            for(size_t i = 0; i < maskVals.size(); ++i)
             {
-                xPxl = pxlGen();
-                while(xPxl >= imgPxlXSize)
-                {
-                    xPxl = pxlGen();
-                }
-                
-                yPxl = pxlGen();
-                while(yPxl >= imgPxlYSize)
+                if(maskVals.at(i) < 0)
                 {
-                    yPxl = pxlGen();
+                    throw RSGISImageException("Mask values must be positive.");
                 }
-                                
-                pxlVal = imgUtils.getPixelValue(inputImage, imgBand, xPxl, yPxl);
-                
-                for(int i = 0; i < maskVals.size(); ++i)
+                if(maskVals.at(i) > maxMaskVal)
                 {
-                    if(maskVals.at(i) == pxlVal)
-                    {
-                        if(maskValCounts[i] <= numSamples)
-                        {
-                            imgUtils.setPixelValue(outputImage, imgBand, xPxl, yPxl, pxlVal);
-                            maskValCounts[i] += 1;
-                        }
-                        break;
-                    }
+                    maxMaskVal = maskVals.at(i);
                 }
-                
-                foundAllSamples = true;
-                for(int i = 0; i < maskVals.size(); ++i)
+            }
+            std::vector<long> valMaskIdx(((size_t)maxMaskVal)+1, -1);
+            for(size_t i = 0; i < maskVals.size(); ++i)
+            {
+                valMaskIdx.at(maskVals.at(i)) = i;
+            }
+            
+            RSGISStratifiedPxlSampler sampler = RSGISStratifiedPxlSampler(0);
+            std::vector<std::vector<std::pair<unsigned int, unsigned int> > > samples;
+            std::vector<unsigned long> maskPxlCounts;
+            sampler.samplePxls(inputImage, imgBand, valMaskIdx, numSamples, &samples, &maskPxlCounts);
+            
+            std::vector<std::pair<unsigned int, unsigned int> > outPxlLocs;
+            std::vector<double> outPxlVals;
+            for(size_t i = 0; i < maskVals.size(); ++i)
+            {
+                if(maskPxlCounts.at(i) < numSamples)
                 {
-                    if(maskValCounts[i] <= numSamples)
-                    {
-                        foundAllSamples = false;
-                        break;
-                    }
+                    std::cout << "Only " << maskPxlCounts.at(i) << " pixels are available with mask value " << maskVals.at(i) << std::endl;
                 }
+                outPxlLocs.insert(outPxlLocs.end(), samples.at(i).begin(), samples.at(i).end());
+                outPxlVals.insert(outPxlVals.end(), samples.at(i).size(), maskVals.at(i));
             }
+            
+            sampler.writePxlValues(outputImage, imgBand, outPxlLocs, outPxlVals);
         }
         catch (RSGISImageCalcException &e)
         {
@@ -249,6 +225,315 @@ namespace rsgis{namespace img{
     }
     
     
+    RSGISStratifiedPxlSampler::RSGISStratifiedPxlSampler(unsigned int seed): rng(seed)
+    {
+        
+    }
+    
+    double RSGISStratifiedPxlSampler::randUniform()
+    {
+        // Uniform on (0,1] so it is safe to take the log.
+        boost::uniform_01<double> uniDist;
+        double val = 0.0;
+        while(val == 0.0)
+        {
+            val = 1.0 - uniDist(this->rng);
+        }
+        return val;
+    }
+    
+    unsigned long RSGISStratifiedPxlSampler::nextSamplePxl(unsigned long count, double w)
+    {
+        double skip = floor(log(this->randUniform())/log(1.0-w));
+        if(!(skip < 1e18))
+        {
+            return std::numeric_limits<unsigned long>::max();
+        }
+        return count + 1 + ((unsigned long)skip);
+    }
+    
+    void RSGISStratifiedPxlSampler::samplePxls(GDALDataset *image, unsigned int band, const std::vector<long> &valStratumIdx, unsigned long numSamples, std::vector<std::vector<std::pair<unsigned int, unsigned int> > > *samples, std::vector<unsigned long> *stratumPxlCounts, bool quiet)
+    {
+        int *data = NULL;
+        try
+        {
+            if((band == 0) | (band > ((unsigned int)image->GetRasterCount())))
+            {
+                throw RSGISImageCalcException("The band specified is not within the image.");
+            }
+            
+            size_t numStrata = 0;
+            for(std::vector<long>::const_iterator iterIdx = valStratumIdx.begin(); iterIdx != valStratumIdx.end(); ++iterIdx)
+            {
+                if(((*iterIdx) >= 0) && (((size_t)(*iterIdx)) >= numStrata))
+                {
+                    numStrata = (*iterIdx) + 1;
+                }
+            }
+            
+            samples->clear();
+            samples->resize(numStrata);
+            stratumPxlCounts->assign(numStrata, 0);
+            if((numStrata == 0) | (numSamples == 0))
+            {
+                return;
+            }
+            for(size_t i = 0; i < numStrata; ++i)
+            {
+                samples->at(i).reserve(numSamples);
+            }
+            
+            /*
+             * Reservoir sampling (Li's algorithm L); once a reservoir is full the
+             * number of pixels to skip before the next replacement is drawn so the
+             * random number generator is only used when a sample is taken.
+             */
+            const double numSamplesDbl = numSamples;
+            std::vector<double> w(numStrata, 0.0);
+            std::vector<unsigned long> nextPxl(numStrata, 0);
+            
+            GDALRasterBand *imgBand = image->GetRasterBand(band);
+            int width = imgBand->GetXSize();
+            int height = imgBand->GetYSize();
+            int xBlockSize = 0;
+            int yBlockSize = 0;
+            imgBand->GetBlockSize(&xBlockSize, &yBlockSize);
+            if(yBlockSize < 1)
+            {
+                yBlockSize = 1;
+            }
+            int stripRows = yBlockSize;
+            while(((((size_t)stripRows) * ((size_t)width)) < 65536) & (stripRows < height))
+            {
+                stripRows += yBlockSize;
+            }
+            data = (int *) CPLMalloc(sizeof(int)*((size_t)width)*((size_t)stripRows));
+            
+            const size_t lutSize = valStratumIdx.size();
+            rsgis_tqdm pbar;
+            for(int yOff = 0; yOff < height; yOff += stripRows)
+            {
+                if(!quiet)
+                {
+                    pbar.progress(yOff, height);
+                }
+                int nRows = std::min(stripRows, height - yOff);
+                if(imgBand->RasterIO(GF_Read, 0, yOff, width, nRows, data, width, nRows, GDT_Int32, 0, 0) != CE_None)
+                {
+                    throw RSGISImageCalcException("Could not read image data while sampling the image.");
+                }
+                
+                size_t pxlIdx = 0;
+                for(int y = 0; y < nRows; ++y)
+                {
+                    for(int x = 0; x < width; ++x, ++pxlIdx)
+                    {
+                        int val = data[pxlIdx];
+                        if((val < 0) || (((size_t)val) >= lutSize))
+                        {
+                            continue;
+                        }
+                        long stratum = valStratumIdx[val];
+                        if(stratum < 0)
+                        {
+                            continue;
+                        }
+                        
+                        unsigned long count = (*stratumPxlCounts)[stratum]++;
+                        std::vector<std::pair<unsigned int, unsigned int> > &reservoir = (*samples)[stratum];
+                        if(count < numSamples)
+                        {
+                            reservoir.push_back(std::pair<unsigned int, unsigned int>(x, yOff+y));
+                            if((count+1) == numSamples)
+                            {
+                                w[stratum] = exp(log(this->randUniform())/numSamplesDbl);
+                                nextPxl[stratum] = this->nextSamplePxl(count, w[stratum]);
+                            }
+                        }
+                        else if(count == nextPxl[stratum])
+                        {
+                            size_t replaceIdx = std::min((size_t)floor(this->randUniform() * numSamplesDbl), (size_t)(numSamples-1));
+                            reservoir[replaceIdx] = std::pair<unsigned int, unsigned int>(x, yOff+y);
+                            w[stratum] *= exp(log(this->randUniform())/numSamplesDbl);
+                            nextPxl[stratum] = this->nextSamplePxl(count, w[stratum]);
+                        }
+                    }
+                }
+            }
+            if(!quiet)
+            {
+                pbar.finish();
+            }
+            CPLFree(data);
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            if(data != NULL)
+            {
+                CPLFree(data);
+            }
+            throw e;
+        }
+        catch(std::exception &e)
+        {
+            if(data != NULL)
+            {
+                CPLFree(data);
+            }
+            throw RSGISImageCalcException(e.what());
+        }
+    }
+    
+    std::vector<size_t> RSGISStratifiedPxlSampler::sortByBlockRow(const std::vector<std::pair<unsigned int, unsigned int> > &pxlLocs, unsigned int yBlockSize)
+    {
+        std::vector<size_t> order(pxlLocs.size());
+        for(size_t i = 0; i < order.size(); ++i)
+        {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&pxlLocs, yBlockSize](size_t a, size_t b)
+        {
+            unsigned int aBlk = pxlLocs[a].second / yBlockSize;
+            unsigned int bBlk = pxlLocs[b].second / yBlockSize;
+            if(aBlk != bBlk)
+            {
+                return aBlk < bBlk;
+            }
+            return pxlLocs[a].first < pxlLocs[b].first;
+        });
+        return order;
+    }
+    
+    void RSGISStratifiedPxlSampler::readPxlValues(GDALDataset *image, unsigned int band, const std::vector<std::pair<unsigned int, unsigned int> > &pxlLocs, std::vector<double> *vals)
+    {
+        if((band == 0) | (band > ((unsigned int)image->GetRasterCount())))
+        {
+            throw RSGISImageCalcException("The band specified is not within the image.");
+        }
+        GDALRasterBand *imgBand = image->GetRasterBand(band);
+        unsigned int width = imgBand->GetXSize();
+        unsigned int height = imgBand->GetYSize();
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        imgBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        if(yBlockSize < 1)
+        {
+            yBlockSize = 1;
+        }
+        
+        vals->assign(pxlLocs.size(), 0.0);
+        std::vector<size_t> order = this->sortByBlockRow(pxlLocs, yBlockSize);
+        std::vector<double> buffer;
+        
+        // Read the window covering the points in each block row with a single RasterIO.
+        size_t i = 0;
+        while(i < order.size())
+        {
+            unsigned int blkRow = pxlLocs[order[i]].second / yBlockSize;
+            size_t j = i;
+            unsigned int minX = pxlLocs[order[i]].first;
+            unsigned int maxX = minX;
+            unsigned int minY = pxlLocs[order[i]].second;
+            unsigned int maxY = minY;
+            while((j < order.size()) && ((pxlLocs[order[j]].second / yBlockSize) == blkRow))
+            {
+                const std::pair<unsigned int, unsigned int> &loc = pxlLocs[order[j]];
+                if((loc.first >= width) | (loc.second >= height))
+                {
+                    throw RSGISImageCalcException("Pixel location is not within the image.");
+                }
+                minX = std::min(minX, loc.first);
+                maxX = std::max(maxX, loc.first);
+                minY = std::min(minY, loc.second);
+                maxY = std::max(maxY, loc.second);
+                ++j;
+            }
+            
+            unsigned int winWidth = (maxX - minX) + 1;
+            unsigned int winHeight = (maxY - minY) + 1;
+            buffer.resize(((size_t)winWidth) * ((size_t)winHeight));
+            if(imgBand->RasterIO(GF_Read, minX, minY, winWidth, winHeight, buffer.data(), winWidth, winHeight, GDT_Float64, 0, 0) != CE_None)
+            {
+                throw RSGISImageCalcException("Could not read pixel values from the image.");
+            }
+            for(size_t k = i; k < j; ++k)
+            {
+                const std::pair<unsigned int, unsigned int> &loc = pxlLocs[order[k]];
+                (*vals)[order[k]] = buffer[(((size_t)(loc.second - minY)) * winWidth) + (loc.first - minX)];
+            }
+            i = j;
+        }
+    }
+    
+    void RSGISStratifiedPxlSampler::writePxlValues(GDALDataset *image, unsigned int band, const std::vector<std::pair<unsigned int, unsigned int> > &pxlLocs, const std::vector<double> &vals)
+    {
+        if((band == 0) | (band > ((unsigned int)image->GetRasterCount())))
+        {
+            throw RSGISImageCalcException("The band specified is not within the image.");
+        }
+        if(pxlLocs.size() != vals.size())
+        {
+            throw RSGISImageCalcException("The number of pixel locations and values are different.");
+        }
+        GDALRasterBand *imgBand = image->GetRasterBand(band);
+        unsigned int width = imgBand->GetXSize();
+        unsigned int height = imgBand->GetYSize();
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        imgBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        if(yBlockSize < 1)
+        {
+            yBlockSize = 1;
+        }
+        
+        std::vector<size_t> order = this->sortByBlockRow(pxlLocs, yBlockSize);
+        std::vector<double> buffer;
+        
+        // Read, update and write back the window covering the points in each block row.
+        size_t i = 0;
+        while(i < order.size())
+        {
+            unsigned int blkRow = pxlLocs[order[i]].second / yBlockSize;
+            size_t j = i;
+            unsigned int minX = pxlLocs[order[i]].first;
+            unsigned int maxX = minX;
+            unsigned int minY = pxlLocs[order[i]].second;
+            unsigned int maxY = minY;
+            while((j < order.size()) && ((pxlLocs[order[j]].second / yBlockSize) == blkRow))
+            {
+                const std::pair<unsigned int, unsigned int> &loc = pxlLocs[order[j]];
+                if((loc.first >= width) | (loc.second >= height))
+                {
+                    throw RSGISImageCalcException("Pixel location is not within the image.");
+                }
+                minX = std::min(minX, loc.first);
+                maxX = std::max(maxX, loc.first);
+                minY = std::min(minY, loc.second);
+                maxY = std::max(maxY, loc.second);
+                ++j;
+            }
+            
+            unsigned int winWidth = (maxX - minX) + 1;
+            unsigned int winHeight = (maxY - minY) + 1;
+            buffer.resize(((size_t)winWidth) * ((size_t)winHeight));
+            if(imgBand->RasterIO(GF_Read, minX, minY, winWidth, winHeight, buffer.data(), winWidth, winHeight, GDT_Float64, 0, 0) != CE_None)
+            {
+                throw RSGISImageCalcException("Could not read pixel values from the image.");
+            }
+            for(size_t k = i; k < j; ++k)
+            {
+                const std::pair<unsigned int, unsigned int> &loc = pxlLocs[order[k]];
+                buffer[(((size_t)(loc.second - minY)) * winWidth) + (loc.first - minX)] = vals[order[k]];
+            }
+            if(imgBand->RasterIO(GF_Write, minX, minY, winWidth, winHeight, buffer.data(), winWidth, winHeight, GDT_Float64, 0, 0) != CE_None)
+            {
+                throw RSGISImageCalcException("Could not write pixel values to the image.");
+            }
+            i = j;
+        }
+    }
+    
+    
     RSGISSampleCalcImage::RSGISSampleCalcImage(unsigned int sample, float noData, bool useNoData, rsgis::utils::RSGISExportColumnData2HDF *dataExport, float *dataRow):RSGISCalcImageValue(0)
     {
         this->sample = sample;
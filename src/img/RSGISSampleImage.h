@@ -25,6 +25,11 @@
 
 #include <iostream>
 #include <fstream>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <math.h>
 
 #include "boost/random.hpp"
 #include "boost/generator_iterator.hpp"
@@ -40,6 +45,8 @@
 
 #include "gdal_priv.h"
 
+#include "common/rsgis-tqdm.h"
+
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
 #undef DllExport
@@ -65,6 +72,30 @@ namespace rsgis{namespace img{
         ~RSGISSampleImage();
     };
     
+    /**
+     * Stratified random sampling of pixel locations using a reservoir per
+     * stratum, filled in a single streaming pass over the image so memory is
+     * proportional to the number of samples rather than the number of pixels.
+     * The stratum of a pixel is looked up from its (integer) value using
+     * valStratumIdx; values outside the lookup or mapped to -1 are ignored.
+     * Pixel values at a set of locations can then be read (or written) with
+     * one RasterIO per block row rather than one per pixel.
+     */
+    class DllExport RSGISStratifiedPxlSampler
+    {
+    public:
+        RSGISStratifiedPxlSampler(unsigned int seed);
+        void samplePxls(GDALDataset *image, unsigned int band, const std::vector<long> &valStratumIdx, unsigned long numSamples, std::vector<std::vector<std::pair<unsigned int, unsigned int> > > *samples, std::vector<unsigned long> *stratumPxlCounts, bool quiet=false);
+        void readPxlValues(GDALDataset *image, unsigned int band, const std::vector<std::pair<unsigned int, unsigned int> > &pxlLocs, std::vector<double> *vals);
+        void writePxlValues(GDALDataset *image, unsigned int band, const std::vector<std::pair<unsigned int, unsigned int> > &pxlLocs, const std::vector<double> &vals);
+        ~RSGISStratifiedPxlSampler(){};
+    protected:
+        std::vector<size_t> sortByBlockRow(const std::vector<std::pair<unsigned int, unsigned int> > &pxlLocs, unsigned int yBlockSize);
+        double randUniform();
+        unsigned long nextSamplePxl(unsigned long count, double w);
+        boost::mt19937 rng;
+    };
+    
     class DllExport RSGISSampleCalcImage : public RSGISCalcImageValue
     {
     public:
@@ -18,6 +18,11 @@ namespace rsgis{namespace img{
 		this->order = order;
 		this->window = window;
 		this->imagebandValues = imagebandValues;
+		
+		// The band values are fixed so the weights only need calculating once.
+		std::vector<double> times(imagebandValues->vector, imagebandValues->vector + imagebandValues->n);
+		this->sgTimeSeries = new RSGISSavitzkyGolayTimeSeries(times, order, window);
+		this->sgCoeffs = this->sgTimeSeries->getCoefficients(std::vector<char>(times.size(), 1));
 	}
 	
 	void RSGISSavitzkyGolaySmoothingFilters::calcImageValue(float *bandValues, int numBands, double *output) 
@@ -32,53 +37,14 @@ namespace rsgis{namespace img{
 			throw RSGISImageCalcException("The number of input images bands and defined values need to be equal");
 		}
 		
-		int numCols = 2;
-		int numRows = 0;
-		int startVal = 0;
-		
-        rsgis::math::RSGISPolyFit polyFit;
-		gsl_vector *coefficients = NULL;
-		gsl_matrix *inputValues = NULL;
-		
 		for(int i = 0; i < numBands; ++i)
 		{
-			if((i-window) < 0)
-			{
-				numRows = (window + 1) + i;
-				startVal = 0;
-			}
-			else if((i+window) >= numBands)
-			{
-				numRows = (window + 1) + (numBands - i);
-				startVal = i - window;
-			}
-			else 
-			{
-				numRows = (window * 2) + 1;
-				startVal = i - window;
-			}
-				
-			inputValues = gsl_matrix_alloc (numRows,numCols);
-			for(int j = 0; j < numRows; ++j)
-			{
-				gsl_matrix_set (inputValues, j, 0, imagebandValues->vector[(startVal+j)]);
-				gsl_matrix_set (inputValues, j, 1, bandValues[(startVal+j)]);
-			}
-			
-			coefficients = polyFit.PolyfitOneDimensionQuiet(this->order, inputValues);	
-			
 			double yPredicted = 0;
-			for(int j = 0; j < order; j++)
+			for(unsigned int k = this->sgCoeffs->outStart[i]; k < this->sgCoeffs->outStart[i+1]; ++k)
 			{
-				double xPow = pow(imagebandValues->vector[i], j); // x^n;
-				double coeff = gsl_vector_get(coefficients, j); // a_n
-				double coeffXPow = coeff * xPow; // a_n * x^n				
-				yPredicted = yPredicted + coeffXPow;
+				yPredicted += this->sgCoeffs->weights[k] * bandValues[this->sgCoeffs->obsIdx[k]];
 			}
 			output[i] = yPredicted;
-			
-			gsl_matrix_free(inputValues);
-			gsl_vector_free(coefficients);
 		}
 	}
 	
@@ -109,6 +75,437 @@ namespace rsgis{namespace img{
 	
 	RSGISSavitzkyGolaySmoothingFilters::~RSGISSavitzkyGolaySmoothingFilters()
 	{
+		delete this->sgTimeSeries;
+	}
+	
+	
+	
+	RSGISSavitzkyGolayTimeSeries::RSGISSavitzkyGolayTimeSeries(std::vector<double> times, unsigned int order, unsigned int window, bool useNoData, double noDataVal, unsigned int maxCachedPatterns, unsigned int numThreads)
+	{
+		if(times.empty())
+		{
+			throw RSGISImageCalcException("At least one observation time is required.");
+		}
+		if(order < 1)
+		{
+			throw RSGISImageCalcException("The polynomial order must be at least 1.");
+		}
+		this->times = times;
+		this->numObs = times.size();
+		this->order = order;
+		this->window = window;
+		this->useNoData = useNoData;
+		this->noDataVal = noDataVal;
+		this->maxCachedPatterns = maxCachedPatterns;
+		this->numThreads = numThreads;
+	}
+	
+	void RSGISSavitzkyGolayTimeSeries::smoothValues(const double *vals, size_t numPxls, double *output)
+	{
+		if(numPxls == 0)
+		{
+			return;
+		}
+		
+		// Pack the valid observations of each pixel into a bit mask.
+		size_t numWords = (this->numObs + 63) / 64;
+		std::vector<unsigned long long> validBits(numPxls * numWords, 0);
+		for(unsigned int t = 0; t < this->numObs; ++t)
+		{
+			const double *obsVals = vals + (((size_t)t) * numPxls);
+			unsigned long long bit = 1ULL << (t % 64);
+			unsigned long long *bits = &validBits[t / 64];
+			for(size_t p = 0; p < numPxls; ++p)
+			{
+				if(!(std::isnan(obsVals[p]) || (this->useNoData && (obsVals[p] == this->noDataVal))))
+				{
+					bits[p * numWords] |= bit;
+				}
+			}
+		}
+		
+		// Group pixels which share a gap pattern.
+		std::map<std::string, size_t> groupLUT;
+		std::vector<std::vector<size_t> > groupPxls;
+		for(size_t p = 0; p < numPxls; ++p)
+		{
+			std::string key((const char*)&validBits[p * numWords], numWords * sizeof(unsigned long long));
+			std::map<std::string, size_t>::iterator iterGroup = groupLUT.find(key);
+			if(iterGroup == groupLUT.end())
+			{
+				iterGroup = groupLUT.insert(std::pair<std::string, size_t>(key, groupPxls.size())).first;
+				groupPxls.push_back(std::vector<size_t>());
+			}
+			groupPxls[iterGroup->second].push_back(p);
+		}
+		
+		std::vector<char> validObs(this->numObs);
+		std::vector<unsigned int> obsRow(this->numObs);
+		std::vector<double> groupVals;
+		std::vector<double> groupOut;
+		for(size_t g = 0; g < groupPxls.size(); ++g)
+		{
+			const std::vector<size_t> &pxls = groupPxls[g];
+			size_t numGrpPxls = pxls.size();
+			const unsigned long long *bits = &validBits[pxls[0] * numWords];
+			unsigned int numValid = 0;
+			for(unsigned int t = 0; t < this->numObs; ++t)
+			{
+				validObs[t] = (bits[t / 64] >> (t % 64)) & 1ULL;
+				obsRow[t] = numValid;
+				if(validObs[t])
+				{
+					++numValid;
+				}
+			}
+			std::shared_ptr<const RSGISSGCoefficients> coeffs = this->getCoefficients(validObs);
+			
+			// Gather the group into contiguous rows, unless it is the whole block.
+			bool wholeBlock = (numGrpPxls == numPxls);
+			if(!wholeBlock)
+			{
+				groupVals.resize(((size_t)numValid) * numGrpPxls);
+				for(unsigned int t = 0; t < this->numObs; ++t)
+				{
+					if(validObs[t])
+					{
+						const double *obsVals = vals + (((size_t)t) * numPxls);
+						double *grpRow = &groupVals[((size_t)obsRow[t]) * numGrpPxls];
+						for(size_t i = 0; i < numGrpPxls; ++i)
+						{
+							grpRow[i] = obsVals[pxls[i]];
+						}
+					}
+				}
+				groupOut.resize(numGrpPxls);
+			}
+			
+			for(unsigned int t = 0; t < this->numObs; ++t)
+			{
+				double *outRow = wholeBlock?(output + (((size_t)t) * numPxls)):groupOut.data();
+				if(coeffs->outStart[t] == coeffs->outStart[t+1])
+				{
+					std::fill(outRow, outRow + numGrpPxls, this->noDataVal);
+				}
+				else
+				{
+					std::fill(outRow, outRow + numGrpPxls, 0.0);
+					for(unsigned int k = coeffs->outStart[t]; k < coeffs->outStart[t+1]; ++k)
+					{
+						double weight = coeffs->weights[k];
+						const double *inRow = wholeBlock?(vals + (((size_t)coeffs->obsIdx[k]) * numPxls)):&groupVals[((size_t)obsRow[coeffs->obsIdx[k]]) * numGrpPxls];
+						for(size_t i = 0; i < numGrpPxls; ++i)
+						{
+							outRow[i] += weight * inRow[i];
+						}
+					}
+				}
+				if(!wholeBlock)
+				{
+					double *outObs = output + (((size_t)t) * numPxls);
+					for(size_t i = 0; i < numGrpPxls; ++i)
+					{
+						outObs[pxls[i]] = outRow[i];
+					}
+				}
+			}
+		}
+	}
+	
+	void RSGISSavitzkyGolayTimeSeries::smoothImages(std::vector<GDALDataset*> datasets, std::vector<unsigned int> bands, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType)
+	{
+		try
+		{
+			if((datasets.size() != this->numObs) | (bands.size() != this->numObs))
+			{
+				throw RSGISImageCalcException("The number of input layers must match the number of observation times.");
+			}
+			int width = datasets[0]->GetRasterXSize();
+			int height = datasets[0]->GetRasterYSize();
+			for(unsigned int t = 0; t < this->numObs; ++t)
+			{
+				if((datasets[t]->GetRasterXSize() != width) | (datasets[t]->GetRasterYSize() != height))
+				{
+					throw RSGISImageCalcException("All the input images must be the same size.");
+				}
+				if((bands[t] < 1) | (bands[t] > ((unsigned int)datasets[t]->GetRasterCount())))
+				{
+					throw RSGISImageCalcException("An input band is not within the image it refers to.");
+				}
+			}
+			
+			RSGISImageUtils imgUtils;
+			GDALDataset *outDS = imgUtils.createCopy(datasets[0], this->numObs, outputImage, gdalFormat, gdalDataType);
+			if(this->useNoData)
+			{
+				for(unsigned int t = 1; t <= this->numObs; ++t)
+				{
+					outDS->GetRasterBand(t)->SetNoDataValue(this->noDataVal);
+				}
+			}
+			
+			// Strips hold about 16 MB of input and output values however many layers there are.
+			int xBlockSize = 0;
+			int yBlockSize = 0;
+			datasets[0]->GetRasterBand(bands[0])->GetBlockSize(&xBlockSize, &yBlockSize);
+			if(yBlockSize < 1)
+			{
+				yBlockSize = 1;
+			}
+			size_t targetPxls = std::max<size_t>(2097152 / (this->numObs * 2), width);
+			unsigned int stripRows = yBlockSize;
+			while(((((size_t)stripRows) * width) < targetPxls) && (stripRows < ((unsigned int)height)))
+			{
+				stripRows += yBlockSize;
+			}
+			size_t numStrips = (height + stripRows - 1) / stripRows;
+			
+			// Each distinct input file gets its own set of thread handles.
+			RSGISImageThreadUtils threadUtils;
+			unsigned int nThreads = threadUtils.getNumThreads(this->numThreads);
+			std::map<GDALDataset*, std::vector<GDALDataset*> > handles;
+			for(unsigned int t = 0; t < this->numObs; ++t)
+			{
+				if(handles.count(datasets[t]) == 0)
+				{
+					handles[datasets[t]] = threadUtils.openDatasetHandles(datasets[t], nThreads);
+					nThreads = std::min<unsigned int>(nThreads, handles[datasets[t]].size());
+				}
+			}
+			// The handles of each observation are looked up before the threads start so the map is only read.
+			std::vector<const std::vector<GDALDataset*>*> obsHandles(this->numObs);
+			for(unsigned int t = 0; t < this->numObs; ++t)
+			{
+				obsHandles[t] = &handles.at(datasets[t]);
+			}
+			
+			std::mutex writeMutex;
+			try
+			{
+				threadUtils.runTasks(nThreads, numStrips, [&](unsigned int threadIdx, size_t strip)
+				{
+					unsigned int startRow = strip * stripRows;
+					unsigned int numStripRows = std::min(stripRows, ((unsigned int)height) - startRow);
+					size_t numPxls = ((size_t)width) * numStripRows;
+					
+					std::vector<double> vals(numPxls * this->numObs);
+					for(unsigned int t = 0; t < this->numObs; ++t)
+					{
+						GDALDataset *ds = (*obsHandles[t])[threadIdx];
+						if(ds->GetRasterBand(bands[t])->RasterIO(GF_Read, 0, startRow, width, numStripRows, &vals[t * numPxls], width, numStripRows, GDT_Float64, 0, 0) != CE_None)
+						{
+							throw RSGISImageCalcException("Failed to read an input image.");
+						}
+					}
+					
+					std::vector<double> outVals(numPxls * this->numObs);
+					this->smoothValues(vals.data(), numPxls, outVals.data());
+					
+					std::lock_guard<std::mutex> lock(writeMutex);
+					for(unsigned int t = 0; t < this->numObs; ++t)
+					{
+						if(outDS->GetRasterBand(t+1)->RasterIO(GF_Write, 0, startRow, width, numStripRows, &outVals[t * numPxls], width, numStripRows, GDT_Float64, 0, 0) != CE_None)
+						{
+							throw RSGISImageCalcException("Failed to write the output image.");
+						}
+					}
+				});
+			}
+			catch(RSGISImageCalcException &e)
+			{
+				for(std::map<GDALDataset*, std::vector<GDALDataset*> >::iterator iterHandles = handles.begin(); iterHandles != handles.end(); ++iterHandles)
+				{
+					threadUtils.closeDatasetHandles(&iterHandles->second);
+				}
+				GDALClose(outDS);
+				throw e;
+			}
+			
+			for(std::map<GDALDataset*, std::vector<GDALDataset*> >::iterator iterHandles = handles.begin(); iterHandles != handles.end(); ++iterHandles)
+			{
+				threadUtils.closeDatasetHandles(&iterHandles->second);
+			}
+			GDALClose(outDS);
+		}
+		catch(RSGISImageCalcException &e)
+		{
+			throw e;
+		}
+		catch(RSGISException &e)
+		{
+			throw RSGISImageCalcException(e.what());
+		}
+	}
+	
+	std::shared_ptr<const RSGISSGCoefficients> RSGISSavitzkyGolayTimeSeries::getCoefficients(const std::vector<char> &validObs)
+	{
+		if(validObs.size() != this->numObs)
+		{
+			throw RSGISImageCalcException("The valid observation mask does not match the number of observations.");
+		}
+		std::string key(validObs.begin(), validObs.end());
+		{
+			std::lock_guard<std::mutex> lock(this->cacheMutex);
+			std::map<std::string, std::shared_ptr<const RSGISSGCoefficients> >::iterator iterCoeffs = this->coeffCache.find(key);
+			if(iterCoeffs != this->coeffCache.end())
+			{
+				return iterCoeffs->second;
+			}
+		}
+		
+		std::shared_ptr<RSGISSGCoefficients> coeffs = std::make_shared<RSGISSGCoefficients>();
+		this->calcCoefficients(validObs, coeffs.get());
 		
+		std::lock_guard<std::mutex> lock(this->cacheMutex);
+		if(this->coeffCache.size() >= this->maxCachedPatterns)
+		{
+			// Anything still in use is kept alive by its shared pointer.
+			this->coeffCache.clear();
+		}
+		this->coeffCache[key] = coeffs;
+		return coeffs;
+	}
+	
+	void RSGISSavitzkyGolayTimeSeries::calcCoefficients(const std::vector<char> &validObs, RSGISSGCoefficients *coeffs)
+	{
+		std::vector<unsigned int> validIdx;
+		for(unsigned int t = 0; t < this->numObs; ++t)
+		{
+			if(validObs[t])
+			{
+				validIdx.push_back(t);
+			}
+		}
+		
+		coeffs->outStart.assign(this->numObs+1, 0);
+		coeffs->obsIdx.clear();
+		coeffs->weights.clear();
+		
+		std::vector<double> xVals;
+		std::vector<double> normMatrix;
+		std::vector<double> solution;
+		for(unsigned int t = 0; t < this->numObs; ++t)
+		{
+			coeffs->outStart[t] = coeffs->obsIdx.size();
+			if(validIdx.empty())
+			{
+				continue;
+			}
+			
+			// Up to window valid observations either side, plus the observation itself if valid.
+			size_t upper = std::lower_bound(validIdx.begin(), validIdx.end(), t) - validIdx.begin();
+			size_t first = (upper > this->window)?(upper - this->window):0;
+			size_t last = upper + this->window;
+			if((upper < validIdx.size()) && (validIdx[upper] == t))
+			{
+				++last;
+			}
+			last = std::min(last, validIdx.size());
+			size_t numPts = last - first;
+			if(numPts == 0)
+			{
+				continue;
+			}
+			
+			// Fit in coordinates centred on the output date so only the constant term is needed.
+			double scale = 0.0;
+			xVals.resize(numPts);
+			for(size_t k = 0; k < numPts; ++k)
+			{
+				xVals[k] = this->times[validIdx[first+k]] - this->times[t];
+				scale = std::max(scale, fabs(xVals[k]));
+			}
+			if(scale == 0.0)
+			{
+				scale = 1.0;
+			}
+			for(size_t k = 0; k < numPts; ++k)
+			{
+				xVals[k] /= scale;
+			}
+			
+			// Weights are row 0 of (A^T A)^-1 A^T, reducing the order if the fit is degenerate.
+			unsigned int numCoeffs = std::min<size_t>(this->order, numPts);
+			bool solved = false;
+			while(!solved)
+			{
+				normMatrix.assign(numCoeffs * (numCoeffs+1), 0.0);
+				for(unsigned int i = 0; i < numCoeffs; ++i)
+				{
+					for(unsigned int j = 0; j < numCoeffs; ++j)
+					{
+						double sum = 0.0;
+						for(size_t k = 0; k < numPts; ++k)
+						{
+							sum += pow(xVals[k], (int)(i+j));
+						}
+						normMatrix[(i*(numCoeffs+1))+j] = sum;
+					}
+				}
+				normMatrix[numCoeffs] = 1.0;
+				
+				solved = true;
+				for(unsigned int c = 0; c < numCoeffs; ++c)
+				{
+					unsigned int pivot = c;
+					for(unsigned int r = c+1; r < numCoeffs; ++r)
+					{
+						if(fabs(normMatrix[(r*(numCoeffs+1))+c]) > fabs(normMatrix[(pivot*(numCoeffs+1))+c]))
+						{
+							pivot = r;
+						}
+					}
+					if(fabs(normMatrix[(pivot*(numCoeffs+1))+c]) < (1e-12 * numPts))
+					{
+						solved = false;
+						break;
+					}
+					if(pivot != c)
+					{
+						for(unsigned int j = 0; j <= numCoeffs; ++j)
+						{
+							std::swap(normMatrix[(c*(numCoeffs+1))+j], normMatrix[(pivot*(numCoeffs+1))+j]);
+						}
+					}
+					for(unsigned int r = c+1; r < numCoeffs; ++r)
+					{
+						double factor = normMatrix[(r*(numCoeffs+1))+c] / normMatrix[(c*(numCoeffs+1))+c];
+						for(unsigned int j = c; j <= numCoeffs; ++j)
+						{
+							normMatrix[(r*(numCoeffs+1))+j] -= factor * normMatrix[(c*(numCoeffs+1))+j];
+						}
+					}
+				}
+				if(!solved)
+				{
+					--numCoeffs;
+					continue;
+				}
+				solution.assign(numCoeffs, 0.0);
+				for(int r = numCoeffs-1; r >= 0; --r)
+				{
+					double val = normMatrix[(r*(numCoeffs+1))+numCoeffs];
+					for(unsigned int j = r+1; j < numCoeffs; ++j)
+					{
+						val -= normMatrix[(r*(numCoeffs+1))+j] * solution[j];
+					}
+					solution[r] = val / normMatrix[(r*(numCoeffs+1))+r];
+				}
+			}
+			
+			for(size_t k = 0; k < numPts; ++k)
+			{
+				double weight = 0.0;
+				double xPow = 1.0;
+				for(unsigned int j = 0; j < numCoeffs; ++j)
+				{
+					weight += solution[j] * xPow;
+					xPow *= xVals[k];
+				}
+				coeffs->obsIdx.push_back(validIdx[first+k]);
+				coeffs->weights.push_back(weight);
+			}
+		}
+		coeffs->outStart[this->numObs] = coeffs->obsIdx.size();
 	}
 }}
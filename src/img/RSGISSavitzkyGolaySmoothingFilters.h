@@ -25,6 +25,10 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <math.h>
 
 #include "gdal_priv.h"
@@ -34,6 +38,8 @@
 
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
+#include "img/RSGISImageUtils.h"
+#include "img/RSGISImageThreadUtils.h"
 
 #include "math/RSGISPolyFit.h"
 #include "math/RSGISVectors.h"
@@ -62,6 +68,54 @@ namespace rsgis{namespace img{
 	 *
 	 */
 	
+	/**
+	 * Savitzky-Golay weights for one pattern of valid observations. For output
+	 * observation i the smoothed value is the sum of weights[k] * value[obsIdx[k]]
+	 * for k in [outStart[i], outStart[i+1]). An empty range means there were no
+	 * valid observations to fit.
+	 */
+	struct DllExport RSGISSGCoefficients
+	{
+		std::vector<unsigned int> outStart;
+		std::vector<unsigned int> obsIdx;
+		std::vector<double> weights;
+	};
+	
+	/**
+	 * Savitzky-Golay smoothing of a time series with irregular dates and gaps.
+	 * The order is the number of polynomial coefficients (as RSGISPolyFit) and
+	 * the window is the number of valid observations used either side of each
+	 * date. Because the fitted value is linear in the observations, the weights
+	 * depend only on which observations are valid, so they are calculated once
+	 * for each gap pattern and cached. Pixels in a block are grouped by their
+	 * gap pattern and the weights are applied across each group at once.
+	 *
+	 * Invalid observations (no data or NaN) are filled by the fit. Pixels
+	 * without any valid observations are set to the no data value.
+	 */
+	class DllExport RSGISSavitzkyGolayTimeSeries
+	{
+	public:
+		RSGISSavitzkyGolayTimeSeries(std::vector<double> times, unsigned int order, unsigned int window, bool useNoData=false, double noDataVal=0.0, unsigned int maxCachedPatterns=4096, unsigned int numThreads=0);
+		void smoothValues(const double *vals, size_t numPxls, double *output);
+		void smoothImages(std::vector<GDALDataset*> datasets, std::vector<unsigned int> bands, std::string outputImage, std::string gdalFormat, GDALDataType gdalDataType);
+		std::shared_ptr<const RSGISSGCoefficients> getCoefficients(const std::vector<char> &validObs);
+		unsigned int getNumObservations(){return this->numObs;};
+		~RSGISSavitzkyGolayTimeSeries(){};
+	protected:
+		void calcCoefficients(const std::vector<char> &validObs, RSGISSGCoefficients *coeffs);
+		std::vector<double> times;
+		unsigned int numObs;
+		unsigned int order;
+		unsigned int window;
+		bool useNoData;
+		double noDataVal;
+		unsigned int maxCachedPatterns;
+		unsigned int numThreads;
+		std::map<std::string, std::shared_ptr<const RSGISSGCoefficients> > coeffCache;
+		std::mutex cacheMutex;
+	};
+	
 	class DllExport RSGISSavitzkyGolaySmoothingFilters : public RSGISCalcImageValue
 	{
 	public: 
@@ -81,6 +135,8 @@ namespace rsgis{namespace img{
 		int order;
 		int window;
         rsgis::math::Vector *imagebandValues; 
+		RSGISSavitzkyGolayTimeSeries *sgTimeSeries;
+		std::shared_ptr<const RSGISSGCoefficients> sgCoeffs;
 	};
 	
 }}
@@ -0,0 +1,563 @@
+/*
+ *  RSGISSinglePassImageStats.cpp
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISSinglePassImageStats.h"
+
+namespace rsgis{namespace img{
+
+    /**
+     * Per thread accumulator for a single band. Moments are merged using
+     * the pairwise update of Chan et al. (1979) so blocks and threads can
+     * be combined in any order without losing precision.
+     */
+    struct RSGISBandStatsAccumulator
+    {
+        RSGISBandStatsAccumulator(unsigned int sketchK):sketch(sketchK)
+        {
+            this->n = 0;
+            this->min = 0;
+            this->max = 0;
+            this->mean = 0;
+            this->m2 = 0;
+            this->sum = 0;
+            this->useDirectHist = false;
+            this->histOffset = 0;
+        };
+
+        void mergeMoments(unsigned long bN, double bMin, double bMax, double bMean, double bM2, double bSum)
+        {
+            if(bN == 0)
+            {
+                return;
+            }
+            if(this->n == 0)
+            {
+                this->n = bN;
+                this->min = bMin;
+                this->max = bMax;
+                this->mean = bMean;
+                this->m2 = bM2;
+                this->sum = bSum;
+                return;
+            }
+            double totalN = ((double)this->n) + ((double)bN);
+            double delta = bMean - this->mean;
+            this->mean += delta * (((double)bN) / totalN);
+            this->m2 += bM2 + (delta * delta * ((((double)this->n) * ((double)bN)) / totalN));
+            this->n += bN;
+            this->sum += bSum;
+            this->min = std::min(this->min, bMin);
+            this->max = std::max(this->max, bMax);
+        };
+
+        void addBlock(double *data, size_t nPxls, bool useNoData, double noDataVal)
+        {
+            // Compact the valid values to the front of the (scratch) buffer so the
+            // following loops are free of branches and can be vectorised.
+            size_t nValid = 0;
+            for(size_t i = 0; i < nPxls; ++i)
+            {
+                double val = data[i];
+                if(boost::math::isnan(val) || (useNoData && (val == noDataVal)))
+                {
+                    continue;
+                }
+                data[nValid++] = val;
+            }
+            if(nValid == 0)
+            {
+                return;
+            }
+
+            rsgis::math::RSGISRunMoments moments = rsgis::math::RSGISGroupedStatsAccumulator::calcRunMoments(data, nValid, true);
+            if(moments.n > 0)
+            {
+                this->mergeMoments((unsigned long)moments.n, moments.min, moments.max, moments.sum/moments.n, moments.m2, moments.sum);
+            }
+
+            if(this->useDirectHist)
+            {
+                for(size_t i = 0; i < nValid; ++i)
+                {
+                    ++this->directHist[((long)data[i]) - this->histOffset];
+                }
+            }
+            else
+            {
+                for(size_t i = 0; i < nValid; ++i)
+                {
+                    this->sketch.add(data[i]);
+                }
+            }
+        };
+
+        void merge(const RSGISBandStatsAccumulator &other)
+        {
+            this->mergeMoments(other.n, other.min, other.max, other.mean, other.m2, other.sum);
+            if(this->useDirectHist)
+            {
+                for(size_t i = 0; i < this->directHist.size(); ++i)
+                {
+                    this->directHist[i] += other.directHist[i];
+                }
+            }
+            else
+            {
+                this->sketch.merge(other.sketch);
+            }
+        };
+
+        unsigned long n;
+        double min;
+        double max;
+        double mean;
+        double m2;
+        double sum;
+        bool useDirectHist;
+        long histOffset;
+        std::vector<unsigned long> directHist;
+        rsgis::math::RSGISQuantileSketch sketch;
+    };
+
+
+    double ImageBandSummary::getPercentile(double percentile) const
+    {
+        if(this->n == 0)
+        {
+            throw RSGISImageCalcException("Cannot calculate a percentile for a band without any valid pixels.");
+        }
+
+        if(this->exactHistogram)
+        {
+            double target = ceil((percentile/100.0) * ((double)this->n));
+            if(target < 1)
+            {
+                target = 1;
+            }
+            double cumCount = 0;
+            for(size_t i = 0; i < this->histogram.size(); ++i)
+            {
+                cumCount += this->histogram[i];
+                if(cumCount >= target)
+                {
+                    return this->histMin + (((double)i) * this->histBinWidth);
+                }
+            }
+            return this->histMax;
+        }
+        return this->sketch.getQuantile(percentile/100.0);
+    }
+
+    void ImageBandSummary::getImageStats(ImageStats *stats) const
+    {
+        stats->min = this->min;
+        stats->max = this->max;
+        stats->mean = this->mean;
+        stats->stddev = this->stddev;
+        stats->sum = this->sum;
+    }
+
+
+    RSGISSinglePassImageStats::RSGISSinglePassImageStats(unsigned int numThreads, unsigned int numHistBins, unsigned int sketchK)
+    {
+        if(numHistBins == 0)
+        {
+            throw RSGISImageCalcException("The number of histogram bins must be greater than zero.");
+        }
+        this->numThreads = numThreads;
+        this->numHistBins = numHistBins;
+        this->sketchK = sketchK;
+    }
+
+    int RSGISSinglePassImageStats::findOverviewIndex(GDALRasterBand *band, unsigned int minOverviewDim)
+    {
+        // Use the coarsest overview which is still at least minOverviewDim pixels in both directions.
+        int ovIdx = -1;
+        double ovNumPxls = ((double)band->GetXSize()) * ((double)band->GetYSize());
+        for(int i = 0; i < band->GetOverviewCount(); ++i)
+        {
+            GDALRasterBand *ovBand = band->GetOverview(i);
+            if(ovBand == NULL)
+            {
+                continue;
+            }
+            if((ovBand->GetXSize() >= ((int)minOverviewDim)) & (ovBand->GetYSize() >= ((int)minOverviewDim)))
+            {
+                double numPxls = ((double)ovBand->GetXSize()) * ((double)ovBand->GetYSize());
+                if(numPxls < ovNumPxls)
+                {
+                    ovNumPxls = numPxls;
+                    ovIdx = i;
+                }
+            }
+        }
+        return ovIdx;
+    }
+
+    GDALRasterBand* RSGISSinglePassImageStats::getSourceBand(GDALDataset *dataset, unsigned int band, int overviewIdx)
+    {
+        GDALRasterBand *imgBand = dataset->GetRasterBand(band);
+        if(imgBand == NULL)
+        {
+            throw RSGISImageCalcException("Could not open the image band.");
+        }
+        if(overviewIdx >= 0)
+        {
+            imgBand = imgBand->GetOverview(overviewIdx);
+            if(imgBand == NULL)
+            {
+                throw RSGISImageCalcException("Could not open the image band overview.");
+            }
+        }
+        return imgBand;
+    }
+
+    void RSGISSinglePassImageStats::calcImageBandSummaries(GDALDataset *dataset, std::vector<ImageBandSummary> *bandSummaries, bool useNoData, double noDataVal, bool useOverviews, unsigned int minOverviewDim, bool quiet)
+    {
+        RSGISImageThreadUtils threadUtils;
+        std::vector<GDALDataset*> handles;
+        try
+        {
+            unsigned int numBands = dataset->GetRasterCount();
+            if(numBands == 0)
+            {
+                throw RSGISImageCalcException("The input image does not have any image bands.");
+            }
+
+            int ovIdx = -1;
+            if(useOverviews)
+            {
+                ovIdx = this->findOverviewIndex(dataset->GetRasterBand(1), minOverviewDim);
+            }
+
+            GDALRasterBand *srcBand = this->getSourceBand(dataset, 1, ovIdx);
+            int width = srcBand->GetXSize();
+            int height = srcBand->GetYSize();
+            int xBlockSize = 0;
+            int yBlockSize = 0;
+            srcBand->GetBlockSize(&xBlockSize, &yBlockSize);
+            if(yBlockSize < 1)
+            {
+                yBlockSize = 1;
+            }
+
+            // Strips are whole multiples of the block height and at least ~64k pixels.
+            int stripRows = yBlockSize;
+            while(((((size_t)stripRows) * ((size_t)width)) < 65536) & (stripRows < height))
+            {
+                stripRows += yBlockSize;
+            }
+            size_t numStrips = (height + stripRows - 1) / stripRows;
+
+            // KEA files cannot be opened per thread so their reads are serialised.
+            bool sharedHandle = false;
+            unsigned int nThreads = threadUtils.getNumThreads(this->numThreads);
+            handles = threadUtils.openDatasetHandles(dataset, nThreads, &sharedHandle);
+
+            std::vector< std::vector<RSGISBandStatsAccumulator> > accums;
+            for(unsigned int t = 0; t < nThreads; ++t)
+            {
+                accums.push_back(std::vector<RSGISBandStatsAccumulator>(numBands, RSGISBandStatsAccumulator(this->sketchK)));
+                for(unsigned int b = 0; b < numBands; ++b)
+                {
+                    accums[t][b].sketch.setSeed((((boost::uint_fast64_t)t) * numBands) + b);
+                    GDALDataType dataType = dataset->GetRasterBand(b+1)->GetRasterDataType();
+                    if(dataType == GDT_Byte)
+                    {
+                        accums[t][b].useDirectHist = true;
+                        accums[t][b].histOffset = 0;
+                        accums[t][b].directHist.resize(256, 0);
+                    }
+                    else if(dataType == GDT_UInt16)
+                    {
+                        accums[t][b].useDirectHist = true;
+                        accums[t][b].histOffset = 0;
+                        accums[t][b].directHist.resize(65536, 0);
+                    }
+                    else if(dataType == GDT_Int16)
+                    {
+                        accums[t][b].useDirectHist = true;
+                        accums[t][b].histOffset = -32768;
+                        accums[t][b].directHist.resize(65536, 0);
+                    }
+                }
+            }
+
+            std::vector< std::vector<double> > buffers(nThreads, std::vector<double>(((size_t)width) * ((size_t)stripRows)));
+
+            if(!quiet)
+            {
+                std::cout << "Calculating statistics for " << numBands << " band(s) using " << nThreads << " thread(s)";
+                if(ovIdx >= 0)
+                {
+                    std::cout << " from a " << width << " x " << height << " overview";
+                }
+                std::cout << std::endl;
+            }
+
+            threadUtils.runTasks(nThreads, numStrips, [&](unsigned int threadIdx, size_t strip)
+            {
+                int yOff = strip * stripRows;
+                int nRows = std::min(stripRows, height - yOff);
+                size_t nPxls = ((size_t)width) * ((size_t)nRows);
+                double *data = buffers[threadIdx].data();
+                for(unsigned int b = 0; b < numBands; ++b)
+                {
+                    std::unique_lock<std::mutex> readLock = threadUtils.lockSharedRead(sharedHandle);
+                    GDALRasterBand *imgBand = this->getSourceBand(handles[threadIdx], b+1, ovIdx);
+                    if(imgBand->RasterIO(GF_Read, 0, yOff, width, nRows, data, width, nRows, GDT_Float64, 0, 0) != CE_None)
+                    {
+                        throw RSGISImageCalcException("Failed to read image data while calculating statistics.");
+                    }
+                    if(readLock.owns_lock())
+                    {
+                        readLock.unlock();
+                    }
+                    accums[threadIdx][b].addBlock(data, nPxls, useNoData, noDataVal);
+                }
+            }, quiet);
+
+            threadUtils.closeDatasetHandles(&handles);
+
+            bandSummaries->clear();
+            for(unsigned int b = 0; b < numBands; ++b)
+            {
+                RSGISBandStatsAccumulator &accum = accums[0][b];
+                for(unsigned int t = 1; t < nThreads; ++t)
+                {
+                    accum.merge(accums[t][b]);
+                }
+
+                ImageBandSummary summary = ImageBandSummary(this->sketchK);
+                summary.band = b+1;
+                summary.fromOverview = (ovIdx >= 0);
+                summary.n = accum.n;
+                if(accum.n > 0)
+                {
+                    summary.min = accum.min;
+                    summary.max = accum.max;
+                    summary.mean = accum.mean;
+                    summary.stddev = sqrt(accum.m2 / ((double)accum.n));
+                    summary.sum = accum.sum;
+                    summary.histMin = accum.min;
+                    summary.histMax = accum.max;
+
+                    if(accum.useDirectHist)
+                    {
+                        summary.exactHistogram = true;
+                        summary.histBinWidth = 1;
+                        long minIdx = ((long)accum.min) - accum.histOffset;
+                        long maxIdx = ((long)accum.max) - accum.histOffset;
+                        summary.histogram.assign(accum.directHist.begin()+minIdx, accum.directHist.begin()+maxIdx+1);
+                    }
+                    else
+                    {
+                        summary.exactHistogram = false;
+                        summary.sketch = accum.sketch;
+                        summary.histBinWidth = (accum.max - accum.min) / ((double)this->numHistBins);
+                        if(summary.histBinWidth == 0)
+                        {
+                            summary.histogram.push_back(accum.n);
+                            summary.histBinWidth = 1;
+                        }
+                        else
+                        {
+                            // Histogram counts from the differences in rank between the bin edges.
+                            double prevRank = 0;
+                            for(unsigned int i = 0; i < this->numHistBins; ++i)
+                            {
+                                double rank = 1;
+                                if(i < (this->numHistBins-1))
+                                {
+                                    rank = accum.sketch.getRank(accum.min + (((double)(i+1)) * summary.histBinWidth));
+                                }
+                                summary.histogram.push_back((unsigned long)floor(((rank - prevRank) * ((double)accum.n)) + 0.5));
+                                prevRank = rank;
+                            }
+                        }
+                    }
+                }
+                bandSummaries->push_back(summary);
+            }
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            threadUtils.closeDatasetHandles(&handles);
+            throw e;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            threadUtils.closeDatasetHandles(&handles);
+            throw RSGISImageCalcException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            threadUtils.closeDatasetHandles(&handles);
+            throw RSGISImageCalcException(e.what());
+        }
+    }
+
+    void RSGISSinglePassImageStats::calcThematicHistogram(GDALDataset *dataset, unsigned int band, std::vector<size_t> *histogram, long *minVal, long *maxVal, bool quiet)
+    {
+        RSGISImageThreadUtils threadUtils;
+        std::vector<GDALDataset*> handles;
+        try
+        {
+            if((band == 0) | (band > ((unsigned int)dataset->GetRasterCount())))
+            {
+                throw RSGISImageCalcException("The band specified is not within the image.");
+            }
+
+            GDALRasterBand *srcBand = dataset->GetRasterBand(band);
+            int width = srcBand->GetXSize();
+            int height = srcBand->GetYSize();
+            int xBlockSize = 0;
+            int yBlockSize = 0;
+            srcBand->GetBlockSize(&xBlockSize, &yBlockSize);
+            if(yBlockSize < 1)
+            {
+                yBlockSize = 1;
+            }
+            int stripRows = yBlockSize;
+            while(((((size_t)stripRows) * ((size_t)width)) < 65536) & (stripRows < height))
+            {
+                stripRows += yBlockSize;
+            }
+            size_t numStrips = (height + stripRows - 1) / stripRows;
+
+            // KEA files cannot be opened per thread so their reads are serialised.
+            bool sharedHandle = false;
+            unsigned int nThreads = threadUtils.getNumThreads(this->numThreads);
+            handles = threadUtils.openDatasetHandles(dataset, nThreads, &sharedHandle);
+
+            // The histogram of each thread grows to the largest value it has seen.
+            std::vector< std::vector<size_t> > threadHists(nThreads);
+            std::vector<long> threadMin(nThreads, 0);
+            std::vector<long> threadMax(nThreads, 0);
+            std::vector<char> threadFirst(nThreads, 1);
+            std::vector< std::vector<double> > buffers(nThreads, std::vector<double>(((size_t)width) * ((size_t)stripRows)));
+
+            threadUtils.runTasks(nThreads, numStrips, [&](unsigned int threadIdx, size_t strip)
+            {
+                int yOff = strip * stripRows;
+                int nRows = std::min(stripRows, height - yOff);
+                size_t nPxls = ((size_t)width) * ((size_t)nRows);
+                double *data = buffers[threadIdx].data();
+                std::unique_lock<std::mutex> readLock = threadUtils.lockSharedRead(sharedHandle);
+                if(handles[threadIdx]->GetRasterBand(band)->RasterIO(GF_Read, 0, yOff, width, nRows, data, width, nRows, GDT_Float64, 0, 0) != CE_None)
+                {
+                    throw RSGISImageCalcException("Failed to read image data while calculating the histogram.");
+                }
+                if(readLock.owns_lock())
+                {
+                    readLock.unlock();
+                }
+                std::vector<size_t> &hist = threadHists[threadIdx];
+                for(size_t i = 0; i < nPxls; ++i)
+                {
+                    if(boost::math::isnan(data[i]))
+                    {
+                        continue;
+                    }
+                    long val = (long)data[i];
+                    if(threadFirst[threadIdx])
+                    {
+                        threadMin[threadIdx] = val;
+                        threadMax[threadIdx] = val;
+                        threadFirst[threadIdx] = 0;
+                    }
+                    else if(val < threadMin[threadIdx])
+                    {
+                        threadMin[threadIdx] = val;
+                    }
+                    else if(val > threadMax[threadIdx])
+                    {
+                        threadMax[threadIdx] = val;
+                    }
+
+                    if(val >= 0)
+                    {
+                        if(((size_t)val) >= hist.size())
+                        {
+                            hist.resize(std::max(((size_t)val)+1, hist.size() + (hist.size()/2)), 0);
+                        }
+                        ++hist[val];
+                    }
+                }
+            }, quiet);
+
+            threadUtils.closeDatasetHandles(&handles);
+
+            bool first = true;
+            *minVal = 0;
+            *maxVal = 0;
+            for(unsigned int t = 0; t < nThreads; ++t)
+            {
+                if(threadFirst[t])
+                {
+                    continue;
+                }
+                if(first)
+                {
+                    *minVal = threadMin[t];
+                    *maxVal = threadMax[t];
+                    first = false;
+                }
+                else
+                {
+                    *minVal = std::min(*minVal, threadMin[t]);
+                    *maxVal = std::max(*maxVal, threadMax[t]);
+                }
+            }
+
+            histogram->clear();
+            if(*maxVal >= 0)
+            {
+                histogram->resize(((size_t)(*maxVal))+1, 0);
+                for(unsigned int t = 0; t < nThreads; ++t)
+                {
+                    size_t numVals = std::min(threadHists[t].size(), histogram->size());
+                    for(size_t i = 0; i < numVals; ++i)
+                    {
+                        histogram->at(i) += threadHists[t][i];
+                    }
+                }
+            }
+        }
+        catch(RSGISImageCalcException &e)
+        {
+            threadUtils.closeDatasetHandles(&handles);
+            throw e;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            threadUtils.closeDatasetHandles(&handles);
+            throw RSGISImageCalcException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            threadUtils.closeDatasetHandles(&handles);
+            throw RSGISImageCalcException(e.what());
+        }
+    }
+
+}}
@@ -0,0 +1,123 @@
+/*
+ *  RSGISSinglePassImageStats.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISSinglePassImageStats_H
+#define RSGISSinglePassImageStats_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <math.h>
+
+#include "gdal_priv.h"
+
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISImageStatistics.h"
+#include "img/RSGISImageThreadUtils.h"
+
+#include "math/RSGISQuantileSketch.h"
+#include "math/RSGISGroupedStatsAccumulator.h"
+
+#include <boost/math/special_functions/fpclassify.hpp>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+
+    /**
+     * Summary statistics for a single image band. For Byte, UInt16 and Int16
+     * bands the histogram is exact with a bin width of 1 between min and max,
+     * so percentiles are exact. For all other types the percentiles come from
+     * a quantile sketch and the histogram (numHistBins between min and max) is
+     * derived from that sketch.
+     */
+    struct DllExport ImageBandSummary
+    {
+        ImageBandSummary(unsigned int sketchK=200):sketch(sketchK)
+        {
+            this->band = 0;
+            this->n = 0;
+            this->min = 0;
+            this->max = 0;
+            this->mean = 0;
+            this->stddev = 0;
+            this->sum = 0;
+            this->histMin = 0;
+            this->histMax = 0;
+            this->histBinWidth = 0;
+            this->exactHistogram = false;
+            this->fromOverview = false;
+        };
+        double getPercentile(double percentile) const;
+        void getImageStats(ImageStats *stats) const;
+        unsigned int band;
+        unsigned long n;
+        double min;
+        double max;
+        double mean;
+        double stddev;
+        double sum;
+        double histMin;
+        double histMax;
+        double histBinWidth;
+        std::vector<unsigned long> histogram;
+        bool exactHistogram;
+        bool fromOverview;
+        rsgis::math::RSGISQuantileSketch sketch;
+    };
+
+    /**
+     * Calculates min, max, mean, standard deviation, a histogram and percentiles
+     * for every band of an image in a single pass. Strips of the image are
+     * distributed across threads, each with its own dataset handle, and the
+     * per-thread results are merged at the end. Optionally the statistics are
+     * estimated from an overview rather than the full resolution image.
+     */
+    class DllExport RSGISSinglePassImageStats
+    {
+    public:
+        RSGISSinglePassImageStats(unsigned int numThreads=0, unsigned int numHistBins=256, unsigned int sketchK=200);
+        void calcImageBandSummaries(GDALDataset *dataset, std::vector<ImageBandSummary> *bandSummaries, bool useNoData=false, double noDataVal=0.0, bool useOverviews=false, unsigned int minOverviewDim=1024, bool quiet=false);
+        void calcThematicHistogram(GDALDataset *dataset, unsigned int band, std::vector<size_t> *histogram, long *minVal, long *maxVal, bool quiet=false);
+        ~RSGISSinglePassImageStats(){};
+    protected:
+        int findOverviewIndex(GDALRasterBand *band, unsigned int minOverviewDim);
+        GDALRasterBand* getSourceBand(GDALDataset *dataset, unsigned int band, int overviewIdx);
+        unsigned int numThreads;
+        unsigned int numHistBins;
+        unsigned int sketchK;
+    };
+
+}}
+
+#endif
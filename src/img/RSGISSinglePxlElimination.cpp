@@ -0,0 +1,211 @@
+/*
+ *  RSGISSinglePxlElimination.cpp
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISSinglePxlElimination.h"
+
+namespace rsgis{namespace img{
+
+    RSGISSinglePxlElimination::RSGISSinglePxlElimination(RSGISRasterConnectivity connectivity, bool noDataValProvided, float noDataVal)
+    {
+        // Above, below, left, right and then the diagonals.
+        const int xOffs[8] = {0, 0, -1, 1, -1, 1, -1, 1};
+        const int yOffs[8] = {-1, 1, 0, 0, -1, -1, 1, 1};
+        this->numOffsets = (connectivity == rsgis_8connect)?8:4;
+        for(unsigned int k = 0; k < 8; ++k)
+        {
+            this->xOffsets[k] = xOffs[k];
+            this->yOffsets[k] = yOffs[k];
+        }
+        this->noDataValProvided = noDataValProvided;
+        this->noDataVal = noDataVal;
+        this->width = 0;
+        this->height = 0;
+    }
+
+    unsigned long RSGISSinglePxlElimination::eliminate(GDALRasterBand *catBand, GDALRasterBand *flagBand, RSGISSinglePxlReplacement *replacement)
+    {
+        this->width = catBand->GetXSize();
+        this->height = catBand->GetYSize();
+        if((flagBand->GetXSize() != ((int)this->width)) | (flagBand->GetYSize() != ((int)this->height)))
+        {
+            throw rsgis::RSGISImageException("The single pixel mask is not the same size as the input image.");
+        }
+
+        RSGISImageTileCache<unsigned int> catCache(catBand, true, 134217728);
+        RSGISImageTileCache<unsigned char> flagCache(flagBand, true, 67108864);
+
+        std::vector<size_t> singlePxls;
+        for(unsigned int y = 0; y < this->height; ++y)
+        {
+            for(unsigned int x = 0; x < this->width; ++x)
+            {
+                if(this->isSingle(&catCache, x, y))
+                {
+                    flagCache.setValue(x, y, 1);
+                    singlePxls.push_back((((size_t)y) * this->width) + x);
+                }
+                else
+                {
+                    flagCache.setValue(x, y, 0);
+                }
+            }
+        }
+        std::cout << "There are " << singlePxls.size() << " single pixels within the image\n";
+
+        unsigned long numReplaced = 0;
+        std::vector<std::pair<size_t, unsigned int> > replacements;
+        std::vector<size_t> changedFlags;
+        unsigned int xNeighbours[8];
+        unsigned int yNeighbours[8];
+        unsigned int neighbourVals[8];
+        unsigned int numNeighbours = 0;
+        unsigned int outVal = 0;
+        unsigned int x = 0;
+        unsigned int y = 0;
+        long nX = 0;
+        long nY = 0;
+        while(!singlePxls.empty())
+        {
+            // Find the new values from the current state so every pixel in
+            // this round is updated together.
+            replacements.clear();
+            for(std::vector<size_t>::iterator iterPxls = singlePxls.begin(); iterPxls != singlePxls.end(); ++iterPxls)
+            {
+                x = (*iterPxls) % this->width;
+                y = (*iterPxls) / this->width;
+                numNeighbours = 0;
+                for(unsigned int k = 0; k < this->numOffsets; ++k)
+                {
+                    nX = ((long)x) + this->xOffsets[k];
+                    nY = ((long)y) + this->yOffsets[k];
+                    if((nX < 0) | (nY < 0) | (nX >= this->width) | (nY >= this->height))
+                    {
+                        continue;
+                    }
+                    if(flagCache.getValue(nX, nY) == 0)
+                    {
+                        neighbourVals[numNeighbours] = catCache.getValue(nX, nY);
+                        if(this->noDataValProvided & (((float)neighbourVals[numNeighbours]) == this->noDataVal))
+                        {
+                            continue;
+                        }
+                        xNeighbours[numNeighbours] = nX;
+                        yNeighbours[numNeighbours] = nY;
+                        ++numNeighbours;
+                    }
+                }
+                if((numNeighbours > 0) && replacement->findReplacement(x, y, numNeighbours, xNeighbours, yNeighbours, neighbourVals, &outVal))
+                {
+                    replacements.push_back(std::pair<size_t, unsigned int>(*iterPxls, outVal));
+                }
+            }
+            if(replacements.empty())
+            {
+                break;
+            }
+
+            for(std::vector<std::pair<size_t, unsigned int> >::iterator iterVals = replacements.begin(); iterVals != replacements.end(); ++iterVals)
+            {
+                catCache.setValue((*iterVals).first % this->width, (*iterVals).first / this->width, (*iterVals).second);
+            }
+            numReplaced += replacements.size();
+
+            // Only the changed pixels and their neighbours can change state.
+            changedFlags.clear();
+            for(std::vector<std::pair<size_t, unsigned int> >::iterator iterVals = replacements.begin(); iterVals != replacements.end(); ++iterVals)
+            {
+                x = (*iterVals).first % this->width;
+                y = (*iterVals).first / this->width;
+                for(int k = -1; k < ((int)this->numOffsets); ++k)
+                {
+                    nX = ((long)x) + ((k < 0)?0:this->xOffsets[k]);
+                    nY = ((long)y) + ((k < 0)?0:this->yOffsets[k]);
+                    if((nX < 0) | (nY < 0) | (nX >= this->width) | (nY >= this->height))
+                    {
+                        continue;
+                    }
+                    unsigned char flag = this->isSingle(&catCache, nX, nY)?1:0;
+                    if(flag != flagCache.getValue(nX, nY))
+                    {
+                        flagCache.setValue(nX, nY, flag);
+                        changedFlags.push_back((((size_t)nY) * this->width) + nX);
+                    }
+                }
+            }
+
+            // The single pixels which could now be replaced are those next
+            // to (or at) a pixel which has changed state.
+            singlePxls.clear();
+            for(std::vector<size_t>::iterator iterPxls = changedFlags.begin(); iterPxls != changedFlags.end(); ++iterPxls)
+            {
+                x = (*iterPxls) % this->width;
+                y = (*iterPxls) / this->width;
+                for(int k = -1; k < ((int)this->numOffsets); ++k)
+                {
+                    nX = ((long)x) + ((k < 0)?0:this->xOffsets[k]);
+                    nY = ((long)y) + ((k < 0)?0:this->yOffsets[k]);
+                    if((nX < 0) | (nY < 0) | (nX >= this->width) | (nY >= this->height))
+                    {
+                        continue;
+                    }
+                    if(flagCache.getValue(nX, nY) == 1)
+                    {
+                        singlePxls.push_back((((size_t)nY) * this->width) + nX);
+                    }
+                }
+            }
+            std::sort(singlePxls.begin(), singlePxls.end());
+            singlePxls.erase(std::unique(singlePxls.begin(), singlePxls.end()), singlePxls.end());
+        }
+        catCache.flush();
+        flagCache.flush();
+        std::cout << "Replaced " << numReplaced << " single pixels\n";
+
+        return numReplaced;
+    }
+
+    bool RSGISSinglePxlElimination::isSingle(RSGISImageTileCache<unsigned int> *catCache, unsigned int xPxl, unsigned int yPxl)
+    {
+        unsigned int val = catCache->getValue(xPxl, yPxl);
+        if(this->noDataValProvided & (((float)val) == this->noDataVal))
+        {
+            return false;
+        }
+        long nX = 0;
+        long nY = 0;
+        for(unsigned int k = 0; k < this->numOffsets; ++k)
+        {
+            nX = ((long)xPxl) + this->xOffsets[k];
+            nY = ((long)yPxl) + this->yOffsets[k];
+            if((nX < 0) | (nY < 0) | (nX >= this->width) | (nY >= this->height))
+            {
+                continue;
+            }
+            if(catCache->getValue(nX, nY) == val)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+}}
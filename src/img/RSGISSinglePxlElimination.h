@@ -0,0 +1,95 @@
+/*
+ *  RSGISSinglePxlElimination.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISSinglePxlElimination_H
+#define RSGISSinglePxlElimination_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISImageException.h"
+
+#include "img/RSGISImageUtils.h"
+#include "img/RSGISImageTileCache.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_img_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace img{
+
+    /**
+     * Decides the new value of a single pixel from its neighbours which are
+     * not single pixels. Returns false if the pixel should be left unchanged.
+     */
+    class DllExport RSGISSinglePxlReplacement
+    {
+    public:
+        RSGISSinglePxlReplacement(){};
+        virtual bool findReplacement(unsigned int xPxl, unsigned int yPxl, unsigned int numNeighbours, const unsigned int *xNeighbours, const unsigned int *yNeighbours, const unsigned int *neighbourVals, unsigned int *outVal) = 0;
+        virtual ~RSGISSinglePxlReplacement(){};
+    };
+
+    /**
+     * Replaces single pixels (those with no neighbour of the same value) in a
+     * categorical band, repeating until no more can be replaced. Each round
+     * updates all the single pixels which have a neighbour that is not single
+     * at once, as a full pass over the image would, but only the pixels
+     * around those changed in the previous round are revisited so the cost
+     * follows the number of single pixels rather than the image size.
+     *
+     * The band is edited in place through a tile cache and the flag band,
+     * which must be writable and the same size, holds the single pixel mask.
+     */
+    class DllExport RSGISSinglePxlElimination
+    {
+    public:
+        RSGISSinglePxlElimination(RSGISRasterConnectivity connectivity=rsgis_4connect, bool noDataValProvided=false, float noDataVal=0);
+        unsigned long eliminate(GDALRasterBand *catBand, GDALRasterBand *flagBand, RSGISSinglePxlReplacement *replacement);
+        ~RSGISSinglePxlElimination(){};
+    protected:
+        bool isSingle(RSGISImageTileCache<unsigned int> *catCache, unsigned int xPxl, unsigned int yPxl);
+        unsigned int numOffsets;
+        int xOffsets[8];
+        int yOffsets[8];
+        bool noDataValProvided;
+        float noDataVal;
+        unsigned int width;
+        unsigned int height;
+    };
+
+}}
+
+#endif
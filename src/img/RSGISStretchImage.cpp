@@ -25,7 +25,7 @@
 
 namespace rsgis { namespace img {
 
-	RSGISStretchImage::RSGISStretchImage(GDALDataset *inputImage, std::string outputImage,  bool outStats, std::string outStatsFile, bool onePassSD, std::string imageFormat, GDALDataType outDataType, float outMinVal, float outMaxVal, bool useNoData, double inNoData, double outNoData)
+	RSGISStretchImage::RSGISStretchImage(GDALDataset *inputImage, std::string outputImage,  bool outStats, std::string outStatsFile, bool onePassSD, std::string imageFormat, GDALDataType outDataType, float outMinVal, float outMaxVal, bool useNoData, double inNoData, double outNoData, bool useMetadataStats, bool useOverviews)
 	{
 		this->inputImage = inputImage;
 		this->outputImage = outputImage;
@@ -39,14 +39,110 @@ namespace rsgis { namespace img {
         this->useNoData = useNoData;
         this->inNoData = inNoData;
         this->outNoData = outNoData;
+        this->useMetadataStats = useMetadataStats;
+        this->useOverviews = useOverviews;
+        this->haveBandSummaries = false;
 	}
+    
+    void RSGISStretchImage::setBandSummaries(std::vector<ImageBandSummary> *bandSummaries)
+    {
+        if(bandSummaries->size() != ((size_t)this->inputImage->GetRasterCount()))
+        {
+            throw RSGISImageCalcException("The number of band summaries does not match the number of image bands.");
+        }
+        this->bandSummaries = *bandSummaries;
+        this->haveBandSummaries = true;
+    }
+    
+    bool RSGISStretchImage::useBandMetadata(GDALRasterBand *band)
+    {
+        if(!this->useMetadataStats)
+        {
+            return false;
+        }
+        // Only use values calculated with the same pixels ignored.
+        int hasNoData = false;
+        double bandNoData = band->GetNoDataValue(&hasNoData);
+        if(this->useNoData)
+        {
+            return hasNoData && (bandNoData == this->inNoData);
+        }
+        return !hasNoData;
+    }
+    
+    void RSGISStretchImage::calcBandStats(ImageStats **stats, int numBands)
+    {
+        if(!this->haveBandSummaries)
+        {
+            bool haveAllStats = true;
+            for(int i = 0; i < numBands; i++)
+            {
+                GDALRasterBand *band = this->inputImage->GetRasterBand(i+1);
+                if(!this->useBandMetadata(band) || (band->GetStatistics(false, false, &stats[i]->min, &stats[i]->max, &stats[i]->mean, &stats[i]->stddev) != CE_None))
+                {
+                    haveAllStats = false;
+                    break;
+                }
+            }
+            if(haveAllStats)
+            {
+                std::cout << "Using the statistics from the image metadata\n";
+                return;
+            }
+            
+            RSGISSinglePassImageStats calcSummaries;
+            calcSummaries.calcImageBandSummaries(this->inputImage, &this->bandSummaries, this->useNoData, this->inNoData, this->useOverviews);
+            this->haveBandSummaries = true;
+        }
+        for(int i = 0; i < numBands; i++)
+        {
+            this->bandSummaries.at(i).getImageStats(stats[i]);
+        }
+    }
+    
+    void RSGISStretchImage::calcBandHistogramCDFs(std::vector<BandHistogramCDF> *bandCDFs)
+    {
+        int numBands = this->inputImage->GetRasterCount();
+        bandCDFs->clear();
+        for(int i = 0; i < numBands; i++)
+        {
+            GDALRasterBand *band = this->inputImage->GetRasterBand(i+1);
+            double histMin = 0;
+            double histMax = 0;
+            int numBins = 0;
+            GUIntBig *binCounts = NULL;
+            if(this->useBandMetadata(band) && (band->GetDefaultHistogram(&histMin, &histMax, &numBins, &binCounts, false, NULL, NULL) == CE_None) && (numBins > 0))
+            {
+                std::vector<double> histogram(binCounts, binCounts+numBins);
+                VSIFree(binCounts);
+                BandHistogramCDF bandCDF(i+1, histMin, (histMax - histMin)/numBins);
+                RSGISHistogramStretchImage::calcCDF(histogram, &bandCDF.cdf);
+                bandCDFs->push_back(bandCDF);
+                continue;
+            }
+            
+            if(!this->haveBandSummaries)
+            {
+                RSGISSinglePassImageStats calcSummaries;
+                calcSummaries.calcImageBandSummaries(this->inputImage, &this->bandSummaries, this->useNoData, this->inNoData, this->useOverviews);
+                this->haveBandSummaries = true;
+            }
+            const ImageBandSummary &summary = this->bandSummaries.at(i);
+            std::vector<double> histogram(summary.histogram.begin(), summary.histogram.end());
+            if(histogram.empty())
+            {
+                histogram.push_back(0);
+            }
+            BandHistogramCDF bandCDF(i+1, summary.histMin, summary.histBinWidth);
+            RSGISHistogramStretchImage::calcCDF(histogram, &bandCDF.cdf);
+            bandCDFs->push_back(bandCDF);
+        }
+    }
 	
 	void RSGISStretchImage::executeLinearMinMaxStretch() 
 	{
 		GDALDataset **datasets = NULL;
-		RSGISImageStatistics *calcImageStats = NULL;
 		ImageStats **stats = NULL;
-		RSGISCalcImage *calcImg = NULL;
 		RSGISLinearStretchImage *linearStretchImage = NULL;
 		double *imageMax = NULL;
 		double *imageMin = NULL;
@@ -68,9 +164,7 @@ namespace rsgis { namespace img {
 			{
 				stats[i] = new ImageStats();
 			}
-			calcImageStats = new RSGISImageStatistics();
-            
-			calcImageStats->calcImageStatistics(datasets, 1, stats, numBands, false, this->useNoData, this->inNoData, onePassSD);
+			this->calcBandStats(stats, numBands);
 			
             std::ofstream outTxtFile;
             if(this->outStats)
@@ -108,11 +202,10 @@ namespace rsgis { namespace img {
 				delete stats[i];
 			}
 			delete[] stats;
-			delete calcImageStats;
 
 			linearStretchImage = new RSGISLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData);
-			calcImg = new RSGISCalcImage(linearStretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+			RSGISApplyImageStretch applyStretch;
+			applyStretch.applyStretch(this->inputImage, linearStretchImage, this->outputImage, this->imageFormat, this->outDataType);
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -138,7 +231,6 @@ namespace rsgis { namespace img {
 		delete[] outMin;
 		
 		delete linearStretchImage;
-		delete calcImg;
 		
 		if(datasets != NULL)
 		{
@@ -149,9 +241,7 @@ namespace rsgis { namespace img {
 	void RSGISStretchImage::executeLinearPercentStretch(float percent) 
 	{
 		GDALDataset **datasets = NULL;
-		RSGISImageStatistics *calcImageStats = NULL;
 		ImageStats **stats = NULL;
-		RSGISCalcImage *calcImg = NULL;
 		RSGISLinearStretchImage *linearStretchImage = NULL;
 		double *imageMax = NULL;
 		double *imageMin = NULL;
@@ -173,8 +263,7 @@ namespace rsgis { namespace img {
 			{
 				stats[i] = new ImageStats();
 			}
-			calcImageStats = new RSGISImageStatistics();
-			calcImageStats->calcImageStatistics(datasets, 1, stats, numBands, false, this->useNoData, this->inNoData, onePassSD);
+			this->calcBandStats(stats, numBands);
 			
 			double onePercent = 0;
 			double onePercentUpper = 0;
@@ -221,11 +310,10 @@ namespace rsgis { namespace img {
 				delete stats[i];
 			}
 			delete[] stats;
-			delete calcImageStats;
 			
 			linearStretchImage = new RSGISLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData);
-			calcImg = new RSGISCalcImage(linearStretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+			RSGISApplyImageStretch applyStretch;
+			applyStretch.applyStretch(this->inputImage, linearStretchImage, this->outputImage, this->imageFormat, this->outDataType);
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -251,7 +339,6 @@ namespace rsgis { namespace img {
 		delete[] outMin;
 		
 		delete linearStretchImage;
-		delete calcImg;
 		
 		if(datasets != NULL)
 		{
@@ -263,9 +350,7 @@ namespace rsgis { namespace img {
 	void RSGISStretchImage::executeLinearStdDevStretch(float stddev) 
 	{
 		GDALDataset **datasets = NULL;
-		RSGISImageStatistics *calcImageStats = NULL;
 		ImageStats **stats = NULL;
-		RSGISCalcImage *calcImg = NULL;
 		RSGISLinearStretchImage *linearStretchImage = NULL;
 		double *imageMax = NULL;
 		double *imageMin = NULL;
@@ -287,8 +372,7 @@ namespace rsgis { namespace img {
 			{
 				stats[i] = new ImageStats();
 			}
-			calcImageStats = new RSGISImageStatistics();
-			calcImageStats->calcImageStatistics(datasets, 1, stats, numBands, true, this->useNoData, this->inNoData, onePassSD);
+			this->calcBandStats(stats, numBands);
 			
             std::ofstream outTxtFile;
             if(this->outStats)
@@ -338,11 +422,10 @@ namespace rsgis { namespace img {
 				delete stats[i];
 			}
 			delete[] stats;
-			delete calcImageStats;
 			
 			linearStretchImage = new RSGISLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData);
-			calcImg = new RSGISCalcImage(linearStretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+			RSGISApplyImageStretch applyStretch;
+			applyStretch.applyStretch(this->inputImage, linearStretchImage, this->outputImage, this->imageFormat, this->outDataType);
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -368,7 +451,6 @@ namespace rsgis { namespace img {
 		delete[] outMin;
 		
 		delete linearStretchImage;
-		delete calcImg;
 		
 		if(datasets != NULL)
 		{
@@ -378,7 +460,60 @@ namespace rsgis { namespace img {
 	
 	void RSGISStretchImage::executeHistogramStretch() 
 	{
-		throw RSGISImageCalcException("Histogram Stretch is not implmented yet\n");
+		RSGISHistogramStretchImage *histStretchImage = NULL;
+		try
+		{
+			int numBands = inputImage->GetRasterCount();
+			std::vector<BandHistogramCDF> bandCDFs;
+			this->calcBandHistogramCDFs(&bandCDFs);
+			
+            if(this->outStats)
+            {
+                std::ofstream outTxtFile;
+                outTxtFile.open(this->outStatsFile.c_str());
+                if(!outTxtFile.is_open())
+                {
+                    throw RSGISImageCalcException("Output file for the statistics could not be opened.");
+                }
+                outTxtFile.precision(10);
+                outTxtFile << "#histogram\n";
+                outTxtFile << "#band,img_min,img_max,out_min,out_max\n";
+                for(int i = 0; i < numBands; i++)
+                {
+                    outTxtFile << i+1 << "," << bandCDFs[i].histMin << "," << bandCDFs[i].histMin + (bandCDFs[i].binWidth * bandCDFs[i].cdf.size()) << "," << this->outMinVal << "," << this->outMaxVal << std::endl;
+                }
+                outTxtFile << "#cdf,band,hist_min,bin_width,values\n";
+                for(int i = 0; i < numBands; i++)
+                {
+                    outTxtFile << "#cdf," << i+1 << "," << bandCDFs[i].histMin << "," << bandCDFs[i].binWidth << ",";
+                    for(size_t j = 0; j < bandCDFs[i].cdf.size(); ++j)
+                    {
+                        if(j > 0)
+                        {
+                            outTxtFile << " ";
+                        }
+                        outTxtFile << bandCDFs[i].cdf[j];
+                    }
+                    outTxtFile << std::endl;
+                }
+                outTxtFile.flush();
+                outTxtFile.close();
+            }
+			
+			histStretchImage = new RSGISHistogramStretchImage(numBands, &bandCDFs, this->outMinVal, this->outMaxVal, this->useNoData, this->inNoData, this->outNoData);
+			RSGISApplyImageStretch applyStretch;
+			applyStretch.applyStretch(this->inputImage, histStretchImage, this->outputImage, this->imageFormat, this->outDataType);
+		}
+		catch(RSGISImageCalcException &e)
+		{
+			if(histStretchImage != NULL)
+			{
+				delete histStretchImage;
+			}
+			throw e;
+		}
+		
+		delete histStretchImage;
 	}
 	
 	void RSGISStretchImage::executeExponentialStretch() 
@@ -386,7 +521,6 @@ namespace rsgis { namespace img {
 		GDALDataset **datasets = NULL;
 		RSGISImageStatistics *calcImageStats = NULL;
 		ImageStats **stats = NULL;
-		RSGISCalcImage *calcImg = NULL;
 		RSGISFuncLinearStretchImage *stretchImage = NULL;
 		double *imageMax = NULL;
 		double *imageMin = NULL;
@@ -461,8 +595,8 @@ namespace rsgis { namespace img {
 			delete calcImageStats;
 			
 			stretchImage = new RSGISFuncLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData, function);
-			calcImg = new RSGISCalcImage(stretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+			RSGISApplyImageStretch applyStretch;
+			applyStretch.applyStretch(this->inputImage, stretchImage, this->outputImage, this->imageFormat, this->outDataType);
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -488,7 +622,6 @@ namespace rsgis { namespace img {
 		delete[] outMin;
 		
 		delete stretchImage;
-		delete calcImg;
 		delete function;
 		
 		if(datasets != NULL)
@@ -502,7 +635,6 @@ namespace rsgis { namespace img {
 		GDALDataset **datasets = NULL;
 		RSGISImageStatistics *calcImageStats = NULL;
 		ImageStats **stats = NULL;
-		RSGISCalcImage *calcImg = NULL;
 		RSGISFuncLinearStretchImage *stretchImage = NULL;
 		double *imageMax = NULL;
 		double *imageMin = NULL;
@@ -577,8 +709,8 @@ namespace rsgis { namespace img {
 			delete calcImageStats;
 			
 			stretchImage = new RSGISFuncLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData, function);
-			calcImg = new RSGISCalcImage(stretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+			RSGISApplyImageStretch applyStretch;
+			applyStretch.applyStretch(this->inputImage, stretchImage, this->outputImage, this->imageFormat, this->outDataType);
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -604,7 +736,6 @@ namespace rsgis { namespace img {
 		delete[] outMin;
 		
 		delete stretchImage;
-		delete calcImg;
 		delete function;
 		
 		if(datasets != NULL)
@@ -618,7 +749,6 @@ namespace rsgis { namespace img {
 		GDALDataset **datasets = NULL;
 		RSGISImageStatistics *calcImageStats = NULL;
 		ImageStats **stats = NULL;
-		RSGISCalcImage *calcImg = NULL;
 		RSGISFuncLinearStretchImage *stretchImage = NULL;
 		double *imageMax = NULL;
 		double *imageMin = NULL;
@@ -688,8 +818,8 @@ namespace rsgis { namespace img {
 			delete calcImageStats;
 			
 			stretchImage = new RSGISFuncLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData, function);
-			calcImg = new RSGISCalcImage(stretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+			RSGISApplyImageStretch applyStretch;
+			applyStretch.applyStretch(this->inputImage, stretchImage, this->outputImage, this->imageFormat, this->outDataType);
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -715,7 +845,6 @@ namespace rsgis { namespace img {
 		delete[] outMin;
 		
 		delete stretchImage;
-		delete calcImg;
 		delete function;
 		
 		if(datasets != NULL)
@@ -751,7 +880,6 @@ namespace rsgis { namespace img {
 	void RSGISStretchImageWithStats::executeLinearMinMaxStretch() 
 	{
 		GDALDataset **datasets = NULL;
-		RSGISCalcImage *calcImg = NULL;
 		RSGISLinearStretchImage *linearStretchImage = NULL;
 		double *imageMax = NULL;
 		double *imageMin = NULL;
@@ -783,8 +911,8 @@ namespace rsgis { namespace img {
 			delete stats;
 			
 			linearStretchImage = new RSGISLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData);
-			calcImg = new RSGISCalcImage(linearStretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+			RSGISApplyImageStretch applyStretch;
+			applyStretch.applyStretch(this->inputImage, linearStretchImage, this->outputImage, this->imageFormat, this->outDataType);
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -810,7 +938,6 @@ namespace rsgis { namespace img {
 		delete[] outMin;
 		
 		delete linearStretchImage;
-		delete calcImg;
 		
 		if(datasets != NULL)
 		{
@@ -820,13 +947,116 @@ namespace rsgis { namespace img {
 	
 	void RSGISStretchImageWithStats::executeHistogramStretch() 
 	{
-		throw RSGISImageCalcException("Histogram Stretch is not implmented yet\n");
+		RSGISHistogramStretchImage *histStretchImage = NULL;
+		std::vector<BandHistogramCDF> *cdfs = NULL;
+		try
+		{
+			int numBands = inputImage->GetRasterCount();
+			cdfs = this->readHistogramCDFs(this->inStatsFile);
+			
+			std::vector<BandHistogramCDF> bandCDFs(numBands);
+			std::vector<bool> foundBand(numBands, false);
+			for(std::vector<BandHistogramCDF>::iterator iterCDF = cdfs->begin(); iterCDF != cdfs->end(); ++iterCDF)
+			{
+				if(((*iterCDF).band >= 1) && ((*iterCDF).band <= ((size_t)numBands)))
+				{
+					bandCDFs[(*iterCDF).band-1] = *iterCDF;
+					foundBand[(*iterCDF).band-1] = true;
+				}
+			}
+			delete cdfs;
+			cdfs = NULL;
+			for(int i = 0; i < numBands; i++)
+			{
+				if(!foundBand[i])
+				{
+					throw RSGISImageCalcException("The statistics file does not have a histogram for every image band.");
+				}
+			}
+			
+			histStretchImage = new RSGISHistogramStretchImage(numBands, &bandCDFs, this->outMinVal, this->outMaxVal, this->useNoData, this->inNoData, this->outNoData);
+			RSGISApplyImageStretch applyStretch;
+			applyStretch.applyStretch(this->inputImage, histStretchImage, this->outputImage, this->imageFormat, this->outDataType);
+		}
+		catch(RSGISImageCalcException &e)
+		{
+			if(cdfs != NULL)
+			{
+				delete cdfs;
+			}
+			if(histStretchImage != NULL)
+			{
+				delete histStretchImage;
+			}
+			throw e;
+		}
+		catch(rsgis::RSGISFileException &e)
+		{
+			throw RSGISImageCalcException(e.what());
+		}
+		
+		delete histStretchImage;
 	}
+    
+    std::vector<BandHistogramCDF>* RSGISStretchImageWithStats::readHistogramCDFs(std::string inputFile)
+    {
+        std::vector<BandHistogramCDF> *bandCDFs = new std::vector<BandHistogramCDF>();
+        
+        try
+        {
+            std::vector<std::string> tokens;
+            std::vector<std::string> valTokens;
+            
+            rsgis::utils::RSGISTextUtils textUtils;
+            rsgis::utils::RSGISTextFileLineReader reader;
+            std::string line = "";
+            reader.openFile(inputFile);
+            while(!reader.endOfFile())
+            {
+                line = reader.readLine();
+                
+                if(textUtils.lineStart(line, '#') && (line.substr(0, 5) == "#cdf,") && (line.substr(0, 9) != "#cdf,band"))
+                {
+                    tokens.clear();
+                    textUtils.tokenizeString(line, ',', &tokens, true, true);
+                    if(tokens.size() != 5)
+                    {
+                        throw rsgis::utils::RSGISTextException("A histogram line should have 5 tokens (#cdf,band,hist_min,bin_width,values).");
+                    }
+                    
+                    BandHistogramCDF bandCDF(textUtils.strtosizet(tokens.at(1)), textUtils.strtodouble(tokens.at(2)), textUtils.strtodouble(tokens.at(3)));
+                    valTokens.clear();
+                    textUtils.tokenizeString(tokens.at(4), ' ', &valTokens, true, true);
+                    for(std::vector<std::string>::iterator iterVals = valTokens.begin(); iterVals != valTokens.end(); ++iterVals)
+                    {
+                        bandCDF.cdf.push_back(textUtils.strtodouble(*iterVals));
+                    }
+                    if(bandCDF.cdf.empty())
+                    {
+                        throw rsgis::utils::RSGISTextException("A histogram line does not have any values.");
+                    }
+                    bandCDFs->push_back(bandCDF);
+                }
+            }
+            reader.closeFile();
+        }
+        catch(rsgis::RSGISFileException &e)
+        {
+            delete bandCDFs;
+            throw e;
+        }
+        catch(rsgis::utils::RSGISTextException &e)
+        {
+            delete bandCDFs;
+            throw rsgis::RSGISFileException(e.what());
+        }
+        
+        return bandCDFs;
+    }
 	
 	void RSGISStretchImageWithStats::executeExponentialStretch() 
 	{
 		GDALDataset **datasets = NULL;
-		RSGISCalcImage *calcImg = NULL;
 		RSGISFuncLinearStretchImage *stretchImage = NULL;
 		double *imageMax = NULL;
 		double *imageMin = NULL;
@@ -861,8 +1091,8 @@ namespace rsgis { namespace img {
 			delete stats;
 			
 			stretchImage = new RSGISFuncLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData, function);
-			calcImg = new RSGISCalcImage(stretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+			RSGISApplyImageStretch applyStretch;
+			applyStretch.applyStretch(this->inputImage, stretchImage, this->outputImage, this->imageFormat, this->outDataType);
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -888,7 +1118,6 @@ namespace rsgis { namespace img {
 		delete[] outMin;
 		
 		delete stretchImage;
-		delete calcImg;
 		delete function;
 		
 		if(datasets != NULL)
@@ -900,7 +1129,6 @@ namespace rsgis { namespace img {
 	void RSGISStretchImageWithStats::executeLogrithmicStretch() 
 	{
 		GDALDataset **datasets = NULL;
-		RSGISCalcImage *calcImg = NULL;
 		RSGISFuncLinearStretchImage *stretchImage = NULL;
 		double *imageMax = NULL;
 		double *imageMin = NULL;
@@ -935,8 +1163,8 @@ namespace rsgis { namespace img {
 			delete stats;
 			
 			stretchImage = new RSGISFuncLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin, this->useNoData, this->inNoData, this->outNoData, function);
-			calcImg = new RSGISCalcImage(stretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+			RSGISApplyImageStretch applyStretch;
+			applyStretch.applyStretch(this->inputImage, stretchImage, this->outputImage, this->imageFormat, this->outDataType);
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -962,7 +1190,6 @@ namespace rsgis { namespace img {
 		delete[] outMin;
 		
 		delete stretchImage;
-		delete calcImg;
 		delete function;
 		
 		if(datasets != NULL)
@@ -974,7 +1201,6 @@ namespace rsgis { namespace img {
 	void RSGISStretchImageWithStats::executePowerLawStretch(float power) 
 	{
 		GDALDataset **datasets = NULL;
-		RSGISCalcImage *calcImg = NULL;
 		RSGISFuncLinearStretchImage *stretchImage = NULL;
 		double *imageMax = NULL;
 		double *imageMin = NULL;
@@ -1009,8 +1235,8 @@ namespace rsgis { namespace img {
 			delete stats;
 			
 			stretchImage = new RSGISFuncLinearStretchImage(numBands, imageMax, imageMin, outMax, outMin,  this->useNoData, this->inNoData, this->outNoData, function);
-			calcImg = new RSGISCalcImage(stretchImage, "", true);
-			calcImg->calcImage(datasets, 1, outputImage, false, NULL, imageFormat, outDataType);
+			RSGISApplyImageStretch applyStretch;
+			applyStretch.applyStretch(this->inputImage, stretchImage, this->outputImage, this->imageFormat, this->outDataType);
 			
 		}
 		catch(RSGISImageCalcException &e)
@@ -1036,7 +1262,6 @@ namespace rsgis { namespace img {
 		delete[] outMin;
 		
 		delete stretchImage;
-		delete calcImg;
 		delete function;
 		
 		if(datasets != NULL)
@@ -1239,6 +1464,274 @@ namespace rsgis { namespace img {
 	}
 	
 	
+	RSGISApplyImageStretch::RSGISApplyImageStretch(unsigned int numThreads)
+	{
+		this->numThreads = numThreads;
+	}
+	
+	void RSGISApplyImageStretch::applyStretch(GDALDataset *inputImage, RSGISCalcImageValue *stretch, std::string outputImage, std::string imageFormat, GDALDataType outDataType)
+	{
+		int numBands = inputImage->GetRasterCount();
+		int width = inputImage->GetRasterXSize();
+		int height = inputImage->GetRasterYSize();
+		if(stretch->getNumOutBands() != numBands)
+		{
+			throw RSGISImageCalcException("The stretch does not have the same number of bands as the input image.");
+		}
+		
+		std::vector<bool> useLUT(numBands, false);
+		bool allLUT = true;
+		long lutMin = 0;
+		long lutMax = -1;
+		for(int i = 0; i < numBands; i++)
+		{
+			GDALDataType bandType = inputImage->GetRasterBand(i+1)->GetRasterDataType();
+			long typeMin = 0;
+			long typeMax = 0;
+			if(bandType == GDT_Byte)
+			{
+				typeMax = 255;
+			}
+			else if(bandType == GDT_UInt16)
+			{
+				typeMax = 65535;
+			}
+			else if(bandType == GDT_Int16)
+			{
+				typeMin = -32768;
+				typeMax = 32767;
+			}
+			else
+			{
+				allLUT = false;
+				continue;
+			}
+			if(lutMax < lutMin)
+			{
+				lutMin = typeMin;
+				lutMax = typeMax;
+			}
+			else
+			{
+				lutMin = std::min(lutMin, typeMin);
+				lutMax = std::max(lutMax, typeMax);
+			}
+			useLUT[i] = true;
+		}
+		
+		// Lookup tables for every band are built together with one call to the stretch per value.
+		size_t lutSize = 0;
+		std::vector<double> lut;
+		if(lutMax >= lutMin)
+		{
+			lutSize = lutMax - lutMin + 1;
+			lut.resize(lutSize * numBands);
+			std::vector<float> inVals(numBands);
+			std::vector<double> outVals(numBands);
+			for(long val = lutMin; val <= lutMax; ++val)
+			{
+				std::fill(inVals.begin(), inVals.end(), (float)val);
+				stretch->calcImageValue(inVals.data(), numBands, outVals.data());
+				for(int i = 0; i < numBands; i++)
+				{
+					lut[(i * lutSize) + (val - lutMin)] = outVals[i];
+				}
+			}
+		}
+		
+		int xBlockSize = 0;
+		int yBlockSize = 0;
+		inputImage->GetRasterBand(1)->GetBlockSize(&xBlockSize, &yBlockSize);
+		if(yBlockSize < 1)
+		{
+			yBlockSize = 1;
+		}
+		int stripRows = yBlockSize;
+		while(((((size_t)stripRows) * width * numBands) < 2097152) && (stripRows < height))
+		{
+			stripRows += yBlockSize;
+		}
+		size_t numStrips = (height + stripRows - 1) / stripRows;
+		
+		RSGISImageUtils imgUtils;
+		GDALDataset *outDS = imgUtils.createCopy(inputImage, numBands, outputImage, imageFormat, outDataType);
+		
+		RSGISImageThreadUtils threadUtils;
+		std::vector<GDALDataset*> handles = threadUtils.openDatasetHandles(inputImage, threadUtils.getNumThreads(this->numThreads));
+		std::mutex writeMutex;
+		try
+		{
+			std::cout << "Applying the stretch\n";
+			threadUtils.runTasks(handles.size(), numStrips, [&](unsigned int threadIdx, size_t strip)
+			{
+				GDALDataset *inDS = handles[threadIdx];
+				int startRow = strip * stripRows;
+				int numRows = std::min(stripRows, height - startRow);
+				size_t numPxls = ((size_t)width) * numRows;
+				
+				std::vector<double> outVals(numPxls * numBands);
+				std::vector<float> pxlVals;
+				if(!allLUT)
+				{
+					pxlVals.resize(numPxls * numBands);
+				}
+				std::vector<int> intVals;
+				for(int i = 0; i < numBands; i++)
+				{
+					GDALRasterBand *band = inDS->GetRasterBand(i+1);
+					if(useLUT[i])
+					{
+						intVals.resize(numPxls);
+						if(band->RasterIO(GF_Read, 0, startRow, width, numRows, intVals.data(), width, numRows, GDT_Int32, 0, 0) != CE_None)
+						{
+							throw RSGISImageCalcException("Failed to read the input image.");
+						}
+						const double *bandLUT = &lut[i * lutSize];
+						double *bandOut = &outVals[i * numPxls];
+						for(size_t j = 0; j < numPxls; ++j)
+						{
+							bandOut[j] = bandLUT[intVals[j] - lutMin];
+						}
+						if(!allLUT)
+						{
+							for(size_t j = 0; j < numPxls; ++j)
+							{
+								pxlVals[(j * numBands) + i] = intVals[j];
+							}
+						}
+					}
+					else if(band->RasterIO(GF_Read, 0, startRow, width, numRows, &pxlVals[i], width, numRows, GDT_Float32, sizeof(float) * numBands, sizeof(float) * numBands * width) != CE_None)
+					{
+						throw RSGISImageCalcException("Failed to read the input image.");
+					}
+				}
+				
+				if(!allLUT)
+				{
+					std::vector<double> pxlOut(numBands);
+					for(size_t j = 0; j < numPxls; ++j)
+					{
+						stretch->calcImageValue(&pxlVals[j * numBands], numBands, pxlOut.data());
+						for(int i = 0; i < numBands; i++)
+						{
+							if(!useLUT[i])
+							{
+								outVals[(i * numPxls) + j] = pxlOut[i];
+							}
+						}
+					}
+				}
+				
+				std::lock_guard<std::mutex> lock(writeMutex);
+				for(int i = 0; i < numBands; i++)
+				{
+					if(outDS->GetRasterBand(i+1)->RasterIO(GF_Write, 0, startRow, width, numRows, &outVals[i * numPxls], width, numRows, GDT_Float64, 0, 0) != CE_None)
+					{
+						throw RSGISImageCalcException("Failed to write the output image.");
+					}
+				}
+			});
+		}
+		catch(rsgis::RSGISException &e)
+		{
+			threadUtils.closeDatasetHandles(&handles);
+			GDALClose(outDS);
+			throw RSGISImageCalcException(e.what());
+		}
+		threadUtils.closeDatasetHandles(&handles);
+		GDALClose(outDS);
+	}
+	
+	RSGISHistogramStretchImage::RSGISHistogramStretchImage(int numberOutBands, std::vector<BandHistogramCDF> *bandCDFs, double outMin, double outMax, bool useNoData, double inNoData, double outNoData) : RSGISCalcImageValue(numberOutBands)
+	{
+		if(bandCDFs->size() != ((size_t)numberOutBands))
+		{
+			throw RSGISImageCalcException("A histogram is needed for each band.");
+		}
+		this->bandCDFs = *bandCDFs;
+		this->outMin = outMin;
+		this->outMax = outMax;
+        this->useNoData = useNoData;
+        this->inNoData = inNoData;
+        this->outNoData = outNoData;
+	}
+	
+	void RSGISHistogramStretchImage::calcImageValue(float *bandValues, int numBands, double *output)
+	{
+        double outVal = 0;
+		for(int i = 0; i < numBands; i++)
+		{
+			if(boost::math::isnan(bandValues[i]))
+			{
+                output[i] = this->useNoData?this->outNoData:this->outMin;
+			}
+            else if(this->useNoData && (bandValues[i] == this->inNoData))
+            {
+                output[i] = this->outNoData;
+            }
+			else
+			{
+                const BandHistogramCDF &bandCDF = this->bandCDFs[i];
+                double binPos = (bandValues[i] - bandCDF.histMin) / bandCDF.binWidth;
+                size_t bin = 0;
+                if(binPos >= bandCDF.cdf.size())
+                {
+                    bin = bandCDF.cdf.size()-1;
+                }
+                else if(binPos > 0)
+                {
+                    bin = (size_t)binPos;
+                }
+                outVal = this->outMin + (bandCDF.cdf[bin] * (this->outMax - this->outMin));
+                if(outVal == this->outNoData)
+                {
+                    if(this->outNoData == this->outMax)
+                    {
+                        output[i] = outVal - 1;
+                    }
+                    else
+                    {
+                        output[i] = outVal + 1;
+                    }
+                }
+                else
+                {
+                    output[i] = outVal;
+                }
+			}
+		}
+	}
+	
+	void RSGISHistogramStretchImage::calcCDF(const std::vector<double> &histogram, std::vector<double> *cdf)
+	{
+		// Equalisation: the lowest occupied bin maps to 0 and the highest to 1.
+		double total = 0;
+		double firstCount = -1;
+		for(size_t i = 0; i < histogram.size(); ++i)
+		{
+			if((firstCount < 0) && (histogram[i] > 0))
+			{
+				firstCount = histogram[i];
+			}
+			total += histogram[i];
+		}
+		
+		cdf->assign(histogram.size(), 0.0);
+		if((firstCount < 0) || (total <= firstCount))
+		{
+			return;
+		}
+		double cumCount = 0;
+		for(size_t i = 0; i < histogram.size(); ++i)
+		{
+			cumCount += histogram[i];
+			if(cumCount > firstCount)
+			{
+				cdf->at(i) = (cumCount - firstCount) / (total - firstCount);
+			}
+		}
+	}
+	
 }}
 
 
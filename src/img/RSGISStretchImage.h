@@ -28,6 +28,8 @@
 #include <fstream>
 #include <math.h>
 #include <float.h>
+#include <vector>
+#include <mutex>
 
 #include "common/RSGISFileException.h"
 
@@ -39,6 +41,8 @@
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISImageStatistics.h"
+#include "img/RSGISSinglePassImageStats.h"
+#include "img/RSGISImageThreadUtils.h"
 
 #include "math/RSGISMathFunction.h"
 #include "math/RSGISMathException.h"
@@ -82,11 +86,32 @@ namespace rsgis { namespace img {
         float outNoDataVal;
     };
     
+    struct DllExport BandHistogramCDF
+    {
+        BandHistogramCDF(){};
+        BandHistogramCDF(size_t band, double histMin, double binWidth)
+        {
+            this->band = band;
+            this->histMin = histMin;
+            this->binWidth = binWidth;
+        }
+        size_t band;
+        double histMin;
+        double binWidth;
+        std::vector<double> cdf;
+    };
+    
 
 	class DllExport RSGISStretchImage
 	{
 	public:
-		RSGISStretchImage(GDALDataset *inputImage, std::string outputImage, bool outStats, std::string outStatsFile, bool onePassSD, std::string imageFormat, GDALDataType outDataType, float outMinVal, float outMaxVal, bool useNoData, double inNoData, double outNoData);
+        /**
+         * Unless useMetadataStats is false the linear and histogram stretches take
+         * the statistics/histogram stored in the band metadata when present (and
+         * the band no data value matches inNoData), otherwise they are calculated
+         * in a single pass, optionally from an overview (useOverviews).
+         */
+		RSGISStretchImage(GDALDataset *inputImage, std::string outputImage, bool outStats, std::string outStatsFile, bool onePassSD, std::string imageFormat, GDALDataType outDataType, float outMinVal, float outMaxVal, bool useNoData, double inNoData, double outNoData, bool useMetadataStats=true, bool useOverviews=false);
 		void executeLinearMinMaxStretch();
 		void executeLinearPercentStretch(float percent);
 		void executeLinearStdDevStretch(float stddev);
@@ -94,6 +119,12 @@ namespace rsgis { namespace img {
 		void executeExponentialStretch();
 		void executeLogrithmicStretch();
 		void executePowerLawStretch(float power);
+        /**
+         * Provide statistics which have already been calculated for the input image
+         * (e.g., by RSGISSinglePassImageStats) so the linear stretches do not need
+         * to re-read the image to calculate them.
+         */
+        void setBandSummaries(std::vector<ImageBandSummary> *bandSummaries);
         
         static std::vector<BandSpecThresholdStats>* readBandSpecThresholds(std::string inputFile)
         {
@@ -156,6 +187,9 @@ namespace rsgis { namespace img {
         };
 		~RSGISStretchImage();
 	protected:
+        void calcBandStats(ImageStats **stats, int numBands);
+        void calcBandHistogramCDFs(std::vector<BandHistogramCDF> *bandCDFs);
+        bool useBandMetadata(GDALRasterBand *band);
 		GDALDataset *inputImage;
         std::string outputImage;
         bool outStats;
@@ -168,6 +202,10 @@ namespace rsgis { namespace img {
         bool useNoData;
         double inNoData;
         double outNoData;
+        bool useMetadataStats;
+        bool useOverviews;
+        std::vector<ImageBandSummary> bandSummaries;
+        bool haveBandSummaries;
 	};
     
     class DllExport RSGISStretchImageWithStats
@@ -239,6 +277,11 @@ namespace rsgis { namespace img {
             
             return bandStats;
         };
+        /**
+         * Read the "#cdf,band,hist_min,bin_width,values" lines written alongside
+         * the thresholds by RSGISStretchImage::executeHistogramStretch.
+         */
+        static std::vector<BandHistogramCDF>* readHistogramCDFs(std::string inputFile);
 		~RSGISStretchImageWithStats();
 	protected:
 		GDALDataset *inputImage;
@@ -253,6 +296,24 @@ namespace rsgis { namespace img {
         double outNoData;
 	};
 
+    /**
+     * Applies a stretch to every band of an image, with strips of the image
+     * shared between threads. The stretch must calculate each output band
+     * from the matching input band alone (as all the stretches in this file
+     * do) and must be safe to call from several threads. Byte, Int16 and
+     * UInt16 bands are stretched through a lookup table built once from the
+     * stretch rather than by calling it for every pixel.
+     */
+    class DllExport RSGISApplyImageStretch
+    {
+    public:
+        RSGISApplyImageStretch(unsigned int numThreads=0);
+        void applyStretch(GDALDataset *inputImage, RSGISCalcImageValue *stretch, std::string outputImage, std::string imageFormat, GDALDataType outDataType);
+        ~RSGISApplyImageStretch(){};
+    protected:
+        unsigned int numThreads;
+    };
+
 	class DllExport RSGISExponentStretchFunction : public rsgis::math::RSGISMathFunction
 	{
 	public:
@@ -342,6 +403,22 @@ namespace rsgis { namespace img {
 		rsgis::math::RSGISMathFunction *func;
 	};
 
+	class DllExport RSGISHistogramStretchImage : public RSGISCalcImageValue
+	{
+	public:
+		RSGISHistogramStretchImage(int numberOutBands, std::vector<BandHistogramCDF> *bandCDFs, double outMin, double outMax, bool useNoData, double inNoData, double outNoData);
+		void calcImageValue(float *bandValues, int numBands, double *output);
+        static void calcCDF(const std::vector<double> &histogram, std::vector<double> *cdf);
+		~RSGISHistogramStretchImage(){};
+	protected:
+		std::vector<BandHistogramCDF> bandCDFs;
+		double outMin;
+		double outMax;
+        bool useNoData;
+        double inNoData;
+        double outNoData;
+	};
+
 }}
 
 #endif
@@ -26,6 +26,14 @@
 
 namespace rsgis {namespace math{
     
+    void RSGIS2DInterpolator::getValues(double eastings, double northings, double xStep, unsigned int numVals, float *outVals)
+    {
+        for(unsigned int i = 0; i < numVals; ++i)
+        {
+            outVals[i] = this->getValue(eastings + (i * xStep), northings);
+        }
+    }
+    
     
     RSGISSearchKNN2DInterpolator::RSGISSearchKNN2DInterpolator(unsigned int k): RSGIS2DInterpolator()
     {
@@ -134,78 +142,114 @@ namespace rsgis {namespace math{
                 throw RSGISInterpolationException("Data points sit on a line and therefore cannot triangulate.");
             }
             
-            dt = new DelaunayTriangulation();
-            values = new PointValueMap();
-            
+            std::vector<double> coords;
+            coords.reserve(pts->size() * 2);
+            this->values.clear();
+            this->values.reserve(pts->size());
             for(std::vector<RSGISInterpolatorDataPoint>::iterator iterPts = pts->begin(); iterPts != pts->end(); ++iterPts)
             {
-                K::Point_2 cgalPt((*iterPts).x,(*iterPts).y);
-                dt->insert(cgalPt);
-                CGALCoordType value = (*iterPts).value;
-                values->insert(std::make_pair(cgalPt, value));
+                coords.push_back((*iterPts).x);
+                coords.push_back((*iterPts).y);
+                this->values.push_back((*iterPts).value);
             }
+            
+            if(this->tin != NULL)
+            {
+                delete this->tin;
+                this->tin = NULL;
+            }
+            this->tin = new RSGISDelaunayTIN(coords.data(), pts->size());
         }
         catch(RSGISInterpolationException &e)
         {
             throw e;
         }
+        catch(RSGISMathException &e)
+        {
+            throw RSGISInterpolationException(e.what());
+        }
         initialised = true;
     }
     
+    double RSGIS2DTriagulatorInterpolator::getValue(double eastings, double northings)
+    {
+        if(!initialised)
+        {
+            throw RSGISInterpolationException("Interpolated needs to be initialised before values can be retrieved.");
+        }
+        return this->getTINValue(eastings, northings, this->getWalkHint());
+    }
     
+    void RSGIS2DTriagulatorInterpolator::getValues(double eastings, double northings, double xStep, unsigned int numVals, float *outVals)
+    {
+        if(!initialised)
+        {
+            throw RSGISInterpolationException("Interpolated needs to be initialised before values can be retrieved.");
+        }
+        // Consecutive positions along the row are in the same or a neighbouring triangle.
+        int tri = -1;
+        for(unsigned int i = 0; i < numVals; ++i)
+        {
+            outVals[i] = this->getTINValue(eastings + (i * xStep), northings, &tri);
+        }
+    }
     
+    int* RSGIS2DTriagulatorInterpolator::getWalkHint() const
+    {
+        // Each thread keeps the last triangle found in the TINs it has used most
+        // recently, so a walk for the next pixel starts next to it. The index is
+        // only a starting point so a stale entry cannot give a wrong value.
+        struct TINWalkHint
+        {
+            const RSGISDelaunayTIN *tin;
+            int tri;
+        };
+        static thread_local TINWalkHint hints[4] = {{NULL, -1}, {NULL, -1}, {NULL, -1}, {NULL, -1}};
+        static thread_local unsigned int nextHint = 0;
+        for(unsigned int i = 0; i < 4; ++i)
+        {
+            if(hints[i].tin == this->tin)
+            {
+                return &hints[i].tri;
+            }
+        }
+        TINWalkHint *hint = &hints[nextHint];
+        nextHint = (nextHint + 1) % 4;
+        hint->tin = this->tin;
+        hint->tri = -1;
+        return &hint->tri;
+    }
     
-    double RSGISNearestNeighbour2DInterpolator::getValue(double eastings, double northings)
+    RSGIS2DTriagulatorInterpolator::~RSGIS2DTriagulatorInterpolator()
     {
-        double outValue = std::numeric_limits<double>::signaling_NaN();
-		if(initialised)
-		{
-            CGALPoint p(eastings, northings);
-            Vertex_handle vh = dt->nearest_vertex(p);
-            CGALPoint nearestPt = vh->point();
-            PointValueMap::iterator iterVal = values->find(nearestPt);
-            outValue = (*iterVal).second;
-		}
-		else
-		{
-			throw RSGISInterpolationException("Interpolated needs to be initialised before values can be retrieved.");
-		}
-		return outValue;
+        if(this->tin != NULL)
+        {
+            delete this->tin;
+        }
     }
     
     
     
     
-    double RSGISNaturalNeighbor2DInterpolator::getValue(double eastings, double northings)
+    double RSGISNearestNeighbour2DInterpolator::getTINValue(double eastings, double northings, int *tri) const
     {
-        float outValue = std::numeric_limits<float>::signaling_NaN();
-        if(initialised)
+        return this->values[this->tin->findNearestPt(eastings, northings, tri)];
+    }
+    
+    
+    
+    
+    double RSGISNaturalNeighbor2DInterpolator::getTINValue(double eastings, double northings, int *tri) const
+    {
+        std::vector<std::pair<size_t, double> > weights;
+        if(!this->tin->calcNaturalNeighbourWeights(eastings, northings, tri, &weights))
         {
-            try
-            {
-                K::Point_2 p(eastings, northings);
-                CoordinateVector coords;
-                CGAL::Triple<std::back_insert_iterator<CoordinateVector>, K::FT, bool> result = CGAL::natural_neighbor_coordinates_2(*dt, p, std::back_inserter(coords));
-                if(!result.third)
-                {
-                    Vertex_handle vh = dt->nearest_vertex(p);
-                    CGALPoint nearestPt = vh->point();
-                    PointValueMap::iterator iterVal = values->find(nearestPt);
-                    outValue = (*iterVal).second;
-                }
-                else
-                {
-                    CGALCoordType norm = result.second;
-                    
-                    CGALCoordType outDataValue = CGAL::linear_interpolation(coords.begin(), coords.end(), norm, CGAL::Data_access<PointValueMap>(*this->values));
-                    
-                    outValue = outDataValue;
-                }
-            }
-            catch(RSGISInterpolationException &e)
-            {
-                throw e;
-            }
+            return this->values[this->tin->findNearestPt(eastings, northings, tri)];
+        }
+        double outValue = 0.0;
+        for(std::vector<std::pair<size_t, double> >::iterator iterWeights = weights.begin(); iterWeights != weights.end(); ++iterWeights)
+        {
+            outValue += (*iterWeights).second * this->values[(*iterWeights).first];
         }
         return outValue;
     }
@@ -213,33 +257,17 @@ namespace rsgis {namespace math{
     
     
     
-    double RSGISNaturalNearestNeighbor2DInterpolator::getValue(double eastings, double northings)
+    double RSGISNaturalNearestNeighbor2DInterpolator::getTINValue(double eastings, double northings, int *tri) const
     {
-        float outValue = std::numeric_limits<float>::signaling_NaN();
-        if(initialised)
+        std::vector<std::pair<size_t, double> > weights;
+        if(!this->tin->calcNaturalNeighbourWeights(eastings, northings, tri, &weights))
         {
-            try
-            {
-                K::Point_2 p(eastings, northings);
-                CoordinateVector coords;
-                CGAL::Triple<std::back_insert_iterator<CoordinateVector>, K::FT, bool> result = CGAL::natural_neighbor_coordinates_2(*dt, p, std::back_inserter(coords));
-                if(!result.third)
-                {
-                    outValue = std::numeric_limits<float>::signaling_NaN();
-                }
-                else
-                {
-                    CGALCoordType norm = result.second;
-                    
-                    CGALCoordType outDataValue = CGAL::linear_interpolation(coords.begin(), coords.end(), norm, CGAL::Data_access<PointValueMap>(*this->values));
-                    
-                    outValue = outDataValue;
-                }
-            }
-            catch(RSGISInterpolationException &e)
-            {
-                throw e;
-            }
+            return std::numeric_limits<float>::signaling_NaN();
+        }
+        double outValue = 0.0;
+        for(std::vector<std::pair<size_t, double> >::iterator iterWeights = weights.begin(); iterWeights != weights.end(); ++iterWeights)
+        {
+            outValue += (*iterWeights).second * this->values[(*iterWeights).first];
         }
         return outValue;
     }
@@ -247,6 +275,20 @@ namespace rsgis {namespace math{
     
     
     
+    double RSGISLinearTIN2DInterpolator::getTINValue(double eastings, double northings, int *tri) const
+    {
+        size_t ptIdxs[3];
+        double weights[3];
+        if(!this->tin->calcLinearWeights(eastings, northings, tri, ptIdxs, weights))
+        {
+            return std::numeric_limits<float>::signaling_NaN();
+        }
+        return (weights[0] * this->values[ptIdxs[0]]) + (weights[1] * this->values[ptIdxs[1]]) + (weights[2] * this->values[ptIdxs[2]]);
+    }
+    
+    
+    
+    
     double RSGISKNearestNeighbour2DInterpolator::getValue(double eastings, double northings)
     {
         float outValue = std::numeric_limits<float>::signaling_NaN();
@@ -494,6 +536,28 @@ namespace rsgis {namespace math{
         return outVal;
     }
     
+    void RSGISCombine2DInterpolators::getValues(double eastings, double northings, double xStep, unsigned int numVals, float *outVals)
+    {
+        try
+        {
+            this->interp1->getValues(eastings, northings, xStep, numVals, outVals);
+            for(unsigned int i = 0; i < numVals; ++i)
+            {
+                if((outVals[i] > upperThres) | (outVals[i] < lowerThres))
+                {
+                    outVals[i] = this->interp2->getValue(eastings + (i * xStep), northings);
+                }
+            }
+        }
+        catch(RSGISInterpolationException &e)
+        {
+            throw e;
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISInterpolationException(e.what());
+        }
+    }
     
 }}
 
@@ -25,20 +25,15 @@
 #define RSGIS2DInterpolation_H
 
 #include <iostream>
+#include <vector>
+#include <list>
+#include <limits>
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
 
 #include "RSGISMathsUtils.h"
-
-#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
-#include <CGAL/Delaunay_triangulation_2.h>
-#include <CGAL/Interpolation_traits_2.h>
-#include <CGAL/natural_neighbor_coordinates_2.h>
-#include <CGAL/interpolation_functions.h>
-#include <CGAL/algorithm.h>
-#include <CGAL/Origin.h>
-#include <CGAL/squared_distance_2.h>
+#include "math/RSGISDelaunayTIN.h"
 
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
@@ -53,18 +48,6 @@
     #define DllExport
 #endif
 
-typedef CGAL::Exact_predicates_inexact_constructions_kernel K;
-typedef K::FT                                         CGALCoordType;
-typedef K::Vector_2                                   CGALVector;
-typedef K::Point_2                                    CGALPoint;
-
-typedef CGAL::Delaunay_triangulation_2<K>             DelaunayTriangulation;
-typedef CGAL::Interpolation_traits_2<K>               InterpTraits;
-typedef CGAL::Delaunay_triangulation_2<K>::Vertex_handle    Vertex_handle;
-
-typedef std::vector< std::pair<CGALPoint, CGALCoordType> >   CoordinateVector;
-typedef std::map<CGALPoint, CGALCoordType, K::Less_xy_2>     PointValueMap;
-
 namespace rsgis {namespace math{
     
     class DllExport RSGISInterpolationException : public RSGISMathException
@@ -94,6 +77,12 @@ namespace rsgis {namespace math{
 		RSGIS2DInterpolator(){};
 		virtual void initInterpolator(std::vector<RSGISInterpolatorDataPoint> *pts) = 0;
 		virtual double getValue(double eastings, double northings) = 0;
+        /**
+         * Values for numVals positions along a row, starting at (eastings, northings)
+         * and stepping xStep in the eastings. Once initialised, getValue and getValues
+         * may be called from several threads at once.
+         */
+        virtual void getValues(double eastings, double northings, double xStep, unsigned int numVals, float *outVals);
 		virtual ~RSGIS2DInterpolator(){};
 	protected:
 		bool initialised;
@@ -115,37 +104,55 @@ namespace rsgis {namespace math{
     class DllExport RSGIS2DTriagulatorInterpolator: public RSGIS2DInterpolator
 	{
 	public:
-		RSGIS2DTriagulatorInterpolator():RSGIS2DInterpolator(){};
+		RSGIS2DTriagulatorInterpolator():RSGIS2DInterpolator(){this->tin = NULL; this->initialised = false;};
 		virtual void initInterpolator(std::vector<RSGISInterpolatorDataPoint> *pts);
-		virtual double getValue(double eastings, double northings) = 0;
-		virtual ~RSGIS2DTriagulatorInterpolator(){};
+		virtual double getValue(double eastings, double northings);
+        virtual void getValues(double eastings, double northings, double xStep, unsigned int numVals, float *outVals);
+		virtual ~RSGIS2DTriagulatorInterpolator();
 	protected:
-		DelaunayTriangulation *dt;
-        PointValueMap *values;
+        /** tri is the triangle the walk starts from and is updated to the one containing the point. */
+        virtual double getTINValue(double eastings, double northings, int *tri) const = 0;
+        int* getWalkHint() const;
+		RSGISDelaunayTIN *tin;
+        std::vector<double> values;
 	};
     
 	class DllExport RSGISNearestNeighbour2DInterpolator : public RSGIS2DTriagulatorInterpolator
 	{
 	public:
 		RSGISNearestNeighbour2DInterpolator():RSGIS2DTriagulatorInterpolator(){};
-		double getValue(double eastings, double northings);
 		~RSGISNearestNeighbour2DInterpolator(){};
+    protected:
+        double getTINValue(double eastings, double northings, int *tri) const;
 	};
     
     class DllExport RSGISNaturalNeighbor2DInterpolator :public RSGIS2DTriagulatorInterpolator
 	{
 	public:
 		RSGISNaturalNeighbor2DInterpolator():RSGIS2DTriagulatorInterpolator(){};
-		double getValue(double eastings, double northings);
 		~RSGISNaturalNeighbor2DInterpolator(){};
+    protected:
+        double getTINValue(double eastings, double northings, int *tri) const;
 	};
     
     class DllExport RSGISNaturalNearestNeighbor2DInterpolator :public RSGIS2DTriagulatorInterpolator
 	{
 	public:
 		RSGISNaturalNearestNeighbor2DInterpolator():RSGIS2DTriagulatorInterpolator(){};
-		double getValue(double eastings, double northings);
 		~RSGISNaturalNearestNeighbor2DInterpolator(){};
+    protected:
+        double getTINValue(double eastings, double northings, int *tri) const;
+	};
+    
+    
+    /** Linear interpolation within the triangle containing the point, NaN outside of the convex hull. */
+    class DllExport RSGISLinearTIN2DInterpolator :public RSGIS2DTriagulatorInterpolator
+	{
+	public:
+		RSGISLinearTIN2DInterpolator():RSGIS2DTriagulatorInterpolator(){};
+		~RSGISLinearTIN2DInterpolator(){};
+    protected:
+        double getTINValue(double eastings, double northings, int *tri) const;
 	};
     
     
@@ -194,6 +201,7 @@ namespace rsgis {namespace math{
         };
         void initInterpolator(std::vector<RSGISInterpolatorDataPoint> *pts);
 		double getValue(double eastings, double northings);
+        void getValues(double eastings, double northings, double xStep, unsigned int numVals, float *outVals);
 		~RSGISCombine2DInterpolators()
         {
             delete interp1;
@@ -0,0 +1,819 @@
+/*
+ *  RSGISDelaunayTIN.cpp
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISDelaunayTIN.h"
+
+namespace rsgis{namespace math{
+
+    RSGISDelaunayTIN::RSGISDelaunayTIN(const double *coords, size_t numPts)
+    {
+        if(numPts < 3)
+        {
+            throw RSGISMathException("At least 3 points are needed to create a triangulation.");
+        }
+        if(numPts > ((size_t)(std::numeric_limits<int>::max() / 6)))
+        {
+            throw RSGISMathException("There are too many points to create a triangulation.");
+        }
+        this->numPts = numPts;
+
+        double minX = std::numeric_limits<double>::infinity();
+        double maxX = -std::numeric_limits<double>::infinity();
+        double minY = std::numeric_limits<double>::infinity();
+        double maxY = -std::numeric_limits<double>::infinity();
+        for(size_t i = 0; i < numPts; ++i)
+        {
+            if(!(std::isfinite(coords[i*2]) && std::isfinite(coords[(i*2)+1])))
+            {
+                throw RSGISMathException("The points to be triangulated must have finite coordinates.");
+            }
+            minX = std::min(minX, coords[i*2]);
+            maxX = std::max(maxX, coords[i*2]);
+            minY = std::min(minY, coords[(i*2)+1]);
+            maxY = std::max(maxY, coords[(i*2)+1]);
+        }
+
+        // The points are stored in the order of a Hilbert curve so that points
+        // (and triangles) near each other are near each other in memory.
+        std::vector<std::pair<uint64_t, int> > hilbertIdxs(numPts);
+        double scaleX = (maxX > minX)?(65535 / (maxX - minX)):0.0;
+        double scaleY = (maxY > minY)?(65535 / (maxY - minY)):0.0;
+        for(size_t i = 0; i < numPts; ++i)
+        {
+            hilbertIdxs[i].first = this->calcHilbertIdx((coords[i*2] - minX) * scaleX, (coords[(i*2)+1] - minY) * scaleY);
+            hilbertIdxs[i].second = i;
+        }
+        std::sort(hilbertIdxs.begin(), hilbertIdxs.end());
+
+        // The points are held relative to their centre so that the predicates
+        // are not calculated with large (e.g., projected) coordinates.
+        this->offsetX = (minX + maxX) / 2;
+        this->offsetY = (minY + maxY) / 2;
+        this->coords.resize(numPts * 2);
+        this->ptOrder.resize(numPts);
+        for(size_t i = 0; i < numPts; ++i)
+        {
+            size_t idx = hilbertIdxs[i].second;
+            this->coords[i*2] = coords[idx*2] - this->offsetX;
+            this->coords[(i*2)+1] = coords[(idx*2)+1] - this->offsetY;
+            this->ptOrder[i] = idx;
+        }
+
+        this->buildTriangulation();
+    }
+
+    bool RSGISDelaunayTIN::locate(double x, double y, int *tri) const
+    {
+        return this->walkToTriangle(x - this->offsetX, y - this->offsetY, tri);
+    }
+
+    size_t RSGISDelaunayTIN::findNearestPt(double x, double y, int *tri) const
+    {
+        x -= this->offsetX;
+        y -= this->offsetY;
+        this->walkToTriangle(x, y, tri);
+
+        int bestPt = -1;
+        double bestDist = std::numeric_limits<double>::infinity();
+        double dist = 0.0;
+        for(int k = 0; k < 3; ++k)
+        {
+            int pt = this->triangles[((*tri) * 3) + k];
+            dist = this->sqDist(pt, x, y);
+            if((dist < bestDist) || ((dist == bestDist) && (pt < bestPt)))
+            {
+                bestPt = pt;
+                bestDist = dist;
+            }
+        }
+
+        // Each point which is not the nearest has a Delaunay neighbour which is
+        // closer so move to the closest neighbour until none are closer.
+        bool moved = true;
+        while(moved)
+        {
+            moved = false;
+            int nextPt = bestPt;
+            int e0 = this->ptEdges[bestPt];
+            int e = e0;
+            do
+            {
+                int pt = this->triangles[e];
+                dist = this->sqDist(pt, x, y);
+                if((dist < bestDist) || ((dist == bestDist) && (pt < nextPt)))
+                {
+                    nextPt = pt;
+                    bestDist = dist;
+                }
+                int outEdge = nextEdge(e);
+                e = this->halfEdges[outEdge];
+                if(e == -1)
+                {
+                    // On the hull, the last neighbour is at the end of the outgoing edge.
+                    pt = this->triangles[nextEdge(outEdge)];
+                    dist = this->sqDist(pt, x, y);
+                    if((dist < bestDist) || ((dist == bestDist) && (pt < nextPt)))
+                    {
+                        nextPt = pt;
+                        bestDist = dist;
+                    }
+                    break;
+                }
+            }
+            while(e != e0);
+
+            if(nextPt != bestPt)
+            {
+                bestPt = nextPt;
+                moved = true;
+            }
+        }
+        return this->ptOrder[bestPt];
+    }
+
+    bool RSGISDelaunayTIN::calcLinearWeights(double x, double y, int *tri, size_t *ptIdxs, double *weights) const
+    {
+        x -= this->offsetX;
+        y -= this->offsetY;
+        if(!this->walkToTriangle(x, y, tri))
+        {
+            return false;
+        }
+        this->calcBarycentric(*tri, x, y, ptIdxs, weights);
+        return true;
+    }
+
+    bool RSGISDelaunayTIN::calcNaturalNeighbourWeights(double x, double y, int *tri, std::vector<std::pair<size_t, double> > *weights) const
+    {
+        weights->clear();
+        x -= this->offsetX;
+        y -= this->offsetY;
+        if(!this->walkToTriangle(x, y, tri))
+        {
+            return false;
+        }
+        int t = *tri;
+        for(int k = 0; k < 3; ++k)
+        {
+            int pt = this->triangles[(t * 3) + k];
+            if((this->coords[pt*2] == x) && (this->coords[(pt*2)+1] == y))
+            {
+                weights->push_back(std::pair<size_t, double>(this->ptOrder[pt], 1.0));
+                return true;
+            }
+        }
+
+        // The triangles whose circumcircle contains the point (i.e., those which
+        // would be removed if it was inserted); a connected set around t.
+        std::vector<int> cavity;
+        cavity.push_back(t);
+        for(size_t i = 0; i < cavity.size(); ++i)
+        {
+            for(int k = 0; k < 3; ++k)
+            {
+                int twin = this->halfEdges[(cavity[i] * 3) + k];
+                if(twin == -1)
+                {
+                    continue;
+                }
+                int nt = twin / 3;
+                if((std::find(cavity.begin(), cavity.end(), nt) == cavity.end()) && this->inCircumcircle(this->triangles[nt*3], this->triangles[(nt*3)+1], this->triangles[(nt*3)+2], x, y))
+                {
+                    cavity.push_back(nt);
+                }
+            }
+        }
+
+        std::vector<int> boundary;
+        for(std::vector<int>::iterator iterTri = cavity.begin(); iterTri != cavity.end(); ++iterTri)
+        {
+            for(int k = 0; k < 3; ++k)
+            {
+                int e = ((*iterTri) * 3) + k;
+                int twin = this->halfEdges[e];
+                if((twin == -1) || (std::find(cavity.begin(), cavity.end(), twin / 3) == cavity.end()))
+                {
+                    boundary.push_back(e);
+                }
+            }
+        }
+
+        // The area taken by the point from the Voronoi cell of each boundary
+        // point v is the polygon of the circumcentres of the new triangle
+        // before v, the old triangles around v and the new triangle after v.
+        // The calculation is relative to the point to keep the precision.
+        bool valid = true;
+        double totalArea = 0.0;
+        std::vector<double> polyX;
+        std::vector<double> polyY;
+        double cX = 0.0;
+        double cY = 0.0;
+        for(std::vector<int>::iterator iterOut = boundary.begin(); iterOut != boundary.end(); ++iterOut)
+        {
+            int outEdge = *iterOut;
+            int v = this->triangles[outEdge];
+            int w = this->triangles[nextEdge(outEdge)];
+            int inEdge = -1;
+            for(std::vector<int>::iterator iterIn = boundary.begin(); iterIn != boundary.end(); ++iterIn)
+            {
+                if(this->triangles[nextEdge(*iterIn)] == v)
+                {
+                    inEdge = *iterIn;
+                    break;
+                }
+            }
+            if(inEdge == -1)
+            {
+                valid = false;
+                break;
+            }
+            int u = this->triangles[inEdge];
+
+            polyX.clear();
+            polyY.clear();
+            this->circumcentre(0, 0, this->coords[u*2] - x, this->coords[(u*2)+1] - y, this->coords[v*2] - x, this->coords[(v*2)+1] - y, &cX, &cY);
+            polyX.push_back(cX);
+            polyY.push_back(cY);
+            int e = inEdge;
+            size_t numFan = 0;
+            while(true)
+            {
+                int ft = e / 3;
+                int a = this->triangles[ft*3];
+                int b = this->triangles[(ft*3)+1];
+                int c = this->triangles[(ft*3)+2];
+                this->circumcentre(this->coords[a*2] - x, this->coords[(a*2)+1] - y, this->coords[b*2] - x, this->coords[(b*2)+1] - y, this->coords[c*2] - x, this->coords[(c*2)+1] - y, &cX, &cY);
+                polyX.push_back(cX);
+                polyY.push_back(cY);
+                int f = nextEdge(e);
+                if(f == outEdge)
+                {
+                    break;
+                }
+                e = this->halfEdges[f];
+                if((e == -1) || ((++numFan) > cavity.size()))
+                {
+                    valid = false;
+                    break;
+                }
+            }
+            if(!valid)
+            {
+                break;
+            }
+            this->circumcentre(0, 0, this->coords[v*2] - x, this->coords[(v*2)+1] - y, this->coords[w*2] - x, this->coords[(w*2)+1] - y, &cX, &cY);
+            polyX.push_back(cX);
+            polyY.push_back(cY);
+
+            double area = 0.0;
+            for(size_t i = 0; i < polyX.size(); ++i)
+            {
+                size_t j = (i + 1) % polyX.size();
+                area += (polyX[i] * polyY[j]) - (polyX[j] * polyY[i]);
+            }
+            area = fabs(area) / 2;
+            totalArea += area;
+            weights->push_back(std::pair<size_t, double>(this->ptOrder[v], area));
+        }
+
+        if(valid && (totalArea > 0) && std::isfinite(totalArea))
+        {
+            for(std::vector<std::pair<size_t, double> >::iterator iterWeights = weights->begin(); iterWeights != weights->end(); ++iterWeights)
+            {
+                (*iterWeights).second /= totalArea;
+            }
+        }
+        else
+        {
+            // A point on the hull (or a degenerate cavity) where the natural
+            // neighbour weights reduce to the linear weights.
+            size_t ptIdxs[3];
+            double ptWeights[3];
+            this->calcBarycentric(t, x, y, ptIdxs, ptWeights);
+            weights->clear();
+            for(int k = 0; k < 3; ++k)
+            {
+                weights->push_back(std::pair<size_t, double>(ptIdxs[k], ptWeights[k]));
+            }
+        }
+        return true;
+    }
+
+    bool RSGISDelaunayTIN::walkToTriangle(double x, double y, int *tri) const
+    {
+        int numTris = this->triangles.size() / 3;
+        int t = *tri;
+        if((t < 0) || (t >= numTris))
+        {
+            t = 0;
+        }
+
+        // A visibility walk, which always reaches the triangle on a Delaunay
+        // triangulation. The edge walked across is not tested again.
+        int fromEdge = -1;
+        for(int step = 0; step < numTris; ++step)
+        {
+            int crossEdge = -1;
+            for(int k = 0; k < 3; ++k)
+            {
+                int e = (t * 3) + k;
+                if((e != fromEdge) && (this->orient(this->triangles[e], this->triangles[nextEdge(e)], x, y) < 0))
+                {
+                    crossEdge = e;
+                    break;
+                }
+            }
+            if(crossEdge == -1)
+            {
+                *tri = t;
+                return true;
+            }
+            if(this->halfEdges[crossEdge] == -1)
+            {
+                *tri = t;
+                return false;
+            }
+            fromEdge = this->halfEdges[crossEdge];
+            t = fromEdge / 3;
+        }
+
+        // Only expected from rounding on very degenerate triangulations.
+        for(int i = 0; i < numTris; ++i)
+        {
+            if((this->orient(this->triangles[i*3], this->triangles[(i*3)+1], x, y) >= 0) &&
+               (this->orient(this->triangles[(i*3)+1], this->triangles[(i*3)+2], x, y) >= 0) &&
+               (this->orient(this->triangles[(i*3)+2], this->triangles[i*3], x, y) >= 0))
+            {
+                *tri = i;
+                return true;
+            }
+        }
+        *tri = t;
+        return false;
+    }
+
+    void RSGISDelaunayTIN::calcBarycentric(int t, double x, double y, size_t *ptIdxs, double *weights) const
+    {
+        int a = this->triangles[t*3];
+        int b = this->triangles[(t*3)+1];
+        int c = this->triangles[(t*3)+2];
+        double area = this->orient(a, b, this->coords[c*2], this->coords[(c*2)+1]);
+        ptIdxs[0] = this->ptOrder[a];
+        ptIdxs[1] = this->ptOrder[b];
+        ptIdxs[2] = this->ptOrder[c];
+        weights[0] = this->orient(b, c, x, y) / area;
+        weights[1] = this->orient(c, a, x, y) / area;
+        weights[2] = 1.0 - weights[0] - weights[1];
+    }
+
+    double RSGISDelaunayTIN::orient(int a, int b, double x, double y) const
+    {
+        // Positive if the point is on the inside of the triangle edge a->b.
+        return ((this->coords[(b*2)+1] - this->coords[(a*2)+1]) * (x - this->coords[b*2])) - ((this->coords[b*2] - this->coords[a*2]) * (y - this->coords[(b*2)+1]));
+    }
+
+    bool RSGISDelaunayTIN::inCircumcircle(int a, int b, int c, double x, double y) const
+    {
+        double dx = this->coords[a*2] - x;
+        double dy = this->coords[(a*2)+1] - y;
+        double ex = this->coords[b*2] - x;
+        double ey = this->coords[(b*2)+1] - y;
+        double fx = this->coords[c*2] - x;
+        double fy = this->coords[(c*2)+1] - y;
+        double ap = (dx * dx) + (dy * dy);
+        double bp = (ex * ex) + (ey * ey);
+        double cp = (fx * fx) + (fy * fy);
+        double det = (dx * ((ey * cp) - (bp * fy))) - (dy * ((ex * cp) - (bp * fx))) + (ap * ((ex * fy) - (ey * fx)));
+        // Treat (nearly) co-circular points as outside so that edges are not
+        // flipped back and forth on rounding error.
+        double permanent = (ap * (fabs(ex * fy) + fabs(ey * fx))) + (bp * (fabs(fx * dy) + fabs(fy * dx))) + (cp * (fabs(dx * ey) + fabs(dy * ex)));
+        return det < -(16 * std::numeric_limits<double>::epsilon() * permanent);
+    }
+
+    void RSGISDelaunayTIN::circumcentre(double ax, double ay, double bx, double by, double cx, double cy, double *ox, double *oy) const
+    {
+        double dx = bx - ax;
+        double dy = by - ay;
+        double ex = cx - ax;
+        double ey = cy - ay;
+        double bl = (dx * dx) + (dy * dy);
+        double cl = (ex * ex) + (ey * ey);
+        double d = 0.5 / ((dx * ey) - (dy * ex));
+        *ox = ax + (((ey * bl) - (dy * cl)) * d);
+        *oy = ay + (((dx * cl) - (ex * bl)) * d);
+    }
+
+    int RSGISDelaunayTIN::addTriangle(int i0, int i1, int i2, int a, int b, int c)
+    {
+        int t = this->triangles.size();
+        this->triangles.push_back(i0);
+        this->triangles.push_back(i1);
+        this->triangles.push_back(i2);
+        this->halfEdges.push_back(-1);
+        this->halfEdges.push_back(-1);
+        this->halfEdges.push_back(-1);
+        this->linkEdges(t, a);
+        this->linkEdges(t + 1, b);
+        this->linkEdges(t + 2, c);
+        return t;
+    }
+
+    void RSGISDelaunayTIN::linkEdges(int a, int b)
+    {
+        this->halfEdges[a] = b;
+        if(b != -1)
+        {
+            this->halfEdges[b] = a;
+        }
+    }
+
+    int RSGISDelaunayTIN::legaliseEdge(int a)
+    {
+        /*
+         * If the point p1 is within the circumcircle of [p0, pr, pl] the shared
+         * edge is flipped and the new edges are checked in turn:
+         *
+         *           pl                    pl
+         *          /||\                  /  \
+         *       al/ || \bl            al/    \a
+         *        /  ||  \              /      \
+         *       /  a||b  \    flip    /___ar___\
+         *     p0\   ||   /p1   =>   p0\---bl---/p1
+         *        \  ||  /              \      /
+         *       ar\ || /br             b\    /br
+         *          \||/                  \  /
+         *           pr                    pr
+         */
+        int ar = 0;
+        this->edgeStack.clear();
+        while(true)
+        {
+            int b = this->halfEdges[a];
+            int a0 = a - (a % 3);
+            ar = a0 + ((a + 2) % 3);
+            if(b == -1)
+            {
+                if(this->edgeStack.empty())
+                {
+                    break;
+                }
+                a = this->edgeStack.back();
+                this->edgeStack.pop_back();
+                continue;
+            }
+
+            int b0 = b - (b % 3);
+            int al = a0 + ((a + 1) % 3);
+            int bl = b0 + ((b + 2) % 3);
+            int p0 = this->triangles[ar];
+            int pr = this->triangles[a];
+            int pl = this->triangles[al];
+            int p1 = this->triangles[bl];
+
+            if(this->inCircumcircle(p0, pr, pl, this->coords[p1*2], this->coords[(p1*2)+1]))
+            {
+                this->triangles[a] = p1;
+                this->triangles[b] = p0;
+                int hbl = this->halfEdges[bl];
+                if(hbl == -1)
+                {
+                    // The edge is on the hull so the hull's reference to it is updated.
+                    int e = this->hullStart;
+                    do
+                    {
+                        if(this->hullTri[e] == bl)
+                        {
+                            this->hullTri[e] = a;
+                            break;
+                        }
+                        e = this->hullPrev[e];
+                    }
+                    while(e != this->hullStart);
+                }
+                this->linkEdges(a, hbl);
+                this->linkEdges(b, this->halfEdges[ar]);
+                this->linkEdges(ar, bl);
+                this->edgeStack.push_back(b0 + ((b + 1) % 3));
+            }
+            else
+            {
+                if(this->edgeStack.empty())
+                {
+                    break;
+                }
+                a = this->edgeStack.back();
+                this->edgeStack.pop_back();
+            }
+        }
+        return ar;
+    }
+
+    size_t RSGISDelaunayTIN::hashKey(double x, double y) const
+    {
+        // A pseudo-angle (0-1) around the centre, which increases with the angle.
+        double dx = x - this->centreX;
+        double dy = y - this->centreY;
+        double p = dx / (fabs(dx) + fabs(dy));
+        if(!(p == p))
+        {
+            return 0;
+        }
+        double angle = ((dy > 0)?(3 - p):(1 + p)) / 4;
+        return ((size_t)floor(angle * this->hullHash.size())) % this->hullHash.size();
+    }
+
+    uint64_t RSGISDelaunayTIN::calcHilbertIdx(double x, double y) const
+    {
+        // Position along a Hilbert curve filling a 65536 x 65536 grid.
+        uint64_t gridX = std::min<uint64_t>((uint64_t)x, 65535);
+        uint64_t gridY = std::min<uint64_t>((uint64_t)y, 65535);
+        uint64_t idx = 0;
+        for(uint64_t s = 32768; s > 0; s /= 2)
+        {
+            uint64_t rx = ((gridX & s) > 0)?1:0;
+            uint64_t ry = ((gridY & s) > 0)?1:0;
+            idx += s * s * ((3 * rx) ^ ry);
+            if(ry == 0)
+            {
+                if(rx == 1)
+                {
+                    gridX = 65535 - gridX;
+                    gridY = 65535 - gridY;
+                }
+                std::swap(gridX, gridY);
+            }
+        }
+        return idx;
+    }
+
+    double RSGISDelaunayTIN::sqDist(int pt, double x, double y) const
+    {
+        double dx = this->coords[pt*2] - x;
+        double dy = this->coords[(pt*2)+1] - y;
+        return (dx * dx) + (dy * dy);
+    }
+
+    void RSGISDelaunayTIN::buildTriangulation()
+    {
+        int n = this->numPts;
+
+        // The seed triangle: the point nearest the centre, its nearest point and
+        // the point giving the smallest circumcircle with those two.
+        int i0 = -1;
+        int i1 = -1;
+        int i2 = -1;
+        double minDist = std::numeric_limits<double>::infinity();
+        for(int i = 0; i < n; ++i)
+        {
+            double dist = (this->coords[i*2] * this->coords[i*2]) + (this->coords[(i*2)+1] * this->coords[(i*2)+1]);
+            if(dist < minDist)
+            {
+                i0 = i;
+                minDist = dist;
+            }
+        }
+        double i0x = this->coords[i0*2];
+        double i0y = this->coords[(i0*2)+1];
+
+        minDist = std::numeric_limits<double>::infinity();
+        for(int i = 0; i < n; ++i)
+        {
+            double dist = this->sqDist(i, i0x, i0y);
+            if((i != i0) && (dist < minDist) && (dist > 0))
+            {
+                i1 = i;
+                minDist = dist;
+            }
+        }
+        if(i1 == -1)
+        {
+            throw RSGISMathException("All of the points are at the same location so cannot be triangulated.");
+        }
+
+        double minRadius = std::numeric_limits<double>::infinity();
+        double cX = 0.0;
+        double cY = 0.0;
+        for(int i = 0; i < n; ++i)
+        {
+            if((i == i0) || (i == i1))
+            {
+                continue;
+            }
+            this->circumcentre(i0x, i0y, this->coords[i1*2], this->coords[(i1*2)+1], this->coords[i*2], this->coords[(i*2)+1], &cX, &cY);
+            double radius = ((cX - i0x) * (cX - i0x)) + ((cY - i0y) * (cY - i0y));
+            if(radius < minRadius)
+            {
+                i2 = i;
+                minRadius = radius;
+            }
+        }
+        if(i2 == -1)
+        {
+            throw RSGISMathException("The points are collinear so cannot be triangulated.");
+        }
+        if(this->orient(i0, i1, this->coords[i2*2], this->coords[(i2*2)+1]) < 0)
+        {
+            std::swap(i1, i2);
+        }
+        this->circumcentre(i0x, i0y, this->coords[i1*2], this->coords[(i1*2)+1], this->coords[i2*2], this->coords[(i2*2)+1], &this->centreX, &this->centreY);
+
+        // Add the points in order of distance from the seed circumcentre so each
+        // new point is outside of the current hull.
+        std::vector<double> dists(n);
+        std::vector<int> ids(n);
+        for(int i = 0; i < n; ++i)
+        {
+            dists[i] = this->sqDist(i, this->centreX, this->centreY);
+            ids[i] = i;
+        }
+        std::sort(ids.begin(), ids.end(), [&dists](int a, int b){return (dists[a] < dists[b]) || ((dists[a] == dists[b]) && (a < b));});
+
+        size_t maxTriangles = std::max((2 * n) - 5, 1);
+        this->triangles.reserve(maxTriangles * 3);
+        this->halfEdges.reserve(maxTriangles * 3);
+        this->hullPrev.assign(n, 0);
+        this->hullNext.assign(n, 0);
+        this->hullTri.assign(n, 0);
+        this->hullHash.assign((size_t)ceil(sqrt((double)n)), -1);
+
+        this->hullStart = i0;
+        this->hullNext[i0] = i1;
+        this->hullPrev[i2] = i1;
+        this->hullNext[i1] = i2;
+        this->hullPrev[i0] = i2;
+        this->hullNext[i2] = i0;
+        this->hullPrev[i1] = i0;
+        this->hullTri[i0] = 0;
+        this->hullTri[i1] = 1;
+        this->hullTri[i2] = 2;
+        this->hullHash[this->hashKey(i0x, i0y)] = i0;
+        this->hullHash[this->hashKey(this->coords[i1*2], this->coords[(i1*2)+1])] = i1;
+        this->hullHash[this->hashKey(this->coords[i2*2], this->coords[(i2*2)+1])] = i2;
+        this->addTriangle(i0, i1, i2, -1, -1, -1);
+
+        double xp = 0.0;
+        double yp = 0.0;
+        for(int k = 0; k < n; ++k)
+        {
+            int i = ids[k];
+            double x = this->coords[i*2];
+            double y = this->coords[(i*2)+1];
+
+            // Skip duplicate points.
+            if((k > 0) && (fabs(x - xp) <= std::numeric_limits<double>::epsilon()) && (fabs(y - yp) <= std::numeric_limits<double>::epsilon()))
+            {
+                continue;
+            }
+            xp = x;
+            yp = y;
+            if((i == i0) || (i == i1) || (i == i2))
+            {
+                continue;
+            }
+
+            // Find a hull edge visible from the point using the angle hash.
+            int start = 0;
+            size_t key = this->hashKey(x, y);
+            for(size_t j = 0; j < this->hullHash.size(); ++j)
+            {
+                start = this->hullHash[(key + j) % this->hullHash.size()];
+                if((start != -1) && (start != this->hullNext[start]))
+                {
+                    break;
+                }
+            }
+            start = this->hullPrev[start];
+            int e = start;
+            int q = 0;
+            while(true)
+            {
+                q = this->hullNext[e];
+                if(this->orient(e, q, x, y) < 0)
+                {
+                    break;
+                }
+                e = q;
+                if(e == start)
+                {
+                    e = -1;
+                    break;
+                }
+            }
+            if(e == -1)
+            {
+                // A near duplicate of a point already in the triangulation.
+                continue;
+            }
+
+            int t = this->addTriangle(e, i, this->hullNext[e], -1, -1, this->hullTri[e]);
+            this->hullTri[i] = this->legaliseEdge(t + 2);
+            this->hullTri[e] = t;
+
+            // Add triangles for the other visible hull edges, forwards then backwards.
+            int nxt = this->hullNext[e];
+            while(true)
+            {
+                q = this->hullNext[nxt];
+                if(this->orient(nxt, q, x, y) >= 0)
+                {
+                    break;
+                }
+                t = this->addTriangle(nxt, i, q, this->hullTri[i], -1, this->hullTri[nxt]);
+                this->hullTri[i] = this->legaliseEdge(t + 2);
+                this->hullNext[nxt] = nxt;
+                nxt = q;
+            }
+            if(e == start)
+            {
+                while(true)
+                {
+                    q = this->hullPrev[e];
+                    if(this->orient(q, e, x, y) >= 0)
+                    {
+                        break;
+                    }
+                    t = this->addTriangle(q, i, e, -1, this->hullTri[e], this->hullTri[q]);
+                    this->legaliseEdge(t + 2);
+                    this->hullTri[q] = t;
+                    this->hullNext[e] = e;
+                    e = q;
+                }
+            }
+
+            this->hullStart = e;
+            this->hullPrev[i] = e;
+            this->hullNext[e] = i;
+            this->hullPrev[nxt] = i;
+            this->hullNext[i] = nxt;
+            this->hullHash[this->hashKey(x, y)] = i;
+            this->hullHash[this->hashKey(this->coords[e*2], this->coords[(e*2)+1])] = e;
+        }
+
+        // Order the triangles by their first point on the Hilbert curve.
+        int numTris = this->triangles.size() / 3;
+        std::vector<int> triPos(n + 1, 0);
+        std::vector<int> newTriIdxs(numTris);
+        for(int t = 0; t < numTris; ++t)
+        {
+            ++triPos[std::min(this->triangles[t*3], std::min(this->triangles[(t*3)+1], this->triangles[(t*3)+2])) + 1];
+        }
+        for(int i = 0; i < n; ++i)
+        {
+            triPos[i+1] += triPos[i];
+        }
+        for(int t = 0; t < numTris; ++t)
+        {
+            newTriIdxs[t] = triPos[std::min(this->triangles[t*3], std::min(this->triangles[(t*3)+1], this->triangles[(t*3)+2]))]++;
+        }
+        std::vector<int> orderedTriangles(this->triangles.size());
+        std::vector<int> orderedHalfEdges(this->halfEdges.size());
+        for(int t = 0; t < numTris; ++t)
+        {
+            for(int k = 0; k < 3; ++k)
+            {
+                int twin = this->halfEdges[(t*3)+k];
+                orderedTriangles[(newTriIdxs[t]*3)+k] = this->triangles[(t*3)+k];
+                orderedHalfEdges[(newTriIdxs[t]*3)+k] = (twin == -1)?-1:((newTriIdxs[twin/3]*3) + (twin%3));
+            }
+        }
+        this->triangles.swap(orderedTriangles);
+        this->halfEdges.swap(orderedHalfEdges);
+
+        // For each point an edge ending at it, on the hull if the point is.
+        this->ptEdges.assign(n, -1);
+        for(size_t e = 0; e < this->triangles.size(); ++e)
+        {
+            int pt = this->triangles[nextEdge((int)e)];
+            if((this->halfEdges[e] == -1) || (this->ptEdges[pt] == -1))
+            {
+                this->ptEdges[pt] = e;
+            }
+        }
+
+        std::vector<int>().swap(this->hullPrev);
+        std::vector<int>().swap(this->hullNext);
+        std::vector<int>().swap(this->hullTri);
+        std::vector<int>().swap(this->hullHash);
+        std::vector<int>().swap(this->edgeStack);
+    }
+
+}}
@@ -0,0 +1,128 @@
+/*
+ *  RSGISDelaunayTIN.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISDelaunayTIN_H
+#define RSGISDelaunayTIN_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <utility>
+#include <stdint.h>
+#include <math.h>
+
+#include "math/RSGISMathException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_maths_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace math{
+
+    /**
+     * A 2D Delaunay triangulation held in flat arrays: the points (x,y), three
+     * point indexes per triangle and, for each triangle edge (half-edge), the
+     * opposite half-edge in the neighbouring triangle (-1 on the convex hull).
+     *
+     * The points are added in order of distance from the centre of the first
+     * triangle, growing the convex hull outwards (a sweep-hull build), with
+     * edges flipped until each new triangle is Delaunay. Duplicate points are
+     * only triangulated once. The points are stored in Hilbert curve order and
+     * the triangles by their first point so that nearby triangles are close
+     * in memory; point indexes returned are those of the input.
+     *
+     * Queries walk across the triangles from a start triangle, which is updated
+     * to the triangle reached, so successive queries along a scanline only
+     * step to a neighbouring triangle. The queries do not modify the object so
+     * can be run on several threads, each with its own start triangle.
+     */
+    class DllExport RSGISDelaunayTIN
+    {
+    public:
+        /** The coordinates are interleaved (i.e., x0,y0,x1,y1,...). */
+        RSGISDelaunayTIN(const double *coords, size_t numPts);
+        size_t getNumPts() const {return this->numPts;};
+        size_t getNumTriangles() const {return this->triangles.size() / 3;};
+        /**
+         * Find the triangle containing the point, starting from *tri (or any
+         * triangle if *tri is negative). Returns false if the point is outside
+         * of the convex hull, in which case *tri is a triangle on the hull.
+         */
+        bool locate(double x, double y, int *tri) const;
+        /** Index of the nearest point, using *tri as for locate. */
+        size_t findNearestPt(double x, double y, int *tri) const;
+        /**
+         * Barycentric (linear) weights of the three points of the triangle
+         * containing the point. Returns false if it is outside of the hull.
+         */
+        bool calcLinearWeights(double x, double y, int *tri, size_t *ptIdxs, double *weights) const;
+        /**
+         * Natural neighbour (Sibson) weights, which sum to 1, as (point index,
+         * weight) pairs. Returns false if the point is outside of the hull.
+         */
+        bool calcNaturalNeighbourWeights(double x, double y, int *tri, std::vector<std::pair<size_t, double> > *weights) const;
+        ~RSGISDelaunayTIN(){};
+    protected:
+        static int nextEdge(int e){return ((e % 3) == 2)?(e - 2):(e + 1);};
+        bool walkToTriangle(double x, double y, int *tri) const;
+        void calcBarycentric(int t, double x, double y, size_t *ptIdxs, double *weights) const;
+        double orient(int a, int b, double x, double y) const;
+        bool inCircumcircle(int a, int b, int c, double x, double y) const;
+        void circumcentre(double ax, double ay, double bx, double by, double cx, double cy, double *ox, double *oy) const;
+        int addTriangle(int i0, int i1, int i2, int a, int b, int c);
+        void linkEdges(int a, int b);
+        int legaliseEdge(int a);
+        size_t hashKey(double x, double y) const;
+        uint64_t calcHilbertIdx(double x, double y) const;
+        double sqDist(int pt, double x, double y) const;
+        void buildTriangulation();
+        size_t numPts;
+        double offsetX;
+        double offsetY;
+        std::vector<double> coords;
+        std::vector<size_t> ptOrder;
+        std::vector<int> triangles;
+        std::vector<int> halfEdges;
+        std::vector<int> ptEdges;
+        // Only used while building the triangulation.
+        std::vector<int> hullPrev;
+        std::vector<int> hullNext;
+        std::vector<int> hullTri;
+        std::vector<int> hullHash;
+        std::vector<int> edgeStack;
+        int hullStart;
+        double centreX;
+        double centreY;
+    };
+
+}}
+
+#endif
@@ -209,13 +209,17 @@ namespace rsgis{namespace math{
     
     
     
-    RSGISCalcMinkowskiDistMetric::RSGISCalcMinkowskiDistMetric(): RSGISCalcDistMetric()
+    RSGISCalcMinkowskiDistMetric::RSGISCalcMinkowskiDistMetric(double p): RSGISCalcDistMetric()
     {
-        
+        this->p = p;
     }
     
     void RSGISCalcMinkowskiDistMetric::init()
     {
+        if(!(this->p >= 1) || std::isinf(this->p))
+        {
+            throw RSGISMathException("The order of the Minkowski distance must be finite and at least 1.");
+        }
         this->initalised = true;
     }
     
@@ -233,7 +237,16 @@ namespace rsgis{namespace math{
                 throw RSGISMathException("The length of the two arrays must be the same for the distance to be calculated.");
             }
             
-            throw RSGISMathException("RSGISCalcMinkowskiDistMetric is not implemented!");
+            size_t numVals = eIdx1-sIdx1;
+            double diff = 0;
+            dist = 0;
+            for(size_t i = 0; i < numVals; ++i)
+            {
+                diff = fabs(vals1[i+sIdx1] - vals2[i+sIdx2]);
+                dist += pow(diff, this->p);
+            }
+            
+            dist = pow(dist, 1.0/this->p);
         }
         catch (RSGISMathException &e)
         {
@@ -275,7 +288,12 @@ namespace rsgis{namespace math{
                 throw RSGISMathException("The length of the two arrays must be the same for the distance to be calculated.");
             }
             
-            throw RSGISMathException("RSGISCalcChebyshevDistMetric is not implemented!");
+            size_t numVals = eIdx1-sIdx1;
+            dist = 0;
+            for(size_t i = 0; i < numVals; ++i)
+            {
+                dist = std::max(dist, fabs(vals1[i+sIdx1] - vals2[i+sIdx2]));
+            }
         }
         catch (RSGISMathException &e)
         {
@@ -98,15 +98,20 @@ namespace rsgis{namespace math{
         size_t n;
     };
     
+    /** Minkowski distance of order p (p >= 1): (sum(|a-b|^p))^(1/p) */
     class DllExport RSGISCalcMinkowskiDistMetric: public RSGISCalcDistMetric
     {
     public:
-        RSGISCalcMinkowskiDistMetric();
+        RSGISCalcMinkowskiDistMetric(double p=3);
         virtual void init();
         virtual double calcDist(double *vals1, size_t sIdx1, size_t eIdx1, double *vals2, size_t sIdx2, size_t eIdx2);
+        double getOrder(){return this->p;};
         virtual ~RSGISCalcMinkowskiDistMetric();
+    protected:
+        double p;
     };
     
+    /** Chebyshev distance: max(|a-b|) */
     class DllExport RSGISCalcChebyshevDistMetric: public RSGISCalcDistMetric
     {
     public:
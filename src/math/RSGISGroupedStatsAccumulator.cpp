@@ -0,0 +1,307 @@
+/*
+ *  RSGISGroupedStatsAccumulator.cpp
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISGroupedStatsAccumulator.h"
+
+namespace rsgis{namespace math{
+
+    /*
+     * Four independent partial results are kept so the loop carries no
+     * dependency from one value to the next and maps onto SIMD lanes.
+     */
+    template <typename T>
+    static RSGISRunMoments calcRunMomentsImpl(const T *vals, size_t numVals, bool calcM2)
+    {
+        const double maxFinite = std::numeric_limits<double>::max();
+        const double posInf = std::numeric_limits<double>::infinity();
+
+        double n[4] = {0, 0, 0, 0};
+        double sum[4] = {0, 0, 0, 0};
+        double min[4] = {posInf, posInf, posInf, posInf};
+        double max[4] = {-posInf, -posInf, -posInf, -posInf};
+
+        size_t numVals4 = numVals - (numVals % 4);
+        for(size_t i = 0; i < numVals4; i += 4)
+        {
+            for(size_t j = 0; j < 4; ++j)
+            {
+                double val = vals[i+j];
+                bool valid = fabs(val) <= maxFinite;
+                n[j] += valid ? 1.0 : 0.0;
+                sum[j] += valid ? val : 0.0;
+                min[j] = (valid && (val < min[j])) ? val : min[j];
+                max[j] = (valid && (val > max[j])) ? val : max[j];
+            }
+        }
+        for(size_t i = numVals4; i < numVals; ++i)
+        {
+            double val = vals[i];
+            bool valid = fabs(val) <= maxFinite;
+            n[0] += valid ? 1.0 : 0.0;
+            sum[0] += valid ? val : 0.0;
+            min[0] = (valid && (val < min[0])) ? val : min[0];
+            max[0] = (valid && (val > max[0])) ? val : max[0];
+        }
+
+        RSGISRunMoments moments;
+        moments.n = (n[0] + n[1]) + (n[2] + n[3]);
+        moments.sum = (sum[0] + sum[1]) + (sum[2] + sum[3]);
+        moments.min = std::min(std::min(min[0], min[1]), std::min(min[2], min[3]));
+        moments.max = std::max(std::max(max[0], max[1]), std::max(max[2], max[3]));
+        moments.m2 = 0.0;
+
+        if(calcM2 && (moments.n > 1))
+        {
+            // Deviations are taken from the run mean, which is numerically stable
+            // as the run is still in cache.
+            double mean = moments.sum / moments.n;
+            double m2[4] = {0, 0, 0, 0};
+            for(size_t i = 0; i < numVals4; i += 4)
+            {
+                for(size_t j = 0; j < 4; ++j)
+                {
+                    double val = vals[i+j];
+                    double diff = (fabs(val) <= maxFinite) ? (val - mean) : 0.0;
+                    m2[j] += diff * diff;
+                }
+            }
+            for(size_t i = numVals4; i < numVals; ++i)
+            {
+                double val = vals[i];
+                double diff = (fabs(val) <= maxFinite) ? (val - mean) : 0.0;
+                m2[0] += diff * diff;
+            }
+            moments.m2 = (m2[0] + m2[1]) + (m2[2] + m2[3]);
+        }
+        return moments;
+    }
+
+    RSGISGroupedStatsAccumulator::RSGISGroupedStatsAccumulator(size_t numGroups, unsigned int numVars, bool calcMinMax, bool calcVariance)
+    {
+        this->numGroups = numGroups;
+        this->numVars = numVars;
+        this->calcMinMax = calcMinMax;
+        this->calcVariance = calcVariance;
+        this->reset();
+    }
+
+    void RSGISGroupedStatsAccumulator::reset()
+    {
+        size_t numElems = this->numGroups * this->numVars;
+        this->counts.assign(numElems, 0.0);
+        this->sums.assign(numElems, 0.0);
+        if(this->calcMinMax)
+        {
+            this->mins.assign(numElems, 0.0);
+            this->maxs.assign(numElems, 0.0);
+        }
+        if(this->calcVariance)
+        {
+            this->m2s.assign(numElems, 0.0);
+        }
+    }
+
+    void RSGISGroupedStatsAccumulator::addBlock(const unsigned int *groupIDs, const float *vals, size_t numVals, bool ignoreGroupZero)
+    {
+        size_t runStart = 0;
+        while(runStart < numVals)
+        {
+            unsigned int group = groupIDs[runStart];
+            size_t runEnd = runStart + 1;
+            while((runEnd < numVals) && (groupIDs[runEnd] == group))
+            {
+                ++runEnd;
+            }
+
+            if((group != 0) || (!ignoreGroupZero))
+            {
+                if(group >= this->numGroups)
+                {
+                    throw RSGISMathException("Group ID is outside of the range of the statistics accumulator.");
+                }
+                for(unsigned int var = 0; var < this->numVars; ++var)
+                {
+                    RSGISRunMoments moments = calcRunMomentsImpl(&vals[(var*numVals)+runStart], runEnd-runStart, this->calcVariance);
+                    this->addMoments(group, var, moments);
+                }
+            }
+            runStart = runEnd;
+        }
+    }
+
+    void RSGISGroupedStatsAccumulator::addRun(size_t group, unsigned int var, const float *vals, size_t numVals)
+    {
+        if((group >= this->numGroups) || (var >= this->numVars))
+        {
+            throw RSGISMathException("Group or variable is outside of the range of the statistics accumulator.");
+        }
+        this->addMoments(group, var, calcRunMomentsImpl(vals, numVals, this->calcVariance));
+    }
+
+    void RSGISGroupedStatsAccumulator::addMoments(size_t group, unsigned int var, const RSGISRunMoments &moments)
+    {
+        if(moments.n == 0)
+        {
+            return;
+        }
+        size_t idx = (var*this->numGroups)+group;
+        double curN = this->counts[idx];
+        if(curN == 0)
+        {
+            this->counts[idx] = moments.n;
+            this->sums[idx] = moments.sum;
+            if(this->calcMinMax)
+            {
+                this->mins[idx] = moments.min;
+                this->maxs[idx] = moments.max;
+            }
+            if(this->calcVariance)
+            {
+                this->m2s[idx] = moments.m2;
+            }
+            return;
+        }
+
+        double totalN = curN + moments.n;
+        if(this->calcVariance)
+        {
+            double delta = (moments.sum / moments.n) - (this->sums[idx] / curN);
+            this->m2s[idx] += moments.m2 + (delta * delta * ((curN * moments.n) / totalN));
+        }
+        if(this->calcMinMax)
+        {
+            this->mins[idx] = std::min(this->mins[idx], moments.min);
+            this->maxs[idx] = std::max(this->maxs[idx], moments.max);
+        }
+        this->counts[idx] = totalN;
+        this->sums[idx] += moments.sum;
+    }
+
+    void RSGISGroupedStatsAccumulator::merge(const RSGISGroupedStatsAccumulator &other)
+    {
+        if((other.numGroups != this->numGroups) || (other.numVars != this->numVars) || (other.calcMinMax != this->calcMinMax) || (other.calcVariance != this->calcVariance))
+        {
+            throw RSGISMathException("Statistics accumulators must have the same dimensions to be merged.");
+        }
+
+        RSGISRunMoments moments;
+        moments.min = 0;
+        moments.max = 0;
+        moments.m2 = 0;
+        for(unsigned int var = 0; var < this->numVars; ++var)
+        {
+            for(size_t group = 0; group < this->numGroups; ++group)
+            {
+                size_t idx = (var*this->numGroups)+group;
+                moments.n = other.counts[idx];
+                if(moments.n == 0)
+                {
+                    continue;
+                }
+                moments.sum = other.sums[idx];
+                if(this->calcMinMax)
+                {
+                    moments.min = other.mins[idx];
+                    moments.max = other.maxs[idx];
+                }
+                if(this->calcVariance)
+                {
+                    moments.m2 = other.m2s[idx];
+                }
+                this->addMoments(group, var, moments);
+            }
+        }
+    }
+
+    double RSGISGroupedStatsAccumulator::getMin(size_t group, unsigned int var) const
+    {
+        if(!this->calcMinMax)
+        {
+            throw RSGISMathException("The min was not calculated by the statistics accumulator.");
+        }
+        return this->mins[(var*this->numGroups)+group];
+    }
+
+    double RSGISGroupedStatsAccumulator::getMax(size_t group, unsigned int var) const
+    {
+        if(!this->calcMinMax)
+        {
+            throw RSGISMathException("The max was not calculated by the statistics accumulator.");
+        }
+        return this->maxs[(var*this->numGroups)+group];
+    }
+
+    double RSGISGroupedStatsAccumulator::getMean(size_t group, unsigned int var) const
+    {
+        size_t idx = (var*this->numGroups)+group;
+        if(this->counts[idx] == 0)
+        {
+            return 0.0;
+        }
+        return this->sums[idx] / this->counts[idx];
+    }
+
+    double RSGISGroupedStatsAccumulator::getVariance(size_t group, unsigned int var) const
+    {
+        if(!this->calcVariance)
+        {
+            throw RSGISMathException("The variance was not calculated by the statistics accumulator.");
+        }
+        size_t idx = (var*this->numGroups)+group;
+        if(this->counts[idx] == 0)
+        {
+            return 0.0;
+        }
+        return this->m2s[idx] / this->counts[idx];
+    }
+
+    double RSGISGroupedStatsAccumulator::getStdDev(size_t group, unsigned int var) const
+    {
+        return sqrt(this->getVariance(group, var));
+    }
+
+    RSGISRunMoments RSGISGroupedStatsAccumulator::calcRunMoments(const float *vals, size_t numVals, bool calcM2)
+    {
+        return calcRunMomentsImpl(vals, numVals, calcM2);
+    }
+
+    RSGISRunMoments RSGISGroupedStatsAccumulator::calcRunMoments(const double *vals, size_t numVals, bool calcM2)
+    {
+        return calcRunMomentsImpl(vals, numVals, calcM2);
+    }
+
+    size_t RSGISGroupedStatsAccumulator::getBytesPerGroup(unsigned int numVars, bool calcMinMax, bool calcVariance)
+    {
+        size_t numArrs = 2;
+        if(calcMinMax)
+        {
+            numArrs += 2;
+        }
+        if(calcVariance)
+        {
+            numArrs += 1;
+        }
+        return numArrs * numVars * sizeof(double);
+    }
+
+}}
@@ -0,0 +1,108 @@
+/*
+ *  RSGISGroupedStatsAccumulator.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISGroupedStatsAccumulator_H
+#define RSGISGroupedStatsAccumulator_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <math.h>
+
+#include "math/RSGISMathException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_maths_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace math{
+
+    /**
+     * The moments of a run of values: the number of finite values, their min,
+     * max and sum and the sum of squared deviations from their mean (m2).
+     */
+    struct DllExport RSGISRunMoments
+    {
+        double n;
+        double min;
+        double max;
+        double sum;
+        double m2;
+    };
+
+    /**
+     * Accumulates count, min, max, sum and variance for a set of groups (e.g.,
+     * clumps) and variables (e.g., image bands) in a single pass. Each statistic
+     * is held in its own contiguous array (indexed var * numGroups + group) and
+     * only the arrays which are needed are allocated. Values are reduced a run
+     * at a time, where a run is a sequence of pixels with the same group, using
+     * branch-free loops the compiler can vectorise. Runs are combined with the
+     * pairwise update of Chan et al. so accumulators built on separate threads
+     * can be merged. Non-finite values are ignored.
+     */
+    class DllExport RSGISGroupedStatsAccumulator
+    {
+    public:
+        RSGISGroupedStatsAccumulator(size_t numGroups, unsigned int numVars, bool calcMinMax=true, bool calcVariance=true);
+        void reset();
+        void addBlock(const unsigned int *groupIDs, const float *vals, size_t numVals, bool ignoreGroupZero=true);
+        void addRun(size_t group, unsigned int var, const float *vals, size_t numVals);
+        void addMoments(size_t group, unsigned int var, const RSGISRunMoments &moments);
+        void merge(const RSGISGroupedStatsAccumulator &other);
+        size_t getNumGroups() const {return this->numGroups;};
+        unsigned int getNumVars() const {return this->numVars;};
+        double getCount(size_t group, unsigned int var) const {return this->counts[(var*this->numGroups)+group];};
+        double getSum(size_t group, unsigned int var) const {return this->sums[(var*this->numGroups)+group];};
+        double getMin(size_t group, unsigned int var) const;
+        double getMax(size_t group, unsigned int var) const;
+        double getMean(size_t group, unsigned int var) const;
+        double getVariance(size_t group, unsigned int var) const;
+        double getStdDev(size_t group, unsigned int var) const;
+        static RSGISRunMoments calcRunMoments(const float *vals, size_t numVals, bool calcM2=true);
+        static RSGISRunMoments calcRunMoments(const double *vals, size_t numVals, bool calcM2=true);
+        static size_t getBytesPerGroup(unsigned int numVars, bool calcMinMax, bool calcVariance);
+        ~RSGISGroupedStatsAccumulator(){};
+    protected:
+        size_t numGroups;
+        unsigned int numVars;
+        bool calcMinMax;
+        bool calcVariance;
+        std::vector<double> counts;
+        std::vector<double> sums;
+        std::vector<double> mins;
+        std::vector<double> maxs;
+        std::vector<double> m2s;
+    };
+
+}}
+
+#endif
@@ -0,0 +1,388 @@
+/*
+ *  RSGISKNNSearchIndex.cpp
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISKNNSearchIndex.h"
+
+namespace rsgis{namespace math{
+
+    RSGISKNNSearchIndex::RSGISKNNSearchIndex(const double *pts, size_t numPts, unsigned int numVars, rsgisdistmetrics metric, unsigned int leafSize, double minkowskiP)
+    {
+        if((numPts == 0) | (numVars == 0))
+        {
+            throw RSGISMathException("At least one point with at least one variable is required to build a KNN index.");
+        }
+        if((metric != rsgis_euclidean) & (metric != rsgis_manhatten) & (metric != rsgis_mahalanobis) & (metric != rsgis_minkowski) & (metric != rsgis_chebyshev))
+        {
+            throw RSGISMathException("The distance metric is not supported by the KNN index; use Euclidean, Manhattan, Mahalanobis, Minkowski or Chebyshev.");
+        }
+        if((metric == rsgis_minkowski) && (!(minkowskiP >= 1) || std::isinf(minkowskiP)))
+        {
+            throw RSGISMathException("The order of the Minkowski distance must be finite and at least 1.");
+        }
+        this->numPts = numPts;
+        this->numVars = numVars;
+        this->metric = metric;
+        this->leafSize = std::max<unsigned int>(leafSize, 1);
+        this->minkowskiP = minkowskiP;
+
+        if(metric == rsgis_mahalanobis)
+        {
+            this->calcWhitening(pts);
+        }
+        this->treePts.resize(numPts * numVars);
+        this->ptIdxs.resize(numPts);
+        for(size_t i = 0; i < numPts; ++i)
+        {
+            this->transformPt(&pts[i * numVars], &this->treePts[i * numVars]);
+            this->ptIdxs[i] = i;
+        }
+
+        this->buildNode(0, numPts);
+
+        // Store the points in tree order so each leaf is contiguous.
+        std::vector<double> orderedPts(numPts * numVars);
+        for(size_t i = 0; i < numPts; ++i)
+        {
+            std::copy(&this->treePts[this->ptIdxs[i] * numVars], &this->treePts[this->ptIdxs[i] * numVars] + numVars, &orderedPts[i * numVars]);
+        }
+        this->treePts.swap(orderedPts);
+    }
+
+    void RSGISKNNSearchIndex::findKNN(const double *query, unsigned int k, double maxDist, std::vector<std::pair<double, size_t> > *neighbours) const
+    {
+        neighbours->clear();
+        if(k == 0)
+        {
+            return;
+        }
+        std::vector<double> queryPt(this->numVars);
+        this->transformPt(query, queryPt.data());
+
+        neighbours->reserve(k);
+        this->searchNode(0, queryPt.data(), k, maxDist, neighbours);
+        std::sort_heap(neighbours->begin(), neighbours->end());
+        for(std::vector<std::pair<double, size_t> >::iterator iterNeighbours = neighbours->begin(); iterNeighbours != neighbours->end(); ++iterNeighbours)
+        {
+            (*iterNeighbours).first = this->reducedToDist((*iterNeighbours).first);
+        }
+    }
+
+    void RSGISKNNSearchIndex::calcWhitening(const double *pts)
+    {
+        if(this->numPts < 2)
+        {
+            throw RSGISMathException("At least two points are needed to calculate the Mahalanobis distance.");
+        }
+        std::vector<double> means(this->numVars, 0.0);
+        for(size_t i = 0; i < this->numPts; ++i)
+        {
+            for(unsigned int v = 0; v < this->numVars; ++v)
+            {
+                means[v] += pts[(i * this->numVars) + v];
+            }
+        }
+        for(unsigned int v = 0; v < this->numVars; ++v)
+        {
+            means[v] /= this->numPts;
+        }
+
+        std::vector<double> covMatrix(((size_t)this->numVars) * this->numVars, 0.0);
+        for(size_t i = 0; i < this->numPts; ++i)
+        {
+            const double *pt = &pts[i * this->numVars];
+            for(unsigned int a = 0; a < this->numVars; ++a)
+            {
+                for(unsigned int b = 0; b <= a; ++b)
+                {
+                    covMatrix[(a * this->numVars) + b] += (pt[a] - means[a]) * (pt[b] - means[b]);
+                }
+            }
+        }
+
+        // Cholesky decomposition of the covariance matrix (S = LL^T).
+        this->whiten.assign(((size_t)this->numVars) * this->numVars, 0.0);
+        for(unsigned int a = 0; a < this->numVars; ++a)
+        {
+            for(unsigned int b = 0; b <= a; ++b)
+            {
+                double sum = covMatrix[(a * this->numVars) + b] / (this->numPts - 1);
+                for(unsigned int c = 0; c < b; ++c)
+                {
+                    sum -= this->whiten[(a * this->numVars) + c] * this->whiten[(b * this->numVars) + c];
+                }
+                if(a == b)
+                {
+                    if(!(sum > 0))
+                    {
+                        throw RSGISMathException("The covariance matrix of the training data is singular so the Mahalanobis distance cannot be calculated.");
+                    }
+                    this->whiten[(a * this->numVars) + a] = sqrt(sum);
+                }
+                else
+                {
+                    this->whiten[(a * this->numVars) + b] = sum / this->whiten[(b * this->numVars) + b];
+                }
+            }
+        }
+    }
+
+    void RSGISKNNSearchIndex::transformPt(const double *pt, double *outPt) const
+    {
+        if(this->metric != rsgis_mahalanobis)
+        {
+            std::copy(pt, pt + this->numVars, outPt);
+            return;
+        }
+        // Solve L z = x by forward substitution.
+        for(unsigned int a = 0; a < this->numVars; ++a)
+        {
+            double sum = pt[a];
+            for(unsigned int b = 0; b < a; ++b)
+            {
+                sum -= this->whiten[(a * this->numVars) + b] * outPt[b];
+            }
+            outPt[a] = sum / this->whiten[(a * this->numVars) + a];
+        }
+    }
+
+    long RSGISKNNSearchIndex::buildNode(size_t start, size_t end)
+    {
+        long nodeIdx = this->nodes.size();
+        KDTreeNode node;
+        node.start = start;
+        node.end = end;
+        node.splitDim = 0;
+        node.splitVal = 0.0;
+        node.left = -1;
+        node.right = -1;
+        this->nodes.push_back(node);
+
+        size_t boxOff = this->boxMins.size();
+        this->boxMins.resize(boxOff + this->numVars, std::numeric_limits<double>::infinity());
+        this->boxMaxs.resize(boxOff + this->numVars, -std::numeric_limits<double>::infinity());
+        for(size_t i = start; i < end; ++i)
+        {
+            const double *pt = &this->treePts[this->ptIdxs[i] * this->numVars];
+            for(unsigned int v = 0; v < this->numVars; ++v)
+            {
+                this->boxMins[boxOff + v] = std::min(this->boxMins[boxOff + v], pt[v]);
+                this->boxMaxs[boxOff + v] = std::max(this->boxMaxs[boxOff + v], pt[v]);
+            }
+        }
+
+        if((end - start) <= this->leafSize)
+        {
+            return nodeIdx;
+        }
+
+        // Split the widest dimension at its median.
+        unsigned int splitDim = 0;
+        double maxSpread = 0.0;
+        for(unsigned int v = 0; v < this->numVars; ++v)
+        {
+            double spread = this->boxMaxs[boxOff + v] - this->boxMins[boxOff + v];
+            if(spread > maxSpread)
+            {
+                maxSpread = spread;
+                splitDim = v;
+            }
+        }
+        if(!(maxSpread > 0))
+        {
+            return nodeIdx;
+        }
+
+        size_t mid = start + ((end - start) / 2);
+        const double *treePts = this->treePts.data();
+        unsigned int numVars = this->numVars;
+        std::nth_element(this->ptIdxs.begin() + start, this->ptIdxs.begin() + mid, this->ptIdxs.begin() + end, [treePts, numVars, splitDim](size_t a, size_t b)
+        {
+            double valA = treePts[(a * numVars) + splitDim];
+            double valB = treePts[(b * numVars) + splitDim];
+            return (valA < valB) || ((valA == valB) && (a < b));
+        });
+
+        long left = this->buildNode(start, mid);
+        long right = this->buildNode(mid, end);
+        this->nodes[nodeIdx].splitDim = splitDim;
+        this->nodes[nodeIdx].splitVal = this->treePts[(this->ptIdxs[mid] * this->numVars) + splitDim];
+        this->nodes[nodeIdx].left = left;
+        this->nodes[nodeIdx].right = right;
+        return nodeIdx;
+    }
+
+    void RSGISKNNSearchIndex::searchNode(long nodeIdx, const double *query, unsigned int k, double maxDist, std::vector<std::pair<double, size_t> > *heap) const
+    {
+        double boxDist = this->calcBoxDist(nodeIdx, query);
+        if(this->reducedToDist(boxDist) >= maxDist)
+        {
+            return;
+        }
+        if((heap->size() == k) && (boxDist > heap->front().first))
+        {
+            return;
+        }
+
+        const KDTreeNode &node = this->nodes[nodeIdx];
+        if(node.left < 0)
+        {
+            for(size_t i = node.start; i < node.end; ++i)
+            {
+                double bound = (heap->size() == k)?heap->front().first:std::numeric_limits<double>::infinity();
+                double dist = this->calcReducedDist(&this->treePts[i * this->numVars], query, bound);
+                if((dist > bound) || !(this->reducedToDist(dist) < maxDist))
+                {
+                    continue;
+                }
+                std::pair<double, size_t> neighbour(dist, this->ptIdxs[i]);
+                if(heap->size() < k)
+                {
+                    heap->push_back(neighbour);
+                    std::push_heap(heap->begin(), heap->end());
+                }
+                else if(neighbour < heap->front())
+                {
+                    std::pop_heap(heap->begin(), heap->end());
+                    heap->back() = neighbour;
+                    std::push_heap(heap->begin(), heap->end());
+                }
+            }
+        }
+        else if(query[node.splitDim] < node.splitVal)
+        {
+            this->searchNode(node.left, query, k, maxDist, heap);
+            this->searchNode(node.right, query, k, maxDist, heap);
+        }
+        else
+        {
+            this->searchNode(node.right, query, k, maxDist, heap);
+            this->searchNode(node.left, query, k, maxDist, heap);
+        }
+    }
+
+    double RSGISKNNSearchIndex::calcReducedDist(const double *pt1, const double *pt2, double bound) const
+    {
+        double dist = 0.0;
+        double diff = 0.0;
+        if(this->metric == rsgis_manhatten)
+        {
+            for(unsigned int v = 0; v < this->numVars; ++v)
+            {
+                dist += fabs(pt1[v] - pt2[v]);
+                if(dist > bound)
+                {
+                    break;
+                }
+            }
+        }
+        else if(this->metric == rsgis_minkowski)
+        {
+            for(unsigned int v = 0; v < this->numVars; ++v)
+            {
+                dist += pow(fabs(pt1[v] - pt2[v]), this->minkowskiP);
+                if(dist > bound)
+                {
+                    break;
+                }
+            }
+        }
+        else if(this->metric == rsgis_chebyshev)
+        {
+            for(unsigned int v = 0; v < this->numVars; ++v)
+            {
+                dist = std::max(dist, fabs(pt1[v] - pt2[v]));
+                if(dist > bound)
+                {
+                    break;
+                }
+            }
+        }
+        else
+        {
+            for(unsigned int v = 0; v < this->numVars; ++v)
+            {
+                diff = pt1[v] - pt2[v];
+                dist += diff * diff;
+                if(dist > bound)
+                {
+                    break;
+                }
+            }
+        }
+        return dist;
+    }
+
+    double RSGISKNNSearchIndex::calcBoxDist(long nodeIdx, const double *query) const
+    {
+        const double *boxMin = &this->boxMins[((size_t)nodeIdx) * this->numVars];
+        const double *boxMax = &this->boxMaxs[((size_t)nodeIdx) * this->numVars];
+        double dist = 0.0;
+        double diff = 0.0;
+        for(unsigned int v = 0; v < this->numVars; ++v)
+        {
+            diff = 0.0;
+            if(query[v] < boxMin[v])
+            {
+                diff = boxMin[v] - query[v];
+            }
+            else if(query[v] > boxMax[v])
+            {
+                diff = query[v] - boxMax[v];
+            }
+            if(this->metric == rsgis_manhatten)
+            {
+                dist += diff;
+            }
+            else if(this->metric == rsgis_minkowski)
+            {
+                dist += pow(diff, this->minkowskiP);
+            }
+            else if(this->metric == rsgis_chebyshev)
+            {
+                dist = std::max(dist, diff);
+            }
+            else
+            {
+                dist += diff * diff;
+            }
+        }
+        return dist;
+    }
+
+    double RSGISKNNSearchIndex::reducedToDist(double reducedDist) const
+    {
+        if(this->metric == rsgis_mahalanobis)
+        {
+            return sqrt(reducedDist);
+        }
+        else if(this->metric == rsgis_minkowski)
+        {
+            return pow(reducedDist, 1.0 / this->minkowskiP);
+        }
+        else if(this->metric == rsgis_chebyshev)
+        {
+            return reducedDist;
+        }
+        return sqrt(reducedDist / this->numVars);
+    }
+
+}}
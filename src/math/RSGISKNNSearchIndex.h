@@ -0,0 +1,112 @@
+/*
+ *  RSGISKNNSearchIndex.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISKNNSearchIndex_H
+#define RSGISKNNSearchIndex_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <utility>
+#include <math.h>
+
+#include "math/RSGISMathException.h"
+#include "math/RSGISMathsUtils.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_maths_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace math{
+
+    /**
+     * A k-d tree over a set of points for finding the k nearest neighbours of
+     * a query. The distances are those of RSGISCalcDistMetric:
+     *
+     * - rsgis_euclidean: sqrt(sum((a-b)^2)/n)
+     * - rsgis_manhatten: sqrt(sum(|a-b|)/n)
+     * - rsgis_mahalanobis: sqrt((a-b)^T S^-1 (a-b)), with S the covariance of
+     *   the points. The points and queries are whitened (S = LL^T, z = L^-1 x)
+     *   so the tree is searched with the Euclidean distance.
+     * - rsgis_minkowski: (sum(|a-b|^p))^(1/p), of order minkowskiP (p >= 1).
+ *   The node bounds use the same p so the pruning is exact.
+     * - rsgis_chebyshev: max(|a-b|)
+     *
+     * Each query keeps its neighbours in a bounded max-heap and skips any node
+     * whose bounding box is further than the current k-th neighbour. Ties are
+     * broken on the point index, so the result is the same as a full scan.
+     * Queries do not modify the index so can be run on several threads.
+     */
+    class DllExport RSGISKNNSearchIndex
+    {
+    public:
+        RSGISKNNSearchIndex(const double *pts, size_t numPts, unsigned int numVars, rsgisdistmetrics metric=rsgis_euclidean, unsigned int leafSize=16, double minkowskiP=3);
+        /**
+         * Finds (up to) the k nearest points with a distance less than maxDist,
+         * returned nearest first as (distance, point index) pairs.
+         */
+        void findKNN(const double *query, unsigned int k, double maxDist, std::vector<std::pair<double, size_t> > *neighbours) const;
+        size_t getNumPts() const {return this->numPts;};
+        unsigned int getNumVars() const {return this->numVars;};
+        ~RSGISKNNSearchIndex(){};
+    protected:
+        struct KDTreeNode
+        {
+            size_t start;
+            size_t end;
+            unsigned int splitDim;
+            double splitVal;
+            long left;
+            long right;
+        };
+        void calcWhitening(const double *pts);
+        void transformPt(const double *pt, double *outPt) const;
+        long buildNode(size_t start, size_t end);
+        void searchNode(long nodeIdx, const double *query, unsigned int k, double maxDist, std::vector<std::pair<double, size_t> > *heap) const;
+        double calcReducedDist(const double *pt1, const double *pt2, double bound) const;
+        double calcBoxDist(long nodeIdx, const double *query) const;
+        double reducedToDist(double reducedDist) const;
+        size_t numPts;
+        unsigned int numVars;
+        rsgisdistmetrics metric;
+        unsigned int leafSize;
+        double minkowskiP;
+        std::vector<double> treePts;
+        std::vector<size_t> ptIdxs;
+        std::vector<double> whiten;
+        std::vector<KDTreeNode> nodes;
+        std::vector<double> boxMins;
+        std::vector<double> boxMaxs;
+    };
+
+}}
+
+#endif
@@ -0,0 +1,247 @@
+/*
+ *  RSGISNearestCentreSearch.cpp
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISNearestCentreSearch.h"
+
+namespace rsgis{namespace math{
+
+    RSGISNearestCentreSearch::RSGISNearestCentreSearch(const double *centres, unsigned int numCentres, unsigned int numVars, bool varMajor)
+    {
+        this->setCentres(centres, numCentres, numVars, varMajor);
+    }
+
+    void RSGISNearestCentreSearch::setCentres(const double *centres, unsigned int numCentres, unsigned int numVars, bool varMajor)
+    {
+        if((numCentres == 0) | (numVars == 0))
+        {
+            throw RSGISMathException("At least one centre with at least one variable is required for a nearest centre search.");
+        }
+        this->numCentres = numCentres;
+        this->numVars = numVars;
+        this->centres.resize(((size_t)numCentres) * numVars);
+        this->centreSqNorms.assign(numCentres, 0.0);
+        this->maxCentreSqNorm = 0.0;
+        for(unsigned int c = 0; c < numCentres; ++c)
+        {
+            double *centre = &this->centres[((size_t)c) * numVars];
+            for(unsigned int v = 0; v < numVars; ++v)
+            {
+                centre[v] = varMajor?centres[(((size_t)v) * numCentres) + c]:centres[(((size_t)c) * numVars) + v];
+                this->centreSqNorms[c] += centre[v] * centre[v];
+            }
+            this->maxCentreSqNorm = std::max(this->maxCentreSqNorm, this->centreSqNorms[c]);
+        }
+
+        this->normOrder.resize(numCentres);
+        for(unsigned int c = 0; c < numCentres; ++c)
+        {
+            this->normOrder[c] = c;
+        }
+        std::stable_sort(this->normOrder.begin(), this->normOrder.end(), [this](unsigned int a, unsigned int b){return this->centreSqNorms[a] < this->centreSqNorms[b];});
+        this->sortedNorms.resize(numCentres);
+        for(unsigned int i = 0; i < numCentres; ++i)
+        {
+            this->sortedNorms[i] = sqrt(this->centreSqNorms[this->normOrder[i]]);
+        }
+    }
+
+    unsigned int RSGISNearestCentreSearch::findNearest(const float *vals, double *sqDist) const
+    {
+        return this->searchByNorm<float>(vals, sqDist);
+    }
+
+    unsigned int RSGISNearestCentreSearch::findNearest(const double *vals, double *sqDist) const
+    {
+        return this->searchByNorm<double>(vals, sqDist);
+    }
+
+    template<typename T> unsigned int RSGISNearestCentreSearch::searchByNorm(const T *vals, double *sqDist) const
+    {
+        double xSqNorm = 0.0;
+        for(unsigned int v = 0; v < this->numVars; ++v)
+        {
+            xSqNorm += ((double)vals[v]) * vals[v];
+        }
+        double xNorm = sqrt(xSqNorm);
+
+        // Walk out from the value's norm in both directions, taking the closer
+        // norm each time. (||x|| - ||c||)^2 is a lower bound on the squared
+        // distance so a direction is finished once it is above the best.
+        size_t upper = std::lower_bound(this->sortedNorms.begin(), this->sortedNorms.end(), xNorm) - this->sortedNorms.begin();
+        size_t lower = upper;
+        bool searchLower = (lower > 0);
+        bool searchUpper = (upper < this->numCentres);
+        double bestDist = std::numeric_limits<double>::infinity();
+        unsigned int bestIdx = this->numCentres;
+        size_t pos = 0;
+        bool fromLower = false;
+        while(searchLower | searchUpper)
+        {
+            fromLower = searchLower && (!searchUpper || ((xNorm - this->sortedNorms[lower-1]) <= (this->sortedNorms[upper] - xNorm)));
+            pos = fromLower?(--lower):(upper++);
+
+            double normDiff = xNorm - this->sortedNorms[pos];
+            double tolerance = 16 * std::numeric_limits<double>::epsilon() * (xSqNorm + this->centreSqNorms[this->normOrder[pos]]);
+            if((normDiff * normDiff) > (bestDist + tolerance))
+            {
+                if(fromLower)
+                {
+                    searchLower = false;
+                }
+                else
+                {
+                    searchUpper = false;
+                }
+                continue;
+            }
+            searchLower = searchLower & (lower > 0);
+            searchUpper = searchUpper & (upper < this->numCentres);
+
+            unsigned int idx = this->normOrder[pos];
+            const double *centre = &this->centres[((size_t)idx) * this->numVars];
+            double dist = 0.0;
+            double diff = 0.0;
+            unsigned int v = 0;
+            for(; v < this->numVars; ++v)
+            {
+                diff = vals[v] - centre[v];
+                dist += diff * diff;
+                if(dist > bestDist)
+                {
+                    break;
+                }
+            }
+            if((v == this->numVars) && ((dist < bestDist) || ((dist == bestDist) && (idx < bestIdx))))
+            {
+                bestDist = dist;
+                bestIdx = idx;
+            }
+        }
+
+        if(bestIdx == this->numCentres)
+        {
+            bestIdx = 0;
+            bestDist = std::numeric_limits<double>::quiet_NaN();
+        }
+        if(sqDist != NULL)
+        {
+            *sqDist = bestDist;
+        }
+        return bestIdx;
+    }
+
+    void RSGISNearestCentreSearch::findNearest(const double *vals, size_t numVals, unsigned int *idxs, double *sqDists) const
+    {
+        if(numVals == 0)
+        {
+            return;
+        }
+        const size_t valBlockSize = 256;
+        const unsigned int centreBlockSize = 256;
+        size_t maxValBlock = std::min(valBlockSize, numVals);
+        unsigned int maxCentreBlock = std::min(centreBlockSize, this->numCentres);
+        std::vector<double> scores(maxValBlock * maxCentreBlock);
+        std::vector<double> valSqNorms(maxValBlock);
+        std::vector<double> bestDists(maxValBlock);
+        const double relTolerance = (this->numVars + 4) * 8 * std::numeric_limits<double>::epsilon();
+
+        for(size_t start = 0; start < numVals; start += valBlockSize)
+        {
+            size_t numBlockVals = std::min(valBlockSize, numVals - start);
+            const double *blockVals = vals + (start * this->numVars);
+            unsigned int *blockIdxs = idxs + start;
+            for(size_t i = 0; i < numBlockVals; ++i)
+            {
+                valSqNorms[i] = 0.0;
+                for(unsigned int v = 0; v < this->numVars; ++v)
+                {
+                    valSqNorms[i] += blockVals[(i * this->numVars) + v] * blockVals[(i * this->numVars) + v];
+                }
+                bestDists[i] = std::numeric_limits<double>::infinity();
+                blockIdxs[i] = this->numCentres;
+            }
+
+            gsl_matrix_const_view valsView = gsl_matrix_const_view_array(blockVals, numBlockVals, this->numVars);
+            for(unsigned int cStart = 0; cStart < this->numCentres; cStart += centreBlockSize)
+            {
+                unsigned int numBlockCentres = std::min(centreBlockSize, this->numCentres - cStart);
+                gsl_matrix_const_view centresView = gsl_matrix_const_view_array(&this->centres[((size_t)cStart) * this->numVars], numBlockCentres, this->numVars);
+                gsl_matrix_view scoresView = gsl_matrix_view_array(scores.data(), numBlockVals, numBlockCentres);
+                gsl_blas_dgemm(CblasNoTrans, CblasTrans, 1.0, &valsView.matrix, &centresView.matrix, 0.0, &scoresView.matrix);
+
+                for(size_t i = 0; i < numBlockVals; ++i)
+                {
+                    double *valScores = &scores[i * numBlockCentres];
+                    double blockMin = std::numeric_limits<double>::infinity();
+                    for(unsigned int j = 0; j < numBlockCentres; ++j)
+                    {
+                        valScores[j] = valSqNorms[i] - (2.0 * valScores[j]) + this->centreSqNorms[cStart + j];
+                        blockMin = std::min(blockMin, valScores[j]);
+                    }
+
+                    // Check exactly every centre which could be the nearest
+                    // given the rounding error of the expanded distances.
+                    double threshold = std::min(blockMin, bestDists[i]) + (relTolerance * (valSqNorms[i] + this->maxCentreSqNorm));
+                    const double *val = blockVals + (i * this->numVars);
+                    for(unsigned int j = 0; j < numBlockCentres; ++j)
+                    {
+                        if(valScores[j] <= threshold)
+                        {
+                            const double *centre = &this->centres[((size_t)(cStart + j)) * this->numVars];
+                            double dist = 0.0;
+                            double diff = 0.0;
+                            unsigned int v = 0;
+                            for(; v < this->numVars; ++v)
+                            {
+                                diff = val[v] - centre[v];
+                                dist += diff * diff;
+                                if(dist > bestDists[i])
+                                {
+                                    break;
+                                }
+                            }
+                            if((v == this->numVars) && ((dist < bestDists[i]) || ((dist == bestDists[i]) && ((cStart + j) < blockIdxs[i]))))
+                            {
+                                bestDists[i] = dist;
+                                blockIdxs[i] = cStart + j;
+                            }
+                        }
+                    }
+                }
+            }
+
+            for(size_t i = 0; i < numBlockVals; ++i)
+            {
+                if(blockIdxs[i] == this->numCentres)
+                {
+                    blockIdxs[i] = 0;
+                    bestDists[i] = std::numeric_limits<double>::quiet_NaN();
+                }
+                if(sqDists != NULL)
+                {
+                    sqDists[start + i] = bestDists[i];
+                }
+            }
+        }
+    }
+
+}}
@@ -0,0 +1,101 @@
+/*
+ *  RSGISNearestCentreSearch.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISNearestCentreSearch_H
+#define RSGISNearestCentreSearch_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <math.h>
+
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_blas.h>
+
+#include "math/RSGISMathException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_maths_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace math{
+
+    /**
+     * Finds the nearest (Euclidean) of a set of centres (e.g., cluster centres)
+     * for pixel values. The centre norms are calculated once so that:
+     *
+     * - a single value is searched in order of centre norm, outwards from the
+     *   norm of the value, stopping once | ||x|| - ||c|| | exceeds the best
+     *   distance found (with each distance abandoned once it exceeds the best).
+     * - a block of values is compared with a block of centres as one matrix
+     *   product, using ||x||^2 - 2x.c + ||c||^2, and only the centres within
+     *   rounding error of the smallest of those are checked exactly.
+     *
+     * Both return the same centre as a full scan: the lowest index of the
+     * centres with the minimum distance. A value with a non-finite element is
+     * given centre 0. The search does not modify the object so can be shared
+     * between threads.
+     */
+    class DllExport RSGISNearestCentreSearch
+    {
+    public:
+        /**
+         * The centres are numCentres x numVars values, stored centre by centre
+         * or, if varMajor, variable by variable (i.e., vals[var*numCentres+centre]).
+         */
+        RSGISNearestCentreSearch(const double *centres, unsigned int numCentres, unsigned int numVars, bool varMajor=false);
+        void setCentres(const double *centres, unsigned int numCentres, unsigned int numVars, bool varMajor=false);
+        unsigned int findNearest(const float *vals, double *sqDist=NULL) const;
+        unsigned int findNearest(const double *vals, double *sqDist=NULL) const;
+        /**
+         * Finds the nearest centre for numVals values stored value by value
+         * (i.e., vals[i*numVars+var]) writing the centre indexes to idxs and,
+         * if not NULL, the squared distances to sqDists.
+         */
+        void findNearest(const double *vals, size_t numVals, unsigned int *idxs, double *sqDists=NULL) const;
+        unsigned int getNumCentres() const {return this->numCentres;};
+        unsigned int getNumVars() const {return this->numVars;};
+        const double* getCentre(unsigned int idx) const {return &this->centres[((size_t)idx) * this->numVars];};
+        ~RSGISNearestCentreSearch(){};
+    protected:
+        template<typename T> unsigned int searchByNorm(const T *vals, double *sqDist) const;
+        unsigned int numCentres;
+        unsigned int numVars;
+        std::vector<double> centres;
+        std::vector<double> centreSqNorms;
+        std::vector<double> sortedNorms;
+        std::vector<unsigned int> normOrder;
+        double maxCentreSqNorm;
+    };
+
+}}
+
+#endif
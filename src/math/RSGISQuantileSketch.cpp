@@ -0,0 +1,247 @@
+/*
+ *  RSGISQuantileSketch.cpp
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISQuantileSketch.h"
+
+namespace rsgis{namespace math{
+
+    RSGISQuantileSketch::RSGISQuantileSketch(unsigned int k, boost::uint_fast64_t seed)
+    {
+        if(k < 8)
+        {
+            throw RSGISMathException("The quantile sketch parameter k must be at least 8.");
+        }
+        this->k = k;
+        this->seed = seed;
+        this->reset();
+    }
+
+    void RSGISQuantileSketch::setSeed(boost::uint_fast64_t seed)
+    {
+        this->seed = seed;
+        this->randState = this->seedState(seed);
+    }
+
+    boost::uint_fast64_t RSGISQuantileSketch::seedState(boost::uint_fast64_t seed) const
+    {
+        // splitmix64 so neighbouring seeds give unrelated (and non-zero) xorshift states.
+        boost::uint_fast64_t z = (seed + 0x9E3779B97F4A7C15ULL) & 0xFFFFFFFFFFFFFFFFULL;
+        z = ((z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL) & 0xFFFFFFFFFFFFFFFFULL;
+        z = ((z ^ (z >> 27)) * 0x94D049BB133111EBULL) & 0xFFFFFFFFFFFFFFFFULL;
+        z = z ^ (z >> 31);
+        if(z == 0)
+        {
+            z = 0x9E3779B97F4A7C15ULL;
+        }
+        return z;
+    }
+
+    void RSGISQuantileSketch::reset()
+    {
+        this->n = 0;
+        this->numRetained = 0;
+        this->randState = this->seedState(this->seed);
+        this->levels.clear();
+        this->levels.push_back(std::vector<double>());
+        this->maxRetained = this->levelCapacity(0);
+    }
+
+    unsigned int RSGISQuantileSketch::levelCapacity(size_t level) const
+    {
+        // Capacities decay geometrically (factor 2/3) from the top level down.
+        size_t depth = this->levels.size() - level - 1;
+        double cap = ceil(((double)this->k) * pow(2.0/3.0, (double)depth));
+        if(cap < 2)
+        {
+            cap = 2;
+        }
+        return (unsigned int)cap;
+    }
+
+    void RSGISQuantileSketch::add(double val)
+    {
+        this->levels[0].push_back(val);
+        ++this->numRetained;
+        ++this->n;
+        if(this->numRetained >= this->maxRetained)
+        {
+            this->compress();
+        }
+    }
+
+    void RSGISQuantileSketch::compress()
+    {
+        while(this->numRetained >= this->maxRetained)
+        {
+            for(size_t h = 0; h < this->levels.size(); ++h)
+            {
+                if(this->levels[h].size() >= this->levelCapacity(h))
+                {
+                    if((h+1) >= this->levels.size())
+                    {
+                        this->levels.push_back(std::vector<double>());
+                    }
+                    std::vector<double> &level = this->levels[h];
+                    std::vector<double> &nextLevel = this->levels[h+1];
+
+                    // Keep one item behind if the level has an odd length.
+                    double leftOver = 0;
+                    bool hasLeftOver = (level.size() % 2) == 1;
+                    if(hasLeftOver)
+                    {
+                        leftOver = level.back();
+                        level.pop_back();
+                    }
+
+                    std::sort(level.begin(), level.end());
+
+                    // xorshift64 - a private generator so sketches are independent between threads.
+                    this->randState ^= this->randState << 13;
+                    this->randState ^= this->randState >> 7;
+                    this->randState ^= this->randState << 17;
+                    size_t offset = this->randState & 1;
+
+                    for(size_t i = offset; i < level.size(); i += 2)
+                    {
+                        nextLevel.push_back(level[i]);
+                    }
+                    level.clear();
+                    if(hasLeftOver)
+                    {
+                        level.push_back(leftOver);
+                    }
+                    break;
+                }
+            }
+
+            this->numRetained = 0;
+            this->maxRetained = 0;
+            for(size_t h = 0; h < this->levels.size(); ++h)
+            {
+                this->numRetained += this->levels[h].size();
+                this->maxRetained += this->levelCapacity(h);
+            }
+        }
+    }
+
+    void RSGISQuantileSketch::merge(const RSGISQuantileSketch &other)
+    {
+        if(other.n == 0)
+        {
+            return;
+        }
+        while(this->levels.size() < other.levels.size())
+        {
+            this->levels.push_back(std::vector<double>());
+        }
+        for(size_t h = 0; h < other.levels.size(); ++h)
+        {
+            this->levels[h].insert(this->levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+        }
+        this->n += other.n;
+
+        this->numRetained = 0;
+        this->maxRetained = 0;
+        for(size_t h = 0; h < this->levels.size(); ++h)
+        {
+            this->numRetained += this->levels[h].size();
+            this->maxRetained += this->levelCapacity(h);
+        }
+        this->compress();
+    }
+
+    void RSGISQuantileSketch::sortedItemsAndWeights(std::vector<std::pair<double, boost::uint_fast64_t> > *items) const
+    {
+        items->clear();
+        items->reserve(this->numRetained);
+        for(size_t h = 0; h < this->levels.size(); ++h)
+        {
+            boost::uint_fast64_t weight = ((boost::uint_fast64_t)1) << h;
+            for(std::vector<double>::const_iterator iterVals = this->levels[h].begin(); iterVals != this->levels[h].end(); ++iterVals)
+            {
+                items->push_back(std::pair<double, boost::uint_fast64_t>(*iterVals, weight));
+            }
+        }
+        std::sort(items->begin(), items->end());
+    }
+
+    double RSGISQuantileSketch::getQuantile(double quantile) const
+    {
+        if(this->n == 0)
+        {
+            throw RSGISMathException("Cannot calculate a quantile from an empty sketch.");
+        }
+        if(quantile < 0)
+        {
+            quantile = 0;
+        }
+        else if(quantile > 1)
+        {
+            quantile = 1;
+        }
+
+        std::vector<std::pair<double, boost::uint_fast64_t> > items;
+        this->sortedItemsAndWeights(&items);
+
+        boost::uint_fast64_t totalWeight = 0;
+        for(size_t i = 0; i < items.size(); ++i)
+        {
+            totalWeight += items[i].second;
+        }
+
+        double target = quantile * ((double)totalWeight);
+        boost::uint_fast64_t cumWeight = 0;
+        for(size_t i = 0; i < items.size(); ++i)
+        {
+            cumWeight += items[i].second;
+            if(((double)cumWeight) >= target)
+            {
+                return items[i].first;
+            }
+        }
+        return items.back().first;
+    }
+
+    double RSGISQuantileSketch::getRank(double val) const
+    {
+        if(this->n == 0)
+        {
+            return 0;
+        }
+        boost::uint_fast64_t totalWeight = 0;
+        boost::uint_fast64_t lessEqWeight = 0;
+        for(size_t h = 0; h < this->levels.size(); ++h)
+        {
+            boost::uint_fast64_t weight = ((boost::uint_fast64_t)1) << h;
+            for(std::vector<double>::const_iterator iterVals = this->levels[h].begin(); iterVals != this->levels[h].end(); ++iterVals)
+            {
+                totalWeight += weight;
+                if((*iterVals) <= val)
+                {
+                    lessEqWeight += weight;
+                }
+            }
+        }
+        return ((double)lessEqWeight)/((double)totalWeight);
+    }
+
+}}
@@ -0,0 +1,86 @@
+/*
+ *  RSGISQuantileSketch.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISQuantileSketch_H
+#define RSGISQuantileSketch_H
+
+#include <vector>
+#include <algorithm>
+#include <math.h>
+
+#include <boost/cstdint.hpp>
+
+#include "math/RSGISMathException.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_maths_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace math{
+
+    /**
+     * A KLL quantile sketch (Karnin, Lang and Liberty, 2016). Values are streamed
+     * in with add() and the sketch holds O(k log(n/k)) of them, so percentiles of
+     * a whole image can be estimated in a single pass. Sketches built on separate
+     * threads or image blocks can be combined with merge(). The rank error is
+     * roughly 1.7/k (i.e., ~1% for the default k=200). Sketches which are to be
+     * merged should be given different seeds so their compactions are independent.
+     */
+    class DllExport RSGISQuantileSketch
+    {
+    public:
+        RSGISQuantileSketch(unsigned int k=200, boost::uint_fast64_t seed=0);
+        void add(double val);
+        void merge(const RSGISQuantileSketch &other);
+        double getQuantile(double quantile) const;
+        double getRank(double val) const;
+        boost::uint_fast64_t getN() const{return this->n;};
+        bool empty() const{return this->n == 0;};
+        void reset();
+        void setSeed(boost::uint_fast64_t seed);
+        ~RSGISQuantileSketch(){};
+    protected:
+        unsigned int levelCapacity(size_t level) const;
+        void compress();
+        boost::uint_fast64_t seedState(boost::uint_fast64_t seed) const;
+        void sortedItemsAndWeights(std::vector<std::pair<double, boost::uint_fast64_t> > *items) const;
+        unsigned int k;
+        boost::uint_fast64_t n;
+        size_t numRetained;
+        size_t maxRetained;
+        boost::uint_fast64_t seed;
+        boost::uint_fast64_t randState;
+        std::vector< std::vector<double> > levels;
+    };
+
+}}
+
+#endif
@@ -311,7 +311,7 @@ namespace rsgis{namespace rastergis{
         }
     }
     
-    void RSGISCalcClusterLocation::populateAttWithClumpPxlLocation(GDALDataset *dataset, unsigned int ratBand, std::string minXCol, std::string maxXCol, std::string minYCol, std::string maxYCol)
+    void RSGISCalcClusterLocation::populateAttWithClumpPxlLocation(GDALDataset *dataset, unsigned int ratBand, std::string minXCol, std::string maxXCol, std::string minYCol, std::string maxYCol, std::string blocksCol)
     {
         try
         {
@@ -323,100 +323,13 @@ namespace rsgis{namespace rastergis{
             {
                 throw rsgis::RSGISAttributeTableException("RAT Band is larger than the number of bands within the image.");
             }
-            RSGISRasterAttUtils attUtils;
-            
-            GDALRasterAttributeTable *attTable = dataset->GetRasterBand(ratBand)->GetDefaultRAT();
-            
-            size_t numRows = attTable->GetRowCount();
-            
-            long minVal = 0;
-            long maxVal = 0;
-            attUtils.getImageBandMinMax(dataset, 1, &minVal, &maxVal);
             
-            if(maxVal > numRows)
-            {
-                attTable->SetRowCount(maxVal+1);
-                numRows = maxVal+1;
-            }
-            
-            int minXIdx = attUtils.findColumnIndexOrCreate(attTable, minXCol, GFT_Real);
-            int maxXIdx = attUtils.findColumnIndexOrCreate(attTable, maxXCol, GFT_Real);
-            int minYIdx = attUtils.findColumnIndexOrCreate(attTable, minYCol, GFT_Real);
-            int maxYIdx = attUtils.findColumnIndexOrCreate(attTable, maxYCol, GFT_Real);
-            
-            unsigned long **pxlLoc = new unsigned long*[numRows];
-            bool *first = new bool[numRows];
-            for(size_t i = 0; i < numRows; ++i)
-            {
-                first[i] = true;
-                pxlLoc[i] = new unsigned long[4];
-                pxlLoc[i][0] = 0;
-                pxlLoc[i][1] = 0;
-                pxlLoc[i][2] = 0;
-                pxlLoc[i][3] = 0;
-            }
-            
-            RSGISCalcClusterPxlExtentCalcValue *calcLoc = new RSGISCalcClusterPxlExtentCalcValue(pxlLoc, first, ratBand);
-            rsgis::img::RSGISCalcImage calcImage(calcLoc);
-            calcImage.calcImagePosPxl(&dataset, 1, 0);
-            delete calcLoc;
+            // A single pass over the image, which also finds the number of rows required.
+            RSGISClumpBBoxIndex bboxIdx;
+            bboxIdx.buildIndex(dataset, ratBand, (blocksCol != ""));
             
             std::cout << "Writing data to output RAT\n";
-            size_t numBlocks = floor((double)numRows/(double)RAT_BLOCK_LENGTH);
-            size_t rowsRemain = numRows - (numBlocks * RAT_BLOCK_LENGTH);
-            
-            rsgis::math::RSGISMathsUtils mathUtils;
-            double *dataMinXBlock = new double[RAT_BLOCK_LENGTH];
-            double *dataMaxXBlock = new double[RAT_BLOCK_LENGTH];
-            double *dataMinYBlock = new double[RAT_BLOCK_LENGTH];
-            double *dataMaxYBlock = new double[RAT_BLOCK_LENGTH];
-            size_t startRow = 0;
-            size_t rowID = 0;
-            for(size_t i = 0; i < numBlocks; ++i)
-            {
-                rowID = startRow;
-                for(size_t j = 0; j < RAT_BLOCK_LENGTH; ++j)
-                {
-                    dataMinXBlock[j] = pxlLoc[rowID][0];
-                    dataMinYBlock[j] = pxlLoc[rowID][1];
-                    dataMaxXBlock[j] = pxlLoc[rowID][2];
-                    dataMaxYBlock[j] = pxlLoc[rowID][3];
-                    ++rowID;
-                }
-                attTable->ValuesIO(GF_Write, minXIdx, startRow, RAT_BLOCK_LENGTH, dataMinXBlock);
-                attTable->ValuesIO(GF_Write, minYIdx, startRow, RAT_BLOCK_LENGTH, dataMinYBlock);
-                attTable->ValuesIO(GF_Write, maxXIdx, startRow, RAT_BLOCK_LENGTH, dataMaxXBlock);
-                attTable->ValuesIO(GF_Write, maxYIdx, startRow, RAT_BLOCK_LENGTH, dataMaxYBlock);
-                
-                startRow += RAT_BLOCK_LENGTH;
-            }
-            if(rowsRemain > 0)
-            {
-                rowID = startRow;
-                for(size_t j = 0; j < rowsRemain; ++j)
-                {
-                    dataMinXBlock[j] = pxlLoc[rowID][0];
-                    dataMinYBlock[j] = pxlLoc[rowID][1];
-                    dataMaxXBlock[j] = pxlLoc[rowID][2];
-                    dataMaxYBlock[j] = pxlLoc[rowID][3];
-                    ++rowID;
-                }
-                attTable->ValuesIO(GF_Write, minXIdx, startRow, rowsRemain, dataMinXBlock);
-                attTable->ValuesIO(GF_Write, minYIdx, startRow, rowsRemain, dataMinYBlock);
-                attTable->ValuesIO(GF_Write, maxXIdx, startRow, rowsRemain, dataMaxXBlock);
-                attTable->ValuesIO(GF_Write, maxYIdx, startRow, rowsRemain, dataMaxYBlock);
-            }
-            
-            delete[] dataMinXBlock;
-            delete[] dataMinYBlock;
-            delete[] dataMaxXBlock;
-            delete[] dataMaxYBlock;
-            
-            for(size_t i = 0; i < numRows; ++i)
-            {
-                delete[] pxlLoc[i];
-            }
-            delete[] pxlLoc;
+            bboxIdx.writeIndex(dataset, ratBand, minXCol, maxXCol, minYCol, maxYCol, blocksCol);
             
             dataset->GetRasterBand(ratBand)->SetMetadataItem("LAYER_TYPE", "thematic");
         }
@@ -33,6 +33,7 @@
 #include "common/RSGISAttributeTableException.h"
 
 #include "rastergis/RSGISRasterAttUtils.h"
+#include "rastergis/RSGISClumpBBoxIndex.h"
 
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
@@ -62,7 +63,7 @@ namespace rsgis{namespace rastergis{
         RSGISCalcClusterLocation();
         void populateAttWithClumpLocation(GDALDataset *dataset, unsigned int ratBand, std::string eastColumn, std::string northColumn);
         void populateAttWithClumpLocationExtent(GDALDataset *dataset, unsigned int ratBand, std::string minXColX, std::string minXColY, std::string maxXColX, std::string maxXColY, std::string minYColX, std::string minYColY, std::string maxYColX, std::string maxYColY);
-        void populateAttWithClumpPxlLocation(GDALDataset *dataset, unsigned int ratBand, std::string minXCol, std::string maxXCol, std::string minYCol, std::string maxYCol);
+        void populateAttWithClumpPxlLocation(GDALDataset *dataset, unsigned int ratBand, std::string minXCol, std::string maxXCol, std::string minYCol, std::string maxYCol, std::string blocksCol="");
         ~RSGISCalcClusterLocation();
     };
     
@@ -81,10 +81,11 @@ namespace rsgis{namespace rastergis{
             
             long max = 0;
             long min = 0;
-            std::cout << "Get Image Min and Max.\n";
-            RSGISCalcImgMinMax calcMinMac = RSGISCalcImgMinMax(&min, &max, ratBand-1);
-            rsgis::img::RSGISCalcImage calcImageMinMax(&calcMinMac);
-            calcImageMinMax.calcImage(&clumpsDataset, 1, 0);
+            // The min, max and histogram are found together in a single (parallel) pass.
+            std::cout << "Get Image Min, Max and Histogram.\n";
+            std::vector<size_t> histo;
+            rsgis::img::RSGISSinglePassImageStats calcImgStats;
+            calcImgStats.calcThematicHistogram(clumpsDataset, ratBand, &histo, &min, &max);
             
             
             if((min == 0) & (max == 0))
@@ -145,17 +146,6 @@ namespace rsgis{namespace rastergis{
                 }
                 
                 size_t maxHistVal = max+1;
-                size_t *histo = new size_t[maxHistVal];
-                
-                for(size_t i = 0; i < maxHistVal; ++i)
-                {
-                    histo[i] = 0;
-                }
-                
-                std::cout << "Get Image Histogram.\n";
-                RSGISGetClumpsHistogram calcImgHisto = RSGISGetClumpsHistogram(histo, maxHistVal, (ratBand-1));
-                rsgis::img::RSGISCalcImage calcImageStats(&calcImgHisto);
-                calcImageStats.calcImage(&clumpsDataset, 1, 0);
                 
                 if(ignoreZero)
                 {
@@ -278,7 +268,6 @@ namespace rsgis{namespace rastergis{
                         attTable->ValuesIO(GF_Write, alphaColIdx, startRow, rowsRemain, alphaBlock);
                     }
                 }
-                delete[] histo;
             }
 
             
@@ -0,0 +1,631 @@
+/*
+ *  RSGISClumpBBoxIndex.cpp
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISClumpBBoxIndex.h"
+
+namespace rsgis{namespace rastergis{
+    
+    RSGISClumpBBoxIndex::RSGISClumpBBoxIndex()
+    {
+        this->imgWidth = 0;
+        this->imgHeight = 0;
+        this->xBlockSize = 0;
+        this->yBlockSize = 0;
+        this->numXBlocks = 0;
+        this->numYBlocks = 0;
+        this->useBlocks = false;
+    }
+    
+    void RSGISClumpBBoxIndex::setImageGrid(GDALDataset *clumpsImage, unsigned int ratBand)
+    {
+        if((ratBand == 0) | (ratBand > clumpsImage->GetRasterCount()))
+        {
+            throw rsgis::RSGISAttributeTableException("RAT band is not within the clumps image.");
+        }
+        this->imgWidth = clumpsImage->GetRasterXSize();
+        this->imgHeight = clumpsImage->GetRasterYSize();
+        
+        int xBlock = 0;
+        int yBlock = 0;
+        clumpsImage->GetRasterBand(ratBand)->GetBlockSize(&xBlock, &yBlock);
+        this->xBlockSize = (xBlock < 1)?this->imgWidth:xBlock;
+        this->yBlockSize = (yBlock < 1)?1:yBlock;
+        this->numXBlocks = (this->imgWidth + this->xBlockSize - 1) / this->xBlockSize;
+        this->numYBlocks = (this->imgHeight + this->yBlockSize - 1) / this->yBlockSize;
+    }
+    
+    void RSGISClumpBBoxIndex::buildIndex(GDALDataset *clumpsImage, unsigned int ratBand, bool calcBlockOccupancy)
+    {
+        try
+        {
+            this->setImageGrid(clumpsImage, ratBand);
+            GDALRasterBand *clumpBand = clumpsImage->GetRasterBand(ratBand);
+            
+            this->present.assign(1, 0);
+            this->minXPxl.assign(1, 0);
+            this->maxXPxl.assign(1, 0);
+            this->minYPxl.assign(1, 0);
+            this->maxYPxl.assign(1, 0);
+            this->useBlocks = calcBlockOccupancy;
+            this->blockOffsets.clear();
+            this->blockIdxs.clear();
+            
+            // (clump, block) pairs, appended in block order, and the block (+1) each clump was last seen in.
+            std::vector<std::pair<unsigned int, unsigned int> > clumpBlocks;
+            std::vector<unsigned int> lastBlock(1, 0);
+            
+            size_t maxClumpID = 0;
+            std::vector<unsigned int> data(((size_t)this->xBlockSize) * ((size_t)this->yBlockSize));
+            int xOff = 0;
+            int yOff = 0;
+            int xSize = 0;
+            int ySize = 0;
+            rsgis_tqdm pbar;
+            for(unsigned int yBlock = 0; yBlock < this->numYBlocks; ++yBlock)
+            {
+                pbar.progress(yBlock, this->numYBlocks);
+                for(unsigned int xBlock = 0; xBlock < this->numXBlocks; ++xBlock)
+                {
+                    this->getBlockWindow(xBlock, yBlock, &xOff, &yOff, &xSize, &ySize);
+                    if(clumpBand->RasterIO(GF_Read, xOff, yOff, xSize, ySize, data.data(), xSize, ySize, GDT_UInt32, 0, 0) != CE_None)
+                    {
+                        throw rsgis::RSGISAttributeTableException("Could not read a block of the clumps image.");
+                    }
+                    unsigned int blockIdx = (yBlock * this->numXBlocks) + xBlock;
+                    
+                    for(int y = 0; y < ySize; ++y)
+                    {
+                        const unsigned int *row = data.data() + (((size_t)y) * xSize);
+                        unsigned int yPxl = yOff + y;
+                        int x = 0;
+                        while(x < xSize)
+                        {
+                            // Runs of the same clump only need their end points testing.
+                            unsigned int clumpID = row[x];
+                            int runStart = x;
+                            while((x < xSize) && (row[x] == clumpID))
+                            {
+                                ++x;
+                            }
+                            if(clumpID == 0)
+                            {
+                                continue;
+                            }
+                            
+                            if(clumpID >= this->present.size())
+                            {
+                                size_t newSize = std::max(((size_t)clumpID)+1, this->present.size()*2);
+                                this->present.resize(newSize, 0);
+                                this->minXPxl.resize(newSize, 0);
+                                this->maxXPxl.resize(newSize, 0);
+                                this->minYPxl.resize(newSize, 0);
+                                this->maxYPxl.resize(newSize, 0);
+                                if(calcBlockOccupancy)
+                                {
+                                    lastBlock.resize(newSize, 0);
+                                }
+                            }
+                            
+                            unsigned int runMinX = xOff + runStart;
+                            unsigned int runMaxX = xOff + x - 1;
+                            if(this->present[clumpID] == 0)
+                            {
+                                this->present[clumpID] = 1;
+                                this->minXPxl[clumpID] = runMinX;
+                                this->maxXPxl[clumpID] = runMaxX;
+                                this->minYPxl[clumpID] = yPxl;
+                                this->maxYPxl[clumpID] = yPxl;
+                                if(clumpID > maxClumpID)
+                                {
+                                    maxClumpID = clumpID;
+                                }
+                            }
+                            else
+                            {
+                                if(runMinX < this->minXPxl[clumpID])
+                                {
+                                    this->minXPxl[clumpID] = runMinX;
+                                }
+                                if(runMaxX > this->maxXPxl[clumpID])
+                                {
+                                    this->maxXPxl[clumpID] = runMaxX;
+                                }
+                                if(yPxl < this->minYPxl[clumpID])
+                                {
+                                    this->minYPxl[clumpID] = yPxl;
+                                }
+                                if(yPxl > this->maxYPxl[clumpID])
+                                {
+                                    this->maxYPxl[clumpID] = yPxl;
+                                }
+                            }
+                            
+                            if(calcBlockOccupancy && (lastBlock[clumpID] != (blockIdx+1)))
+                            {
+                                lastBlock[clumpID] = blockIdx+1;
+                                clumpBlocks.push_back(std::pair<unsigned int, unsigned int>(clumpID, blockIdx));
+                            }
+                        }
+                    }
+                }
+            }
+            pbar.finish();
+            
+            size_t numClumps = maxClumpID + 1;
+            this->present.resize(numClumps);
+            this->minXPxl.resize(numClumps);
+            this->maxXPxl.resize(numClumps);
+            this->minYPxl.resize(numClumps);
+            this->maxYPxl.resize(numClumps);
+            
+            if(calcBlockOccupancy)
+            {
+                // Counting sort of the pairs by clump; blocks stay in ascending order within each clump.
+                this->blockOffsets.assign(numClumps+1, 0);
+                for(std::vector<std::pair<unsigned int, unsigned int> >::iterator iterPairs = clumpBlocks.begin(); iterPairs != clumpBlocks.end(); ++iterPairs)
+                {
+                    ++this->blockOffsets[(*iterPairs).first+1];
+                }
+                for(size_t i = 1; i <= numClumps; ++i)
+                {
+                    this->blockOffsets[i] += this->blockOffsets[i-1];
+                }
+                this->blockIdxs.resize(clumpBlocks.size());
+                std::vector<size_t> fillPos(this->blockOffsets.begin(), this->blockOffsets.end()-1);
+                for(std::vector<std::pair<unsigned int, unsigned int> >::iterator iterPairs = clumpBlocks.begin(); iterPairs != clumpBlocks.end(); ++iterPairs)
+                {
+                    this->blockIdxs[fillPos[(*iterPairs).first]++] = (*iterPairs).second;
+                }
+            }
+        }
+        catch(rsgis::RSGISAttributeTableException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw rsgis::RSGISAttributeTableException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw rsgis::RSGISAttributeTableException(e.what());
+        }
+    }
+    
+    void RSGISClumpBBoxIndex::writeIndex(GDALDataset *clumpsImage, unsigned int ratBand, std::string minXCol, std::string maxXCol, std::string minYCol, std::string maxYCol, std::string blocksCol)
+    {
+        try
+        {
+            if((ratBand == 0) | (ratBand > clumpsImage->GetRasterCount()))
+            {
+                throw rsgis::RSGISAttributeTableException("RAT band is not within the clumps image.");
+            }
+            GDALRasterAttributeTable *attTable = clumpsImage->GetRasterBand(ratBand)->GetDefaultRAT();
+            if(attTable == NULL)
+            {
+                throw rsgis::RSGISAttributeTableException("The clumps image does not have a RAT.");
+            }
+            bool writeBlocks = this->useBlocks && (blocksCol != "");
+            
+            size_t numRows = attTable->GetRowCount();
+            if(numRows < this->present.size())
+            {
+                attTable->SetRowCount(this->present.size());
+                numRows = this->present.size();
+            }
+            
+            RSGISRasterAttUtils attUtils;
+            int minXIdx = attUtils.findColumnIndexOrCreate(attTable, minXCol, GFT_Real);
+            int maxXIdx = attUtils.findColumnIndexOrCreate(attTable, maxXCol, GFT_Real);
+            int minYIdx = attUtils.findColumnIndexOrCreate(attTable, minYCol, GFT_Real);
+            int maxYIdx = attUtils.findColumnIndexOrCreate(attTable, maxYCol, GFT_Real);
+            int blocksIdx = 0;
+            if(writeBlocks)
+            {
+                blocksIdx = attUtils.findColumnIndexOrCreate(attTable, blocksCol, GFT_String);
+            }
+            
+            double *dataMinXBlock = new double[RAT_BLOCK_LENGTH];
+            double *dataMaxXBlock = new double[RAT_BLOCK_LENGTH];
+            double *dataMinYBlock = new double[RAT_BLOCK_LENGTH];
+            double *dataMaxYBlock = new double[RAT_BLOCK_LENGTH];
+            std::vector<std::string> blockStrs;
+            char **dataBlocksBlock = new char*[RAT_BLOCK_LENGTH];
+            for(size_t startRow = 0; startRow < numRows; startRow += RAT_BLOCK_LENGTH)
+            {
+                size_t numBlockRows = std::min(((size_t)RAT_BLOCK_LENGTH), numRows - startRow);
+                if(writeBlocks)
+                {
+                    blockStrs.assign(numBlockRows, "");
+                }
+                for(size_t j = 0; j < numBlockRows; ++j)
+                {
+                    size_t rowID = startRow + j;
+                    if(this->hasClump(rowID))
+                    {
+                        dataMinXBlock[j] = this->minXPxl[rowID];
+                        dataMaxXBlock[j] = this->maxXPxl[rowID];
+                        dataMinYBlock[j] = this->minYPxl[rowID];
+                        dataMaxYBlock[j] = this->maxYPxl[rowID];
+                        if(writeBlocks)
+                        {
+                            blockStrs[j] = this->encodeBlocks(rowID);
+                        }
+                    }
+                    else
+                    {
+                        dataMinXBlock[j] = 0;
+                        dataMaxXBlock[j] = 0;
+                        dataMinYBlock[j] = 0;
+                        dataMaxYBlock[j] = 0;
+                    }
+                    if(writeBlocks)
+                    {
+                        dataBlocksBlock[j] = const_cast<char*>(blockStrs[j].c_str());
+                    }
+                }
+                attTable->ValuesIO(GF_Write, minXIdx, startRow, numBlockRows, dataMinXBlock);
+                attTable->ValuesIO(GF_Write, maxXIdx, startRow, numBlockRows, dataMaxXBlock);
+                attTable->ValuesIO(GF_Write, minYIdx, startRow, numBlockRows, dataMinYBlock);
+                attTable->ValuesIO(GF_Write, maxYIdx, startRow, numBlockRows, dataMaxYBlock);
+                if(writeBlocks)
+                {
+                    attTable->ValuesIO(GF_Write, blocksIdx, startRow, numBlockRows, dataBlocksBlock);
+                }
+            }
+            delete[] dataMinXBlock;
+            delete[] dataMaxXBlock;
+            delete[] dataMinYBlock;
+            delete[] dataMaxYBlock;
+            delete[] dataBlocksBlock;
+            
+            if(writeBlocks)
+            {
+                // The bitmaps are only valid for this block grid.
+                std::string blockSizeStr = boost::lexical_cast<std::string>(this->xBlockSize) + "," + boost::lexical_cast<std::string>(this->yBlockSize);
+                clumpsImage->GetRasterBand(ratBand)->SetMetadataItem((blocksCol + "_BLOCKSIZE").c_str(), blockSizeStr.c_str());
+            }
+        }
+        catch(rsgis::RSGISAttributeTableException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw rsgis::RSGISAttributeTableException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw rsgis::RSGISAttributeTableException(e.what());
+        }
+    }
+    
+    void RSGISClumpBBoxIndex::readIndex(GDALDataset *clumpsImage, unsigned int ratBand, std::string minXCol, std::string maxXCol, std::string minYCol, std::string maxYCol, std::string blocksCol)
+    {
+        try
+        {
+            this->setImageGrid(clumpsImage, ratBand);
+            GDALRasterAttributeTable *attTable = clumpsImage->GetRasterBand(ratBand)->GetDefaultRAT();
+            if(attTable == NULL)
+            {
+                throw rsgis::RSGISAttributeTableException("The clumps image does not have a RAT.");
+            }
+            size_t numRows = attTable->GetRowCount();
+            
+            RSGISRasterAttUtils attUtils;
+            std::vector<double> *minXVals = attUtils.readDoubleColumnAsVec(attTable, minXCol);
+            std::vector<double> *maxXVals = attUtils.readDoubleColumnAsVec(attTable, maxXCol);
+            std::vector<double> *minYVals = attUtils.readDoubleColumnAsVec(attTable, minYCol);
+            std::vector<double> *maxYVals = attUtils.readDoubleColumnAsVec(attTable, maxYCol);
+            
+            // Block occupancy is only used if it was calculated on the same block grid.
+            std::vector<std::string> *blockStrs = NULL;
+            if(blocksCol != "")
+            {
+                std::string blockSizeStr = boost::lexical_cast<std::string>(this->xBlockSize) + "," + boost::lexical_cast<std::string>(this->yBlockSize);
+                const char *storedBlockSize = clumpsImage->GetRasterBand(ratBand)->GetMetadataItem((blocksCol + "_BLOCKSIZE").c_str());
+                if((storedBlockSize != NULL) && (blockSizeStr == storedBlockSize))
+                {
+                    blockStrs = attUtils.readStrColumnAsVec(attTable, blocksCol);
+                }
+            }
+            
+            // Without the occupancy column the presence of a clump is taken from the
+            // histogram or, failing that, a non-zero bounding box.
+            std::vector<double> *histVals = NULL;
+            if(blockStrs == NULL)
+            {
+                for(int i = 0; i < attTable->GetColumnCount(); ++i)
+                {
+                    if(std::string(attTable->GetNameOfCol(i)) == "Histogram")
+                    {
+                        histVals = attUtils.readDoubleColumnAsVec(attTable, "Histogram");
+                        break;
+                    }
+                }
+            }
+            
+            this->present.assign(numRows, 0);
+            this->minXPxl.assign(numRows, 0);
+            this->maxXPxl.assign(numRows, 0);
+            this->minYPxl.assign(numRows, 0);
+            this->maxYPxl.assign(numRows, 0);
+            bool validIdx = true;
+            for(size_t i = 1; i < numRows; ++i)
+            {
+                if(blockStrs != NULL)
+                {
+                    this->present[i] = (blockStrs->at(i) != "")?1:0;
+                }
+                else if(histVals != NULL)
+                {
+                    this->present[i] = (histVals->at(i) > 0)?1:0;
+                }
+                else
+                {
+                    this->present[i] = ((maxXVals->at(i) > 0) | (maxYVals->at(i) > 0))?1:0;
+                }
+                
+                if(this->present[i] == 1)
+                {
+                    if((minXVals->at(i) < 0) | (minYVals->at(i) < 0) | (maxXVals->at(i) >= this->imgWidth) | (maxYVals->at(i) >= this->imgHeight) | (minXVals->at(i) > maxXVals->at(i)) | (minYVals->at(i) > maxYVals->at(i)))
+                    {
+                        validIdx = false;
+                        break;
+                    }
+                    this->minXPxl[i] = minXVals->at(i);
+                    this->maxXPxl[i] = maxXVals->at(i);
+                    this->minYPxl[i] = minYVals->at(i);
+                    this->maxYPxl[i] = maxYVals->at(i);
+                }
+            }
+            delete minXVals;
+            delete maxXVals;
+            delete minYVals;
+            delete maxYVals;
+            if(histVals != NULL)
+            {
+                delete histVals;
+            }
+            if(!validIdx)
+            {
+                if(blockStrs != NULL)
+                {
+                    delete blockStrs;
+                }
+                this->present.clear();
+                throw rsgis::RSGISAttributeTableException("The clump bounding box index is not valid for this image, it needs rebuilding.");
+            }
+            
+            this->useBlocks = (blockStrs != NULL);
+            this->blockOffsets.clear();
+            this->blockIdxs.clear();
+            if(this->useBlocks)
+            {
+                this->decodeBlocks(blockStrs);
+                delete blockStrs;
+            }
+        }
+        catch(rsgis::RSGISAttributeTableException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw rsgis::RSGISAttributeTableException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw rsgis::RSGISAttributeTableException(e.what());
+        }
+    }
+    
+    bool RSGISClumpBBoxIndex::hasClump(size_t clumpID) const
+    {
+        return (clumpID > 0) && (clumpID < this->present.size()) && (this->present[clumpID] == 1);
+    }
+    
+    bool RSGISClumpBBoxIndex::getClumpBBox(size_t clumpID, unsigned int *minX, unsigned int *maxX, unsigned int *minY, unsigned int *maxY) const
+    {
+        if(!this->hasClump(clumpID))
+        {
+            return false;
+        }
+        *minX = this->minXPxl[clumpID];
+        *maxX = this->maxXPxl[clumpID];
+        *minY = this->minYPxl[clumpID];
+        *maxY = this->maxYPxl[clumpID];
+        return true;
+    }
+    
+    void RSGISClumpBBoxIndex::getClumpBlocks(size_t clumpID, std::vector<std::pair<unsigned int, unsigned int> > *blocks) const
+    {
+        blocks->clear();
+        if(!this->hasClump(clumpID))
+        {
+            return;
+        }
+        if(this->useBlocks)
+        {
+            for(size_t i = this->blockOffsets[clumpID]; i < this->blockOffsets[clumpID+1]; ++i)
+            {
+                blocks->push_back(std::pair<unsigned int, unsigned int>(this->blockIdxs[i] % this->numXBlocks, this->blockIdxs[i] / this->numXBlocks));
+            }
+        }
+        else
+        {
+            // All the blocks which intersect the bounding box.
+            for(unsigned int yBlock = this->minYPxl[clumpID]/this->yBlockSize; yBlock <= this->maxYPxl[clumpID]/this->yBlockSize; ++yBlock)
+            {
+                for(unsigned int xBlock = this->minXPxl[clumpID]/this->xBlockSize; xBlock <= this->maxXPxl[clumpID]/this->xBlockSize; ++xBlock)
+                {
+                    blocks->push_back(std::pair<unsigned int, unsigned int>(xBlock, yBlock));
+                }
+            }
+        }
+    }
+    
+    void RSGISClumpBBoxIndex::getBlockWindow(unsigned int xBlock, unsigned int yBlock, int *xOff, int *yOff, int *xSize, int *ySize) const
+    {
+        *xOff = xBlock * this->xBlockSize;
+        *yOff = yBlock * this->yBlockSize;
+        *xSize = std::min(this->xBlockSize, this->imgWidth - (*xOff));
+        *ySize = std::min(this->yBlockSize, this->imgHeight - (*yOff));
+    }
+    
+    bool RSGISClumpBBoxIndex::readClumpWindow(GDALDataset *clumpsImage, unsigned int ratBand, size_t clumpID, std::vector<unsigned int> *data, unsigned int *xOff, unsigned int *yOff, unsigned int *xSize, unsigned int *ySize) const
+    {
+        if(!this->hasClump(clumpID))
+        {
+            return false;
+        }
+        if((clumpsImage->GetRasterXSize() != this->imgWidth) | (clumpsImage->GetRasterYSize() != this->imgHeight))
+        {
+            throw rsgis::RSGISAttributeTableException("The clumps image does not match the clump bounding box index.");
+        }
+        GDALRasterBand *clumpBand = clumpsImage->GetRasterBand(ratBand);
+        
+        *xOff = this->minXPxl[clumpID];
+        *yOff = this->minYPxl[clumpID];
+        *xSize = (this->maxXPxl[clumpID] - this->minXPxl[clumpID]) + 1;
+        *ySize = (this->maxYPxl[clumpID] - this->minYPxl[clumpID]) + 1;
+        data->assign(((size_t)(*xSize)) * ((size_t)(*ySize)), 0);
+        
+        if(!this->useBlocks)
+        {
+            if(clumpBand->RasterIO(GF_Read, *xOff, *yOff, *xSize, *ySize, data->data(), *xSize, *ySize, GDT_UInt32, 0, 0) != CE_None)
+            {
+                throw rsgis::RSGISAttributeTableException("Could not read from the clumps image.");
+            }
+            return true;
+        }
+        
+        // Only read the parts of the window within blocks holding the clump; elsewhere is left as zero.
+        int blkXOff = 0;
+        int blkYOff = 0;
+        int blkXSize = 0;
+        int blkYSize = 0;
+        for(size_t i = this->blockOffsets[clumpID]; i < this->blockOffsets[clumpID+1]; ++i)
+        {
+            this->getBlockWindow(this->blockIdxs[i] % this->numXBlocks, this->blockIdxs[i] / this->numXBlocks, &blkXOff, &blkYOff, &blkXSize, &blkYSize);
+            int x1 = std::max(blkXOff, (int)(*xOff));
+            int y1 = std::max(blkYOff, (int)(*yOff));
+            int x2 = std::min(blkXOff + blkXSize, (int)((*xOff) + (*xSize)));
+            int y2 = std::min(blkYOff + blkYSize, (int)((*yOff) + (*ySize)));
+            if((x2 <= x1) | (y2 <= y1))
+            {
+                continue;
+            }
+            unsigned int *dataPtr = data->data() + ((((size_t)(y1 - (*yOff))) * (*xSize)) + (x1 - (*xOff)));
+            if(clumpBand->RasterIO(GF_Read, x1, y1, (x2-x1), (y2-y1), dataPtr, (x2-x1), (y2-y1), GDT_UInt32, 0, ((GSpacing)(*xSize)) * sizeof(unsigned int)) != CE_None)
+            {
+                throw rsgis::RSGISAttributeTableException("Could not read from the clumps image.");
+            }
+        }
+        return true;
+    }
+    
+    std::string RSGISClumpBBoxIndex::encodeBlocks(size_t clumpID) const
+    {
+        // One bit per block within the bounding box (row major), four bits per hex character.
+        static const char hexChars[] = "0123456789ABCDEF";
+        unsigned int xBlock1 = this->minXPxl[clumpID] / this->xBlockSize;
+        unsigned int yBlock1 = this->minYPxl[clumpID] / this->yBlockSize;
+        unsigned int nXBlks = (this->maxXPxl[clumpID] / this->xBlockSize) - xBlock1 + 1;
+        unsigned int nYBlks = (this->maxYPxl[clumpID] / this->yBlockSize) - yBlock1 + 1;
+        size_t numBits = ((size_t)nXBlks) * ((size_t)nYBlks);
+        
+        std::vector<unsigned char> nibbles((numBits + 3) / 4, 0);
+        for(size_t i = this->blockOffsets[clumpID]; i < this->blockOffsets[clumpID+1]; ++i)
+        {
+            unsigned int xBlock = this->blockIdxs[i] % this->numXBlocks;
+            unsigned int yBlock = this->blockIdxs[i] / this->numXBlocks;
+            size_t bit = (((size_t)(yBlock - yBlock1)) * nXBlks) + (xBlock - xBlock1);
+            nibbles[bit / 4] |= (1 << (bit % 4));
+        }
+        
+        std::string blockStr(nibbles.size(), '0');
+        for(size_t i = 0; i < nibbles.size(); ++i)
+        {
+            blockStr[i] = hexChars[nibbles[i]];
+        }
+        return blockStr;
+    }
+    
+    void RSGISClumpBBoxIndex::decodeBlocks(std::vector<std::string> *blockStrs)
+    {
+        size_t numClumps = this->present.size();
+        this->blockOffsets.assign(numClumps+1, 0);
+        this->blockIdxs.clear();
+        for(size_t clumpID = 0; clumpID < numClumps; ++clumpID)
+        {
+            this->blockOffsets[clumpID] = this->blockIdxs.size();
+            if(this->present[clumpID] == 0)
+            {
+                continue;
+            }
+            const std::string &blockStr = blockStrs->at(clumpID);
+            unsigned int xBlock1 = this->minXPxl[clumpID] / this->xBlockSize;
+            unsigned int yBlock1 = this->minYPxl[clumpID] / this->yBlockSize;
+            unsigned int nXBlks = (this->maxXPxl[clumpID] / this->xBlockSize) - xBlock1 + 1;
+            size_t numBits = ((size_t)nXBlks) * ((size_t)((this->maxYPxl[clumpID] / this->yBlockSize) - yBlock1 + 1));
+            if(blockStr.size() != ((numBits + 3) / 4))
+            {
+                throw rsgis::RSGISAttributeTableException("The clump block occupancy does not match the bounding box, the index needs rebuilding.");
+            }
+            for(size_t i = 0; i < blockStr.size(); ++i)
+            {
+                char c = blockStr[i];
+                unsigned int nibble = 0;
+                if((c >= '0') & (c <= '9'))
+                {
+                    nibble = c - '0';
+                }
+                else if((c >= 'A') & (c <= 'F'))
+                {
+                    nibble = (c - 'A') + 10;
+                }
+                else if((c >= 'a') & (c <= 'f'))
+                {
+                    nibble = (c - 'a') + 10;
+                }
+                else
+                {
+                    throw rsgis::RSGISAttributeTableException("The clump block occupancy column is not a valid bitmap.");
+                }
+                for(unsigned int b = 0; b < 4; ++b)
+                {
+                    size_t bit = (i * 4) + b;
+                    if(((nibble >> b) & 1) && (bit < numBits))
+                    {
+                        unsigned int xBlock = xBlock1 + (bit % nXBlks);
+                        unsigned int yBlock = yBlock1 + (bit / nXBlks);
+                        this->blockIdxs.push_back((yBlock * this->numXBlocks) + xBlock);
+                    }
+                }
+            }
+        }
+        this->blockOffsets[numClumps] = this->blockIdxs.size();
+    }
+    
+}}
+
@@ -0,0 +1,108 @@
+/*
+ *  RSGISClumpBBoxIndex.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISClumpBBoxIndex_H
+#define RSGISClumpBBoxIndex_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "gdal_priv.h"
+#include "gdal_rat.h"
+
+#include "common/RSGISAttributeTableException.h"
+#include "common/rsgis-tqdm.h"
+
+#include "rastergis/RSGISRasterAttUtils.h"
+
+#include <boost/lexical_cast.hpp>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_rastergis_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace rastergis{
+    
+    /**
+     * A spatial index of the clumps within a clumps image, holding the pixel
+     * bounding box of each clump and, optionally, the list of image blocks
+     * (on the band's natural block grid) which contain pixels of that clump.
+     * The index is built in one pass over the image and allows the pixels of
+     * a single clump to be read without scanning the whole image. It can be
+     * used in memory or, where the caller names the columns, stored within the
+     * RAT (writeIndex) and reloaded. Block occupancy is stored as a
+     * hexadecimal bitmap over the blocks covered by the bounding box and is
+     * only used when read back on an image with the same block size.
+     */
+    class DllExport RSGISClumpBBoxIndex
+    {
+    public:
+        RSGISClumpBBoxIndex();
+        void buildIndex(GDALDataset *clumpsImage, unsigned int ratBand=1, bool calcBlockOccupancy=true);
+        void writeIndex(GDALDataset *clumpsImage, unsigned int ratBand, std::string minXCol, std::string maxXCol, std::string minYCol, std::string maxYCol, std::string blocksCol="");
+        void readIndex(GDALDataset *clumpsImage, unsigned int ratBand, std::string minXCol, std::string maxXCol, std::string minYCol, std::string maxYCol, std::string blocksCol="");
+        size_t getNumClumps() const {return this->present.size();};
+        bool hasClump(size_t clumpID) const;
+        bool hasBlockOccupancy() const {return this->useBlocks;};
+        bool getClumpBBox(size_t clumpID, unsigned int *minX, unsigned int *maxX, unsigned int *minY, unsigned int *maxY) const;
+        void getClumpBlocks(size_t clumpID, std::vector<std::pair<unsigned int, unsigned int> > *blocks) const;
+        void getBlockWindow(unsigned int xBlock, unsigned int yBlock, int *xOff, int *yOff, int *xSize, int *ySize) const;
+        bool readClumpWindow(GDALDataset *clumpsImage, unsigned int ratBand, size_t clumpID, std::vector<unsigned int> *data, unsigned int *xOff, unsigned int *yOff, unsigned int *xSize, unsigned int *ySize) const;
+        ~RSGISClumpBBoxIndex(){};
+    protected:
+        void setImageGrid(GDALDataset *clumpsImage, unsigned int ratBand);
+        std::string encodeBlocks(size_t clumpID) const;
+        void decodeBlocks(std::vector<std::string> *blockStrs);
+        unsigned int imgWidth;
+        unsigned int imgHeight;
+        unsigned int xBlockSize;
+        unsigned int yBlockSize;
+        unsigned int numXBlocks;
+        unsigned int numYBlocks;
+        std::vector<unsigned char> present;
+        std::vector<unsigned int> minXPxl;
+        std::vector<unsigned int> maxXPxl;
+        std::vector<unsigned int> minYPxl;
+        std::vector<unsigned int> maxYPxl;
+        bool useBlocks;
+        // Occupied block indexes (yBlock * numXBlocks + xBlock) for clump i are
+        // blockIdxs[blockOffsets[i]] to blockIdxs[blockOffsets[i+1]-1].
+        std::vector<size_t> blockOffsets;
+        std::vector<unsigned int> blockIdxs;
+    };
+    
+}}
+
+#endif
+
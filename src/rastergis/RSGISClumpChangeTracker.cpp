@@ -0,0 +1,349 @@
+/*
+ *  RSGISClumpChangeTracker.cpp
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "RSGISClumpChangeTracker.h"
+
+namespace rsgis{namespace rastergis{
+    
+    RSGISClumpChangeTracker::RSGISClumpChangeTracker(GDALDataset *clumpsImage, unsigned int ratBand)
+    {
+        if((ratBand == 0) | (ratBand > clumpsImage->GetRasterCount()))
+        {
+            throw rsgis::RSGISAttributeTableException("RAT band is not within the clumps image.");
+        }
+        this->imgWidth = clumpsImage->GetRasterXSize();
+        this->imgHeight = clumpsImage->GetRasterYSize();
+        
+        int xBlock = 0;
+        int yBlock = 0;
+        clumpsImage->GetRasterBand(ratBand)->GetBlockSize(&xBlock, &yBlock);
+        this->xBlockSize = (xBlock < 1)?this->imgWidth:xBlock;
+        this->yBlockSize = (yBlock < 1)?1:yBlock;
+        this->numXBlocks = (this->imgWidth + this->xBlockSize - 1) / this->xBlockSize;
+        this->numYBlocks = (this->imgHeight + this->yBlockSize - 1) / this->yBlockSize;
+        
+        this->changedBlocks.assign(((size_t)this->numXBlocks) * ((size_t)this->numYBlocks), false);
+        this->numChangedClumps = 0;
+        this->numPxlChangedClumps = 0;
+    }
+    
+    void RSGISClumpChangeTracker::markClump(size_t clumpID, bool pxlsChanged)
+    {
+        if(clumpID >= this->clumpState.size())
+        {
+            this->clumpState.resize(std::max(clumpID+1, this->clumpState.size()*2), 0);
+        }
+        unsigned char state = pxlsChanged?2:1;
+        if(this->clumpState[clumpID] == 0)
+        {
+            ++this->numChangedClumps;
+        }
+        if((state == 2) & (this->clumpState[clumpID] != 2))
+        {
+            ++this->numPxlChangedClumps;
+        }
+        if(state > this->clumpState[clumpID])
+        {
+            this->clumpState[clumpID] = state;
+        }
+    }
+    
+    void RSGISClumpChangeTracker::markPxl(unsigned int xPxl, unsigned int yPxl)
+    {
+        if((xPxl >= this->imgWidth) | (yPxl >= this->imgHeight))
+        {
+            throw rsgis::RSGISAttributeTableException("Pixel is outside of the clumps image.");
+        }
+        this->changedBlocks[(((size_t)(yPxl / this->yBlockSize)) * this->numXBlocks) + (xPxl / this->xBlockSize)] = true;
+    }
+    
+    void RSGISClumpChangeTracker::markClumpPxls(size_t clumpID, const std::vector<rsgis::img::PxlLoc> *pxls)
+    {
+        this->markClump(clumpID, true);
+        for(std::vector<rsgis::img::PxlLoc>::const_iterator iterPxls = pxls->begin(); iterPxls != pxls->end(); ++iterPxls)
+        {
+            this->markPxl((*iterPxls).xPos, (*iterPxls).yPos);
+        }
+    }
+    
+    void RSGISClumpChangeTracker::markAllBlocks()
+    {
+        this->changedBlocks.assign(this->changedBlocks.size(), true);
+    }
+    
+    void RSGISClumpChangeTracker::markAllClumps(size_t numClumps)
+    {
+        // Clump 0 is no data.
+        for(size_t i = 1; i < numClumps; ++i)
+        {
+            this->markClump(i, true);
+        }
+        this->markAllBlocks();
+    }
+    
+    bool RSGISClumpChangeTracker::isClumpChanged(size_t clumpID, bool pxlsChangedOnly) const
+    {
+        if(clumpID >= this->clumpState.size())
+        {
+            return false;
+        }
+        if(pxlsChangedOnly)
+        {
+            return this->clumpState[clumpID] == 2;
+        }
+        return this->clumpState[clumpID] != 0;
+    }
+    
+    std::vector<size_t> RSGISClumpChangeTracker::getChangedClumps(bool pxlsChangedOnly) const
+    {
+        std::vector<size_t> clumpIDs;
+        clumpIDs.reserve(pxlsChangedOnly?this->numPxlChangedClumps:this->numChangedClumps);
+        for(size_t i = 0; i < this->clumpState.size(); ++i)
+        {
+            if((this->clumpState[i] == 2) | ((!pxlsChangedOnly) & (this->clumpState[i] == 1)))
+            {
+                clumpIDs.push_back(i);
+            }
+        }
+        return clumpIDs;
+    }
+    
+    std::vector<std::pair<unsigned int, unsigned int> > RSGISClumpChangeTracker::getChangedBlocks() const
+    {
+        std::vector<std::pair<unsigned int, unsigned int> > blocks;
+        for(unsigned int yBlock = 0; yBlock < this->numYBlocks; ++yBlock)
+        {
+            for(unsigned int xBlock = 0; xBlock < this->numXBlocks; ++xBlock)
+            {
+                if(this->changedBlocks[(((size_t)yBlock) * this->numXBlocks) + xBlock])
+                {
+                    blocks.push_back(std::pair<unsigned int, unsigned int>(xBlock, yBlock));
+                }
+            }
+        }
+        return blocks;
+    }
+    
+    void RSGISClumpChangeTracker::getBlockWindow(unsigned int xBlock, unsigned int yBlock, int *xOff, int *yOff, int *xSize, int *ySize) const
+    {
+        *xOff = xBlock * this->xBlockSize;
+        *yOff = yBlock * this->yBlockSize;
+        *xSize = std::min(this->xBlockSize, this->imgWidth - (*xOff));
+        *ySize = std::min(this->yBlockSize, this->imgHeight - (*yOff));
+    }
+    
+    void RSGISClumpChangeTracker::clear()
+    {
+        this->clumpState.clear();
+        this->changedBlocks.assign(this->changedBlocks.size(), false);
+        this->numChangedClumps = 0;
+        this->numPxlChangedClumps = 0;
+    }
+    
+    bool RSGISClumpChangeTracker::readFromRAT(GDALDataset *clumpsImage, unsigned int ratBand, std::string changesCol)
+    {
+        try
+        {
+            this->checkImage(clumpsImage, ratBand);
+            GDALRasterBand *ratImgBand = clumpsImage->GetRasterBand(ratBand);
+            GDALRasterAttributeTable *attTable = ratImgBand->GetDefaultRAT();
+            if(attTable == NULL)
+            {
+                return false;
+            }
+            int colIdx = -1;
+            for(int i = 0; i < attTable->GetColumnCount(); ++i)
+            {
+                if(std::string(attTable->GetNameOfCol(i)) == changesCol)
+                {
+                    colIdx = i;
+                    break;
+                }
+            }
+            if(colIdx < 0)
+            {
+                return false;
+            }
+            
+            size_t numRows = attTable->GetRowCount();
+            int *dataBlock = new int[RAT_BLOCK_LENGTH];
+            for(size_t startRow = 0; startRow < numRows; startRow += RAT_BLOCK_LENGTH)
+            {
+                size_t numBlockRows = std::min((size_t)RAT_BLOCK_LENGTH, numRows - startRow);
+                attTable->ValuesIO(GF_Read, colIdx, startRow, numBlockRows, dataBlock);
+                for(size_t j = 0; j < numBlockRows; ++j)
+                {
+                    if(dataBlock[j] > 0)
+                    {
+                        this->markClump(startRow + j, (dataBlock[j] == 2));
+                    }
+                }
+            }
+            delete[] dataBlock;
+            
+            // Without a bitmap for this block grid all the blocks have to be read.
+            bool blocksRead = false;
+            std::string blockSizeStr = boost::lexical_cast<std::string>(this->xBlockSize) + "," + boost::lexical_cast<std::string>(this->yBlockSize);
+            const char *storedBlockSize = ratImgBand->GetMetadataItem((changesCol + "_BLOCKSIZE").c_str());
+            const char *storedBlocks = ratImgBand->GetMetadataItem((changesCol + "_BLOCKS").c_str());
+            if((storedBlockSize != NULL) && (storedBlocks != NULL) && (blockSizeStr == storedBlockSize))
+            {
+                std::string blockStr = std::string(storedBlocks);
+                size_t numBits = this->changedBlocks.size();
+                if(blockStr.size() == ((numBits + 3) / 4))
+                {
+                    blocksRead = true;
+                    std::vector<bool> storedChanges(numBits, false);
+                    for(size_t i = 0; (i < blockStr.size()) & blocksRead; ++i)
+                    {
+                        char c = blockStr[i];
+                        unsigned int nibble = 0;
+                        if((c >= '0') & (c <= '9'))
+                        {
+                            nibble = c - '0';
+                        }
+                        else if((c >= 'A') & (c <= 'F'))
+                        {
+                            nibble = (c - 'A') + 10;
+                        }
+                        else
+                        {
+                            blocksRead = false;
+                        }
+                        for(unsigned int b = 0; b < 4; ++b)
+                        {
+                            size_t bit = (i * 4) + b;
+                            if(((nibble >> b) & 1) && (bit < numBits))
+                            {
+                                storedChanges[bit] = true;
+                            }
+                        }
+                    }
+                    if(blocksRead)
+                    {
+                        for(size_t i = 0; i < numBits; ++i)
+                        {
+                            if(storedChanges[i])
+                            {
+                                this->changedBlocks[i] = true;
+                            }
+                        }
+                    }
+                }
+            }
+            if((!blocksRead) & this->hasPxlChanges())
+            {
+                this->markAllBlocks();
+            }
+        }
+        catch(rsgis::RSGISAttributeTableException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw rsgis::RSGISAttributeTableException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw rsgis::RSGISAttributeTableException(e.what());
+        }
+        return true;
+    }
+    
+    void RSGISClumpChangeTracker::writeToRAT(GDALDataset *clumpsImage, unsigned int ratBand, std::string changesCol) const
+    {
+        try
+        {
+            this->checkImage(clumpsImage, ratBand);
+            GDALRasterBand *ratImgBand = clumpsImage->GetRasterBand(ratBand);
+            GDALRasterAttributeTable *attTable = ratImgBand->GetDefaultRAT();
+            if(attTable == NULL)
+            {
+                throw rsgis::RSGISAttributeTableException("The clumps image does not have a RAT.");
+            }
+            
+            // Clumps beyond the end of the RAT are no longer within the image.
+            size_t numRows = attTable->GetRowCount();
+            RSGISRasterAttUtils attUtils;
+            unsigned int colIdx = attUtils.findColumnIndexOrCreate(attTable, changesCol, GFT_Integer);
+            int *dataBlock = new int[RAT_BLOCK_LENGTH];
+            for(size_t startRow = 0; startRow < numRows; startRow += RAT_BLOCK_LENGTH)
+            {
+                size_t numBlockRows = std::min((size_t)RAT_BLOCK_LENGTH, numRows - startRow);
+                for(size_t j = 0; j < numBlockRows; ++j)
+                {
+                    size_t clumpID = startRow + j;
+                    dataBlock[j] = (clumpID < this->clumpState.size())?this->clumpState[clumpID]:0;
+                }
+                attTable->ValuesIO(GF_Write, colIdx, startRow, numBlockRows, dataBlock);
+            }
+            delete[] dataBlock;
+            
+            // One bit per block (row major), four bits per hex character.
+            static const char hexChars[] = "0123456789ABCDEF";
+            std::string blockStr((this->changedBlocks.size() + 3) / 4, '0');
+            for(size_t i = 0; i < blockStr.size(); ++i)
+            {
+                unsigned int nibble = 0;
+                for(unsigned int b = 0; b < 4; ++b)
+                {
+                    size_t bit = (i * 4) + b;
+                    if((bit < this->changedBlocks.size()) && this->changedBlocks[bit])
+                    {
+                        nibble |= (1 << b);
+                    }
+                }
+                blockStr[i] = hexChars[nibble];
+            }
+            std::string blockSizeStr = boost::lexical_cast<std::string>(this->xBlockSize) + "," + boost::lexical_cast<std::string>(this->yBlockSize);
+            ratImgBand->SetMetadataItem((changesCol + "_BLOCKSIZE").c_str(), blockSizeStr.c_str());
+            ratImgBand->SetMetadataItem((changesCol + "_BLOCKS").c_str(), blockStr.c_str());
+        }
+        catch(rsgis::RSGISAttributeTableException &e)
+        {
+            throw e;
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            throw rsgis::RSGISAttributeTableException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw rsgis::RSGISAttributeTableException(e.what());
+        }
+    }
+    
+    void RSGISClumpChangeTracker::checkImage(GDALDataset *clumpsImage, unsigned int ratBand) const
+    {
+        if((ratBand == 0) | (ratBand > clumpsImage->GetRasterCount()))
+        {
+            throw rsgis::RSGISAttributeTableException("RAT band is not within the clumps image.");
+        }
+        if((clumpsImage->GetRasterXSize() != this->imgWidth) | (clumpsImage->GetRasterYSize() != this->imgHeight))
+        {
+            throw rsgis::RSGISAttributeTableException("The clump change tracker was not created for the clumps image.");
+        }
+    }
+    
+}}
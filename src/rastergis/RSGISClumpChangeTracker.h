@@ -0,0 +1,110 @@
+/*
+ *  RSGISClumpChangeTracker.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RSGISClumpChangeTracker_H
+#define RSGISClumpChangeTracker_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "gdal_priv.h"
+#include "gdal_rat.h"
+
+#include "common/RSGISAttributeTableException.h"
+
+#include "img/RSGISImageUtils.h"
+
+#include "rastergis/RSGISRasterAttUtils.h"
+
+#include <boost/lexical_cast.hpp>
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_rastergis_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace rastergis{
+    
+    /**
+     * Records which clumps (RAT rows) have been edited and which image blocks
+     * of the clumps image hold their pixels, so the RAT statistics can be
+     * updated for just those rows (see RSGISPopRATWithStats). A clump is marked
+     * either as having had its pixels changed (its statistics are stale) or only
+     * its attributes (e.g., a class column). When pixels change, the blocks
+     * marked must cover all the pixels of that clump, not just those edited; if
+     * that is not known then markAllBlocks() should be called.
+     *
+     * So the changes can be carried between commands they can be stored in the
+     * RAT as an integer column (the state of each clump) with the changed blocks
+     * held as a hexadecimal bitmap in the <col>_BLOCKS metadata item of the band.
+     * The bitmap is only used if the block size (<col>_BLOCKSIZE) matches.
+     */
+    class DllExport RSGISClumpChangeTracker
+    {
+    public:
+        RSGISClumpChangeTracker(GDALDataset *clumpsImage, unsigned int ratBand=1);
+        void markClump(size_t clumpID, bool pxlsChanged=true);
+        void markPxl(unsigned int xPxl, unsigned int yPxl);
+        void markClumpPxls(size_t clumpID, const std::vector<rsgis::img::PxlLoc> *pxls);
+        void markAllBlocks();
+        void markAllClumps(size_t numClumps);
+        bool isClumpChanged(size_t clumpID, bool pxlsChangedOnly=true) const;
+        bool hasChanges() const {return this->numChangedClumps > 0;};
+        bool hasPxlChanges() const {return this->numPxlChangedClumps > 0;};
+        std::vector<size_t> getChangedClumps(bool pxlsChangedOnly=true) const;
+        std::vector<std::pair<unsigned int, unsigned int> > getChangedBlocks() const;
+        void getBlockWindow(unsigned int xBlock, unsigned int yBlock, int *xOff, int *yOff, int *xSize, int *ySize) const;
+        unsigned int getImageWidth() const {return this->imgWidth;};
+        unsigned int getImageHeight() const {return this->imgHeight;};
+        void clear();
+        bool readFromRAT(GDALDataset *clumpsImage, unsigned int ratBand, std::string changesCol);
+        void writeToRAT(GDALDataset *clumpsImage, unsigned int ratBand, std::string changesCol) const;
+        ~RSGISClumpChangeTracker(){};
+    protected:
+        void checkImage(GDALDataset *clumpsImage, unsigned int ratBand) const;
+        unsigned int imgWidth;
+        unsigned int imgHeight;
+        unsigned int xBlockSize;
+        unsigned int yBlockSize;
+        unsigned int numXBlocks;
+        unsigned int numYBlocks;
+        // 0 = unchanged, 1 = attributes changed, 2 = pixels changed.
+        std::vector<unsigned char> clumpState;
+        size_t numChangedClumps;
+        size_t numPxlChangedClumps;
+        std::vector<bool> changedBlocks;
+    };
+    
+}}
+
+#endif
@@ -29,7 +29,7 @@ namespace rsgis{namespace rastergis{
         
     }
     
-    void RSGISClumpRegionGrowing::growClassRegion(GDALDataset *inputClumps, std::string classColumn, std::string classVal, int maxIter, unsigned int ratBand, std::string xmlBlock)
+    void RSGISClumpRegionGrowing::growClassRegion(GDALDataset *inputClumps, std::string classColumn, std::string classVal, int maxIter, unsigned int ratBand, std::string xmlBlock, RSGISClumpChangeTracker *changes)
     {
         try
         {
@@ -113,11 +113,6 @@ namespace rsgis{namespace rastergis{
             
             size_t colLen = 0;
             std::string *classColVals = attUtils.readStrColumnStdStr(rat, classColumn, &colLen);
-            std::string *classColValsTmp = new std::string[colLen];
-            for(size_t i = 0; i < numRows; ++i)
-            {
-                classColValsTmp[i] = "";
-            }
             
             if(colLen != numRows)
             {
@@ -130,23 +125,37 @@ namespace rsgis{namespace rastergis{
                 throw rsgis::RSGISAttributeTableException("The column does not have enough values ");
             }
             
+            // The criteria only depend on the neighbour being tested so a neighbour which
+            // failed will always fail; only the neighbours of clumps added in the previous
+            // iteration need to be tested.
+            std::vector<size_t> frontier;
+            for(size_t i = 0; i < numRows; ++i)
+            {
+                if(classColVals[i] == classVal)
+                {
+                    frontier.push_back(i);
+                }
+            }
+            std::vector<size_t> nextFrontier;
+            std::vector<bool> added(numRows, false);
+            
             bool changeFound = true;
-            unsigned int numChangeFeats = 0;
             bool maxIterDef = false;
             if(maxIter >= 0)
             {
                 maxIterDef = true;
             }
             int numIter = 0;
-            int feedback = numRows/10.0;
+            int feedback = 0;
             int feedbackCounter = 0;
             while(changeFound)
             {
                 changeFound = false;
                 std::cout << "Started " << std::flush;
+                feedback = frontier.size()/10.0;
                 feedbackCounter = 0;
-                numChangeFeats = 0;
-                for(size_t i = 0; i < numRows; ++i)
+                nextFrontier.clear();
+                for(size_t i = 0; i < frontier.size(); ++i)
                 {
                     if((feedback != 0) && ((i % feedback) == 0))
                     {
@@ -154,52 +163,49 @@ namespace rsgis{namespace rastergis{
                         feedbackCounter = feedbackCounter + 10;
                     }
                     
-                    if(classColVals[i] == classVal)
+                    // Check the neighbours...
+                    std::vector<size_t> *clumpNeigh = neighbours->at(frontier[i]);
+                    for(std::vector<size_t>::iterator iterNeigh = clumpNeigh->begin(); iterNeigh != clumpNeigh->end(); ++iterNeigh)
                     {
-                        // Check the neighbours...
-                        std::vector<size_t> *clumpNeigh = neighbours->at(i);
-                        for(std::vector<size_t>::iterator iterNeigh = clumpNeigh->begin(); iterNeigh != clumpNeigh->end(); ++iterNeigh)
+                        if((classColVals[*iterNeigh] != classVal) && (!added[*iterNeigh]))
                         {
-                            if(classColVals[*iterNeigh] != classVal)
+                            // Check if condition is met, if met then 'grow' and set change flag...
+                            for(std::vector<rsgis::rastergis::RSGISColumnLogicIdxs*>::iterator iterColIdx = colIdxes->begin(); iterColIdx != colIdxes->end(); ++iterColIdx)
                             {
-                                // Check if condition is met, if met then 'grow' and set change flag...
-                                for(std::vector<rsgis::rastergis::RSGISColumnLogicIdxs*>::iterator iterColIdx = colIdxes->begin(); iterColIdx != colIdxes->end(); ++iterColIdx)
+                                if((*iterColIdx)->useThreshold)
                                 {
-                                    if((*iterColIdx)->useThreshold)
-                                    {
-                                        (*iterColIdx)->col1Val = ratCols->at((*iterColIdx)->col1Idx)[*iterNeigh];
-                                    }
-                                    else
-                                    {
-                                        (*iterColIdx)->col1Val = ratCols->at((*iterColIdx)->col1Idx)[*iterNeigh];
-                                        (*iterColIdx)->col2Val = ratCols->at((*iterColIdx)->col2Idx)[*iterNeigh];
-                                    }
+                                    (*iterColIdx)->col1Val = ratCols->at((*iterColIdx)->col1Idx)[*iterNeigh];
                                 }
-                                
-                                if(exp->evaluate())
+                                else
                                 {
-                                    classColValsTmp[*iterNeigh] = classVal;
-                                    changeFound = true;
-                                    ++numChangeFeats;
+                                    (*iterColIdx)->col1Val = ratCols->at((*iterColIdx)->col1Idx)[*iterNeigh];
+                                    (*iterColIdx)->col2Val = ratCols->at((*iterColIdx)->col2Idx)[*iterNeigh];
                                 }
                             }
+                            
+                            if(exp->evaluate())
+                            {
+                                added[*iterNeigh] = true;
+                                nextFrontier.push_back(*iterNeigh);
+                                changeFound = true;
+                            }
                         }
                     }
                 }
                 std::cout << ".Completed\n";
-                std::cout << "Iteration " << numIter << " changed " << numChangeFeats << " features\n";
-
-                numChangeFeats = 0;
-                //unsigned int changeCountTmp = 0;
+                std::cout << "Iteration " << numIter << " changed " << nextFrontier.size() << " features\n";
+                
                 // Copy class names to 'main' array...
-                for(size_t i = 0; i < numRows; ++i)
+                for(std::vector<size_t>::iterator iterClumps = nextFrontier.begin(); iterClumps != nextFrontier.end(); ++iterClumps)
                 {
-                    if(classColValsTmp[i] == classVal)
+                    classColVals[*iterClumps] = classVal;
+                    added[*iterClumps] = false;
+                    if(changes != NULL)
                     {
-                        classColVals[i] = classColValsTmp[i];
+                        changes->markClump(*iterClumps, false);
                     }
-                    classColValsTmp[i] = "";
                 }
+                frontier.swap(nextFrontier);
                 
                 if(maxIterDef && (numIter > maxIter))
                 {
@@ -214,7 +220,6 @@ namespace rsgis{namespace rastergis{
             std::cout << "Tidying up...\n";
             
             delete[] classColVals;
-            delete[] classColValsTmp;
             for(std::vector<std::vector<size_t>* >::iterator iterNeigh = neighbours->begin(); iterNeigh != neighbours->end(); ++iterNeigh)
             {
                 delete *iterNeigh;
@@ -38,6 +38,7 @@
 
 #include "rastergis/RSGISRasterAttUtils.h"
 #include "rastergis/RSGISBinaryClassifyClumps.h"
+#include "rastergis/RSGISClumpChangeTracker.h"
 
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
@@ -58,7 +59,7 @@ namespace rsgis{namespace rastergis{
     {
     public:
         RSGISClumpRegionGrowing();
-        void growClassRegion(GDALDataset *inputClumps, std::string classColumn, std::string classVal, int maxIter, unsigned int ratBand, std::string xmlBlock);
+        void growClassRegion(GDALDataset *inputClumps, std::string classColumn, std::string classVal, int maxIter, unsigned int ratBand, std::string xmlBlock, RSGISClumpChangeTracker *changes=NULL);
         void growClassRegionNeighCriteria(GDALDataset *inputClumps, std::string classColumn, std::string classVal, int maxIter, unsigned int ratBand, std::string xmlBlockCriteria, std::string xmlBlockNeighCriteria);
         ~RSGISClumpRegionGrowing();
     };
@@ -41,17 +41,40 @@ namespace rsgis{namespace rastergis{
                 throw RSGISAttributeTableException("GDAL Dataset does not have a RAT.");
             }
             
-            size_t numRows = attTable->GetRowCount();
-            
-            
-            std::vector<int> *minXPxlVals = attUtils.readIntColumnAsVec(attTable, minXPxl);
-            std::vector<int> *maxXPxlVals = attUtils.readIntColumnAsVec(attTable, maxXPxl);
-            std::vector<int> *minYPxlVals = attUtils.readIntColumnAsVec(attTable, minYPxl);
-            std::vector<int> *maxYPxlVals = attUtils.readIntColumnAsVec(attTable, maxYPxl);
+            RSGISClumpBBoxIndex bboxIdx;
+            bboxIdx.readIndex(clumpsDataset, ratBand, minXPxl, maxXPxl, minYPxl, maxYPxl);
             
             std::vector<double> *tlXVals = attUtils.readDoubleColumnAsVec(attTable, tlX);
             std::vector<double> *tlYVals = attUtils.readDoubleColumnAsVec(attTable, tlY);
             
+            this->exportClumps(clumpsDataset, outImgBase, imgFileExt, imageFormat, binaryOut, &bboxIdx, tlXVals, tlYVals, ratBand);
+            
+            delete tlXVals;
+            delete tlYVals;
+        }
+        catch(RSGISAttributeTableException &e)
+        {
+            throw rsgis::RSGISImageException(e.what());
+        }
+        catch(rsgis::RSGISImageException &e)
+        {
+            throw e;
+        }
+        catch(std::exception &e)
+        {
+            throw rsgis::RSGISImageException(e.what());
+        }
+    }
+    
+    void RSGISExportClumps2Images::exportClumps2Images(GDALDataset *clumpsDataset, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, RSGISClumpBBoxIndex *bboxIdx, unsigned int ratBand)
+    {
+        this->exportClumps(clumpsDataset, outImgBase, imgFileExt, imageFormat, binaryOut, bboxIdx, NULL, NULL, ratBand);
+    }
+    
+    void RSGISExportClumps2Images::exportClumps(GDALDataset *clumpsDataset, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, RSGISClumpBBoxIndex *bboxIdx, std::vector<double> *tlXVals, std::vector<double> *tlYVals, unsigned int ratBand)
+    {
+        try
+        {
             double geoTransform[6];
             if(clumpsDataset->GetGeoTransform(geoTransform) != CE_None)
             {
@@ -60,6 +83,8 @@ namespace rsgis{namespace rastergis{
 
             std::cout << "Res: [" << geoTransform[1] << ", " << geoTransform[5] << "]\n";
             
+            unsigned int xOff = 0;
+            unsigned int yOff = 0;
             unsigned int xSize = 0;
             unsigned int ySize = 0;
             double *outTransform = new double[6];
@@ -71,44 +96,56 @@ namespace rsgis{namespace rastergis{
             outTransform[5] = geoTransform[5];
             
             GDALDataset *outClumpImg = NULL;
-            GDALDataset **datasets = new GDALDataset*[2];
-            datasets[0] = clumpsDataset;
             RSGISPopulateWithImageStats addClrTab;
-            RSGISCopyImageBand4ClumpExport valueCalc = RSGISCopyImageBand4ClumpExport(ratBand, 0, binaryOut);
-            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(&valueCalc);
             rsgis::img::RSGISImageUtils imgUtils;
             rsgis::utils::RSGISTextUtils textUtils;
-            for(size_t i = 1; i < numRows; ++i)
+            std::vector<unsigned int> data;
+            size_t numClumps = bboxIdx->getNumClumps();
+            for(size_t i = 1; i < numClumps; ++i)
             {
-                if( (maxXPxlVals->at(i) > 0) | (maxYPxlVals->at(i) > 0) )
+                // Only the blocks of the clumps image holding the clump are read.
+                if(bboxIdx->readClumpWindow(clumpsDataset, ratBand, i, &data, &xOff, &yOff, &xSize, &ySize))
                 {
                     std::string outImgFileName = outImgBase + "C" + textUtils.sizettostring(i) + "." + imgFileExt;
                     std::cout << "Output Img: " << outImgFileName << std::endl;
                     
-                    xSize = (maxXPxlVals->at(i) - minXPxlVals->at(i)) + 1;
-                    ySize = (maxYPxlVals->at(i) - minYPxlVals->at(i)) + 1;
+                    if(tlXVals != NULL)
+                    {
+                        outTransform[0] = tlXVals->at(i);
+                        outTransform[3] = tlYVals->at(i);
+                    }
+                    else
+                    {
+                        outTransform[0] = geoTransform[0] + (xOff * geoTransform[1]) + (yOff * geoTransform[2]);
+                        outTransform[3] = geoTransform[3] + (xOff * geoTransform[4]) + (yOff * geoTransform[5]);
+                    }
                     
                     std::cout << "Size: [" << xSize << ", " << ySize << "]\n";
-                    std::cout << "TL: [" << tlXVals->at(i) << ", " << tlYVals->at(i) << "]\n";
+                    std::cout << "TL: [" << outTransform[0] << ", " << outTransform[3] << "]\n";
                     
-                    outTransform[0] = tlXVals->at(i);
-                    outTransform[3] = tlYVals->at(i);
+                    for(std::vector<unsigned int>::iterator iterData = data.begin(); iterData != data.end(); ++iterData)
+                    {
+                        if((*iterData) == i)
+                        {
+                            *iterData = binaryOut?1:i;
+                        }
+                        else
+                        {
+                            *iterData = 0;
+                        }
+                    }
                     
                     outClumpImg = imgUtils.createBlankImage(outImgFileName, outTransform, xSize, ySize, 1, "", 0.0, imageFormat, GDT_UInt32);
                     outClumpImg->SetProjection(clumpsDataset->GetProjectionRef());
-                    GDALClose(outClumpImg);
-                    
-                    valueCalc.setFid(i);
-                    outClumpImg = (GDALDataset *) GDALOpen(outImgFileName.c_str(), GA_Update);
-                    datasets[1] = outClumpImg;
-                    calcImage.calcImage(datasets, 2, 0, outClumpImg);
+                    if(outClumpImg->GetRasterBand(1)->RasterIO(GF_Write, 0, 0, xSize, ySize, data.data(), xSize, ySize, GDT_UInt32, 0, 0) != CE_None)
+                    {
+                        throw rsgis::RSGISImageException("Could not write the clump image.");
+                    }
                     addClrTab.populateImageWithRasterGISStats(outClumpImg, true, true, 1);
                     GDALClose(outClumpImg);
-                    
                 }
             }
-            delete[] datasets;
-            
+            delete[] outTransform;
         }
         catch(RSGISAttributeTableException &e)
         {
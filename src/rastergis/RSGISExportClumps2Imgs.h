@@ -41,6 +41,7 @@
 
 #include "rastergis/RSGISRasterAttUtils.h"
 #include "rastergis/RSGISCalcImageStatsAndPyramids.h"
+#include "rastergis/RSGISClumpBBoxIndex.h"
 
 #include "utils/RSGISTextUtils.h"
 
@@ -67,7 +68,10 @@ namespace rsgis{namespace rastergis{
     public:
         RSGISExportClumps2Images();
         void exportClumps2Images(GDALDataset *clumpsDataset, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, std::string minXPxl, std::string maxXPxl, std::string minYPxl, std::string maxYPxl, std::string tlX, std::string tlY, unsigned int ratBand=1);
+        void exportClumps2Images(GDALDataset *clumpsDataset, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, RSGISClumpBBoxIndex *bboxIdx, unsigned int ratBand=1);
         ~RSGISExportClumps2Images();
+    protected:
+        void exportClumps(GDALDataset *clumpsDataset, std::string outImgBase, std::string imgFileExt, std::string imageFormat, bool binaryOut, RSGISClumpBBoxIndex *bboxIdx, std::vector<double> *tlXVals, std::vector<double> *tlYVals, unsigned int ratBand);
     };
     
     
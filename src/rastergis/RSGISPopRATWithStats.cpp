@@ -51,21 +51,18 @@ namespace rsgis{namespace rastergis{
             long maxClumpID = 0;
             attUtils.getImageBandMinMax(inputClumps, ratBand, &minClumpID, &maxClumpID);
             
-            if(maxClumpID > numRows)
+            if(maxClumpID >= numRows)
             {
-                numRows = boost::lexical_cast<size_t>(maxClumpID);
+                numRows = boost::lexical_cast<size_t>(maxClumpID)+1;
                 rat->SetRowCount(numRows);
             }
             
-            // Check whether a standard deviation is to be created (requires second iteration of image).
             bool calcMins = false;
             bool calcMaxs = false;
             bool calcMeans = false;
             bool calcStdDevs = false;
             bool calcSums = false;
             
-            size_t numFeats2Calc = 0;
-            size_t numStdDevs2Calc = 0;
             for(std::vector<rsgis::rastergis::RSGISBandAttStats*>::iterator iterBands = bandStats->begin(); iterBands != bandStats->end(); ++iterBands)
             {
                 if(((*iterBands)->calcStdDev) & (!(*iterBands)->calcMean))
@@ -78,330 +75,477 @@ namespace rsgis{namespace rastergis{
                 {
                     (*iterBands)->minFieldIdx = attUtils.findColumnIndexOrCreate(rat, (*iterBands)->minField, GFT_Real);
                     calcMins = true;
-                    (*iterBands)->minLocalIdx = numFeats2Calc++;
                 }
                 if((*iterBands)->calcMax)
                 {
                     (*iterBands)->maxFieldIdx = attUtils.findColumnIndexOrCreate(rat, (*iterBands)->maxField, GFT_Real);
                     calcMaxs = true;
-                    (*iterBands)->maxLocalIdx = numFeats2Calc++;
                 }
                 if((*iterBands)->calcMean)
                 {
                     (*iterBands)->meanFieldIdx = attUtils.findColumnIndexOrCreate(rat, (*iterBands)->meanField, GFT_Real);
                     calcMeans = true;
-                    (*iterBands)->meanLocalIdx = numFeats2Calc++;
                 }
                 if((*iterBands)->calcStdDev)
                 {
                     (*iterBands)->stdDevFieldIdx = attUtils.findColumnIndexOrCreate(rat, (*iterBands)->stdDevField, GFT_Real);
                     calcStdDevs = true;
-                    (*iterBands)->stdDevLocalIdx = numStdDevs2Calc++;
                 }
                 if((*iterBands)->calcSum)
                 {
                     (*iterBands)->sumFieldIdx = attUtils.findColumnIndexOrCreate(rat, (*iterBands)->sumField, GFT_Real);
                     calcSums = true;
-                    (*iterBands)->sumLocalIdx = numFeats2Calc++;
                 }
             }
             
             unsigned int histoIdx = attUtils.findColumnIndex(rat, "Histogram");
             
-            bool *firstVal = new bool[numRows];
-            for(int i = 0; i < numRows; ++i)
+            unsigned int numVars = bandStats->size();
+            for(std::vector<rsgis::rastergis::RSGISBandAttStats*>::iterator iterBands = bandStats->begin(); iterBands != bandStats->end(); ++iterBands)
             {
-                firstVal[i] = true;
+                if(((*iterBands)->band == 0) | ((*iterBands)->band > inputValsImage->GetRasterCount()))
+                {
+                    throw rsgis::RSGISAttributeTableException("A band specified for the statistics is not within the input image.");
+                }
             }
             
             GDALDataset **datasets = new GDALDataset*[2];
             datasets[0] = inputClumps;
             datasets[1] = inputValsImage;
+            int **dsOffsets = new int*[2];
+            dsOffsets[0] = new int[2];
+            dsOffsets[1] = new int[2];
+            double *gdalTransform = new double[6];
+            int width = 0;
+            int height = 0;
+            rsgis::img::RSGISImageUtils imgUtils;
+            imgUtils.getImageOverlap(datasets, 2, dsOffsets, &width, &height, gdalTransform);
+            int clumpsXOff = dsOffsets[0][0];
+            int clumpsYOff = dsOffsets[0][1];
+            int valsXOff = dsOffsets[1][0];
+            int valsYOff = dsOffsets[1][1];
+            delete[] dsOffsets[0];
+            delete[] dsOffsets[1];
+            delete[] dsOffsets;
+            delete[] gdalTransform;
+            delete[] datasets;
             
-            double **statsData = new double*[numRows];
-            for(unsigned int i = 0; i < numRows; ++i)
+            int xBlockSize = 0;
+            int yBlockSize = 0;
+            inputClumps->GetRasterBand(ratBand)->GetBlockSize(&xBlockSize, &yBlockSize);
+            if(yBlockSize < 1)
             {
-                statsData[i] = new double[numFeats2Calc];
-                for(unsigned int j = 0; j < numFeats2Calc; ++j)
+                yBlockSize = 1;
+            }
+            int stripRows = yBlockSize;
+            while(((((size_t)stripRows) * ((size_t)width)) < 65536) & (stripRows < height))
+            {
+                stripRows += yBlockSize;
+            }
+            size_t numStrips = (height + stripRows - 1) / stripRows;
+            
+            // Every thread has its own accumulator so limit the threads to keep within ~2 GB.
+            bool calcMinMax = calcMins | calcMaxs;
+            size_t accumBytes = numRows * rsgis::math::RSGISGroupedStatsAccumulator::getBytesPerGroup(numVars, calcMinMax, calcStdDevs);
+            size_t maxAccumBytes = ((size_t)2) * 1024 * 1024 * 1024;
+            rsgis::img::RSGISImageThreadUtils threadUtils;
+            unsigned int nThreads = threadUtils.getNumThreads(0);
+            if((accumBytes > 0) && ((nThreads * accumBytes) > maxAccumBytes))
+            {
+                nThreads = std::max<size_t>(1, maxAccumBytes / accumBytes);
+            }
+            
+            // KEA files cannot be opened per thread so their reads are serialised.
+            bool sharedClumps = false;
+            bool sharedVals = false;
+            std::vector<GDALDataset*> clumpHandles = threadUtils.openDatasetHandles(inputClumps, nThreads, &sharedClumps);
+            std::vector<GDALDataset*> valsHandles = threadUtils.openDatasetHandles(inputValsImage, nThreads, &sharedVals);
+            
+            std::vector<rsgis::math::RSGISGroupedStatsAccumulator> accums(nThreads, rsgis::math::RSGISGroupedStatsAccumulator(numRows, numVars, calcMinMax, calcStdDevs));
+            try
+            {
+                threadUtils.runTasks(nThreads, numStrips, [&](unsigned int threadIdx, size_t strip)
                 {
-                    statsData[i][j] = 0.0;
-                }
+                    int yOff = strip * stripRows;
+                    int nRows = std::min(stripRows, height - yOff);
+                    size_t nPxls = ((size_t)width) * ((size_t)nRows);
+                    std::vector<unsigned int> clumpIDs(nPxls);
+                    std::vector<float> vals(nPxls * numVars);
+                    
+                    std::unique_lock<std::mutex> readLock = threadUtils.lockSharedRead(sharedClumps | sharedVals);
+                    if(clumpHandles[threadIdx]->GetRasterBand(ratBand)->RasterIO(GF_Read, clumpsXOff, clumpsYOff+yOff, width, nRows, clumpIDs.data(), width, nRows, GDT_UInt32, 0, 0) != CE_None)
+                    {
+                        throw rsgis::RSGISAttributeTableException("Failed to read the clumps image.");
+                    }
+                    for(unsigned int i = 0; i < numVars; ++i)
+                    {
+                        if(valsHandles[threadIdx]->GetRasterBand(bandStats->at(i)->band)->RasterIO(GF_Read, valsXOff, valsYOff+yOff, width, nRows, &vals[i*nPxls], width, nRows, GDT_Float32, 0, 0) != CE_None)
+                        {
+                            throw rsgis::RSGISAttributeTableException("Failed to read the input values image.");
+                        }
+                    }
+                    if(readLock.owns_lock())
+                    {
+                        readLock.unlock();
+                    }
+                    accums[threadIdx].addBlock(clumpIDs.data(), vals.data(), nPxls, true);
+                });
+            }
+            catch(...)
+            {
+                threadUtils.closeDatasetHandles(&clumpHandles);
+                threadUtils.closeDatasetHandles(&valsHandles);
+                throw;
             }
+            threadUtils.closeDatasetHandles(&clumpHandles);
+            threadUtils.closeDatasetHandles(&valsHandles);
             
-            RSGISCalcClusterPxlValueStats *calcImgValStats = new RSGISCalcClusterPxlValueStats(statsData, bandStats, firstVal, ratBand);
-            rsgis::img::RSGISCalcImage calcImageStats(calcImgValStats);
-            calcImageStats.calcImage(datasets, 1, 1);
-            delete calcImgValStats;
+            rsgis::math::RSGISGroupedStatsAccumulator &stats = accums[0];
+            for(unsigned int t = 1; t < nThreads; ++t)
+            {
+                stats.merge(accums[t]);
+                accums[t] = rsgis::math::RSGISGroupedStatsAccumulator(0, 0, false, false);
+            }
             
             std::cout << "Writing Stats (";
             if(calcMins){std::cout << "Min, ";}
             if(calcMaxs){std::cout << "Max, ";}
             if(calcMeans){std::cout << "Mean, ";}
+            if(calcStdDevs){std::cout << "StdDev, ";}
             if(calcSums){std::cout << "Sum";}
             std::cout << ") to Output RAT\n";
             
-            size_t numBlocks = floor((double)numRows/(double)RAT_BLOCK_LENGTH);
-            size_t rowsRemain = numRows - (numBlocks * RAT_BLOCK_LENGTH);
-            
             double *dataBlock = new double[RAT_BLOCK_LENGTH];
             double *histDataBlock = new double[RAT_BLOCK_LENGTH];
-            size_t startRow = 0;
-            size_t rowID = 0;
-            for(size_t i = 0; i < numBlocks; ++i)
+            for(size_t startRow = 0; startRow < numRows; startRow += RAT_BLOCK_LENGTH)
             {
-                rat->ValuesIO(GF_Read, histoIdx, startRow, RAT_BLOCK_LENGTH, histDataBlock);
-                for(std::vector<rsgis::rastergis::RSGISBandAttStats*>::iterator iterBands = bandStats->begin(); iterBands != bandStats->end(); ++iterBands)
+                size_t blockRows = std::min<size_t>(RAT_BLOCK_LENGTH, numRows - startRow);
+                rat->ValuesIO(GF_Read, histoIdx, startRow, blockRows, histDataBlock);
+                for(unsigned int i = 0; i < numVars; ++i)
                 {
-                    if((*iterBands)->calcMin)
+                    RSGISBandAttStats *bandStat = bandStats->at(i);
+                    if(bandStat->calcMin)
                     {
-                        rowID = startRow;
-                        for(size_t j = 0; j < RAT_BLOCK_LENGTH; ++j)
+                        for(size_t j = 0; j < blockRows; ++j)
                         {
-                            if(histDataBlock[j] > 0)
-                            {
-                                dataBlock[j] = statsData[rowID][(*iterBands)->minLocalIdx];
-                            }
-                            else
-                            {
-                                dataBlock[j] = 0.0;
-                            }
-                            ++rowID;
+                            dataBlock[j] = (histDataBlock[j] > 0) ? stats.getMin(startRow+j, i) : 0.0;
                         }
-                        rat->ValuesIO(GF_Write, (*iterBands)->minFieldIdx, startRow, RAT_BLOCK_LENGTH, dataBlock);
+                        rat->ValuesIO(GF_Write, bandStat->minFieldIdx, startRow, blockRows, dataBlock);
                     }
-                    
-                    if((*iterBands)->calcMax)
+                    if(bandStat->calcMax)
                     {
-                        rowID = startRow;
-                        for(size_t j = 0; j < RAT_BLOCK_LENGTH; ++j)
+                        for(size_t j = 0; j < blockRows; ++j)
                         {
-                            if(histDataBlock[j] > 0)
-                            {
-                                dataBlock[j] = statsData[rowID][(*iterBands)->maxLocalIdx];
-                            }
-                            else
-                            {
-                                dataBlock[j] = 0.0;
-                            }
-                            ++rowID;
+                            dataBlock[j] = (histDataBlock[j] > 0) ? stats.getMax(startRow+j, i) : 0.0;
                         }
-                        rat->ValuesIO(GF_Write, (*iterBands)->maxFieldIdx, startRow, RAT_BLOCK_LENGTH, dataBlock);
+                        rat->ValuesIO(GF_Write, bandStat->maxFieldIdx, startRow, blockRows, dataBlock);
                     }
-                    
-                    if((*iterBands)->calcMean)
+                    if(bandStat->calcMean)
                     {
-                        rowID = startRow;
-                        for(size_t j = 0; j < RAT_BLOCK_LENGTH; ++j)
+                        for(size_t j = 0; j < blockRows; ++j)
                         {
-                            if(histDataBlock[j] > 0)
-                            {
-                                statsData[rowID][(*iterBands)->meanLocalIdx] = statsData[rowID][(*iterBands)->meanLocalIdx] / histDataBlock[j];
-                                dataBlock[j] = statsData[rowID][(*iterBands)->meanLocalIdx];
-                            }
-                            else
-                            {
-                                dataBlock[j] = 0.0;
-                            }
-                            ++rowID;
+                            dataBlock[j] = (histDataBlock[j] > 0) ? stats.getMean(startRow+j, i) : 0.0;
                         }
-                        rat->ValuesIO(GF_Write, (*iterBands)->meanFieldIdx, startRow, RAT_BLOCK_LENGTH, dataBlock);
+                        rat->ValuesIO(GF_Write, bandStat->meanFieldIdx, startRow, blockRows, dataBlock);
                     }
-                    
-                    if((*iterBands)->calcSum)
+                    if(bandStat->calcStdDev)
                     {
-                        rowID = startRow;
-                        for(size_t j = 0; j < RAT_BLOCK_LENGTH; ++j)
+                        for(size_t j = 0; j < blockRows; ++j)
                         {
-                            if(histDataBlock[j] > 0)
-                            {
-                                dataBlock[j] = statsData[rowID][(*iterBands)->sumLocalIdx];
-                            }
-                            else
-                            {
-                                dataBlock[j] = 0.0;
-                            }
-                            ++rowID;
+                            dataBlock[j] = (histDataBlock[j] > 0) ? stats.getStdDev(startRow+j, i) : 0.0;
                         }
-                        rat->ValuesIO(GF_Write, (*iterBands)->sumFieldIdx, startRow, RAT_BLOCK_LENGTH, dataBlock);
+                        rat->ValuesIO(GF_Write, bandStat->stdDevFieldIdx, startRow, blockRows, dataBlock);
+                    }
+                    if(bandStat->calcSum)
+                    {
+                        for(size_t j = 0; j < blockRows; ++j)
+                        {
+                            dataBlock[j] = (histDataBlock[j] > 0) ? stats.getSum(startRow+j, i) : 0.0;
+                        }
+                        rat->ValuesIO(GF_Write, bandStat->sumFieldIdx, startRow, blockRows, dataBlock);
                     }
                 }
-                startRow += RAT_BLOCK_LENGTH;
             }
-            if(rowsRemain > 0)
+            
+            delete[] dataBlock;
+            delete[] histDataBlock;
+        }
+        catch(RSGISAttributeTableException &e)
+        {
+            throw e;
+        }
+        catch(RSGISException &e)
+        {
+            throw RSGISAttributeTableException(e.what());
+        }
+        catch(std::exception &e)
+        {
+            throw RSGISAttributeTableException(e.what());
+        }
+    }
+    
+    void RSGISPopRATWithStats::populateRATWithBasicStats(GDALDataset *inputClumps, GDALDataset *inputValsImage, std::vector<RSGISBandAttStats*> *bandStats, unsigned int ratBand, RSGISClumpChangeTracker *changes)
+    {
+        if(changes == NULL)
+        {
+            this->populateRATWithBasicStats(inputClumps, inputValsImage, bandStats, ratBand);
+            return;
+        }
+        
+        try
+        {
+            if(ratBand == 0)
             {
-                rat->ValuesIO(GF_Read, histoIdx, startRow, rowsRemain, histDataBlock);
-                for(std::vector<rsgis::rastergis::RSGISBandAttStats*>::iterator iterBands = bandStats->begin(); iterBands != bandStats->end(); ++iterBands)
+                throw rsgis::RSGISAttributeTableException("RAT Band must be greater than zero.");
+            }
+            if(ratBand > inputClumps->GetRasterCount())
+            {
+                throw rsgis::RSGISAttributeTableException("RAT Band is larger than the number of bands within the image.");
+            }
+            if((changes->getImageWidth() != inputClumps->GetRasterXSize()) | (changes->getImageHeight() != inputClumps->GetRasterYSize()))
+            {
+                throw rsgis::RSGISAttributeTableException("The clump change tracker was not created for the clumps image.");
+            }
+            RSGISRasterAttUtils attUtils;
+            GDALRasterAttributeTable *rat = inputClumps->GetRasterBand(ratBand)->GetDefaultRAT();
+            
+            // Any column which does not exist yet has to be populated for every clump.
+            std::vector<std::string> colNames;
+            for(int i = 0; i < rat->GetColumnCount(); ++i)
+            {
+                colNames.push_back(std::string(rat->GetNameOfCol(i)));
+            }
+            bool newCols = false;
+            bool calcMinMax = false;
+            bool calcStdDevs = false;
+            for(std::vector<rsgis::rastergis::RSGISBandAttStats*>::iterator iterBands = bandStats->begin(); iterBands != bandStats->end(); ++iterBands)
+            {
+                if(((*iterBands)->calcStdDev) & (!(*iterBands)->calcMean))
                 {
-                    if((*iterBands)->calcMin)
+                    throw rsgis::RSGISAttributeTableException("If the standard deviation is required to be calculated then the mean must also be calculated.");
+                }
+                if(((*iterBands)->band == 0) | ((*iterBands)->band > inputValsImage->GetRasterCount()))
+                {
+                    throw rsgis::RSGISAttributeTableException("A band specified for the statistics is not within the input image.");
+                }
+                newCols = newCols | ((*iterBands)->calcMin && (std::find(colNames.begin(), colNames.end(), (*iterBands)->minField) == colNames.end()));
+                newCols = newCols | ((*iterBands)->calcMax && (std::find(colNames.begin(), colNames.end(), (*iterBands)->maxField) == colNames.end()));
+                newCols = newCols | ((*iterBands)->calcMean && (std::find(colNames.begin(), colNames.end(), (*iterBands)->meanField) == colNames.end()));
+                newCols = newCols | ((*iterBands)->calcStdDev && (std::find(colNames.begin(), colNames.end(), (*iterBands)->stdDevField) == colNames.end()));
+                newCols = newCols | ((*iterBands)->calcSum && (std::find(colNames.begin(), colNames.end(), (*iterBands)->sumField) == colNames.end()));
+                calcMinMax = calcMinMax | (*iterBands)->calcMin | (*iterBands)->calcMax;
+                calcStdDevs = calcStdDevs | (*iterBands)->calcStdDev;
+            }
+            if(newCols)
+            {
+                this->populateRATWithBasicStats(inputClumps, inputValsImage, bandStats, ratBand);
+                return;
+            }
+            
+            std::vector<size_t> changedClumps = changes->getChangedClumps(true);
+            if(changedClumps.empty())
+            {
+                return;
+            }
+            
+            size_t numRows = rat->GetRowCount();
+            if(changedClumps.back() >= numRows)
+            {
+                numRows = changedClumps.back()+1;
+                rat->SetRowCount(numRows);
+            }
+            
+            for(std::vector<rsgis::rastergis::RSGISBandAttStats*>::iterator iterBands = bandStats->begin(); iterBands != bandStats->end(); ++iterBands)
+            {
+                if((*iterBands)->calcMin)
+                {
+                    (*iterBands)->minFieldIdx = attUtils.findColumnIndex(rat, (*iterBands)->minField);
+                }
+                if((*iterBands)->calcMax)
+                {
+                    (*iterBands)->maxFieldIdx = attUtils.findColumnIndex(rat, (*iterBands)->maxField);
+                }
+                if((*iterBands)->calcMean)
+                {
+                    (*iterBands)->meanFieldIdx = attUtils.findColumnIndex(rat, (*iterBands)->meanField);
+                }
+                if((*iterBands)->calcStdDev)
+                {
+                    (*iterBands)->stdDevFieldIdx = attUtils.findColumnIndex(rat, (*iterBands)->stdDevField);
+                }
+                if((*iterBands)->calcSum)
+                {
+                    (*iterBands)->sumFieldIdx = attUtils.findColumnIndex(rat, (*iterBands)->sumField);
+                }
+            }
+            
+            // Map the changed clumps onto a compact range so only they are accumulated (clump 0 is no data).
+            std::vector<unsigned int> clumpGroups(numRows, 0);
+            for(size_t i = 0; i < changedClumps.size(); ++i)
+            {
+                if(changedClumps[i] > 0)
+                {
+                    clumpGroups[changedClumps[i]] = i+1;
+                }
+            }
+            
+            GDALDataset **datasets = new GDALDataset*[2];
+            datasets[0] = inputClumps;
+            datasets[1] = inputValsImage;
+            int **dsOffsets = new int*[2];
+            dsOffsets[0] = new int[2];
+            dsOffsets[1] = new int[2];
+            double *gdalTransform = new double[6];
+            int width = 0;
+            int height = 0;
+            rsgis::img::RSGISImageUtils imgUtils;
+            imgUtils.getImageOverlap(datasets, 2, dsOffsets, &width, &height, gdalTransform);
+            int clumpsXOff = dsOffsets[0][0];
+            int clumpsYOff = dsOffsets[0][1];
+            int valsXOff = dsOffsets[1][0];
+            int valsYOff = dsOffsets[1][1];
+            delete[] dsOffsets[0];
+            delete[] dsOffsets[1];
+            delete[] dsOffsets;
+            delete[] gdalTransform;
+            delete[] datasets;
+            
+            std::vector<std::pair<unsigned int, unsigned int> > blocks = changes->getChangedBlocks();
+            std::cout << "Updating statistics for " << changedClumps.size() << " clumps from " << blocks.size() << " image blocks\n";
+            
+            unsigned int numVars = bandStats->size();
+            rsgis::img::RSGISImageThreadUtils threadUtils;
+            unsigned int nThreads = threadUtils.getNumThreads(0);
+            
+            // KEA files cannot be opened per thread so their reads are serialised.
+            bool sharedClumps = false;
+            bool sharedVals = false;
+            std::vector<GDALDataset*> clumpHandles = threadUtils.openDatasetHandles(inputClumps, nThreads, &sharedClumps);
+            std::vector<GDALDataset*> valsHandles = threadUtils.openDatasetHandles(inputValsImage, nThreads, &sharedVals);
+            
+            std::vector<rsgis::math::RSGISGroupedStatsAccumulator> accums(nThreads, rsgis::math::RSGISGroupedStatsAccumulator(changedClumps.size()+1, numVars, calcMinMax, calcStdDevs));
+            try
+            {
+                threadUtils.runTasks(nThreads, blocks.size(), [&](unsigned int threadIdx, size_t blockIdx)
+                {
+                    int xOff = 0;
+                    int yOff = 0;
+                    int xSize = 0;
+                    int ySize = 0;
+                    changes->getBlockWindow(blocks[blockIdx].first, blocks[blockIdx].second, &xOff, &yOff, &xSize, &ySize);
+                    
+                    // Clip the block to the region where the two images overlap.
+                    int xMin = std::max(xOff, clumpsXOff);
+                    int yMin = std::max(yOff, clumpsYOff);
+                    int xMax = std::min(xOff+xSize, clumpsXOff+width);
+                    int yMax = std::min(yOff+ySize, clumpsYOff+height);
+                    if((xMax <= xMin) | (yMax <= yMin))
                     {
-                        rowID = startRow;
-                        for(size_t j = 0; j < rowsRemain; ++j)
-                        {
-                            if(histDataBlock[j] > 0)
-                            {
-                                dataBlock[j] = statsData[rowID][(*iterBands)->minLocalIdx];
-                            }
-                            else
-                            {
-                                dataBlock[j] = 0.0;
-                            }
-                            ++rowID;
-                        }
-                        rat->ValuesIO(GF_Write, (*iterBands)->minFieldIdx, startRow, rowsRemain, dataBlock);
+                        return;
                     }
+                    int winWidth = xMax - xMin;
+                    int winHeight = yMax - yMin;
+                    size_t nPxls = ((size_t)winWidth) * ((size_t)winHeight);
                     
-                    if((*iterBands)->calcMax)
+                    std::vector<unsigned int> clumpIDs(nPxls);
+                    std::vector<float> vals(nPxls * numVars);
+                    
+                    std::unique_lock<std::mutex> readLock = threadUtils.lockSharedRead(sharedClumps | sharedVals);
+                    if(clumpHandles[threadIdx]->GetRasterBand(ratBand)->RasterIO(GF_Read, xMin, yMin, winWidth, winHeight, clumpIDs.data(), winWidth, winHeight, GDT_UInt32, 0, 0) != CE_None)
                     {
-                        rowID = startRow;
-                        for(size_t j = 0; j < rowsRemain; ++j)
-                        {
-                            if(histDataBlock[j] > 0)
-                            {
-                                dataBlock[j] = statsData[rowID][(*iterBands)->maxLocalIdx];
-                            }
-                            else
-                            {
-                                dataBlock[j] = 0.0;
-                            }
-                            ++rowID;
-                        }
-                        rat->ValuesIO(GF_Write, (*iterBands)->maxFieldIdx, startRow, rowsRemain, dataBlock);
+                        throw rsgis::RSGISAttributeTableException("Failed to read the clumps image.");
                     }
-                    
-                    if((*iterBands)->calcMean)
+                    for(unsigned int i = 0; i < numVars; ++i)
                     {
-                        rowID = startRow;
-                        for(size_t j = 0; j < rowsRemain; ++j)
+                        if(valsHandles[threadIdx]->GetRasterBand(bandStats->at(i)->band)->RasterIO(GF_Read, xMin-clumpsXOff+valsXOff, yMin-clumpsYOff+valsYOff, winWidth, winHeight, &vals[i*nPxls], winWidth, winHeight, GDT_Float32, 0, 0) != CE_None)
                         {
-                            if(histDataBlock[j] > 0)
-                            {
-                                statsData[rowID][(*iterBands)->meanLocalIdx] = statsData[rowID][(*iterBands)->meanLocalIdx] / histDataBlock[j];
-                                dataBlock[j] = statsData[rowID][(*iterBands)->meanLocalIdx];
-                            }
-                            else
-                            {
-                                dataBlock[j] = 0.0;
-                            }
-                            ++rowID;
+                            throw rsgis::RSGISAttributeTableException("Failed to read the input values image.");
                         }
-                        rat->ValuesIO(GF_Write, (*iterBands)->meanFieldIdx, startRow, rowsRemain, dataBlock);
                     }
-                    
-                    if((*iterBands)->calcSum)
+                    if(readLock.owns_lock())
                     {
-                        rowID = startRow;
-                        for(size_t j = 0; j < rowsRemain; ++j)
-                        {
-                            if(histDataBlock[j] > 0)
-                            {
-                                dataBlock[j] = statsData[rowID][(*iterBands)->sumLocalIdx];
-                            }
-                            else
-                            {
-                                dataBlock[j] = 0.0;
-                            }
-                            ++rowID;
-                        }
-                        rat->ValuesIO(GF_Write, (*iterBands)->sumFieldIdx, startRow, rowsRemain, dataBlock);
+                        readLock.unlock();
                     }
-                }
+                    for(size_t i = 0; i < nPxls; ++i)
+                    {
+                        clumpIDs[i] = (clumpIDs[i] < numRows)?clumpGroups[clumpIDs[i]]:0;
+                    }
+                    accums[threadIdx].addBlock(clumpIDs.data(), vals.data(), nPxls, true);
+                });
             }
+            catch(...)
+            {
+                threadUtils.closeDatasetHandles(&clumpHandles);
+                threadUtils.closeDatasetHandles(&valsHandles);
+                throw;
+            }
+            threadUtils.closeDatasetHandles(&clumpHandles);
+            threadUtils.closeDatasetHandles(&valsHandles);
             
-            if(calcStdDevs)
+            rsgis::math::RSGISGroupedStatsAccumulator &stats = accums[0];
+            for(unsigned int t = 1; t < nThreads; ++t)
             {
-                for(int i = 0; i < numRows; ++i)
-                {
-                    firstVal[i] = true;
-                }
-
-                // Get Image Values
-                double **stdDevData = new double*[numRows];
-                for(unsigned int i = 0; i < numRows; ++i)
+                stats.merge(accums[t]);
+            }
+            
+            // Only the span of each RAT block which holds changed rows is read and rewritten.
+            double *dataBlock = new double[RAT_BLOCK_LENGTH];
+            size_t firstIdx = 0;
+            while(firstIdx < changedClumps.size())
+            {
+                size_t blockEnd = ((changedClumps[firstIdx] / RAT_BLOCK_LENGTH) + 1) * RAT_BLOCK_LENGTH;
+                size_t lastIdx = firstIdx;
+                while(((lastIdx+1) < changedClumps.size()) && (changedClumps[lastIdx+1] < blockEnd))
                 {
-                    stdDevData[i] = new double[numStdDevs2Calc];
-                    for(unsigned int j = 0; j < numStdDevs2Calc; ++j)
-                    {
-                        stdDevData[i][j] = 0.0;
-                    }
+                    ++lastIdx;
                 }
-                RSGISCalcClusterPxlValueStdDev *calcImgValStdDev = new RSGISCalcClusterPxlValueStdDev(stdDevData, statsData, bandStats, firstVal, ratBand);
-                rsgis::img::RSGISCalcImage calcImageStdDev(calcImgValStdDev);
-                calcImageStdDev.calcImage(datasets, 1, 1);
-                delete calcImgValStdDev;
-
-                std::cout << "Writing Standard Deviation Stats to Output RAT\n";
-                startRow = 0;
-                for(size_t i = 0; i < numBlocks; ++i)
+                size_t startRow = changedClumps[firstIdx];
+                size_t spanRows = changedClumps[lastIdx] - startRow + 1;
+                
+                for(unsigned int i = 0; i < numVars; ++i)
                 {
-                    rat->ValuesIO(GF_Read, histoIdx, startRow, RAT_BLOCK_LENGTH, histDataBlock);
-                    for(std::vector<rsgis::rastergis::RSGISBandAttStats*>::iterator iterBands = bandStats->begin(); iterBands != bandStats->end(); ++iterBands)
+                    RSGISBandAttStats *bandStat = bandStats->at(i);
+                    for(unsigned int statIdx = 0; statIdx < 5; ++statIdx)
                     {
-                        if((*iterBands)->calcStdDev)
+                        bool calcStat = false;
+                        unsigned int fieldIdx = 0;
+                        switch(statIdx)
                         {
-                            rowID = startRow;
-                            for(size_t j = 0; j < RAT_BLOCK_LENGTH; ++j)
-                            {
-                                if(histDataBlock[j] > 0)
-                                {
-                                    stdDevData[rowID][(*iterBands)->stdDevLocalIdx] = sqrt(stdDevData[rowID][(*iterBands)->stdDevLocalIdx] / histDataBlock[j]);
-                                    dataBlock[j] = stdDevData[rowID][(*iterBands)->stdDevLocalIdx];
-                                }
-                                else
-                                {
-                                    dataBlock[j] = 0.0;
-                                }
-                                ++rowID;
-                            }
-                            rat->ValuesIO(GF_Write, (*iterBands)->stdDevFieldIdx, startRow, RAT_BLOCK_LENGTH, dataBlock);
+                            case 0: calcStat = bandStat->calcMin; fieldIdx = bandStat->minFieldIdx; break;
+                            case 1: calcStat = bandStat->calcMax; fieldIdx = bandStat->maxFieldIdx; break;
+                            case 2: calcStat = bandStat->calcMean; fieldIdx = bandStat->meanFieldIdx; break;
+                            case 3: calcStat = bandStat->calcStdDev; fieldIdx = bandStat->stdDevFieldIdx; break;
+                            default: calcStat = bandStat->calcSum; fieldIdx = bandStat->sumFieldIdx; break;
+                        }
+                        if(!calcStat)
+                        {
+                            continue;
                         }
                         
-                    }
-                    startRow += RAT_BLOCK_LENGTH;
-                }
-                if(rowsRemain > 0)
-                {
-                    rat->ValuesIO(GF_Read, histoIdx, startRow, rowsRemain, histDataBlock);
-                    for(std::vector<rsgis::rastergis::RSGISBandAttStats*>::iterator iterBands = bandStats->begin(); iterBands != bandStats->end(); ++iterBands)
-                    {
-                        if((*iterBands)->calcStdDev)
+                        rat->ValuesIO(GF_Read, fieldIdx, startRow, spanRows, dataBlock);
+                        for(size_t k = firstIdx; k <= lastIdx; ++k)
                         {
-                            rowID = startRow;
-                            for(size_t j = 0; j < rowsRemain; ++j)
+                            size_t group = k+1;
+                            double val = 0.0;
+                            if(stats.getCount(group, i) > 0)
                             {
-                                if(histDataBlock[j] > 0)
+                                switch(statIdx)
                                 {
-                                    stdDevData[rowID][(*iterBands)->stdDevLocalIdx] = sqrt(stdDevData[rowID][(*iterBands)->stdDevLocalIdx] / histDataBlock[j]);
-                                    dataBlock[j] = stdDevData[rowID][(*iterBands)->stdDevLocalIdx];
-                                }
-                                else
-                                {
-                                    dataBlock[j] = 0.0;
+                                    case 0: val = stats.getMin(group, i); break;
+                                    case 1: val = stats.getMax(group, i); break;
+                                    case 2: val = stats.getMean(group, i); break;
+                                    case 3: val = stats.getStdDev(group, i); break;
+                                    default: val = stats.getSum(group, i); break;
                                 }
-                                ++rowID;
                             }
-                            rat->ValuesIO(GF_Write, (*iterBands)->stdDevFieldIdx, startRow, rowsRemain, dataBlock);
+                            dataBlock[changedClumps[k] - startRow] = val;
                         }
+                        rat->ValuesIO(GF_Write, fieldIdx, startRow, spanRows, dataBlock);
                     }
                 }
-                
-                for(unsigned int i = 0; i < numRows; ++i)
-                {
-                    delete[] stdDevData[i];
-                }
-                delete[] stdDevData;
-            }
-            
-            for(unsigned int i = 0; i < numRows; ++i)
-            {
-                delete[] statsData[i];
+                firstIdx = lastIdx + 1;
             }
-            delete[] statsData;
-            delete[] firstVal;
-            
-            
             delete[] dataBlock;
-            delete[] histDataBlock;
-            delete[] datasets;
         }
         catch(RSGISAttributeTableException &e)
         {
@@ -1233,134 +1377,6 @@ namespace rsgis{namespace rastergis{
     }
     
     
-    RSGISCalcClusterPxlValueStats::RSGISCalcClusterPxlValueStats(double **statsData, std::vector<rsgis::rastergis::RSGISBandAttStats*> *bandStats, bool *firstVal, unsigned int ratBand) : rsgis::img::RSGISCalcImageValue(0)
-    {
-        this->statsData = statsData;
-        this->bandStats = bandStats;
-        this->firstVal = firstVal;
-        this->ratBand = ratBand;
-    }
-    
-    void RSGISCalcClusterPxlValueStats::calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals) 
-    {
-        if(intBandValues[ratBand-1] > 0)
-        {
-            unsigned long fid = intBandValues[ratBand-1];
-
-            for(std::vector<rsgis::rastergis::RSGISBandAttStats*>::iterator iterBands = bandStats->begin(); iterBands != bandStats->end(); ++iterBands)
-            {
-                if((boost::math::isfinite)(floatBandValues[(*iterBands)->band-1]))
-                {
-                    if((*iterBands)->calcMin)
-                    {
-                        if(firstVal[fid])
-                        {
-                            statsData[fid][(*iterBands)->minLocalIdx] = floatBandValues[(*iterBands)->band-1];
-                        }
-                        else if(floatBandValues[(*iterBands)->band-1] < statsData[fid][(*iterBands)->minLocalIdx])
-                        {
-                            statsData[fid][(*iterBands)->minLocalIdx] = floatBandValues[(*iterBands)->band-1];
-                        }
-                    }
-                    
-                    if((*iterBands)->calcMax)
-                    {
-                        if(firstVal[fid])
-                        {
-                            statsData[fid][(*iterBands)->maxLocalIdx] = floatBandValues[(*iterBands)->band-1];
-                        }
-                        else if(floatBandValues[(*iterBands)->band-1] > statsData[fid][(*iterBands)->maxLocalIdx])
-                        {
-                            statsData[fid][(*iterBands)->maxLocalIdx] = floatBandValues[(*iterBands)->band-1];
-                        }
-                    }
-                    
-                    if((*iterBands)->calcMean)
-                    {
-                        if(firstVal[fid])
-                        {
-                            statsData[fid][(*iterBands)->meanLocalIdx] = floatBandValues[(*iterBands)->band-1];
-                        }
-                        else
-                        {
-                            statsData[fid][(*iterBands)->meanLocalIdx] += floatBandValues[(*iterBands)->band-1];
-                        }
-                    }
-                    
-                    if((*iterBands)->calcSum)
-                    {
-                        if(firstVal[fid])
-                        {
-                            statsData[fid][(*iterBands)->sumLocalIdx] = floatBandValues[(*iterBands)->band-1];
-                        }
-                        else
-                        {
-                            statsData[fid][(*iterBands)->sumLocalIdx] += floatBandValues[(*iterBands)->band-1];
-                        }
-                    }
-                }
-            }
-            
-            if(firstVal[fid])
-            {
-                firstVal[fid] = false;
-            }
-        }
-    }
-    
-    RSGISCalcClusterPxlValueStats::~RSGISCalcClusterPxlValueStats()
-    {
-        
-    }
-    
-    RSGISCalcClusterPxlValueStdDev::RSGISCalcClusterPxlValueStdDev(double **stdDevData, double **statsData, std::vector<rsgis::rastergis::RSGISBandAttStats*> *bandStats, bool *firstVal, unsigned int ratBand) : rsgis::img::RSGISCalcImageValue(0)
-    {
-        this->stdDevData = stdDevData;
-        this->statsData = statsData;
-        this->bandStats = bandStats;
-        this->firstVal = firstVal;
-        this->ratBand = ratBand;
-    }
-    
-    void RSGISCalcClusterPxlValueStdDev::calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals) 
-    {
-        if(intBandValues[ratBand-1] > 0)
-        {
-            unsigned long fid = intBandValues[ratBand-1];
-            for(std::vector<rsgis::rastergis::RSGISBandAttStats*>::iterator iterBands = bandStats->begin(); iterBands != bandStats->end(); ++iterBands)
-            {
-                if((boost::math::isfinite)(floatBandValues[(*iterBands)->band-1]))
-                {
-                    if((*iterBands)->calcStdDev)
-                    {
-                        double stdDevComp = pow(((double)(floatBandValues[(*iterBands)->band-1] - statsData[fid][(*iterBands)->meanLocalIdx])), 2.0);
-                        if(firstVal[fid])
-                        {
-                            stdDevData[fid][(*iterBands)->stdDevLocalIdx] = stdDevComp;
-                        }
-                        else
-                        {
-                            stdDevData[fid][(*iterBands)->stdDevLocalIdx] += stdDevComp;
-                        }
-                    }
-                }
-            }
-            
-            if(firstVal[fid])
-            {
-                firstVal[fid] = false;
-            }
-        }
-    }
-    
-    RSGISCalcClusterPxlValueStdDev::~RSGISCalcClusterPxlValueStdDev()
-    {
-        
-    }
-    
-    
-    
-    
     RSGISCalcClusterPxlValueHistograms::RSGISCalcClusterPxlValueHistograms(unsigned int **clumpHistData, double *binBounds, unsigned int numBins, unsigned int ratBand, unsigned int imgBand, double noDataVal, bool useNoDataVal): rsgis::img::RSGISCalcImageValue(0)
     {
         this->clumpHistData = clumpHistData;
@@ -24,12 +24,12 @@
 
 namespace rsgis{namespace rastergis{
     
-    RSGISApplyRATKNN::RSGISApplyRATKNN()
+    RSGISApplyRATKNN::RSGISApplyRATKNN(unsigned int numThreads)
     {
-        
+        this->numThreads = numThreads;
     }
     
-    void RSGISApplyRATKNN::applyKNNExtrapolation(GDALDataset *clumpsDS, std::string inExtrapField, std::string outExtrapField, std::string trainRegionsField, std::string applyRegionsField, bool useApplyField, std::vector<std::string> fields, unsigned int kFeatures, rsgis::math::rsgisdistmetrics distKNN, float distThreshold, rsgis::math::rsgissummarytype summeriseKNN, unsigned int ratBand)
+    void RSGISApplyRATKNN::applyKNNExtrapolation(GDALDataset *clumpsDS, std::string inExtrapField, std::string outExtrapField, std::string trainRegionsField, std::string applyRegionsField, bool useApplyField, std::vector<std::string> fields, unsigned int kFeatures, rsgis::math::rsgisdistmetrics distKNN, float distThreshold, rsgis::math::rsgissummarytype summeriseKNN, unsigned int ratBand, double minkowskiP)
     {
         try
         {
@@ -52,29 +52,7 @@ namespace rsgis{namespace rastergis{
             }
             unsigned int outExtrapFieldIdx = attUtils.findColumnIndexOrCreate(gdalAtt, outExtrapField, gdalAtt->GetTypeOfCol(inExtrapFieldIdx));
             
-            
-            // Find out how many training samples there are.
-            std::cout << "Count Number of Training Sample\n";
-            size_t numTrainFeats = 0;
-            RSGISCountTrainingValues countTrainSamplesVals = RSGISCountTrainingValues(&numTrainFeats);
-            RSGISRATCalc ratCalc = RSGISRATCalc(&countTrainSamplesVals);
-            std::vector<unsigned int> inRealColIdx;
-            std::vector<unsigned int> inIntColIdx;
-            inIntColIdx.push_back(trainRegFieldIdx);
-            std::vector<unsigned int> inStrColIdx;
-            std::vector<unsigned int> outRealColIdx;
-            std::vector<unsigned int> outIntColIdx;
-            std::vector<unsigned int> outStrColIdx;
-            ratCalc.calcRATValues(gdalAtt, inRealColIdx, inIntColIdx, inStrColIdx, outRealColIdx, outIntColIdx, outStrColIdx);
-            
-            // Check it is enough...
-            if(numTrainFeats < kFeatures)
-            {
-                throw RSGISAttributeTableException("The number of training samples is less than the value of K.");
-            }
-            
             // Find fields from RAT
-            inRealColIdx.push_back(inExtrapFieldIdx);
             std::vector<unsigned int> fieldsIdx;
             for(std::vector<std::string>::iterator iterFields = fields.begin(); iterFields != fields.end(); ++iterFields)
             {
@@ -85,113 +63,127 @@ namespace rsgis{namespace rastergis{
                     throw RSGISAttributeTableException(message);
                 }
                 fieldsIdx.push_back(idx);
-                inRealColIdx.push_back(idx);
-            }
-            
-            
-            // Allocate memory for training data
-            double **trainData = new double*[numTrainFeats];
-            size_t numFloatVals = inRealColIdx.size();
-            for(size_t i = 0; i < numTrainFeats; ++i)
-            {
-                trainData[i] = new double[numFloatVals];
-                for(size_t j = 0; j < numFloatVals; ++j)
-                {
-                    trainData[i][j] = 0.0;
-                }
             }
-            
-            // Extract training data
-            std::cout << "Extract Training Data\n";
-            RSGISExtractTrainingValues extractVals = RSGISExtractTrainingValues(trainData, numTrainFeats, numFloatVals);
-            ratCalc = RSGISRATCalc(&extractVals);
-            extractVals.resetCounter();
-            ratCalc.calcRATValues(gdalAtt, inRealColIdx, inIntColIdx, inStrColIdx, outRealColIdx, outIntColIdx, outStrColIdx);
+            unsigned int numFeatVals = fieldsIdx.size();
             
             rsgis::math::RSGISMathsUtils mathUtils;
-            rsgis::math::RSGISStatsSummary *mathSumStats = new rsgis::math::RSGISStatsSummary();
-            mathUtils.initStatsSummary(mathSumStats);
+            rsgis::math::RSGISStatsSummary mathSumStats;
+            mathUtils.initStatsSummary(&mathSumStats);
             if(summeriseKNN == rsgis::math::sumtype_mean)
             {
-                mathSumStats->calcMean = true;
+                mathSumStats.calcMean = true;
             }
             else if(summeriseKNN == rsgis::math::sumtype_median)
             {
-                mathSumStats->calcMedian = true;
+                mathSumStats.calcMedian = true;
             }
             else if(summeriseKNN == rsgis::math::sumtype_mode)
             {
-                mathSumStats->calcMode = true;
+                mathSumStats.calcMode = true;
             }
             else if(summeriseKNN == rsgis::math::sumtype_min)
             {
-                mathSumStats->calcMin = true;
+                mathSumStats.calcMin = true;
             }
             else if(summeriseKNN == rsgis::math::sumtype_max)
             {
-                mathSumStats->calcMax = true;
+                mathSumStats.calcMax = true;
             }
             else
             {
                 throw RSGISAttributeTableException("Summary method is not supported and/or known.");
             }
             
-            rsgis::math::RSGISCalcDistMetric *calcDist = NULL;
-            if(distKNN == rsgis::math::rsgis_euclidean)
-            {
-                calcDist = new rsgis::math::RSGISCalcEuclideanDistMetric();
-                calcDist->init();
-            }
-            else if(distKNN == rsgis::math::rsgis_manhatten)
-            {
-                calcDist = new rsgis::math::RSGISCalcManhattenDistMetric();
-                calcDist->init();
-            }
-            else if(distKNN == rsgis::math::rsgis_mahalanobis)
-            {
-                double *meanVec = mathUtils.calcMeanVector(trainData, numTrainFeats, numFloatVals, 1, numFloatVals);
-                double **covarMatrix = mathUtils.calcCovarianceMatrix(trainData, meanVec, numTrainFeats, numFloatVals, 1, numFloatVals);
-                size_t numVals = numFloatVals - 1;
-                delete[] meanVec;
-                calcDist = new rsgis::math::RSGISCalcMahalanobisDistMetric(covarMatrix, numVals);
-                calcDist->init();
-            }
-            else if(distKNN == rsgis::math::rsgis_minkowski)
-            {
-                calcDist = new rsgis::math::RSGISCalcMinkowskiDistMetric();
-                calcDist->init();
-            }
-            else if(distKNN == rsgis::math::rsgis_chebyshev)
-            {
-                calcDist = new rsgis::math::RSGISCalcChebyshevDistMetric();
-                calcDist->init();
-            }
-            else
+            // Extract training data
+            std::cout << "Extract Training Data\n";
+            size_t numRows = gdalAtt->GetRowCount();
+            std::vector<double> trainFeats;
+            std::vector<double> trainVals;
+            std::vector<int> intBlock(RAT_BLOCK_LENGTH);
+            std::vector<double> valsBlock(RAT_BLOCK_LENGTH);
+            std::vector<double> featsBlock(((size_t)RAT_BLOCK_LENGTH) * numFeatVals);
+            for(size_t startRow = 0; startRow < numRows; startRow += RAT_BLOCK_LENGTH)
             {
-                throw RSGISAttributeTableException("Distance method is not supported and/or known.");
+                size_t blockRows = std::min<size_t>(RAT_BLOCK_LENGTH, numRows - startRow);
+                gdalAtt->ValuesIO(GF_Read, trainRegFieldIdx, startRow, blockRows, intBlock.data());
+                gdalAtt->ValuesIO(GF_Read, inExtrapFieldIdx, startRow, blockRows, valsBlock.data());
+                this->readFeatures(gdalAtt, fieldsIdx, startRow, blockRows, &featsBlock);
+                for(size_t i = 0; i < blockRows; ++i)
+                {
+                    if(intBlock[i] == 1)
+                    {
+                        trainVals.push_back(valsBlock[i]);
+                        trainFeats.insert(trainFeats.end(), &featsBlock[i * numFeatVals], &featsBlock[i * numFeatVals] + numFeatVals);
+                    }
+                }
             }
+            size_t numTrainFeats = trainVals.size();
             
-                
-            // Perform KNN
-            std::cout << "Perform KNN\n";
-            inIntColIdx.clear();
-            if(useApplyField)
+            // Check it is enough...
+            if(numTrainFeats < kFeatures)
             {
-                inIntColIdx.push_back(applyRegFieldIdx);
+                throw RSGISAttributeTableException("The number of training samples is less than the value of K.");
             }
-            outRealColIdx.push_back(outExtrapFieldIdx);
-            RSGISPerformKNNCalcValues performKNN = RSGISPerformKNNCalcValues(trainData, numTrainFeats, numFloatVals, kFeatures, calcDist, distThreshold, mathSumStats);
-            ratCalc = RSGISRATCalc(&performKNN);
-            ratCalc.calcRATValues(gdalAtt, inRealColIdx, inIntColIdx, inStrColIdx, outRealColIdx, outIntColIdx, outStrColIdx);
             
-            // Deallocate memory
-            for(size_t i = 0; i < numTrainFeats; ++i)
+            std::cout << "Build KNN Index\n";
+            rsgis::math::RSGISKNNSearchIndex knnIndex(trainFeats.data(), numTrainFeats, numFeatVals, distKNN, 16, minkowskiP);
+            
+            // Perform KNN, splitting each block of rows between the threads.
+            std::cout << "Perform KNN\n";
+            rsgis::img::RSGISImageThreadUtils threadUtils;
+            unsigned int nThreads = threadUtils.getNumThreads(this->numThreads);
+            const size_t chunkRows = 1000;
+            std::vector<double> outBlock(RAT_BLOCK_LENGTH);
+            size_t numBlocks = (numRows + RAT_BLOCK_LENGTH - 1) / RAT_BLOCK_LENGTH;
+            rsgis_tqdm pbar;
+            for(size_t block = 0; block < numBlocks; ++block)
             {
-                delete[] trainData[i];
+                pbar.progress(block, numBlocks);
+                size_t startRow = block * RAT_BLOCK_LENGTH;
+                size_t blockRows = std::min<size_t>(RAT_BLOCK_LENGTH, numRows - startRow);
+                if(useApplyField)
+                {
+                    gdalAtt->ValuesIO(GF_Read, applyRegFieldIdx, startRow, blockRows, intBlock.data());
+                }
+                this->readFeatures(gdalAtt, fieldsIdx, startRow, blockRows, &featsBlock);
+                
+                size_t numChunks = (blockRows + chunkRows - 1) / chunkRows;
+                threadUtils.runTasks(nThreads, numChunks, [&](unsigned int threadIdx, size_t chunk)
+                {
+                    rsgis::math::RSGISMathsUtils chunkMathUtils;
+                    rsgis::math::RSGISStatsSummary sumStats = mathSumStats;
+                    std::vector<std::pair<double, size_t> > neighbours;
+                    std::vector<double> data;
+                    size_t endRow = std::min(blockRows, (chunk + 1) * chunkRows);
+                    for(size_t i = chunk * chunkRows; i < endRow; ++i)
+                    {
+                        outBlock[i] = std::numeric_limits<double>::signaling_NaN();
+                        if(useApplyField && (intBlock[i] != 1))
+                        {
+                            continue;
+                        }
+                        
+                        // Find K NN samples from training data
+                        knnIndex.findKNN(&featsBlock[i * numFeatVals], kFeatures, distThreshold, &neighbours);
+                        if(neighbours.empty())
+                        {
+                            continue;
+                        }
+                        
+                        // Derive new value from K NN samples
+                        data.clear();
+                        for(std::vector<std::pair<double, size_t> >::iterator iterFeat = neighbours.begin(); iterFeat != neighbours.end(); ++iterFeat)
+                        {
+                            data.push_back(trainVals[(*iterFeat).second]);
+                        }
+                        chunkMathUtils.generateStats(&data, &sumStats);
+                        outBlock[i] = this->getSummaryValue(&sumStats);
+                    }
+                }, true);
+                
+                gdalAtt->ValuesIO(GF_Write, outExtrapFieldIdx, startRow, blockRows, outBlock.data());
             }
-            delete[]trainData;
-            delete mathSumStats;
-            delete calcDist;
+            pbar.finish();
         }
         catch (RSGISAttributeTableException &e)
         {
@@ -207,240 +199,58 @@ namespace rsgis{namespace rastergis{
         }
     }
     
-    RSGISApplyRATKNN::~RSGISApplyRATKNN()
+    void RSGISApplyRATKNN::readFeatures(GDALRasterAttributeTable *gdalAtt, const std::vector<unsigned int> &fieldsIdx, size_t startRow, size_t numRows, std::vector<double> *featVals)
     {
-        
-    }
-    
-    RSGISCountTrainingValues::RSGISCountTrainingValues(size_t *numTrainPts): RSGISRATCalcValue()
-    {
-        this->numTrainPts = numTrainPts;
-    }
-    
-    void RSGISCountTrainingValues::calcRATValue(size_t fid, double *inRealCols, unsigned int numInRealCols, int *inIntCols, unsigned int numInIntCols, std::string *inStringCols, unsigned int numInStringCols, double *outRealCols, unsigned int numOutRealCols, int *outIntCols, unsigned int numOutIntCols, std::string *outStringCols, unsigned int numOutStringCols)
-    {
-        if(numInIntCols != 1)
+        // Read column by column and interleave so each row's features are together.
+        unsigned int numFeatVals = fieldsIdx.size();
+        std::vector<double> colVals(numRows);
+        for(unsigned int n = 0; n < numFeatVals; ++n)
         {
-            throw RSGISAttributeTableException("Only expecting one and only one integer column with values of 1 indicating a training sample.");
-        }
-        
-        if(inIntCols[0] == 1)
-        {
-            ++(*numTrainPts);
-        }
-    }
-    
-    RSGISCountTrainingValues::~RSGISCountTrainingValues()
-    {
-        
-    }
-    
-    RSGISExtractTrainingValues::RSGISExtractTrainingValues(double **trainData, size_t n, size_t m): RSGISRATCalcValue()
-    {
-        this->trainData = trainData;
-        this->n = n;
-        this->m = m;
-        this->counter = 0;
-    }
-    
-    void RSGISExtractTrainingValues::calcRATValue(size_t fid, double *inRealCols, unsigned int numInRealCols, int *inIntCols, unsigned int numInIntCols, std::string *inStringCols, unsigned int numInStringCols, double *outRealCols, unsigned int numOutRealCols, int *outIntCols, unsigned int numOutIntCols, std::string *outStringCols, unsigned int numOutStringCols)
-    {
-        if(numInIntCols != 1)
-        {
-            throw RSGISAttributeTableException("Only expecting one and only one integer column with values of 1 indicating a training sample.");
-        }
-        
-        
-        if(inIntCols[0] == 1)
-        {
-            if(m != numInRealCols)
-            {
-                throw RSGISAttributeTableException("The number of real number columns is not the same size as the array; which ones to copy?");
-            }
-            
-            if(counter == n)
+            gdalAtt->ValuesIO(GF_Read, fieldsIdx[n], startRow, numRows, colVals.data());
+            for(size_t i = 0; i < numRows; ++i)
             {
-                throw RSGISAttributeTableException("The array for the training data is not long enough.");
+                (*featVals)[(i * numFeatVals) + n] = colVals[i];
             }
-            
-            for(size_t i = 0; i < this->m; ++i)
-            {
-                trainData[counter][i] = inRealCols[i];
-            }
-            ++counter;
         }
     }
     
-    void RSGISExtractTrainingValues::resetCounter()
-    {
-        this->counter = 0;
-    }
-    
-    RSGISExtractTrainingValues::~RSGISExtractTrainingValues()
-    {
-        
-    }
-    
-    
-
-    RSGISPerformKNNCalcValues::RSGISPerformKNNCalcValues(double **trainData, size_t n, size_t m, unsigned int kFeatures, rsgis::math::RSGISCalcDistMetric *calcDist, float distThreshold, rsgis::math::RSGISStatsSummary *mathSumStats):RSGISRATCalcValue()
-    {
-        this->trainData = trainData;
-        this->n = n;
-        this->m = m;
-        this->kFeatures = kFeatures;
-        this->calcDist = calcDist;
-        this->distThreshold = distThreshold;
-        this->mathSumStats = mathSumStats;
-    }
-    
-    void RSGISPerformKNNCalcValues::calcRATValue(size_t fid, double *inRealCols, unsigned int numInRealCols, int *inIntCols, unsigned int numInIntCols, std::string *inStringCols, unsigned int numInStringCols, double *outRealCols, unsigned int numOutRealCols, int *outIntCols, unsigned int numOutIntCols, std::string *outStringCols, unsigned int numOutStringCols)
+    double RSGISApplyRATKNN::getSummaryValue(rsgis::math::RSGISStatsSummary *sumStats)
     {
-        if(numOutRealCols != 1)
+        if(sumStats->calcMean)
         {
-            throw RSGISAttributeTableException("Only one output float column should be specified as otherwise don't know which column to write to?");
+            return sumStats->mean;
         }
-        
-        if(m != numInRealCols)
+        else if(sumStats->calcMedian)
         {
-            throw RSGISAttributeTableException("The number of real number columns is not the same size as the array; which ones to copy?");
+            return sumStats->median;
         }
-        
-        try
+        else if(sumStats->calcMax)
         {
-            bool performKNN = true;
-            if(numInIntCols == 1)
-            {
-                if(inIntCols[0] != 1)
-                {
-                    performKNN = false;
-                }
-            }
-            if(performKNN)
-            {
-                // Find K NN samples from training data
-                std::list<std::pair<double, double*> > *kVals = new std::list<std::pair<double, double*> >();
-                this->findKVals(kVals, inRealCols);
-                
-                // Derive new value from K NN samples
-                std::vector<double> data;
-                for(std::list<std::pair<double, double*> >::iterator iterFeat = kVals->begin(); iterFeat != kVals->end(); ++iterFeat)
-                {
-                    data.push_back((*iterFeat).second[0]);
-                }
-                rsgis::math::RSGISMathsUtils mathUtils;
-                mathUtils.generateStats(&data, this->mathSumStats);
-                
-                // Write to output column
-                if(this->mathSumStats->calcMean)
-                {
-                    outRealCols[0] = this->mathSumStats->mean;
-                }
-                else if(this->mathSumStats->calcMedian)
-                {
-                    outRealCols[0] = this->mathSumStats->median;
-                }
-                else if(this->mathSumStats->calcMax)
-                {
-                    outRealCols[0] = this->mathSumStats->max;
-                }
-                else if(this->mathSumStats->calcMin)
-                {
-                    outRealCols[0] = this->mathSumStats->min;
-                }
-                else if(this->mathSumStats->calcMode)
-                {
-                    outRealCols[0] = this->mathSumStats->mode;
-                }
-                else if(this->mathSumStats->calcStdDev)
-                {
-                    outRealCols[0] = this->mathSumStats->stdDev;
-                }
-                else if(this->mathSumStats->calcSum)
-                {
-                    outRealCols[0] = this->mathSumStats->sum;
-                }
-                else
-                {
-                    throw RSGISAttributeTableException("Summarise option unknown.");
-                }
-                delete kVals;
-            }
-            else
-            {
-                outRealCols[0] = std::numeric_limits<double>::signaling_NaN();
-            }
+            return sumStats->max;
         }
-        catch (RSGISAttributeTableException &e)
+        else if(sumStats->calcMin)
         {
-            throw e;
-        }
-        catch (rsgis::RSGISException &e)
-        {
-            throw RSGISAttributeTableException(e.what());
-        }
-        catch (std::exception &e)
-        {
-            throw RSGISAttributeTableException(e.what());
-        }
-       
-        
-    }
-    
-    void RSGISPerformKNNCalcValues::findKVals(std::list<std::pair<double, double*> > *kVals, double *featVals)
-    {
-        try
-        {
-            double dist = 0.0;
-            for(size_t i = 0; i < this->n; ++i)
-            {
-                dist = this->calcDist->calcDist(this->trainData[i], 1, m, featVals, 1, m);
-
-                if(dist < this->distThreshold)
-                {
-                    if(kVals->empty())
-                    {
-                        kVals->push_back(std::pair<double, double*>(dist, this->trainData[i]));
-                    }
-                    else
-                    {
-                        for(std::list<std::pair<double, double*> >::iterator iterFeat = kVals->begin(); iterFeat != kVals->end(); ++iterFeat)
-                        {
-                            if(dist < (*iterFeat).first)
-                            {
-                                kVals->insert(iterFeat, std::pair<double, double*>(dist, this->trainData[i]));
-                                break;
-                            }
-                        }
-                        if(kVals->size() > this->kFeatures)
-                        {
-                            kVals->pop_back();
-                        }
-                    }
-                }
-            }
+            return sumStats->min;
         }
-        catch (RSGISAttributeTableException &e)
+        else if(sumStats->calcMode)
         {
-            throw e;
+            return sumStats->mode;
         }
-        catch (rsgis::RSGISException &e)
+        else if(sumStats->calcStdDev)
         {
-            throw RSGISAttributeTableException(e.what());
+            return sumStats->stdDev;
         }
-        catch (std::exception &e)
+        else if(sumStats->calcSum)
         {
-            throw RSGISAttributeTableException(e.what());
+            return sumStats->sum;
         }
+        throw RSGISAttributeTableException("Summarise option unknown.");
     }
     
-    RSGISPerformKNNCalcValues::~RSGISPerformKNNCalcValues()
+    RSGISApplyRATKNN::~RSGISApplyRATKNN()
     {
         
     }
-
-    
-    
     
 }}
 
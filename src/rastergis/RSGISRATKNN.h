@@ -26,19 +26,21 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <list>
+#include <limits>
+#include <algorithm>
 
 #include "gdal_priv.h"
 #include "gdal_rat.h"
 
 #include "common/RSGISAttributeTableException.h"
+#include "common/rsgis-tqdm.h"
+
+#include "img/RSGISImageThreadUtils.h"
 
 #include "rastergis/RSGISRasterAttUtils.h"
-#include "rastergis/RSGISRATCalcValue.h"
-#include "rastergis/RSGISRATCalc.h"
 
 #include "math/RSGISMathsUtils.h"
-#include "math/RSGISDistMetrics.h"
+#include "math/RSGISKNNSearchIndex.h"
 
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
@@ -56,57 +58,27 @@
 namespace rsgis{namespace rastergis{
     
     
+    /**
+     * Extrapolates a column to the rows of a RAT from the k nearest training
+     * rows (train field == 1) in the feature space of the given columns. The
+     * training rows are indexed with a k-d tree (whitened for the Mahalanobis
+     * distance) and the RAT is processed in blocks of rows, with the queries
+     * of each block split between threads. Rows not selected by the apply
+     * field, or without a training row within the distance threshold, are
+     * given NaN.
+     */
     class DllExport RSGISApplyRATKNN
     {
     public:
-        RSGISApplyRATKNN();
-        void applyKNNExtrapolation(GDALDataset *clumpsDS, std::string inExtrapField, std::string outExtrapField, std::string trainRegionsField, std::string applyRegionsField, bool useApplyField, std::vector<std::string> fields, unsigned int kFeatures=12, rsgis::math::rsgisdistmetrics distKNN=rsgis::math::rsgis_mahalanobis, float distThreshold=100000, rsgis::math::rsgissummarytype summeriseKNN=rsgis::math::sumtype_median, unsigned int ratBand=1);
+        RSGISApplyRATKNN(unsigned int numThreads=0);
+        void applyKNNExtrapolation(GDALDataset *clumpsDS, std::string inExtrapField, std::string outExtrapField, std::string trainRegionsField, std::string applyRegionsField, bool useApplyField, std::vector<std::string> fields, unsigned int kFeatures=12, rsgis::math::rsgisdistmetrics distKNN=rsgis::math::rsgis_mahalanobis, float distThreshold=100000, rsgis::math::rsgissummarytype summeriseKNN=rsgis::math::sumtype_median, unsigned int ratBand=1, double minkowskiP=3);
         ~RSGISApplyRATKNN();
+    protected:
+        void readFeatures(GDALRasterAttributeTable *gdalAtt, const std::vector<unsigned int> &fieldsIdx, size_t startRow, size_t numRows, std::vector<double> *featVals);
+        double getSummaryValue(rsgis::math::RSGISStatsSummary *sumStats);
+        unsigned int numThreads;
     };
     
-    class DllExport RSGISCountTrainingValues : public RSGISRATCalcValue
-    {
-    public:
-        RSGISCountTrainingValues(size_t *numTrainPts);
-        void calcRATValue(size_t fid, double *inRealCols, unsigned int numInRealCols, int *inIntCols, unsigned int numInIntCols, std::string *inStringCols, unsigned int numInStringCols, double *outRealCols, unsigned int numOutRealCols, int *outIntCols, unsigned int numOutIntCols, std::string *outStringCols, unsigned int numOutStringCols);
-        ~RSGISCountTrainingValues();
-    private:
-        size_t *numTrainPts;
-    };
-    
-    class DllExport RSGISExtractTrainingValues : public RSGISRATCalcValue
-    {
-    public:
-        RSGISExtractTrainingValues(double **trainData, size_t n, size_t m);
-        void calcRATValue(size_t fid, double *inRealCols, unsigned int numInRealCols, int *inIntCols, unsigned int numInIntCols, std::string *inStringCols, unsigned int numInStringCols, double *outRealCols, unsigned int numOutRealCols, int *outIntCols, unsigned int numOutIntCols, std::string *outStringCols, unsigned int numOutStringCols);
-        void resetCounter();
-        ~RSGISExtractTrainingValues();
-    private:
-        double **trainData;
-        size_t n;
-        size_t m;
-        size_t counter;
-    };
-    
-    class DllExport RSGISPerformKNNCalcValues : public RSGISRATCalcValue
-    {
-    public:
-        RSGISPerformKNNCalcValues(double **trainData, size_t n, size_t m, unsigned int kFeatures, rsgis::math::RSGISCalcDistMetric *calcDist, float distThreshold, rsgis::math::RSGISStatsSummary *mathSumStats);
-        void calcRATValue(size_t fid, double *inRealCols, unsigned int numInRealCols, int *inIntCols, unsigned int numInIntCols, std::string *inStringCols, unsigned int numInStringCols, double *outRealCols, unsigned int numOutRealCols, int *outIntCols, unsigned int numOutIntCols, std::string *outStringCols, unsigned int numOutStringCols);
-        void findKVals(std::list<std::pair<double, double*> > *kVals, double *featVals);
-        ~RSGISPerformKNNCalcValues();
-    private:
-        double **trainData;
-        size_t n;
-        size_t m;
-        unsigned int kFeatures;
-        rsgis::math::RSGISCalcDistMetric *calcDist;
-        float distThreshold;
-        rsgis::math::RSGISStatsSummary *mathSumStats;
-    };
-    
-    
-    
 }}
 
 #endif
@@ -49,6 +49,8 @@ namespace rsgis{namespace segment{
         
         GDALRasterBand *catagoryBand = catagories->GetRasterBand(1);
         GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
+        rsgis::img::RSGISImageTileCache<unsigned int> catCache(catagoryBand);
+        rsgis::img::RSGISImageTileCache<unsigned int> clumpCache(clumpBand, true);
         
         unsigned long clumpIdx = 1;
         std::vector<rsgis::img::PxlLoc> clumpPxls;
@@ -66,12 +68,12 @@ namespace rsgis{namespace segment{
             for(unsigned int j = 0; j < width; ++j)
             {
                 // Get pixel value from clump image for (j,i)
-                clumpBand->RasterIO(GF_Read, j, i, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                uiPxlVal = clumpCache.getValue(j, i);
                 
                 // if value is zero create new clump
                 if(uiPxlVal == 0) 
                 {
-                    catagoryBand->RasterIO(GF_Read, j, i, 1, 1, &catPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                    catPxlVal = catCache.getValue(j, i);
                     if((!noDataValProvided) | (noDataValProvided & (catPxlVal != noDataVal)))
                     {     
                         // Make sure all lists are empty.
@@ -91,7 +93,7 @@ namespace rsgis{namespace segment{
                             
                         clumpPxls.push_back(rsgis::img::PxlLoc(j, i));
                         clumpSearchPxls.push(rsgis::img::PxlLoc(j, i));
-                        clumpBand->RasterIO(GF_Write, j, i, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                        clumpCache.setValue(j, i, clumpIdx);
                         
                         // Add neigbouring pixels to clump.
                         // If no more pixels to add then stop.
@@ -103,32 +105,32 @@ namespace rsgis{namespace segment{
                             // Above
                             if(((long)pxl.yPos)-1 >= 0)
                             {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                uiPxlVal = clumpCache.getValue(pxl.xPos, pxl.yPos-1);
                                 if(uiPxlVal == 0)
                                 {
-                                    catagoryBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &catCPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                    catCPxlVal = catCache.getValue(pxl.xPos, pxl.yPos-1);
 
                                     if(catPxlVal == catCPxlVal)
                                     {
                                         clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
                                         clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                        clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos-1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                                        clumpCache.setValue(pxl.xPos, pxl.yPos-1, clumpIdx);
                                     }
                                 }
                             }
                             // Below
                             if((pxl.yPos+1) < height)
                             {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                uiPxlVal = clumpCache.getValue(pxl.xPos, pxl.yPos+1);
                                 if(uiPxlVal == 0)
                                 {
-                                    catagoryBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &catCPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                    catCPxlVal = catCache.getValue(pxl.xPos, pxl.yPos+1);
                                     
                                     if(catPxlVal == catCPxlVal)
                                     {
                                         clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
                                         clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                        clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos+1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                                        clumpCache.setValue(pxl.xPos, pxl.yPos+1, clumpIdx);
                                     }
                                 }
                                 
@@ -136,32 +138,32 @@ namespace rsgis{namespace segment{
                             // Left
                             if(((long)pxl.xPos)-1 >= 0)
                             {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                uiPxlVal = clumpCache.getValue(pxl.xPos-1, pxl.yPos);
                                 if(uiPxlVal == 0)
                                 {
-                                    catagoryBand->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &catCPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                    catCPxlVal = catCache.getValue(pxl.xPos-1, pxl.yPos);
                                     
                                     if(catPxlVal == catCPxlVal)
                                     {
                                         clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
                                         clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                        clumpBand->RasterIO(GF_Write, pxl.xPos-1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                                        clumpCache.setValue(pxl.xPos-1, pxl.yPos, clumpIdx);
                                     }
                                 }
                             }
                             // Right
                             if((pxl.xPos+1) < width)
                             {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                uiPxlVal = clumpCache.getValue(pxl.xPos+1, pxl.yPos);
                                 if(uiPxlVal == 0)
                                 {
-                                    catagoryBand->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &catCPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                    catCPxlVal = catCache.getValue(pxl.xPos+1, pxl.yPos);
                                     
                                     if(catPxlVal == catCPxlVal)
                                     {
                                         clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
                                         clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                        clumpBand->RasterIO(GF_Write, pxl.xPos+1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                                        clumpCache.setValue(pxl.xPos+1, pxl.yPos, clumpIdx);
                                     }
                                 }
                             }
@@ -172,6 +174,7 @@ namespace rsgis{namespace segment{
                 }
             }
         }
+        clumpCache.flush();
         pbar.finish();
         std::cout << "(Generated " << clumpIdx-1 << " clumps).\n";
         if(clumpPxlVals != NULL)
@@ -204,6 +207,8 @@ namespace rsgis{namespace segment{
         
         GDALRasterBand *catagoryBand = catagories->GetRasterBand(1);
         GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
+        rsgis::img::RSGISImageTileCache<unsigned int> catCache(catagoryBand);
+        rsgis::img::RSGISImageTileCache<unsigned int> clumpCache(clumpBand, true);
         
         unsigned long clumpIdx = 1;
         std::vector<rsgis::img::PxlLoc> clumpPxls;
@@ -221,12 +226,12 @@ namespace rsgis{namespace segment{
             for(unsigned int j = 0; j < width; ++j)
             {
                 // Get pixel value from clump image for (j,i)
-                clumpBand->RasterIO(GF_Read, j, i, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                uiPxlVal = clumpCache.getValue(j, i);
                 
                 // if value is zero create new clump
                 if(uiPxlVal == 0)
                 {
-                    catagoryBand->RasterIO(GF_Read, j, i, 1, 1, &catPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                    catPxlVal = catCache.getValue(j, i);
                     if(catPxlVal > 0)
                     {
                         // Make sure all lists are empty.
@@ -241,7 +246,7 @@ namespace rsgis{namespace segment{
                         
                         clumpPxls.push_back(rsgis::img::PxlLoc(j, i));
                         clumpSearchPxls.push(rsgis::img::PxlLoc(j, i));
-                        clumpBand->RasterIO(GF_Write, j, i, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                        clumpCache.setValue(j, i, clumpIdx);
                         
                         // Add neigbouring pixels to clump.
                         // If no more pixels to add then stop.
@@ -253,32 +258,32 @@ namespace rsgis{namespace segment{
                             // Above
                             if(((long)pxl.yPos)-1 >= 0)
                             {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                uiPxlVal = clumpCache.getValue(pxl.xPos, pxl.yPos-1);
                                 if(uiPxlVal == 0)
                                 {
-                                    catagoryBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &catCPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                    catCPxlVal = catCache.getValue(pxl.xPos, pxl.yPos-1);
                                     
                                     if(catPxlVal == catCPxlVal)
                                     {
                                         clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
                                         clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                        clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos-1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                                        clumpCache.setValue(pxl.xPos, pxl.yPos-1, clumpIdx);
                                     }
                                 }
                             }
                             // Below
                             if((pxl.yPos+1) < height)
                             {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                uiPxlVal = clumpCache.getValue(pxl.xPos, pxl.yPos+1);
                                 if(uiPxlVal == 0)
                                 {
-                                    catagoryBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &catCPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                    catCPxlVal = catCache.getValue(pxl.xPos, pxl.yPos+1);
                                     
                                     if(catPxlVal == catCPxlVal)
                                     {
                                         clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
                                         clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                        clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos+1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                                        clumpCache.setValue(pxl.xPos, pxl.yPos+1, clumpIdx);
                                     }
                                 }
                                 
@@ -286,32 +291,32 @@ namespace rsgis{namespace segment{
                             // Left
                             if(((long)pxl.xPos)-1 >= 0)
                             {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                uiPxlVal = clumpCache.getValue(pxl.xPos-1, pxl.yPos);
                                 if(uiPxlVal == 0)
                                 {
-                                    catagoryBand->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &catCPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                    catCPxlVal = catCache.getValue(pxl.xPos-1, pxl.yPos);
                                     
                                     if(catPxlVal == catCPxlVal)
                                     {
                                         clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
                                         clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                        clumpBand->RasterIO(GF_Write, pxl.xPos-1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                                        clumpCache.setValue(pxl.xPos-1, pxl.yPos, clumpIdx);
                                     }
                                 }
                             }
                             // Right
                             if((pxl.xPos+1) < width)
                             {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                uiPxlVal = clumpCache.getValue(pxl.xPos+1, pxl.yPos);
                                 if(uiPxlVal == 0)
                                 {
-                                    catagoryBand->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &catCPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                    catCPxlVal = catCache.getValue(pxl.xPos+1, pxl.yPos);
                                     
                                     if(catPxlVal == catCPxlVal)
                                     {
                                         clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
                                         clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                        clumpBand->RasterIO(GF_Write, pxl.xPos+1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                                        clumpCache.setValue(pxl.xPos+1, pxl.yPos, clumpIdx);
                                     }
                                 }
                             }
@@ -322,6 +327,7 @@ namespace rsgis{namespace segment{
                 }
             }
         }
+        clumpCache.flush();
         pbar.finish();
         std::cout << "(Generated " << clumpIdx-1 << " clumps).\n";
     }
@@ -402,6 +408,13 @@ namespace rsgis{namespace segment{
             //Get Image Output Band
 			GDALRasterBand *clumpBand = clumpsDS->GetRasterBand(1);
             clumpBand->SetDescription("Clumps");
+            
+            std::vector<rsgis::img::RSGISImageTileCache<unsigned int>*> catCaches;
+            for(unsigned int n = 0; n < numInBands; ++n)
+            {
+                catCaches.push_back(new rsgis::img::RSGISImageTileCache<unsigned int>(catBands[n], false, 268435456/numInBands));
+            }
+            rsgis::img::RSGISImageTileCache<unsigned int> clumpCache(clumpBand, true);
                         
             unsigned long clumpIdx = 1;
             std::vector<rsgis::img::PxlLoc> clumpPxls;
@@ -420,14 +433,14 @@ namespace rsgis{namespace segment{
                 for(unsigned int j = 0; j < width; ++j)
                 {
                     // Get pixel value from clump image for (j,i)
-                    clumpBand->RasterIO(GF_Read, j, i, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                    uiPxlVal = clumpCache.getValue(j, i);
                     
                     // if value is zero create new clump
                     if(uiPxlVal == 0)
                     {
                         for(unsigned int n = 0; n < numInBands; ++n)
                         {
-                            catBands[n]->RasterIO(GF_Read, bandOffsets[n][0]+j, bandOffsets[n][1]+i, 1, 1, &catPxlVals[n], 1, 1, GDT_UInt32, 0, 0);
+                            catPxlVals[n] = catCaches[n]->getValue(bandOffsets[n][0]+j, bandOffsets[n][1]+i);
                         }
                         
                         if((!noDataValProvided) | (noDataValProvided & (!this->allValueEqual(catPxlVals, numInBands, noDataVal))))
@@ -454,7 +467,7 @@ namespace rsgis{namespace segment{
                             
                             clumpPxls.push_back(rsgis::img::PxlLoc(j, i));
                             clumpSearchPxls.push(rsgis::img::PxlLoc(j, i));
-                            clumpBand->RasterIO(GF_Write, j, i, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                            clumpCache.setValue(j, i, clumpIdx);
                             
                             // Add neigbouring pixels to clump.
                             // If no more pixels to add then stop.
@@ -466,38 +479,38 @@ namespace rsgis{namespace segment{
                                 // Above
                                 if(((long)pxl.yPos)-1 >= 0)
                                 {
-                                    clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                    uiPxlVal = clumpCache.getValue(pxl.xPos, pxl.yPos-1);
                                     if(uiPxlVal == 0)
                                     {
                                         for(unsigned int n = 0; n < numInBands; ++n)
                                         {
-                                            catBands[n]->RasterIO(GF_Read, bandOffsets[n][0]+pxl.xPos, bandOffsets[n][1]+(pxl.yPos-1), 1, 1, &catCPxlVals[n], 1, 1, GDT_UInt32, 0, 0);
+                                            catCPxlVals[n] = catCaches[n]->getValue(bandOffsets[n][0]+pxl.xPos, bandOffsets[n][1]+(pxl.yPos-1));
                                         }
                                         
                                         if(this->allValueEqual(catPxlVals, catCPxlVals, numInBands))
                                         {
                                             clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
                                             clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                            clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos-1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                                            clumpCache.setValue(pxl.xPos, pxl.yPos-1, clumpIdx);
                                         }
                                     }
                                 }
                                 // Below
                                 if((pxl.yPos+1) < height)
                                 {
-                                    clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                    uiPxlVal = clumpCache.getValue(pxl.xPos, pxl.yPos+1);
                                     if(uiPxlVal == 0)
                                     {
                                         for(unsigned int n = 0; n < numInBands; ++n)
                                         {
-                                            catBands[n]->RasterIO(GF_Read, bandOffsets[n][0]+pxl.xPos, bandOffsets[n][1]+(pxl.yPos+1), 1, 1, &catCPxlVals[n], 1, 1, GDT_UInt32, 0, 0);
+                                            catCPxlVals[n] = catCaches[n]->getValue(bandOffsets[n][0]+pxl.xPos, bandOffsets[n][1]+(pxl.yPos+1));
                                         }
                                         
                                         if(this->allValueEqual(catPxlVals, catCPxlVals, numInBands))
                                         {
                                             clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
                                             clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                            clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos+1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                                            clumpCache.setValue(pxl.xPos, pxl.yPos+1, clumpIdx);
                                         }
                                     }
                                     
@@ -505,38 +518,38 @@ namespace rsgis{namespace segment{
                                 // Left
                                 if(((long)pxl.xPos)-1 >= 0)
                                 {
-                                    clumpBand->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                    uiPxlVal = clumpCache.getValue(pxl.xPos-1, pxl.yPos);
                                     if(uiPxlVal == 0)
                                     {
                                         for(unsigned int n = 0; n < numInBands; ++n)
                                         {
-                                            catBands[n]->RasterIO(GF_Read, bandOffsets[n][0]+(pxl.xPos-1), bandOffsets[n][1]+pxl.yPos, 1, 1, &catCPxlVals[n], 1, 1, GDT_UInt32, 0, 0);
+                                            catCPxlVals[n] = catCaches[n]->getValue(bandOffsets[n][0]+(pxl.xPos-1), bandOffsets[n][1]+pxl.yPos);
                                         }
                                         
                                         if(this->allValueEqual(catPxlVals, catCPxlVals, numInBands))
                                         {
                                             clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
                                             clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                            clumpBand->RasterIO(GF_Write, pxl.xPos-1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                                            clumpCache.setValue(pxl.xPos-1, pxl.yPos, clumpIdx);
                                         }
                                     }
                                 }
                                 // Right
                                 if((pxl.xPos+1) < width)
                                 {
-                                    clumpBand->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                                    uiPxlVal = clumpCache.getValue(pxl.xPos+1, pxl.yPos);
                                     if(uiPxlVal == 0)
                                     {
                                         for(unsigned int n = 0; n < numInBands; ++n)
                                         {
-                                            catBands[n]->RasterIO(GF_Read, bandOffsets[n][0]+(pxl.xPos+1), bandOffsets[n][1]+pxl.yPos, 1, 1, &catCPxlVals[n], 1, 1, GDT_UInt32, 0, 0);
+                                            catCPxlVals[n] = catCaches[n]->getValue(bandOffsets[n][0]+(pxl.xPos+1), bandOffsets[n][1]+pxl.yPos);
                                         }
                                         
                                         if(this->allValueEqual(catPxlVals, catCPxlVals, numInBands))
                                         {
                                             clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
                                             clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                            clumpBand->RasterIO(GF_Write, pxl.xPos+1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                                            clumpCache.setValue(pxl.xPos+1, pxl.yPos, clumpIdx);
                                         }
                                     }
                                 }
@@ -547,6 +560,11 @@ namespace rsgis{namespace segment{
                     }
                 }
             }
+            clumpCache.flush();
+            for(unsigned int n = 0; n < numInBands; ++n)
+            {
+                delete catCaches[n];
+            }
             pbar.finish();
             std::cout << "(Generated " << clumpIdx-1 << " clumps).\n";
             
@@ -34,6 +34,7 @@
 
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISImageCalcException.h"
+#include "img/RSGISImageTileCache.h"
 
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISCalcImage.h"
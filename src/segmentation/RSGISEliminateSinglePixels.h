@@ -34,8 +34,8 @@
 #include "img/RSGISImageCalcException.h"
 #include "math/RSGISMathsUtils.h"
 
-#include "img/RSGISCalcImageValue.h"
-#include "img/RSGISCalcImage.h"
+#include "img/RSGISImageTileCache.h"
+#include "img/RSGISSinglePxlElimination.h"
 
 #include "rastergis/RSGISRasterAttUtils.h"
 
@@ -65,61 +65,25 @@ namespace rsgis{namespace segment{
         void eliminate(GDALDataset *inSpecData, GDALDataset *inClumpsData, GDALDataset *tmpData, std::string outputImage, float noDataVal, bool noDataValProvided, bool projFromImage, std::string proj, std::string format);
         void eliminateBlocks(GDALDataset *inSpecData, GDALDataset *inClumpsData, GDALDataset *tmpData, std::string outputImage, float noDataVal, bool noDataValProvided, bool projFromImage, std::string proj, std::string format);
         ~RSGISEliminateSinglePixels();
-    private:
-        unsigned long findSinglePixels(GDALDataset *inClumpsData, GDALDataset *tmpData, float noDataVal, bool noDataValProvided);
-        bool eliminateSinglePixels(GDALDataset *inSpecData, GDALDataset *inClumpsData, GDALDataset *tmpData, GDALDataset *outDataset, float noDataVal, bool noDataValProvided);
-        inline float eucDistance(float **vals1, float **vals2, unsigned int numBands, unsigned int col1, unsigned int col2);
     };
     
-    
-    
-    class DllExport RSGISFindSinglePixels : public rsgis::img::RSGISCalcImageValue
-	{
-	public:
-		RSGISFindSinglePixels(float noDataVal, bool noDataValProvided);
-		void calcImageValue(float *bandValues, int numBands, double *output) {throw rsgis::img::RSGISImageCalcException("No implemented");};
-		void calcImageValue(float *bandValues, int numBands) {throw rsgis::img::RSGISImageCalcException("No implemented");};
-        void calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals) {throw rsgis::img::RSGISImageCalcException("Not implemented");};
-        void calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals, double *output) {throw rsgis::img::RSGISImageCalcException("Not implemented");};
-        void calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals, geos::geom::Envelope extent){throw rsgis::img::RSGISImageCalcException("Not implemented");};
-		void calcImageValue(float *bandValues, int numBands, geos::geom::Envelope extent) {throw rsgis::img::RSGISImageCalcException("No implemented");};
-		void calcImageValue(float *bandValues, int numBands, double *output, geos::geom::Envelope extent) {throw rsgis::img::RSGISImageCalcException("No implemented");};
-		void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
-        void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output, geos::geom::Envelope extent) {throw rsgis::img::RSGISImageCalcException("No implemented");};
-		bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output) {throw rsgis::img::RSGISImageCalcException("No implemented");};
-		void resetCount(){this->numSingles = 0;};
-        unsigned long getCount(){return this->numSingles;};
-        ~RSGISFindSinglePixels();
-    protected:
-        float noDataVal;
-        bool noDataValProvided;
-        unsigned long numSingles;
-	};
-    
-    
-    class DllExport RSGISElimSinglePixelsCalcImg : public rsgis::img::RSGISCalcImageValue
-	{
-	public:
-		RSGISElimSinglePixelsCalcImg(float noDataVal, bool noDataValProvided);
-		void calcImageValue(float *bandValues, int numBands, double *output) {throw rsgis::img::RSGISImageCalcException("No implemented");};
-		void calcImageValue(float *bandValues, int numBands) {throw rsgis::img::RSGISImageCalcException("No implemented");};
-        void calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals) {throw rsgis::img::RSGISImageCalcException("Not implemented");};
-        void calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals, double *output) {throw rsgis::img::RSGISImageCalcException("Not implemented");};
-        void calcImageValue(long *intBandValues, unsigned int numIntVals, float *floatBandValues, unsigned int numfloatVals, geos::geom::Envelope extent){throw rsgis::img::RSGISImageCalcException("Not implemented");};
-		void calcImageValue(float *bandValues, int numBands, geos::geom::Envelope extent) {throw rsgis::img::RSGISImageCalcException("No implemented");};
-		void calcImageValue(float *bandValues, int numBands, double *output, geos::geom::Envelope extent) {throw rsgis::img::RSGISImageCalcException("No implemented");};
-		void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output);
-        void calcImageValue(float ***dataBlock, int numBands, int winSize, double *output, geos::geom::Envelope extent) {throw rsgis::img::RSGISImageCalcException("No implemented");};
-		bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output) {throw rsgis::img::RSGISImageCalcException("No implemented");};
-		void resetChangeOccured(){this->hasChangeOccured = false;};
-        bool getChangeOccured(){return this->hasChangeOccured;};
-        ~RSGISElimSinglePixelsCalcImg();
+    /**
+     * Replaces a single pixel with the clump of the spectrally closest
+     * neighbour, ignoring neighbours where all the bands are no data.
+     */
+    class DllExport RSGISSpecDistSinglePxlReplacement : public rsgis::img::RSGISSinglePxlReplacement
+    {
+    public:
+        RSGISSpecDistSinglePxlReplacement(GDALDataset *inSpecData, float noDataVal, bool noDataValProvided);
+        bool findReplacement(unsigned int xPxl, unsigned int yPxl, unsigned int numNeighbours, const unsigned int *xNeighbours, const unsigned int *yNeighbours, const unsigned int *neighbourVals, unsigned int *outVal);
+        ~RSGISSpecDistSinglePxlReplacement();
     protected:
-        bool hasChangeOccured;
+        std::vector<rsgis::img::RSGISImageTileCache<float>*> specCaches;
+        unsigned int numBands;
+        float *pxlVals;
         float noDataVal;
         bool noDataValProvided;
-        inline float eucDistance(float *vals1, float *vals2, unsigned int numBands);
-	};
+    };
     
 }}
 
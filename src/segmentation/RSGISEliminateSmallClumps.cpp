@@ -29,7 +29,7 @@ namespace rsgis{namespace segment{
         
     }
     
-    void RSGISEliminateSmallClumps::eliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold) 
+    void RSGISEliminateSmallClumps::eliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, rsgis::rastergis::RSGISClumpChangeTracker *changes) 
     {
         if(spectral->GetRasterXSize() != clumps->GetRasterXSize())
         {
@@ -222,6 +222,11 @@ namespace rsgis{namespace segment{
                         // Update Clump Table
                         tClump = clumpTable->at(closestNeighbour-1);
                         
+                        if(changes != NULL)
+                        {
+                            changes->markClump(cClump->clumpID);
+                            changes->markClump(tClump->clumpID);
+                        }
                         for(size_t n = 0; n < cClump->pxls->size(); ++n)
                         {
                             tLoc = cClump->pxls->at(n);
@@ -262,6 +267,11 @@ namespace rsgis{namespace segment{
             {
                 if((*iterClumps)->active)
                 {
+                    if((changes != NULL) && changes->isClumpChanged((*iterClumps)->clumpID))
+                    {
+                        // All the pixels of a clump which has grown are needed to update its statistics.
+                        changes->markClumpPxls((*iterClumps)->clumpID, (*iterClumps)->pxls);
+                    }
                     delete (*iterClumps)->sumVals;
                     delete (*iterClumps)->meanVals;
                     delete (*iterClumps)->pxls;
@@ -281,7 +291,7 @@ namespace rsgis{namespace segment{
         delete[] spectralVals;
     }
     
-    void RSGISEliminateSmallClumps::stepwiseEliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail) 
+    void RSGISEliminateSmallClumps::stepwiseEliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail, rsgis::rastergis::RSGISClumpChangeTracker *changes) 
     {
         if(spectral->GetRasterXSize() != clumps->GetRasterXSize())
         {
@@ -515,6 +525,11 @@ namespace rsgis{namespace segment{
                 pair2Merge = mergeLookupTab.at(idx);
                 
                 closestNeighbour = pair2Merge.second->clumpID;
+                if(changes != NULL)
+                {
+                    changes->markClump(pair2Merge.first->clumpID);
+                    changes->markClump(pair2Merge.second->clumpID);
+                }
                 for(size_t n = 0; n < pair2Merge.first->pxls->size(); ++n)
                 {
                     tLoc = pair2Merge.first->pxls->at(n);
@@ -547,6 +562,11 @@ namespace rsgis{namespace segment{
             {
                 if((*iterClumps)->active)
                 {
+                    if((changes != NULL) && changes->isClumpChanged((*iterClumps)->clumpID))
+                    {
+                        // All the pixels of a clump which has grown are needed to update its statistics.
+                        changes->markClumpPxls((*iterClumps)->clumpID, (*iterClumps)->pxls);
+                    }
                     delete[] (*iterClumps)->sumVals;
                     delete[] (*iterClumps)->meanVals;
                     delete (*iterClumps)->pxls;
@@ -563,7 +583,7 @@ namespace rsgis{namespace segment{
         }
     }
     
-    void RSGISEliminateSmallClumps::stepwiseIterativeEliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail) 
+    void RSGISEliminateSmallClumps::stepwiseIterativeEliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail, rsgis::rastergis::RSGISClumpChangeTracker *changes) 
     {
         if(spectral->GetRasterXSize() != clumps->GetRasterXSize())
         {
@@ -806,6 +826,11 @@ namespace rsgis{namespace segment{
                     pair2Merge = mergeLookupTab.at(idx);
                     
                     closestNeighbour = pair2Merge.second->clumpID;
+                    if(changes != NULL)
+                    {
+                        changes->markClump(pair2Merge.first->clumpID);
+                        changes->markClump(pair2Merge.second->clumpID);
+                    }
                     for(size_t n = 0; n < pair2Merge.first->pxls->size(); ++n)
                     {
                         tLoc = pair2Merge.first->pxls->at(n);
@@ -863,6 +888,11 @@ namespace rsgis{namespace segment{
             {
                 if((*iterClumps)->active)
                 {
+                    if((changes != NULL) && changes->isClumpChanged((*iterClumps)->clumpID))
+                    {
+                        // All the pixels of a clump which has grown are needed to update its statistics.
+                        changes->markClumpPxls((*iterClumps)->clumpID, (*iterClumps)->pxls);
+                    }
                     delete[] (*iterClumps)->sumVals;
                     delete[] (*iterClumps)->meanVals;
                     delete (*iterClumps)->pxls;
@@ -879,7 +909,7 @@ namespace rsgis{namespace segment{
         }
     }
     
-    void RSGISEliminateSmallClumps::stepwiseEliminateSmallClumpsNoMean(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail) 
+    void RSGISEliminateSmallClumps::stepwiseEliminateSmallClumpsNoMean(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail, rsgis::rastergis::RSGISClumpChangeTracker *changes) 
     {
         if(spectral->GetRasterXSize() != clumps->GetRasterXSize())
         {
@@ -1093,6 +1123,11 @@ namespace rsgis{namespace segment{
                 pair2Merge = mergeLookupTab.at(idx);
                 
                 closestNeighbour = clumpTable[pair2Merge.second]->clumpID;
+                if(changes != NULL)
+                {
+                    changes->markClump(clumpTable[pair2Merge.first]->clumpID);
+                    changes->markClump(closestNeighbour);
+                }
                 for(size_t n = 0; n < clumpTable[pair2Merge.first]->pxls->size(); ++n)
                 {
                     tLoc = clumpTable[pair2Merge.first]->pxls->at(n);
@@ -1124,6 +1159,11 @@ namespace rsgis{namespace segment{
             {
                 if(clumpTable[i]->active)
                 {
+                    if((changes != NULL) && changes->isClumpChanged(clumpTable[i]->clumpID))
+                    {
+                        // All the pixels of a clump which has grown are needed to update its statistics.
+                        changes->markClumpPxls(clumpTable[i]->clumpID, clumpTable[i]->pxls);
+                    }
                     delete[] clumpTable[i]->sumVals;
                     delete clumpTable[i]->pxls;
                 }
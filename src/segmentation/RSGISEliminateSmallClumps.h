@@ -45,6 +45,7 @@
 #include "img/RSGISStretchImage.h"
 
 #include "rastergis/RSGISRasterAttUtils.h"
+#include "rastergis/RSGISClumpChangeTracker.h"
 
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
@@ -65,10 +66,10 @@ namespace rsgis{namespace segment{
     {
     public:
         RSGISEliminateSmallClumps();
-        void eliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold);
-        void stepwiseEliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail);
-        void stepwiseIterativeEliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail);
-        void stepwiseEliminateSmallClumpsNoMean(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail);
+        void eliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, rsgis::rastergis::RSGISClumpChangeTracker *changes=NULL);
+        void stepwiseEliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail, rsgis::rastergis::RSGISClumpChangeTracker *changes=NULL);
+        void stepwiseIterativeEliminateSmallClumps(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail, rsgis::rastergis::RSGISClumpChangeTracker *changes=NULL);
+        void stepwiseEliminateSmallClumpsNoMean(GDALDataset *spectral, GDALDataset *clumps, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail, rsgis::rastergis::RSGISClumpChangeTracker *changes=NULL);
         ~RSGISEliminateSmallClumps();
     };
     
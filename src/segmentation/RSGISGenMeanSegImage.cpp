@@ -25,475 +25,278 @@
 namespace rsgis{namespace segment{
     
     
-    RSGISGenMeanSegImage::RSGISGenMeanSegImage()
+    RSGISGenMeanSegImage::RSGISGenMeanSegImage(unsigned int numThreads)
     {
-        
+        this->numThreads = numThreads;
     }
     
     void RSGISGenMeanSegImage::generateMeanImage(GDALDataset *spectral, GDALDataset *clumps, GDALDataset *meanImg) 
     {
-        if((spectral->GetRasterXSize() != clumps->GetRasterXSize()) |
-           (spectral->GetRasterXSize() != meanImg->GetRasterXSize()))
+        try
         {
-            throw rsgis::img::RSGISImageCalcException("Widths are not the same");
+            if((spectral->GetRasterXSize() != clumps->GetRasterXSize()) |
+               (spectral->GetRasterXSize() != meanImg->GetRasterXSize()))
+            {
+                throw rsgis::img::RSGISImageCalcException("Widths are not the same");
+            }
+            if((spectral->GetRasterYSize() != clumps->GetRasterYSize()) |
+               (spectral->GetRasterYSize() != meanImg->GetRasterYSize()))
+            {
+                throw rsgis::img::RSGISImageCalcException("Heights are not the same");
+            }
+            if(spectral->GetRasterCount() != meanImg->GetRasterCount())
+            {
+                throw rsgis::img::RSGISImageCalcException("The number of bands is not the same");
+            }
+            
+            std::cout << "Calculating the clump means\n";
+            std::vector<double> meanLUT;
+            this->calcClumpMeans(spectral, clumps, &meanLUT);
+            
+            std::cout << "Applying Look up table.\n";
+            this->applyMeanLUT(clumps, meanLUT, meanImg);
         }
-        if((spectral->GetRasterYSize() != clumps->GetRasterYSize()) |
-           (spectral->GetRasterYSize() != meanImg->GetRasterYSize()))
+        catch(rsgis::img::RSGISImageCalcException &e)
         {
-            throw rsgis::img::RSGISImageCalcException("Heights are not the same");
+            throw e;
         }
-        
-        if(spectral->GetRasterCount() != meanImg->GetRasterCount())
+        catch (rsgis::RSGISException &e)
         {
-            throw rsgis::img::RSGISImageCalcException("The number of bands is not the same");
+            throw rsgis::img::RSGISImageCalcException(e.what());
         }
-        
-        rsgis::img::RSGISImageUtils imgUtils;
-        imgUtils.zerosFloatGDALDataset(meanImg);
-        
-        unsigned int width = spectral->GetRasterXSize();
-        unsigned int height = spectral->GetRasterYSize();
-        unsigned int numSpecBands = spectral->GetRasterCount();
-        
-        bool **pxlMask = new bool*[height];
-        for(unsigned int i = 0; i < height; ++i)
+    }
+    
+    void RSGISGenMeanSegImage::generateMeanImageUsingClumpTable(GDALDataset *spectral, GDALDataset *clumps, GDALDataset *meanImg) 
+    {
+        this->generateMeanImage(spectral, clumps, meanImg);
+    }
+    
+    void RSGISGenMeanSegImage::generateMeanImageUsingCalcImage(GDALDataset *spectral, GDALDataset *clumps, GDALDataset *meanImg) 
+    {
+        this->generateMeanImage(spectral, clumps, meanImg);
+    }
+    
+    void RSGISGenMeanSegImage::populateRATMeans(GDALDataset *spectral, GDALDataset *clumps)
+    {
+        try
         {
-            pxlMask[i] = new bool[width];
-            for(unsigned int j = 0; j < width; ++j)
+            if((spectral->GetRasterXSize() != clumps->GetRasterXSize()) | (spectral->GetRasterYSize() != clumps->GetRasterYSize()))
             {
-                pxlMask[i][j] = false;
+                throw rsgis::img::RSGISImageCalcException("The spectral and clumps images are not the same size.");
             }
+            std::vector<double> meanLUT;
+            this->calcClumpMeans(spectral, clumps, &meanLUT);
+            this->writeRATMeans(clumps, spectral->GetRasterCount(), meanLUT);
         }
-        
-        GDALRasterBand **spectralBands = new GDALRasterBand*[numSpecBands];
-        GDALRasterBand **meanBands = new GDALRasterBand*[numSpecBands];
-        for(unsigned int n = 0; n < numSpecBands; ++n)
-        {
-            spectralBands[n] = spectral->GetRasterBand(n+1);
-            meanBands[n] = meanImg->GetRasterBand(n+1);
-        }
-        GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
-        
-        unsigned long clumpIdx = 0;
-        unsigned int uiPxlVal = 0;
-        std::vector<rsgis::img::PxlLoc> clumpPxls;
-        std::queue<rsgis::img::PxlLoc> clumpSearchPxls;
-        std::vector<float> *clumpSpecPxlVals = new std::vector<float>[numSpecBands];
-        float *specPxlVals = new float[numSpecBands];
-        
-        rsgis_tqdm pbar;
-        for(unsigned int i = 0; i < height; ++i)
+        catch(rsgis::img::RSGISImageCalcException &e)
         {
-            pbar.progress(i, height);
-            
-            for(unsigned int j = 0; j < width; ++j)
-            {
-                // Get pixel value from clump image for (j,i)
-                if(!pxlMask[i][j])
-                {
-                    clumpBand->RasterIO(GF_Read, j, i, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                    
-                    // Make sure all lists are empty.
-                    clumpPxls.clear();
-                    if(!clumpSearchPxls.empty())
-                    {
-                        while(clumpSearchPxls.size() > 0)
-                        {
-                            clumpSearchPxls.pop();
-                        }
-                    }
-                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                    {
-                        clumpSpecPxlVals[n].clear();
-                        spectralBands[n]->RasterIO(GF_Read, j, i, 1, 1, &specPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                        clumpSpecPxlVals[n].push_back(specPxlVals[n]);
-                    }
-                    clumpPxls.push_back(rsgis::img::PxlLoc(j, i));
-                    clumpSearchPxls.push(rsgis::img::PxlLoc(j, i));
-                    pxlMask[i][j] = true;
-                    
-                    // Add neigbouring pixels to clump.
-                    // If no more pixels to add then stop.
-                    while(clumpSearchPxls.size() > 0)
-                    {
-                        rsgis::img::PxlLoc pxl = clumpSearchPxls.front();
-                        clumpSearchPxls.pop();
-                        
-                        // Above
-                        if((((long)pxl.yPos)-1 >= 0) && (!pxlMask[pxl.yPos-1][pxl.xPos]))
-                        {
-                            clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                            if(uiPxlVal == clumpIdx)
-                            {
-                                for(unsigned int n = 0; n < numSpecBands; ++n)
-                                {
-                                    spectralBands[n]->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &specPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                                }
-                                                            
-                                clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                for(unsigned int n = 0; n < numSpecBands; ++n)
-                                {
-                                    clumpSpecPxlVals[n].push_back(specPxlVals[n]);
-                                }
-                                pxlMask[pxl.yPos-1][pxl.xPos] = true;
-                            }
-                        }
-                        // Below
-                        if((((long)pxl.yPos)+1 < height) && (!pxlMask[pxl.yPos+1][pxl.xPos]))
-                        {
-                            clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                            if(uiPxlVal == clumpIdx)
-                            {
-                                for(unsigned int n = 0; n < numSpecBands; ++n)
-                                {
-                                    spectralBands[n]->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &specPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                                }
-                                
-                                clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                for(unsigned int n = 0; n < numSpecBands; ++n)
-                                {
-                                    clumpSpecPxlVals[n].push_back(specPxlVals[n]);
-                                }
-                                pxlMask[pxl.yPos+1][pxl.xPos] = true;
-                            }
-                        }
-                        // Left
-                        if((((long)pxl.xPos-1) >= 0) && (!pxlMask[pxl.yPos][pxl.xPos-1]))
-                        {
-                            clumpBand->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                            if(uiPxlVal == clumpIdx)
-                            {
-                                for(unsigned int n = 0; n < numSpecBands; ++n)
-                                {
-                                    spectralBands[n]->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &specPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                                }
-                                
-                                clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                for(unsigned int n = 0; n < numSpecBands; ++n)
-                                {
-                                    clumpSpecPxlVals[n].push_back(specPxlVals[n]);
-                                }
-                                pxlMask[pxl.yPos][pxl.xPos-1] = true;
-                            }
-                        }
-                        // Right
-                        if((((long)pxl.xPos+1) < width) && (!pxlMask[pxl.yPos][pxl.xPos+1]))
-                        {
-                            clumpBand->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                            if(uiPxlVal == clumpIdx)
-                            {
-                                for(unsigned int n = 0; n < numSpecBands; ++n)
-                                {
-                                    spectralBands[n]->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &specPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                                }
-                                
-                                clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                for(unsigned int n = 0; n < numSpecBands; ++n)
-                                {
-                                    clumpSpecPxlVals[n].push_back(specPxlVals[n]);
-                                }
-                                pxlMask[pxl.yPos][pxl.xPos+1] = true;
-                            }
-                        }
-                    }
-                    
-                    // Calc Mean Values;
-                    for(size_t n = 0; n < clumpPxls.size(); ++n)
-                    {
-                        for(unsigned int b = 0; b < numSpecBands; ++b)
-                        {
-                            if(n == 0)
-                            {
-                                specPxlVals[b] = clumpSpecPxlVals[b][n];
-                            }
-                            else
-                            {
-                                specPxlVals[b] += clumpSpecPxlVals[b][n];
-                            }
-                        }
-                    }
-                    
-                    for(unsigned int b = 0; b < numSpecBands; ++b)
-                    {
-                        specPxlVals[b] = specPxlVals[b]/clumpPxls.size();
-                    }
-                    
-                    for(size_t n = 0; n < clumpPxls.size(); ++n)
-                    {
-                        for(unsigned int b = 0; b < numSpecBands; ++b)
-                        {
-                            meanBands[b]->RasterIO(GF_Write, clumpPxls[n].xPos, clumpPxls[n].yPos, 1, 1, &specPxlVals[b], 1, 1, GDT_Float32, 0, 0);
-                        }
-                    }
-                }
-            }
+            throw e;
         }
-        pbar.finish();
-        
-        delete[] clumpSpecPxlVals;
-        delete[] specPxlVals;
-        delete[] meanBands;
-        delete[] spectralBands;
-        
-        for(unsigned int i = 0; i < height; ++i)
+        catch (rsgis::RSGISException &e)
         {
-            delete[] pxlMask[i];
+            throw rsgis::img::RSGISImageCalcException(e.what());
         }
-        delete[] pxlMask;
     }
     
-    void RSGISGenMeanSegImage::generateMeanImageUsingClumpTable(GDALDataset *spectral, GDALDataset *clumps, GDALDataset *meanImg) 
+    void RSGISGenMeanSegImage::writeRATMeans(GDALDataset *clumps, unsigned int numSpecBands, const std::vector<double> &meanLUT)
     {
-        if((spectral->GetRasterXSize() != clumps->GetRasterXSize()) |
-           (spectral->GetRasterXSize() != meanImg->GetRasterXSize()))
+        GDALRasterAttributeTable *rat = clumps->GetRasterBand(1)->GetDefaultRAT();
+        if(rat == NULL)
         {
-            throw rsgis::img::RSGISImageCalcException("Widths are not the same");
+            throw rsgis::img::RSGISImageCalcException("The clumps image does not have an attribute table.");
         }
-        if((spectral->GetRasterYSize() != clumps->GetRasterYSize()) |
-           (spectral->GetRasterYSize() != meanImg->GetRasterYSize()))
+        size_t numRows = meanLUT.size() / numSpecBands;
+        if(rat->GetRowCount() < ((int)numRows))
         {
-            throw rsgis::img::RSGISImageCalcException("Heights are not the same");
+            rat->SetRowCount(numRows);
         }
         
-        if(spectral->GetRasterCount() != meanImg->GetRasterCount())
+        rsgis::rastergis::RSGISRasterAttUtils ratUtils;
+        std::vector<double> colVals(rat->GetRowCount(), 0.0);
+        for(unsigned int n = 0; n < numSpecBands; ++n)
         {
-            throw rsgis::img::RSGISImageCalcException("The number of bands is not the same");
+            for(size_t i = 0; i < numRows; ++i)
+            {
+                colVals[i] = meanLUT[(i * numSpecBands) + n];
+            }
+            unsigned int colIdx = ratUtils.findColumnIndexOrCreate(rat, "b" + std::to_string(n+1) + "Mean", GFT_Real);
+            if(rat->ValuesIO(GF_Write, colIdx, 0, colVals.size(), colVals.data()) != CE_None)
+            {
+                throw rsgis::img::RSGISImageCalcException("Could not write the clump means to the attribute table.");
+            }
         }
-        
-        rsgis::img::RSGISImageUtils imgUtils;
-        imgUtils.zerosFloatGDALDataset(meanImg);
-        
+    }
+    
+    void RSGISGenMeanSegImage::calcClumpMeans(GDALDataset *spectral, GDALDataset *clumps, std::vector<double> *meanLUT)
+    {
         unsigned int width = spectral->GetRasterXSize();
         unsigned int height = spectral->GetRasterYSize();
         unsigned int numSpecBands = spectral->GetRasterCount();
+        unsigned int stripRows = this->calcStripRows(spectral, numSpecBands + 1);
+        size_t numStrips = (height + stripRows - 1) / stripRows;
         
-        unsigned int *clumpIdxs = new unsigned int[width];
-        float **spectralVals = new float*[numSpecBands];
+        rsgis::img::RSGISImageThreadUtils threadUtils;
+        unsigned int numThreads = threadUtils.getNumThreads(this->numThreads);
+        std::vector<GDALDataset*> specHandles = threadUtils.openDatasetHandles(spectral, numThreads);
+        std::vector<GDALDataset*> clumpHandles = threadUtils.openDatasetHandles(clumps, numThreads);
+        numThreads = std::min(specHandles.size(), clumpHandles.size());
         
-        GDALRasterBand **spectralBands = new GDALRasterBand*[numSpecBands];
-        GDALRasterBand **meanBands = new GDALRasterBand*[numSpecBands];
-        for(unsigned int n = 0; n < numSpecBands; ++n)
-        {
-            spectralBands[n] = spectral->GetRasterBand(n+1);
-            meanBands[n] = meanImg->GetRasterBand(n+1);
-            spectralVals[n] = new float[width]; 
-        }
-        GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
-
-        unsigned long maxClumpIdx = 0;
-        for(unsigned int i = 0; i < height; ++i)
+        // Each thread sums into its own arrays, which are added together at the end.
+        std::vector<std::vector<double> > sumVals(numThreads);
+        std::vector<std::vector<unsigned long> > numPxls(numThreads);
+        try
         {
-            clumpBand->RasterIO(GF_Read, 0, i, width, 1, clumpIdxs, width, 1, GDT_UInt32, 0, 0);
-            for(unsigned int j = 0; j < width; ++j)
+            threadUtils.runTasks(numThreads, numStrips, [&](unsigned int threadIdx, size_t strip)
             {
-                if((i == 0) & (j == 0))
+                unsigned int startRow = strip * stripRows;
+                unsigned int numRows = std::min(stripRows, height - startRow);
+                size_t numStripPxls = ((size_t)width) * numRows;
+                
+                std::vector<unsigned int> clumpVals(numStripPxls);
+                std::vector<float> specVals(numStripPxls * numSpecBands);
+                if(clumpHandles[threadIdx]->GetRasterBand(1)->RasterIO(GF_Read, 0, startRow, width, numRows, clumpVals.data(), width, numRows, GDT_UInt32, 0, 0) != CE_None)
                 {
-                    maxClumpIdx = clumpIdxs[j];
+                    throw rsgis::img::RSGISImageCalcException("Failed to read the clumps image.");
                 }
-                else if(clumpIdxs[j] > maxClumpIdx)
+                if(specHandles[threadIdx]->RasterIO(GF_Read, 0, startRow, width, numRows, specVals.data(), width, numRows, GDT_Float32, numSpecBands, NULL, sizeof(float) * numSpecBands, sizeof(float) * numSpecBands * width, sizeof(float)) != CE_None)
                 {
-                    maxClumpIdx = clumpIdxs[j];
+                    throw rsgis::img::RSGISImageCalcException("Failed to read the spectral image.");
                 }
-            }
-        }
-        
-        std::vector<rsgis::img::ImgClumpMean*> *clumpTab = new std::vector<rsgis::img::ImgClumpMean*>();
-        clumpTab->reserve(maxClumpIdx);
-        rsgis::img::ImgClumpMean *cClump;
-        for(unsigned int i = 0; i < maxClumpIdx; ++i)
-        {
-            cClump = new rsgis::img::ImgClumpMean(i+1);
-            cClump->sumVals = new float[numSpecBands];
-            cClump->meanVals = new float[numSpecBands];
-            for(unsigned int n = 0; n < numSpecBands; ++n)
-            {
-                cClump->sumVals[n] = 0;
-                cClump->meanVals[n] = 0;
-            }
-            clumpTab->push_back(cClump);
-        }
-        
-        for(unsigned int i = 0; i < height; ++i)
-        {
-            clumpBand->RasterIO(GF_Read, 0, i, width, 1, clumpIdxs, width, 1, GDT_UInt32, 0, 0);
-            for(unsigned int n = 0; n < numSpecBands; ++n)
-            {
-                spectralBands[n]->RasterIO(GF_Read, 0, i, width, 1, spectralVals[n], width, 1, GDT_Float32, 0, 0);
-            }
-            for(unsigned int j = 0; j < width; ++j)
-            {
-                if(clumpIdxs[j] != 0)
+                unsigned int maxClump = *std::max_element(clumpVals.begin(), clumpVals.end());
+                
+                std::vector<double> &threadSums = sumVals[threadIdx];
+                std::vector<unsigned long> &threadPxls = numPxls[threadIdx];
+                if(threadPxls.size() <= maxClump)
                 {
-                    cClump = clumpTab->at(clumpIdxs[j] - 1);
-                    for(unsigned int n = 0; n < numSpecBands; ++n)
+                    threadPxls.resize(((size_t)maxClump) + 1, 0);
+                    threadSums.resize(threadPxls.size() * numSpecBands, 0.0);
+                }
+                for(size_t i = 0; i < numStripPxls; ++i)
+                {
+                    if(clumpVals[i] > 0)
                     {
-                        cClump->sumVals[n] += spectralVals[n][j];
+                        double *clumpSums = &threadSums[((size_t)clumpVals[i]) * numSpecBands];
+                        const float *pxlVals = &specVals[i * numSpecBands];
+                        for(unsigned int n = 0; n < numSpecBands; ++n)
+                        {
+                            clumpSums[n] += pxlVals[n];
+                        }
+                        ++threadPxls[clumpVals[i]];
                     }
-                    ++cClump->numPxls;
                 }
-            }
+            });
         }
-        
-        for(std::vector<rsgis::img::ImgClumpMean*>::iterator iterClumps = clumpTab->begin(); iterClumps != clumpTab->end(); ++iterClumps)
+        catch(rsgis::RSGISException &e)
         {
-            for(unsigned int n = 0; n < numSpecBands; ++n)
-            {
-                (*iterClumps)->meanVals[n] = (*iterClumps)->sumVals[n] / (*iterClumps)->numPxls;
-            }
+            threadUtils.closeDatasetHandles(&specHandles);
+            threadUtils.closeDatasetHandles(&clumpHandles);
+            throw rsgis::img::RSGISImageCalcException(e.what());
         }
+        threadUtils.closeDatasetHandles(&specHandles);
+        threadUtils.closeDatasetHandles(&clumpHandles);
         
-        for(unsigned int i = 0; i < height; ++i)
+        size_t numClumps = 0;
+        for(unsigned int t = 0; t < numThreads; ++t)
         {
-            clumpBand->RasterIO(GF_Read, 0, i, width, 1, clumpIdxs, width, 1, GDT_UInt32, 0, 0);
-            
-            for(unsigned int j = 0; j < width; ++j)
+            numClumps = std::max(numClumps, numPxls[t].size());
+        }
+        std::vector<double> totalSums(numClumps * numSpecBands, 0.0);
+        std::vector<unsigned long> totalPxls(numClumps, 0);
+        for(unsigned int t = 0; t < numThreads; ++t)
+        {
+            for(size_t i = 0; i < numPxls[t].size(); ++i)
             {
-                if(clumpIdxs[j] != 0)
-                {
-                    cClump = clumpTab->at(clumpIdxs[j] - 1);
-                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                    {
-                        spectralVals[n][j] = cClump->meanVals[n];
-                    }
-                }
-                else
-                {
-                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                    {
-                        spectralVals[n][j] = 0;
-                    }
-                }
+                totalPxls[i] += numPxls[t][i];
             }
-            
-            for(unsigned int n = 0; n < numSpecBands; ++n)
+            for(size_t i = 0; i < sumVals[t].size(); ++i)
             {
-                meanBands[n]->RasterIO(GF_Write, 0, i, width, 1, spectralVals[n], width, 1, GDT_Float32, 0, 0);
+                totalSums[i] += sumVals[t][i];
             }
+            std::vector<double>().swap(sumVals[t]);
+            std::vector<unsigned long>().swap(numPxls[t]);
         }
         
-        
-        delete[] clumpIdxs;
-        for(unsigned int n = 0; n < numSpecBands; ++n)
-        {
-            delete[] spectralVals[n];
-        }
-        delete[] spectralVals;
-        
-        delete[] spectralBands;
-        delete[] meanBands;
-        
-        for(std::vector<rsgis::img::ImgClumpMean*>::iterator iterClumps = clumpTab->begin(); iterClumps != clumpTab->end(); ++iterClumps)
+        meanLUT->assign(totalSums.size(), 0.0);
+        for(size_t i = 1; i < numClumps; ++i)
         {
-            delete[] (*iterClumps)->meanVals;
-            delete[] (*iterClumps)->sumVals;
-            delete *iterClumps;
+            if(totalPxls[i] > 0)
+            {
+                for(unsigned int n = 0; n < numSpecBands; ++n)
+                {
+                    (*meanLUT)[(i * numSpecBands) + n] = totalSums[(i * numSpecBands) + n] / totalPxls[i];
+                }
+            }
         }
-        delete clumpTab;
     }
     
-    void RSGISGenMeanSegImage::generateMeanImageUsingCalcImage(GDALDataset *spectral, GDALDataset *clumps, GDALDataset *meanImg) 
+    void RSGISGenMeanSegImage::applyMeanLUT(GDALDataset *clumps, const std::vector<double> &meanLUT, GDALDataset *meanImg)
     {
+        unsigned int width = clumps->GetRasterXSize();
+        unsigned int height = clumps->GetRasterYSize();
+        unsigned int numSpecBands = meanImg->GetRasterCount();
+        size_t numLUTRows = meanLUT.size() / numSpecBands;
+        unsigned int stripRows = this->calcStripRows(clumps, numSpecBands + 1);
+        size_t numStrips = (height + stripRows - 1) / stripRows;
+        
+        rsgis::img::RSGISImageThreadUtils threadUtils;
+        std::vector<GDALDataset*> clumpHandles = threadUtils.openDatasetHandles(clumps, threadUtils.getNumThreads(this->numThreads));
+        std::mutex writeMutex;
         try
         {
-            if((spectral->GetRasterXSize() != clumps->GetRasterXSize()) |
-               (spectral->GetRasterXSize() != meanImg->GetRasterXSize()))
-            {
-                throw rsgis::img::RSGISImageCalcException("Widths are not the same");
-            }
-            if((spectral->GetRasterYSize() != clumps->GetRasterYSize()) |
-               (spectral->GetRasterYSize() != meanImg->GetRasterYSize()))
-            {
-                throw rsgis::img::RSGISImageCalcException("Heights are not the same");
-            }
-            if(spectral->GetRasterCount() != meanImg->GetRasterCount())
-            {
-                throw rsgis::img::RSGISImageCalcException("The number of bands is not the same");
-            }
-            rsgis::rastergis::RSGISRasterAttUtils ratUtils;
-            
-            std::cout << "Finding maximum image value\n";
-            long maxVal = 0;
-            long minVal = 0;
-            ratUtils.getImageBandMinMax(clumps, 1, &minVal, &maxVal);
-            
-            unsigned int maxClumpIdx = boost::lexical_cast<unsigned long>(maxVal);
-            
-            unsigned int numSpecBands = spectral->GetRasterCount();
-                        
-            std::vector<rsgis::img::ImgClumpMean*> *clumpTable = new std::vector<rsgis::img::ImgClumpMean*>();
-            clumpTable->reserve(maxClumpIdx);
-            
-            std::cout << "Build clump table\n";
-            rsgis::img::ImgClumpMean *cClump = NULL;
-            for(unsigned int i = 0; i < maxClumpIdx; ++i)
+            threadUtils.runTasks(clumpHandles.size(), numStrips, [&](unsigned int threadIdx, size_t strip)
             {
-                cClump = new rsgis::img::ImgClumpMean(i+1);
-                cClump->sumVals = new float[numSpecBands];
-                cClump->meanVals = new float[numSpecBands];
-                cClump->numPxls = 0;
-                for(unsigned int n = 0; n < numSpecBands; ++n)
+                unsigned int startRow = strip * stripRows;
+                unsigned int numRows = std::min(stripRows, height - startRow);
+                size_t numStripPxls = ((size_t)width) * numRows;
+                
+                std::vector<unsigned int> clumpVals(numStripPxls);
+                if(clumpHandles[threadIdx]->GetRasterBand(1)->RasterIO(GF_Read, 0, startRow, width, numRows, clumpVals.data(), width, numRows, GDT_UInt32, 0, 0) != CE_None)
                 {
-                    cClump->sumVals[n] = 0;
-                    cClump->meanVals[n] = 0;
+                    throw rsgis::img::RSGISImageCalcException("Failed to read the clumps image.");
                 }
-                clumpTable->push_back(cClump);
-            }
-            
-            std::cout << "Creating Look up table.\n";
-            RSGISPopulateMeans *createLookUp = new RSGISPopulateMeans(clumpTable, numSpecBands, maxClumpIdx);
-            rsgis::img::RSGISCalcImage calcImgCreateLoopUp = rsgis::img::RSGISCalcImage(createLookUp);
-            GDALDataset **datasets = new GDALDataset*[2];
-            datasets[0] = clumps;
-            datasets[1] = spectral;
-            calcImgCreateLoopUp.calcImage(datasets, 2);
-            delete createLookUp;
-            
-            
-            
-            //for(unsigned int i = 0; i < maxClumpIdx; ++i)
-            for(std::vector<rsgis::img::ImgClumpMean*>::iterator iterClump = clumpTable->begin(); iterClump != clumpTable->end(); ++iterClump)
-            {
-                for(unsigned int n = 0; n < numSpecBands; ++n)
+                
+                // Clump 0 (and any clump without a mean) is given 0.
+                std::vector<float> outVals(numStripPxls * numSpecBands);
+                for(size_t i = 0; i < numStripPxls; ++i)
                 {
-                    (*iterClump)->meanVals[n] = (*iterClump)->sumVals[n]/(*iterClump)->numPxls;
+                    size_t lutRow = (clumpVals[i] < numLUTRows)?clumpVals[i]:0;
+                    const double *clumpMeans = &meanLUT[lutRow * numSpecBands];
+                    for(unsigned int n = 0; n < numSpecBands; ++n)
+                    {
+                        outVals[(n * numStripPxls) + i] = clumpMeans[n];
+                    }
                 }
-            }
-            
-            std::cout << "Applying Look up table.\n";
-            RSGISApplyMeans2Output *applyMeansLookUp = new RSGISApplyMeans2Output(clumpTable, numSpecBands, maxClumpIdx);
-            rsgis::img::RSGISCalcImage calcImgApplyLookUp = rsgis::img::RSGISCalcImage(applyMeansLookUp);
-            calcImgApplyLookUp.calcImage(datasets, 2, meanImg);
-            delete applyMeansLookUp;
-            delete[] datasets;
-            
-            for(std::vector<rsgis::img::ImgClumpMean*>::iterator iterClump = clumpTable->begin(); iterClump != clumpTable->end(); ++iterClump)
-            {
-                delete[] (*iterClump)->meanVals;
-                delete[] (*iterClump)->sumVals;
-                delete (*iterClump);
-            }
-            delete clumpTable;
-            
-        }
-        catch(rsgis::img::RSGISImageCalcException &e)
-        {
-            throw e;
+                
+                std::lock_guard<std::mutex> lock(writeMutex);
+                if(meanImg->RasterIO(GF_Write, 0, startRow, width, numRows, outVals.data(), width, numRows, GDT_Float32, numSpecBands, NULL, 0, 0, 0) != CE_None)
+                {
+                    throw rsgis::img::RSGISImageCalcException("Failed to write the mean image.");
+                }
+            }, true);
         }
-        catch (rsgis::RSGISException &e)
+        catch(rsgis::RSGISException &e)
         {
+            threadUtils.closeDatasetHandles(&clumpHandles);
             throw rsgis::img::RSGISImageCalcException(e.what());
         }
-        catch (std::exception &e)
+        threadUtils.closeDatasetHandles(&clumpHandles);
+    }
+    
+    unsigned int RSGISGenMeanSegImage::calcStripRows(GDALDataset *dataset, unsigned int numVals)
+    {
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        dataset->GetRasterBand(1)->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int height = dataset->GetRasterYSize();
+        unsigned int stripRows = std::max(yBlockSize, 1);
+        unsigned int yStep = stripRows;
+        while(((((size_t)stripRows) * dataset->GetRasterXSize() * numVals) < 2097152) && (stripRows < height))
         {
-            throw rsgis::img::RSGISImageCalcException(e.what());
+            stripRows += yStep;
         }
+        return stripRows;
     }
     
-    
     RSGISGenMeanSegImage::~RSGISGenMeanSegImage()
     {
         
@@ -27,6 +27,8 @@
 #include <string>
 #include <vector>
 #include <queue>
+#include <mutex>
+#include <algorithm>
 #include <math.h>
 
 #include "gdal_priv.h"
@@ -37,6 +39,7 @@
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISCalcImage.h"
+#include "img/RSGISImageThreadUtils.h"
 
 #include "rastergis/RSGISRasterAttUtils.h"
 
@@ -55,14 +58,30 @@
 
 namespace rsgis{namespace segment{
     
+    /**
+     * Generates an image where each pixel takes the mean spectral values of
+     * its clump. The clump means are calculated in one streaming pass over the
+     * spectral and clumps images and the look up table is then applied to the
+     * clumps in parallel strips. The clumps are only read.
+     *
+     * populateRATMeans writes the same means to the clumps RAT (columns b1Mean,
+     * b2Mean, ...), replacing any existing values.
+     */
     class DllExport RSGISGenMeanSegImage
     {
     public:
-        RSGISGenMeanSegImage();
+        RSGISGenMeanSegImage(unsigned int numThreads=0);
         void generateMeanImage(GDALDataset *spectral, GDALDataset *clumps, GDALDataset *meanImg);
         void generateMeanImageUsingClumpTable(GDALDataset *spectral, GDALDataset *clumps, GDALDataset *meanImg);
         void generateMeanImageUsingCalcImage(GDALDataset *spectral, GDALDataset *clumps, GDALDataset *meanImg);
+        void populateRATMeans(GDALDataset *spectral, GDALDataset *clumps);
         ~RSGISGenMeanSegImage();
+    protected:
+        void writeRATMeans(GDALDataset *clumps, unsigned int numSpecBands, const std::vector<double> &meanLUT);
+        void calcClumpMeans(GDALDataset *spectral, GDALDataset *clumps, std::vector<double> *meanLUT);
+        void applyMeanLUT(GDALDataset *clumps, const std::vector<double> &meanLUT, GDALDataset *meanImg);
+        unsigned int calcStripRows(GDALDataset *dataset, unsigned int numVals);
+        unsigned int numThreads;
     };
     
     
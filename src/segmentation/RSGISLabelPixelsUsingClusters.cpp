@@ -26,9 +26,9 @@
 namespace rsgis{namespace segment{
     
 
-    RSGISLabelPixelsUsingClusters::RSGISLabelPixelsUsingClusters()
+    RSGISLabelPixelsUsingClusters::RSGISLabelPixelsUsingClusters(unsigned int numThreads)
     {
-        
+        this->numThreads = numThreads;
     }
     
     void RSGISLabelPixelsUsingClusters::labelPixelsUsingClusters(GDALDataset **datasets, int numDatasets, std::string output, std::string clusterCentresFile, bool ignoreZeros, std::string imageFormat, bool useImageProj, std::string outProjStr)
@@ -38,14 +38,35 @@ namespace rsgis{namespace segment{
             rsgis::math::RSGISMatrices matrixUtils;
             rsgis::math::Matrix *clusterCentres = matrixUtils.readMatrixFromGridTxt(clusterCentresFile);
             
-            std::string *bandNames = new std::string[1];
-            bandNames[0] = "Clusters";
-            
-            RSGISLabelPixelsUsingClustersCalcImg *calcValue = new RSGISLabelPixelsUsingClustersCalcImg(1, clusterCentres, ignoreZeros);
-            rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(calcValue, outProjStr, useImageProj);
-            calcImage.calcImage(datasets, numDatasets, output, true, bandNames, imageFormat);
-            
-            delete calcValue;
+            if(numDatasets == 1)
+            {
+                rsgis::img::RSGISImageUtils imgUtils;
+                GDALDataset *outDataset = imgUtils.createCopy(datasets[0], 1, output, imageFormat, GDT_Float32, useImageProj, outProjStr);
+                outDataset->GetRasterBand(1)->SetDescription("Clusters");
+                try
+                {
+                    this->labelPixelsUsingClusters(datasets[0], outDataset, clusterCentres, ignoreZeros);
+                }
+                catch(rsgis::RSGISException &e)
+                {
+                    GDALClose(outDataset);
+                    matrixUtils.freeMatrix(clusterCentres);
+                    throw;
+                }
+                GDALClose(outDataset);
+            }
+            else
+            {
+                std::string *bandNames = new std::string[1];
+                bandNames[0] = "Clusters";
+                
+                RSGISLabelPixelsUsingClustersCalcImg *calcValue = new RSGISLabelPixelsUsingClustersCalcImg(1, clusterCentres, ignoreZeros);
+                rsgis::img::RSGISCalcImage calcImage = rsgis::img::RSGISCalcImage(calcValue, outProjStr, useImageProj);
+                calcImage.calcImage(datasets, numDatasets, output, true, bandNames, imageFormat);
+                
+                delete calcValue;
+                delete[] bandNames;
+            }
             matrixUtils.freeMatrix(clusterCentres);
         } 
         catch (rsgis::math::RSGISMathException &e) 
@@ -66,6 +87,102 @@ namespace rsgis{namespace segment{
         }
     }
 
+    void RSGISLabelPixelsUsingClusters::labelPixelsUsingClusters(GDALDataset *spectral, GDALDataset *output, rsgis::math::Matrix *clusterCentres, bool ignoreZeros)
+    {
+        unsigned int width = spectral->GetRasterXSize();
+        unsigned int height = spectral->GetRasterYSize();
+        unsigned int numBands = spectral->GetRasterCount();
+        if((output->GetRasterXSize() != ((int)width)) | (output->GetRasterYSize() != ((int)height)))
+        {
+            throw rsgis::RSGISImageException("The output image is not the same size as the input image.");
+        }
+        if(((unsigned int)clusterCentres->n) != numBands)
+        {
+            throw rsgis::RSGISImageException("The number of image bands does not match the cluster centres.");
+        }
+        
+        rsgis::math::RSGISNearestCentreSearch centreSearch(clusterCentres->matrix, clusterCentres->m, clusterCentres->n, true);
+        
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        spectral->GetRasterBand(1)->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = std::max(yBlockSize, 1);
+        unsigned int yStep = stripRows;
+        while(((((size_t)stripRows) * width * (numBands + 1)) < 2097152) && (stripRows < height))
+        {
+            stripRows += yStep;
+        }
+        size_t numStrips = (height + stripRows - 1) / stripRows;
+        
+        rsgis::img::RSGISImageThreadUtils threadUtils;
+        std::vector<GDALDataset*> handles = threadUtils.openDatasetHandles(spectral, threadUtils.getNumThreads(this->numThreads));
+        std::mutex writeMutex;
+        try
+        {
+            threadUtils.runTasks(handles.size(), numStrips, [&](unsigned int threadIdx, size_t strip)
+            {
+                unsigned int startRow = strip * stripRows;
+                unsigned int numRows = std::min(stripRows, height - startRow);
+                size_t numStripPxls = ((size_t)width) * numRows;
+                
+                // Read the pixels interleaved so each pixel's values are together.
+                std::vector<double> pxlVals(numStripPxls * numBands);
+                GSpacing pxlSpace = sizeof(double) * numBands;
+                if(handles[threadIdx]->RasterIO(GF_Read, 0, startRow, width, numRows, pxlVals.data(), width, numRows, GDT_Float64, numBands, NULL, pxlSpace, pxlSpace * width, sizeof(double)) != CE_None)
+                {
+                    throw rsgis::img::RSGISImageCalcException("Failed to read the input image.");
+                }
+                
+                std::vector<unsigned int> labels(numStripPxls, 0);
+                if(ignoreZeros)
+                {
+                    // Only search for the pixels which are not all zero.
+                    std::vector<size_t> pxlIdxs;
+                    size_t numSearchPxls = 0;
+                    for(size_t i = 0; i < numStripPxls; ++i)
+                    {
+                        const double *pxl = &pxlVals[i * numBands];
+                        if(std::any_of(pxl, pxl + numBands, [](double val){return val != 0;}))
+                        {
+                            if(numSearchPxls != i)
+                            {
+                                std::copy(pxl, pxl + numBands, &pxlVals[numSearchPxls * numBands]);
+                            }
+                            pxlIdxs.push_back(i);
+                            ++numSearchPxls;
+                        }
+                    }
+                    std::vector<unsigned int> centreIdxs(numSearchPxls);
+                    centreSearch.findNearest(pxlVals.data(), numSearchPxls, centreIdxs.data());
+                    for(size_t i = 0; i < numSearchPxls; ++i)
+                    {
+                        labels[pxlIdxs[i]] = centreIdxs[i] + 1;
+                    }
+                }
+                else
+                {
+                    centreSearch.findNearest(pxlVals.data(), numStripPxls, labels.data());
+                    for(size_t i = 0; i < numStripPxls; ++i)
+                    {
+                        ++labels[i];
+                    }
+                }
+                
+                std::lock_guard<std::mutex> lock(writeMutex);
+                if(output->GetRasterBand(1)->RasterIO(GF_Write, 0, startRow, width, numRows, labels.data(), width, numRows, GDT_UInt32, 0, 0) != CE_None)
+                {
+                    throw rsgis::img::RSGISImageCalcException("Failed to write the output image.");
+                }
+            });
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            threadUtils.closeDatasetHandles(&handles);
+            throw rsgis::img::RSGISImageCalcException(e.what());
+        }
+        threadUtils.closeDatasetHandles(&handles);
+    }
+
     RSGISLabelPixelsUsingClusters::~RSGISLabelPixelsUsingClusters()
     {
         
@@ -75,57 +192,30 @@ namespace rsgis{namespace segment{
 
     RSGISLabelPixelsUsingClustersCalcImg::RSGISLabelPixelsUsingClustersCalcImg(int numberOutBands, rsgis::math::Matrix *clusterCentres, bool ignoreZeros) : RSGISCalcImageValue(numberOutBands)
     {
-        this->clusterCentres = clusterCentres;
+        this->centreSearch = new rsgis::math::RSGISNearestCentreSearch(clusterCentres->matrix, clusterCentres->m, clusterCentres->n, true);
         this->ignoreZeros = ignoreZeros;
     }
     
     void RSGISLabelPixelsUsingClustersCalcImg::calcImageValue(float *bandValues, int numBands, double *output) 
     {
-        unsigned int clusterID = 0;
-        float minDist = 0;
-        float dist = 0;
-        int clustIdx = 0;
-        bool nonZeroFound = false;
-        
-        for(int cluster = 0; cluster < clusterCentres->m; ++cluster)
+        if(((unsigned int)numBands) != this->centreSearch->getNumVars())
         {
-            dist = 0;
-            for(int i = 0; i < numBands; ++i)
-            {
-                clustIdx = (i*clusterCentres->m)+cluster;
-                dist += ((bandValues[i]-clusterCentres->matrix[clustIdx])*(bandValues[i]-clusterCentres->matrix[clustIdx]));
-                if(bandValues[i] != 0)
-                {
-                    nonZeroFound = true;
-                }
-            }
-            
-            dist = sqrt(dist);
-            
-            if(cluster == 0)
-            {
-                clusterID = cluster+1;
-                minDist = dist;
-            }
-            else if(dist < minDist)
-            {
-                clusterID = cluster+1;
-                minDist = dist;
-            }
-            
-            if(ignoreZeros & !nonZeroFound)
-            {
-                clusterID = 0;
-                break;
-            }
+            throw rsgis::img::RSGISImageCalcException("The number of image bands does not match the cluster centres.");
         }
         
-        output[0] = clusterID;
+        if(ignoreZeros && std::all_of(bandValues, bandValues + numBands, [](float val){return val == 0;}))
+        {
+            output[0] = 0;
+        }
+        else
+        {
+            output[0] = this->centreSearch->findNearest(bandValues) + 1;
+        }
     }
     
     RSGISLabelPixelsUsingClustersCalcImg::~RSGISLabelPixelsUsingClustersCalcImg()
     {
-        
+        delete this->centreSearch;
     }
     
 }}
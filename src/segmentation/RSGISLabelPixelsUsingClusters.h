@@ -25,6 +25,9 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <mutex>
+#include <algorithm>
 #include <math.h>
 
 #include "common/RSGISImageException.h"
@@ -32,8 +35,11 @@
 #include "img/RSGISImageCalcException.h"
 #include "img/RSGISCalcImageValue.h"
 #include "img/RSGISCalcImage.h"
+#include "img/RSGISImageUtils.h"
+#include "img/RSGISImageThreadUtils.h"
 
 #include "math/RSGISMatrices.h"
+#include "math/RSGISNearestCentreSearch.h"
 
 #include "gdal_priv.h"
 #include "ogrsf_frmts.h"
@@ -54,12 +60,21 @@
 
 namespace rsgis{namespace segment{
     
+    /**
+     * Labels each pixel with the (1-based) index of its nearest cluster centre.
+     * The centres matrix holds a centre per column (i.e., matrix[band*m+centre]).
+     * A single input image is labelled in strips on a pool of threads, with a
+     * block of pixels compared with the centres at a time.
+     */
     class DllExport RSGISLabelPixelsUsingClusters
     {
     public:
-        RSGISLabelPixelsUsingClusters();
+        RSGISLabelPixelsUsingClusters(unsigned int numThreads=0);
         void labelPixelsUsingClusters(GDALDataset **datasets, int numDatasets, std::string output, std::string clusterCentresFile, bool ignoreZeros, std::string imageFormat, bool useImageProj, std::string outProjStr);
+        void labelPixelsUsingClusters(GDALDataset *spectral, GDALDataset *output, rsgis::math::Matrix *clusterCentres, bool ignoreZeros);
         ~RSGISLabelPixelsUsingClusters();
+    protected:
+        unsigned int numThreads;
     };
     
     class DllExport RSGISLabelPixelsUsingClustersCalcImg : public rsgis::img::RSGISCalcImageValue
@@ -78,7 +93,7 @@ namespace rsgis{namespace segment{
         bool calcImageValueCondition(float ***dataBlock, int numBands, int winSize, double *output) {throw rsgis::img::RSGISImageCalcException("Not implemented");};
         ~RSGISLabelPixelsUsingClustersCalcImg();
     private:
-        rsgis::math::Matrix *clusterCentres;
+        rsgis::math::RSGISNearestCentreSearch *centreSearch;
         bool ignoreZeros;
     };
     
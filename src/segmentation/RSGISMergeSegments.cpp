@@ -25,12 +25,106 @@
 
 namespace rsgis{namespace segment{
     
+    RSGISClumpMergeGraph::RSGISClumpMergeGraph(const std::vector<std::vector<size_t>* > *neighbours)
+    {
+        this->numClumps = neighbours->size();
+        this->nOffsets.resize(this->numClumps);
+        this->nLens.resize(this->numClumps);
+        size_t numEdges = 0;
+        for(size_t i = 0; i < this->numClumps; ++i)
+        {
+            this->nOffsets[i] = numEdges;
+            this->nLens[i] = neighbours->at(i)->size();
+            numEdges += this->nLens[i];
+        }
+        this->nIdxs.reserve(numEdges);
+        for(size_t i = 0; i < this->numClumps; ++i)
+        {
+            for(std::vector<size_t>::const_iterator iterNeigh = neighbours->at(i)->begin(); iterNeigh != neighbours->at(i)->end(); ++iterNeigh)
+            {
+                if((*iterNeigh) >= this->numClumps)
+                {
+                    throw rsgis::RSGISAttributeTableException("A clump neighbour is outside of the RAT.");
+                }
+                this->nIdxs.push_back(*iterNeigh);
+            }
+        }
+        
+        this->parents.resize(this->numClumps);
+        for(size_t i = 0; i < this->numClumps; ++i)
+        {
+            this->parents[i] = i;
+        }
+        this->sizes.assign(this->numClumps, 1);
+        this->stamps.assign(this->numClumps, 0);
+        this->stamp = 0;
+    }
+    
+    size_t RSGISClumpMergeGraph::findClump(size_t clump)
+    {
+        // Path halving: each clump visited is pointed at its grandparent.
+        while(this->parents[clump] != clump)
+        {
+            this->parents[clump] = this->parents[this->parents[clump]];
+            clump = this->parents[clump];
+        }
+        return clump;
+    }
+    
+    void RSGISClumpMergeGraph::mergeClumps(size_t clump, size_t intoClump)
+    {
+        clump = this->findClump(clump);
+        intoClump = this->findClump(intoClump);
+        if(clump != intoClump)
+        {
+            this->parents[clump] = intoClump;
+            this->sizes[intoClump] += this->sizes[clump];
+        }
+    }
+    
+    size_t RSGISClumpMergeGraph::unionClumps(size_t clumpA, size_t clumpB)
+    {
+        clumpA = this->findClump(clumpA);
+        clumpB = this->findClump(clumpB);
+        if(clumpA == clumpB)
+        {
+            return clumpA;
+        }
+        if(this->sizes[clumpA] < this->sizes[clumpB])
+        {
+            std::swap(clumpA, clumpB);
+        }
+        this->parents[clumpB] = clumpA;
+        this->sizes[clumpA] += this->sizes[clumpB];
+        return clumpA;
+    }
+    
+    void RSGISClumpMergeGraph::compactNeighbours(size_t clump, const std::vector<bool> &ignoreClumps)
+    {
+        ++this->stamp;
+        size_t root = this->findClump(clump);
+        this->stamps[root] = this->stamp;
+        size_t *clumpNeighbours = &this->nIdxs[this->nOffsets[clump]];
+        size_t numKept = 0;
+        size_t neighbour = 0;
+        for(size_t i = 0; i < this->nLens[clump]; ++i)
+        {
+            neighbour = this->findClump(clumpNeighbours[i]);
+            if((this->stamps[neighbour] != this->stamp) && (!ignoreClumps[neighbour]))
+            {
+                this->stamps[neighbour] = this->stamp;
+                clumpNeighbours[numKept++] = neighbour;
+            }
+        }
+        this->nLens[clump] = numKept;
+    }
+    
     RSGISMergeSegments::RSGISMergeSegments()
     {
         
     }
     
-    void RSGISMergeSegments::mergeSelectedClumps(GDALDataset *clumpsImage, GDALDataset *valsImageDS, std::string clumps2MergeCol, std::string noDataClumpsCol)
+    void RSGISMergeSegments::mergeSelectedClumps(GDALDataset *clumpsImage, GDALDataset *valsImageDS, std::string clumps2MergeCol, std::string noDataClumpsCol, rsgis::rastergis::RSGISClumpChangeTracker *changes)
     {
         try
         {
@@ -74,8 +168,14 @@ namespace rsgis{namespace segment{
                 colNames.push_back(bandName);
             }
             
+            // If the clumps edited since the statistics were last calculated are known
+            // then only those rows are updated.
             rsgis::rastergis::RSGISPopRATWithStats clumpStats;
-            clumpStats.populateRATWithBasicStats(clumpsImage, valsImageDS, bandStats, 1);
+            clumpStats.populateRATWithBasicStats(clumpsImage, valsImageDS, bandStats, 1, changes);
+            if(changes != NULL)
+            {
+                changes->clear();
+            }
             
             delete bandStats;
             std::cout << "Calculated Stats\n";
@@ -101,223 +201,179 @@ namespace rsgis{namespace segment{
                 throw rsgis::RSGISAttributeTableException("RAT size is different to the number of neighbours retrieved.");
             }
             
+            RSGISClumpMergeGraph clumpGraph(neighbours);
+            for(std::vector<std::vector<size_t>* >::iterator iterNeigh = neighbours->begin(); iterNeigh != neighbours->end(); ++iterNeigh)
+            {
+                delete *iterNeigh;
+            }
+            delete neighbours;
+            
             size_t tmpNumRows = 0;
             int *selectCol = attUtils.readIntColumn(rat, clumps2MergeCol, &tmpNumRows);
             int *noDataCol = attUtils.readIntColumn(rat, noDataClumpsCol, &tmpNumRows);
             std::cout << "Read input column\n";
             
-            double *numPxls = new double[numRows];
-            
-            double **meanVals = new double*[numSpecBands];
-            double **sumVals = new double*[numSpecBands];
-            
-            for(int i = 0; i < numSpecBands; ++i)
+            // The per-clump statistics are held clump by clump in single arrays.
+            std::vector<double> clumpSums(numRows * numSpecBands);
+            std::vector<double> clumpMeans(numRows * numSpecBands);
+            std::vector<double> clumpNumPxls(numRows);
+            for(int n = 0; n < numSpecBands; ++n)
             {
                 tmpNumRows = 0;
-                meanVals[i] = attUtils.readDoubleColumn(rat, "Mean"+colNames.at(i), &tmpNumRows);
+                double *meanVals = attUtils.readDoubleColumn(rat, "Mean"+colNames.at(n), &tmpNumRows);
                 if(tmpNumRows != numRows)
                 {
+                    delete[] meanVals;
+                    delete[] selectCol;
+                    delete[] noDataCol;
                     throw rsgis::img::RSGISImageCalcException("Number of rows was incorrect. (Mean)");
                 }
                 tmpNumRows = 0;
-                sumVals[i] = attUtils.readDoubleColumn(rat, "Sum"+colNames.at(i), &tmpNumRows);
+                double *sumVals = attUtils.readDoubleColumn(rat, "Sum"+colNames.at(n), &tmpNumRows);
                 if(tmpNumRows != numRows)
                 {
+                    delete[] meanVals;
+                    delete[] sumVals;
+                    delete[] selectCol;
+                    delete[] noDataCol;
                     throw rsgis::img::RSGISImageCalcException("Number of rows was incorrect. (Sum)");
                 }
-            }
-            
-            
-            
-            std::vector<rsgisClumpInfo*> clumps;
-            for(size_t i = 0; i < numRows; ++i)
-            {
-                rsgisClumpInfo *clump = new rsgisClumpInfo();
-                clump->clumpID = i;
-                if(noDataCol[i] == 1)
+                for(size_t i = 0; i < numRows; ++i)
                 {
-                    clump->clumpID = 0;
+                    clumpMeans[(i * numSpecBands) + n] = meanVals[i];
+                    clumpSums[(i * numSpecBands) + n] = sumVals[i];
                 }
-                clump->origClumpIDs.push_back(i);
-                clump->merge = false;
-                clump->removed = false;
-                clump->mergeTo = NULL;
-                clump->meanVals = new double[numSpecBands];
-                clump->sumVals = new double[numSpecBands];
-                clump->numVals = numSpecBands;
-                for(size_t j = 0; j < numSpecBands; ++j)
+                if(n == 0)
                 {
-                    clump->meanVals[j] = meanVals[j][i];
-                    clump->sumVals[j] = sumVals[j][i];
+                    for(size_t i = 0; i < numRows; ++i)
+                    {
+                        clumpNumPxls[i] = sumVals[i] / meanVals[i];
+                    }
                 }
-                clump->numPxls = sumVals[0][i] / meanVals[0][i];
-                clump->neighbours.clear();
-                clump->selected = selectCol[i];
-                clump->noDataRegion = noDataCol[i];
-                clumps.push_back(clump);
+                delete[] meanVals;
+                delete[] sumVals;
             }
+            
+            // No data clumps which are not selected can never be merged or
+            // merged into so are dropped from the neighbour lists.
+            std::vector<bool> ignoreClumps(numRows, false);
+            std::vector<size_t> activeClumps;
             for(size_t i = 0; i < numRows; ++i)
             {
-                for(size_t j = 0; j < neighbours->at(i)->size(); ++j)
+                if(selectCol[i] == 1)
+                {
+                    activeClumps.push_back(i);
+                }
+                else if(noDataCol[i] == 1)
                 {
-                    clumps.at(i)->neighbours.push_back(clumps.at(neighbours->at(i)->at(j)));
+                    ignoreClumps[i] = true;
                 }
             }
             
-            
+            // Selected clumps are only merged into unselected clumps so only the
+            // selected clumps need their neighbours, and only those next to a
+            // clump merged in the previous iteration can have a new candidate.
+            std::vector<std::pair<size_t, size_t> > merges;
+            const size_t *clumpNeighbours = NULL;
+            size_t numNeighbours = 0;
             double val = 0.0;
-            bool process = true;
-            bool first = true;
-            rsgisClumpInfo *minClump = NULL;
             double minVal = 0.0;
-            bool found = false;
+            size_t minClump = 0;
+            bool first = true;
             unsigned int processIter = 1;
-            rsgisClumpInfo *cClump;
-            rsgisClumpInfo *mClump;
-            while(process)
+            while(!activeClumps.empty())
             {
                 std::cout << "Processing Iteration " << processIter++ << std::endl;
-                process = false;
-                for(size_t i = 0; i < clumps.size(); ++i)
+                merges.clear();
+                for(std::vector<size_t>::iterator iterClump = activeClumps.begin(); iterClump != activeClumps.end(); ++iterClump)
                 {
-                    cClump = clumps.at(i);
-                    if((cClump->selected == 1) & (!cClump->removed))
+                    clumpGraph.compactNeighbours(*iterClump, ignoreClumps);
+                    clumpNeighbours = clumpGraph.getNeighbours(*iterClump, &numNeighbours);
+                    first = true;
+                    for(size_t j = 0; j < numNeighbours; ++j)
                     {
-                        first = true;
-
-                        for(std::list<rsgisClumpInfo*>::iterator iterNeigh = cClump->neighbours.begin(); iterNeigh != cClump->neighbours.end(); ++iterNeigh)
+                        if(selectCol[clumpNeighbours[j]] != 1)
                         {
-                            if(((*iterNeigh)->selected != 1) & (!(*iterNeigh)->removed) & ((*iterNeigh)->noDataRegion != 1))
+                            val = this->calcDist(&clumpMeans[(*iterClump) * numSpecBands], &clumpMeans[clumpNeighbours[j] * numSpecBands], numSpecBands);
+                            if(first || (val < minVal))
                             {
-                                val = this->calcDist(cClump->meanVals, (*iterNeigh)->meanVals, numSpecBands);
-                                if(first)
-                                {
-                                    minClump = (*iterNeigh);
-                                    minVal = val;
-                                    first = false;
-                                }
-                                else if(val < minVal)
-                                {
-                                    minClump = (*iterNeigh);
-                                    minVal = val;
-                                }
+                                minClump = clumpNeighbours[j];
+                                minVal = val;
+                                first = false;
                             }
                         }
-                        
-                        if(!first)
-                        {
-                            cClump->merge = true;
-                            cClump->mergeTo = minClump;
-
-                            process = true;
-                        }
+                    }
+                    if(!first)
+                    {
+                        merges.push_back(std::pair<size_t, size_t>(*iterClump, minClump));
                     }
                 }
                 
-                if(process)
+                activeClumps.clear();
+                for(std::vector<std::pair<size_t, size_t> >::iterator iterMerge = merges.begin(); iterMerge != merges.end(); ++iterMerge)
                 {
-                    for(size_t i = 0; i < clumps.size(); ++i)
+                    size_t cClump = (*iterMerge).first;
+                    size_t mClump = (*iterMerge).second;
+                    clumpGraph.mergeClumps(cClump, mClump);
+                    if(changes != NULL)
                     {
-                        cClump = clumps.at(i);
-                        if(cClump->merge)
+                        changes->markClump(cClump);
+                        changes->markClump(mClump);
+                    }
+                    
+                    clumpNumPxls[mClump] += clumpNumPxls[cClump];
+                    for(int n = 0; n < numSpecBands; ++n)
+                    {
+                        clumpSums[(mClump * numSpecBands) + n] += clumpSums[(cClump * numSpecBands) + n];
+                        clumpMeans[(mClump * numSpecBands) + n] = clumpSums[(mClump * numSpecBands) + n] / clumpNumPxls[mClump];
+                    }
+                    
+                    clumpNeighbours = clumpGraph.getNeighbours(cClump, &numNeighbours);
+                    for(size_t j = 0; j < numNeighbours; ++j)
+                    {
+                        if(selectCol[clumpNeighbours[j]] == 1)
                         {
-                            mClump = cClump->mergeTo;
-                            cClump->removed = true;
-                            mClump->origClumpIDs.push_back(cClump->clumpID);
-                            
-                            mClump->numPxls += cClump->numPxls;
-                            for(int n = 0; n < numSpecBands; ++n)
-                            {
-                                mClump->sumVals[n] += cClump->sumVals[n];
-                                mClump->meanVals[n] = mClump->sumVals[n] / mClump->numPxls;
-                            }
-                            
-                            for(std::list<rsgisClumpInfo*>::iterator iterNeigh = mClump->neighbours.begin(); iterNeigh != mClump->neighbours.end(); ++iterNeigh)
-                            {
-                                if((*iterNeigh)->clumpID == cClump->clumpID)
-                                {
-                                    mClump->neighbours.erase(iterNeigh);
-                                    break;
-                                }
-                            }
-                            
-                            for(std::list<rsgisClumpInfo*>::iterator iterNeighC = cClump->neighbours.begin(); iterNeighC != cClump->neighbours.end(); ++iterNeighC)
-                            {
-                                if((*iterNeighC)->clumpID != mClump->clumpID)
-                                {
-                                    found = false;
-                                    for(std::list<rsgisClumpInfo*>::iterator iterNeighM = mClump->neighbours.begin(); iterNeighM != mClump->neighbours.end(); ++iterNeighM)
-                                    {
-                                        if((*iterNeighM)->clumpID == (*iterNeighC)->clumpID)
-                                        {
-                                            found = true;
-                                            break;
-                                        }
-                                    }
-                                    if(!found)
-                                    {
-                                        mClump->neighbours.push_back(*iterNeighC);
-                                        found = false;
-                                        for(std::list<rsgisClumpInfo*>::iterator iterNeighSec = (*iterNeighC)->neighbours.begin(); iterNeighSec != (*iterNeighC)->neighbours.end(); ++iterNeighSec)
-                                        {
-                                            if((*iterNeighSec)->clumpID == mClump->clumpID)
-                                            {
-                                                found = true;
-                                                break;
-                                            }
-                                        }
-                                        if(!found)
-                                        {
-                                            (*iterNeighC)->neighbours.push_back(mClump);
-                                        }
-                                    }
-                                }
-                            }
-                            cClump->neighbours.clear();
+                            activeClumps.push_back(clumpNeighbours[j]);
                         }
                     }
                 }
+                
+                std::sort(activeClumps.begin(), activeClumps.end());
+                activeClumps.erase(std::unique(activeClumps.begin(), activeClumps.end()), activeClumps.end());
+                size_t numActive = 0;
+                for(std::vector<size_t>::iterator iterClump = activeClumps.begin(); iterClump != activeClumps.end(); ++iterClump)
+                {
+                    if(clumpGraph.findClump(*iterClump) == (*iterClump))
+                    {
+                        activeClumps[numActive++] = *iterClump;
+                    }
+                }
+                activeClumps.resize(numActive);
             }
             std::cout << "Completed Iterations\n";
             
-            
             int *clumpIDUp = new int[numRows];
-            for(size_t i = 0; i < clumps.size(); ++i)
+            size_t root = 0;
+            for(size_t i = 0; i < numRows; ++i)
             {
-                cClump = clumps.at(i);
-                if(!cClump->removed)
+                root = clumpGraph.findClump(i);
+                clumpIDUp[i] = (noDataCol[root] == 1)?0:((int)root);
+                if((changes != NULL) && (i > 0) && (clumpIDUp[i] == 0))
                 {
-                    for(std::vector<unsigned int>::iterator iterClumpIDs = cClump->origClumpIDs.begin(); iterClumpIDs != cClump->origClumpIDs.end(); ++iterClumpIDs)
-                    {
-                        clumpIDUp[*iterClumpIDs] = cClump->clumpID;
-                    }
+                    // The pixels of the no data clumps are set to zero.
+                    changes->markClump(i);
                 }
             }
             attUtils.writeIntColumn(rat, "OutClumpIDs", clumpIDUp, numRows);
-            
-            for(size_t i = 0; i < clumps.size(); ++i)
+            if(changes != NULL)
             {
-                cClump = clumps.at(i);
-                cClump->neighbours.clear();
-                delete cClump->meanVals;
-                delete cClump->sumVals;
-                delete cClump;
+                // Where the pixels of the merged clumps are is not known here.
+                changes->markAllBlocks();
             }
-            clumps.clear();
-            
             
-            for(int i = 0; i < numSpecBands; ++i)
-            {
-                delete[] meanVals[i];
-                delete[] sumVals[i];
-            }
-            delete[] meanVals;
-            delete[] sumVals;
-            delete[] numPxls;
             delete[] selectCol;
             delete[] noDataCol;
             delete[] clumpIDUp;
-            
         }
         catch(rsgis::img::RSGISImageCalcException &e)
         {
@@ -362,86 +418,61 @@ namespace rsgis{namespace segment{
                 throw rsgis::RSGISAttributeTableException("RAT size is different to the number of neighbours retrieved.");
             }
             
-            size_t numCols = clumpsCols2Merge.size();
-            int **clumps2MergeCol = new int*[numCols];
-            size_t tmpNumRows = 0;
-            for(size_t i = 0; i < numCols; ++i)
+            RSGISClumpMergeGraph clumpGraph(neighbours);
+            for(std::vector<std::vector<size_t>* >::iterator iterNeigh = neighbours->begin(); iterNeigh != neighbours->end(); ++iterNeigh)
             {
-                clumps2MergeCol[i] = attUtils.readIntColumn(rat, clumpsCols2Merge.at(i), &tmpNumRows);
+                delete *iterNeigh;
             }
+            delete neighbours;
             
-            
-            std::vector<rsgisClumpMergeInfo*> clumps;
-            for(size_t i = 0; i < numRows; ++i)
-            {
-                rsgisClumpMergeInfo *clump = new rsgisClumpMergeInfo();
-                clump->clumpID = i;
-                clump->origClumpIDs.push_back(i);
-                for(size_t j = 0; j < numCols; ++j)
-                {
-                    clump->clumpVal.push_back(clumps2MergeCol[j][i]);
-                }
-                clump->merge = false;
-                clump->mergeTo = NULL;
-                clump->neighbours.clear();
-                clumps.push_back(clump);
-            }
-            for(size_t i = 0; i < numRows; ++i)
+            size_t numCols = clumpsCols2Merge.size();
+            std::vector<long> clumpVals(numRows * numCols);
+            size_t tmpNumRows = 0;
+            for(size_t j = 0; j < numCols; ++j)
             {
-                for(size_t j = 0; j < neighbours->at(i)->size(); ++j)
+                int *colVals = attUtils.readIntColumn(rat, clumpsCols2Merge.at(j), &tmpNumRows);
+                for(size_t i = 0; i < numRows; ++i)
                 {
-                    clumps.at(i)->neighbours.push_back(clumps.at(neighbours->at(i)->at(j)));
+                    clumpVals[(i * numCols) + j] = colVals[i];
                 }
+                delete[] colVals;
             }
             
-            std::cout << "Run Iterative Merge\n";
+            std::cout << "Merge Neighbouring Clumps\n";
             rsgis_tqdm pbar;
-            rsgisClumpMergeInfo *cClump;
-            unsigned int outIdx = 0;
-            for(size_t i = 0; i < clumps.size(); ++i)
+            const size_t *clumpNeighbours = NULL;
+            size_t numNeighbours = 0;
+            for(size_t i = 0; i < numRows; ++i)
             {
                 pbar.progress(i, numRows);
-                
-                cClump = clumps.at(i);
-                
-                if((!cClump->merge) && (cClump->neighbours.size() > 0))
+                clumpNeighbours = clumpGraph.getNeighbours(i, &numNeighbours);
+                for(size_t j = 0; j < numNeighbours; ++j)
                 {
-                    cClump->clumpID = outIdx;
-                    cClump->merge = true;
-                    for(std::list<rsgisClumpMergeInfo*>::iterator iterNeigh = cClump->neighbours.begin(); iterNeigh != cClump->neighbours.end(); ++iterNeigh)
+                    if(std::equal(&clumpVals[i * numCols], &clumpVals[i * numCols] + numCols, &clumpVals[clumpNeighbours[j] * numCols]))
                     {
-                        if(!(*iterNeigh)->merge)
-                        {
-                            this->mergeClump2Neighbours(cClump, *iterNeigh, outIdx);
-                        }
+                        clumpGraph.unionClumps(i, clumpNeighbours[j]);
                     }
-                    ++outIdx;
-                }
-                else if(!cClump->merge)
-                {
-                    cClump->clumpID = outIdx;
-                    ++outIdx;
                 }
             }
             pbar.finish();
             
+            // Number the merged clumps in order of their lowest clump ID.
             int *clumpIDUp = new int[numRows];
-            for(size_t i = 0; i < clumps.size(); ++i)
+            std::vector<int> rootIDs(numRows, -1);
+            int outIdx = 0;
+            size_t root = 0;
+            for(size_t i = 0; i < numRows; ++i)
             {
-                cClump = clumps.at(i);
-                clumpIDUp[i] = cClump->clumpID;
+                root = clumpGraph.findClump(i);
+                if(rootIDs[root] < 0)
+                {
+                    rootIDs[root] = outIdx++;
+                }
+                clumpIDUp[i] = rootIDs[root];
             }
             attUtils.writeIntColumn(rat, "OutClumpIDs", clumpIDUp, numRows);
             
-            for(size_t i = 0; i < clumps.size(); ++i)
-            {
-                cClump = clumps.at(i);
-                cClump->neighbours.clear();
-                delete cClump;
-            }
-            clumps.clear();
-
-            delete[] clumps2MergeCol;
+            delete[] clumpIDUp;
         }
         catch(rsgis::img::RSGISImageCalcException &e)
         {
@@ -457,37 +488,6 @@ namespace rsgis{namespace segment{
         }
     }
     
-    void RSGISMergeSegments::mergeClump2Neighbours(rsgisClumpMergeInfo *baseClump, rsgisClumpMergeInfo *testClump, unsigned int outIdx)
-    {
-        unsigned int numVals = baseClump->clumpVal.size();
-        bool sameVal = true;
-        for(unsigned int i = 0; i < numVals; ++i)
-        {
-            if(baseClump->clumpVal.at(i) != testClump->clumpVal.at(i))
-            {
-                sameVal = false;
-                break;
-            }
-        }
-        if(sameVal)
-        {
-            baseClump->origClumpIDs.push_back(testClump->clumpID);
-            testClump->merge = true;
-            testClump->mergeTo = baseClump;
-            testClump->clumpID = outIdx;
-            if(testClump->neighbours.size() > 0)
-            {
-                for(std::list<rsgisClumpMergeInfo*>::iterator iterNeigh = testClump->neighbours.begin(); iterNeigh != testClump->neighbours.end(); ++iterNeigh)
-                {
-                    if(!(*iterNeigh)->merge)
-                    {
-                        this->mergeClump2Neighbours(baseClump, *iterNeigh, outIdx);
-                    }
-                }
-            }
-        }
-    }
-    
     RSGISMergeSegments::~RSGISMergeSegments()
     {
         
@@ -27,6 +27,8 @@
 #include <string>
 #include <math.h>
 #include <stdlib.h>
+#include <vector>
+#include <algorithm>
 
 #include "common/rsgis-tqdm.h"
 #include "common/RSGISAttributeTableException.h"
@@ -49,6 +51,7 @@
 #include "rastergis/RSGISRasterAttUtils.h"
 #include "rastergis/RSGISFindClumpNeighbours.h"
 #include "rastergis/RSGISPopRATWithStats.h"
+#include "rastergis/RSGISClumpChangeTracker.h"
 
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
@@ -65,41 +68,53 @@
 
 namespace rsgis{namespace segment{
     
-    struct rsgisClumpInfo
+    /**
+     * The clump neighbours held in one flat (CSR) array with a union-find
+     * forest over the clump IDs. Merging clumps only updates the forest; the
+     * neighbour list of a clump is resolved to the current (root) clumps, with
+     * duplicates removed, when it is compacted rather than on every merge.
+     */
+    class DllExport RSGISClumpMergeGraph
     {
-        unsigned int clumpID;
-        std::vector<unsigned int> origClumpIDs;
-        double *meanVals;
-        double *sumVals;
-        double numPxls;
-        unsigned int numVals;
-        unsigned int selected;
-        unsigned int noDataRegion;
-        bool merge;
-        rsgisClumpInfo *mergeTo;
-        std::list<rsgisClumpInfo*> neighbours;
-        bool removed;
-    };
-    
-    struct rsgisClumpMergeInfo
-    {
-        unsigned int clumpID;
-        std::vector<unsigned int> origClumpIDs;
-        std::vector<long> clumpVal;
-        bool merge;
-        rsgisClumpMergeInfo *mergeTo;
-        std::list<rsgisClumpMergeInfo*> neighbours;
+    public:
+        RSGISClumpMergeGraph(const std::vector<std::vector<size_t>* > *neighbours);
+        size_t getNumClumps() const {return this->numClumps;};
+        size_t findClump(size_t clump);
+        /** Merge the clump into another, which remains the root. */
+        void mergeClumps(size_t clump, size_t intoClump);
+        /** Merge two clumps, keeping the larger as the root. */
+        size_t unionClumps(size_t clumpA, size_t clumpB);
+        const size_t* getNeighbours(size_t clump, size_t *numNeighbours) const
+        {
+            *numNeighbours = this->nLens[clump];
+            return &this->nIdxs[this->nOffsets[clump]];
+        };
+        /**
+         * Replace the neighbours of a clump with their root clumps, removing
+         * itself, duplicates and any clump flagged in ignoreClumps.
+         */
+        void compactNeighbours(size_t clump, const std::vector<bool> &ignoreClumps);
+        ~RSGISClumpMergeGraph(){};
+    protected:
+        size_t numClumps;
+        std::vector<size_t> nOffsets;
+        std::vector<size_t> nLens;
+        std::vector<size_t> nIdxs;
+        std::vector<size_t> parents;
+        std::vector<size_t> sizes;
+        std::vector<size_t> stamps;
+        size_t stamp;
     };
     
     class DllExport RSGISMergeSegments
     {
     public:
         RSGISMergeSegments();
-        void mergeSelectedClumps(GDALDataset *clumpsImage, GDALDataset *valsImageDS, std::string clumps2MergeCol, std::string noDataClumpsCol);
+        void mergeSelectedClumps(GDALDataset *clumpsImage, GDALDataset *valsImageDS, std::string clumps2MergeCol, std::string noDataClumpsCol, rsgis::rastergis::RSGISClumpChangeTracker *changes=NULL);
         void mergeEquivlentClumpsInRAT(GDALDataset *clumpsImage, std::vector<std::string> clumpsCols2Merge);
         ~RSGISMergeSegments();
     protected:
-        double calcDist(double *valsRef, double *valsTest, int numVals)
+        double calcDist(const double *valsRef, const double *valsTest, int numVals)
         {
             double outVal = 0.0;
             for(int i = 0; i < numVals; ++i)
@@ -109,7 +124,6 @@ namespace rsgis{namespace segment{
             outVal = sqrt(outVal/numVals);
             return outVal;
         };
-        void mergeClump2Neighbours(rsgisClumpMergeInfo *baseClump, rsgisClumpMergeInfo *testClump, unsigned int outIdx);
     };
     
 
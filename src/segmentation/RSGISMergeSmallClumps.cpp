@@ -54,6 +54,7 @@ namespace rsgis{namespace segment{
             spectralVals[n] = new float[width];
         }
         GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
+        rsgis::img::RSGISImageTileCache<unsigned int> clumpCache(clumpBand, true);
         
         unsigned long clumpIdx = 0;
         unsigned int uiPxlVal = 0;
@@ -63,7 +64,7 @@ namespace rsgis{namespace segment{
         {
             for(unsigned int j = 0; j < width; ++j)
             {
-                clumpBand->RasterIO(GF_Read, j, i, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                clumpIdx = clumpCache.getValue(j, i);
                 if((i == 0) & (j == 0))
                 {
                     maxClumpIdx = clumpIdx;
@@ -158,7 +159,7 @@ namespace rsgis{namespace segment{
                     // Above
                     if(((long)(*iterPxls).yPos)-1 >= 0)
                     {
-                        clumpBand->RasterIO(GF_Read, (*iterPxls).xPos, (*iterPxls).yPos-1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                        uiPxlVal = clumpCache.getValue((*iterPxls).xPos, (*iterPxls).yPos-1);
                         if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                         {
                             neighbours.push_back(uiPxlVal);
@@ -167,7 +168,7 @@ namespace rsgis{namespace segment{
                     // Below
                     if(((long)(*iterPxls).yPos)+1 < height)
                     {
-                        clumpBand->RasterIO(GF_Read, (*iterPxls).xPos, (*iterPxls).yPos+1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                        uiPxlVal = clumpCache.getValue((*iterPxls).xPos, (*iterPxls).yPos+1);
                         if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                         {
                             neighbours.push_back(uiPxlVal);
@@ -176,7 +177,7 @@ namespace rsgis{namespace segment{
                     // Left
                     if(((long)(*iterPxls).xPos-1) >= 0)
                     {
-                        clumpBand->RasterIO(GF_Read, (*iterPxls).xPos-1, (*iterPxls).yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                        uiPxlVal = clumpCache.getValue((*iterPxls).xPos-1, (*iterPxls).yPos);
                         if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                         {
                             neighbours.push_back(uiPxlVal);
@@ -185,7 +186,7 @@ namespace rsgis{namespace segment{
                     // Right
                     if(((long)(*iterPxls).xPos+1) < width)
                     {
-                        clumpBand->RasterIO(GF_Read, (*iterPxls).xPos+1, (*iterPxls).yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                        uiPxlVal = clumpCache.getValue((*iterPxls).xPos+1, (*iterPxls).yPos);
                         if((uiPxlVal != cClump->clumpID) & (uiPxlVal != 0))
                         {
                             neighbours.push_back(uiPxlVal);
@@ -223,7 +224,7 @@ namespace rsgis{namespace segment{
                         tLoc = cClump->pxls->at(n);
                         tClump->pxls->push_back(tLoc);
                         // Update Pixel Values - in clump image.
-                        clumpBand->RasterIO(GF_Write, tLoc.xPos, tLoc.yPos, 1, 1, &closestNeighbour, 1, 1, GDT_UInt32, 0, 0);
+                        clumpCache.setValue(tLoc.xPos, tLoc.yPos, closestNeighbour);
                     }
                     for(unsigned int b = 0; b < numSpecBands; ++b)
                     {
@@ -247,6 +248,7 @@ namespace rsgis{namespace segment{
             
             ++smallClumpsCounter;
         }
+        clumpCache.flush();
         std::cout << "Eliminated " << smallClumpsCounter << " small clumps\n";
         
         
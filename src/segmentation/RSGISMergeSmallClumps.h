@@ -34,6 +34,7 @@
 
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISImageCalcException.h"
+#include "img/RSGISImageTileCache.h"
 
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
@@ -35,9 +35,10 @@ namespace rsgis{namespace segment{
         unsigned int width = clumps->GetRasterXSize();
         unsigned int height = clumps->GetRasterYSize();
         
-        GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
+        // The seeds are in no particular order so the clumps are read through a tile cache.
+        rsgis::img::RSGISImageTileCache<unsigned int> clumpCache(clumps->GetRasterBand(1), false, 67108864);
         
-        unsigned long clumpIdx = 0;
+        unsigned int clumpIdx = 0;
         
         std::ofstream outTextFile;
         outTextFile.open (outputText.c_str());
@@ -46,7 +47,7 @@ namespace rsgis{namespace segment{
         {
             if(((*iterSeeds).xPxl < width) & ((*iterSeeds).yPxl < height))
             {
-                clumpBand->RasterIO(GF_Read, (*iterSeeds).xPxl, (*iterSeeds).yPxl, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                clumpIdx = clumpCache.getValue((*iterSeeds).xPxl, (*iterSeeds).yPxl);
                 outTextFile << clumpIdx << "," << (*iterSeeds).seedID << std::endl;
             }
             else
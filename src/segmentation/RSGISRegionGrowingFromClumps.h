@@ -36,6 +36,7 @@
 
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISImageCalcException.h"
+#include "img/RSGISImageTileCache.h"
 
 #include "utils/RSGISTextUtils.h"
 
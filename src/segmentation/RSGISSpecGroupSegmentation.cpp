@@ -32,6 +32,16 @@ namespace rsgis{namespace segment{
     }
     
     void RSGISSpecGroupSegmentation::performSimpleClump(GDALDataset *spectral, GDALDataset *clumps, float specThreshold, bool noDataValProvided, float noDataVal) 
+    {
+        this->growSpectralClumps(spectral, clumps, specThreshold, noDataValProvided, noDataVal, NULL);
+    }
+    
+    void RSGISSpecGroupSegmentation::performSimpleClumpKeepPxlVals(GDALDataset *spectral, GDALDataset *clumps, float specThreshold) 
+    {
+        this->growSpectralClumps(spectral, clumps, specThreshold, false, 0.0, NULL);
+    }
+
+    void RSGISSpecGroupSegmentation::performSimpleClumpStdDevWeights(GDALDataset *spectral, GDALDataset *clumps, float specThreshold, bool noDataValProvided, float noDataVal) 
     {
         if(spectral->GetRasterXSize() != clumps->GetRasterXSize())
         {
@@ -42,210 +52,78 @@ namespace rsgis{namespace segment{
             throw rsgis::img::RSGISImageCalcException("Heights are not the same");
         }
         
-        rsgis::img::RSGISImageUtils imgUtils;
-        imgUtils.zerosUIntGDALDataset(clumps);
-        
         unsigned int width = spectral->GetRasterXSize();
         unsigned int height = spectral->GetRasterYSize();
         unsigned int numSpecBands = spectral->GetRasterCount();
         
-        GDALRasterBand **spectralBands = new GDALRasterBand*[numSpecBands];
+        // Standard deviation of the non-zero values of each band (Welford's method).
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        spectral->GetRasterBand(1)->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int numRows = std::max(std::min((unsigned int)yBlockSize, height), 1u);
+        float *spectralVals = new float[((size_t)width) * numRows * numSpecBands];
+        double *meanSpecVals = new double[numSpecBands];
+        double *m2SpecVals = new double[numSpecBands];
+        unsigned long *numVals = new unsigned long[numSpecBands];
         for(unsigned int n = 0; n < numSpecBands; ++n)
         {
-            spectralBands[n] = spectral->GetRasterBand(n+1);
+            meanSpecVals[n] = 0;
+            m2SpecVals[n] = 0;
+            numVals[n] = 0;
         }
-        GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
-        
-        unsigned long clumpIdx = 1;
-        std::vector<rsgis::img::PxlLoc> clumpPxls;
-        std::queue<rsgis::img::PxlLoc> clumpSearchPxls;
-        float *specPxlVals = new float[numSpecBands];
-        float *specCPxlVals = new float[numSpecBands];
-        
-        unsigned int uiPxlVal = 0;
-        float dist = 0;
-        bool noDataValFound = false;
         
-        rsgis_tqdm pbar;
-        for(unsigned int i = 0; i < height; ++i)
+        double delta = 0;
+        for(unsigned int i = 0; i < height; i += numRows)
         {
-            pbar.progress(i, height);
-            
-            for(unsigned int j = 0; j < width; ++j)
+            unsigned int nRows = std::min(numRows, height - i);
+            size_t numPxls = ((size_t)width) * nRows;
+            if(spectral->RasterIO(GF_Read, 0, i, width, nRows, spectralVals, width, nRows, GDT_Float32, numSpecBands, NULL, 0, 0, 0) != CE_None)
             {
-                // Get pixel value from clump image for (j,i)
-                clumpBand->RasterIO(GF_Read, j, i, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                
-                // if value is zero create new clump
-                if(uiPxlVal == 0)
+                delete[] spectralVals;
+                delete[] meanSpecVals;
+                delete[] m2SpecVals;
+                delete[] numVals;
+                throw rsgis::img::RSGISImageCalcException("Could not read the spectral image.");
+            }
+            for(unsigned int n = 0; n < numSpecBands; ++n)
+            {
+                float *bandVals = &spectralVals[n * numPxls];
+                for(size_t k = 0; k < numPxls; ++k)
                 {
-                    noDataValFound = true;
-                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                    {
-                        specPxlVals[n] = 0;
-                        spectralBands[n]->RasterIO(GF_Read, j, i, 1, 1, &specPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                        if(specPxlVals[n] != noDataVal)
-                        {
-                            noDataValFound = false;
-                        }
-                    }
-                    
-                    if(!noDataValProvided | !noDataValFound)
+                    if(bandVals[k] != 0)
                     {
-                        // Make sure all lists are empty.
-                        clumpPxls.clear();
-                        if(!clumpSearchPxls.empty())
-                        {
-                            while(clumpSearchPxls.size() > 0)
-                            {
-                                clumpSearchPxls.pop();
-                            }
-                        }
-                        
-                        clumpPxls.push_back(rsgis::img::PxlLoc(j, i));
-                        clumpSearchPxls.push(rsgis::img::PxlLoc(j, i));
-                        clumpBand->RasterIO(GF_Write, j, i, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                        
-                        // Add neigbouring pixels to clump.
-                        // If no more pixels to add then stop.
-                        while(clumpSearchPxls.size() > 0)
-                        {
-                            rsgis::img::PxlLoc pxl = clumpSearchPxls.front();
-                            clumpSearchPxls.pop();
-                            
-                            // Above
-                            if(((long)pxl.yPos)-1 >= 0)
-                            {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                if(uiPxlVal == 0)
-                                {
-                                    noDataValFound = true;
-                                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                                    {
-                                        spectralBands[n]->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &specCPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                                        if(specPxlVals[n] != noDataVal)
-                                        {
-                                            noDataValFound = false;
-                                        }
-                                    }
-                                    if(!noDataValProvided | !noDataValFound)
-                                    {
-                                        dist = this->eucDistance(specPxlVals, specCPxlVals, numSpecBands);
-                                        
-                                        if(dist <= specThreshold)
-                                        {
-                                            clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                            clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                            clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos-1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                        }
-                                    }
-                                }
-                            }
-                            // Below
-                            if((pxl.yPos+1) < height)
-                            {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                if(uiPxlVal == 0)
-                                {
-                                    noDataValFound = true;
-                                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                                    {
-                                        spectralBands[n]->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &specCPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                                        if(specPxlVals[n] != noDataVal)
-                                        {
-                                            noDataValFound = false;
-                                        }
-                                    }
-                                    
-                                    if(!noDataValProvided | !noDataValFound)
-                                    {
-                                        dist = this->eucDistance(specPxlVals, specCPxlVals, numSpecBands);
-                                        
-                                        if(dist <= specThreshold)
-                                        {
-                                            clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                            clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                            clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos+1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                        }
-                                    }
-                                }
-
-                            }
-                            // Left
-                            if(((long)pxl.xPos)-1 >= 0)
-                            {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                if(uiPxlVal == 0)
-                                {
-                                    noDataValFound = true;
-                                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                                    {
-                                        spectralBands[n]->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &specCPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                                        if(specPxlVals[n] != noDataVal)
-                                        {
-                                            noDataValFound = false;
-                                        }
-                                    }
-                                    
-                                    if(!noDataValProvided | !noDataValFound)
-                                    {
-                                        dist = this->eucDistance(specPxlVals, specCPxlVals, numSpecBands);
-                                        
-                                        if(dist <= specThreshold)
-                                        {
-                                            clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                            clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                            clumpBand->RasterIO(GF_Write, pxl.xPos-1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                        }
-                                    }
-                                }
-
-                            }
-                            // Right
-                            if((pxl.xPos+1) < width)
-                            {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                if(uiPxlVal == 0)
-                                {
-                                    noDataValFound = true;
-                                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                                    {
-                                        spectralBands[n]->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &specCPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                                        if(specPxlVals[n] != noDataVal)
-                                        {
-                                            noDataValFound = false;
-                                        }
-                                    }
-                                    
-                                    if(!noDataValProvided | !noDataValFound)
-                                    {
-                                        dist = this->eucDistance(specPxlVals, specCPxlVals, numSpecBands);
-                                        
-                                        if(dist <= specThreshold)
-                                        {
-                                            clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                            clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                            clumpBand->RasterIO(GF_Write, pxl.xPos+1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                        }
-                                    }
-                                }
-
-                            }
-                        }
-                        
-                        clumpIdx++;
+                        ++numVals[n];
+                        delta = bandVals[k] - meanSpecVals[n];
+                        meanSpecVals[n] += delta / numVals[n];
+                        m2SpecVals[n] += delta * (bandVals[k] - meanSpecVals[n]);
                     }
                 }
             }
         }
-        pbar.finish();
-        std::cout << "(Generated " << clumpIdx-1 << " clumps).\n";
         
-        delete[] specPxlVals;
-        delete[] specCPxlVals;
+        float *stdDevSpecVals = new float[numSpecBands];
+        for(unsigned int n = 0; n < numSpecBands; ++n)
+        {
+            stdDevSpecVals[n] = sqrt(m2SpecVals[n] / numVals[n]);
+        }
+        delete[] spectralVals;
+        delete[] meanSpecVals;
+        delete[] m2SpecVals;
+        delete[] numVals;
+        
+        try
+        {
+            this->growSpectralClumps(spectral, clumps, specThreshold, noDataValProvided, noDataVal, stdDevSpecVals);
+        }
+        catch(rsgis::img::RSGISImageCalcException &e)
+        {
+            delete[] stdDevSpecVals;
+            throw e;
+        }
+        delete[] stdDevSpecVals;
     }
     
-    void RSGISSpecGroupSegmentation::performSimpleClumpKeepPxlVals(GDALDataset *spectral, GDALDataset *clumps, float specThreshold) 
+    void RSGISSpecGroupSegmentation::growSpectralClumps(GDALDataset *spectral, GDALDataset *clumps, float specThreshold, bool noDataValProvided, float noDataVal, float *stddev)
     {
         if(spectral->GetRasterXSize() != clumps->GetRasterXSize())
         {
@@ -263,54 +141,61 @@ namespace rsgis{namespace segment{
         unsigned int height = spectral->GetRasterYSize();
         unsigned int numSpecBands = spectral->GetRasterCount();
         
-        GDALRasterBand **spectralBands = new GDALRasterBand*[numSpecBands];
-        for(unsigned int n = 0; n < numSpecBands; ++n)
-        {
-            spectralBands[n] = spectral->GetRasterBand(n+1);
-        }
-        GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
-        
         unsigned long clumpIdx = 1;
-        std::vector<rsgis::img::PxlLoc> clumpPxls;
         std::queue<rsgis::img::PxlLoc> clumpSearchPxls;
-        std::vector<float> *clumpSpecPxlVals = new  std::vector<float>[numSpecBands];
         float *specPxlVals = new float[numSpecBands];
         float *specCPxlVals = new float[numSpecBands];
         
-        unsigned int uiPxlVal = 0;
-        float dist = 0;
+        const int nXOff[4] = {0, 0, -1, 1};
+        const int nYOff[4] = {-1, 1, 0, 0};
         
-        rsgis_tqdm pbar;
-        for(unsigned int i = 0; i < height; ++i)
+        std::vector<rsgis::img::RSGISImageTileCache<float>*> specCaches;
+        try
         {
-            pbar.progress(i, height);
+            // Share the default cache budget between the clump and spectral bands.
+            size_t cacheBytes = 268435456 / (numSpecBands + 1);
+            rsgis::img::RSGISImageTileCache<unsigned int> clumpCache(clumps->GetRasterBand(1), true, cacheBytes);
+            for(unsigned int n = 0; n < numSpecBands; ++n)
+            {
+                specCaches.push_back(new rsgis::img::RSGISImageTileCache<float>(spectral->GetRasterBand(n+1), false, cacheBytes));
+            }
+            
+            unsigned int uiPxlVal = 0;
+            float dist = 0;
+            bool noDataValFound = false;
+            long nX = 0;
+            long nY = 0;
             
-            for(unsigned int j = 0; j < width; ++j)
+            rsgis_tqdm pbar;
+            for(unsigned int i = 0; i < height; ++i)
             {
-                // Get pixel value from clump image for (j,i)
-                clumpBand->RasterIO(GF_Read, j, i, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
+                pbar.progress(i, height);
                 
-                // if value is zero create new clump
-                if(uiPxlVal == 0)
+                for(unsigned int j = 0; j < width; ++j)
                 {
-                    // Make sure all lists are empty.
-                    clumpPxls.clear();
-                    if(!clumpSearchPxls.empty())
+                    // if value is zero create new clump
+                    uiPxlVal = clumpCache.getValue(j, i);
+                    if(uiPxlVal != 0)
+                    {
+                        continue;
+                    }
+                    
+                    noDataValFound = true;
+                    for(unsigned int n = 0; n < numSpecBands; ++n)
                     {
-                        while(clumpSearchPxls.size() > 0)
+                        specPxlVals[n] = specCaches[n]->getValue(j, i);
+                        if(specPxlVals[n] != noDataVal)
                         {
-                            clumpSearchPxls.pop();
+                            noDataValFound = false;
                         }
                     }
-                    for(unsigned int n = 0; n < numSpecBands; ++n)
+                    if(noDataValProvided & noDataValFound)
                     {
-                        clumpSpecPxlVals[n].clear();
-                        spectralBands[n]->RasterIO(GF_Read, j, i, 1, 1, &specPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                        clumpSpecPxlVals[n].push_back(specPxlVals[n]);
+                        continue;
                     }
-                    clumpPxls.push_back(rsgis::img::PxlLoc(j, i));
+                    
                     clumpSearchPxls.push(rsgis::img::PxlLoc(j, i));
-                    clumpBand->RasterIO(GF_Write, j, i, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                    clumpCache.setValue(j, i, clumpIdx);
                     
                     // Add neigbouring pixels to clump.
                     // If no more pixels to add then stop.
@@ -318,392 +203,78 @@ namespace rsgis{namespace segment{
                     {
                         rsgis::img::PxlLoc pxl = clumpSearchPxls.front();
                         clumpSearchPxls.pop();
-
-                        // Above
-                        if(((long)pxl.yPos)-1 >= 0)
+                        
+                        // Above, below, left and right.
+                        for(unsigned int k = 0; k < 4; ++k)
                         {
-                            clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                            if(uiPxlVal == 0)
+                            nX = ((long)pxl.xPos) + nXOff[k];
+                            nY = ((long)pxl.yPos) + nYOff[k];
+                            if((nX < 0) | (nY < 0) | (nX >= width) | (nY >= height))
                             {
-                                for(unsigned int n = 0; n < numSpecBands; ++n)
-                                {
-                                    spectralBands[n]->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &specCPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                                }
-                                
-                                dist = this->eucDistance(specPxlVals, specCPxlVals, numSpecBands);
-                                
-                                if(dist <= specThreshold)
-                                {
-                                    clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                    clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                                    {
-                                        clumpSpecPxlVals[n].push_back(specCPxlVals[n]);
-                                    }
-                                    clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos-1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                }
+                                continue;
                             }
-                        }
-                        // Below
-                        if((pxl.yPos+1) < height)
-                        {
-                            clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                            if(uiPxlVal == 0)
+                            
+                            uiPxlVal = clumpCache.getValue(nX, nY);
+                            if(uiPxlVal != 0)
                             {
-                                for(unsigned int n = 0; n < numSpecBands; ++n)
-                                {
-                                    spectralBands[n]->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &specCPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                                }
-                                
-                                dist = this->eucDistance(specPxlVals, specCPxlVals, numSpecBands);
-                                
-                                if(dist <= specThreshold)
-                                {
-                                    clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                    clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                                    {
-                                        clumpSpecPxlVals[n].push_back(specCPxlVals[n]);
-                                    }
-                                    clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos+1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                }
+                                continue;
                             }
                             
-                        }
-                        // Left
-                        if(((long)pxl.xPos)-1 >= 0)
-                        {
-                            clumpBand->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                            if(uiPxlVal == 0)
+                            noDataValFound = true;
+                            for(unsigned int n = 0; n < numSpecBands; ++n)
                             {
-                                for(unsigned int n = 0; n < numSpecBands; ++n)
+                                specCPxlVals[n] = specCaches[n]->getValue(nX, nY);
+                                if(specCPxlVals[n] != noDataVal)
                                 {
-                                    spectralBands[n]->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &specCPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                                }
-                                
-                                dist = this->eucDistance(specPxlVals, specCPxlVals, numSpecBands);
-                                
-                                if(dist <= specThreshold)
-                                {
-                                    clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                    clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                                    {
-                                        clumpSpecPxlVals[n].push_back(specCPxlVals[n]);
-                                    }
-                                    clumpBand->RasterIO(GF_Write, pxl.xPos-1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
+                                    noDataValFound = false;
                                 }
                             }
+                            if(noDataValProvided & noDataValFound)
+                            {
+                                continue;
+                            }
                             
-                        }
-                        // Right
-                        if((pxl.xPos+1) < width)
-                        {
-                            clumpBand->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                            if(uiPxlVal == 0)
+                            if(stddev == NULL)
                             {
-                                for(unsigned int n = 0; n < numSpecBands; ++n)
-                                {
-                                    spectralBands[n]->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &specCPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                                }
-                                
                                 dist = this->eucDistance(specPxlVals, specCPxlVals, numSpecBands);
-                                
-                                if(dist <= specThreshold)
-                                {
-                                    clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                    clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                                    {
-                                        clumpSpecPxlVals[n].push_back(specCPxlVals[n]);
-                                    }
-                                    clumpBand->RasterIO(GF_Write, pxl.xPos+1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                }
+                            }
+                            else
+                            {
+                                dist = this->weightedEucDistance(specPxlVals, specCPxlVals, numSpecBands, stddev);
                             }
                             
+                            if(dist <= specThreshold)
+                            {
+                                clumpSearchPxls.push(rsgis::img::PxlLoc(nX, nY));
+                                clumpCache.setValue(nX, nY, clumpIdx);
+                            }
                         }
                     }
                     
                     clumpIdx++;
                 }
             }
+            clumpCache.flush();
+            pbar.finish();
         }
-        pbar.finish();
-        std::cout << "(Generated " << clumpIdx-1 << " clumps).\n";
-        
-        delete[] clumpSpecPxlVals;
-        delete[] specPxlVals;
-        delete[] specCPxlVals;
-    }
-
-    void RSGISSpecGroupSegmentation::performSimpleClumpStdDevWeights(GDALDataset *spectral, GDALDataset *clumps, float specThreshold, bool noDataValProvided, float noDataVal) 
-    {
-        if(spectral->GetRasterXSize() != clumps->GetRasterXSize())
-        {
-            throw rsgis::img::RSGISImageCalcException("Widths are not the same");
-        }
-        if(spectral->GetRasterYSize() != clumps->GetRasterYSize())
-        {
-            throw rsgis::img::RSGISImageCalcException("Heights are not the same");
-        }
-        
-        rsgis::img::RSGISImageUtils imgUtils;
-        imgUtils.zerosUIntGDALDataset(clumps);
-        
-        unsigned int width = spectral->GetRasterXSize();
-        unsigned int height = spectral->GetRasterYSize();
-        unsigned int numSpecBands = spectral->GetRasterCount();
-        
-        float **spectralVals = new float*[numSpecBands];
-        GDALRasterBand **spectralBands = new GDALRasterBand*[numSpecBands];
-        for(unsigned int n = 0; n < numSpecBands; ++n)
-        {
-            spectralBands[n] = spectral->GetRasterBand(n+1);
-            spectralVals[n] = new float[width];
-        }
-        GDALRasterBand *clumpBand = clumps->GetRasterBand(1);
-        
-        unsigned long clumpIdx = 1;
-        std::vector<rsgis::img::PxlLoc> clumpPxls;
-        std::queue<rsgis::img::PxlLoc> clumpSearchPxls;
-        float *specPxlVals = new float[numSpecBands];
-        float *specCPxlVals = new float[numSpecBands];
-        
-        float *meanSpecVals = new float[numSpecBands];
-        float *stdDevSpecVals = new float[numSpecBands];
-        unsigned int *numVals = new unsigned int[numSpecBands];
-        
-        for(unsigned int i = 0; i < height; ++i)
+        catch(rsgis::RSGISException &e)
         {
-            for(unsigned int n = 0; n < numSpecBands; ++n)
+            for(size_t n = 0; n < specCaches.size(); ++n)
             {
-                spectralBands[n]->RasterIO(GF_Read, 0, i, width, 1, spectralVals[n], width, 1, GDT_Float32, 0, 0);
-            }
-            for(unsigned int j = 0; j < width; ++j)
-            {
-                for(unsigned int n = 0; n < numSpecBands; ++n)
-                {
-                    if(spectralVals[n][j] != 0)
-                    {
-                        meanSpecVals[n] += spectralVals[n][j];
-                        ++numVals[n];
-                    }
-                }
+                delete specCaches[n];
             }
+            delete[] specPxlVals;
+            delete[] specCPxlVals;
+            throw rsgis::img::RSGISImageCalcException(e.what());
         }
+        std::cout << "(Generated " << clumpIdx-1 << " clumps).\n";
         
-        for(unsigned int n = 0; n < numSpecBands; ++n)
-        {
-            meanSpecVals[n] = meanSpecVals[n] / numVals[n];
-        }
-        
-        for(unsigned int i = 0; i < height; ++i)
-        {
-            for(unsigned int n = 0; n < numSpecBands; ++n)
-            {
-                spectralBands[n]->RasterIO(GF_Read, 0, i, width, 1, spectralVals[n], width, 1, GDT_Float32, 0, 0);
-            }
-            for(unsigned int j = 0; j < width; ++j)
-            {
-                for(unsigned int n = 0; n < numSpecBands; ++n)
-                {
-                    if(spectralVals[n][j] != 0)
-                    {
-                        stdDevSpecVals[n] += ((spectralVals[n][j]-meanSpecVals[n])*(spectralVals[n][j]-meanSpecVals[n]));
-                    }
-                }
-            }
-        }
-        
-        for(unsigned int n = 0; n < numSpecBands; ++n)
+        for(size_t n = 0; n < specCaches.size(); ++n)
         {
-            stdDevSpecVals[n] = sqrt(stdDevSpecVals[n] / numVals[n]);
+            delete specCaches[n];
         }
-        
-        unsigned int uiPxlVal = 0;
-        float dist = 0;
-        bool noDataValFound = false;
-        
-        rsgis_tqdm pbar;
-        for(unsigned int i = 0; i < height; ++i)
-        {
-            pbar.progress(i, height);
-            
-            for(unsigned int j = 0; j < width; ++j)
-            {
-                // Get pixel value from clump image for (j,i)
-                clumpBand->RasterIO(GF_Read, j, i, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                
-                // if value is zero create new clump
-                if(uiPxlVal == 0)
-                {
-                    noDataValFound = true;
-                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                    {
-                        specPxlVals[n] = 0;
-                        spectralBands[n]->RasterIO(GF_Read, j, i, 1, 1, &specPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                        if(specPxlVals[n] != noDataVal)
-                        {
-                            noDataValFound = false;
-                        }
-                    }
-                    
-                    if(!noDataValProvided | !noDataValFound)
-                    {
-                        // Make sure all lists are empty.
-                        clumpPxls.clear();
-                        if(!clumpSearchPxls.empty())
-                        {
-                            while(clumpSearchPxls.size() > 0)
-                            {
-                                clumpSearchPxls.pop();
-                            }
-                        }
-                        
-                        clumpPxls.push_back(rsgis::img::PxlLoc(j, i));
-                        clumpSearchPxls.push(rsgis::img::PxlLoc(j, i));
-                        clumpBand->RasterIO(GF_Write, j, i, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                        
-                        // Add neigbouring pixels to clump.
-                        // If no more pixels to add then stop.
-                        while(clumpSearchPxls.size() > 0)
-                        {
-                            rsgis::img::PxlLoc pxl = clumpSearchPxls.front();
-                            clumpSearchPxls.pop();
-                            
-                            // Above
-                            if(((long)pxl.yPos)-1 >= 0)
-                            {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                if(uiPxlVal == 0)
-                                {
-                                    noDataValFound = true;
-                                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                                    {
-                                        spectralBands[n]->RasterIO(GF_Read, pxl.xPos, pxl.yPos-1, 1, 1, &specCPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                                        if(specPxlVals[n] != noDataVal)
-                                        {
-                                            noDataValFound = false;
-                                        }
-                                    }
-                                    if(!noDataValProvided | !noDataValFound)
-                                    {
-                                        dist = this->weightedEucDistance(specPxlVals, specCPxlVals, numSpecBands, stdDevSpecVals);
-                                        
-                                        if(dist <= specThreshold)
-                                        {
-                                            clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                            clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos-1));
-                                            clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos-1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                        }
-                                    }
-                                }
-                            }
-                            // Below
-                            if((pxl.yPos+1) < height)
-                            {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                if(uiPxlVal == 0)
-                                {
-                                    noDataValFound = true;
-                                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                                    {
-                                        spectralBands[n]->RasterIO(GF_Read, pxl.xPos, pxl.yPos+1, 1, 1, &specCPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                                        if(specPxlVals[n] != noDataVal)
-                                        {
-                                            noDataValFound = false;
-                                        }
-                                    }
-                                    
-                                    if(!noDataValProvided | !noDataValFound)
-                                    {
-                                        dist = this->weightedEucDistance(specPxlVals, specCPxlVals, numSpecBands, stdDevSpecVals);
-                                        
-                                        if(dist <= specThreshold)
-                                        {
-                                            clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                            clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos, pxl.yPos+1));
-                                            clumpBand->RasterIO(GF_Write, pxl.xPos, pxl.yPos+1, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                        }
-                                    }
-                                }
-                                
-                            }
-                            // Left
-                            if(((long)pxl.xPos)-1 >= 0)
-                            {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                if(uiPxlVal == 0)
-                                {
-                                    noDataValFound = true;
-                                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                                    {
-                                        spectralBands[n]->RasterIO(GF_Read, pxl.xPos-1, pxl.yPos, 1, 1, &specCPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                                        if(specPxlVals[n] != noDataVal)
-                                        {
-                                            noDataValFound = false;
-                                        }
-                                    }
-                                    
-                                    if(!noDataValProvided | !noDataValFound)
-                                    {
-                                        dist = this->weightedEucDistance(specPxlVals, specCPxlVals, numSpecBands, stdDevSpecVals);
-                                        
-                                        if(dist <= specThreshold)
-                                        {
-                                            clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                            clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos-1, pxl.yPos));
-                                            clumpBand->RasterIO(GF_Write, pxl.xPos-1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                        }
-                                    }
-                                }
-                                
-                            }
-                            // Right
-                            if((pxl.xPos+1) < width)
-                            {
-                                clumpBand->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &uiPxlVal, 1, 1, GDT_UInt32, 0, 0);
-                                if(uiPxlVal == 0)
-                                {
-                                    noDataValFound = true;
-                                    for(unsigned int n = 0; n < numSpecBands; ++n)
-                                    {
-                                        spectralBands[n]->RasterIO(GF_Read, pxl.xPos+1, pxl.yPos, 1, 1, &specCPxlVals[n], 1, 1, GDT_Float32, 0, 0);
-                                        if(specPxlVals[n] != noDataVal)
-                                        {
-                                            noDataValFound = false;
-                                        }
-                                    }
-                                    
-                                    if(!noDataValProvided | !noDataValFound)
-                                    {
-                                        dist = this->weightedEucDistance(specPxlVals, specCPxlVals, numSpecBands, stdDevSpecVals);
-                                        
-                                        if(dist <= specThreshold)
-                                        {
-                                            clumpPxls.push_back(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                            clumpSearchPxls.push(rsgis::img::PxlLoc(pxl.xPos+1, pxl.yPos));
-                                            clumpBand->RasterIO(GF_Write, pxl.xPos+1, pxl.yPos, 1, 1, &clumpIdx, 1, 1, GDT_UInt32, 0, 0);
-                                        }
-                                    }
-                                }
-                                
-                            }
-                        }
-                        
-                        clumpIdx++;
-                    }
-                }
-            }
-        }
-        pbar.finish();
-        std::cout << "(Generated " << clumpIdx-1 << " clumps).\n";
-        
         delete[] specPxlVals;
         delete[] specCPxlVals;
-        delete[] meanSpecVals;
-        delete[] stdDevSpecVals;
-        delete[] numVals;
     }
     
     float RSGISSpecGroupSegmentation::eucDistance(float *vals1, float *vals2, unsigned int numVals)
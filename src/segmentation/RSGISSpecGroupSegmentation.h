@@ -35,6 +35,7 @@
 
 #include "img/RSGISImageUtils.h"
 #include "img/RSGISImageCalcException.h"
+#include "img/RSGISImageTileCache.h"
 
 // mark all exported classes/functions with DllExport to have
 // them exported by Visual Studio
@@ -51,6 +52,12 @@
 
 namespace rsgis{namespace segment{
     
+    /**
+     * Spectral grouping: each clump is grown from the first unlabelled pixel
+     * (in raster order) to the connected pixels within the spectral threshold
+     * of that seed pixel. Pixel access during growth is served from tile
+     * caches so only a bounded window of the images is held in memory.
+     */
     class DllExport RSGISSpecGroupSegmentation
     {
     public:
@@ -60,6 +67,7 @@ namespace rsgis{namespace segment{
         void performSimpleClumpStdDevWeights(GDALDataset *spectral, GDALDataset *clumps, float specThreshold, bool noDataValProvided, float noDataVal);
         ~RSGISSpecGroupSegmentation();
     protected:
+        void growSpectralClumps(GDALDataset *spectral, GDALDataset *clumps, float specThreshold, bool noDataValProvided, float noDataVal, float *stddev);
         float eucDistance(float *vals1, float *vals2, unsigned int numVals);
         float weightedEucDistance(float *vals1, float *vals2, unsigned int numVals, float *stddev);
     };
@@ -0,0 +1,616 @@
+/*
+ *  RSGISTiledSegmentation.cpp
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISTiledSegmentation.h"
+
+namespace rsgis{namespace segment{
+
+    RSGISTiledSegmentation::RSGISTiledSegmentation(unsigned int tileXSize, unsigned int tileYSize, unsigned int tileOverlap, unsigned int numThreads)
+    {
+        this->tileXSize = std::max<unsigned int>(tileXSize, 2);
+        this->tileYSize = std::max<unsigned int>(tileYSize, 2);
+        this->tileOverlap = tileOverlap;
+        this->numThreads = numThreads;
+        this->spectral = NULL;
+        this->clumps = NULL;
+        this->clusterCentres = NULL;
+        this->minClumpSize = 0;
+        this->specThreshold = 0;
+        this->bandStretchStats = NULL;
+        this->bandStatsAvail = false;
+        this->nextClumpID = 1;
+    }
+
+    void RSGISTiledSegmentation::performSegmentation(GDALDataset *spectral, GDALDataset *clumps, rsgis::math::Matrix *clusterCentres, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats, bool bandStatsAvail)
+    {
+        if((spectral->GetRasterXSize() != clumps->GetRasterXSize()) | (spectral->GetRasterYSize() != clumps->GetRasterYSize()))
+        {
+            throw rsgis::img::RSGISImageCalcException("The spectral and clumps images are not the same size.");
+        }
+        if(clusterCentres->n != spectral->GetRasterCount())
+        {
+            throw rsgis::img::RSGISImageCalcException("The cluster centres do not have the same number of bands as the spectral image.");
+        }
+
+        this->spectral = spectral;
+        this->clumps = clumps;
+        this->clusterCentres = clusterCentres;
+        this->minClumpSize = minClumpSize;
+        this->specThreshold = specThreshold;
+        this->bandStretchStats = bandStretchStats;
+        this->bandStatsAvail = bandStatsAvail;
+        this->nextClumpID = 1;
+
+        unsigned int width = spectral->GetRasterXSize();
+        unsigned int height = spectral->GetRasterYSize();
+
+        rsgis::img::RSGISImageThreadUtils threadUtils;
+        this->specHandles = threadUtils.openDatasetHandles(spectral, threadUtils.getNumThreads(this->numThreads));
+        try
+        {
+            rsgis::img::RSGISImageUtils imgUtils;
+            imgUtils.zerosUIntGDALDataset(clumps);
+
+            std::vector<RSGISSegTileWindow> tiles = this->createTiles(width, height, 0, 0);
+            std::cout << "Stage 1: Segmenting " << tiles.size() << " tiles\n";
+            // Every pixel is available in stage 1, so a tile's overlap does not
+            // depend on whether its neighbours have already written their cores.
+            this->segmentTiles(tiles, 0);
+            unsigned int stage1MaxID = this->nextClumpID - 1;
+            std::cout << "Stage 1 produced " << stage1MaxID << " clumps\n";
+
+            tiles = this->createTiles(width, height, this->tileXSize/2, this->tileYSize/2);
+            std::cout << "Stage 2: Segmenting the tile borders with " << tiles.size() << " offset tiles\n";
+            this->segmentTiles(tiles, stage1MaxID);
+            std::cout << "Stage 2 produced " << (this->nextClumpID - 1 - stage1MaxID) << " clumps\n";
+
+            std::cout << "Stage 3: Segmenting the remaining border regions\n";
+            std::vector<RSGISSegBorderRegion> regions = this->findBorderRegions();
+            std::cout << "There are " << regions.size() << " border regions\n";
+            this->segmentBorderRegions(regions);
+
+            this->relabelClumps();
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            threadUtils.closeDatasetHandles(&this->specHandles);
+            throw rsgis::img::RSGISImageCalcException(e.what());
+        }
+        threadUtils.closeDatasetHandles(&this->specHandles);
+    }
+
+    std::vector<RSGISSegTileWindow> RSGISTiledSegmentation::createTiles(unsigned int width, unsigned int height, unsigned int xShift, unsigned int yShift)
+    {
+        std::vector<unsigned int> xStarts;
+        std::vector<unsigned int> yStarts;
+        xStarts.push_back(0);
+        for(unsigned int x = xShift; x < width; x += this->tileXSize)
+        {
+            if(x > 0)
+            {
+                xStarts.push_back(x);
+            }
+        }
+        xStarts.push_back(width);
+        yStarts.push_back(0);
+        for(unsigned int y = yShift; y < height; y += this->tileYSize)
+        {
+            if(y > 0)
+            {
+                yStarts.push_back(y);
+            }
+        }
+        yStarts.push_back(height);
+
+        std::vector<RSGISSegTileWindow> tiles;
+        for(size_t j = 0; j < yStarts.size()-1; ++j)
+        {
+            for(size_t i = 0; i < xStarts.size()-1; ++i)
+            {
+                RSGISSegTileWindow tile;
+                tile.coreXOff = xStarts[i];
+                tile.coreYOff = yStarts[j];
+                tile.coreXSize = xStarts[i+1] - xStarts[i];
+                tile.coreYSize = yStarts[j+1] - yStarts[j];
+                tile.xOff = (tile.coreXOff > this->tileOverlap)?(tile.coreXOff - this->tileOverlap):0;
+                tile.yOff = (tile.coreYOff > this->tileOverlap)?(tile.coreYOff - this->tileOverlap):0;
+                tile.xSize = std::min<size_t>(((size_t)xStarts[i+1]) + this->tileOverlap, width) - tile.xOff;
+                tile.ySize = std::min<size_t>(((size_t)yStarts[j+1]) + this->tileOverlap, height) - tile.yOff;
+                tiles.push_back(tile);
+            }
+        }
+        return tiles;
+    }
+
+    void RSGISTiledSegmentation::segmentTiles(const std::vector<RSGISSegTileWindow> &tiles, unsigned int availAboveID)
+    {
+        unsigned int width = this->clumps->GetRasterXSize();
+        unsigned int height = this->clumps->GetRasterYSize();
+        unsigned int numSpecBands = this->spectral->GetRasterCount();
+        GDALRasterBand *clumpBand = this->clumps->GetRasterBand(1);
+
+        rsgis::img::RSGISImageThreadUtils threadUtils;
+        threadUtils.runTasks(threadUtils.getNumThreads(this->numThreads), tiles.size(), [&](unsigned int threadIdx, size_t t)
+        {
+            const RSGISSegTileWindow &tile = tiles[t];
+            size_t numPxls = ((size_t)tile.xSize) * tile.ySize;
+
+            // Pixels are available if no earlier stage has assigned them; later
+            // IDs are from this stage and only cover other tiles' cores.
+            std::vector<unsigned int> outVals(numPxls);
+            {
+                std::lock_guard<std::mutex> lock(this->ioMutex);
+                if(clumpBand->RasterIO(GF_Read, tile.xOff, tile.yOff, tile.xSize, tile.ySize, outVals.data(), tile.xSize, tile.ySize, GDT_UInt32, 0, 0) != CE_None)
+                {
+                    throw rsgis::img::RSGISImageCalcException("Failed to read the clumps image.");
+                }
+            }
+            std::vector<unsigned char> validPxls(numPxls, 0);
+            bool coreAvail = false;
+            for(unsigned int y = 0; y < tile.ySize; ++y)
+            {
+                for(unsigned int x = 0; x < tile.xSize; ++x)
+                {
+                    size_t i = (((size_t)y) * tile.xSize) + x;
+                    if((outVals[i] == 0) || (outVals[i] > availAboveID))
+                    {
+                        validPxls[i] = 1;
+                        if(((tile.xOff + x) >= tile.coreXOff) && ((tile.xOff + x) < (tile.coreXOff + tile.coreXSize)) && ((tile.yOff + y) >= tile.coreYOff) && ((tile.yOff + y) < (tile.coreYOff + tile.coreYSize)))
+                        {
+                            coreAvail = true;
+                        }
+                    }
+                }
+            }
+            if(!coreAvail)
+            {
+                return;
+            }
+
+            std::vector<float> specVals;
+            this->readSpectral(threadIdx, tile.xOff, tile.yOff, tile.xSize, tile.ySize, &specVals);
+            bool anyValid = false;
+            for(size_t i = 0; i < numPxls; ++i)
+            {
+                if(validPxls[i] == 1)
+                {
+                    validPxls[i] = 0;
+                    for(unsigned int n = 0; n < numSpecBands; ++n)
+                    {
+                        if(specVals[(n * numPxls) + i] != 0)
+                        {
+                            validPxls[i] = 1;
+                            anyValid = true;
+                            break;
+                        }
+                    }
+                }
+            }
+            if(!anyValid)
+            {
+                return;
+            }
+
+            std::vector<unsigned int> clumpVals;
+            this->segmentWindow(specVals, validPxls, tile.xOff, tile.yOff, tile.xSize, tile.ySize, &clumpVals);
+
+            // Keep the clumps within the core which do not reach the edge of
+            // the window (unless it is the edge of the image); the others could
+            // have been cut by the tile.
+            unsigned int maxClump = *std::max_element(clumpVals.begin(), clumpVals.end());
+            std::vector<unsigned char> keepClump(((size_t)maxClump) + 1, 1);
+            keepClump[0] = 0;
+            for(unsigned int y = 0; y < tile.ySize; ++y)
+            {
+                for(unsigned int x = 0; x < tile.xSize; ++x)
+                {
+                    unsigned int clump = clumpVals[(((size_t)y) * tile.xSize) + x];
+                    if(clump == 0)
+                    {
+                        continue;
+                    }
+                    bool inCore = ((tile.xOff + x) >= tile.coreXOff) && ((tile.xOff + x) < (tile.coreXOff + tile.coreXSize)) && ((tile.yOff + y) >= tile.coreYOff) && ((tile.yOff + y) < (tile.coreYOff + tile.coreYSize));
+                    bool onEdge = ((x == 0) && (tile.xOff > 0)) || ((y == 0) && (tile.yOff > 0)) || ((x == tile.xSize-1) && ((tile.xOff + tile.xSize) < width)) || ((y == tile.ySize-1) && ((tile.yOff + tile.ySize) < height));
+                    if((!inCore) || onEdge)
+                    {
+                        keepClump[clump] = 0;
+                    }
+                }
+            }
+
+            // Only this tile writes to its core, so the values read above are
+            // still current.
+            unsigned int coreX = tile.coreXOff - tile.xOff;
+            unsigned int coreY = tile.coreYOff - tile.yOff;
+            std::vector<unsigned int> coreVals(((size_t)tile.coreXSize) * tile.coreYSize);
+            std::vector<unsigned int> globalIDs(((size_t)maxClump) + 1, 0);
+            std::lock_guard<std::mutex> lock(this->ioMutex);
+            for(unsigned int y = 0; y < tile.coreYSize; ++y)
+            {
+                for(unsigned int x = 0; x < tile.coreXSize; ++x)
+                {
+                    size_t i = (((size_t)(y + coreY)) * tile.xSize) + (x + coreX);
+                    unsigned int clump = clumpVals[i];
+                    if(keepClump[clump] == 1)
+                    {
+                        if(globalIDs[clump] == 0)
+                        {
+                            globalIDs[clump] = this->nextClumpID++;
+                        }
+                        outVals[i] = globalIDs[clump];
+                    }
+                    coreVals[(((size_t)y) * tile.coreXSize) + x] = outVals[i];
+                }
+            }
+            if(clumpBand->RasterIO(GF_Write, tile.coreXOff, tile.coreYOff, tile.coreXSize, tile.coreYSize, coreVals.data(), tile.coreXSize, tile.coreYSize, GDT_UInt32, 0, 0) != CE_None)
+            {
+                throw rsgis::img::RSGISImageCalcException("Failed to write the clumps image.");
+            }
+        }, true);
+    }
+
+    std::vector<RSGISSegBorderRegion> RSGISTiledSegmentation::findBorderRegions()
+    {
+        unsigned int width = this->clumps->GetRasterXSize();
+        unsigned int height = this->clumps->GetRasterYSize();
+        unsigned int numSpecBands = this->spectral->GetRasterCount();
+
+        // The regions are marked with temporary IDs counting down from the
+        // maximum so they can be picked out of the image when segmented.
+        std::vector<RSGISSegBorderRegion> regions;
+        size_t cacheBytes = 268435456 / (numSpecBands + 1);
+        rsgis::img::RSGISImageTileCache<unsigned int> clumpCache(this->clumps->GetRasterBand(1), true, cacheBytes);
+        std::vector<rsgis::img::RSGISImageTileCache<float>*> specCaches;
+        try
+        {
+            for(unsigned int n = 0; n < numSpecBands; ++n)
+            {
+                specCaches.push_back(new rsgis::img::RSGISImageTileCache<float>(this->spectral->GetRasterBand(n+1), false, cacheBytes));
+            }
+            auto isAvail = [&](unsigned int x, unsigned int y)
+            {
+                if(clumpCache.getValue(x, y) != 0)
+                {
+                    return false;
+                }
+                for(unsigned int n = 0; n < numSpecBands; ++n)
+                {
+                    if(specCaches[n]->getValue(x, y) != 0)
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            };
+
+            const int xOffs[4] = {0, 0, -1, 1};
+            const int yOffs[4] = {-1, 1, 0, 0};
+            unsigned int tempID = std::numeric_limits<unsigned int>::max();
+            std::deque<rsgis::img::PxlLoc> searchPxls;
+            rsgis_tqdm pbar;
+            for(unsigned int y = 0; y < height; ++y)
+            {
+                pbar.progress(y, height);
+                for(unsigned int x = 0; x < width; ++x)
+                {
+                    if(!isAvail(x, y))
+                    {
+                        continue;
+                    }
+                    if(tempID <= this->nextClumpID)
+                    {
+                        throw rsgis::img::RSGISImageCalcException("There are too many clumps for a 32 bit image.");
+                    }
+
+                    RSGISSegBorderRegion region;
+                    region.tempID = tempID--;
+                    region.xMin = x;
+                    region.xMax = x;
+                    region.yMin = y;
+                    region.yMax = y;
+                    region.numPxls = 0;
+                    clumpCache.setValue(x, y, region.tempID);
+                    searchPxls.push_back(rsgis::img::PxlLoc(x, y));
+                    while(!searchPxls.empty())
+                    {
+                        rsgis::img::PxlLoc pxl = searchPxls.front();
+                        searchPxls.pop_front();
+                        ++region.numPxls;
+                        region.xMin = std::min(region.xMin, pxl.xPos);
+                        region.xMax = std::max(region.xMax, pxl.xPos);
+                        region.yMin = std::min(region.yMin, pxl.yPos);
+                        region.yMax = std::max(region.yMax, pxl.yPos);
+                        for(unsigned int k = 0; k < 4; ++k)
+                        {
+                            long nX = ((long)pxl.xPos) + xOffs[k];
+                            long nY = ((long)pxl.yPos) + yOffs[k];
+                            if((nX < 0) | (nY < 0) | (nX >= width) | (nY >= height))
+                            {
+                                continue;
+                            }
+                            if(isAvail(nX, nY))
+                            {
+                                clumpCache.setValue(nX, nY, region.tempID);
+                                searchPxls.push_back(rsgis::img::PxlLoc(nX, nY));
+                            }
+                        }
+                    }
+                    regions.push_back(region);
+                }
+            }
+            pbar.finish();
+            clumpCache.flush();
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            for(size_t n = 0; n < specCaches.size(); ++n)
+            {
+                delete specCaches[n];
+            }
+            throw rsgis::img::RSGISImageCalcException(e.what());
+        }
+        for(size_t n = 0; n < specCaches.size(); ++n)
+        {
+            delete specCaches[n];
+        }
+        return regions;
+    }
+
+    void RSGISTiledSegmentation::segmentBorderRegions(const std::vector<RSGISSegBorderRegion> &regions)
+    {
+        GDALRasterBand *clumpBand = this->clumps->GetRasterBand(1);
+
+        rsgis::img::RSGISImageThreadUtils threadUtils;
+        threadUtils.runTasks(threadUtils.getNumThreads(this->numThreads), regions.size(), [&](unsigned int threadIdx, size_t r)
+        {
+            const RSGISSegBorderRegion &region = regions[r];
+            unsigned int xSize = region.xMax - region.xMin + 1;
+            unsigned int ySize = region.yMax - region.yMin + 1;
+            size_t numPxls = ((size_t)xSize) * ySize;
+
+            std::vector<unsigned int> outVals(numPxls);
+            {
+                std::lock_guard<std::mutex> lock(this->ioMutex);
+                if(clumpBand->RasterIO(GF_Read, region.xMin, region.yMin, xSize, ySize, outVals.data(), xSize, ySize, GDT_UInt32, 0, 0) != CE_None)
+                {
+                    throw rsgis::img::RSGISImageCalcException("Failed to read the clumps image.");
+                }
+            }
+            std::vector<unsigned char> validPxls(numPxls, 0);
+            for(size_t i = 0; i < numPxls; ++i)
+            {
+                validPxls[i] = (outVals[i] == region.tempID)?1:0;
+            }
+
+            std::vector<unsigned int> clumpVals;
+            if(region.numPxls < this->minClumpSize)
+            {
+                clumpVals.assign(validPxls.begin(), validPxls.end());
+            }
+            else
+            {
+                std::vector<float> specVals;
+                this->readSpectral(threadIdx, region.xMin, region.yMin, xSize, ySize, &specVals);
+                this->segmentWindow(specVals, validPxls, region.xMin, region.yMin, xSize, ySize, &clumpVals);
+            }
+            unsigned int maxClump = *std::max_element(clumpVals.begin(), clumpVals.end());
+            std::vector<unsigned int> globalIDs(((size_t)maxClump) + 1, 0);
+
+            // Other regions within the bounding box may have been written since
+            // it was read so only this region's pixels are replaced.
+            std::lock_guard<std::mutex> lock(this->ioMutex);
+            if(clumpBand->RasterIO(GF_Read, region.xMin, region.yMin, xSize, ySize, outVals.data(), xSize, ySize, GDT_UInt32, 0, 0) != CE_None)
+            {
+                throw rsgis::img::RSGISImageCalcException("Failed to read the clumps image.");
+            }
+            for(size_t i = 0; i < numPxls; ++i)
+            {
+                if(validPxls[i] == 1)
+                {
+                    unsigned int clump = clumpVals[i];
+                    if((clump != 0) && (globalIDs[clump] == 0))
+                    {
+                        globalIDs[clump] = this->nextClumpID++;
+                    }
+                    outVals[i] = globalIDs[clump];
+                }
+            }
+            if(clumpBand->RasterIO(GF_Write, region.xMin, region.yMin, xSize, ySize, outVals.data(), xSize, ySize, GDT_UInt32, 0, 0) != CE_None)
+            {
+                throw rsgis::img::RSGISImageCalcException("Failed to write the clumps image.");
+            }
+        }, true);
+    }
+
+    void RSGISTiledSegmentation::segmentWindow(const std::vector<float> &specVals, const std::vector<unsigned char> &validPxls, unsigned int xOff, unsigned int yOff, unsigned int xSize, unsigned int ySize, std::vector<unsigned int> *clumpVals)
+    {
+        unsigned int numSpecBands = this->spectral->GetRasterCount();
+        size_t numPxls = ((size_t)xSize) * ySize;
+
+        double trans[6];
+        this->spectral->GetGeoTransform(trans);
+        trans[0] += (xOff * trans[1]) + (yOff * trans[2]);
+        trans[3] += (xOff * trans[4]) + (yOff * trans[5]);
+        const char *projRef = this->spectral->GetProjectionRef();
+
+        GDALDriver *memDriver = GetGDALDriverManager()->GetDriverByName("MEM");
+        if(memDriver == NULL)
+        {
+            throw rsgis::RSGISImageException("MEM driver does not exists..");
+        }
+        GDALDataset *specDataset = memDriver->Create("", xSize, ySize, numSpecBands, GDT_Float32, NULL);
+        GDALDataset *catDataset = memDriver->Create("", xSize, ySize, 1, GDT_UInt32, NULL);
+        GDALDataset *clumpDataset = memDriver->Create("", xSize, ySize, 1, GDT_UInt32, NULL);
+        try
+        {
+            std::vector<GDALDataset*> datasets = {specDataset, catDataset, clumpDataset};
+            for(size_t i = 0; i < datasets.size(); ++i)
+            {
+                datasets[i]->SetGeoTransform(trans);
+                datasets[i]->SetProjection(projRef);
+            }
+
+            // Label each pixel with the nearest cluster centre.
+            rsgis::math::RSGISNearestCentreSearch centreSearch(this->clusterCentres->matrix, this->clusterCentres->m, this->clusterCentres->n, true);
+            if(centreSearch.getNumVars() != numSpecBands)
+            {
+                throw rsgis::RSGISImageException("The number of image bands does not match the cluster centres.");
+            }
+            std::vector<size_t> pxlIdxs;
+            for(size_t i = 0; i < numPxls; ++i)
+            {
+                if(validPxls[i] == 1)
+                {
+                    pxlIdxs.push_back(i);
+                }
+            }
+            std::vector<double> pxlVals(pxlIdxs.size() * numSpecBands);
+            for(size_t i = 0; i < pxlIdxs.size(); ++i)
+            {
+                for(unsigned int n = 0; n < numSpecBands; ++n)
+                {
+                    pxlVals[(i * numSpecBands) + n] = specVals[(n * numPxls) + pxlIdxs[i]];
+                }
+            }
+            std::vector<unsigned int> centreIdxs(pxlIdxs.size());
+            centreSearch.findNearest(pxlVals.data(), pxlIdxs.size(), centreIdxs.data());
+            std::vector<unsigned int> catVals(numPxls, 0);
+            for(size_t i = 0; i < pxlIdxs.size(); ++i)
+            {
+                catVals[pxlIdxs[i]] = centreIdxs[i] + 1;
+            }
+            if(specDataset->RasterIO(GF_Write, 0, 0, xSize, ySize, (void*)specVals.data(), xSize, ySize, GDT_Float32, numSpecBands, NULL, 0, 0, 0) != CE_None)
+            {
+                throw rsgis::img::RSGISImageCalcException("Failed to write the tile spectral values.");
+            }
+            if(catDataset->GetRasterBand(1)->RasterIO(GF_Write, 0, 0, xSize, ySize, catVals.data(), xSize, ySize, GDT_UInt32, 0, 0) != CE_None)
+            {
+                throw rsgis::img::RSGISImageCalcException("Failed to write the tile labels.");
+            }
+
+            RSGISClumpPxls clumpImg;
+            clumpImg.performClump(catDataset, clumpDataset, true, 0);
+
+            RSGISEliminateSmallClumps eliminate;
+            eliminate.stepwiseIterativeEliminateSmallClumps(specDataset, clumpDataset, this->minClumpSize, this->specThreshold, this->bandStretchStats, this->bandStatsAvail);
+
+            clumpVals->resize(numPxls);
+            if(clumpDataset->GetRasterBand(1)->RasterIO(GF_Read, 0, 0, xSize, ySize, clumpVals->data(), xSize, ySize, GDT_UInt32, 0, 0) != CE_None)
+            {
+                throw rsgis::img::RSGISImageCalcException("Failed to read the tile clumps.");
+            }
+        }
+        catch(rsgis::RSGISException &e)
+        {
+            GDALClose(specDataset);
+            GDALClose(catDataset);
+            GDALClose(clumpDataset);
+            throw rsgis::img::RSGISImageCalcException(e.what());
+        }
+        GDALClose(specDataset);
+        GDALClose(catDataset);
+        GDALClose(clumpDataset);
+    }
+
+    void RSGISTiledSegmentation::readSpectral(unsigned int threadIdx, unsigned int xOff, unsigned int yOff, unsigned int xSize, unsigned int ySize, std::vector<float> *specVals)
+    {
+        unsigned int numSpecBands = this->spectral->GetRasterCount();
+        specVals->resize(((size_t)xSize) * ySize * numSpecBands);
+
+        // With a single handle the reads are serialised along with the output.
+        CPLErr err = CE_None;
+        if(this->specHandles.size() > 1)
+        {
+            err = this->specHandles[threadIdx]->RasterIO(GF_Read, xOff, yOff, xSize, ySize, specVals->data(), xSize, ySize, GDT_Float32, numSpecBands, NULL, 0, 0, 0);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(this->ioMutex);
+            err = this->specHandles[0]->RasterIO(GF_Read, xOff, yOff, xSize, ySize, specVals->data(), xSize, ySize, GDT_Float32, numSpecBands, NULL, 0, 0, 0);
+        }
+        if(err != CE_None)
+        {
+            throw rsgis::img::RSGISImageCalcException("Failed to read the spectral image.");
+        }
+    }
+
+    void RSGISTiledSegmentation::relabelClumps()
+    {
+        unsigned int width = this->clumps->GetRasterXSize();
+        unsigned int height = this->clumps->GetRasterYSize();
+        GDALRasterBand *clumpBand = this->clumps->GetRasterBand(1);
+
+        int xBlockSize = 0;
+        int yBlockSize = 0;
+        clumpBand->GetBlockSize(&xBlockSize, &yBlockSize);
+        unsigned int stripRows = std::max(yBlockSize, 1);
+        while(((((size_t)stripRows) * width) < 2097152) && (stripRows < height))
+        {
+            stripRows += std::max(yBlockSize, 1);
+        }
+
+        // IDs are given in raster order so they do not depend on the order
+        // the tiles were completed.
+        std::vector<unsigned int> newIDs(this->nextClumpID, 0);
+        unsigned int relabelID = 1;
+        std::vector<unsigned int> clumpVals(((size_t)stripRows) * width);
+        rsgis_tqdm pbar;
+        for(unsigned int startRow = 0; startRow < height; startRow += stripRows)
+        {
+            pbar.progress(startRow, height);
+            unsigned int numRows = std::min(stripRows, height - startRow);
+            size_t numStripPxls = ((size_t)width) * numRows;
+            if(clumpBand->RasterIO(GF_Read, 0, startRow, width, numRows, clumpVals.data(), width, numRows, GDT_UInt32, 0, 0) != CE_None)
+            {
+                throw rsgis::img::RSGISImageCalcException("Failed to read the clumps image.");
+            }
+            for(size_t i = 0; i < numStripPxls; ++i)
+            {
+                if(clumpVals[i] == 0)
+                {
+                    continue;
+                }
+                if(clumpVals[i] >= this->nextClumpID)
+                {
+                    throw rsgis::img::RSGISImageCalcException("A border region was not segmented.");
+                }
+                if(newIDs[clumpVals[i]] == 0)
+                {
+                    newIDs[clumpVals[i]] = relabelID++;
+                }
+                clumpVals[i] = newIDs[clumpVals[i]];
+            }
+            if(clumpBand->RasterIO(GF_Write, 0, startRow, width, numRows, clumpVals.data(), width, numRows, GDT_UInt32, 0, 0) != CE_None)
+            {
+                throw rsgis::img::RSGISImageCalcException("Failed to write the clumps image.");
+            }
+        }
+        pbar.finish();
+        std::cout << "There are " << (relabelID-1) << " clumps\n";
+    }
+
+    RSGISTiledSegmentation::~RSGISTiledSegmentation()
+    {
+
+    }
+
+}}
@@ -0,0 +1,140 @@
+/*
+ *  RSGISTiledSegmentation.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISTiledSegmentation_H
+#define RSGISTiledSegmentation_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <algorithm>
+#include <limits>
+
+#include "gdal_priv.h"
+
+#include "common/RSGISImageException.h"
+
+#include "math/RSGISMatrices.h"
+#include "math/RSGISNearestCentreSearch.h"
+
+#include "img/RSGISImageCalcException.h"
+#include "img/RSGISImageThreadUtils.h"
+#include "img/RSGISImageTileCache.h"
+#include "img/RSGISStretchImage.h"
+
+#include "segmentation/RSGISClumpPxls.h"
+#include "segmentation/RSGISEliminateSmallClumps.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_segmentation_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace segment{
+
+    struct DllExport RSGISSegTileWindow
+    {
+        // The region this tile is responsible for.
+        unsigned int coreXOff;
+        unsigned int coreYOff;
+        unsigned int coreXSize;
+        unsigned int coreYSize;
+        // The core plus the overlap, clipped to the image.
+        unsigned int xOff;
+        unsigned int yOff;
+        unsigned int xSize;
+        unsigned int ySize;
+    };
+
+    struct DllExport RSGISSegBorderRegion
+    {
+        unsigned int tempID;
+        unsigned int xMin;
+        unsigned int yMin;
+        unsigned int xMax;
+        unsigned int yMax;
+        size_t numPxls;
+    };
+
+    /**
+     * Runs the Shepherd et al. (2019) segmentation (label pixels to the nearest
+     * cluster centre, clump, eliminate small clumps) over an image in tiles on a
+     * pool of threads, writing a single clumps image. It follows the stages of
+     * the tiled workflow of Clewley et al. (2015) but holds the tiles in memory:
+     *
+     * 1. Tiles (with an overlap) are segmented and the clumps which lie within a
+     *    tile's core region, without reaching the edge of the segmented window,
+     *    are kept. The remaining pixels are left for the later stages.
+     * 2. The same is done with tiles offset by half a tile, segmenting only the
+     *    pixels which stage 1 did not assign.
+     * 3. Each connected region of pixels still unassigned is segmented on its
+     *    own (or given a single clump if smaller than the minimum clump size).
+     *
+     * Pixels with all bands zero are no data. The output is relabelled in raster
+     * order so the clump IDs are contiguous and do not depend on the thread
+     * count. Note that a stage 3 region is segmented as one window, so very
+     * large homogeneous areas spanning many tiles (e.g., the sea) should be
+     * masked out first.
+     */
+    class DllExport RSGISTiledSegmentation
+    {
+    public:
+        RSGISTiledSegmentation(unsigned int tileXSize=2000, unsigned int tileYSize=2000, unsigned int tileOverlap=100, unsigned int numThreads=0);
+        void performSegmentation(GDALDataset *spectral, GDALDataset *clumps, rsgis::math::Matrix *clusterCentres, unsigned int minClumpSize, float specThreshold, std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats=NULL, bool bandStatsAvail=false);
+        ~RSGISTiledSegmentation();
+    protected:
+        std::vector<RSGISSegTileWindow> createTiles(unsigned int width, unsigned int height, unsigned int xShift, unsigned int yShift);
+        void segmentTiles(const std::vector<RSGISSegTileWindow> &tiles, unsigned int availAboveID);
+        std::vector<RSGISSegBorderRegion> findBorderRegions();
+        void segmentBorderRegions(const std::vector<RSGISSegBorderRegion> &regions);
+        void segmentWindow(const std::vector<float> &specVals, const std::vector<unsigned char> &validPxls, unsigned int xOff, unsigned int yOff, unsigned int xSize, unsigned int ySize, std::vector<unsigned int> *clumpVals);
+        void readSpectral(unsigned int threadIdx, unsigned int xOff, unsigned int yOff, unsigned int xSize, unsigned int ySize, std::vector<float> *specVals);
+        void relabelClumps();
+        unsigned int tileXSize;
+        unsigned int tileYSize;
+        unsigned int tileOverlap;
+        unsigned int numThreads;
+        GDALDataset *spectral;
+        GDALDataset *clumps;
+        rsgis::math::Matrix *clusterCentres;
+        unsigned int minClumpSize;
+        float specThreshold;
+        std::vector<rsgis::img::BandSpecThresholdStats> *bandStretchStats;
+        bool bandStatsAvail;
+        std::vector<GDALDataset*> specHandles;
+        unsigned int nextClumpID;
+        std::mutex ioMutex;
+    };
+
+}}
+
+#endif
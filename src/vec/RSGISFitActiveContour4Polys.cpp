@@ -153,6 +153,8 @@ namespace rsgis{namespace vec{
             GDALRasterBand *extImgBand = externalForceImg->GetRasterBand(1);
             unsigned int imgWidth = extImgBand->GetXSize();
             unsigned int imgHeight = extImgBand->GetYSize();
+            // The contour is re-evaluated around the same pixels on every iteration.
+            rsgis::img::RSGISImageTileCache<float> extImgCache(extImgBand, false, 67108864);
             
             double *trans = new double[6];
             externalForceImg->GetGeoTransform(trans);
@@ -203,6 +205,24 @@ namespace rsgis{namespace vec{
                 }					
             }
             
+            // The first iterations evaluate the pixels around the initial contour so its window is loaded up front.
+            double cXMin = coords->front().x;
+            double cXMax = coords->front().x;
+            double cYMin = coords->front().y;
+            double cYMax = coords->front().y;
+            for(std::vector<RSGISACCoordFit>::iterator iterCoords = coords->begin(); iterCoords != coords->end(); ++iterCoords)
+            {
+                cXMin = std::min(cXMin, (*iterCoords).x);
+                cXMax = std::max(cXMax, (*iterCoords).x);
+                cYMin = std::min(cYMin, (*iterCoords).y);
+                cYMax = std::max(cYMax, (*iterCoords).y);
+            }
+            int winXMin = floor((cXMin - bXMin)/imgRes) - 1;
+            int winXMax = floor((cXMax - bXMin)/imgRes) + 1;
+            int winYMin = floor((bYMax - cYMax)/imgRes) - 1;
+            int winYMax = floor((bYMax - cYMin)/imgRes) + 1;
+            extImgCache.prefetch(winXMin, winYMin, (winXMax - winXMin) + 1, (winYMax - winYMin) + 1);
+            
             // Initial all the coordinates
             RSGISACCoordFit next;
             RSGISACCoordFit prev;
@@ -256,7 +276,7 @@ namespace rsgis{namespace vec{
                     throw rsgis::RSGISVectorException("X Does not fit within the image");
                 }
                 
-                extImgBand->RasterIO(GF_Read, xPxl, yPxl, 1, 1, &dataVal, 1, 1, GDT_Float32, 0, 0);
+                dataVal = extImgCache.getValue(xPxl, yPxl);
                 (*iterCoords).extEnergy = (dataVal * extGamma);
                 externalEnergy += (*iterCoords).extEnergy;
                 
@@ -428,7 +448,7 @@ namespace rsgis{namespace vec{
                                     throw rsgis::RSGISVectorException("X Does not fit within the image");
                                 }
                                 
-                                extImgBand->RasterIO(GF_Read, xPxl, yPxl, 1, 1, &dataVal, 1, 1, GDT_Float32, 0, 0);
+                                dataVal = extImgCache.getValue(xPxl, yPxl);
                                 cCExt = (dataVal * extGamma);
                                 
                                 this->calcUpdateInternalEnergies(interAlpha, interBeta, &coord1, &next, &prev, &next1, &prev1, &cCInt, &cNInt, &cPInt);
@@ -36,6 +36,8 @@
 #include "vec/RSGISProcessOGRGeometry.h"
 #include "vec/RSGISProcessGeometry.h"
 
+#include "img/RSGISImageTileCache.h"
+
 #include "gdal_priv.h"
 
 // mark all exported classes/functions with DllExport to have
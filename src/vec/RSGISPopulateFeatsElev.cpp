@@ -29,6 +29,7 @@ namespace rsgis{namespace vec{
 	{
         this->image = image;
 		this->band = band;
+        this->ownImage = false;
         this->numImgBands = image->GetRasterCount();
         
         if(band > numImgBands)
@@ -37,12 +38,8 @@ namespace rsgis{namespace vec{
         }
         this->band -= 1; // set so using array index rather than image.
         
-		this->bands = new GDALRasterBand*[numImgBands];
-        
-		for(int i = 0; i < numImgBands; ++i)
-		{
-			bands[i] = image->GetRasterBand(i+1);
-		}
+        // Neighbouring vertices fall in the same tiles so the band is read through a cache.
+        this->elevCache = new rsgis::img::RSGISImageTileCache<double>(image->GetRasterBand(band), false, 16777216);
 		
 		double geoTransform[6];
 		
@@ -57,8 +54,6 @@ namespace rsgis{namespace vec{
 			imageExtent = new geos::geom::Envelope(xMin, xMax, yMin, yMax);
 			
 			imgRes = geoTransform[1];
-            
-			pxlValues = (double *) CPLMalloc(sizeof(double));
 		}
     }
 	
@@ -68,6 +63,7 @@ namespace rsgis{namespace vec{
 		if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbPolygon )
 		{
 			OGRPolygon *poly = (OGRPolygon *) geometry;
+            this->prefetchGeomWindow(poly);
             OGRPolygon *nPoly = new OGRPolygon();
             
             nPoly->addRingDirectly(this->popZfield(poly->getExteriorRing()));
@@ -83,6 +79,7 @@ namespace rsgis{namespace vec{
 		else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbMultiPolygon )
 		{
 			OGRMultiPolygon *mPoly = (OGRMultiPolygon *) geometry;
+            this->prefetchGeomWindow(mPoly);
             OGRMultiPolygon *nMPoly = new OGRMultiPolygon();
             OGRPolygon *poly = NULL;
             
@@ -120,11 +117,7 @@ namespace rsgis{namespace vec{
 				int xPxl = static_cast<int> (xDiff/imgRes);
 				int yPxl = static_cast<int> (yDiff/imgRes);
 				
-				double *values = this->getPixelColumns(xPxl, yPxl);
-
-                point->setZ(values[this->band]);
-                
-                delete[] values;
+                point->setZ(this->getPixelValue(xPxl, yPxl));
                 
 			}
 			else
@@ -158,17 +151,39 @@ namespace rsgis{namespace vec{
         
 	}
 	
-	double* RSGISPopulateFeatsElev::getPixelColumns(int xPxl, int yPxl)
+	RSGISProcessOGRFeature* RSGISPopulateFeatsElev::clone()
 	{
-		double *values = new double[numImgBands];
-		for(int i = 0; i < numImgBands; ++i)
+		rsgis::img::RSGISImageThreadUtils threadUtils;
+		std::vector<GDALDataset*> handles = threadUtils.openDatasetHandles(this->image, 2);
+		if(handles.size() < 2)
 		{
-			bands[i]->RasterIO(GF_Read, xPxl, yPxl, 1, 1, pxlValues, 1, 1, GDT_Float64, 0, 0);
-			values[i] = pxlValues[0];
+			return NULL;
 		}
-		return values;
+		RSGISPopulateFeatsElev *popFeatsElev = new RSGISPopulateFeatsElev(handles[1], this->band + 1);
+		popFeatsElev->ownImage = true;
+		return popFeatsElev;
+	}
+	
+	double RSGISPopulateFeatsElev::getPixelValue(int xPxl, int yPxl)
+	{
+        // Points on the maximum edge of the image are given the last pixel.
+        xPxl = std::min(std::max(xPxl, 0), this->elevCache->getXSize()-1);
+        yPxl = std::min(std::max(yPxl, 0), this->elevCache->getYSize()-1);
+		return this->elevCache->getValue(xPxl, yPxl);
 	}
     
+    void RSGISPopulateFeatsElev::prefetchGeomWindow(OGRGeometry *geometry)
+    {
+        // Load the tiles under the geometry in one pass rather than in the order the vertices visit them.
+        OGREnvelope geomEnv;
+        geometry->getEnvelope(&geomEnv);
+        int xMinPxl = static_cast<int>((geomEnv.MinX - imageExtent->getMinX())/imgRes);
+        int xMaxPxl = static_cast<int>((geomEnv.MaxX - imageExtent->getMinX())/imgRes);
+        int yMinPxl = static_cast<int>((imageExtent->getMaxY() - geomEnv.MaxY)/imgRes);
+        int yMaxPxl = static_cast<int>((imageExtent->getMaxY() - geomEnv.MinY)/imgRes);
+        this->elevCache->prefetch(xMinPxl, yMinPxl, (xMaxPxl - xMinPxl) + 1, (yMaxPxl - yMinPxl) + 1);
+    }
+    
     OGRLinearRing* RSGISPopulateFeatsElev::popZfield(OGRLinearRing *inGeomRing)
     {
         OGRLinearRing *outGeomRing = new OGRLinearRing();
@@ -191,9 +206,7 @@ namespace rsgis{namespace vec{
                     int xPxl = static_cast<int> (xDiff/imgRes);
                     int yPxl = static_cast<int> (yDiff/imgRes);
                     
-                    double *values = this->getPixelColumns(xPxl, yPxl);
-                    point->setZ(values[this->band]);
-                    delete[] values;
+                    point->setZ(this->getPixelValue(xPxl, yPxl));
                     outGeomRing->setPoint(i, point);
                 }
                 else
@@ -219,9 +232,12 @@ namespace rsgis{namespace vec{
 	
 	RSGISPopulateFeatsElev::~RSGISPopulateFeatsElev()
 	{
-        delete[] this->bands;
+        delete this->elevCache;
 		delete this->imageExtent;
-		delete[] this->pxlValues;
+        if(this->ownImage)
+        {
+            GDALClose(this->image);
+        }
 	}
 }}
 
@@ -43,6 +43,9 @@
 
 #include "math/RSGISMathsUtils.h"
 
+#include "img/RSGISImageThreadUtils.h"
+#include "img/RSGISImageTileCache.h"
+
 #include "geos/geom/Envelope.h"
 
 // mark all exported classes/functions with DllExport to have
@@ -67,17 +70,20 @@ namespace rsgis{namespace vec{
 		virtual void processFeature(OGRFeature *inFeature, OGRFeature *outFeature, geos::geom::Envelope *env, long fid);
 		virtual void processFeature(OGRFeature *inFeature, geos::geom::Envelope *env, long fid);
 		virtual void createOutputLayerDefinition(OGRLayer *outputLayer, OGRFeatureDefn *inFeatureDefn);
-		double* getPixelColumns(int xPxl, int yPxl);
+		/** A copy reading the image through its own dataset handle (NULL if the image cannot be re-opened). */
+		virtual RSGISProcessOGRFeature* clone();
+		double getPixelValue(int xPxl, int yPxl);
+		void prefetchGeomWindow(OGRGeometry *geometry);
         OGRLinearRing* popZfield(OGRLinearRing *inGeomRing);
 		virtual ~RSGISPopulateFeatsElev();
 	private:
 		GDALDataset *image;
-		GDALRasterBand **bands;
 		int numImgBands;
 		geos::geom::Envelope *imageExtent;
 		double imgRes;
-		double *pxlValues;
+		rsgis::img::RSGISImageTileCache<double> *elevCache;
         unsigned int band;
+        bool ownImage;
     };
 }}
 
@@ -0,0 +1,338 @@
+/*
+ *  RSGISProcessFeatureBatches.cpp
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RSGISProcessFeatureBatches.h"
+
+namespace rsgis{namespace vec{
+
+    RSGISProcessFeatureBatches::RSGISProcessFeatureBatches(RSGISProcessOGRFeature *processFeatures, unsigned int numThreads, unsigned int batchSize, unsigned int featsPerTransaction)
+    {
+        this->processFeatures = processFeatures;
+        this->numThreads = numThreads;
+        this->batchSize = std::max<unsigned int>(batchSize, 1);
+        this->featsPerTransaction = std::max<unsigned int>(featsPerTransaction, 1);
+        this->inTransaction = false;
+        this->numInTransaction = 0;
+        this->numFeatures = 0;
+        this->numWritten = 0;
+        this->outVertical = false;
+        this->feedbackStep = 10;
+        this->feedbackCounter = 0;
+        this->nextFeedback = 0;
+    }
+
+    void RSGISProcessFeatureBatches::setFeedback(bool outVertical, bool moreFeedback)
+    {
+        this->outVertical = outVertical;
+        this->feedbackStep = moreFeedback?5:10;
+    }
+
+    void RSGISProcessFeatureBatches::processToLayer(OGRLayer *inputLayer, OGRLayer *outputLayer, bool copyData)
+    {
+        this->processLayer(inputLayer, outputLayer, featsToLayer, copyData);
+    }
+
+    void RSGISProcessFeatureBatches::processInPlace(OGRLayer *inputLayer)
+    {
+        this->processLayer(inputLayer, inputLayer, featsInPlace, false);
+    }
+
+    void RSGISProcessFeatureBatches::processNoOutput(OGRLayer *inputLayer)
+    {
+        this->processLayer(inputLayer, NULL, featsNoOutput, false);
+    }
+
+    void RSGISProcessFeatureBatches::processLayer(OGRLayer *inputLayer, OGRLayer *outputLayer, FeatureOutput output, bool copyData)
+    {
+        try
+        {
+            OGRFeatureDefn *inFeatureDefn = inputLayer->GetLayerDefn();
+            OGRFeatureDefn *outFeatureDefn = (output == featsToLayer)?outputLayer->GetLayerDefn():NULL;
+
+            rsgis::img::RSGISImageThreadUtils threadUtils;
+            unsigned int numThreads = threadUtils.getNumThreads(this->numThreads);
+            this->processors.clear();
+            this->processors.push_back(this->processFeatures);
+            for(unsigned int i = 1; i < numThreads; ++i)
+            {
+                RSGISProcessOGRFeature *processor = this->processFeatures->clone();
+                if(processor == NULL)
+                {
+                    break;
+                }
+                this->processors.push_back(processor);
+            }
+
+            this->numFeatures = (int)inputLayer->GetFeatureCount(TRUE);
+            this->numWritten = 0;
+            this->inTransaction = false;
+            this->numInTransaction = 0;
+            this->feedbackCounter = 0;
+            this->nextFeedback = 0;
+            if(this->outVertical)
+            {
+                std::cout << "Started, " << this->numFeatures << " features to process.\n";
+            }
+            else
+            {
+                std::cout << "Started (" << this->numFeatures << " features) " << std::flush;
+            }
+
+            inputLayer->ResetReading();
+            this->readBatch(inputLayer, outFeatureDefn, &this->readFeats);
+            while(!this->readFeats.empty())
+            {
+                this->procFeats.swap(this->readFeats);
+                if(this->processors.size() > 1)
+                {
+                    // The batch is processed while the previous one is written and the next one read.
+                    std::exception_ptr procError = nullptr;
+                    std::thread procThread([&]()
+                    {
+                        try
+                        {
+                            threadUtils.runTasks(this->processors.size(), this->procFeats.size(), [&](unsigned int threadIdx, size_t i)
+                            {
+                                this->processFeature(this->processors[threadIdx], &this->procFeats[i], output, copyData, inFeatureDefn, outFeatureDefn);
+                            }, true);
+                        }
+                        catch(...)
+                        {
+                            procError = std::current_exception();
+                        }
+                    });
+
+                    std::exception_ptr ioError = nullptr;
+                    try
+                    {
+                        this->writeBatch(outputLayer, output, &this->writeFeats);
+                        this->readBatch(inputLayer, outFeatureDefn, &this->readFeats);
+                    }
+                    catch(...)
+                    {
+                        ioError = std::current_exception();
+                    }
+                    procThread.join();
+
+                    if(ioError != nullptr)
+                    {
+                        std::rethrow_exception(ioError);
+                    }
+                    if(procError != nullptr)
+                    {
+                        std::rethrow_exception(procError);
+                    }
+                    this->writeFeats.swap(this->procFeats);
+                }
+                else
+                {
+                    for(std::vector<FeatureJob>::iterator iterFeats = this->procFeats.begin(); iterFeats != this->procFeats.end(); ++iterFeats)
+                    {
+                        this->processFeature(this->processFeatures, &(*iterFeats), output, copyData, inFeatureDefn, outFeatureDefn);
+                    }
+                    this->writeBatch(outputLayer, output, &this->procFeats);
+                    this->readBatch(inputLayer, outFeatureDefn, &this->readFeats);
+                }
+            }
+            this->writeBatch(outputLayer, output, &this->writeFeats);
+        }
+        catch(RSGISException &e)
+        {
+            // Rethrown as is so callers still see the processor's exception type.
+            this->finish(outputLayer, false);
+            throw;
+        }
+        catch(...)
+        {
+            this->finish(outputLayer, false);
+            throw;
+        }
+        this->finish(outputLayer, true);
+        std::cout << " Complete.\n";
+    }
+
+    void RSGISProcessFeatureBatches::readBatch(OGRLayer *inputLayer, OGRFeatureDefn *outFeatureDefn, std::vector<FeatureJob> *batch)
+    {
+        batch->clear();
+        OGRFeature *inFeature = NULL;
+        while((batch->size() < this->batchSize) && ((inFeature = inputLayer->GetNextFeature()) != NULL))
+        {
+            FeatureJob job;
+            job.inFeature = inFeature;
+            job.outFeature = (outFeatureDefn != NULL)?OGRFeature::CreateFeature(outFeatureDefn):NULL;
+            job.nullGeometry = false;
+            batch->push_back(job);
+        }
+    }
+
+    void RSGISProcessFeatureBatches::processFeature(RSGISProcessOGRFeature *processor, FeatureJob *job, FeatureOutput output, bool copyData, OGRFeatureDefn *inFeatureDefn, OGRFeatureDefn *outFeatureDefn)
+    {
+        OGRGeometry *geometry = job->inFeature->GetGeometryRef();
+        if(geometry == NULL)
+        {
+            job->nullGeometry = true;
+            return;
+        }
+        OGRwkbGeometryType geomType = wkbFlatten(geometry->getGeometryType());
+        if((geomType != wkbPolygon) & (geomType != wkbMultiPolygon) & (geomType != wkbPoint) & (geomType != wkbLineString) & (geomType != wkbMultiLineString))
+        {
+            std::string message = std::string("Unsupport data type: ") + std::string(geometry->getGeometryName());
+            throw RSGISVectorException(message);
+        }
+
+        RSGISVectorUtils vecUtils;
+        geos::geom::Envelope *env = vecUtils.getEnvelope(geometry);
+        long fid = job->inFeature->GetFID();
+        try
+        {
+            if(output == featsToLayer)
+            {
+                job->outFeature->SetGeometry(geometry);
+                processor->processFeature(job->inFeature, job->outFeature, env, fid);
+                job->outFeature->SetFID(fid);
+                if(copyData)
+                {
+                    this->copyFeatureData(job->inFeature, job->outFeature, inFeatureDefn, outFeatureDefn);
+                }
+            }
+            else
+            {
+                processor->processFeature(job->inFeature, env, fid);
+            }
+        }
+        catch(...)
+        {
+            delete env;
+            throw;
+        }
+        delete env;
+    }
+
+    void RSGISProcessFeatureBatches::writeBatch(OGRLayer *writeLayer, FeatureOutput output, std::vector<FeatureJob> *batch)
+    {
+        for(std::vector<FeatureJob>::iterator iterFeats = batch->begin(); iterFeats != batch->end(); ++iterFeats)
+        {
+            if((*iterFeats).nullGeometry)
+            {
+                std::cout << "WARNING: NULL Geometry Present within input file - IGNORED\n";
+            }
+            else if(output != featsNoOutput)
+            {
+                if(!this->inTransaction)
+                {
+                    writeLayer->StartTransaction();
+                    this->inTransaction = true;
+                }
+                if(output == featsToLayer)
+                {
+                    if(writeLayer->CreateFeature((*iterFeats).outFeature) != OGRERR_NONE)
+                    {
+                        throw RSGISVectorOutputException("Failed to write feature to the output layer.");
+                    }
+                }
+                else if(writeLayer->SetFeature((*iterFeats).inFeature) != OGRERR_NONE)
+                {
+                    throw RSGISVectorOutputException("Failed to write feature to the vector layer.");
+                }
+                if(++this->numInTransaction == this->featsPerTransaction)
+                {
+                    writeLayer->CommitTransaction();
+                    this->inTransaction = false;
+                    this->numInTransaction = 0;
+                }
+            }
+            this->printFeedback();
+            ++this->numWritten;
+        }
+        this->destroyBatch(batch);
+    }
+
+    void RSGISProcessFeatureBatches::destroyBatch(std::vector<FeatureJob> *batch)
+    {
+        for(std::vector<FeatureJob>::iterator iterFeats = batch->begin(); iterFeats != batch->end(); ++iterFeats)
+        {
+            OGRFeature::DestroyFeature((*iterFeats).inFeature);
+            if((*iterFeats).outFeature != NULL)
+            {
+                OGRFeature::DestroyFeature((*iterFeats).outFeature);
+            }
+        }
+        batch->clear();
+    }
+
+    void RSGISProcessFeatureBatches::finish(OGRLayer *writeLayer, bool commit)
+    {
+        if(this->inTransaction)
+        {
+            if(commit)
+            {
+                writeLayer->CommitTransaction();
+            }
+            else
+            {
+                writeLayer->RollbackTransaction();
+            }
+            this->inTransaction = false;
+            this->numInTransaction = 0;
+        }
+        this->destroyBatch(&this->readFeats);
+        this->destroyBatch(&this->procFeats);
+        this->destroyBatch(&this->writeFeats);
+        for(size_t i = 1; i < this->processors.size(); ++i)
+        {
+            delete this->processors[i];
+        }
+        this->processors.clear();
+    }
+
+    void RSGISProcessFeatureBatches::printFeedback()
+    {
+        if((this->numFeatures > 10) && (this->numWritten == this->nextFeedback) && (this->feedbackCounter <= 100))
+        {
+            if(this->outVertical)
+            {
+                std::cout << this->feedbackCounter << "% Done" << std::endl;
+            }
+            else
+            {
+                std::cout << "." << this->feedbackCounter << "." << std::flush;
+            }
+            this->feedbackCounter += this->feedbackStep;
+            this->nextFeedback += std::max<int>((int)(((long)this->numFeatures * this->feedbackStep) / 100), 1);
+        }
+    }
+
+    void RSGISProcessFeatureBatches::copyFeatureData(OGRFeature *inFeature, OGRFeature *outFeature, OGRFeatureDefn *inFeatureDefn, OGRFeatureDefn *outFeatureDefn)
+    {
+        int fieldCount = inFeatureDefn->GetFieldCount();
+        for(int i = 0; i < fieldCount; i++)
+        {
+            outFeature->SetField(outFeatureDefn->GetFieldIndex(inFeatureDefn->GetFieldDefn(i)->GetNameRef()), inFeature->GetRawFieldRef(i));
+        }
+    }
+
+    RSGISProcessFeatureBatches::~RSGISProcessFeatureBatches()
+    {
+
+    }
+
+}}
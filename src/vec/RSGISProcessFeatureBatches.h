@@ -0,0 +1,123 @@
+/*
+ *  RSGISProcessFeatureBatches.h
+ *  RSGIS_LIB
+ *
+ *  Created on 19/10/2026.
+ *  Copyright 2026 RSGISLib.
+ *
+ *  RSGISLib is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  RSGISLib is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with RSGISLib.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RSGISProcessFeatureBatches_H
+#define RSGISProcessFeatureBatches_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <exception>
+
+#include "ogrsf_frmts.h"
+
+#include "common/RSGISVectorException.h"
+
+#include "img/RSGISImageThreadUtils.h"
+
+#include "vec/RSGISVectorOutputException.h"
+#include "vec/RSGISProcessOGRFeature.h"
+#include "vec/RSGISVectorUtils.h"
+
+#include "geos/geom/Envelope.h"
+
+// mark all exported classes/functions with DllExport to have
+// them exported by Visual Studio
+#undef DllExport
+#ifdef _MSC_VER
+    #ifdef rsgis_vec_EXPORTS
+        #define DllExport   __declspec( dllexport )
+    #else
+        #define DllExport   __declspec( dllimport )
+    #endif
+#else
+    #define DllExport
+#endif
+
+namespace rsgis{namespace vec{
+
+    /**
+     * Runs a RSGISProcessOGRFeature over the features of a layer. An OGR layer
+     * cannot be used from several threads so the features are read in batches,
+     * and written back in their input order, on the calling thread. Writes are
+     * grouped into transactions of featsPerTransaction features.
+     *
+     * If the processor can be cloned (RSGISProcessOGRFeature::clone) each batch
+     * is processed by the processor and its clones, one per thread, while the
+     * previous batch is written and the next one read. Otherwise the features
+     * are processed one at a time on the calling thread.
+     */
+    class DllExport RSGISProcessFeatureBatches
+    {
+    public:
+        RSGISProcessFeatureBatches(RSGISProcessOGRFeature *processFeatures, unsigned int numThreads=0, unsigned int batchSize=1000, unsigned int featsPerTransaction=20000);
+        /** A new feature is created in the output layer for each input feature (the output layer definition must already be created). */
+        void processToLayer(OGRLayer *inputLayer, OGRLayer *outputLayer, bool copyData);
+        /** The processed features are written back to the input layer. */
+        void processInPlace(OGRLayer *inputLayer);
+        void processNoOutput(OGRLayer *inputLayer);
+        /** Progress is printed every 10% (5% with moreFeedback), one line per step if outVertical. */
+        void setFeedback(bool outVertical, bool moreFeedback);
+        ~RSGISProcessFeatureBatches();
+    protected:
+        enum FeatureOutput
+        {
+            featsToLayer,
+            featsInPlace,
+            featsNoOutput
+        };
+        struct FeatureJob
+        {
+            OGRFeature *inFeature;
+            OGRFeature *outFeature;
+            bool nullGeometry;
+        };
+        void processLayer(OGRLayer *inputLayer, OGRLayer *outputLayer, FeatureOutput output, bool copyData);
+        void readBatch(OGRLayer *inputLayer, OGRFeatureDefn *outFeatureDefn, std::vector<FeatureJob> *batch);
+        void processFeature(RSGISProcessOGRFeature *processor, FeatureJob *job, FeatureOutput output, bool copyData, OGRFeatureDefn *inFeatureDefn, OGRFeatureDefn *outFeatureDefn);
+        void writeBatch(OGRLayer *writeLayer, FeatureOutput output, std::vector<FeatureJob> *batch);
+        void destroyBatch(std::vector<FeatureJob> *batch);
+        void finish(OGRLayer *writeLayer, bool commit);
+        void printFeedback();
+        void copyFeatureData(OGRFeature *inFeature, OGRFeature *outFeature, OGRFeatureDefn *inFeatureDefn, OGRFeatureDefn *outFeatureDefn);
+        RSGISProcessOGRFeature *processFeatures;
+        unsigned int numThreads;
+        unsigned int batchSize;
+        unsigned int featsPerTransaction;
+        std::vector<RSGISProcessOGRFeature*> processors;
+        std::vector<FeatureJob> readFeats;
+        std::vector<FeatureJob> procFeats;
+        std::vector<FeatureJob> writeFeats;
+        bool inTransaction;
+        unsigned int numInTransaction;
+        int numFeatures;
+        int numWritten;
+        bool outVertical;
+        int feedbackStep;
+        int feedbackCounter;
+        int nextFeedback;
+    };
+}}
+
+#endif
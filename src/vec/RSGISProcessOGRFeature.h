@@ -56,6 +56,12 @@ namespace rsgis{namespace vec{
 			virtual void processFeature(OGRFeature *inFeature, OGRFeature *outFeature, geos::geom::Envelope *env, long fid)= 0;
 			virtual void processFeature(OGRFeature *feature, geos::geom::Envelope *env, long fid)= 0;
 			virtual void createOutputLayerDefinition(OGRLayer *outputLayer, OGRFeatureDefn *inFeatureDefn) = 0;
+			/**
+			 * A copy which can process features on another thread at the same time
+			 * as this one, or NULL (the default) if features must be processed one
+			 * at a time. The copy is deleted by the caller.
+			 */
+			virtual RSGISProcessOGRFeature* clone(){return NULL;};
 			virtual ~RSGISProcessOGRFeature(){};
 		};
 }}
@@ -25,154 +25,33 @@
 
 namespace rsgis{namespace vec{
 	
-	RSGISProcessVector::RSGISProcessVector(RSGISProcessOGRFeature *processFeatures)
+	RSGISProcessVector::RSGISProcessVector(RSGISProcessOGRFeature *processFeatures, unsigned int numThreads)
 	{
 		this->processFeatures = processFeatures;
+		this->numThreads = numThreads;
 	}
 	
 	void RSGISProcessVector::processVectors(OGRLayer *inputLayer, OGRLayer *outputLayer, bool copyData, bool outVertical, bool newFirst)
 	{
-		RSGISVectorUtils vecUtils;
-		
-		geos::geom::Envelope *env = NULL;
-		OGRGeometry *geometry = NULL;
-		
-		OGRFeature *inFeature = NULL;
-		OGRFeature *outFeature = NULL;
-		
-		OGRFeatureDefn *inFeatureDefn = NULL;
-		OGRFeatureDefn *outFeatureDefn = NULL;
-		
-		long fid = 0;
-		
 		try
 		{
-			inFeatureDefn = inputLayer->GetLayerDefn();
-			
-			if(copyData)
+			// newFirst puts the processor's fields before those copied from the input.
+			if(newFirst)
 			{
-				this->copyFeatureDefn(outputLayer, inFeatureDefn);
+				this->processFeatures->createOutputLayerDefinition(outputLayer, inputLayer->GetLayerDefn());
 			}
-			this->processFeatures->createOutputLayerDefinition(outputLayer, inFeatureDefn);
-			
-			outFeatureDefn = outputLayer->GetLayerDefn();
-			
-			int numFeatures = inputLayer->GetFeatureCount(TRUE);
-			
-			bool nullGeometry = false;
-			
-			int feedback = numFeatures/10;
-			int feedbackCounter = 0;
-			int i = 0;
-			
-			if(outVertical)
+			if(copyData)
 			{
-				std::cout << "Started, " << numFeatures << " features to process.\n";
+				this->copyFeatureDefn(outputLayer, inputLayer->GetLayerDefn());
 			}
-			else
-			{
-				std::cout << "Started" << std::flush;
-			}	
-
-            bool inTransaction = false;
-			inputLayer->ResetReading();
-			while( (inFeature = inputLayer->GetNextFeature()) != NULL )
+			if(!newFirst)
 			{
-				if((numFeatures > 10) && ((i % feedback) == 0) && feedbackCounter <= 100)
-				{
-					if(outVertical)
-					{
-						std::cout << feedbackCounter << "% Done" << std::endl;
-					}
-					else
-					{
-						std::cout << "." << feedbackCounter << "." << std::flush;
-					}
-					
-					feedbackCounter = feedbackCounter + 10;
-				}
-                if(!inTransaction)
-                {
-                    outputLayer->StartTransaction();
-                    inTransaction = true;
-                }
-				
-				fid = inFeature->GetFID();
-				
-				outFeature = OGRFeature::CreateFeature(outFeatureDefn);
-
-				// Get Geometry.
-				nullGeometry = false;
-				geometry = inFeature->GetGeometryRef();
-				if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbPolygon )
-				{
-					OGRPolygon *polygon = (OGRPolygon *) geometry;
-					outFeature->SetGeometry(polygon);
-					env = vecUtils.getEnvelope(polygon);
-				} 
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbMultiPolygon )
-				{
-					OGRMultiPolygon *multiPolygon = (OGRMultiPolygon *) geometry;
-					outFeature->SetGeometry(multiPolygon);
-					env = vecUtils.getEnvelope(multiPolygon);
-				}
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbPoint )
-				{
-					OGRPoint *point = (OGRPoint *) geometry;
-					outFeature->SetGeometry(point);
-					env = vecUtils.getEnvelope(point);
-				}	
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbLineString )
-				{
-					OGRLineString *line = (OGRLineString *) geometry;
-					outFeature->SetGeometry(line);
-					env = vecUtils.getEnvelope(line);
-				}
-				else if(geometry != NULL)
-				{
-					std::string message = std::string("Unsupport data type: ") + std::string(geometry->getGeometryName());
-					throw RSGISVectorException(message);
-				}
-				else 
-				{
-					nullGeometry = true;
-					std::cout << "WARNING: NULL Geometry Present within input file - IGNORED\n";
-				}
-				
-				if(!nullGeometry)
-				{
-					processFeatures->processFeature(inFeature, outFeature, env, fid);
-					
-					delete env;
-					
-					outFeature->SetFID(fid);
-					
-					if(copyData)
-					{
-						this->copyFeatureData(inFeature, outFeature, inFeatureDefn, outFeatureDefn);
-					}
-					
-					if( outputLayer->CreateFeature(outFeature) != OGRERR_NONE )
-					{
-						throw RSGISVectorOutputException("Failed to write feature to the output shapefile.");
-					}
-
-					OGRFeature::DestroyFeature(outFeature);
-				}
-				OGRFeature::DestroyFeature(inFeature);
-				i++;
-                if(((i % 20000) == 0) & inTransaction)
-                {
-                    inputLayer->CommitTransaction();
-                    inTransaction = false;
-                }
-            }
-            if(inTransaction)
-            {
-                inputLayer->CommitTransaction();
-                inTransaction = false;
-            }
-			std::cout << " Complete.\n";
+				this->processFeatures->createOutputLayerDefinition(outputLayer, inputLayer->GetLayerDefn());
+			}
+			
+			RSGISProcessFeatureBatches processBatches(this->processFeatures, this->numThreads);
+			processBatches.setFeedback(outVertical, false);
+			processBatches.processToLayer(inputLayer, outputLayer, copyData);
 		}
 		catch(RSGISVectorOutputException& e)
 		{
@@ -186,139 +65,11 @@ namespace rsgis{namespace vec{
 		
 	void RSGISProcessVector::processVectors(OGRLayer *inputLayer, bool outVertical, bool morefeedback)
 	{
-		RSGISVectorUtils vecUtils;
-		
-		geos::geom::Envelope *env = NULL;
-		OGRGeometry *geometry = NULL;
-		
-		OGRFeature *inFeature = NULL;
-		
-		OGRFeatureDefn *inFeatureDefn = NULL;
-		
-		long fid = 0;
-		
 		try
 		{
-			inFeatureDefn = inputLayer->GetLayerDefn();
-			
-			int numFeatures = inputLayer->GetFeatureCount(TRUE);
-			
-			bool nullGeometry = false;
-			
-			int feedback = numFeatures/10;
-			int feedbackCounter = 0;
-            unsigned long nextFeedback = 0;
-			int i = 0;
-
-            if(morefeedback)
-            {
-                feedback = numFeatures/20;
-            }
-			
-			if(outVertical)
-			{
-				std::cout << "Started, " << numFeatures << " features to process.\n";
-			}
-			else
-			{
-				std::cout << "Started (" << numFeatures << " features) " << std::flush;
-			}	
-
-            bool inTransaction = false;
-			inputLayer->ResetReading();
-			while( (inFeature = inputLayer->GetNextFeature()) != NULL )
-			{
-				if((numFeatures > 10) && (i == nextFeedback) && feedbackCounter <= 100)
-				{
-					if(outVertical)
-					{
-						std::cout << feedbackCounter << "% Done" << std::endl;
-					}
-					else
-					{
-						std::cout << "." << feedbackCounter << "." << std::flush;
-					}
-
-                    if(morefeedback)
-                    {
-                        feedbackCounter = feedbackCounter + 5;
-                    }
-                    else
-                    {
-                        feedbackCounter = feedbackCounter + 10;
-                    }
-                    nextFeedback = nextFeedback + feedback;
-				}
-                if(!inTransaction)
-                {
-                    inputLayer->StartTransaction();
-                    inTransaction = true;
-                }
-				
-				fid = inFeature->GetFID();
-				
-				// Get Geometry.
-				nullGeometry = false;
-				geometry = inFeature->GetGeometryRef();
-				if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbPolygon )
-				{
-					OGRPolygon *polygon = (OGRPolygon *) geometry;
-					env = vecUtils.getEnvelope(polygon);
-				} 
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbMultiPolygon )
-				{
-					OGRMultiPolygon *multiPolygon = (OGRMultiPolygon *) geometry;
-					env = vecUtils.getEnvelope(multiPolygon);
-				}
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbPoint )
-				{
-					OGRPoint *point = (OGRPoint *) geometry;
-					env = vecUtils.getEnvelope(point);
-				}	
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbLineString )
-				{
-					OGRLineString *line = (OGRLineString *) geometry;
-					env = vecUtils.getEnvelope(line);
-				}
-				else if(geometry != NULL)
-				{
-					std::string message = std::string("Unsupport data type: ") + std::string(geometry->getGeometryName());
-					throw RSGISVectorException(message);
-				}
-				else 
-				{
-					nullGeometry = true;
-					std::cout << "WARNING: NULL Geometry Present within input file - IGNORED\n";
-				}
-				
-				if(!nullGeometry)
-				{					
-					processFeatures->processFeature(inFeature, env, fid);
-					
-					delete env;
-
-					if( inputLayer->SetFeature(inFeature) != OGRERR_NONE )
-					{
-						throw RSGISVectorOutputException("Failed to write feature to the vector layer.");
-					}
-				}
-				
-				OGRFeature::DestroyFeature(inFeature);
-				i++;
-                if(((i % 20000) == 0) & inTransaction)
-                {
-                    std::cout << "w" << std::flush;
-                    inputLayer->CommitTransaction();
-                    inTransaction = false;
-                }
-			}
-            if(inTransaction)
-            {
-                std::cout << "w" << std::flush;
-                inputLayer->CommitTransaction();
-                inTransaction = false;
-            }
-			std::cout << " Complete.\n";
+			RSGISProcessFeatureBatches processBatches(this->processFeatures, this->numThreads);
+			processBatches.setFeedback(outVertical, morefeedback);
+			processBatches.processInPlace(inputLayer);
 		}
 		catch(RSGISVectorOutputException& e)
 		{
@@ -332,107 +83,11 @@ namespace rsgis{namespace vec{
 	
 	void RSGISProcessVector::processVectorsNoOutput(OGRLayer *inputLayer, bool outVertical)
 	{
-		RSGISVectorUtils vecUtils;
-		
-		geos::geom::Envelope *env = NULL;
-		OGRGeometry *geometry = NULL;
-		
-		OGRFeature *inFeature = NULL;
-		
-		OGRFeatureDefn *inFeatureDefn = NULL;
-		
-		long fid = 0;
-		
 		try
 		{
-			inFeatureDefn = inputLayer->GetLayerDefn();
-			
-			bool nullGeometry = false;
-			
-			int numFeatures = inputLayer->GetFeatureCount(TRUE);
-			int feedback = numFeatures/10;
-			int feedbackCounter = 0;
-
-			int i = 0;
-			if(outVertical)
-			{
-				std::cout << "Started, " << numFeatures << " features to process.\n";
-			}
-			else
-			{
-				std::cout << "Started" << std::flush;
-			}
-			
-			
-			inputLayer->ResetReading();
-			while( (inFeature = inputLayer->GetNextFeature()) != NULL )
-			{
-				if((numFeatures > 10) && ((i % feedback) == 0) && feedbackCounter <= 100)
-				{
-					if(outVertical)
-					{
-						std::cout << feedbackCounter << "% Done\n";
-					}
-					else
-					{
-						std::cout << ".." << feedbackCounter << ".." << std::flush;
-					}
-					
-					feedbackCounter = feedbackCounter + 10;
-				}
-				
-				fid = inFeature->GetFID();
-				
-				// Get Geometry.
-				nullGeometry = false;
-				geometry = inFeature->GetGeometryRef();
-				if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbPolygon )
-				{
-					OGRPolygon *polygon = (OGRPolygon *) geometry;
-					env = vecUtils.getEnvelope(polygon);
-				} 
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbMultiPolygon )
-				{
-					OGRMultiPolygon *multiPolygon = (OGRMultiPolygon *) geometry;
-					env = vecUtils.getEnvelope(multiPolygon);
-				}
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbPoint )
-				{
-					OGRPoint *point = (OGRPoint *) geometry;
-					env = vecUtils.getEnvelope(point);
-				}
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbLineString )
-				{
-					OGRLineString *line = (OGRLineString *) geometry;
-					env = vecUtils.getEnvelope(line);
-				}
-                else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbMultiLineString )
-				{
-					OGRMultiLineString *line = (OGRMultiLineString *) geometry;
-					env = vecUtils.getEnvelope(line);
-				}
-				else if(geometry != NULL)
-				{
-					std::string message = std::string("Unsupport data type: ") + std::string(geometry->getGeometryName());
-					throw RSGISVectorException(message);
-				}
-				else 
-				{
-					nullGeometry = true;
-					std::cout << "WARNING: NULL Geometry Present within input file - IGNORED\n";
-				}
-				
-				if(!nullGeometry)
-				{			
-					processFeatures->processFeature(inFeature, env, fid);
-				
-					delete env;
-				}
-
-				OGRFeature::DestroyFeature(inFeature);
-				i++;
-			}
-			std::cout << " Complete.\n";			
+			RSGISProcessFeatureBatches processBatches(this->processFeatures, this->numThreads);
+			processBatches.setFeedback(outVertical, false);
+			processBatches.processNoOutput(inputLayer);
 		}
 		catch(RSGISVectorOutputException& e)
 		{
@@ -457,16 +112,6 @@ namespace rsgis{namespace vec{
 		}
 	}
 	
-	void RSGISProcessVector::copyFeatureData(OGRFeature *inFeature, OGRFeature *outFeature, OGRFeatureDefn *inFeatureDefn, OGRFeatureDefn *outFeatureDefn)
-	{
-		int fieldCount = inFeatureDefn->GetFieldCount();
-		for(int i = 0; i < fieldCount; i++)
-		{
-			outFeature->SetField(outFeatureDefn->GetFieldIndex(inFeatureDefn->GetFieldDefn(i)->GetNameRef()), inFeature->GetRawFieldRef(inFeatureDefn->GetFieldIndex(inFeatureDefn->GetFieldDefn(i)->GetNameRef())));
-		}
-		
-	}
-	
     void RSGISProcessVector::printGeometry(OGRGeometry *geometry)
     {
         if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbPolygon )
@@ -37,6 +37,7 @@
 
 #include "vec/RSGISVectorOutputException.h"
 #include "vec/RSGISProcessOGRFeature.h"
+#include "vec/RSGISProcessFeatureBatches.h"
 #include "vec/RSGISVectorUtils.h"
 
 #include "geos/geom/Envelope.h"
@@ -59,17 +60,19 @@ namespace rsgis{namespace vec{
 	class DllExport RSGISProcessVector
 		{
 		public:
-			RSGISProcessVector(RSGISProcessOGRFeature *processFeatures);
+			/** Features are processed on numThreads threads (0 uses all cores) if the processor can be cloned. */
+			RSGISProcessVector(RSGISProcessOGRFeature *processFeatures, unsigned int numThreads=0);
+			/** If newFirst the processor's output fields are created before the fields copied from the input. */
 			void processVectors(OGRLayer *inputLayer, OGRLayer *outputLayer, bool copyData, bool outVertical, bool newFirst);
 			void processVectors(OGRLayer *inputLayer, bool outVertical, bool morefeedback=false);
 			void processVectorsNoOutput(OGRLayer *inputLayer, bool outVertical);
 			~RSGISProcessVector();
 		protected:
 			void copyFeatureDefn(OGRLayer *outputSHPLayer, OGRFeatureDefn *inFeatureDefn);
-			void copyFeatureData(OGRFeature *inFeature, OGRFeature *outFeature, OGRFeatureDefn *inFeatureDefn, OGRFeatureDefn *outFeatureDefn);
             void printGeometry(OGRGeometry *geometry);
             void printRing(OGRLinearRing *inGeomRing);
 			RSGISProcessOGRFeature *processFeatures;
+			unsigned int numThreads;
 		};
 }}
 
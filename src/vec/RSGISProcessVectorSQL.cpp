@@ -27,157 +27,31 @@
 
 namespace rsgis{namespace vec{
 	
-	RSGISProcessVectorSQL::RSGISProcessVectorSQL(RSGISProcessOGRFeature *processFeatures)
+	RSGISProcessVectorSQL::RSGISProcessVectorSQL(RSGISProcessOGRFeature *processFeatures, unsigned int numThreads)
 	{
 		this->processFeatures = processFeatures;
+		this->numThreads = numThreads;
 	}
 	
 	void RSGISProcessVectorSQL::processVectors(GDALDataset *inputDS, OGRLayer *outputLayer, bool copyData, bool outVertical, std::string sql)
 	{
-		RSGISVectorUtils vecUtils;
-		
-		geos::geom::Envelope *env = NULL;
-		OGRGeometry *geometry = NULL;
-		
-		OGRFeature *inFeature = NULL;
-		OGRFeature *outFeature = NULL;
-		
-		OGRFeatureDefn *inFeatureDefn = NULL;
-		OGRFeatureDefn *outFeatureDefn = NULL;
-		
-		OGRLayer *inputLayer = NULL;
-		
-		long fid = 0;
-		
 		try
-		{	
+		{
 			/* Run SQL statement */
-			inputLayer = inputDS->ExecuteSQL(sql.c_str(), NULL, "generic");
+			OGRLayer *inputLayer = inputDS->ExecuteSQL(sql.c_str(), NULL, "generic");
 			
 			/* Create output layer definition */
-			inFeatureDefn = inputLayer->GetLayerDefn();
-			
 			if(copyData)
 			{
-				this->copyFeatureDefn(outputLayer, inFeatureDefn);
+				this->copyFeatureDefn(outputLayer, inputLayer->GetLayerDefn());
 			}
-			this->processFeatures->createOutputLayerDefinition(outputLayer, inFeatureDefn);
-			
-			outFeatureDefn = outputLayer->GetLayerDefn();
+			this->processFeatures->createOutputLayerDefinition(outputLayer, inputLayer->GetLayerDefn());
 			
-			int numFeatures = inputLayer->GetFeatureCount(TRUE);
-			
-            std::cout << numFeatures << " features where selected.\n";
+            std::cout << inputLayer->GetFeatureCount(TRUE) << " features where selected.\n";
             
-			bool nullGeometry = false;
-			
-			int feedback = numFeatures/10;
-			int feedbackCounter = 0;
-			int i = 0;
-			bool toFeedback = true;
-			if(numFeatures < 10)
-			{
-				toFeedback = false;
-			}
-			
-			if(toFeedback)
-			{
-				if(outVertical)
-				{
-					std::cout << "Started, " << numFeatures << " features to process.\n";
-				}
-				else
-				{
-					std::cout << "Started" << std::flush;
-				}				
-			}			
-			inputLayer->ResetReading();
-			while( (inFeature = inputLayer->GetNextFeature()) != NULL )
-			{
-				if(toFeedback && (i % feedback) == 0)
-				{
-					if(outVertical)
-					{
-						std::cout << feedbackCounter << "% Done" << std::endl;
-					}
-					else
-					{
-						std::cout << ".." << feedbackCounter << ".." << std::flush;
-					}
-					
-					feedbackCounter = feedbackCounter + 10;
-				}
-				
-				fid = inFeature->GetFID();
-				
-				outFeature = OGRFeature::CreateFeature(outFeatureDefn);
-				
-				// Get Geometry.
-				nullGeometry = false;
-				geometry = inFeature->GetGeometryRef();
-				if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbPolygon )
-				{
-					OGRPolygon *polygon = (OGRPolygon *) geometry;
-					outFeature->SetGeometry(polygon);
-					env = vecUtils.getEnvelope(polygon);
-				} 
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbMultiPolygon )
-				{
-					OGRMultiPolygon *multiPolygon = (OGRMultiPolygon *) geometry;
-					outFeature->SetGeometry(multiPolygon);
-					env = vecUtils.getEnvelope(multiPolygon);
-				}
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbPoint )
-				{
-					OGRPoint *point = (OGRPoint *) geometry;
-					outFeature->SetGeometry(point);
-					env = vecUtils.getEnvelope(point);
-				}	
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbLineString )
-				{
-					OGRLineString *line = (OGRLineString *) geometry;
-					outFeature->SetGeometry(line);
-					env = vecUtils.getEnvelope(line);
-				}
-				else if(geometry != NULL)
-				{
-					std::string message = std::string("Unsupport data type: ") + std::string(geometry->getGeometryName());
-					throw RSGISVectorException(message);
-				}
-				else 
-				{
-					nullGeometry = true;
-					std::cout << "WARNING: NULL Geometry Present within input file - IGNORED\n";
-				}
-				
-				if(!nullGeometry)
-				{
-					processFeatures->processFeature(inFeature, outFeature, env, fid);
-					
-					delete env;
-					
-					outFeature->SetFID(fid);
-					
-					if(copyData)
-					{
-						this->copyFeatureData(inFeature, outFeature, inFeatureDefn, outFeatureDefn);
-					}
-					
-					if( outputLayer->CreateFeature(outFeature) != OGRERR_NONE )
-					{
-						throw RSGISVectorOutputException("Failed to write feature to the output shapefile.");
-					}
-					
-					OGRFeature::DestroyFeature(outFeature);
-				}
-				
-				OGRFeature::DestroyFeature(inFeature);
-				i++;
-			}
-			if(toFeedback)
-			{
-				std::cout << " Complete.\n";
-			}
+			RSGISProcessFeatureBatches processBatches(this->processFeatures, this->numThreads);
+			processBatches.setFeedback(outVertical, false);
+			processBatches.processToLayer(inputLayer, outputLayer, copyData);
 		}
 		catch(RSGISVectorOutputException& e)
 		{
@@ -191,124 +65,14 @@ namespace rsgis{namespace vec{
 	
 	void RSGISProcessVectorSQL::processVectors(GDALDataset *inputDS, bool outVertical, std::string sql)
 	{
-		RSGISVectorUtils vecUtils;
-		
-		geos::geom::Envelope *env = NULL;
-		OGRGeometry *geometry = NULL;
-		
-		OGRFeature *inFeature = NULL;
-		
-		OGRFeatureDefn *inFeatureDefn = NULL;
-		
-		long fid = 0;
-		
-		OGRLayer *inputLayer = NULL;
-		
 		try
 		{
 			/* Run SQL statement */
-			inputLayer = inputDS->ExecuteSQL(sql.c_str(), NULL, "generic");
-			
-			/* Create output layer definition */
-			inFeatureDefn = inputLayer->GetLayerDefn();
-			
-			int numFeatures = inputLayer->GetFeatureCount(TRUE);
-			
-			bool nullGeometry = false;
-			
-			int feedback = numFeatures/10;
-			int feedbackCounter = 0;
-			int i = 0;
-			bool toFeedback = true;
-			if(numFeatures < 10)
-			{
-				toFeedback = false;
-			}
-			
-			if(toFeedback)
-			{
-				if(outVertical)
-				{
-					std::cout << "Started, " << numFeatures << " features to process.\n";
-				}
-				else
-				{
-					std::cout << "Started" << std::flush;
-				}				
-			}
+			OGRLayer *inputLayer = inputDS->ExecuteSQL(sql.c_str(), NULL, "generic");
 			
-			inputLayer->ResetReading();
-			while( (inFeature = inputLayer->GetNextFeature()) != NULL )
-			{
-				if(toFeedback && (i % feedback) == 0)
-				{
-					if(outVertical)
-					{
-						std::cout << feedbackCounter << "% Done" << std::endl;
-					}
-					else
-					{
-						std::cout << ".." << feedbackCounter << ".." << std::flush;
-					}
-					
-					feedbackCounter = feedbackCounter + 10;
-				}
-				
-				fid = inFeature->GetFID();
-				
-				// Get Geometry.
-				nullGeometry = false;
-				geometry = inFeature->GetGeometryRef();
-				if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbPolygon )
-				{
-					OGRPolygon *polygon = (OGRPolygon *) geometry;
-					env = vecUtils.getEnvelope(polygon);
-				} 
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbMultiPolygon )
-				{
-					OGRMultiPolygon *multiPolygon = (OGRMultiPolygon *) geometry;
-					env = vecUtils.getEnvelope(multiPolygon);
-				}
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbPoint )
-				{
-					OGRPoint *point = (OGRPoint *) geometry;
-					env = vecUtils.getEnvelope(point);
-				}	
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbLineString )
-				{
-					OGRLineString *line = (OGRLineString *) geometry;
-					env = vecUtils.getEnvelope(line);
-				}
-				else if(geometry != NULL)
-				{
-					std::string message = std::string("Unsupport data type: ") + std::string(geometry->getGeometryName());
-					throw RSGISVectorException(message);
-				}
-				else 
-				{
-					nullGeometry = true;
-					std::cout << "WARNING: NULL Geometry Present within input file - IGNORED\n";
-				}
-				
-				if(!nullGeometry)
-				{					
-					processFeatures->processFeature(inFeature, env, fid);
-					
-					delete env;
-					
-					if( inputLayer->SetFeature(inFeature) != OGRERR_NONE )
-					{
-						throw RSGISVectorOutputException("Failed to write feature to the shapefile.");
-					}
-				}
-				
-				OGRFeature::DestroyFeature(inFeature);
-				i++;
-			}
-			if(toFeedback)
-			{
-				std::cout << " Complete.\n";
-			}
+			RSGISProcessFeatureBatches processBatches(this->processFeatures, this->numThreads);
+			processBatches.setFeedback(outVertical, false);
+			processBatches.processInPlace(inputLayer);
 		}
 		catch(RSGISVectorOutputException& e)
 		{
@@ -322,119 +86,14 @@ namespace rsgis{namespace vec{
 	
 	void RSGISProcessVectorSQL::processVectorsNoOutput(GDALDataset *inputDS, bool outVertical, std::string sql)
 	{
-		RSGISVectorUtils vecUtils;
-		
-		geos::geom::Envelope *env = NULL;
-		OGRGeometry *geometry = NULL;
-		
-		OGRFeature *inFeature = NULL;
-		
-		OGRFeatureDefn *inFeatureDefn = NULL;
-		
-		OGRLayer *inputLayer = NULL;
-		
-		long fid = 0;
-		
 		try
 		{
 			/* Run SQL statement */
-			inputLayer = inputDS->ExecuteSQL(sql.c_str(), NULL, "generic");
-			
-			/* Create output layer definition */
-			inFeatureDefn = inputLayer->GetLayerDefn();
-			
-			bool nullGeometry = false;
+			OGRLayer *inputLayer = inputDS->ExecuteSQL(sql.c_str(), NULL, "generic");
 			
-			int numFeatures = inputLayer->GetFeatureCount(TRUE);
-			int feedback = numFeatures/10;
-			int feedbackCounter = 0;
-			bool toFeedback = true;
-			if(numFeatures < 10)
-			{
-				toFeedback = false;
-			}
-			
-			int i = 0;
-			if(toFeedback)
-			{
-				if(outVertical)
-				{
-					std::cout << "Started, " << numFeatures << " features to process.\n";
-				}
-				else
-				{
-					std::cout << "Started" << std::flush;
-				}
-			}
-			
-			
-			inputLayer->ResetReading();
-			while( (inFeature = inputLayer->GetNextFeature()) != NULL )
-			{
-				if(toFeedback && (i % feedback) == 0)
-				{
-					if(outVertical)
-					{
-						std::cout << feedbackCounter << "% Done" << std::endl;
-					}
-					else
-					{
-						std::cout << ".." << feedbackCounter << ".." << std::flush;
-					}
-					
-					feedbackCounter = feedbackCounter + 10;
-				}
-				
-				fid = inFeature->GetFID();
-				
-				// Get Geometry.
-				nullGeometry = false;
-				geometry = inFeature->GetGeometryRef();
-				if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbPolygon )
-				{
-					OGRPolygon *polygon = (OGRPolygon *) geometry;
-					env = vecUtils.getEnvelope(polygon);
-				} 
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbMultiPolygon )
-				{
-					OGRMultiPolygon *multiPolygon = (OGRMultiPolygon *) geometry;
-					env = vecUtils.getEnvelope(multiPolygon);
-				}
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbPoint )
-				{
-					OGRPoint *point = (OGRPoint *) geometry;
-					env = vecUtils.getEnvelope(point);
-				}
-				else if( geometry != NULL && wkbFlatten(geometry->getGeometryType()) == wkbLineString )
-				{
-					OGRLineString *line = (OGRLineString *) geometry;
-					env = vecUtils.getEnvelope(line);
-				}
-				else if(geometry != NULL)
-				{
-					std::string message = std::string("Unsupport data type: ") + std::string(geometry->getGeometryName());
-					throw RSGISVectorException(message);
-				}
-				else 
-				{
-					nullGeometry = true;
-					std::cout << "WARNING: NULL Geometry Present within input file - IGNORED\n";
-				}
-				
-				if(!nullGeometry)
-				{			
-					processFeatures->processFeature(inFeature, env, fid);
-					
-					delete env;
-				}
-				
-				OGRFeature::DestroyFeature(inFeature);
-				i++;
-			}
-			if(toFeedback)
-			{
-				std::cout << " Complete.\n";
-			}			
+			RSGISProcessFeatureBatches processBatches(this->processFeatures, this->numThreads);
+			processBatches.setFeedback(outVertical, false);
+			processBatches.processNoOutput(inputLayer);
 		}
 		catch(RSGISVectorOutputException& e)
 		{
@@ -459,16 +118,6 @@ namespace rsgis{namespace vec{
 		}
 	}
 	
-	void RSGISProcessVectorSQL::copyFeatureData(OGRFeature *inFeature, OGRFeature *outFeature, OGRFeatureDefn *inFeatureDefn, OGRFeatureDefn *outFeatureDefn)
-	{
-		int fieldCount = inFeatureDefn->GetFieldCount();
-		for(int i = 0; i < fieldCount; i++)
-		{
-			outFeature->SetField(outFeatureDefn->GetFieldIndex(inFeatureDefn->GetFieldDefn(i)->GetNameRef()), inFeature->GetRawFieldRef(inFeatureDefn->GetFieldIndex(inFeatureDefn->GetFieldDefn(i)->GetNameRef())));
-		}
-		
-	}
-	
 	RSGISProcessVectorSQL::~RSGISProcessVectorSQL()
 	{
 		
@@ -37,6 +37,7 @@
 
 #include "vec/RSGISVectorOutputException.h"
 #include "vec/RSGISProcessOGRFeature.h"
+#include "vec/RSGISProcessFeatureBatches.h"
 #include "vec/RSGISVectorUtils.h"
 
 #include "geos/geom/Envelope.h"
@@ -59,15 +60,16 @@ namespace rsgis{namespace vec{
 	class DllExport RSGISProcessVectorSQL
 	{
 	public:
-		RSGISProcessVectorSQL(RSGISProcessOGRFeature *processFeatures);
+		/** Features are processed on numThreads threads (0 uses all cores) if the processor can be cloned. */
+		RSGISProcessVectorSQL(RSGISProcessOGRFeature *processFeatures, unsigned int numThreads=0);
 		void processVectors(GDALDataset *inputDS, OGRLayer *outputLayer, bool copyData, bool outVertical, std::string sql);
 		void processVectors(GDALDataset *inputDS, bool outVertical, std::string sql);
 		void processVectorsNoOutput(GDALDataset *inputDS, bool outVertical, std::string sql);
 		~RSGISProcessVectorSQL();
 	protected:
 		void copyFeatureDefn(OGRLayer *outputSHPLayer, OGRFeatureDefn *inFeatureDefn);
-		void copyFeatureData(OGRFeature *inFeature, OGRFeature *outFeature, OGRFeatureDefn *inFeatureDefn, OGRFeatureDefn *outFeatureDefn);
 		RSGISProcessOGRFeature *processFeatures;
+		unsigned int numThreads;
 	};
 }}
 
@@ -94,10 +94,14 @@ namespace rsgis{namespace vec{
 			imageExtent = new geos::geom::Envelope(xMin, xMax, yMin, yMax);
 			
 			imgRes = geoTransform[1];
-		
-			pxlValues = (float *) CPLMalloc(sizeof(float));
 		}
         
+        // The points are read through a tile cache per band so nearby points share the decoded tiles.
+        for(int i = 0; i < numImgBands; ++i)
+        {
+            this->bandCaches.push_back(new rsgis::img::RSGISImageTileCache<float>(bands[i], false, 134217728/numImgBands));
+        }
+        
         if (outZonalFileName != "")
 		{
 			this->outputToTextFile = true;
@@ -280,10 +284,12 @@ namespace rsgis{namespace vec{
 	float* RSGISVectorZonalStats::getPixelColumns(int xPxl, int yPxl)
 	{
 		float *values = new float[numImgBands];
+        // Guard against rounding at the maximum edge of the image.
+        xPxl = std::min(std::max(xPxl, 0), this->image->GetRasterXSize()-1);
+        yPxl = std::min(std::max(yPxl, 0), this->image->GetRasterYSize()-1);
 		for(int i = 0; i < numImgBands; ++i)
 		{
-			bands[i]->RasterIO(GF_Read, xPxl, yPxl, 1, 1, pxlValues, 1, 1, GDT_Float32, 0, 0);
-			values[i] = pxlValues[0];
+			values[i] = this->bandCaches[i]->getValue(xPxl, yPxl);
 		}
 		return values;
 	}
@@ -297,7 +303,10 @@ namespace rsgis{namespace vec{
 		}
         delete[] this->bands;
 		delete this->imageExtent;
-		delete[] this->pxlValues;
+        for(size_t i = 0; i < this->bandCaches.size(); ++i)
+        {
+            delete this->bandCaches[i];
+        }
         delete[] this->outNames;
 	}
 }}
@@ -27,6 +27,7 @@
 #include <iostream>
 #include <string>
 #include <list>
+#include <vector>
 
 #include <boost/algorithm/string/replace.hpp>
 
@@ -42,6 +43,8 @@
 
 #include "math/RSGISMathsUtils.h"
 
+#include "img/RSGISImageTileCache.h"
+
 #include "geos/geom/Envelope.h"
 
 // mark all exported classes/functions with DllExport to have
@@ -74,7 +77,7 @@ namespace rsgis{namespace vec{
 		int numImgBands;
 		geos::geom::Envelope *imageExtent;
 		double imgRes;
-		float *pxlValues;
+		std::vector<rsgis::img::RSGISImageTileCache<float>*> bandCaches;
         bool useBandNames;
         std::string *outNames;
         bool outputToTextFile;
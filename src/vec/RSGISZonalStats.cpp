@@ -1360,6 +1360,8 @@ namespace rsgis{namespace vec{
 		this->attributes = attributes;
 		this->numAttributes = numAttributes;
 		this->outPxlCount = outPxlCount;
+		this->outputToTextFile = false;
+		this->ownDatasets = false;
 		
 		int dataSize = (numAttributes * 7) + 1; // Create array large enough to hold min, max, mean and stdev for each attribute an number of pixels
 		
@@ -1667,8 +1669,33 @@ namespace rsgis{namespace vec{
 		
 	}
 	
+	RSGISProcessOGRFeature* RSGISZonalStats::clone()
+	{
+		if(this->outputToTextFile)
+		{
+			return NULL;
+		}
+		rsgis::img::RSGISImageThreadUtils threadUtils;
+		std::vector<GDALDataset*> featHandles = threadUtils.openDatasetHandles(this->datasets[0], 2);
+		std::vector<GDALDataset*> imgHandles = threadUtils.openDatasetHandles(this->datasets[1], 2);
+		if((featHandles.size() < 2) | (imgHandles.size() < 2))
+		{
+			threadUtils.closeDatasetHandles(&featHandles);
+			threadUtils.closeDatasetHandles(&imgHandles);
+			return NULL;
+		}
+		RSGISZonalStats *zonalStats = new RSGISZonalStats(imgHandles[1], featHandles[1], this->attributes, this->numAttributes, this->outPxlCount);
+		zonalStats->ownDatasets = true;
+		return zonalStats;
+	}
+	
 	RSGISZonalStats::~RSGISZonalStats()
 	{
+		if(this->ownDatasets)
+		{
+			GDALClose(this->datasets[0]);
+			GDALClose(this->datasets[1]);
+		}
 		delete[] datasets;
 		delete[] data;
 		delete calcValue;
@@ -2487,6 +2514,8 @@ namespace rsgis{namespace vec{
     {
         this->datasets = new GDALDataset*[1];
         this->datasets[0] = image;
+        this->ownImage = false;
+        this->sharedImage = false;
         this->zonalBandAtts = zonalBandAtts;
         this->method = method;
         this->nBands = image->GetRasterCount();
@@ -2522,7 +2551,11 @@ namespace rsgis{namespace vec{
             inOGRPoly = (OGRPolygon *) feature->GetGeometryRef();
             poly = vecUtils->convertOGRPolygon2GEOSPolygon(inOGRPoly);
             // Get Pixel values.
-            calcImage->calcImageWithinPolygonExtentInMem(this->datasets, 1, env, poly, this->method);
+            {
+                rsgis::img::RSGISImageThreadUtils threadUtils;
+                std::unique_lock<std::mutex> readLock = threadUtils.lockSharedRead(this->sharedImage);
+                calcImage->calcImageWithinPolygonExtentInMem(this->datasets, 1, env, poly, this->method);
+            }
 
             // Get Stats from pixels and add to feature.
             for(std::vector<ZonalBandAttrs>::iterator iterAtts = zonalBandAtts->begin(); iterAtts != zonalBandAtts->end(); ++iterAtts)
@@ -2537,16 +2570,31 @@ namespace rsgis{namespace vec{
                         this->dataVal->push_back(*iterVal);
                     }
                 }
-                this->statsSummary->calcMin = (*iterAtts).outMin;
-                this->statsSummary->calcMax = (*iterAtts).outMax;
-                this->statsSummary->calcMean = (*iterAtts).outMean;
-                this->statsSummary->calcSum = (*iterAtts).outSum;
-                this->statsSummary->calcStdDev = (*iterAtts).outStDev;
-                this->statsSummary->calcMedian = (*iterAtts).outMedian;
-                this->statsSummary->calcMode = (*iterAtts).outMode;
-                this->statsSummary->calcVariance = false;
-                if(this->dataVal->size() > 0)
+                // The moments are taken in one pass with the same kernel as the RAT
+                // statistics; only the median and mode need the values sorting.
+                if((this->dataVal->size() > 0) && ((*iterAtts).outMin | (*iterAtts).outMax | (*iterAtts).outMean | (*iterAtts).outSum | (*iterAtts).outStDev))
+                {
+                    rsgis::math::RSGISRunMoments moments = rsgis::math::RSGISGroupedStatsAccumulator::calcRunMoments(this->dataVal->data(), this->dataVal->size(), (*iterAtts).outStDev);
+                    if(moments.n > 0)
+                    {
+                        this->statsSummary->min = moments.min;
+                        this->statsSummary->max = moments.max;
+                        this->statsSummary->sum = moments.sum;
+                        this->statsSummary->mean = moments.sum / moments.n;
+                        // Sample standard deviation, as previously given by generateStats.
+                        this->statsSummary->stdDev = sqrt(moments.m2 / (moments.n - 1));
+                    }
+                }
+                if((this->dataVal->size() > 0) && ((*iterAtts).outMedian | (*iterAtts).outMode))
                 {
+                    this->statsSummary->calcMin = false;
+                    this->statsSummary->calcMax = false;
+                    this->statsSummary->calcMean = false;
+                    this->statsSummary->calcSum = false;
+                    this->statsSummary->calcStdDev = false;
+                    this->statsSummary->calcMedian = (*iterAtts).outMedian;
+                    this->statsSummary->calcMode = (*iterAtts).outMode;
+                    this->statsSummary->calcVariance = false;
                     this->mathUtils->generateStats(this->dataVal, this->statsSummary);
                 }
 
@@ -2597,8 +2645,30 @@ namespace rsgis{namespace vec{
         }
     }
 
+    RSGISProcessOGRFeature* RSGISZonalStatsPolyUpdateLyr::clone()
+    {
+        rsgis::img::RSGISImageThreadUtils threadUtils;
+        bool sharedHandle = false;
+        std::vector<GDALDataset*> handles = threadUtils.openDatasetHandles(this->datasets[0], 2, &sharedHandle);
+        RSGISZonalStatsPolyUpdateLyr *zonalStats = new RSGISZonalStatsPolyUpdateLyr(handles[1], this->zonalBandAtts, this->method);
+        if(sharedHandle)
+        {
+            this->sharedImage = true;
+            zonalStats->sharedImage = true;
+        }
+        else
+        {
+            zonalStats->ownImage = true;
+        }
+        return zonalStats;
+    }
+
     RSGISZonalStatsPolyUpdateLyr::~RSGISZonalStatsPolyUpdateLyr()
     {
+        if(this->ownImage)
+        {
+            GDALClose(this->datasets[0]);
+        }
         for(unsigned int i = 0; i < this->nBands; ++i)
         {
             delete this->pxlVals[i];
@@ -37,10 +37,12 @@
 #include "img/RSGISCalcImage.h"
 #include "img/RSGISCalcImageSingle.h"
 #include "img/RSGISPixelInPoly.h"
+#include "img/RSGISImageThreadUtils.h"
 
 #include "utils/RSGISTextException.h"
 
 #include "math/RSGISMathsUtils.h"
+#include "math/RSGISGroupedStatsAccumulator.h"
 
 #include "vec/RSGISVectorOutputException.h"
 #include "vec/RSGISVectorZonalException.h"
@@ -192,6 +194,8 @@ namespace rsgis
 			virtual void processFeature(OGRFeature *inFeature, OGRFeature *outFeature, geos::geom::Envelope *env, long fid);
 			virtual void processFeature(OGRFeature *feature, geos::geom::Envelope *env, long fid);
 			virtual void createOutputLayerDefinition(OGRLayer *outputLayer, OGRFeatureDefn *inFeatureDefn);
+			/** A copy with its own image handles; NULL when writing to a text file, where the lines must stay in order. */
+			virtual RSGISProcessOGRFeature* clone();
 			virtual ~RSGISZonalStats();
 		protected:
 			GDALDataset **datasets;
@@ -205,6 +209,7 @@ namespace rsgis
 			bool outputToTextFile;
 			bool firstLine;
 			std::ofstream outZonalFile;
+			bool ownDatasets;
 		};
 		
 		class DllExport RSGISCalcZonalStatsFromRasterPolygon : public rsgis::img::RSGISCalcImageSingleValue
@@ -318,9 +323,13 @@ namespace rsgis
             virtual void processFeature(OGRFeature *inFeature, OGRFeature *outFeature, geos::geom::Envelope *env, long fid){throw RSGISVectorOutputException("Not Implemented RSGISZonalStatsPolyUpdateLyr::processFeature; outFeature");};
             virtual void processFeature(OGRFeature *feature, geos::geom::Envelope *env, long fid);
             virtual void createOutputLayerDefinition(OGRLayer *outputLayer, OGRFeatureDefn *inFeatureDefn){throw RSGISVectorOutputException("Not Implemented RSGISZonalStatsPolyUpdateLyr::createOutputLayerDefinition");};
+            /** A copy with its own image handle, or sharing this one (with the reads serialised) if the image cannot be reopened (e.g., KEA). */
+            virtual RSGISProcessOGRFeature* clone();
             virtual ~RSGISZonalStatsPolyUpdateLyr();
         protected:
             GDALDataset **datasets;
+            bool ownImage;
+            bool sharedImage;
             std::vector<ZonalBandAttrs> *zonalBandAtts;
             std::vector<float> **pxlVals;
             unsigned int nBands;